@@ -0,0 +1,157 @@
+#include "ArchiveWriter.h"
+#include "AssetArchive.h"
+#include "BenchmarkCommon.h"
+#include <cstring>
+#include <fstream>
+#include <functional>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Lectura de un conjunto de recursos sueltos (un archivo por recurso, leído con ifstream)
+// contra el mismo conjunto en un .pak: read() de todas las entradas y view() de las que se
+// guardan sin comprimir. La mitad de los recursos es texto (se comprime en LZ4) y la otra
+// mitad ruido (se guarda tal cual). En frío se descartan antes las páginas de la caché de
+// archivos (solo en Linux; en Windows frío y caliente coinciden).
+// Uso: AssetArchiveBenchmark [recursos] [KB por recurso]
+
+namespace {
+
+	void dropCache(const std::string& fileName) {
+#ifndef _WIN32
+		const int file = ::open(fileName.c_str(), O_RDONLY);
+		if (file < 0)
+			return;
+		fdatasync(file);
+		posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED);
+		::close(file);
+#else
+		(void)fileName;
+#endif
+	}
+
+	std::vector<uint8_t> makeAsset(size_t size, unsigned int index) {
+		std::vector<uint8_t> bytes(size);
+		uint32_t random = 31 + index;
+		if (index % 2 == 0) {
+			const char* words[] = { "float4 ", "position", " = mul(", "world, ", "input);\n", "v 0.5 1.0 -2.0\n" };
+			for (size_t i = 0; i < size;) {
+				random = random * 1664525u + 1013904223u;
+				for (const char* c = words[(random >> 24) % 6]; *c && i < size; ++c)
+					bytes[i++] = (uint8_t)*c;
+			}
+		}
+		else {
+			for (uint8_t& byte : bytes) {
+				random = random * 1664525u + 1013904223u;
+				byte = (uint8_t)(random >> 24);
+			}
+		}
+		return bytes;
+	}
+
+	std::string assetName(unsigned int index) {
+		return "AssetArchiveBenchmark/" + std::to_string(index) + (index % 2 == 0 ? ".fx" : ".dds");
+	}
+
+	std::string loosePath(unsigned int index) {
+		return "AssetArchiveBenchmark_" + std::to_string(index) + (index % 2 == 0 ? ".fx" : ".dds");
+	}
+}
+
+int
+main(int argc, char** argv) {
+	const unsigned int count = std::max(2u, bench::argument(argc, argv, 1, 256));
+	const size_t assetBytes = (size_t)std::max(1u, bench::argument(argc, argv, 2, 256)) * 1024;
+	const char* archiveName = "AssetArchiveBenchmark.pak";
+
+	ArchiveWriter writer;
+	for (unsigned int i = 0; i < count; ++i) {
+		const std::vector<uint8_t> asset = makeAsset(assetBytes, i);
+		std::ofstream out(loosePath(i), std::ios::binary);
+		out.write((const char*)asset.data(), asset.size());
+		writer.addMemory(assetName(i), asset.data(), asset.size(), true);
+	}
+	if (FAILED(writer.write(archiveName))) {
+		printf("Cannot write %s\n", archiveName);
+		return 1;
+	}
+	const double totalMB = count * assetBytes / 1048576.0;
+	std::ifstream archiveStream(archiveName, std::ios::binary | std::ios::ate);
+	printf("AssetArchive, %u assets of %u KB (%.1f MB, %.1f MB packed)\n", count, (unsigned int)(assetBytes / 1024),
+		totalMB, (double)archiveStream.tellg() / 1048576.0);
+	archiveStream.close();
+
+	std::vector<uint8_t> data;
+	auto loose = [&] {
+		uint64_t sum = 0;
+		for (unsigned int i = 0; i < count; ++i) {
+			std::ifstream in(loosePath(i), std::ios::binary | std::ios::ate);
+			data.resize((size_t)in.tellg());
+			in.seekg(0);
+			in.read((char*)data.data(), data.size());
+			sum += data[data.size() / 2];
+		}
+		bench::keep(sum);
+	};
+	auto packedRead = [&] {
+		AssetArchive archive;
+		archive.open(archiveName);
+		uint64_t sum = 0;
+		for (unsigned int i = 0; i < count; ++i) {
+			archive.read(assetName(i), data);
+			sum += data[data.size() / 2];
+		}
+		bench::keep(sum);
+	};
+	// Lo que hace TextureCache: view() si la entrada está guardada tal cual, read() si no.
+	// Se toca una vez cada página de la vista, como al decodificarla.
+	auto packedView = [&] {
+		AssetArchive archive;
+		archive.open(archiveName);
+		uint64_t sum = 0;
+		for (unsigned int i = 0; i < count; ++i) {
+			size_t size = 0;
+			const uint8_t* view = archive.view(assetName(i), size);
+			if (view) {
+				for (size_t offset = 0; offset < size; offset += 4096)
+					sum += view[offset];
+			}
+			else {
+				archive.read(assetName(i), data);
+				sum += data[data.size() / 2];
+			}
+		}
+		bench::keep(sum);
+	};
+
+	struct Mode {
+		const char* name;
+		std::function<void()> run;
+	};
+	const Mode modes[] = { { "loose files", loose }, { "pak read()", packedRead }, { "pak view()/read()", packedView } };
+	for (bool cold : { true, false }) {
+		for (const Mode& mode : modes) {
+			// No se usa bestOf: el descarte de la caché no debe contar en el tiempo.
+			double seconds = 1e30;
+			for (int repetition = 0; repetition < 3; ++repetition) {
+				if (cold) {
+					for (unsigned int i = 0; i < count; ++i)
+						dropCache(loosePath(i));
+					dropCache(archiveName);
+				}
+				const double start = bench::now();
+				mode.run();
+				seconds = std::min(seconds, bench::now() - start);
+			}
+			printf("  %-4s %-17s: %8.2f ms (%7.1f MB/s, %6.1f us per asset)\n", cold ? "cold" : "warm", mode.name,
+				seconds * 1e3, totalMB / seconds, seconds * 1e6 / count);
+		}
+	}
+
+	for (unsigned int i = 0; i < count; ++i)
+		std::remove(loosePath(i).c_str());
+	std::remove(archiveName);
+	return 0;
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ * @file BenchmarkCommon.h
+ * @brief Utilidades de los benchmarks: cronómetro y mejor tiempo de varias repeticiones.
+ */
+
+namespace bench {
+    inline double now() {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /// Mejor tiempo en segundos de repetitions ejecuciones de function.
+    template<typename Function>
+    double bestOf(int repetitions, Function function) {
+        double best = 1e30;
+        for (int i = 0; i < repetitions; ++i) {
+            const double start = now();
+            function();
+            const double seconds = now() - start;
+            if (seconds < best)
+                best = seconds;
+        }
+        return best;
+    }
+
+    /// Impide que el compilador elimine un cálculo cuyo resultado no se usa.
+    template<typename T>
+    inline void keep(const T& value) {
+#if defined(_MSC_VER)
+        static volatile char sink;
+        sink = *reinterpret_cast<const volatile char*>(&value);
+#else
+        asm volatile("" : : "r"(&value) : "memory");
+#endif
+    }
+
+    /// Argumento entero de la línea de comandos, o defaultValue.
+    inline unsigned int argument(int argc, char** argv, int index, unsigned int defaultValue) {
+        return argc > index ? (unsigned int)strtoul(argv[index], nullptr, 10) : defaultValue;
+    }
+}
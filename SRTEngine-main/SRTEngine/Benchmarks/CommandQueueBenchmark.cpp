@@ -0,0 +1,105 @@
+#include "CommandQueue.h"
+#include "BenchmarkCommon.h"
+#include <thread>
+
+// Tiempo de grabar y reproducir 100k draws repartidos en listas con 1..N hilos del JobSystem.
+// Cada draw lleva lo mismo que un objeto de la demo: búferes, constantes del objeto y textura.
+// La reproducción va a un executor que solo cuenta, así que mide el coste de la CommandList.
+// Uso: CommandQueueBenchmark [draws] [listas] [hilos máximos]
+
+namespace {
+
+	struct CountingExecutor {
+		unsigned int calls = 0;
+		unsigned int draws = 0;
+		unsigned int constantBytes = 0;
+		uint8_t staging[256];
+
+		void executeCommandList(const CommandList& list) { list.replay(*this); }
+
+		void setInputLayout(const void*) { ++calls; }
+		void setVertexBuffer(unsigned int, const void*, unsigned int, unsigned int) { ++calls; }
+		void setIndexBuffer(const void*, CommandList::IndexWidth, unsigned int) { ++calls; }
+		void setPrimitiveTopology(unsigned int) { ++calls; }
+		void setShader(StateCache::Stage, const void*) { ++calls; }
+		void setConstantBuffer(StateCache::Stage, unsigned int, const void*) { ++calls; }
+		void setConstantBufferRange(StateCache::Stage, unsigned int, const void*, unsigned int, unsigned int) { ++calls; }
+		void setShaderResource(StateCache::Stage, unsigned int, const void*) { ++calls; }
+		void setSampler(StateCache::Stage, unsigned int, const void*) { ++calls; }
+		void setViewport(const CommandList::Viewport&) { ++calls; }
+		void setRenderTargets(unsigned int, const void* const*, const void*) { ++calls; }
+		// Copia las constantes como haría UpdateSubresource.
+		void updateConstantBuffer(const void*, const void* data, unsigned int size) {
+			++calls;
+			memcpy(staging, data, std::min(size, (unsigned int)sizeof(staging)));
+			constantBytes += size;
+		}
+		void drawIndexed(unsigned int, unsigned int, int) {
+			++calls;
+			++draws;
+		}
+		void drawIndexedInstanced(unsigned int, unsigned int, unsigned int, int, unsigned int) {
+			++calls;
+			++draws;
+		}
+	};
+
+	struct ObjectConstants {
+		Matrix world;
+		Float4 color;
+	};
+}
+
+int
+main(int argc, char** argv) {
+	const unsigned int drawCount = bench::argument(argc, argv, 1, 100000);
+	const unsigned int listCount = bench::argument(argc, argv, 2, 64);
+	const unsigned int maxThreads = bench::argument(argc, argv, 3, std::max(1u, std::thread::hardware_concurrency()));
+	const int repetitions = 10;
+
+	// Recursos falsos: la lista solo guarda los punteros.
+	static char buffers[16], textures[8], constantBuffer, layout, vertexShader, pixelShader;
+	const unsigned int drawsPerList = (drawCount + listCount - 1) / listCount;
+	auto recordList = [&](unsigned int index, CommandList& list) {
+		const unsigned int begin = index * drawsPerList;
+		const unsigned int end = std::min(drawCount, begin + drawsPerList);
+		list.setInputLayout(&layout);
+		list.setShader(StateCache::VERTEX_STAGE, &vertexShader);
+		list.setShader(StateCache::PIXEL_STAGE, &pixelShader);
+		list.setConstantBuffer(StateCache::VERTEX_STAGE, 2, &constantBuffer);
+		list.setConstantBuffer(StateCache::PIXEL_STAGE, 2, &constantBuffer);
+		ObjectConstants constants;
+		for (unsigned int i = begin; i < end; ++i) {
+			constants.world = MatrixTranslation((float)i, 0.0f, 0.0f);
+			constants.color = Float4(1.0f, 1.0f, 1.0f, 1.0f);
+			list.setVertexBuffer(0, &buffers[i % 16], 32, 0);
+			list.setIndexBuffer(&buffers[i % 16], CommandList::INDEX_16, 0);
+			list.setShaderResource(StateCache::PIXEL_STAGE, 0, &textures[i % 8]);
+			list.updateConstantBuffer(&constantBuffer, &constants, sizeof(constants));
+			list.drawIndexed(36, 0, 0);
+		}
+	};
+
+	printf("CommandQueue, %u draws in %u lists\n", drawCount, listCount);
+	for (unsigned int threads = 1; threads <= maxThreads; threads *= 2) {
+		JobSystem jobs;
+		jobs.init(threads);
+		CommandQueue queue;
+		queue.init(listCount, threads > 1 ? &jobs : nullptr);
+
+		const double recordSeconds = bench::bestOf(repetitions, [&] { queue.record(recordList); });
+		CountingExecutor executor;
+		const double submitSeconds = bench::bestOf(repetitions, [&] {
+			executor = CountingExecutor();
+			queue.submit(executor);
+			bench::keep(executor.calls);
+		});
+		printf("  %2u threads: record %7.3f ms, submit %7.3f ms (%u commands, %u draws, %.1f MB)\n", threads,
+			recordSeconds * 1e3, submitSeconds * 1e3, queue.getStats().commands, executor.draws,
+			executor.constantBytes / (1024.0 * 1024.0));
+
+		queue.destroy();
+		jobs.destroy();
+	}
+	return 0;
+}
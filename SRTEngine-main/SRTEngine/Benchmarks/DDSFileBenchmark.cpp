@@ -0,0 +1,173 @@
+#include "DDSFile.h"
+#include "BenchmarkCommon.h"
+#include <cstring>
+#include <fstream>
+#include <memory>
+#ifdef _WIN32
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Carga de varios DDS BC7 con todos sus mips: DDSFile::open() (proyección del archivo)
+// contra leer cada archivo a un std::vector y llamar a parse(). Se mide lo que tardan las
+// cabeceras, lo que tarda además tocar todos los datos (como haría la subida a la GPU) y la
+// memoria privada del proceso con todos los archivos abiertos. En frío se descartan antes
+// las páginas de la caché de archivos (solo en Linux; en Windows frío y caliente coinciden).
+// Uso: DDSFileBenchmark [archivos] [lado]
+
+namespace {
+
+	// Memoria privada del proceso en bytes; las páginas proyectadas de un archivo no cuentan.
+	size_t privateBytes() {
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS_EX counters = {};
+		GetProcessMemoryInfo(GetCurrentProcess(), (PROCESS_MEMORY_COUNTERS*)&counters, sizeof(counters));
+		return counters.PrivateUsage;
+#else
+		std::ifstream status("/proc/self/status");
+		std::string line;
+		while (std::getline(status, line)) {
+			if (line.compare(0, 8, "RssAnon:") == 0)
+				return (size_t)strtoull(line.c_str() + 8, nullptr, 10) * 1024;
+		}
+		return 0;
+#endif
+	}
+
+	// Saca el archivo de la caché del sistema para que la siguiente lectura vaya al disco.
+	void dropCache(const std::string& fileName) {
+#ifndef _WIN32
+		const int file = ::open(fileName.c_str(), O_RDONLY);
+		if (file < 0)
+			return;
+		fdatasync(file);
+		posix_fadvise(file, 0, 0, POSIX_FADV_DONTNEED);
+		::close(file);
+#else
+		(void)fileName;
+#endif
+	}
+
+	// Cabeceras DDS + DX10 de un BC7 2D de size x size con la cadena de mips completa.
+	std::vector<uint8_t> makeFile(unsigned int size, uint32_t seed) {
+		unsigned int mips = 1;
+		size_t dataBytes = 0;
+		for (unsigned int s = size;; s /= 2, ++mips) {
+			const size_t blocks = std::max(1u, s / 4);
+			dataBytes += blocks * blocks * 16;
+			if (s == 1)
+				break;
+		}
+		std::vector<uint8_t> file(4 + 124 + 20 + dataBytes, 0);
+		auto put = [&](size_t offset, uint32_t value) { memcpy(&file[offset], &value, 4); };
+		put(0, 0x20534444);
+		put(4, 124);
+		put(8, 0x21007);
+		put(12, size);
+		put(16, size);
+		put(28, mips);
+		put(4 + 72, 32);
+		put(4 + 76, 0x4);
+		put(4 + 80, 0x30315844); // "DX10"
+		put(4 + 104, 0x401008);
+		put(128, 98); // DXGI_FORMAT_BC7_UNORM
+		put(132, 3);
+		put(140, 1);
+		uint32_t random = seed;
+		for (size_t i = 148; i < file.size(); ++i) {
+			random = random * 1664525u + 1013904223u;
+			file[i] = (uint8_t)(random >> 24);
+		}
+		return file;
+	}
+
+	// Lee un byte de cada página de cada subrecurso.
+	uint64_t touch(const DDSFile& dds) {
+		uint64_t sum = 0;
+		for (const DDSFile::Subresource& sub : dds.getSubresources()) {
+			const size_t bytes = (size_t)sub.slicePitch * sub.depth;
+			for (size_t i = 0; i < bytes; i += 4096)
+				sum += sub.data[i];
+		}
+		return sum;
+	}
+
+	struct Result {
+		double headerSeconds = 0.0; ///< open()/lectura + cabeceras
+		double totalSeconds = 0.0;  ///< Además, tocar todos los datos
+		size_t privateBytes = 0;    ///< Memoria privada con todo abierto
+	};
+
+	Result load(const std::vector<std::string>& fileNames, bool mapped, bool cold) {
+		if (cold) {
+			for (const std::string& fileName : fileNames)
+				dropCache(fileName);
+		}
+		Result result;
+		const size_t before = privateBytes();
+		std::vector<std::unique_ptr<DDSFile>> files;
+		std::vector<std::vector<uint8_t>> buffers(fileNames.size());
+		const double start = bench::now();
+		for (size_t i = 0; i < fileNames.size(); ++i) {
+			files.push_back(std::make_unique<DDSFile>());
+			if (mapped) {
+				files.back()->open(fileNames[i]);
+				continue;
+			}
+			std::ifstream in(fileNames[i], std::ios::binary | std::ios::ate);
+			buffers[i].resize((size_t)in.tellg());
+			in.seekg(0);
+			in.read((char*)buffers[i].data(), buffers[i].size());
+			files.back()->parse(buffers[i].data(), buffers[i].size());
+		}
+		result.headerSeconds = bench::now() - start;
+		uint64_t sum = 0;
+		for (const std::unique_ptr<DDSFile>& file : files)
+			sum += touch(*file);
+		bench::keep(sum);
+		result.totalSeconds = bench::now() - start;
+		const size_t after = privateBytes();
+		result.privateBytes = after > before ? after - before : 0;
+		return result;
+	}
+}
+
+int
+main(int argc, char** argv) {
+	const unsigned int count = std::max(1u, bench::argument(argc, argv, 1, 8));
+	const unsigned int size = std::max(4u, bench::argument(argc, argv, 2, 2048));
+
+	std::vector<std::string> fileNames;
+	size_t totalBytes = 0;
+	for (unsigned int i = 0; i < count; ++i) {
+		const std::vector<uint8_t> bytes = makeFile(size, 17 + i);
+		fileNames.push_back("DDSFileBenchmark_" + std::to_string(i) + ".dds");
+		std::ofstream out(fileNames.back(), std::ios::binary);
+		out.write((const char*)bytes.data(), bytes.size());
+		totalBytes += bytes.size();
+	}
+
+	printf("DDSFile, %u BC7 files of %ux%u with mips (%.1f MB)\n", count, size, size, totalBytes / 1048576.0);
+	for (bool cold : { true, false }) {
+		for (bool mapped : { true, false }) {
+			// En caliente, el mejor de varios intentos; en frío cada intento parte de la caché vacía.
+			Result best;
+			best.headerSeconds = best.totalSeconds = 1e30;
+			for (int repetition = 0; repetition < 3; ++repetition) {
+				const Result result = load(fileNames, mapped, cold);
+				if (result.totalSeconds < best.totalSeconds)
+					best = result;
+			}
+			printf("  %-4s %-13s: headers %8.3f ms, all data %8.2f ms (%7.1f MB/s), private memory %7.1f MB\n",
+				cold ? "cold" : "warm", mapped ? "open (mapped)" : "read + parse", best.headerSeconds * 1e3,
+				best.totalSeconds * 1e3, totalBytes / 1048576.0 / best.totalSeconds, best.privateBytes / 1048576.0);
+		}
+	}
+
+	for (const std::string& fileName : fileNames)
+		std::remove(fileName.c_str());
+	return 0;
+}
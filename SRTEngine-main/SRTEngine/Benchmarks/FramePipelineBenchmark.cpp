@@ -0,0 +1,147 @@
+#include "FramePipeline.h"
+#include "FrustumCuller.h"
+#include "TransformHierarchy.h"
+#include "BenchmarkCommon.h"
+#include <memory>
+#include <random>
+
+// Tiempo por frame de un bucle sin ventana con FramePipeline de 1, 2 y 3 huecos. La
+// simulación es una escena sintética pesada en CPU: una jerarquía de 200K nodos con 1 de
+// cada 7 girando en cada frame, culling de frustum de sus esferas y las constantes de cada
+// objeto visible escritas en el hueco del frame. El render lee esas constantes 8 veces
+// (como si las copiara a los búferes y montara los draws) y después duerme lo que se le
+// diga, en lugar de un Present que bloquea. La suma de control debe coincidir en todos los
+// modos: los frames se simulan y se dibujan en el mismo orden.
+// Uso: FramePipelineBenchmark [nodos] [frames] [ms de Present] [hilos del JobSystem]
+
+namespace {
+
+	const unsigned int RENDER_PASSES = 8;
+
+	struct FrameData {
+		std::vector<uint32_t> visible;
+		std::vector<Matrix> constants; ///< Mundo traspuesta de cada visible, como en un cbuffer.
+	};
+
+	struct Scene {
+		TransformHierarchy hierarchy;
+		FrustumCuller culler;
+		std::vector<TransformHierarchy::Node> nodes;
+		std::vector<float> angles;
+		BoundingSpheres spheres;
+		Matrix view, projection;
+		uint64_t frame = 0;
+		FrameData frames[FramePipeline::MAX_FRAMES_IN_FLIGHT];
+	};
+
+	void buildScene(Scene& scene, unsigned int count, JobSystem* jobs) {
+		std::mt19937 random(11);
+		scene.hierarchy.init(jobs);
+		scene.culler.init(jobs);
+		const unsigned int roots = std::max(1u, count / 1000);
+		for (unsigned int i = 0; i < count; ++i) {
+			const TransformHierarchy::Node parent = i < roots ? TransformHierarchy::INVALID_NODE : scene.nodes[random() % i];
+			scene.nodes.push_back(scene.hierarchy.createNode(parent));
+			const Float3 position = i < roots
+				? Float3((float)(random() % 400) - 200.0f, 0.0f, (float)(random() % 400) - 200.0f)
+				: Float3((float)(random() % 100) * 0.05f, 0.5f, (float)(random() % 100) * 0.05f);
+			scene.hierarchy.setPosition(scene.nodes.back(), position);
+			scene.angles.push_back((float)(random() % 628) * 0.01f);
+			scene.spheres.add(Float3(0.0f, 0.0f, 0.0f), 1.0f);
+		}
+		scene.view = MatrixLookAtLH(VectorSet(0.0f, 20.0f, -50.0f, 1.0f), VectorSet(0.0f, 0.0f, 100.0f, 1.0f),
+			VectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+		scene.projection = MatrixPerspectiveFovLH(MATH_PIDIV4, 16.0f / 9.0f, 0.1f, 500.0f);
+	}
+
+	void simulate(void* data, unsigned int slot) {
+		Scene& scene = *static_cast<Scene*>(data);
+		const uint64_t frame = scene.frame++;
+		for (size_t i = frame % 7; i < scene.nodes.size(); i += 7) {
+			const float angle = scene.angles[i] + (float)frame * 0.01f;
+			scene.hierarchy.setRotation(scene.nodes[i], Float4(0.0f, std::sin(angle * 0.5f), 0.0f, std::cos(angle * 0.5f)));
+		}
+		scene.hierarchy.update();
+		for (size_t i = 0; i < scene.nodes.size(); ++i) {
+			const Matrix& world = scene.hierarchy.getWorld(scene.nodes[i]);
+			scene.spheres.set((unsigned int)i, Float3(VectorGetX(world.r[3]), VectorGetY(world.r[3]), VectorGetZ(world.r[3])), 1.0f);
+		}
+		scene.culler.setFrustum(scene.view, scene.projection);
+
+		FrameData& target = scene.frames[slot];
+		target.visible.resize(scene.nodes.size());
+		for (size_t i = 0; i < scene.nodes.size(); ++i)
+			target.visible[i] = (uint32_t)i;
+		scene.culler.cullSpheres(scene.spheres, target.visible);
+		target.constants.resize(target.visible.size());
+		for (size_t i = 0; i < target.visible.size(); ++i)
+			target.constants[i] = MatrixTranspose(scene.hierarchy.getWorld(scene.nodes[target.visible[i]]));
+	}
+
+	double render(const FrameData& frame, unsigned int presentMs) {
+		double checksum = 0.0;
+		for (unsigned int pass = 0; pass < RENDER_PASSES; ++pass) {
+			float sum = 0.0f;
+			for (const Matrix& constants : frame.constants)
+				sum += VectorGetW(constants.r[0]) + VectorGetW(constants.r[2]);
+			checksum += sum;
+		}
+		if (presentMs > 0)
+			std::this_thread::sleep_for(std::chrono::milliseconds(presentMs));
+		return checksum / RENDER_PASSES;
+	}
+}
+
+int
+main(int argc, char** argv) {
+	const unsigned int count = std::max(1000u, bench::argument(argc, argv, 1, 200000));
+	const unsigned int frames = std::max(1u, bench::argument(argc, argv, 2, 200));
+	const unsigned int presentArgument = bench::argument(argc, argv, 3, ~0u);
+	const unsigned int threads = bench::argument(argc, argv, 4, 0);
+	const unsigned int warmup = 10;
+
+	JobSystem jobs;
+	if (threads > 0)
+		jobs.init(threads);
+	printf("FramePipeline, %u nodes (1/7 rotating per frame), %u frames, %u JobSystem threads\n", count, frames, threads);
+	std::vector<unsigned int> presents = { 0, 4 };
+	if (presentArgument != ~0u)
+		presents = { presentArgument };
+	for (unsigned int presentMs : presents) {
+		for (unsigned int framesInFlight = 1; framesInFlight <= FramePipeline::MAX_FRAMES_IN_FLIGHT; ++framesInFlight) {
+			std::unique_ptr<Scene> scene = std::make_unique<Scene>();
+			buildScene(*scene, count, threads > 0 ? &jobs : nullptr);
+			FramePipeline pipeline;
+			pipeline.init(framesInFlight, simulate, scene.get());
+
+			double checksum = 0.0, start = 0.0, worst = 0.0;
+			size_t visible = 0;
+			for (unsigned int frame = 0; frame < warmup + frames; ++frame) {
+				if (frame == warmup)
+					start = bench::now();
+				const double frameStart = bench::now();
+				const unsigned int slot = pipeline.beginRender();
+				checksum += render(scene->frames[slot], presentMs);
+				visible += scene->frames[slot].visible.size();
+				pipeline.endRender();
+				if (frame >= warmup)
+					worst = std::max(worst, bench::now() - frameStart);
+			}
+			const double seconds = bench::now() - start;
+			const FramePipeline::Stats stats = pipeline.getStats();
+			pipeline.destroy();
+			printf("  present %2u ms, %u slot%s: %7.2f ms/frame (%6.1f fps), worst %7.2f ms, simulate %6.2f ms, "
+				"render waited %6.2f ms, simulation waited %6.2f ms, %zu visible, checksum %.6g\n",
+				presentMs, framesInFlight, framesInFlight > 1 ? "s" : " ", seconds * 1e3 / frames, frames / seconds,
+				worst * 1e3, stats.simulateSeconds * 1e3 / std::max<uint64_t>(1, stats.simulated),
+				stats.renderWaitSeconds * 1e3 / std::max<uint64_t>(1, stats.rendered),
+				stats.simulateWaitSeconds * 1e3 / std::max<uint64_t>(1, stats.simulated),
+				visible / (warmup + frames), checksum);
+			scene->culler.destroy();
+			scene->hierarchy.destroy();
+		}
+	}
+	if (threads > 0)
+		jobs.destroy();
+	return 0;
+}
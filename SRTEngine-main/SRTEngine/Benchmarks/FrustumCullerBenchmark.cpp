@@ -0,0 +1,62 @@
+#include "FrustumCuller.h"
+#include "BenchmarkCommon.h"
+#include <random>
+#include <thread>
+
+// Millones de volúmenes por segundo de FrustumCuller con 1..N hilos. El camino SIMD depende
+// de la compilación (-DSRT_MATH_SCALAR=ON, por defecto SSE2, -DSRT_ENABLE_AVX2=ON).
+// Uso: FrustumCullerBenchmark [volúmenes] [hilos máximos]
+
+int
+main(int argc, char** argv) {
+	const unsigned int count = bench::argument(argc, argv, 1, 1000000);
+	const unsigned int maxThreads = bench::argument(argc, argv, 2, std::max(1u, std::thread::hardware_concurrency()));
+	const int repetitions = 10;
+
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+	std::uniform_real_distribution<float> size(0.1f, 3.0f);
+	BoundingSpheres spheres;
+	BoundingBoxes boxes;
+	for (unsigned int i = 0; i < count; ++i) {
+		const Float3 center(position(random), position(random), position(random));
+		spheres.add(center, size(random));
+		boxes.add(center, Float3(size(random), size(random), size(random)));
+	}
+	const Matrix view = MatrixLookAtLH(VectorSet(0.0f, 10.0f, -50.0f, 1.0f), VectorSet(0.0f, 0.0f, 0.0f, 1.0f),
+		VectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+	const Matrix projection = MatrixPerspectiveFovLH(MATH_PIDIV4, 1200.0f / 1010.0f, 0.1f, 150.0f);
+
+#if defined(SRT_MATH_SSE) && defined(SRT_SIMD_AVX2)
+	printf("FrustumCuller AVX2, %u volumes\n", count);
+#elif defined(SRT_MATH_SSE)
+	printf("FrustumCuller SSE2, %u volumes\n", count);
+#else
+	printf("FrustumCuller scalar, %u volumes\n", count);
+#endif
+
+	std::vector<uint32_t> visible;
+	for (unsigned int threads = 1; threads <= maxThreads; threads *= 2) {
+		JobSystem jobs;
+		jobs.init(threads);
+		FrustumCuller culler;
+		culler.init(threads > 1 ? &jobs : nullptr);
+		culler.setFrustum(view, projection);
+
+		const double sphereSeconds = bench::bestOf(repetitions, [&] {
+			culler.cullSpheres(spheres, visible);
+			bench::keep(visible[0]);
+		});
+		const unsigned int sphereVisible = culler.getStats().visible;
+		const double boxSeconds = bench::bestOf(repetitions, [&] {
+			culler.cullBoxes(boxes, visible);
+			bench::keep(visible[0]);
+		});
+		printf("  %2u threads: spheres %8.1f M/s (%u visible), boxes %8.1f M/s (%u visible)\n", threads,
+			count / sphereSeconds * 1e-6, sphereVisible, count / boxSeconds * 1e-6, culler.getStats().visible);
+
+		culler.destroy();
+		jobs.destroy();
+	}
+	return 0;
+}
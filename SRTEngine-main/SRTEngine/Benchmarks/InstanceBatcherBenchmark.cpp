@@ -0,0 +1,108 @@
+#include "InstanceRenderer.h"
+#include "ConstantBufferManager.h"
+#include "CommandList.h"
+#include "BenchmarkCommon.h"
+#include <algorithm>
+
+// Dibujos y tiempo de CPU por frame de 10k a 100k objetos repartidos entre pocas mallas y
+// materiales. Por objeto: las constantes (mundo transpuesto y color) en el anillo de
+// ConstantBufferManager, su enlace y un drawIndexed grabados en una CommandList, como el
+// camino sin instanciar de la demo. Instanciado: add() por objeto, build() e
+// InstanceRenderer::submit(), un DrawIndexedInstanced por lote. Sin dispositivo los dos
+// caminos se quedan en CPU, así que el tiempo no incluye el coste del driver por dibujo, que
+// es justo lo que ahorra instanciar.
+// Uso: InstanceBatcherBenchmark [objetos máximos] [mallas] [materiales]
+
+namespace {
+
+	struct ObjectConstants {
+		Matrix world;
+		Float4 color;
+	};
+
+	struct Object {
+		uint32_t mesh;
+		uint32_t material;
+		Matrix world;
+		Float4 color;
+	};
+
+	std::vector<Object> makeScene(unsigned int count, unsigned int meshes, unsigned int materials) {
+		std::vector<Object> objects(count);
+		uint32_t random = 99;
+		for (unsigned int i = 0; i < count; ++i) {
+			random = random * 1664525u + 1013904223u;
+			Object& object = objects[i];
+			object.mesh = (random >> 8) % meshes;
+			object.material = (random >> 16) % materials;
+			object.world = MatrixMultiply(MatrixRotationY(i * 0.01f),
+				MatrixTranslation((float)(i % 100), (float)(i / 10000), (float)(i / 100 % 100)));
+			object.color = { (random >> 24) / 255.0f, 0.5f, 1.0f, 1.0f };
+		}
+		return objects;
+	}
+}
+
+int
+main(int argc, char** argv) {
+	const unsigned int maxObjects = std::max(10000u, bench::argument(argc, argv, 1, 100000));
+	const unsigned int meshes = std::max(1u, bench::argument(argc, argv, 2, 8));
+	const unsigned int materials = std::max(1u, bench::argument(argc, argv, 3, 4));
+	const int repetitions = 5;
+	const std::vector<Object> scene = makeScene(maxObjects, meshes, materials);
+
+	ConstantBufferManager constants;
+	constants.init(nullptr, nullptr, 16 << 20);
+	CommandList commands;
+	InstanceBatcher batcher;
+	batcher.reserve(maxObjects);
+	InstanceRenderer renderer;
+	renderer.init(nullptr, nullptr, maxObjects);
+	for (unsigned int mesh = 0; mesh < meshes; ++mesh) {
+		InstanceRenderer::Mesh description;
+		description.indexCount = 36;
+		renderer.addMesh(description);
+	}
+
+	printf("InstanceBatcher, %u meshes x %u materials, CPU time per frame\n", meshes, materials);
+	for (unsigned int count : { 10000u, 25000u, 50000u, 100000u }) {
+		if (count > maxObjects)
+			break;
+
+		unsigned int individualDraws = 0;
+		const double individualSeconds = bench::bestOf(repetitions, [&] {
+			commands.reset();
+			for (unsigned int i = 0; i < count; ++i) {
+				const Object& object = scene[i];
+				ObjectConstants cb;
+				cb.world = MatrixTranspose(object.world);
+				cb.color = object.color;
+				ConstantBufferManager::Allocation allocation;
+				constants.allocate(&cb, sizeof(cb), allocation);
+				commands.setConstantBufferRange(StateCache::VERTEX_STAGE, 2, constants.getRingBuffer(),
+					allocation.firstConstant, allocation.numConstants);
+				commands.drawIndexed(36, object.mesh * 36, 0);
+			}
+			constants.endFrame();
+			individualDraws = commands.getDrawCount();
+		});
+
+		unsigned int batches = 0;
+		const double instancedSeconds = bench::bestOf(repetitions, [&] {
+			batcher.clear();
+			for (unsigned int i = 0; i < count; ++i) {
+				const Object& object = scene[i];
+				batcher.add(object.mesh, object.material, object.world, object.color, object.mesh);
+			}
+			batcher.build();
+			renderer.submit(batcher);
+			batches = (unsigned int)batcher.getBatches().size();
+		});
+		const InstanceRenderer::Stats& stats = renderer.getStats();
+
+		printf("  %6u objects: individual %7.3f ms, %6u draws | instanced %7.3f ms (%5.2fx), %3u draws, %u batches, %.1f MB uploaded\n",
+			count, individualSeconds * 1e3, individualDraws, instancedSeconds * 1e3, individualSeconds / instancedSeconds,
+			stats.drawCalls, batches, stats.bytesUploaded / 1048576.0);
+	}
+	return 0;
+}
@@ -0,0 +1,153 @@
+#include "JobSystem.h"
+#include "BenchmarkCommon.h"
+#include <random>
+#include <thread>
+
+// JobSystem con 1..N hilos y cuatro cargas: muchos trabajos vacíos (coste de encolar y
+// despachar), trabajos iguales de unos 20 us, trabajos de coste muy desigual (donde el
+// robo reparte la cola del hilo que encoló) y un árbol de trabajos que encolan y esperan a
+// sus hijos desde dentro de un trabajo. Para cada una: tiempo, aceleración frente a un
+// hilo y cuántos trabajos se robaron.
+// Uso: JobSystemBenchmark [hilos máximos] [trabajos]
+
+namespace {
+
+	// Unas iteraciones de cálculo que el compilador no puede quitar.
+	float spin(unsigned int iterations, float seed) {
+		float value = seed;
+		for (unsigned int i = 0; i < iterations; ++i)
+			value = value * 0.999f + 0.5f;
+		return value;
+	}
+
+	struct Workload {
+		std::vector<unsigned int> iterations; ///< Coste de cada trabajo.
+		std::vector<float> results;
+	};
+
+	void workJob(void* data, unsigned int index) {
+		Workload& workload = *static_cast<Workload*>(data);
+		workload.results[index] = spin(workload.iterations[index], (float)index);
+	}
+
+	// Nodo del árbol: si le quedan niveles encola dos hijos y los espera.
+	struct Tree {
+		JobSystem* jobs;
+		unsigned int depth;
+		unsigned int leafIterations;
+		std::atomic<uint64_t> leaves{ 0 };
+	};
+
+	struct TreeNode {
+		Tree* tree;
+		unsigned int level;
+	};
+
+	void treeJob(void* data, unsigned int) {
+		const TreeNode& node = *static_cast<const TreeNode*>(data);
+		Tree& tree = *node.tree;
+		if (node.level == tree.depth) {
+			bench::keep(spin(tree.leafIterations, (float)node.level));
+			tree.leaves.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		TreeNode child = { &tree, node.level + 1 };
+		JobCounter counter;
+		tree.jobs->run(treeJob, &child, 2, &counter);
+		tree.jobs->wait(counter);
+	}
+
+	struct Result {
+		double seconds;
+		uint64_t executed;
+		uint64_t stolen;
+	};
+
+	template <typename Function>
+	Result measure(JobSystem& jobs, Function function) {
+		const JobSystem::Stats before = jobs.getStats();
+		const double seconds = bench::bestOf(5, function);
+		const JobSystem::Stats after = jobs.getStats();
+		return { seconds, (after.executed - before.executed) / 5, (after.stolen - before.stolen) / 5 };
+	}
+
+	void print(const char* name, unsigned int threads, const Result& result, double singleThread) {
+		printf("  %-10s %2u threads: %8.3f ms (%5.2fx), %8llu jobs, %7llu stolen (%4.1f%%)\n", name, threads,
+			result.seconds * 1e3, singleThread / result.seconds, (unsigned long long)result.executed,
+			(unsigned long long)result.stolen, result.executed ? 100.0 * result.stolen / result.executed : 0.0);
+	}
+}
+
+int
+main(int argc, char** argv) {
+	const unsigned int maxThreads = bench::argument(argc, argv, 1, std::max(1u, std::thread::hardware_concurrency()));
+	const unsigned int count = std::max(1u, bench::argument(argc, argv, 2, 4096));
+
+	// Unas 20 us por trabajo en los uniformes; en los desiguales la mayoría son cortos y
+	// unos pocos hasta 50 veces más largos, con el mismo total.
+	unsigned int iterationsPer20us = 1000;
+	{
+		const double start = bench::now();
+		bench::keep(spin(1000000, 1.0f));
+		iterationsPer20us = (unsigned int)std::max(1.0, 1000000 * 20e-6 / (bench::now() - start));
+	}
+	Workload empty, uniform, uneven;
+	std::mt19937 random(3);
+	uint64_t unevenTotal = 0;
+	for (unsigned int i = 0; i < count; ++i) {
+		empty.iterations.push_back(0);
+		uniform.iterations.push_back(iterationsPer20us);
+		uneven.iterations.push_back(random() % 16 == 0 ? iterationsPer20us * (1 + random() % 50) : iterationsPer20us / 8);
+		unevenTotal += uneven.iterations.back();
+	}
+	for (unsigned int& iterations : uneven.iterations)
+		iterations = (unsigned int)((uint64_t)iterations * iterationsPer20us * count / unevenTotal);
+	for (Workload* workload : { &empty, &uniform, &uneven })
+		workload->results.resize(count);
+	unsigned int treeDepth = 0;
+	while ((2u << treeDepth) <= count)
+		++treeDepth;
+
+	printf("JobSystem, %u jobs per batch, %u-level job tree\n", count, treeDepth);
+	double single[4] = {};
+	for (unsigned int threads = 1; threads <= maxThreads; threads *= 2) {
+		JobSystem jobs;
+		jobs.init(threads);
+		const Result results[4] = {
+			measure(jobs, [&] {
+				JobCounter counter;
+				jobs.run(workJob, &empty, count, &counter);
+				jobs.wait(counter);
+			}),
+			measure(jobs, [&] {
+				JobCounter counter;
+				jobs.run(workJob, &uniform, count, &counter);
+				jobs.wait(counter);
+			}),
+			measure(jobs, [&] {
+				JobCounter counter;
+				jobs.run(workJob, &uneven, count, &counter);
+				jobs.wait(counter);
+			}),
+			measure(jobs, [&] {
+				Tree tree;
+				tree.jobs = &jobs;
+				tree.depth = treeDepth;
+				tree.leafIterations = iterationsPer20us;
+				TreeNode root = { &tree, 0 };
+				treeJob(&root, 0);
+				bench::keep(tree.leaves.load());
+			}),
+		};
+		const char* names[4] = { "empty", "uniform", "uneven", "nested" };
+		for (int i = 0; i < 4; ++i) {
+			if (threads == 1)
+				single[i] = results[i].seconds;
+			print(names[i], threads, results[i], single[i]);
+		}
+		if (threads == 1 && results[0].executed)
+			printf("  (%.0f ns per empty job on one thread)\n", results[0].seconds * 1e9 / results[0].executed);
+		jobs.destroy();
+	}
+	return 0;
+}
@@ -0,0 +1,150 @@
+#include "MeshLoader.h"
+#include "BenchmarkCommon.h"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+// Análisis de una rejilla de side x side vértices con MeshLoader, en serie (sin JobSystem) y
+// con 1..N hilos: como OBJ (texto con v, vt y caras de cuatro esquinas) y como .glb (posición,
+// UV e índices de 32 bits en el trozo binario). Tiempo de lectura y de unificación por
+// separado, MB/s de la lectura y si la malla sale igual que en serie.
+// Uso: MeshLoaderBenchmark [lado] [hilos máximos]
+
+namespace {
+
+	std::string gridObj(unsigned int side) {
+		std::string text;
+		text.reserve((size_t)side * side * 80);
+		char line[128];
+		for (unsigned int row = 0; row < side; ++row) {
+			for (unsigned int column = 0; column < side; ++column) {
+				snprintf(line, sizeof(line), "v %.4f %.4f %.4f\nvt %.6f %.6f\n", column * 0.1f, row * 0.1f,
+					std::sin(column * 0.05f) * std::cos(row * 0.05f), (float)column / side, (float)row / side);
+				text += line;
+			}
+		}
+		for (unsigned int row = 0; row + 1 < side; ++row) {
+			for (unsigned int column = 0; column + 1 < side; ++column) {
+				const unsigned int a = row * side + column + 1, b = a + 1, c = a + side + 1, d = a + side;
+				snprintf(line, sizeof(line), "f %u/%u %u/%u %u/%u %u/%u\n", a, a, b, b, c, c, d, d);
+				text += line;
+			}
+		}
+		return text;
+	}
+
+	template <typename T>
+	void append(std::vector<uint8_t>& bytes, const T& value) {
+		const uint8_t* p = reinterpret_cast<const uint8_t*>(&value);
+		bytes.insert(bytes.end(), p, p + sizeof(T));
+	}
+
+	std::vector<uint8_t> gridGlb(unsigned int side) {
+		std::vector<uint8_t> binary;
+		const unsigned int vertices = side * side;
+		for (unsigned int i = 0; i < vertices; ++i) {
+			const unsigned int row = i / side, column = i % side;
+			append(binary, Float3(column * 0.1f, row * 0.1f, std::sin(column * 0.05f) * std::cos(row * 0.05f)));
+		}
+		for (unsigned int i = 0; i < vertices; ++i)
+			append(binary, Float2((float)(i % side) / side, (float)(i / side) / side));
+		unsigned int indices = 0;
+		for (unsigned int row = 0; row + 1 < side; ++row) {
+			for (unsigned int column = 0; column + 1 < side; ++column) {
+				const uint32_t a = row * side + column, b = a + 1, c = a + side + 1, d = a + side;
+				for (uint32_t index : { a, b, c, a, c, d })
+					append(binary, index);
+				indices += 6;
+			}
+		}
+
+		const size_t positionBytes = (size_t)vertices * 12, texCoordBytes = (size_t)vertices * 8;
+		std::string json = "{\"asset\":{\"version\":\"2.0\"},\"meshes\":[{\"primitives\":[{\"attributes\":"
+			"{\"POSITION\":0,\"TEXCOORD_0\":1},\"indices\":2}]}],"
+			"\"buffers\":[{\"byteLength\":" + std::to_string(binary.size()) + "}],"
+			"\"bufferViews\":[{\"buffer\":0,\"byteOffset\":0,\"byteLength\":" + std::to_string(positionBytes) + "},"
+			"{\"buffer\":0,\"byteOffset\":" + std::to_string(positionBytes) + ",\"byteLength\":" + std::to_string(texCoordBytes) + "},"
+			"{\"buffer\":0,\"byteOffset\":" + std::to_string(positionBytes + texCoordBytes) + ",\"byteLength\":" +
+			std::to_string((size_t)indices * 4) + "}],"
+			"\"accessors\":[{\"bufferView\":0,\"componentType\":5126,\"count\":" + std::to_string(vertices) + ",\"type\":\"VEC3\"},"
+			"{\"bufferView\":1,\"componentType\":5126,\"count\":" + std::to_string(vertices) + ",\"type\":\"VEC2\"},"
+			"{\"bufferView\":2,\"componentType\":5125,\"count\":" + std::to_string(indices) + ",\"type\":\"SCALAR\"}]}";
+		while (json.size() % 4)
+			json += ' ';
+
+		std::vector<uint8_t> file;
+		append(file, 0x46546C67u);
+		append(file, 2u);
+		append(file, (uint32_t)(12 + 8 + json.size() + 8 + binary.size()));
+		append(file, (uint32_t)json.size());
+		append(file, 0x4E4F534Au);
+		file.insert(file.end(), json.begin(), json.end());
+		append(file, (uint32_t)binary.size());
+		append(file, 0x004E4942u);
+		file.insert(file.end(), binary.begin(), binary.end());
+		return file;
+	}
+
+	bool sameMesh(const MeshData& a, const MeshData& b) {
+		return a.indices == b.indices && a.vertices.size() == b.vertices.size() &&
+			memcmp(a.vertices.data(), b.vertices.data(), a.vertices.size() * sizeof(MeshVertex)) == 0;
+	}
+
+	// Mejor de repetitions análisis con el loader dado; deja la malla en mesh.
+	template <typename Parse>
+	MeshLoader::Stats run(MeshLoader& loader, int repetitions, MeshData& mesh, const Parse& parse) {
+		MeshLoader::Stats best;
+		best.parseSeconds = 1e30;
+		for (int i = 0; i < repetitions; ++i) {
+			if (FAILED(parse(loader, mesh)))
+				return MeshLoader::Stats();
+			if (loader.getStats().parseSeconds < best.parseSeconds)
+				best = loader.getStats();
+		}
+		return best;
+	}
+
+	template <typename Parse>
+	void compare(const char* name, unsigned int maxThreads, const Parse& parse) {
+		const int repetitions = 3;
+		MeshLoader serial;
+		serial.init();
+		MeshData reference;
+		const MeshLoader::Stats stats = run(serial, repetitions, reference, parse);
+		printf("%s: %.1f MB, %u source vertices -> %u vertices, %u triangles\n", name, stats.bytes / 1048576.0,
+			stats.sourceVertices, stats.vertices, stats.triangles);
+		printf("  serial     : parse %8.2f ms (%7.1f MB/s), weld %7.2f ms\n", stats.parseSeconds * 1e3,
+			stats.bytes / 1048576.0 / stats.parseSeconds, stats.weldSeconds * 1e3);
+
+		for (unsigned int threads = 1; threads <= maxThreads; threads *= 2) {
+			JobSystem jobs;
+			jobs.init(threads);
+			MeshLoader loader;
+			loader.init(&jobs);
+			MeshData mesh;
+			const MeshLoader::Stats parallel = run(loader, repetitions, mesh, parse);
+			printf("  %2u threads : parse %8.2f ms (%7.1f MB/s, %4.2fx), weld %7.2f ms, %s\n", threads,
+				parallel.parseSeconds * 1e3, parallel.bytes / 1048576.0 / parallel.parseSeconds,
+				stats.parseSeconds / parallel.parseSeconds, parallel.weldSeconds * 1e3,
+				sameMesh(reference, mesh) ? "same mesh" : "DIFFERENT MESH");
+			loader.destroy();
+			jobs.destroy();
+		}
+	}
+}
+
+int
+main(int argc, char** argv) {
+	const unsigned int side = std::max(2u, bench::argument(argc, argv, 1, 1000));
+	const unsigned int maxThreads = std::max(1u, bench::argument(argc, argv, 2, std::max(1u, std::thread::hardware_concurrency())));
+
+	const std::string obj = gridObj(side);
+	compare("OBJ", maxThreads, [&](MeshLoader& loader, MeshData& mesh) {
+		return loader.parseObj(reinterpret_cast<const uint8_t*>(obj.data()), obj.size(), mesh);
+	});
+	const std::vector<uint8_t> glb = gridGlb(side);
+	compare("GLB", maxThreads, [&](MeshLoader& loader, MeshData& mesh) {
+		return loader.parseGltf(glb.data(), glb.size(), "", mesh);
+	});
+	return 0;
+}
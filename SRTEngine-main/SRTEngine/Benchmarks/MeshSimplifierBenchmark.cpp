@@ -0,0 +1,121 @@
+#include "MeshSimplifier.h"
+#include "BenchmarkCommon.h"
+#include <algorithm>
+#include <cfloat>
+
+// Simplificación con MeshSimplifier de una esfera con relieve y de una rejilla abierta con
+// relieve. Para cada una, la cadena de buildLods() con las opciones de la demo (triángulos,
+// error absoluto y relativo al radio de la caja, tiempo por nivel) y simplify() sin límite de
+// error al 50, 25, 10 y 5%: triángulos a los que llega, error que deja y tiempo.
+// Uso: MeshSimplifierBenchmark [paralelos de la esfera] [lado de la rejilla]
+
+namespace {
+
+	MeshData makeSphere(unsigned int stacks) {
+		MeshData mesh;
+		const unsigned int slices = stacks * 2;
+		for (unsigned int i = 0; i <= stacks; ++i) {
+			const float theta = 3.14159265f * i / stacks;
+			for (unsigned int j = 0; j <= slices; ++j) {
+				const float phi = 6.2831853f * j / slices;
+				const float radius = 1.0f + 0.05f * std::sin(theta * 11.0f) * std::cos(phi * 7.0f);
+				MeshVertex vertex;
+				vertex.position = Float3(radius * std::sin(theta) * std::cos(phi), radius * std::cos(theta),
+					radius * std::sin(theta) * std::sin(phi));
+				vertex.texCoord = Float2((float)j / slices, (float)i / stacks);
+				mesh.vertices.push_back(vertex);
+			}
+		}
+		for (unsigned int i = 0; i < stacks; ++i) {
+			for (unsigned int j = 0; j < slices; ++j) {
+				const uint32_t a = i * (slices + 1) + j, b = a + 1, c = a + slices + 2, d = a + slices + 1;
+				if (i > 0) {
+					for (uint32_t index : { a, c, b })
+						mesh.indices.push_back(index);
+				}
+				if (i + 1 < stacks) {
+					for (uint32_t index : { a, d, c })
+						mesh.indices.push_back(index);
+				}
+			}
+		}
+		mesh.boundsMin = Float3(-1.05f, -1.05f, -1.05f);
+		mesh.boundsMax = Float3(1.05f, 1.05f, 1.05f);
+		return mesh;
+	}
+
+	MeshData makeGrid(unsigned int side) {
+		MeshData mesh;
+		for (unsigned int y = 0; y < side; ++y) {
+			for (unsigned int x = 0; x < side; ++x) {
+				MeshVertex vertex;
+				vertex.position = Float3(x * 0.1f, y * 0.1f, std::sin(x * 0.05f) * std::cos(y * 0.07f));
+				vertex.texCoord = Float2((float)x / side, (float)y / side);
+				mesh.vertices.push_back(vertex);
+			}
+		}
+		for (unsigned int y = 0; y + 1 < side; ++y) {
+			for (unsigned int x = 0; x + 1 < side; ++x) {
+				const uint32_t a = y * side + x, b = a + 1, c = a + side + 1, d = a + side;
+				for (uint32_t index : { a, c, b, a, d, c })
+					mesh.indices.push_back(index);
+			}
+		}
+		mesh.boundsMin = Float3(0.0f, 0.0f, -1.0f);
+		mesh.boundsMax = Float3((side - 1) * 0.1f, (side - 1) * 0.1f, 1.0f);
+		return mesh;
+	}
+
+	void run(const char* name, const MeshData& mesh) {
+		const size_t triangles = mesh.indices.size() / 3;
+		const float dx = mesh.boundsMax.x - mesh.boundsMin.x, dy = mesh.boundsMax.y - mesh.boundsMin.y,
+			dz = mesh.boundsMax.z - mesh.boundsMin.z;
+		const float radius = 0.5f * std::sqrt(dx * dx + dy * dy + dz * dz);
+		printf("%s: %zu triangles, %zu vertices, bounding radius %.3f\n", name, triangles, mesh.vertices.size(), radius);
+
+		// Cadena de la demo: cada nivel parte del anterior, así que el tiempo es el de ese paso.
+		MeshSimplifier::LodOptions options;
+		std::vector<MeshSimplifier::Lod> lods;
+		MeshSimplifier::Stats stats;
+		if (FAILED(MeshSimplifier::buildLods(mesh, options, lods, &stats)))
+			return;
+		printf("  buildLods: %u levels in %.1f ms\n", stats.levels, stats.seconds * 1e3);
+		for (size_t l = 0; l < lods.size(); ++l) {
+			const size_t count = lods[l].indices.size() / 3;
+			double seconds = 0.0;
+			if (l > 0) {
+				std::vector<uint32_t> destination(lods[l - 1].indices.size());
+				const size_t target = (size_t)(lods[l - 1].indices.size() / 3 * options.reduction) * 3;
+				seconds = bench::bestOf(3, [&] {
+					bench::keep(MeshSimplifier::simplify(destination.data(), lods[l - 1].indices.data(), lods[l - 1].indices.size(),
+						mesh.vertices.data(), (unsigned int)mesh.vertices.size(), target, options.maxError * radius - lods[l - 1].error));
+				});
+			}
+			printf("    LOD %zu: %8zu triangles (%5.1f%%), error %.5f (%.4f%% of radius), %7.2f ms\n", l, count,
+				100.0 * count / triangles, lods[l].error, 100.0 * lods[l].error / radius, seconds * 1e3);
+		}
+
+		// Directo desde la malla original, sin límite de error.
+		std::vector<uint32_t> destination(mesh.indices.size());
+		for (float ratio : { 0.5f, 0.25f, 0.1f, 0.05f }) {
+			const size_t target = (size_t)(triangles * ratio);
+			size_t count = 0;
+			float error = 0.0f;
+			const double seconds = bench::bestOf(3, [&] {
+				count = MeshSimplifier::simplify(destination.data(), mesh.indices.data(), mesh.indices.size(), mesh.vertices.data(),
+					(unsigned int)mesh.vertices.size(), target * 3, FLT_MAX, false, &error);
+			});
+			printf("  simplify to %4.1f%%: %8zu triangles (target %8zu), error %.5f (%.4f%% of radius), %7.2f ms\n",
+				100.0f * ratio, count / 3, target, error, 100.0 * error / radius, seconds * 1e3);
+		}
+	}
+}
+
+int
+main(int argc, char** argv) {
+	const unsigned int stacks = std::max(4u, bench::argument(argc, argv, 1, 256));
+	const unsigned int side = std::max(2u, bench::argument(argc, argv, 2, 512));
+	run("Sphere", makeSphere(stacks));
+	run("Grid", makeGrid(side));
+	return 0;
+}
@@ -0,0 +1,118 @@
+#include "MeshletBuilder.h"
+#include "MeshOptimizer.h"
+#include "BenchmarkCommon.h"
+#include <algorithm>
+
+// Descarte por conos de MeshletBuilder en una esfera con relieve de unos 2M de triángulos,
+// ordenada antes con MeshOptimizer como en la demo. Para 64 cámaras alrededor a distintas
+// distancias: tiempo de cull() de todos los tramos, qué parte de los triángulos se descarta
+// frente a la que mira de verdad hacia atrás, y draws que salen según maxGapTriangles. Como
+// referencia, el coste de probar cada triángulo por separado.
+// Uso: MeshletBuilderBenchmark [paralelos] [maxVertices] [maxTriangles]
+
+namespace {
+
+	MeshData makeSphere(unsigned int stacks) {
+		MeshData mesh;
+		const unsigned int slices = stacks * 2;
+		for (unsigned int i = 0; i <= stacks; ++i) {
+			const float theta = 3.14159265f * i / stacks;
+			for (unsigned int j = 0; j <= slices; ++j) {
+				const float phi = 6.2831853f * j / slices;
+				const float radius = 1.0f + 0.02f * std::sin(theta * 23.0f) * std::cos(phi * 17.0f);
+				MeshVertex vertex;
+				vertex.position = Float3(radius * std::sin(theta) * std::cos(phi), radius * std::cos(theta),
+					radius * std::sin(theta) * std::sin(phi));
+				vertex.texCoord = Float2((float)j / slices, (float)i / stacks);
+				mesh.vertices.push_back(vertex);
+			}
+		}
+		// Sentido horario visto desde fuera: cross(b - a, c - a) apunta hacia fuera.
+		for (unsigned int i = 0; i < stacks; ++i) {
+			for (unsigned int j = 0; j < slices; ++j) {
+				const uint32_t a = i * (slices + 1) + j, b = a + 1, c = a + slices + 2, d = a + slices + 1;
+				if (i > 0) {
+					for (uint32_t index : { a, c, b })
+						mesh.indices.push_back(index);
+				}
+				if (i + 1 < stacks) {
+					for (uint32_t index : { a, d, c })
+						mesh.indices.push_back(index);
+				}
+			}
+		}
+		return mesh;
+	}
+
+	// Triángulos que miran hacia atrás desde camera, uno a uno.
+	uint64_t backFacing(const MeshData& mesh, const Float3& camera) {
+		uint64_t count = 0;
+		for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+			const Float3& a = mesh.vertices[mesh.indices[i]].position;
+			const Float3& b = mesh.vertices[mesh.indices[i + 1]].position;
+			const Float3& c = mesh.vertices[mesh.indices[i + 2]].position;
+			const Float3 u(b.x - a.x, b.y - a.y, b.z - a.z), v(c.x - a.x, c.y - a.y, c.z - a.z);
+			const Float3 n(u.y * v.z - u.z * v.y, u.z * v.x - u.x * v.z, u.x * v.y - u.y * v.x);
+			count += n.x * (a.x - camera.x) + n.y * (a.y - camera.y) + n.z * (a.z - camera.z) >= 0.0f ? 1 : 0;
+		}
+		return count;
+	}
+}
+
+int
+main(int argc, char** argv) {
+	const unsigned int stacks = std::max(4u, bench::argument(argc, argv, 1, 720));
+	MeshletBuilder::Options options;
+	options.maxVertices = bench::argument(argc, argv, 2, options.maxVertices);
+	options.maxTriangles = bench::argument(argc, argv, 3, options.maxTriangles);
+
+	MeshData mesh = makeSphere(stacks);
+	MeshOptimizer::optimizeVertexCache(mesh.indices.data(), mesh.indices.size(), (unsigned int)mesh.vertices.size());
+	MeshletMesh meshlets;
+	double start = bench::now();
+	if (FAILED(MeshletBuilder::build(mesh, options, meshlets)))
+		return 1;
+	const double buildSeconds = bench::now() - start;
+	const size_t triangles = mesh.indices.size() / 3;
+	printf("MeshletBuilder, sphere of %zu triangles: %zu meshlets (%u vertices, %u triangles max), %zu chunks, build %.1f ms\n",
+		triangles, meshlets.meshlets.size(), options.maxVertices, options.maxTriangles, meshlets.chunks.size(), buildSeconds * 1e3);
+
+	// Cámaras en una espiral alrededor de la esfera, de cerca (1.5 radios) a lejos (20).
+	const unsigned int cameraCount = 64;
+	std::vector<Float3> cameras;
+	for (unsigned int i = 0; i < cameraCount; ++i) {
+		const float distance = 1.5f + 18.5f * i / (cameraCount - 1);
+		const float y = 1.0f - 2.0f * (i + 0.5f) / cameraCount;
+		const float ring = std::sqrt(1.0f - y * y);
+		const float angle = i * 2.39996f;
+		cameras.push_back(Float3(distance * ring * std::cos(angle), distance * y, distance * ring * std::sin(angle)));
+	}
+
+	std::vector<MeshletBuilder::DrawRange> ranges;
+	ranges.reserve(meshlets.meshlets.size());
+	for (unsigned int gap : { 0u, 64u, 256u }) {
+		MeshletBuilder::CullStats stats;
+		const double seconds = bench::bestOf(3, [&] {
+			stats = MeshletBuilder::CullStats();
+			for (const Float3& camera : cameras) {
+				ranges.clear();
+				for (unsigned int chunk = 0; chunk < meshlets.chunks.size(); ++chunk)
+					MeshletBuilder::cull(meshlets, chunk, camera, gap, ranges, &stats);
+				bench::keep(ranges.size());
+			}
+		});
+		printf("  cone cull, gap %3u: %7.3f ms per camera (%6.1f Mmeshlets/s), %5.1f%% triangles culled, %7.1f draws per camera\n",
+			gap, seconds * 1e3 / cameraCount, stats.meshletsTested / seconds * 1e-6,
+			100.0 * stats.trianglesCulled / stats.trianglesTested, (double)stats.ranges / cameraCount);
+	}
+
+	uint64_t back = 0;
+	const double triangleSeconds = bench::bestOf(1, [&] {
+		back = 0;
+		for (const Float3& camera : cameras)
+			back += backFacing(mesh, camera);
+	});
+	printf("  per triangle      : %7.3f ms per camera, %5.1f%% triangles back-facing\n", triangleSeconds * 1e3 / cameraCount,
+		100.0 * back / ((double)triangles * cameraCount));
+	return 0;
+}
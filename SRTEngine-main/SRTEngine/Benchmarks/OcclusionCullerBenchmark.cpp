@@ -0,0 +1,100 @@
+#include "OcclusionCuller.h"
+#include "BenchmarkCommon.h"
+#include <random>
+
+// Coste de OcclusionCuller en una ciudad: 256 edificios (cajas de 12 triángulos) como
+// oclusores vistos a pie de calle y 100K cajas pequeñas repartidas entre ellos. Por
+// resolución del búfer de profundidad: tiempo de rasterizar los oclusores, de construir la
+// pirámide y de probar cada caja, y qué parte de las cajas se descarta.
+// Uso: OcclusionCullerBenchmark [cajas] [edificios por lado]
+
+namespace {
+
+	struct Mesh {
+		std::vector<Float3> vertices;
+		std::vector<uint16_t> indices;
+	};
+
+	// Caja unidad de -1 a 1 con las caras hacia fuera en sentido horario (caras frontales).
+	Mesh makeBox() {
+		Mesh mesh;
+		for (int i = 0; i < 8; ++i)
+			mesh.vertices.push_back(Float3(i & 1 ? 1.0f : -1.0f, i & 2 ? 1.0f : -1.0f, i & 4 ? 1.0f : -1.0f));
+		const uint16_t faces[6][4] = {
+			{ 0, 2, 3, 1 }, { 4, 5, 7, 6 }, { 0, 1, 5, 4 }, { 2, 6, 7, 3 }, { 0, 4, 6, 2 }, { 1, 3, 7, 5 },
+		};
+		for (const uint16_t* face : faces) {
+			// Si la normal de (a, b, c) apunta hacia dentro se invierte el orden.
+			const Float3& a = mesh.vertices[face[0]];
+			const Float3& b = mesh.vertices[face[1]];
+			const Float3& c = mesh.vertices[face[2]];
+			const Float3 u(b.x - a.x, b.y - a.y, b.z - a.z), v(c.x - a.x, c.y - a.y, c.z - a.z);
+			const Float3 normal(u.y * v.z - u.z * v.y, u.z * v.x - u.x * v.z, u.x * v.y - u.y * v.x);
+			const float outward = normal.x * (a.x + c.x) + normal.y * (a.y + c.y) + normal.z * (a.z + c.z);
+			const uint16_t quad[6] = { face[0], face[1], face[2], face[0], face[2], face[3] };
+			for (int i = 0; i < 6; ++i)
+				mesh.indices.push_back(outward > 0.0f ? quad[i] : quad[i % 3 == 1 ? i + 1 : i % 3 == 2 ? i - 1 : i]);
+		}
+		return mesh;
+	}
+}
+
+int
+main(int argc, char** argv) {
+	const unsigned int count = bench::argument(argc, argv, 1, 100000);
+	const unsigned int side = std::max(1u, bench::argument(argc, argv, 2, 16));
+	const int repetitions = 10;
+
+	// Edificios en una cuadrícula de 20 m con calles de 6 m; la cámara mira por una calle.
+	const Mesh box = makeBox();
+	std::mt19937 random(5);
+	std::vector<Matrix> buildings;
+	for (unsigned int z = 0; z < side; ++z) {
+		for (unsigned int x = 0; x < side; ++x) {
+			const float height = 10.0f + (float)(random() % 30);
+			buildings.push_back(MatrixMultiply(MatrixScaling(7.0f, height * 0.5f, 7.0f),
+				MatrixTranslation(((float)x - side * 0.5f) * 20.0f + 10.0f, height * 0.5f, (float)z * 20.0f + 10.0f)));
+		}
+	}
+	BoundingBoxes boxes;
+	std::uniform_real_distribution<float> across(-(float)side * 10.0f, (float)side * 10.0f);
+	std::uniform_real_distribution<float> along(0.0f, (float)side * 20.0f);
+	std::uniform_real_distribution<float> size(0.2f, 1.5f);
+	for (unsigned int i = 0; i < count; ++i)
+		boxes.add(Float3(across(random), size(random), along(random)), Float3(size(random), size(random), size(random)));
+	const Matrix view = MatrixLookAtLH(VectorSet(3.0f, 1.8f, -5.0f, 1.0f), VectorSet(0.0f, 4.0f, 100.0f, 1.0f),
+		VectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+	const Matrix projection = MatrixPerspectiveFovLH(MATH_PIDIV4, 16.0f / 9.0f, 0.1f, 1000.0f);
+
+	printf("OcclusionCuller, %u occluders (%u triangles), %u boxes\n", (unsigned int)buildings.size(),
+		(unsigned int)(buildings.size() * box.indices.size() / 3), count);
+	const unsigned int resolutions[][2] = { { 256, 128 }, { 512, 256 }, { 1024, 512 } };
+	for (const unsigned int* resolution : resolutions) {
+		OcclusionCuller culler;
+		culler.init(resolution[0], resolution[1]);
+		const double rasterSeconds = bench::bestOf(repetitions, [&] {
+			culler.beginFrame(view, projection);
+			for (const Matrix& world : buildings) {
+				culler.addOccluder(box.vertices.data(), sizeof(Float3), (unsigned int)box.vertices.size(),
+					box.indices.data(), (unsigned int)box.indices.size(), world);
+			}
+		});
+		const double pyramidSeconds = bench::bestOf(repetitions, [&] {
+			culler.finishOccluders();
+		});
+		const unsigned int rasterized = culler.getStats().rasterizedTriangles;
+
+		std::vector<uint32_t> all(count), visible;
+		for (unsigned int i = 0; i < count; ++i)
+			all[i] = i;
+		const double testSeconds = bench::bestOf(repetitions, [&] {
+			visible = all;
+			culler.cullBoxes(boxes, visible);
+		});
+		printf("  %4ux%-4u: raster %7.3f ms (%u triangles), pyramid %6.3f ms, test %6.1f ns per box, %5.1f%% culled\n",
+			resolution[0], resolution[1], rasterSeconds * 1e3, rasterized, pyramidSeconds * 1e3,
+			testSeconds * 1e9 / std::max(1u, count), 100.0 * (count - visible.size()) / std::max(1u, count));
+		culler.destroy();
+	}
+	return 0;
+}
@@ -0,0 +1,77 @@
+#include "SRTMath.h"
+#include "BenchmarkCommon.h"
+#include <random>
+#include <vector>
+
+// Nanosegundos por operación de SRTMath. Para comparar caminos se compila el mismo
+// benchmark con -DSRT_MATH_SCALAR=ON y con -DSRT_ENABLE_AVX2=ON.
+// Uso: SRTMathBenchmark [elementos]
+
+int
+main(int argc, char** argv) {
+	const unsigned int count = bench::argument(argc, argv, 1, 100000);
+	const int repetitions = 10;
+
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> value(-2.0f, 2.0f);
+	std::vector<Matrix> matrices(count), products(count);
+	std::vector<Float3> points(count);
+	std::vector<Float4> transformed(count);
+	std::vector<Float3> coords(count);
+	for (unsigned int i = 0; i < count; ++i) {
+		float m[16];
+		for (float& f : m)
+			f = value(random);
+		matrices[i] = MatrixLoad(m);
+		points[i] = Float3(value(random), value(random), value(random));
+	}
+	const Matrix m = MatrixMultiply(MatrixRotationY(0.3f), MatrixPerspectiveFovLH(MATH_PIDIV4, 1.2f, 0.1f, 100.0f));
+
+#if defined(SRT_MATH_SCALAR)
+	printf("SRTMath scalar, %u elements\n", count);
+#elif defined(SRT_SIMD_AVX2)
+	printf("SRTMath SSE2 + AVX2 streams, %u elements\n", count);
+#else
+	printf("SRTMath SSE2, %u elements\n", count);
+#endif
+
+	auto report = [&](const char* name, double seconds) {
+		printf("  %-28s %7.2f ns\n", name, seconds * 1e9 / count);
+	};
+
+	report("MatrixMultiply", bench::bestOf(repetitions, [&] {
+		for (unsigned int i = 0; i < count; ++i)
+			products[i] = MatrixMultiply(matrices[i], m);
+		bench::keep(products[0]);
+	}));
+	report("MatrixMultiplyStream", bench::bestOf(repetitions, [&] {
+		MatrixMultiplyStream(products.data(), matrices.data(), count, m);
+		bench::keep(products[0]);
+	}));
+	report("MatrixInverse", bench::bestOf(repetitions, [&] {
+		for (unsigned int i = 0; i < count; ++i)
+			products[i] = MatrixInverse(matrices[i]);
+		bench::keep(products[0]);
+	}));
+	report("Vector3Transform", bench::bestOf(repetitions, [&] {
+		for (unsigned int i = 0; i < count; ++i)
+			VectorStore(transformed[i], Vector3Transform(VectorLoad(points[i]), m));
+		bench::keep(transformed[0]);
+	}));
+	report("Vector3TransformStream", bench::bestOf(repetitions, [&] {
+		Vector3TransformStream(transformed.data(), sizeof(Float4), points.data(), sizeof(Float3), count, m);
+		bench::keep(transformed[0]);
+	}));
+	report("Vector3TransformCoordStream", bench::bestOf(repetitions, [&] {
+		Vector3TransformCoordStream(coords.data(), sizeof(Float3), points.data(), sizeof(Float3), count, m);
+		bench::keep(coords[0]);
+	}));
+	report("QuaternionSlerp", bench::bestOf(repetitions, [&] {
+		const Vector q0 = QuaternionRotationAxis(VectorSet(0.0f, 1.0f, 0.0f, 0.0f), 0.3f);
+		const Vector q1 = QuaternionRotationAxis(VectorSet(1.0f, 0.0f, 0.0f, 0.0f), 2.0f);
+		for (unsigned int i = 0; i < count; ++i)
+			VectorStore(transformed[i], QuaternionSlerp(q0, q1, (float)i / count));
+		bench::keep(transformed[0]);
+	}));
+	return 0;
+}
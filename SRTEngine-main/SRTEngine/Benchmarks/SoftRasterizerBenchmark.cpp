@@ -0,0 +1,131 @@
+#include "SoftRasterizer.h"
+#include "InstanceBatcher.h"
+#include "BenchmarkCommon.h"
+#include <cstring>
+#include <thread>
+
+// Frame completo del rasterizador por software a 1200x1010 (el tamaño de la ventana de la demo)
+// con 1..N hilos: una rejilla con relieve instanciada en un campo de objetos que se solapan.
+// Se informa de triángulos por segundo (enviados, transformación y binning incluidos) y de
+// píxeles por segundo (los que pasan la prueba de profundidad, durante la rasterización).
+// Uso: SoftRasterizerBenchmark [instancias] [quads por lado] [hilos máximos]
+
+namespace {
+
+	const unsigned int WIDTH = 1200;
+	const unsigned int HEIGHT = 1010;
+
+	struct Vertex {
+		Float3 position;
+		Float2 uv;
+	};
+
+	void store(SoftBuffer& buffer, const void* data, size_t size) {
+		buffer.m_data.resize(size);
+		memcpy(buffer.m_data.data(), data, size);
+	}
+
+	void storeTransposed(SoftBuffer& buffer, const Matrix& m) {
+		const Matrix transposed = MatrixTranspose(m);
+		store(buffer, &transposed, sizeof(transposed));
+	}
+}
+
+int
+main(int argc, char** argv) {
+	const unsigned int instanceCount = bench::argument(argc, argv, 1, 400);
+	const unsigned int quads = std::min(bench::argument(argc, argv, 2, 32), 255u);
+	const unsigned int maxThreads = bench::argument(argc, argv, 3, std::max(1u, std::thread::hardware_concurrency()));
+	const int repetitions = 5;
+
+	// Rejilla de quads x quads en [-1, 1] con relieve.
+	std::vector<Vertex> vertices;
+	std::vector<uint16_t> indices;
+	for (unsigned int y = 0; y <= quads; ++y) {
+		for (unsigned int x = 0; x <= quads; ++x) {
+			const float u = (float)x / quads;
+			const float v = (float)y / quads;
+			const float px = u * 2.0f - 1.0f;
+			const float py = 1.0f - v * 2.0f;
+			vertices.push_back({ Float3(px, py, 0.2f * std::sin(4.0f * px) * std::cos(4.0f * py)), Float2(u, v) });
+		}
+	}
+	for (unsigned int y = 0; y < quads; ++y) {
+		for (unsigned int x = 0; x < quads; ++x) {
+			const uint16_t i = (uint16_t)(y * (quads + 1) + x);
+			const uint16_t row = (uint16_t)(quads + 1);
+			const uint16_t quad[6] = { i, (uint16_t)(i + 1), (uint16_t)(i + row + 1),
+				i, (uint16_t)(i + row + 1), (uint16_t)(i + row) };
+			indices.insert(indices.end(), quad, quad + 6);
+		}
+	}
+
+	// Campo de instancias delante de la cámara, girando cada una sobre sí misma.
+	std::vector<InstanceData> instances(instanceCount);
+	const unsigned int side = (unsigned int)std::ceil(std::sqrt((float)instanceCount));
+	for (unsigned int i = 0; i < instanceCount; ++i) {
+		const float x = ((float)(i % side) / side - 0.5f) * 12.0f;
+		const float y = ((float)(i / side) / side - 0.5f) * 10.0f;
+		const Matrix world = MatrixMultiply(MatrixRotationY(0.37f * i),
+			MatrixTranslation(x, y, 2.0f + 0.05f * (i % 7)));
+		for (int row = 0; row < 4; ++row)
+			VectorStore(instances[i].world[row], world.r[row]);
+		instances[i].color = Float4(0.5f + 0.5f * ((i >> 0) & 1), 0.5f + 0.5f * ((i >> 1) & 1), 0.5f + 0.5f * ((i >> 2) & 1), 1.0f);
+	}
+
+	SoftBuffer vertexBuffer, indexBuffer, instanceBuffer, view, projection;
+	store(vertexBuffer, vertices.data(), vertices.size() * sizeof(Vertex));
+	store(indexBuffer, indices.data(), indices.size() * sizeof(uint16_t));
+	store(instanceBuffer, instances.data(), instances.size() * sizeof(InstanceData));
+	storeTransposed(view, MatrixLookAtLH(VectorSet(0.0f, 0.0f, -8.0f, 1.0f),
+		VectorSet(0.0f, 0.0f, 0.0f, 1.0f), VectorSet(0.0f, 1.0f, 0.0f, 0.0f)));
+	storeTransposed(projection, MatrixPerspectiveFovLH(0.785398f, (float)WIDTH / HEIGHT, 0.1f, 100.0f));
+
+	SoftTexture texture;
+	texture.m_width = texture.m_height = 256;
+	for (unsigned int i = 0; i < 256 * 256; ++i)
+		texture.m_texels.push_back(0xFF000000u | ((i * 2654435761u) & 0x00FFFFFFu));
+
+	const unsigned int triangles = (unsigned int)(indices.size() / 3) * instanceCount;
+	printf("SoftRasterizer %ux%u, %u instances x %u triangles (%u triangles per frame)\n",
+		WIDTH, HEIGHT, instanceCount, (unsigned int)(indices.size() / 3), triangles);
+	for (unsigned int threads = 1; threads <= maxThreads; threads *= 2) {
+		SoftRasterizer rasterizer;
+		if (FAILED(rasterizer.init(WIDTH, HEIGHT, threads)))
+			return 1;
+
+		SoftInputLayout layout;
+		const SoftBuffer* vertexBuffers[2] = { &vertexBuffer, &instanceBuffer };
+		const unsigned int strides[2] = { sizeof(Vertex), sizeof(InstanceData) };
+		const unsigned int offsets[2] = { 0, 0 };
+		const SoftBuffer* constants[2] = { &view, &projection };
+		const SoftTexture* textures[1] = { &texture };
+		const float clearColor[4] = { 0.0f, 0.125f, 0.3f, 1.0f };
+		rasterizer.IASetInputLayout(&layout);
+		rasterizer.IASetVertexBuffers(0, 2, vertexBuffers, strides, offsets);
+		rasterizer.IASetIndexBuffer(&indexBuffer, SOFT_INDEX_16, 0);
+		rasterizer.VSSetConstantBuffers(0, 2, constants);
+		rasterizer.PSSetShaderResources(0, 1, textures);
+
+		SoftRasterizer::Stats stats;
+		double setupSeconds = 1e30, rasterSeconds = 1e30;
+		const double frameSeconds = bench::bestOf(repetitions, [&] {
+			rasterizer.resetStats();
+			rasterizer.ClearRenderTargetView(clearColor);
+			rasterizer.ClearDepthStencilView(1.0f);
+			rasterizer.DrawIndexedInstanced((unsigned int)indices.size(), instanceCount, 0, 0, 0);
+			rasterizer.flush();
+			stats = rasterizer.getStats();
+			setupSeconds = std::min(setupSeconds, stats.setupSeconds);
+			rasterSeconds = std::min(rasterSeconds, stats.rasterSeconds);
+		});
+		bench::keep(rasterizer.m_renderTarget.m_color[0]);
+
+		printf("  %2u threads: frame %7.2f ms (setup %6.2f, raster %6.2f), %7.1f Mtris/s, %7.1f Mpixels/s"
+			" (%llu rasterized, %llu pixels)\n", threads, frameSeconds * 1e3, setupSeconds * 1e3, rasterSeconds * 1e3,
+			stats.trianglesSubmitted / frameSeconds * 1e-6, stats.pixelsWritten / rasterSeconds * 1e-6,
+			(unsigned long long)stats.trianglesRasterized, (unsigned long long)stats.pixelsWritten);
+		rasterizer.destroy();
+	}
+	return 0;
+}
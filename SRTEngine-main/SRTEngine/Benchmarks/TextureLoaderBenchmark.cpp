@@ -0,0 +1,172 @@
+#include "TextureLoader.h"
+#include "BenchmarkCommon.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+// Carga de un directorio de PNG con TextureLoader y 1..N hilos, como lo haría el bucle del
+// juego: cada frame de 4 ms el hilo principal llama a update() con un presupuesto de bytes.
+// Para cada número de hilos: tiempo hasta tener todas las imágenes, imágenes por segundo y
+// el peor y el medio update() (lo que se roba al frame). Como referencia, la carga síncrona
+// que hacía Texture::init (stbi_load + mips en el hilo principal): tiempo total y la peor
+// imagen, que es lo que se congelaba el frame. Sin ventana update() no crea texturas, así
+// que su peor tiempo es solo el del propio cargador, sin la subida a la GPU. Sin directorio
+// se escriben imágenes de prueba (PNG sin comprimir de 256x256 con un degradado) en un
+// directorio temporal.
+// Uso: TextureLoaderBenchmark [hilos máximos] [imágenes generadas] [directorio con PNG]
+
+namespace {
+
+	const unsigned int FRAME_MS = 4;
+	const uint64_t FRAME_BUDGET = 4 << 20;
+
+	uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0) {
+		crc = ~crc;
+		for (size_t i = 0; i < size; ++i) {
+			crc ^= data[i];
+			for (int bit = 0; bit < 8; ++bit)
+				crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+		}
+		return ~crc;
+	}
+
+	void putBig32(std::vector<uint8_t>& out, uint32_t value) {
+		for (int shift = 24; shift >= 0; shift -= 8)
+			out.push_back((uint8_t)(value >> shift));
+	}
+
+	void writeChunk(std::ofstream& file, const char* type, const std::vector<uint8_t>& data) {
+		std::vector<uint8_t> chunk;
+		putBig32(chunk, (uint32_t)data.size());
+		chunk.insert(chunk.end(), type, type + 4);
+		chunk.insert(chunk.end(), data.begin(), data.end());
+		putBig32(chunk, crc32(chunk.data() + 4, chunk.size() - 4));
+		file.write((const char*)chunk.data(), chunk.size());
+	}
+
+	// PNG RGBA8 con filas de filtro Sub y zlib en bloques sin comprimir.
+	void writePng(const std::string& fileName, unsigned int size, unsigned int seed) {
+		std::vector<uint8_t> raw;
+		for (unsigned int y = 0; y < size; ++y) {
+			raw.push_back(1);
+			uint8_t previous[4] = {};
+			for (unsigned int x = 0; x < size; ++x) {
+				const uint8_t pixel[4] = { (uint8_t)(x + seed), (uint8_t)(y * 3 + seed), (uint8_t)((x ^ y) + seed * 7), 255 };
+				for (int c = 0; c < 4; ++c) {
+					raw.push_back((uint8_t)(pixel[c] - previous[c]));
+					previous[c] = pixel[c];
+				}
+			}
+		}
+		std::vector<uint8_t> zlib = { 0x78, 0x01 };
+		for (size_t offset = 0; offset < raw.size(); offset += 65535) {
+			const size_t length = std::min<size_t>(65535, raw.size() - offset);
+			zlib.push_back(offset + length == raw.size() ? 1 : 0);
+			zlib.push_back((uint8_t)length);
+			zlib.push_back((uint8_t)(length >> 8));
+			zlib.push_back((uint8_t)~length);
+			zlib.push_back((uint8_t)(~length >> 8));
+			zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + length);
+		}
+		uint32_t a = 1, b = 0;
+		for (uint8_t value : raw) {
+			a = (a + value) % 65521;
+			b = (b + a) % 65521;
+		}
+		putBig32(zlib, (b << 16) | a);
+
+		std::vector<uint8_t> header;
+		putBig32(header, size);
+		putBig32(header, size);
+		header.insert(header.end(), { 8, 6, 0, 0, 0 });
+		std::ofstream file(fileName, std::ios::binary);
+		file.write("\x89PNG\r\n\x1a\n", 8);
+		writeChunk(file, "IHDR", header);
+		writeChunk(file, "IDAT", zlib);
+		writeChunk(file, "IEND", {});
+	}
+}
+
+int
+main(int argc, char** argv) {
+	const unsigned int maxThreads = std::max(1u, bench::argument(argc, argv, 1, std::max(1u, std::thread::hardware_concurrency())));
+	const unsigned int generated = std::max(1u, bench::argument(argc, argv, 2, 300));
+
+	namespace fs = std::filesystem;
+	fs::path directory;
+	bool temporary = false;
+	if (argc > 3) {
+		directory = argv[3];
+	}
+	else {
+		directory = fs::temp_directory_path() / "TextureLoaderBenchmark";
+		fs::create_directories(directory);
+		temporary = true;
+		for (unsigned int i = 0; i < generated; ++i)
+			writePng((directory / ("image" + std::to_string(i) + ".png")).string(), 256, i);
+	}
+	std::vector<std::string> files;
+	for (const fs::directory_entry& entry : fs::directory_iterator(directory)) {
+		if (entry.is_regular_file() && entry.path().extension() == ".png")
+			files.push_back(entry.path().string());
+	}
+	std::sort(files.begin(), files.end());
+	if (files.empty()) {
+		printf("No PNG files in %s\n", directory.string().c_str());
+		return 1;
+	}
+
+	// Referencia: todo en el hilo principal, como Texture::init.
+	double syncSeconds = 0.0, worstImage = 0.0;
+	uint64_t bytes = 0;
+	for (const std::string& file : files) {
+		const double start = bench::now();
+		int width = 0, height = 0, channels = 0;
+		unsigned char* pixels = stbi_load(file.c_str(), &width, &height, &channels, 4);
+		if (pixels) {
+			std::vector<MipLevel> levels;
+			MipGenerator::Options options;
+			options.threadCount = 1;
+			MipGenerator::generate(pixels, (unsigned int)width, (unsigned int)height, options, levels);
+			for (const MipLevel& level : levels)
+				bytes += level.pixels.size();
+			stbi_image_free(pixels);
+		}
+		const double seconds = bench::now() - start;
+		syncSeconds += seconds;
+		worstImage = std::max(worstImage, seconds);
+	}
+	printf("TextureLoader, %u PNG files from %s, %.1f MB with mips, %u ms frames with a %llu KB budget\n",
+		(unsigned int)files.size(), directory.string().c_str(), bytes / 1048576.0, FRAME_MS,
+		(unsigned long long)(FRAME_BUDGET >> 10));
+	printf("  synchronous : %8.1f ms, %7.1f images/s, worst stall %7.2f ms (one image)\n",
+		syncSeconds * 1e3, files.size() / syncSeconds, worstImage * 1e3);
+
+	for (unsigned int threads = 1; threads <= maxThreads; threads *= 2) {
+		TextureLoader loader;
+		loader.init(threads);
+		const double start = bench::now();
+		for (const std::string& file : files)
+			loader.load(file);
+		unsigned int frames = 0;
+		double updateSeconds = 0.0;
+		while (!loader.isIdle()) {
+			loader.update(nullptr, FRAME_BUDGET);
+			updateSeconds += loader.getStats().lastUpdateSeconds;
+			++frames;
+			std::this_thread::sleep_for(std::chrono::milliseconds(FRAME_MS));
+		}
+		const double seconds = bench::now() - start;
+		const TextureLoader::Stats stats = loader.getStats();
+		printf("  %2u threads  : %8.1f ms, %7.1f images/s, worst stall %7.3f ms, average update %6.3f ms, %u frames, %u failed\n",
+			threads, seconds * 1e3, files.size() / seconds, stats.worstUpdateSeconds * 1e3,
+			updateSeconds * 1e3 / std::max(1u, frames), frames, stats.failed);
+		loader.destroy();
+	}
+
+	if (temporary)
+		fs::remove_all(directory);
+	return 0;
+}
@@ -0,0 +1,152 @@
+#include "TransformHierarchy.h"
+#include "BenchmarkCommon.h"
+#include <memory>
+#include <random>
+#include <thread>
+
+// Actualización de matrices de mundo de una escena de 100K nodos: la jerarquía clásica de
+// objetos (cada nodo reservado por separado, con sus hijos en un vector y recorrido
+// recursivo desde las raíces) contra TransformHierarchy (arrays por campo ordenados por
+// profundidad) en un hilo y con 1..N hilos del JobSystem. Con todos los nodos sucios y con
+// un 1 % de nodos cambiados por fotograma.
+// Uso: TransformHierarchyBenchmark [nodos] [hilos máximos]
+
+namespace {
+
+	// Nodo de la jerarquía por objetos; la marca de sucio se propaga al recorrer.
+	struct ObjectNode {
+		Float3 position = Float3(0.0f, 0.0f, 0.0f);
+		Float4 rotation = Float4(0.0f, 0.0f, 0.0f, 1.0f);
+		Float3 scale = Float3(1.0f, 1.0f, 1.0f);
+		bool dirty = true;
+		Matrix world = MatrixIdentity();
+		std::vector<ObjectNode*> children;
+	};
+
+	unsigned int updateObjects(ObjectNode& node, const Matrix* parentWorld, bool parentDirty) {
+		const bool dirty = node.dirty || parentDirty;
+		unsigned int updated = 0;
+		if (dirty) {
+			const Matrix local = MatrixScaleRotationTranslation(VectorLoad(node.scale),
+				VectorLoad(node.rotation), VectorLoad(node.position));
+			node.world = parentWorld ? MatrixMultiply(local, *parentWorld) : local;
+			node.dirty = false;
+			updated = 1;
+		}
+		for (ObjectNode* child : node.children)
+			updated += updateObjects(*child, &node.world, dirty);
+		return updated;
+	}
+
+	struct Shape {
+		std::vector<uint32_t> parents; ///< Padre de cada nodo (~0u en las raíces); padres antes que hijos.
+		std::vector<Float3> positions;
+		std::vector<Float4> rotations;
+	};
+
+	// Árboles de 8 niveles; cada nodo cuelga de un nodo al azar del nivel anterior, como al
+	// cargar varias escenas: los hijos de un nodo no quedan juntos en memoria.
+	Shape makeShape(unsigned int count) {
+		std::mt19937 random(42);
+		Shape shape;
+		const unsigned int roots = std::max(1u, count / 1000);
+		const unsigned int perLevel = (count - roots) / 7 + 1;
+		unsigned int previousBegin = 0, previousEnd = 0, levelEnd = roots;
+		for (unsigned int i = 0; i < count; ++i) {
+			if (i == levelEnd) {
+				previousBegin = previousEnd;
+				previousEnd = levelEnd;
+				levelEnd = std::min(count, levelEnd + perLevel);
+			}
+			shape.parents.push_back(previousEnd == 0 ? ~0u : previousBegin + (uint32_t)(random() % (previousEnd - previousBegin)));
+			shape.positions.push_back(Float3((float)(random() % 100) * 0.1f, 1.0f, (float)(random() % 100) * 0.1f));
+			const float angle = (float)(random() % 628) * 0.01f;
+			shape.rotations.push_back(Float4(0.0f, std::sin(angle * 0.5f), 0.0f, std::cos(angle * 0.5f)));
+		}
+		return shape;
+	}
+}
+
+int
+main(int argc, char** argv) {
+	const unsigned int count = std::max(1000u, bench::argument(argc, argv, 1, 100000));
+	const unsigned int maxThreads = bench::argument(argc, argv, 2, std::max(1u, std::thread::hardware_concurrency()));
+	const int repetitions = 10;
+	const Shape shape = makeShape(count);
+	const unsigned int changed = count / 100;
+	std::vector<uint32_t> changedNodes(changed);
+	std::mt19937 random(7);
+	for (uint32_t& node : changedNodes)
+		node = (uint32_t)(random() % count);
+
+	printf("TransformHierarchy, %u nodes, %u changed per frame in the partial update\n", count, changed);
+
+	// Objetos reservados uno a uno, en el orden en que se crean.
+	std::vector<std::unique_ptr<ObjectNode>> objects(count);
+	std::vector<ObjectNode*> roots;
+	for (unsigned int i = 0; i < count; ++i) {
+		objects[i] = std::make_unique<ObjectNode>();
+		objects[i]->position = shape.positions[i];
+		objects[i]->rotation = shape.rotations[i];
+		if (shape.parents[i] == ~0u)
+			roots.push_back(objects[i].get());
+		else
+			objects[shape.parents[i]]->children.push_back(objects[i].get());
+	}
+	unsigned int updated = 0;
+	const double objectFull = bench::bestOf(repetitions, [&] {
+		for (const std::unique_ptr<ObjectNode>& object : objects)
+			object->dirty = true;
+		updated = 0;
+		for (ObjectNode* root : roots)
+			updated += updateObjects(*root, nullptr, false);
+	});
+	const unsigned int objectFullNodes = updated;
+	const double objectPartial = bench::bestOf(repetitions, [&] {
+		for (uint32_t node : changedNodes)
+			objects[node]->dirty = true;
+		updated = 0;
+		for (ObjectNode* root : roots)
+			updated += updateObjects(*root, nullptr, false);
+	});
+	printf("  objects (AoS, recursive) : full %8.3f ms (%u nodes), partial %8.3f ms (%u nodes)\n",
+		objectFull * 1e3, objectFullNodes, objectPartial * 1e3, updated);
+
+	for (unsigned int threads = 0; threads <= maxThreads; threads = threads ? threads * 2 : 1) {
+		JobSystem jobs;
+		if (threads > 0)
+			jobs.init(threads);
+		TransformHierarchy hierarchy;
+		hierarchy.init(threads > 0 ? &jobs : nullptr);
+		std::vector<TransformHierarchy::Node> nodes(count);
+		for (unsigned int i = 0; i < count; ++i) {
+			nodes[i] = hierarchy.createNode(shape.parents[i] == ~0u ? TransformHierarchy::INVALID_NODE : nodes[shape.parents[i]]);
+			hierarchy.setLocal(nodes[i], shape.positions[i], shape.rotations[i], Float3(1.0f, 1.0f, 1.0f));
+		}
+		hierarchy.update();
+
+		const double full = bench::bestOf(repetitions, [&] {
+			for (unsigned int i = 0; i < count; ++i)
+				hierarchy.setPosition(nodes[i], shape.positions[i]);
+			hierarchy.update();
+		});
+		const unsigned int fullNodes = hierarchy.getStats().updatedNodes;
+		const double partial = bench::bestOf(repetitions, [&] {
+			for (uint32_t node : changedNodes)
+				hierarchy.setPosition(nodes[node], shape.positions[node]);
+			hierarchy.update();
+		});
+		bench::keep(hierarchy.getWorldMatrices()[0]);
+		if (threads == 0)
+			printf("  SoA, no JobSystem        : ");
+		else
+			printf("  SoA, %2u threads          : ", threads);
+		printf("full %8.3f ms (%u nodes, %.2fx objects), partial %8.3f ms (%u nodes, %.2fx objects)\n",
+			full * 1e3, fullNodes, objectFull / full, partial * 1e3, hierarchy.getStats().updatedNodes,
+			objectPartial / partial);
+		hierarchy.destroy();
+		if (threads > 0)
+			jobs.destroy();
+	}
+	return 0;
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class ArchiveWriter
+ * @brief Empaqueta archivos en el formato que lee AssetArchive.
+ *
+ * Se añaden las entradas (desde disco o desde memoria) y write() escribe el archivo
+ * completo. Una entrada marcada para comprimir se guarda en LZ4 solo si ocupa al menos
+ * un 10 % menos; si no, se guarda tal cual y se puede leer sin copias.
+ */
+class ArchiveWriter {
+public:
+    /**
+     * @brief Añade un archivo del disco; se lee en write().
+     * @param name Nombre con el que se buscará en el archivo.
+     */
+    void addFile(const std::string& name, const std::string& sourcePath, bool compress);
+
+    /// Añade una entrada con datos en memoria (se copian).
+    void addMemory(const std::string& name, const uint8_t* data, size_t size, bool compress);
+
+    /**
+     * @brief Escribe el archivo. Falla si algún origen no se puede leer o hay nombres repetidos.
+     */
+    HRESULT write(const std::string& fileName) const;
+
+    void clear() { m_sources.clear(); }
+
+private:
+    struct Source {
+        std::string name;
+        std::string path;          ///< Vacío si los datos están en memoria.
+        std::vector<uint8_t> data;
+        bool compress = false;
+    };
+
+    std::vector<Source> m_sources;
+};
@@ -0,0 +1,100 @@
+#pragma once
+#include "Prerequisites.h"
+#include "MappedFile.h"
+
+/**
+ * @class AssetArchive
+ * @brief Lector del archivo empaquetado de recursos (.pak) escrito por ArchiveWriter.
+ *
+ * Formato (little-endian):
+ *  - Cabecera de 32 bytes: "SRTA", versión, número de entradas, reservado,
+ *    desplazamiento y tamaño de la tabla de contenidos.
+ *  - Datos de cada entrada, alineados a 64 bytes (guardados tal cual o en bloque LZ4).
+ *  - Tabla de contenidos al final: un registro de 48 bytes por entrada, ordenados por el
+ *    hash del nombre, seguidos de los nombres.
+ *
+ * El archivo se proyecta en memoria entero y la tabla se consulta en el sitio (búsqueda
+ * binaria por hash), así que abrirlo no lee ni reserva nada más. Las entradas sin
+ * comprimir se sirven con view() como punteros a la proyección, sin copias.
+ *
+ * Los nombres no distinguen '/' de '\\'. Es seguro leer desde varios hilos a la vez.
+ */
+class AssetArchive {
+public:
+    AssetArchive() = default;
+    ~AssetArchive() = default;
+
+    AssetArchive(const AssetArchive&) = delete;
+    AssetArchive& operator=(const AssetArchive&) = delete;
+
+    /**
+     * @brief Proyecta el archivo y valida la cabecera y la tabla de contenidos.
+     */
+    HRESULT open(const std::string& fileName);
+
+    void close();
+
+    bool isOpen() const { return m_file.isOpen(); }
+
+    unsigned int getEntryCount() const { return m_entryCount; }
+
+    bool contains(const std::string& name) const;
+
+    /**
+     * @brief Puntero a los datos de una entrada guardada sin comprimir.
+     * @return nullptr si la entrada no existe o está comprimida (usar read()).
+     * Válido mientras el archivo siga abierto.
+     */
+    const uint8_t* view(const std::string& name, size_t& size) const;
+
+    /**
+     * @brief Copia (o descomprime) una entrada en data.
+     */
+    HRESULT read(const std::string& name, std::vector<uint8_t>& data) const;
+
+    /// Hash con el que se ordena la tabla (FNV-1a de 64 bits del nombre normalizado).
+    static uint64_t hashName(const std::string& name);
+
+    /// Nombre con '/' como separador, que es como se guarda.
+    static std::string normalizeName(const std::string& name);
+
+    enum Compression {
+        COMPRESSION_NONE = 0,
+        COMPRESSION_LZ4 = 1
+    };
+
+    static const uint32_t MAGIC = 0x41545253; // "SRTA"
+    static const uint32_t VERSION = 1;
+    static const unsigned int ALIGNMENT = 64;
+
+    /// Cabecera al principio del archivo.
+    struct Header {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t entryCount;
+        uint32_t reserved;
+        uint64_t tocOffset;
+        uint64_t tocSize;
+    };
+
+    /// Registro de la tabla de contenidos.
+    struct TocEntry {
+        uint64_t nameHash;
+        uint64_t offset;      ///< Desde el principio del archivo.
+        uint64_t storedSize;  ///< Bytes en el archivo.
+        uint64_t size;        ///< Bytes una vez descomprimida.
+        uint32_t nameOffset;  ///< Desde el principio de los nombres.
+        uint32_t nameLength;
+        uint32_t compression;
+        uint32_t reserved;
+    };
+
+private:
+    const TocEntry* find(const std::string& name) const;
+
+private:
+    MappedFile m_file;
+    const TocEntry* m_toc = nullptr;
+    const char* m_names = nullptr;
+    unsigned int m_entryCount = 0;
+};
@@ -1,37 +1,48 @@
 #pragma once
 #include "Prerequisites.h"
 #include "Window.h"
+#include "FramePipeline.h"
 
 /**
  * @brief Clase base para la aplicacin.
  *
  * Maneja la inicializacin, actualizacin, renderizado y cierre de la aplicacin.
+ *
+ * update() y render() no se llaman seguidos: update() corre en el hilo de simulacin de
+ * un FramePipeline y simula el frame N+1 mientras el hilo principal dibuja el N con
+ * render(). Cada frame deja sus datos (transformaciones, constantes, visibles) en uno de
+ * m_framesInFlight huecos que la clase derivada reserva; ambos mtodos reciben el ndice
+ * del hueco que les toca.
  */
 class BaseApp {
 public:
     BaseApp() = default;
-    ~BaseApp() = default;
+    virtual ~BaseApp() = default;
 
     /**
      * @brief Inicializa la aplicacin.
      * @return HRESULT Indica si la inicializacin fue exitosa.
      */
-    HRESULT init();
+    virtual HRESULT init();
 
     /**
      * @brief Actualiza el estado de la aplicacin.
+     *
+     * Se llama desde el hilo de simulacin: no debe usar el contexto de dispositivo.
+     * @param frameSlot Hueco en el que se escriben los datos del frame.
      */
-    void update();
+    virtual void update(unsigned int frameSlot);
 
     /**
      * @brief Renderiza los elementos de la aplicacin.
+     * @param frameSlot Hueco con los datos del frame ya simulado.
      */
-    void render();
+    virtual void render(unsigned int frameSlot);
 
     /**
      * @brief Libera los recursos utilizados.
      */
-    void destroy();
+    virtual void destroy();
 
     /**
      * @brief Ejecuta la aplicacin.
@@ -49,6 +60,10 @@ public:
         int nCmdShow,
         WNDPROC wndproc);
 
+protected:
+    unsigned int m_framesInFlight = 2; ///< Huecos de datos de frame (1 = sin solapar).
+
 private:
     Window m_window; ///< Maneja la ventana de la aplicacin.
+    FramePipeline m_framePipeline; ///< Hilo de simulacin y reparto de huecos.
 };
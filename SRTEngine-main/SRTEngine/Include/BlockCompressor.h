@@ -0,0 +1,95 @@
+#pragma once
+#include "Prerequisites.h"
+#include "MipGenerator.h"
+
+/// Formatos de compresión por bloques 4x4.
+enum BCFormat {
+    BC_FORMAT_NONE = 0, ///< Sin comprimir (RGBA8).
+    BC_FORMAT_BC1,      ///< RGB 565 + alfa de 1 bit, 8 bytes por bloque.
+    BC_FORMAT_BC3,      ///< BC1 para el color + BC4 para el alfa, 16 bytes por bloque.
+    BC_FORMAT_BC4,      ///< Un canal (R), 8 bytes por bloque.
+    BC_FORMAT_BC5,      ///< Dos canales (R, G) para mapas de normales, 16 bytes por bloque.
+    BC_FORMAT_BC7       ///< RGBA de alta calidad, 16 bytes por bloque.
+};
+
+/// Nivel de esfuerzo del codificador.
+enum BCQuality {
+    BC_QUALITY_FAST = 0, ///< Un eje principal y extremos con recorte, sin refinar.
+    BC_QUALITY_NORMAL,   ///< Refinado por mínimos cuadrados de los extremos.
+    BC_QUALITY_SLOW      ///< Además búsqueda local de extremos y, en BC7, particiones de 2 subconjuntos.
+};
+
+/**
+ * @brief Un nivel comprimido: bloques en orden de filas, ceil(width/4) x ceil(height/4).
+ */
+struct CompressedLevel {
+    unsigned int width = 0;
+    unsigned int height = 0;
+    std::vector<uint8_t> blocks;
+};
+
+/**
+ * @class BlockCompressor
+ * @brief Codificador y decodificador BC1/BC3/BC4/BC5/BC7 en CPU, sin dependencias de Direct3D.
+ *
+ * Cada bloque se codifica de forma independiente, así que las filas de bloques se reparten
+ * entre threadCount hilos. La asignación de índices proyecta los 16 píxeles sobre la recta
+ * entre extremos con SSE2 (4 píxeles por registro); useSimd = false usa el mismo cálculo
+ * en escalar como referencia.
+ *
+ * En BC7 el codificador emite el modo 6 (un subconjunto RGBA) y, en BC_QUALITY_SLOW, prueba
+ * también el modo 1 (dos subconjuntos RGB) en bloques opacos. El decodificador entiende
+ * todos los modos BC7 salvo los de 3 subconjuntos (0 y 2), que este codificador no genera.
+ */
+class BlockCompressor {
+public:
+    /**
+     * @brief Opciones del codificador.
+     */
+    struct Options {
+        BCQuality quality = BC_QUALITY_NORMAL;
+        unsigned int threadCount = 1; ///< Hilos (0 = núcleos disponibles).
+        bool useSimd = true;          ///< false = camino escalar de referencia.
+    };
+
+    /// Bytes por bloque 4x4 (0 para BC_FORMAT_NONE).
+    static unsigned int blockBytes(BCFormat format);
+
+    /// Bytes de una imagen width x height comprimida.
+    static size_t compressedSize(BCFormat format, unsigned int width, unsigned int height);
+
+    /**
+     * @brief Comprime una imagen RGBA8. Los bloques incompletos del borde repiten el último píxel.
+     */
+    static HRESULT encode(const uint8_t* pixels,
+        unsigned int width,
+        unsigned int height,
+        BCFormat format,
+        const Options& options,
+        std::vector<uint8_t>& blocks);
+
+    /// Comprime todos los niveles de una cadena de mips.
+    static HRESULT encodeChain(const std::vector<MipLevel>& levels,
+        BCFormat format,
+        const Options& options,
+        std::vector<CompressedLevel>& compressed);
+
+    /**
+     * @brief Descomprime a RGBA8. BC4 devuelve (R, 0, 0, 255) y BC5 (R, G, 0, 255), como la GPU.
+     */
+    static HRESULT decode(const uint8_t* blocks,
+        unsigned int width,
+        unsigned int height,
+        BCFormat format,
+        std::vector<uint8_t>& pixels);
+
+    /**
+     * @brief PSNR en dB entre dos imágenes RGBA8 sobre los canales de channelMask (bit 0 = R); 100 si son idénticas.
+     */
+    static double psnr(const uint8_t* a, const uint8_t* b, size_t pixelCount, unsigned int channelMask = 0xF);
+
+#ifdef _WIN32
+    /// Formato DXGI equivalente.
+    static DXGI_FORMAT dxgiFormat(BCFormat format);
+#endif
+};
@@ -0,0 +1,267 @@
+#pragma once
+#include "Prerequisites.h"
+#include "StateCache.h"
+#include <cstring>
+
+/**
+ * @class CommandList
+ * @brief Lista de comandos de render independiente del backend.
+ *
+ * Guarda binds, actualizaciones de constantes y draws en un único bloque de memoria
+ * contiguo (las constantes van copiadas dentro del comando), así que grabar no reserva
+ * memoria una vez que la lista alcanza su tamaño de trabajo. Cada hilo graba en su propia
+ * lista; la reproducción la hace un executor (DeviceContext, SoftRasterizer, ...) en el
+ * hilo principal.
+ *
+ * Los recursos se guardan como punteros opacos: el executor sabe a qué tipo pertenecen
+ * (ID3D11Buffer* en DeviceContext, SoftBuffer* en SoftRasterizer).
+ */
+class CommandList {
+public:
+    /// Tipos de comando grabados.
+    enum CommandType : uint16_t {
+        CMD_SET_INPUT_LAYOUT = 0,
+        CMD_SET_VERTEX_BUFFER,
+        CMD_SET_INDEX_BUFFER,
+        CMD_SET_PRIMITIVE_TOPOLOGY,
+        CMD_SET_SHADER,
+        CMD_SET_CONSTANT_BUFFER,
+        CMD_SET_CONSTANT_BUFFER_RANGE,
+        CMD_SET_SHADER_RESOURCE,
+        CMD_SET_SAMPLER,
+        CMD_SET_VIEWPORT,
+        CMD_SET_RENDER_TARGETS,
+        CMD_UPDATE_CONSTANT_BUFFER,
+        CMD_DRAW_INDEXED,
+        CMD_DRAW_INDEXED_INSTANCED
+    };
+
+    /// Ancho de los índices (se traduce a DXGI_FORMAT o SoftIndexFormat al reproducir).
+    enum IndexWidth : uint32_t {
+        INDEX_16 = 0,
+        INDEX_32 = 1
+    };
+
+    /// Viewport neutral (misma distribución que D3D11_VIEWPORT).
+    struct Viewport {
+        float TopLeftX, TopLeftY, Width, Height, MinDepth, MaxDepth;
+    };
+
+    CommandList() = default;
+    ~CommandList() = default;
+
+    /// Vacía la lista conservando la memoria reservada.
+    void reset();
+
+    void setInputLayout(const void* inputLayout);
+    void setVertexBuffer(unsigned int slot, const void* buffer, unsigned int stride, unsigned int offset);
+    void setIndexBuffer(const void* buffer, IndexWidth width, unsigned int offset);
+
+    /// @param topology Valor numérico de D3D11_PRIMITIVE_TOPOLOGY (4 = TRIANGLELIST).
+    void setPrimitiveTopology(unsigned int topology);
+
+    void setShader(StateCache::Stage stage, const void* shader);
+    void setConstantBuffer(StateCache::Stage stage, unsigned int slot, const void* buffer);
+
+    /**
+     * @brief Graba VSSetConstantBuffers1 / PSSetConstantBuffers1: un rango del búfer en
+     * constantes de 16 bytes (por ejemplo una asignación del anillo de ConstantBufferManager).
+     */
+    void setConstantBufferRange(StateCache::Stage stage, unsigned int slot, const void* buffer,
+                                unsigned int firstConstant, unsigned int numConstants);
+
+    void setShaderResource(StateCache::Stage stage, unsigned int slot, const void* view);
+    void setSampler(StateCache::Stage stage, unsigned int slot, const void* sampler);
+    void setViewport(const Viewport& viewport);
+
+    /**
+     * @brief Graba OMSetRenderTargets. Hace falta en cada lista que vaya a un contexto
+     * diferido, porque estos empiezan sin render targets.
+     */
+    void setRenderTargets(unsigned int numViews, const void* const* renderTargetViews, const void* depthStencilView);
+
+    /**
+     * @brief Graba una actualización completa de un búfer de constantes.
+     * Los datos se copian dentro de la lista, así que pSrcData puede reutilizarse enseguida.
+     */
+    void updateConstantBuffer(const void* buffer, const void* pSrcData, unsigned int size);
+
+    void drawIndexed(unsigned int indexCount, unsigned int startIndexLocation, int baseVertexLocation);
+
+    void drawIndexedInstanced(unsigned int indexCountPerInstance, unsigned int instanceCount,
+                              unsigned int startIndexLocation, int baseVertexLocation,
+                              unsigned int startInstanceLocation);
+
+    /// Número de comandos grabados.
+    unsigned int getCommandCount() const { return m_commandCount; }
+
+    /// Número de draws grabados.
+    unsigned int getDrawCount() const { return m_drawCount; }
+
+    /// Bytes ocupados por los comandos.
+    size_t getSizeInBytes() const { return m_size; }
+
+    /**
+     * @brief Reproduce los comandos en orden sobre un executor.
+     *
+     * El executor debe ofrecer setInputLayout, setVertexBuffer, setIndexBuffer,
+     * setPrimitiveTopology, setShader, setConstantBuffer, setConstantBufferRange,
+     * setShaderResource, setSampler,
+     * setViewport, setRenderTargets, updateConstantBuffer, drawIndexed y drawIndexedInstanced
+     * con los mismos parámetros que la grabación.
+     */
+    template<typename Executor>
+    void replay(Executor& executor) const;
+
+private:
+    /// Cabecera de cada comando; el tamaño incluye la cabecera y el relleno a 8 bytes.
+    struct Header {
+        CommandType type;
+        uint16_t reserved;
+        uint32_t size;
+    };
+
+    struct BindPayload {
+        uint32_t stage;
+        uint32_t slot;
+        const void* object;
+    };
+
+    struct RangePayload {
+        const void* buffer;
+        uint32_t stage;
+        uint32_t slot;
+        uint32_t firstConstant;
+        uint32_t numConstants;
+    };
+
+    struct VertexBufferPayload {
+        const void* buffer;
+        uint32_t slot;
+        uint32_t stride;
+        uint32_t offset;
+    };
+
+    struct IndexBufferPayload {
+        const void* buffer;
+        uint32_t width;
+        uint32_t offset;
+    };
+
+    struct UpdatePayload {
+        const void* buffer;
+        uint32_t size;
+    };
+
+    struct RenderTargetsPayload {
+        const void* renderTargets[8];
+        const void* depthStencil;
+        uint32_t numViews;
+    };
+
+    struct DrawPayload {
+        uint32_t indexCount;
+        uint32_t startIndexLocation;
+        int32_t baseVertexLocation;
+    };
+
+    struct DrawInstancedPayload {
+        uint32_t indexCountPerInstance;
+        uint32_t instanceCount;
+        uint32_t startIndexLocation;
+        int32_t baseVertexLocation;
+        uint32_t startInstanceLocation;
+    };
+
+    /// Reserva un comando con extraBytes adicionales tras el payload y devuelve el payload.
+    void* push(CommandType type, size_t payloadSize, size_t extraBytes = 0);
+
+    template<typename T>
+    static const T& payload(const uint8_t* command) {
+        return *reinterpret_cast<const T*>(command + sizeof(Header));
+    }
+
+private:
+    std::vector<uint8_t> m_data;
+    size_t m_size = 0;
+    unsigned int m_commandCount = 0;
+    unsigned int m_drawCount = 0;
+};
+
+template<typename Executor>
+void
+CommandList::replay(Executor& executor) const {
+    const uint8_t* command = m_data.data();
+    const uint8_t* end = command + m_size;
+    while (command < end) {
+        const Header& header = *reinterpret_cast<const Header*>(command);
+        switch (header.type) {
+        case CMD_SET_INPUT_LAYOUT:
+            executor.setInputLayout(payload<BindPayload>(command).object);
+            break;
+        case CMD_SET_VERTEX_BUFFER: {
+            const VertexBufferPayload& p = payload<VertexBufferPayload>(command);
+            executor.setVertexBuffer(p.slot, p.buffer, p.stride, p.offset);
+            break;
+        }
+        case CMD_SET_INDEX_BUFFER: {
+            const IndexBufferPayload& p = payload<IndexBufferPayload>(command);
+            executor.setIndexBuffer(p.buffer, (IndexWidth)p.width, p.offset);
+            break;
+        }
+        case CMD_SET_PRIMITIVE_TOPOLOGY:
+            executor.setPrimitiveTopology(payload<BindPayload>(command).slot);
+            break;
+        case CMD_SET_SHADER: {
+            const BindPayload& p = payload<BindPayload>(command);
+            executor.setShader((StateCache::Stage)p.stage, p.object);
+            break;
+        }
+        case CMD_SET_CONSTANT_BUFFER: {
+            const BindPayload& p = payload<BindPayload>(command);
+            executor.setConstantBuffer((StateCache::Stage)p.stage, p.slot, p.object);
+            break;
+        }
+        case CMD_SET_CONSTANT_BUFFER_RANGE: {
+            const RangePayload& p = payload<RangePayload>(command);
+            executor.setConstantBufferRange((StateCache::Stage)p.stage, p.slot, p.buffer, p.firstConstant, p.numConstants);
+            break;
+        }
+        case CMD_SET_SHADER_RESOURCE: {
+            const BindPayload& p = payload<BindPayload>(command);
+            executor.setShaderResource((StateCache::Stage)p.stage, p.slot, p.object);
+            break;
+        }
+        case CMD_SET_SAMPLER: {
+            const BindPayload& p = payload<BindPayload>(command);
+            executor.setSampler((StateCache::Stage)p.stage, p.slot, p.object);
+            break;
+        }
+        case CMD_SET_VIEWPORT:
+            executor.setViewport(payload<Viewport>(command));
+            break;
+        case CMD_SET_RENDER_TARGETS: {
+            const RenderTargetsPayload& p = payload<RenderTargetsPayload>(command);
+            executor.setRenderTargets(p.numViews, p.renderTargets, p.depthStencil);
+            break;
+        }
+        case CMD_UPDATE_CONSTANT_BUFFER: {
+            const UpdatePayload& p = payload<UpdatePayload>(command);
+            executor.updateConstantBuffer(p.buffer, command + sizeof(Header) + sizeof(UpdatePayload), p.size);
+            break;
+        }
+        case CMD_DRAW_INDEXED: {
+            const DrawPayload& p = payload<DrawPayload>(command);
+            executor.drawIndexed(p.indexCount, p.startIndexLocation, p.baseVertexLocation);
+            break;
+        }
+        case CMD_DRAW_INDEXED_INSTANCED: {
+            const DrawInstancedPayload& p = payload<DrawInstancedPayload>(command);
+            executor.drawIndexedInstanced(p.indexCountPerInstance, p.instanceCount, p.startIndexLocation,
+                p.baseVertexLocation, p.startInstanceLocation);
+            break;
+        }
+        }
+        command += header.size;
+    }
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include "Prerequisites.h"
+#include "CommandList.h"
+#include "JobSystem.h"
+#include <functional>
+
+class Device;
+class DeviceContext;
+
+/**
+ * @class CommandQueue
+ * @brief Conjunto de CommandList que se graban en paralelo y se envían en orden fijo.
+ *
+ * Cada índice de lista es una unidad de trabajo: record() reparte los índices entre los
+ * hilos del JobSystem y submit() reproduce las listas en orden de índice en el hilo que llama, de modo que el
+ * resultado no depende de qué hilo grabó qué. En Windows, submitDeferred() traduce cada
+ * lista a un ID3D11CommandList en un contexto diferido y los ejecuta en el contexto inmediato.
+ */
+class CommandQueue {
+public:
+    /**
+     * @brief Tiempos y volumen del último record()/submit().
+     */
+    struct Stats {
+        unsigned int commands = 0;  ///< Comandos grabados en todas las listas.
+        unsigned int draws = 0;     ///< Draws grabados en todas las listas.
+        double recordSeconds = 0.0; ///< Tiempo de pared de record().
+        double submitSeconds = 0.0; ///< Tiempo de pared de submit()/submitDeferred().
+    };
+
+    CommandQueue() = default;
+    ~CommandQueue() { destroy(); }
+
+    /**
+     * @brief Prepara listCount listas vacías.
+     * @param jobs Sistema de trabajos para grabar en paralelo (nullptr = en el hilo que llama).
+     */
+    HRESULT init(unsigned int listCount, JobSystem* jobs = nullptr);
+
+    /// Libera las listas y los contextos diferidos.
+    void destroy();
+
+    /**
+     * @brief Graba todas las listas en paralelo.
+     * @param recordFn Función llamada una vez por lista con (índice, lista vacía).
+     */
+    void record(const std::function<void(unsigned int, CommandList&)>& recordFn);
+
+    /**
+     * @brief Reproduce las listas en orden sobre un executor con executeCommandList(const CommandList&)
+     * (DeviceContext o SoftRasterizer).
+     */
+    template<typename Executor>
+    void submit(Executor& executor);
+
+#ifdef _WIN32
+    /**
+     * @brief Traduce cada lista a un ID3D11CommandList en paralelo (un contexto diferido por lista)
+     * y los ejecuta en orden en el contexto inmediato. Si alguna lista falla no se ejecuta
+     * ninguna, para no dejar el frame a medias.
+     */
+    HRESULT submitDeferred(Device& device, DeviceContext& immediateContext);
+#endif
+
+    CommandList& getList(unsigned int index) { return m_lists[index]; }
+    unsigned int getListCount() const { return (unsigned int)m_lists.size(); }
+    const Stats& getStats() const { return m_stats; }
+
+private:
+    /// Ejecuta job(index) para cada lista, repartidas entre los hilos del JobSystem.
+    template<typename Job>
+    void forEachList(const Job& job);
+
+    static double now();
+
+private:
+    JobSystem* m_jobs = nullptr;
+    std::vector<CommandList> m_lists;
+#ifdef _WIN32
+    std::vector<DeviceContext*> m_deferredContexts;
+#endif
+    Stats m_stats;
+};
+
+template<typename Job>
+void
+CommandQueue::forEachList(const Job& job) {
+    const unsigned int count = (unsigned int)m_lists.size();
+    if (!m_jobs) {
+        for (unsigned int index = 0; index < count; ++index)
+            job(index);
+        return;
+    }
+    m_jobs->parallelFor(count, 1, [&](unsigned int begin, unsigned int end) {
+        for (unsigned int index = begin; index < end; ++index)
+            job(index);
+    });
+}
+
+template<typename Executor>
+void
+CommandQueue::submit(Executor& executor) {
+    const double start = now();
+    for (CommandList& list : m_lists) {
+        executor.executeCommandList(list);
+    }
+    m_stats.submitSeconds = now() - start;
+}
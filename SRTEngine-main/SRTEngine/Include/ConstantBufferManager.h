@@ -0,0 +1,182 @@
+#pragma once
+#include "Prerequisites.h"
+#include "StateCache.h"
+
+class Device;
+class DeviceContext;
+
+/**
+ * @class ConstantBufferManager
+ * @brief Gestiona las subidas de constantes de la escena.
+ *
+ * Ofrece dos tipos de memoria:
+ * - Bloques persistentes (vista, proyección, ...): guardan una copia en CPU y solo se suben
+ *   a la GPU cuando el contenido cambia de verdad. Varias actualizaciones en el mismo
+ *   fotograma se juntan en una sola subida al enlazar el bloque.
+ * - Un anillo lineal grande para datos de un solo uso (constantes por objeto): cada
+ *   allocate() escribe a continuación de la anterior con MAP_WRITE_NO_OVERWRITE y al llegar
+ *   al final se reinicia con MAP_WRITE_DISCARD. Los objetos comparten el mismo búfer y se
+ *   enlazan por desplazamiento (VSSetConstantBuffers1).
+ *
+ * Si el dispositivo no admite desplazamientos en búferes constantes, el anillo vive en
+ * memoria de CPU y cada enlace copia la asignación a un búfer dinámico por slot.
+ * Sin dispositivo (init con nullptr) todo se queda en CPU, lo que permite comprobar
+ * los contadores sin ventana.
+ */
+class ConstantBufferManager {
+public:
+    /// Alineación de las asignaciones del anillo: 16 constantes de 16 bytes.
+    static const unsigned int CONSTANT_ALIGNMENT = 256;
+
+    /// Tamaño máximo de una asignación (D3D11_REQ_CONSTANT_BUFFER_ELEMENT_COUNT * 16).
+    static const unsigned int MAX_ALLOCATION_SIZE = 65536;
+
+    /// Identificador de un bloque persistente.
+    typedef unsigned int BlockHandle;
+    static const BlockHandle INVALID_BLOCK = ~0u;
+
+    /**
+     * @brief Contadores de subidas.
+     */
+    struct Stats {
+        uint64_t bytesUploaded = 0;    ///< Bytes copiados hacia la GPU (bloques + anillo).
+        uint64_t bytesSkipped = 0;     ///< Bytes de bloques que no se subieron por no cambiar.
+        unsigned int blockUploads = 0; ///< Bloques subidos.
+        unsigned int blockSkips = 0;   ///< Actualizaciones de bloque descartadas.
+        unsigned int allocations = 0;  ///< Asignaciones en el anillo.
+        unsigned int ringWraps = 0;    ///< Veces que el anillo volvió al principio.
+        unsigned int ringDiscards = 0; ///< Escrituras con DISCARD (la primera y cada vuelta); el resto, NO_OVERWRITE.
+    };
+
+    /**
+     * @brief Asignación dentro del anillo. Es válida hasta que el anillo vuelve a pasar por ella.
+     */
+    struct Allocation {
+        unsigned int offset = 0;        ///< Desplazamiento en bytes dentro del anillo.
+        unsigned int size = 0;          ///< Bytes reservados (múltiplo de CONSTANT_ALIGNMENT).
+        unsigned int firstConstant = 0; ///< offset / 16, para VSSetConstantBuffers1.
+        unsigned int numConstants = 0;  ///< size / 16, para VSSetConstantBuffers1.
+    };
+
+    ConstantBufferManager() = default;
+    ~ConstantBufferManager() { destroy(); }
+
+    /**
+     * @brief Crea el anillo.
+     * @param device Dispositivo para crear los búferes; nullptr = solo CPU.
+     * @param deviceContext Contexto con el que se mapea y se enlaza; nullptr = solo CPU.
+     * @param ringSize Tamaño del anillo en bytes (se redondea a CONSTANT_ALIGNMENT).
+     */
+    HRESULT init(Device* device, DeviceContext* deviceContext, unsigned int ringSize);
+
+    /// Libera los bloques, el anillo y los búferes auxiliares.
+    void destroy();
+
+    /**
+     * @brief Crea un bloque persistente de size bytes, inicializado a cero y marcado como sucio.
+     * @return INVALID_BLOCK si no se pudo crear.
+     */
+    BlockHandle createBlock(unsigned int size);
+
+    /**
+     * @brief Copia data en el bloque si difiere del contenido actual.
+     * La subida real se hace en bindBlock() o commitBlocks().
+     * @return true si el contenido cambió.
+     */
+    bool updateBlock(BlockHandle block, const void* data, unsigned int size);
+
+    /// Sube los bloques sucios.
+    void commitBlocks();
+
+    /**
+     * @brief Sube el bloque si está sucio y lo enlaza al slot indicado.
+     */
+    void bindBlock(StateCache::Stage stage, unsigned int slot, BlockHandle block);
+
+    /**
+     * @brief Escribe data en el anillo.
+     * @return false si size supera MAX_ALLOCATION_SIZE o el anillo.
+     */
+    bool allocate(const void* data, unsigned int size, Allocation& allocation);
+
+    /**
+     * @brief Garantiza que count asignaciones de size bytes caben sin que el anillo dé la
+     * vuelta: si no caben hasta el final, la siguiente allocate() empieza desde el principio.
+     * Hace falta cuando las asignaciones se enlazan más tarde (desde una CommandList), porque
+     * al dar la vuelta el anillo se descarta y las asignaciones anteriores dejan de valer.
+     * @return false si no caben ni con el anillo vacío.
+     */
+    bool reserve(unsigned int size, unsigned int count);
+
+    /**
+     * @brief Enlaza una asignación del anillo al slot indicado.
+     */
+    void bindAllocation(StateCache::Stage stage, unsigned int slot, const Allocation& allocation);
+
+    /// Cierra el fotograma: guarda los contadores en getLastFrameStats(), los suma a
+    /// getTotalStats() y los pone a cero.
+    void endFrame();
+
+    const Stats& getFrameStats() const { return m_frame; }
+    const Stats& getLastFrameStats() const { return m_lastFrame; }
+    const Stats& getTotalStats() const { return m_total; }
+
+    /// Contenido en CPU de un bloque.
+    const uint8_t* getBlockData(BlockHandle block) const;
+
+    /// Contenido del anillo en CPU (nullptr si el anillo está en la GPU).
+    const uint8_t* getRingData() const { return m_cpuRing.empty() ? nullptr : m_cpuRing.data(); }
+
+    /// true si el anillo se enlaza por desplazamiento (Direct3D 11.1).
+    bool usesOffsetBinding() const { return m_offsetBinding; }
+
+    /**
+     * @brief Búfer del anillo como puntero opaco, para enlazar asignaciones con
+     * CommandList::setConstantBufferRange. nullptr si el anillo no se enlaza por desplazamiento.
+     */
+    const void* getRingBuffer() const;
+
+    unsigned int getRingSize() const { return m_ringSize; }
+
+private:
+    struct Block {
+        std::vector<uint8_t> data;
+        bool dirty = true;
+#ifdef _WIN32
+        ID3D11Buffer* buffer = nullptr;
+#endif
+    };
+
+    void uploadBlock(Block& block);
+    void countUpload(unsigned int bytes);
+
+#ifdef _WIN32
+    /// Copia la asignación al búfer dinámico del slot (camino sin desplazamientos).
+    ID3D11Buffer* fillFallbackBuffer(StateCache::Stage stage, unsigned int slot, const Allocation& allocation);
+#endif
+
+private:
+    Device* m_device = nullptr;
+    DeviceContext* m_deviceContext = nullptr;
+    bool m_offsetBinding = false;
+
+    std::vector<Block> m_blocks;
+
+    unsigned int m_ringSize = 0;
+    unsigned int m_ringHead = 0;
+    std::vector<uint8_t> m_cpuRing;
+    bool m_ringDiscarded = false; ///< Si ya se escribió en el anillo desde init().
+#ifdef _WIN32
+    ID3D11Buffer* m_ringBuffer = nullptr;
+
+    struct FallbackBuffer {
+        ID3D11Buffer* buffer = nullptr;
+        unsigned int size = 0;
+    };
+    FallbackBuffer m_fallback[StateCache::STAGE_COUNT][StateCache::MAX_CONSTANT_BUFFERS];
+#endif
+
+    Stats m_frame;
+    Stats m_lastFrame;
+    Stats m_total;
+};
@@ -0,0 +1,94 @@
+#pragma once
+#include "Prerequisites.h"
+#include "MappedFile.h"
+
+/**
+ * @class DDSFile
+ * @brief Lector de archivos DDS que proyecta el archivo en memoria sin copiarlo.
+ *
+ * Entiende la cabecera clásica (DXT1/3/5, ATI1/2, formatos RGB por máscaras y los
+ * FourCC de coma flotante) y la extensión DX10 (cualquier DXGI_FORMAT sin empaquetar
+ * o BC1..BC7, arrays, cubemaps y texturas 1D/3D). Cada subrecurso apunta directamente
+ * a la proyección del archivo, en el orden que espera D3D11_SUBRESOURCE_DATA: por cada
+ * elemento del array (o cara del cubo) todos sus mips.
+ *
+ * Los punteros son válidos hasta close() o hasta que se destruya el objeto.
+ */
+class DDSFile {
+public:
+    /// Dimensión del recurso (mismos valores que D3D11_RESOURCE_DIMENSION).
+    enum Dimension {
+        DIMENSION_UNKNOWN = 0,
+        DIMENSION_TEXTURE1D = 2,
+        DIMENSION_TEXTURE2D = 3,
+        DIMENSION_TEXTURE3D = 4
+    };
+
+    /**
+     * @brief Un subrecurso (mip de un elemento del array) dentro del archivo.
+     */
+    struct Subresource {
+        const uint8_t* data = nullptr;
+        unsigned int rowPitch = 0;   ///< Bytes por fila (por fila de bloques en formatos BC).
+        unsigned int slicePitch = 0; ///< Bytes por corte de profundidad.
+        unsigned int width = 0;
+        unsigned int height = 0;
+        unsigned int depth = 0;
+    };
+
+    DDSFile() = default;
+    ~DDSFile();
+
+    DDSFile(const DDSFile&) = delete;
+    DDSFile& operator=(const DDSFile&) = delete;
+
+    /**
+     * @brief Proyecta el archivo en memoria (solo lectura) y lee sus cabeceras.
+     */
+    HRESULT open(const std::string& fileName);
+
+    /**
+     * @brief Lee un DDS que ya está en memoria (por ejemplo dentro de otro archivo).
+     * Los datos no se copian: tienen que seguir vivos mientras se use el DDSFile.
+     */
+    HRESULT parse(const uint8_t* data, size_t size);
+
+    /// Libera la proyección y olvida los subrecursos.
+    void close();
+
+    Dimension getDimension() const { return m_dimension; }
+    unsigned int getFormat() const { return m_format; } ///< Valor de DXGI_FORMAT.
+    unsigned int getWidth() const { return m_width; }
+    unsigned int getHeight() const { return m_height; }
+    unsigned int getDepth() const { return m_depth; }
+    unsigned int getMipCount() const { return m_mipCount; }
+
+    /// Elementos del array; en un cubemap cuenta las 6 caras de cada cubo.
+    unsigned int getArraySize() const { return m_arraySize; }
+    bool isCubemap() const { return m_cubemap; }
+    bool isBlockCompressed() const { return m_blockBytes != 0; }
+
+    const std::vector<Subresource>& getSubresources() const { return m_subresources; }
+
+    /// Bytes de datos de imagen (sin cabeceras).
+    size_t getDataSize() const { return m_dataSize; }
+
+private:
+    HRESULT readHeaders(const uint8_t* data, size_t size);
+
+private:
+    MappedFile m_file; ///< Vacío si se usó parse().
+
+    Dimension m_dimension = DIMENSION_UNKNOWN;
+    unsigned int m_format = 0;
+    unsigned int m_width = 0;
+    unsigned int m_height = 0;
+    unsigned int m_depth = 0;
+    unsigned int m_mipCount = 0;
+    unsigned int m_arraySize = 0;
+    bool m_cubemap = false;
+    unsigned int m_blockBytes = 0;
+    unsigned int m_bitsPerPixel = 0;
+    size_t m_dataSize = 0;
+    std::vector<Subresource> m_subresources;
+};
@@ -100,6 +100,11 @@ public:
     HRESULT CreateBlendState(const D3D11_BLEND_DESC* pBlendStateDesc,
         ID3D11BlendState** ppBlendState);
 
+    /**
+     * @brief Crea un contexto diferido para grabar comandos desde otro hilo.
+     */
+    HRESULT CreateDeferredContext(ID3D11DeviceContext** ppDeferredContext);
+
 public:
     ID3D11Device* m_device = nullptr; ///< Puntero al dispositivo Direct3D.
 };
@@ -1,5 +1,8 @@
 #pragma once
 #include "PreRequisites.h"
+#include "StateCache.h"
+
+class CommandList;
 
 /**
  * @class DeviceContext
@@ -30,6 +33,20 @@ public:
      */
     void destroy();
 
+    /**
+     * @brief Restablece todo el estado del pipeline (ID3D11DeviceContext::ClearState)
+     * y olvida la copia en sombra del estado.
+     */
+    void ClearState();
+
+    /**
+     * @brief Cierra los contadores de llamadas de estado del fotograma actual.
+     *
+     * Despus de llamarlo, m_stateCache.getLastFrameStats() contiene las llamadas
+     * emitidas y filtradas del fotograma que termina.
+     */
+    void endFrame();
+
     /**
      * @brief Configura las vistas de la pantalla.
      * @param NumViewports Nmero de viewports.
@@ -152,6 +169,40 @@ public:
         unsigned int NumBuffers,
         ID3D11Buffer* const* ppConstantBuffers);
 
+    /**
+     * @brief Enlaza rangos de bferes constantes al sombreador de vrtices (Direct3D 11.1).
+     * @param pFirstConstant Primera constante de 16 bytes de cada rango (mltiplo de 16).
+     * @param pNumConstants Nmero de constantes de cada rango (mltiplo de 16).
+     */
+    void VSSetConstantBuffers1(unsigned int StartSlot,
+        unsigned int NumBuffers,
+        ID3D11Buffer* const* ppConstantBuffers,
+        const unsigned int* pFirstConstant,
+        const unsigned int* pNumConstants);
+
+    /**
+     * @brief Enlaza rangos de bferes constantes al sombreador de pxeles (Direct3D 11.1).
+     */
+    void PSSetConstantBuffers1(unsigned int StartSlot,
+        unsigned int NumBuffers,
+        ID3D11Buffer* const* ppConstantBuffers,
+        const unsigned int* pFirstConstant,
+        const unsigned int* pNumConstants);
+
+    /**
+     * @brief Mapea un recurso para escribirlo desde la CPU.
+     */
+    HRESULT Map(ID3D11Resource* pResource,
+        unsigned int Subresource,
+        D3D11_MAP MapType,
+        unsigned int MapFlags,
+        D3D11_MAPPED_SUBRESOURCE* pMappedResource);
+
+    /**
+     * @brief Desmapea un recurso mapeado con Map.
+     */
+    void Unmap(ID3D11Resource* pResource, unsigned int Subresource);
+
     /**
      * @brief Dibuja un conjunto de ndices.
      */
@@ -159,10 +210,46 @@ public:
         unsigned int StartIndexLocation,
         int BaseVertexLocation);
 
+    /**
+     * @brief Dibuja InstanceCount copias de un conjunto de ndices; los bferes de
+     * vrtices por instancia se leen a partir de StartInstanceLocation.
+     */
+    void DrawIndexedInstanced(unsigned int IndexCountPerInstance,
+        unsigned int InstanceCount,
+        unsigned int StartIndexLocation,
+        int BaseVertexLocation,
+        unsigned int StartInstanceLocation);
+
+    /**
+     * @brief Reproduce una CommandList sobre este contexto (inmediato o diferido).
+     * Los punteros opacos de la lista deben ser objetos ID3D11.
+     */
+    void executeCommandList(const CommandList& commandList);
+
+    /**
+     * @brief Cierra la grabacin de un contexto diferido (ID3D11DeviceContext::FinishCommandList).
+     */
+    HRESULT FinishCommandList(bool RestoreDeferredContextState, ID3D11CommandList** ppCommandList);
+
+    /**
+     * @brief Ejecuta en el contexto inmediato una lista grabada en un contexto diferido.
+     */
+    void ExecuteCommandList(ID3D11CommandList* pCommandList, bool RestoreContextState);
+
 private:
     /**
      * @brief Puntero al contexto del dispositivo Direct3D.
      */
 public:
     ID3D11DeviceContext* m_deviceContext = nullptr;
+
+    /**
+     * @brief Interfaz de Direct3D 11.1 del mismo contexto; se obtiene la primera vez que hace falta.
+     */
+    ID3D11DeviceContext1* m_deviceContext1 = nullptr;
+
+    /**
+     * @brief Copia en sombra del estado enlazado; descarta las llamadas que no cambian nada.
+     */
+    StateCache m_stateCache;
 };
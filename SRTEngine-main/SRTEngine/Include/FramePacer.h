@@ -0,0 +1,123 @@
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class FramePacer
+ * @brief Ritmo de presentación: tope de frames por segundo, frames en vuelo y latencia.
+ *
+ * No depende de ninguna API gráfica. El bucle de render llama a beginFrame() antes de
+ * dibujar y a presented() justo después de presentar:
+ *
+ * - beginFrame() espera a que haya hueco si ya hay maxFramesInFlight frames presentados que
+ *   la GPU no ha terminado (lo consulta con la función de setCompletedFramesQuery(); sin
+ *   ella se confía en el límite del propio backend, p. ej. SetMaximumFrameLatency de DXGI).
+ *   Con un tope de FPS espera además hasta el instante del siguiente frame: duerme hasta
+ *   spinSeconds antes y el resto lo espera girando, porque Sleep solo tiene precisión de
+ *   milisegundos. Los instantes se encadenan (anterior + intervalo) para no acumular deriva.
+ * - presented() anota el intervalo entre presentaciones, su desviación respecto al objetivo
+ *   (histograma de jitter) y la latencia desde que se leyó la entrada del frame.
+ *
+ * Los tiempos son segundos de now() (steady_clock), o del reloj de setClock().
+ */
+class FramePacer {
+public:
+    /// Muestras que se guardan para el percentil de latencia.
+    static const unsigned int LATENCY_HISTORY = 256;
+
+    /// Cubetas del histograma de jitter: |intervalo - objetivo| < 0.25, 0.5, 1, 2, 4, 8, 16 ms o más.
+    static const unsigned int JITTER_BUCKETS = 8;
+
+    /// Devuelve cuántos frames presentados ha terminado ya la GPU.
+    typedef uint64_t (*CompletedFramesQuery)(void* data);
+
+    /// Instante actual en segundos.
+    typedef double (*ClockFunction)(void* data);
+
+    /// Espera seconds segundos; con 0 solo cede el hilo (la espera girando).
+    typedef void (*SleepFunction)(void* data, double seconds);
+
+    /// Contadores desde init() o resetStats().
+    struct Stats {
+        uint64_t frames = 0;             ///< Frames presentados.
+        double averageIntervalMs = 0.0;  ///< Tiempo medio entre presentaciones.
+        double minIntervalMs = 0.0;
+        double maxIntervalMs = 0.0;
+        double averageJitterMs = 0.0;    ///< Media de |intervalo - objetivo|.
+        uint64_t jitter[JITTER_BUCKETS] = {};
+        double averageLatencyMs = 0.0;   ///< Entrada -> presentación.
+        double p99LatencyMs = 0.0;       ///< Sobre los últimos LATENCY_HISTORY frames.
+        double maxLatencyMs = 0.0;
+        double throttleSeconds = 0.0;    ///< Esperando a que la GPU terminara frames.
+        double capSeconds = 0.0;         ///< Esperando por el tope de FPS.
+    };
+
+    FramePacer() = default;
+
+    /**
+     * @brief Prepara el ritmo de frames.
+     * @param targetFps Tope de frames por segundo (0 = sin tope).
+     * @param maxFramesInFlight Frames presentados sin terminar en la GPU como máximo.
+     */
+    HRESULT init(double targetFps = 0.0, unsigned int maxFramesInFlight = 2);
+
+    void setTargetFps(double targetFps);
+    double getTargetFps() const { return m_targetFps; }
+
+    void setMaxFramesInFlight(unsigned int frames) { m_maxFramesInFlight = frames > 0 ? frames : 1; }
+    unsigned int getMaxFramesInFlight() const { return m_maxFramesInFlight; }
+
+    /// Margen final que se espera girando en vez de durmiendo.
+    void setSpinSeconds(double seconds) { m_spinSeconds = seconds > 0.0 ? seconds : 0.0; }
+
+    void setCompletedFramesQuery(CompletedFramesQuery query, void* data);
+
+    /**
+     * @brief Cambia el reloj y la espera (nullptr = steady_clock y sleep_for/yield), para
+     * probar el ritmo con tiempos conocidos. inputTime de presented() debe venir del mismo reloj.
+     */
+    void setClock(ClockFunction clock, SleepFunction sleepFunction, void* data);
+
+    /// Espera por los frames en vuelo y por el tope de FPS antes de empezar un frame.
+    void beginFrame();
+
+    /**
+     * @brief Anota una presentación; se llama justo después de Present().
+     * @param inputTime Instante (now()) en que se leyó la entrada de este frame; 0 si no se sabe.
+     */
+    void presented(double inputTime = 0.0);
+
+    Stats getStats() const;
+    void resetStats();
+
+    static double now();
+
+private:
+    double currentTime() const;
+    void sleep(double seconds);
+    void waitUntil(double deadline);
+
+private:
+    ClockFunction m_clock = nullptr;
+    SleepFunction m_sleep = nullptr;
+    void* m_clockData = nullptr;
+    double m_targetFps = 0.0;
+    unsigned int m_maxFramesInFlight = 2;
+    double m_spinSeconds = 0.002;
+    CompletedFramesQuery m_completedFrames = nullptr;
+    void* m_completedFramesData = nullptr;
+
+    uint64_t m_presentedFrames = 0;
+    double m_nextDeadline = 0.0;    ///< Instante del siguiente frame con tope de FPS.
+    double m_lastPresent = 0.0;
+    double m_averageInterval = 0.0; ///< Objetivo del jitter sin tope de FPS (media móvil).
+
+    Stats m_stats;
+    double m_intervalSum = 0.0;
+    uint64_t m_intervals = 0;
+    double m_jitterSum = 0.0;
+    double m_latencySum = 0.0;
+    uint64_t m_latencies = 0;
+    float m_latencyMs[LATENCY_HISTORY] = {};
+    unsigned int m_latencyCount = 0;
+    unsigned int m_latencyNext = 0;
+};
@@ -0,0 +1,82 @@
+#pragma once
+#include "Prerequisites.h"
+#include <condition_variable>
+#include <mutex>
+
+/**
+ * @class FramePipeline
+ * @brief Solapa la simulación del frame N+1 con el envío a la GPU del frame N.
+ *
+ * La aplicación guarda los datos de cada frame (transformaciones, constantes, lista de
+ * visibles...) en getFramesInFlight() huecos. Un hilo de simulación rellena el hueco del
+ * siguiente frame mientras el hilo principal dibuja el anterior con beginRender() /
+ * endRender(); el frame F usa el hueco F % getFramesInFlight(). Ningún hueco lo tocan los
+ * dos hilos a la vez: la simulación solo escribe en huecos que el render ya soltó y el
+ * render solo lee huecos terminados, así que los datos del frame pasan de un hilo a otro
+ * sin más sincronización.
+ *
+ * Con 2 huecos la simulación va como mucho un frame por delante; con 3 puede adelantarse
+ * dos y absorber frames de simulación irregulares a cambio de un frame más de latencia.
+ * Con 1 no hay hilo: beginRender() simula en el hilo principal, como un bucle normal.
+ */
+class FramePipeline {
+public:
+    static const unsigned int MAX_FRAMES_IN_FLIGHT = 3;
+
+    /// Simula un frame y escribe su resultado en el hueco slot.
+    typedef void (*SimulateFunction)(void* data, unsigned int slot);
+
+    /// Contadores acumulados desde init().
+    struct Stats {
+        uint64_t simulated = 0;           ///< Frames simulados.
+        uint64_t rendered = 0;            ///< Frames soltados por endRender().
+        double simulateSeconds = 0.0;     ///< Tiempo dentro de la función de simulación.
+        double simulateWaitSeconds = 0.0; ///< Tiempo de la simulación esperando un hueco libre.
+        double renderWaitSeconds = 0.0;   ///< Tiempo de beginRender() esperando a la simulación.
+    };
+
+    FramePipeline() = default;
+    ~FramePipeline();
+
+    FramePipeline(const FramePipeline&) = delete;
+    FramePipeline& operator=(const FramePipeline&) = delete;
+
+    /**
+     * @brief Arranca el hilo de simulación.
+     * @param framesInFlight Huecos de datos de frame (1 a MAX_FRAMES_IN_FLIGHT).
+     * @param simulate Función que simula un frame; se llama desde el hilo de simulación.
+     * @param data Puntero que se pasa a simulate.
+     */
+    HRESULT init(unsigned int framesInFlight, SimulateFunction simulate, void* data);
+
+    /// Termina el frame que se esté simulando y detiene el hilo.
+    void destroy();
+
+    /// Espera a que el siguiente frame esté simulado y devuelve su hueco.
+    unsigned int beginRender();
+
+    /// Suelta el hueco del frame dibujado para que la simulación lo reutilice.
+    void endRender();
+
+    unsigned int getFramesInFlight() const { return m_framesInFlight; }
+
+    Stats getStats() const;
+
+private:
+    void simulationLoop();
+
+private:
+    unsigned int m_framesInFlight = 0;
+    SimulateFunction m_simulate = nullptr;
+    void* m_data = nullptr;
+
+    std::thread m_thread;
+    mutable std::mutex m_mutex;
+    std::condition_variable m_simulatedCondition; ///< Hay un frame nuevo simulado.
+    std::condition_variable m_releasedCondition;  ///< El render soltó un hueco.
+    uint64_t m_simulatedFrames = 0;               ///< Frames terminados por la simulación.
+    uint64_t m_renderedFrames = 0;                ///< Frames soltados por el render.
+    bool m_rendering = false;
+    bool m_quit = false;
+    Stats m_stats;
+};
@@ -0,0 +1,160 @@
+#pragma once
+#include "Prerequisites.h"
+#include "JobSystem.h"
+
+/**
+ * @brief Esferas envolventes en forma de estructura de arrays (un array por componente).
+ */
+struct BoundingSpheres {
+    std::vector<float> centerX, centerY, centerZ, radius;
+
+    unsigned int add(const Float3& center, float r) {
+        centerX.push_back(center.x);
+        centerY.push_back(center.y);
+        centerZ.push_back(center.z);
+        radius.push_back(r);
+        return size() - 1;
+    }
+
+    void set(unsigned int index, const Float3& center, float r) {
+        centerX[index] = center.x;
+        centerY[index] = center.y;
+        centerZ[index] = center.z;
+        radius[index] = r;
+    }
+
+    unsigned int size() const { return (unsigned int)radius.size(); }
+
+    void clear() {
+        centerX.clear();
+        centerY.clear();
+        centerZ.clear();
+        radius.clear();
+    }
+};
+
+/**
+ * @brief Cajas alineadas a los ejes (centro y semiextensión) en forma de estructura de arrays.
+ */
+struct BoundingBoxes {
+    std::vector<float> centerX, centerY, centerZ;
+    std::vector<float> extentX, extentY, extentZ;
+
+    unsigned int add(const Float3& center, const Float3& extents) {
+        centerX.push_back(center.x);
+        centerY.push_back(center.y);
+        centerZ.push_back(center.z);
+        extentX.push_back(extents.x);
+        extentY.push_back(extents.y);
+        extentZ.push_back(extents.z);
+        return size() - 1;
+    }
+
+    void set(unsigned int index, const Float3& center, const Float3& extents) {
+        centerX[index] = center.x;
+        centerY[index] = center.y;
+        centerZ[index] = center.z;
+        extentX[index] = extents.x;
+        extentY[index] = extents.y;
+        extentZ[index] = extents.z;
+    }
+
+    unsigned int size() const { return (unsigned int)extentX.size(); }
+
+    void clear() {
+        centerX.clear();
+        centerY.clear();
+        centerZ.clear();
+        extentX.clear();
+        extentY.clear();
+        extentZ.clear();
+    }
+};
+
+/**
+ * @class FrustumCuller
+ * @brief Descarta los volúmenes envolventes que quedan fuera del frustum de la cámara.
+ *
+ * Los seis planos se sacan de view * projection (convención de D3D, z de 0 a w) y cada
+ * volumen se prueba contra todos ellos: una esfera es visible si su centro no está a más
+ * de su radio por detrás de ningún plano, y una caja si su vértice más adelantado respecto
+ * a cada plano queda delante. Es una prueba conservadora: puede dejar pasar algún volumen
+ * cerca de las esquinas, pero nunca descarta uno visible.
+ *
+ * Se prueban 8 volúmenes a la vez con AVX2 (4 con SSE) y los bloques de BOUNDS_CHUNK
+ * volúmenes se reparten entre los hilos del JobSystem. El resultado es la lista compacta
+ * de índices visibles en orden creciente.
+ */
+class FrustumCuller {
+public:
+    /// Planos en el orden de planes[]: (a, b, c, d) normalizados, dentro si a*x + b*y + c*z + d >= 0.
+    enum Plane {
+        PLANE_LEFT = 0,
+        PLANE_RIGHT,
+        PLANE_BOTTOM,
+        PLANE_TOP,
+        PLANE_NEAR,
+        PLANE_FAR,
+        PLANE_COUNT
+    };
+
+    /// Contadores del último cull.
+    struct Stats {
+        unsigned int tested = 0;  ///< Volúmenes probados.
+        unsigned int visible = 0; ///< Volúmenes que pasaron la prueba.
+    };
+
+    FrustumCuller() = default;
+
+    FrustumCuller(const FrustumCuller&) = delete;
+    FrustumCuller& operator=(const FrustumCuller&) = delete;
+
+    /**
+     * @brief Prepara el culler.
+     * @param jobs Sistema de trabajos (nullptr = todo en el hilo que llama).
+     */
+    HRESULT init(JobSystem* jobs = nullptr);
+
+    void destroy();
+
+    /// Calcula los planos del frustum de la cámara.
+    void setFrustum(const Matrix& view, const Matrix& projection);
+
+    /// Calcula los planos de una matriz view * projection ya multiplicada.
+    static void extractPlanes(const Matrix& viewProjection, Float4 planes[PLANE_COUNT]);
+
+    const Float4* getPlanes() const { return m_planes; }
+
+    /**
+     * @brief Deja en visible los índices de las esferas que tocan el frustum.
+     */
+    void cullSpheres(const BoundingSpheres& spheres, std::vector<uint32_t>& visible);
+
+    /**
+     * @brief Deja en visible los índices de las cajas que tocan el frustum.
+     */
+    void cullBoxes(const BoundingBoxes& boxes, std::vector<uint32_t>& visible);
+
+    unsigned int getThreadCount() const { return m_jobs ? m_jobs->getThreadCount() : 1; }
+    const Stats& getStats() const { return m_stats; }
+
+    /// Volúmenes por trabajo; cada trabajo escribe sus índices en su propio tramo de la salida.
+    static const unsigned int BOUNDS_CHUNK = 16384;
+
+private:
+    void cull(unsigned int count, std::vector<uint32_t>& visible,
+              void (*job)(FrustumCuller*, unsigned int));
+
+private:
+    Float4 m_planes[PLANE_COUNT] = {}; ///< Sin setFrustum() todo es visible.
+    Stats m_stats;
+
+    // Entrada y salida del cull en curso, leídas por los trabajos.
+    const BoundingSpheres* m_spheres = nullptr;
+    const BoundingBoxes* m_boxes = nullptr;
+    unsigned int m_count = 0;
+    uint32_t* m_output = nullptr;
+    std::vector<unsigned int> m_chunkVisible;
+
+    JobSystem* m_jobs = nullptr;
+};
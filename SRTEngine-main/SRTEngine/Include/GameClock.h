@@ -0,0 +1,122 @@
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class GameClock
+ * @brief Reloj del juego con paso fijo de simulación.
+ *
+ * tick() se llama una vez por frame: mide el tiempo real con un contador monotónico de
+ * alta resolución (steady_clock, que en Windows es QueryPerformanceCounter), lo multiplica
+ * por la escala de tiempo y lo acumula. Después step() devuelve true una vez por cada paso
+ * fijo completo del acumulado:
+ *
+ *     clock.tick();
+ *     while (clock.step())
+ *         simular(clock.getFixedStep());
+ *     dibujar(lerp(estadoAnterior, estadoActual, clock.getAlpha()));
+ *
+ * La simulación siempre avanza getFixedStep() segundos, así que no depende del ritmo de
+ * frames; lo que sobra del acumulado (getAlpha()) sirve para interpolar entre los dos
+ * últimos estados al dibujar. Si un frame llega muy tarde solo se simulan maxSteps pasos y
+ * el resto se descarta, para que un frame lento no provoque otro más lento.
+ *
+ * En modo determinista tick() avanza exactamente deterministicFrame segundos sin mirar el
+ * contador: la misma secuencia de frames da la misma simulación, para repetir una prueba
+ * de rendimiento. Las estadísticas de frame siguen midiendo el tiempo real.
+ */
+class GameClock {
+public:
+    /// Frames que se guardan para getFrameStats().
+    static const unsigned int FRAME_HISTORY = 256;
+
+    /// Duración de los últimos frames (tiempo real, sin escalar), en milisegundos.
+    struct FrameStats {
+        unsigned int frames = 0; ///< Frames medidos (como mucho FRAME_HISTORY).
+        double minMs = 0.0;
+        double averageMs = 0.0;
+        double p99Ms = 0.0;      ///< Percentil 99.
+        double maxMs = 0.0;
+    };
+
+    /// Contador monotónico en nanosegundos.
+    typedef int64_t (*CounterFunction)(void* data);
+
+    GameClock() = default;
+
+    /**
+     * @brief Arranca el reloj a cero.
+     * @param fixedStep Segundos de simulación por paso.
+     * @param maxSteps Pasos como máximo por tick().
+     */
+    HRESULT init(double fixedStep = 1.0 / 60.0, unsigned int maxSteps = 8);
+
+    /**
+     * @brief Activa o desactiva el modo determinista.
+     * @param deterministicFrame Segundos que avanza cada tick() en modo determinista.
+     */
+    void setDeterministic(bool enabled, double deterministicFrame = 1.0 / 60.0);
+    bool isDeterministic() const { return m_deterministic; }
+
+    /// Empieza un frame: mide el tiempo desde el tick() anterior y lo acumula.
+    void tick();
+
+    /// Consume un paso fijo del acumulado; false cuando no queda ninguno completo.
+    bool step();
+
+    /// Fracción de paso que queda en el acumulado, en [0, 1), para interpolar.
+    float getAlpha() const { return (float)(m_accumulator / m_fixedStep); }
+
+    double getFixedStep() const { return m_fixedStep; }
+
+    /// Segundos simulados (pasos consumidos por step()).
+    double getTime() const { return (double)m_steps * m_fixedStep; }
+
+    /// Segundos reales desde init(), según el contador.
+    double getRealTime() const;
+
+    /// Segundos reales del último frame, sin escalar.
+    double getFrameSeconds() const { return m_frameSeconds; }
+
+    uint64_t getFrameCount() const { return m_frames; }
+
+    /// Multiplica el tiempo que se acumula (0.5 = cámara lenta).
+    void setTimeScale(double scale) { m_timeScale = scale < 0.0 ? 0.0 : scale; }
+    double getTimeScale() const { return m_timeScale; }
+
+    /// En pausa no se acumula tiempo, pero se siguen midiendo los frames.
+    void setPaused(bool paused) { m_paused = paused; }
+    bool isPaused() const { return m_paused; }
+
+    FrameStats getFrameStats() const;
+    void resetFrameStats();
+
+    /**
+     * @brief Cambia el contador de tiempo real (nullptr = steady_clock); sirve para
+     * probar el reloj con tiempos conocidos. Se llama antes de init().
+     */
+    void setCounter(CounterFunction counter, void* data);
+
+private:
+    int64_t counterNow() const;
+
+private:
+    CounterFunction m_counter = nullptr;
+    void* m_counterData = nullptr;
+    double m_fixedStep = 1.0 / 60.0;
+    unsigned int m_maxSteps = 8;
+    double m_timeScale = 1.0;
+    bool m_paused = false;
+    bool m_deterministic = false;
+    double m_deterministicFrame = 1.0 / 60.0;
+
+    int64_t m_start = 0;       ///< Contador en init() (nanosegundos).
+    int64_t m_lastTick = 0;    ///< Contador en el último tick().
+    double m_accumulator = 0.0;
+    uint64_t m_steps = 0;
+    uint64_t m_frames = 0;
+    double m_frameSeconds = 0.0;
+
+    float m_frameMs[FRAME_HISTORY] = {};
+    unsigned int m_frameMsCount = 0;
+    unsigned int m_frameMsNext = 0;
+};
@@ -0,0 +1,71 @@
+#pragma once
+#include "Prerequisites.h"
+#include <unordered_map>
+
+/**
+ * @brief Datos de una instancia tal como los lee el vertex shader instanciado.
+ *
+ * Van en un búfer de vértices por instancia: las cuatro filas de la matriz de mundo (sin
+ * transponer, v * world) y el color de la malla, como vMeshColor.
+ */
+struct InstanceData {
+    Float4 world[4];
+    Float4 color;
+};
+
+/**
+ * @class InstanceBatcher
+ * @brief Agrupa los objetos de un frame por malla y material para dibujarlos instanciados.
+ *
+ * Cada frame se llama a clear(), a add() por objeto visible y a build(). build() deja las
+ * instancias de cada par (malla, material) contiguas en getInstances() y describe cada
+ * grupo en getBatches(), ordenados por malla y luego por material para que el render
+ * cambie de estado lo menos posible. Dentro de un lote se conserva el orden de add().
+ * Después de build() no se puede volver a llamar a add() sin pasar antes por clear().
+ *
+ * Solo trabaja en memoria de CPU, así que se puede rellenar en el hilo de simulación;
+ * InstanceRenderer sube el resultado y emite un dibujo por lote.
+ */
+class InstanceBatcher {
+public:
+    /// Instancias contiguas que comparten malla y material.
+    struct Batch {
+        uint32_t mesh = 0;
+        uint32_t material = 0;
+        uint32_t userData = 0;          ///< El de la primera instancia del lote (ver add()).
+        unsigned int firstInstance = 0; ///< Primera instancia en getInstances().
+        unsigned int instanceCount = 0;
+    };
+
+    InstanceBatcher() = default;
+
+    /// Vacía las instancias del frame anterior (conserva la memoria reservada).
+    void clear();
+
+    void reserve(unsigned int instanceCount);
+
+    /// Añade una instancia de mesh con material. userData es del llamador (p. ej. el índice
+    /// de la malla en sus tablas) y se guarda en el lote, así que debe ser el mismo para
+    /// todas las instancias de un par (mesh, material).
+    void add(uint32_t mesh, uint32_t material, const Matrix& world, const Float4& color, uint32_t userData = 0);
+
+    /// Agrupa las instancias añadidas desde clear().
+    void build();
+
+    const std::vector<Batch>& getBatches() const { return m_batches; }
+    const InstanceData* getInstances() const { return m_sorted.data(); }
+    unsigned int getInstanceCount() const { return (unsigned int)m_sorted.size(); }
+
+private:
+    static uint64_t batchKey(uint32_t mesh, uint32_t material) { return ((uint64_t)mesh << 32) | material; }
+
+private:
+    std::vector<InstanceData> m_unsorted;
+    std::vector<uint32_t> m_batchOf;     ///< Lote de cada instancia de m_unsorted.
+    std::vector<InstanceData> m_sorted;
+    std::vector<Batch> m_batches;
+    std::unordered_map<uint64_t, uint32_t> m_batchIndex;
+    uint64_t m_lastKey = ~0ull;          ///< Último par buscado; los objetos suelen llegar seguidos.
+    uint32_t m_lastBatch = 0;
+    bool m_inOrder = true;               ///< Lotes ya contiguos y en orden: build() no copia.
+};
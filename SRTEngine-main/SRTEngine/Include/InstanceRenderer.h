@@ -0,0 +1,122 @@
+#pragma once
+#include "Prerequisites.h"
+#include "InstanceBatcher.h"
+#include "VertexFormat.h"
+
+class Device;
+class DeviceContext;
+
+/**
+ * @class InstanceRenderer
+ * @brief Dibuja los lotes de un InstanceBatcher con un DrawIndexedInstanced por lote.
+ *
+ * Todas las instancias del frame se copian con un solo Map a un búfer de vértices dinámico
+ * que se usa como anillo (NO_OVERWRITE a continuación de lo anterior y DISCARD al dar la
+ * vuelta), y cada lote se dibuja leyendo su tramo con StartInstanceLocation, sin volver a
+ * enlazar el búfer. Si un frame no cabe, el búfer se recrea con el doble de capacidad.
+ *
+ * Trae su propio vertex y pixel shader: las mallas tienen el VertexFormat de init() (por
+ * defecto el de SimpleVertex, posición y coordenadas de textura en float), la vista y la proyección se leen de b0 y b1 como en
+ * el resto de la escena, y el color de cada instancia multiplica la textura de t0 con el
+ * muestreador de s0. La aplicación enlaza esos recursos; el cambio de material entre
+ * lotes se hace con la función de setMaterialFunction().
+ *
+ * Sin dispositivo (init con nullptr) las instancias se copian a memoria de CPU y solo se
+ * cuentan los dibujos, lo que permite medir el coste de CPU sin ventana.
+ */
+class InstanceRenderer {
+public:
+    /// Identificador de una malla registrada con addMesh().
+    typedef uint32_t MeshHandle;
+    static const MeshHandle INVALID_MESH = ~0u;
+
+    /// Enlaza el material de los lotes siguientes.
+    typedef void (*MaterialFunction)(void* data, uint32_t material);
+
+    /// Malla indexada en el formato de vértice de init().
+    struct Mesh {
+        unsigned int indexCount = 0;
+        unsigned int startIndexLocation = 0; ///< Tramo de una malla partida (MeshletBuilder).
+        int baseVertexLocation = 0;
+#ifdef _WIN32
+        ID3D11Buffer* vertexBuffer = nullptr;
+        unsigned int vertexStride = 0;
+        ID3D11Buffer* indexBuffer = nullptr;
+        DXGI_FORMAT indexFormat = DXGI_FORMAT_R16_UINT;
+#endif
+    };
+
+    /// Contadores del último submit().
+    struct Stats {
+        unsigned int instances = 0;
+        unsigned int batches = 0;
+        unsigned int skippedBatches = 0; ///< Lotes por debajo de minInstances.
+        unsigned int drawCalls = 0;
+        unsigned int bufferGrows = 0;   ///< Veces que se recreó el búfer de instancias.
+        uint64_t bytesUploaded = 0;
+        double submitSeconds = 0.0;     ///< Copia de instancias + emisión de dibujos.
+    };
+
+    InstanceRenderer() = default;
+    ~InstanceRenderer() { destroy(); }
+
+    InstanceRenderer(const InstanceRenderer&) = delete;
+    InstanceRenderer& operator=(const InstanceRenderer&) = delete;
+
+    /**
+     * @brief Compila los shaders y crea el búfer de instancias.
+     * @param device Dispositivo; nullptr = solo CPU.
+     * @param deviceContext Contexto con el que se dibuja; nullptr = solo CPU.
+     * @param maxInstances Capacidad inicial del búfer de instancias.
+     * @param vertexFormat Formato de los vértices de las mallas; necesita POSITION y TEXCOORD y
+     * no puede tener COLOR (lo usa la instancia). nullptr = SimpleVertex.
+     */
+    HRESULT init(Device* device, DeviceContext* deviceContext, unsigned int maxInstances,
+        const VertexFormat* vertexFormat = nullptr);
+
+    void destroy();
+
+    /// Registra una malla; los búferes siguen siendo de quien llama.
+    MeshHandle addMesh(const Mesh& mesh);
+
+    void setMaterialFunction(MaterialFunction function, void* data);
+
+    /**
+     * @brief Sube las instancias del batcher (ya construido) y dibuja sus lotes.
+     * Deja enlazados los shaders, el input layout y la topología de lista de triángulos.
+     * @param minInstances Los lotes con menos instancias se saltan (el llamador los dibuja
+     * por objeto, donde instanciar no compensa).
+     */
+    void submit(const InstanceBatcher& batcher, unsigned int minInstances = 1);
+
+    const Stats& getStats() const { return m_stats; }
+
+    /// Instancias del último submit() en CPU (nullptr si el búfer está en la GPU).
+    const InstanceData* getCpuInstances() const { return m_cpuInstances.empty() ? nullptr : m_cpuInstances.data(); }
+
+private:
+#ifdef _WIN32
+    HRESULT createShaders();
+    HRESULT createInstanceBuffer(unsigned int capacity);
+#endif
+
+private:
+    Device* m_device = nullptr;
+    DeviceContext* m_deviceContext = nullptr;
+    std::vector<Mesh> m_meshes;
+    MaterialFunction m_materialFunction = nullptr;
+    void* m_materialData = nullptr;
+    VertexFormat m_vertexFormat;
+
+    unsigned int m_capacity = 0; ///< Instancias que caben en el búfer.
+    unsigned int m_head = 0;     ///< Primera instancia libre del anillo.
+    std::vector<InstanceData> m_cpuInstances;
+#ifdef _WIN32
+    ID3D11Buffer* m_instanceBuffer = nullptr;
+    ID3D11VertexShader* m_vertexShader = nullptr;
+    ID3D11PixelShader* m_pixelShader = nullptr;
+    ID3D11InputLayout* m_inputLayout = nullptr;
+#endif
+
+    Stats m_stats;
+};
@@ -0,0 +1,175 @@
+#pragma once
+#include "Prerequisites.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+
+class JobSystem;
+
+/// Función de un trabajo: recibe el puntero de datos del lote y el índice del trabajo dentro de él.
+typedef void (*JobFunction)(void* data, unsigned int index);
+
+/**
+ * @class JobCounter
+ * @brief Cuenta los trabajos pendientes de uno o varios lotes.
+ *
+ * JobSystem::run() la incrementa y cada trabajo la decrementa al terminar. Se espera con
+ * JobSystem::wait() y sirve de dependencia para JobSystem::runAfter(). Tiene que seguir
+ * viva hasta que llega a cero; después se puede destruir aunque nadie la haya esperado
+ * (los trabajos no la vuelven a tocar tras decrementarla).
+ */
+class JobCounter {
+public:
+    JobCounter() : m_id(nextId()) {}
+    JobCounter(const JobCounter&) = delete;
+    JobCounter& operator=(const JobCounter&) = delete;
+
+    bool isDone() const { return m_pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    friend class JobSystem;
+
+    static uint64_t nextId();
+
+    std::atomic<unsigned int> m_pending{ 0 };
+    const uint64_t m_id; ///< Identifica el contador en la lista de dependencias aunque se reutilice su dirección.
+};
+
+/**
+ * @class JobSystem
+ * @brief Planificador de trabajos con una cola por hilo y robo de trabajo.
+ *
+ * init() lanza un hilo por núcleo y el hilo que llama cuenta como el hilo 0. Cada hilo saca
+ * trabajos del final de su cola (lo último que encoló, que aún está en caché) y, cuando
+ * se queda sin trabajo, roba del principio de la cola de otro. Los hilos ociosos giran un
+ * poco y después se duermen hasta que llega trabajo nuevo.
+ *
+ * wait() no bloquea el hilo: mientras el contador no llega a cero ejecuta trabajos
+ * pendientes, así que se puede llamar desde dentro de un trabajo sin riesgo de bloqueo.
+ *
+ * Los trabajos no deben bloquearse esperando a otros hilos (E/S, mutex largos): para eso
+ * está TextureLoader con sus propios hilos.
+ */
+class JobSystem {
+public:
+    /// Contadores acumulados desde init().
+    struct Stats {
+        uint64_t executed = 0; ///< Trabajos ejecutados.
+        uint64_t stolen = 0;   ///< Trabajos robados de la cola de otro hilo.
+    };
+
+    JobSystem() = default;
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    /**
+     * @brief Lanza los hilos de trabajo.
+     * @param threadCount Hilos contando el que llama; 0 = uno por núcleo.
+     */
+    HRESULT init(unsigned int threadCount = 0);
+
+    /// Detiene los hilos; no debe quedar ningún trabajo pendiente.
+    void destroy();
+
+    /**
+     * @brief Encola jobCount trabajos que llaman a function(data, índice).
+     * @param counter Contador que se decrementa al terminar cada trabajo (opcional).
+     */
+    void run(JobFunction function, void* data, unsigned int jobCount, JobCounter* counter = nullptr);
+
+    /// Igual que run(), pero los trabajos no se encolan hasta que dependency llega a cero.
+    void runAfter(JobCounter& dependency, JobFunction function, void* data, unsigned int jobCount,
+                  JobCounter* counter = nullptr);
+
+    /// Ejecuta trabajos pendientes hasta que el contador llega a cero.
+    void wait(JobCounter& counter);
+
+    /**
+     * @brief Llama a function(begin, end) sobre [0, count) en tramos de grain elementos y
+     * espera a que terminen todos. El hilo que llama también trabaja.
+     */
+    template <typename Function>
+    void parallelFor(unsigned int count, unsigned int grain, const Function& function);
+
+    unsigned int getThreadCount() const { return (unsigned int)m_queues.size(); }
+
+    Stats getStats() const;
+
+private:
+    struct Job {
+        JobFunction function;
+        void* data;
+        unsigned int index;
+        JobCounter* counter;
+    };
+
+    /// Lote que espera a que un contador llegue a cero.
+    struct Dependent {
+        uint64_t dependency; ///< m_id del contador del que depende.
+        JobFunction function;
+        void* data;
+        unsigned int jobCount;
+        JobCounter* counter;
+    };
+
+    /// Cola de un hilo; el dueño usa el final y los ladrones el principio.
+    struct alignas(64) WorkQueue {
+        std::mutex mutex;
+        std::vector<Job> jobs;
+        size_t head = 0; ///< Primer trabajo sin robar.
+        std::atomic<uint64_t> executed{ 0 };
+        std::atomic<uint64_t> stolen{ 0 };
+    };
+
+    void enqueue(JobFunction function, void* data, unsigned int jobCount, JobCounter* counter);
+    unsigned int currentQueue() const;
+    bool popOrSteal(unsigned int queueIndex, Job& job);
+    void execute(unsigned int queueIndex, const Job& job);
+    void finish(JobCounter& counter);
+    void workerLoop(unsigned int queueIndex);
+
+private:
+    std::vector<std::unique_ptr<WorkQueue>> m_queues;
+    std::vector<std::thread> m_workers;
+
+    std::atomic<unsigned int> m_queuedJobs{ 0 }; ///< Trabajos encolados sin empezar.
+    std::atomic<unsigned int> m_sleepingWorkers{ 0 };
+    std::mutex m_sleepMutex;
+    std::condition_variable m_wakeCondition;
+    std::atomic<bool> m_quit{ false };
+
+    std::mutex m_dependentMutex;
+    std::vector<Dependent> m_dependents;
+    std::atomic<unsigned int> m_dependentCount{ 0 }; ///< Tamaño de m_dependents, para no tomar el mutex.
+};
+
+template <typename Function>
+void
+JobSystem::parallelFor(unsigned int count, unsigned int grain, const Function& function) {
+    if (grain == 0)
+        grain = 1;
+    const unsigned int jobCount = (count + grain - 1) / grain;
+    if (jobCount <= 1 || m_queues.size() <= 1) {
+        if (count > 0)
+            function(0u, count);
+        return;
+    }
+
+    struct Range {
+        const Function* function;
+        unsigned int count;
+        unsigned int grain;
+    };
+    Range range = { &function, count, grain };
+    JobCounter counter;
+    run([](void* data, unsigned int index) {
+            const Range& r = *static_cast<const Range*>(data);
+            const unsigned int begin = index * r.grain;
+            (*r.function)(begin, std::min(r.count, begin + r.grain));
+        }, &range, jobCount, &counter);
+    wait(counter);
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class LZ4Codec
+ * @brief Compresión y descompresión en el formato de bloque de LZ4.
+ *
+ * El compresor es el voraz de LZ4 "fast" (tabla hash de secuencias de 4 bytes, sin
+ * búsqueda en cadena): comprime a cientos de MB/s y el resultado lo puede leer
+ * cualquier decodificador LZ4. El descompresor comprueba todos los límites, así que un
+ * bloque corrupto devuelve false en lugar de escribir fuera del búfer.
+ */
+class LZ4Codec {
+public:
+    /// Tamaño máximo que puede ocupar un bloque comprimido de size bytes.
+    static size_t compressBound(size_t size);
+
+    /**
+     * @brief Comprime size bytes y deja el bloque en compressed (redimensionado a su tamaño real).
+     */
+    static void compress(const uint8_t* data, size_t size, std::vector<uint8_t>& compressed);
+
+    /**
+     * @brief Descomprime un bloque cuyo tamaño original se conoce.
+     * @return false si el bloque está corrupto o no ocupa exactamente outputSize bytes.
+     */
+    static bool decompress(const uint8_t* compressed, size_t compressedSize, uint8_t* output, size_t outputSize);
+};
@@ -0,0 +1,70 @@
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class LodSelector
+ * @brief Elige el nivel de detalle de cada objeto por el error que proyecta en pantalla.
+ *
+ * El error geométrico de cada LOD (en unidades del objeto, el de MeshSimplifier::Lod) se
+ * pasa a píxeles con la distancia de la cámara a la esfera del objeto y la escala vertical
+ * de la proyección: píxeles = error * escala / distancia * projection._22 * alto / 2. Se usa
+ * el LOD más simple cuyo error no pasa de maxPixelError.
+ *
+ * Histéresis: para bajar a un LOD más simple que el actual su error tiene que quedar por
+ * debajo de maxPixelError * (1 - hysteresis), y para subir a uno más detallado basta con
+ * que el actual pase de maxPixelError. Un objeto que se queda cerca de la distancia de
+ * cambio no alterna de nivel en cada frame.
+ */
+class LodSelector {
+public:
+    /**
+     * @brief Opciones de la selección.
+     */
+    struct Options {
+        float maxPixelError = 1.0f;
+        float hysteresis = 0.25f; ///< Fracción del umbral que hay que ganar para simplificar.
+    };
+
+    /// Contadores del frame en curso.
+    struct Stats {
+        unsigned int objects = 0;
+        unsigned int switches = 0; ///< Objetos que cambiaron de LOD respecto al frame anterior.
+    };
+
+    LodSelector() = default;
+
+    LodSelector(const LodSelector&) = delete;
+    LodSelector& operator=(const LodSelector&) = delete;
+
+    HRESULT init(const Options& options);
+
+    void destroy();
+
+    /// Cámara del frame: posición y escala de la proyección en píxeles. Pone a cero los contadores.
+    void beginFrame(const Matrix& view, const Matrix& projection, float viewportHeight);
+
+    /**
+     * @brief Elige el LOD del objeto y lo recuerda para el frame siguiente.
+     * @param center Centro de la esfera del objeto en el mundo.
+     * @param lodErrors Errores crecientes de los lodCount niveles (lodErrors[0] = 0).
+     * @param scale Escala del mundo del objeto (pasa los errores a unidades del mundo).
+     */
+    unsigned int select(uint32_t object,
+        const Float3& center,
+        float radius,
+        const float* lodErrors,
+        unsigned int lodCount,
+        float scale = 1.0f);
+
+    /// Píxeles que ocupa un error del mundo en la esfera (center, radius); la cámara dentro = infinito.
+    float getPixelError(const Float3& center, float radius, float error) const;
+
+    const Stats& getStats() const { return m_stats; }
+
+private:
+    Options m_options;
+    Float3 m_eye = Float3(0.0f, 0.0f, 0.0f);
+    float m_pixelScale = 0.0f;        ///< projection._22 * alto / 2.
+    std::vector<uint8_t> m_current;   ///< LOD de cada objeto en el frame anterior.
+    Stats m_stats;
+};
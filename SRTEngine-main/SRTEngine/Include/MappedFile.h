@@ -0,0 +1,37 @@
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class MappedFile
+ * @brief Proyección de solo lectura de un archivo completo en memoria.
+ *
+ * Las páginas se leen del disco la primera vez que se tocan y pertenecen a la caché de
+ * archivos del sistema, así que no cuentan como memoria privada del proceso. Los punteros
+ * a data() son válidos hasta close() o hasta que se destruya el objeto.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /// Proyecta el archivo; falla si no existe o está vacío.
+    HRESULT open(const std::string& fileName);
+
+    /// Libera la proyección.
+    void close();
+
+    const uint8_t* data() const { return m_view; }
+    size_t size() const { return m_size; }
+    bool isOpen() const { return m_view != nullptr; }
+
+private:
+#ifdef _WIN32
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+#endif
+    const uint8_t* m_view = nullptr;
+    size_t m_size = 0;
+};
@@ -0,0 +1,118 @@
+#pragma once
+#include "Prerequisites.h"
+#include "JobSystem.h"
+#include "MappedFile.h"
+#include <memory>
+
+/**
+ * @brief Vértice de malla con la misma distribución que SimpleVertex (posición y UV).
+ */
+struct MeshVertex {
+    Float3 position;
+    Float2 texCoord;
+};
+
+/**
+ * @brief Malla indexada lista para crear los búferes de vértices e índices.
+ */
+struct MeshData {
+    std::vector<MeshVertex> vertices;
+    std::vector<uint32_t> indices; ///< Lista de triángulos.
+    Float3 boundsMin = Float3(0.0f, 0.0f, 0.0f);
+    Float3 boundsMax = Float3(0.0f, 0.0f, 0.0f);
+
+    void clear() {
+        vertices.clear();
+        indices.clear();
+        boundsMin = Float3(0.0f, 0.0f, 0.0f);
+        boundsMax = Float3(0.0f, 0.0f, 0.0f);
+    }
+};
+
+/**
+ * @class MeshLoader
+ * @brief Importa mallas OBJ y glTF 2.0 (.gltf y .glb) al formato de vértices del motor.
+ *
+ * Los archivos se proyectan en memoria con MappedFile y se leen en el sitio, sin copiarlos
+ * ni crear cadenas: el tokenizer recorre los bytes y convierte los números a mano.
+ *
+ * - OBJ: el archivo se parte en tramos por líneas y cada tramo se analiza en un trabajo
+ *   (v, vt y f; los polígonos se triangulan en abanico y se admiten índices negativos).
+ *   Después los vértices se unifican por par (posición, UV), así que cada combinación
+ *   distinta da un solo vértice.
+ * - glTF: se lee el JSON (o el de un .glb) y se recorre la escena aplicando las
+ *   transformaciones de los nodos. Los búferes externos se proyectan en memoria, los de un
+ *   .glb se leen del propio archivo y los "data:" en base64 se decodifican. Los atributos
+ *   POSITION y TEXCOORD_0 y los índices se decodifican en paralelo por tramos, y los
+ *   vértices que quedan iguales al descartar el resto de atributos se unifican.
+ *
+ * Las mallas se pasan de mano derecha (OBJ y glTF) a la mano izquierda del motor negando z,
+ * lo que además deja los triángulos en el sentido horario que D3D11 dibuja por defecto.
+ * La V de OBJ se invierte porque su origen está abajo.
+ *
+ * No se leen normales, materiales ni animaciones, ni accessors dispersos (sparse).
+ */
+class MeshLoader {
+public:
+    /// Contadores de la última carga.
+    struct Stats {
+        uint64_t bytes = 0;            ///< Bytes analizados (JSON y búferes o texto OBJ).
+        unsigned int sourceVertices = 0; ///< Esquinas (OBJ) o vértices (glTF) antes de unificar.
+        unsigned int vertices = 0;
+        unsigned int triangles = 0;
+        double parseSeconds = 0.0;     ///< Lectura y decodificación.
+        double weldSeconds = 0.0;      ///< Unificación de vértices.
+    };
+
+    MeshLoader() = default;
+
+    MeshLoader(const MeshLoader&) = delete;
+    MeshLoader& operator=(const MeshLoader&) = delete;
+
+    /**
+     * @brief Prepara el cargador.
+     * @param jobs Sistema de trabajos para analizar en paralelo (nullptr = en el hilo que llama).
+     */
+    HRESULT init(JobSystem* jobs = nullptr);
+
+    void destroy();
+
+    /// Carga un .obj, .gltf o .glb según la extensión.
+    HRESULT load(const std::string& fileName, MeshData& mesh);
+
+    /// Analiza el texto de un OBJ que ya está en memoria.
+    HRESULT parseObj(const uint8_t* data, size_t size, MeshData& mesh);
+
+    /**
+     * @brief Analiza un .gltf (JSON) o un .glb que ya está en memoria.
+     * @param baseDirectory Carpeta donde buscar los búferes externos (con la barra final).
+     */
+    HRESULT parseGltf(const uint8_t* data, size_t size, const std::string& baseDirectory, MeshData& mesh);
+
+    const Stats& getStats() const { return m_stats; }
+
+    unsigned int getThreadCount() const { return m_jobs ? m_jobs->getThreadCount() : 1; }
+
+private:
+    template <typename Function>
+    void parallelFor(unsigned int count, unsigned int grain, const Function& function);
+
+    /// Unifica los vértices con los mismos bits y reescribe los índices.
+    void weld(MeshData& mesh);
+
+    static void computeBounds(MeshData& mesh);
+
+private:
+    JobSystem* m_jobs = nullptr;
+    std::vector<std::unique_ptr<MappedFile>> m_buffers; ///< Búferes externos del glTF en curso.
+    Stats m_stats;
+};
+
+template <typename Function>
+void
+MeshLoader::parallelFor(unsigned int count, unsigned int grain, const Function& function) {
+    if (m_jobs)
+        m_jobs->parallelFor(count, grain, function);
+    else if (count > 0)
+        function(0u, count);
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include "Prerequisites.h"
+#include "MeshLoader.h"
+
+/**
+ * @class MeshOptimizer
+ * @brief Reordena índices y vértices de una malla para la GPU, solo en CPU.
+ *
+ * optimize() aplica tres pasos, cada uno sin deshacer el anterior:
+ *
+ * - Caché de vértices: algoritmo Tipsify (Sander, Nehab y Barczak 2007). Se avanza en
+ *   abanico alrededor de un vértice y se elige el siguiente entre los vértices recién
+ *   emitidos que seguirán en la caché FIFO; en un callejón sin salida se vuelve a los
+ *   últimos vértices emitidos o al primero que aún tenga triángulos. Es lineal en el número
+ *   de triángulos.
+ * - Overdraw: el orden anterior se corta en grupos donde la caché se vacía (todos los
+ *   vértices del triángulo fallan) y, dentro de ellos, donde el ACMR del grupo no supera
+ *   overdrawThreshold veces el del tramo. Los grupos se ordenan de más a menos orientados
+ *   hacia fuera respecto al centro de la malla, así que los que suelen tapar a otros se
+ *   dibujan antes y la prueba de profundidad descarta más píxeles.
+ * - Lectura de vértices: los vértices se renumeran por orden de primer uso, así que los
+ *   índices recorren el búfer de vértices casi en secuencia. Los no usados se quitan.
+ *
+ * ACMR es la media de vértices transformados por triángulo (0.5 es el mínimo en una malla
+ * regular, 3 sin caché) y ATVR la misma cuenta dividida entre los vértices usados (1 es el
+ * mínimo: cada vértice se transforma una vez).
+ */
+class MeshOptimizer {
+public:
+    /// Tamaño de la caché FIFO simulada; 16 es conservador para el hardware de D3D11.
+    static const unsigned int DEFAULT_CACHE_SIZE = 16;
+
+    /**
+     * @brief Opciones de optimize().
+     */
+    struct Options {
+        unsigned int cacheSize = DEFAULT_CACHE_SIZE;
+        float overdrawThreshold = 1.05f; ///< ACMR que se puede perder para ordenar contra el overdraw (1 = nada).
+        bool optimizeOverdraw = true;
+    };
+
+    /// Resultado de simular la caché de vértices.
+    struct CacheStats {
+        float acmr = 0.0f;
+        float atvr = 0.0f;
+    };
+
+    /**
+     * @brief Resultado de optimize().
+     */
+    struct Stats {
+        CacheStats before;
+        CacheStats after;
+        unsigned int clusters = 0;      ///< Grupos que ordenó el paso de overdraw.
+        double cacheSeconds = 0.0;
+        double overdrawSeconds = 0.0;
+        double fetchSeconds = 0.0;
+    };
+
+    /// Aplica los tres pasos a mesh (lista de triángulos).
+    static HRESULT optimize(MeshData& mesh, const Options& options, Stats* stats = nullptr);
+
+    /// Reordena los triángulos para la caché de vértices (Tipsify).
+    static void optimizeVertexCache(uint32_t* indices,
+        size_t indexCount,
+        unsigned int vertexCount,
+        unsigned int cacheSize = DEFAULT_CACHE_SIZE);
+
+    /**
+     * @brief Reordena grupos de triángulos contra el overdraw conservando su orden interno.
+     * Espera índices ya ordenados por optimizeVertexCache(). Devuelve el número de grupos.
+     */
+    static unsigned int optimizeOverdraw(uint32_t* indices,
+        size_t indexCount,
+        const MeshVertex* vertices,
+        unsigned int vertexCount,
+        unsigned int cacheSize = DEFAULT_CACHE_SIZE,
+        float threshold = 1.05f);
+
+    /// Renumera los vértices por orden de primer uso y quita los no usados.
+    static void optimizeVertexFetch(MeshData& mesh);
+
+    /// Simula una caché FIFO de cacheSize vértices sobre los índices.
+    static CacheStats analyzeVertexCache(const uint32_t* indices,
+        size_t indexCount,
+        unsigned int vertexCount,
+        unsigned int cacheSize = DEFAULT_CACHE_SIZE);
+};
@@ -0,0 +1,71 @@
+#pragma once
+#include "Prerequisites.h"
+#include "MeshLoader.h"
+
+/**
+ * @class MeshSimplifier
+ * @brief Simplifica mallas por colapso de aristas con métrica de error cuádrica (QEM).
+ *
+ * Algoritmo de Garland y Heckbert (1997) con colapsos a uno de los dos extremos de la
+ * arista: los vértices no se mueven, así que los niveles simplificados son solo listas de
+ * índices sobre el mismo búfer de vértices. Cada vértice acumula las cuádricas de los planos
+ * de sus triángulos (ponderadas por área) y de las aristas de borde; el coste de colapsar
+ * v en t es la distancia cuadrática media de t a los planos de v.
+ *
+ * Se trabaja por pasadas: se calcula el coste de todas las aristas, se ordenan, y se aplican
+ * en orden los colapsos que no tocan un vértice ya modificado en la pasada, que no dan la
+ * vuelta a ningún triángulo y que no superan el error pedido. Los vértices con la misma
+ * posición y distinta UV (costuras) colapsan juntos a lo largo de la costura; los bordes
+ * abiertos solo colapsan a lo largo del borde, y las aristas no manifold quedan fijas.
+ */
+class MeshSimplifier {
+public:
+    /**
+     * @brief Opciones de buildLods().
+     */
+    struct LodOptions {
+        unsigned int maxLods = 6;        ///< Niveles, incluido el original.
+        float reduction = 0.5f;          ///< Triángulos de cada nivel respecto al anterior.
+        float maxError = 0.05f;          ///< Error máximo, relativo al radio de la caja de la malla.
+        unsigned int minTriangles = 64;  ///< No se generan niveles más pequeños.
+        bool lockBorder = false;         ///< true = los bordes abiertos no se mueven.
+    };
+
+    /// Nivel de detalle: triángulos sobre los vértices de la malla original.
+    struct Lod {
+        std::vector<uint32_t> indices;
+        float error = 0.0f;              ///< Cota del error geométrico, en unidades de la malla.
+    };
+
+    /// Resultado de buildLods().
+    struct Stats {
+        unsigned int levels = 0;
+        double seconds = 0.0;
+    };
+
+    /**
+     * @brief Genera la cadena de LODs de mesh; lods[0] son los índices originales con error 0.
+     * Cada nivel se simplifica a partir del anterior y su error es la suma de los errores de
+     * la cadena. La cadena se corta al llegar a maxLods, a minTriangles, a maxError o cuando un
+     * nivel ya no se deja reducir.
+     */
+    static HRESULT buildLods(const MeshData& mesh, const LodOptions& options, std::vector<Lod>& lods,
+        Stats* stats = nullptr);
+
+    /**
+     * @brief Simplifica una lista de triángulos hasta targetIndexCount índices sin pasar de targetError.
+     * @param destination Salida; cabe indexCount índices (puede ser indices).
+     * @param targetError Error máximo en unidades de la malla.
+     * @param resultError Si no es nullptr, recibe el error del colapso más caro aplicado.
+     * @return Índices escritos en destination.
+     */
+    static size_t simplify(uint32_t* destination,
+        const uint32_t* indices,
+        size_t indexCount,
+        const MeshVertex* vertices,
+        unsigned int vertexCount,
+        size_t targetIndexCount,
+        float targetError,
+        bool lockBorder = false,
+        float* resultError = nullptr);
+};
@@ -0,0 +1,121 @@
+#pragma once
+#include "Prerequisites.h"
+#include "MeshLoader.h"
+
+/**
+ * @brief Grupo pequeño de triángulos seguidos en el búfer de índices, con su esfera y su
+ * cono de normales para descartarlo entero cuando todas sus caras miran hacia atrás.
+ */
+struct Meshlet {
+    uint32_t firstIndex = 0;       ///< Posición en el búfer de índices.
+    uint32_t triangleCount = 0;
+    uint32_t vertexCount = 0;      ///< Vértices distintos que usa.
+    Float3 center = Float3(0.0f, 0.0f, 0.0f);
+    float radius = 0.0f;
+    Float3 coneAxis = Float3(0.0f, 0.0f, 0.0f);
+    float coneCutoff = 1.0f;       ///< Seno de la apertura del cono; 1 = nunca se descarta.
+};
+
+/**
+ * @brief Tramo de la malla direccionable con índices de 16 bits: se dibuja con
+ * BaseVertexLocation = baseVertex y sus índices son locales al tramo.
+ */
+struct MeshChunk {
+    uint32_t baseVertex = 0;
+    uint32_t vertexCount = 0;
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    uint32_t firstMeshlet = 0;
+    uint32_t meshletCount = 0;
+};
+
+/**
+ * @brief Malla preparada para subir: vértices por tramo, índices empaquetados y meshlets.
+ */
+struct MeshletMesh {
+    std::vector<MeshVertex> vertices;
+    std::vector<uint8_t> indexData;   ///< indexSize bytes por índice.
+    unsigned int indexSize = 2;       ///< 2 (R16_UINT) o 4 (R32_UINT).
+    std::vector<MeshChunk> chunks;
+    std::vector<Meshlet> meshlets;
+
+    unsigned int getIndexCount() const { return (unsigned int)(indexData.size() / indexSize); }
+
+    void clear() {
+        vertices.clear();
+        indexData.clear();
+        indexSize = 2;
+        chunks.clear();
+        meshlets.clear();
+    }
+};
+
+/**
+ * @class MeshletBuilder
+ * @brief Parte una malla en tramos de índices de 16 bits y en meshlets con conos de normales.
+ *
+ * build() recorre los triángulos en el orden que ya tienen (el de MeshOptimizer conserva la
+ * localidad) y cierra un meshlet al llegar a maxVertices vértices distintos o a
+ * maxTriangles triángulos. Los meshlets se van metiendo en el tramo actual hasta que no
+ * caben en maxChunkVertices vértices; entonces empieza otro tramo y los vértices que
+ * comparten se duplican. Así cualquier malla se dibuja con R16_UINT; solo con
+ * splitChunks = false y más de 65536 vértices se usan índices de 32 bits.
+ *
+ * cull() descarta en CPU los meshlets de un tramo que miran hacia atrás desde la cámara
+ * (prueba del cono contra la esfera del meshlet) y junta los visibles seguidos en rangos
+ * de DrawIndexed. La cámara va en el espacio de la malla; la prueba vale para mundos con
+ * rotación, traslación y escala uniforme.
+ */
+class MeshletBuilder {
+public:
+    /// Vértices que caben en un tramo direccionable con índices de 16 bits.
+    static const unsigned int MAX_16BIT_VERTICES = 65536;
+
+    /**
+     * @brief Opciones de build().
+     */
+    struct Options {
+        unsigned int maxVertices = 64;
+        unsigned int maxTriangles = 124;
+        unsigned int maxChunkVertices = MAX_16BIT_VERTICES;
+        bool splitChunks = true; ///< false = un solo tramo (índices de 32 bits si no caben en 16).
+    };
+
+    /// Rango de índices para un DrawIndexed.
+    struct DrawRange {
+        uint32_t firstIndex;
+        uint32_t indexCount;
+        int32_t baseVertex;
+    };
+
+    /// Contadores que cull() va sumando (el llamador los pone a cero).
+    struct CullStats {
+        uint64_t meshletsTested = 0;
+        uint64_t meshletsCulled = 0;
+        uint64_t trianglesTested = 0;
+        uint64_t trianglesCulled = 0;
+        uint64_t ranges = 0;
+    };
+
+    /// Construye tramos, índices empaquetados y meshlets de mesh (lista de triángulos).
+    static HRESULT build(const MeshData& mesh, const Options& options, MeshletMesh& result);
+
+    /**
+     * @brief Añade los vértices, índices, tramos y meshlets de source detrás de los de mesh
+     * (los LODs de una malla comparten así búferes). Los dos tienen que usar el mismo indexSize.
+     */
+    static HRESULT append(MeshletMesh& mesh, const MeshletMesh& source);
+
+    /**
+     * @brief Añade a ranges los meshlets visibles del tramo chunk desde cameraPosition.
+     * @param cameraPosition Posición de la cámara en el espacio de la malla.
+     * @param maxGapTriangles Huecos de hasta tantos triángulos descartados se dibujan igualmente
+     *        para no partir el rango (menos draws a cambio de triángulos que descarta la GPU).
+     */
+    static void cull(const MeshletMesh& mesh,
+        unsigned int chunk,
+        const Float3& cameraPosition,
+        unsigned int maxGapTriangles,
+        std::vector<DrawRange>& ranges,
+        CullStats* stats = nullptr);
+};
@@ -0,0 +1,61 @@
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @brief Un nivel de la cadena de mips en RGBA8, sin relleno entre filas.
+ */
+struct MipLevel {
+    unsigned int width = 0;
+    unsigned int height = 0;
+    std::vector<uint8_t> pixels;
+};
+
+/**
+ * @class MipGenerator
+ * @brief Genera en CPU la cadena de mips completa de una imagen RGBA8.
+ *
+ * Cada nivel se filtra desde el anterior en coma flotante (sin volver a cuantizar entre
+ * niveles) con un filtro separable: primero filas y luego columnas. Con srgb activo los
+ * canales de color se pasan a lineal antes de filtrar y se vuelven a codificar al
+ * guardar, así que los tonos medios no se oscurecen al reducir.
+ *
+ * La pasada vertical usa AVX2 (8 floats) o SSE2 (4 floats) y la horizontal procesa un
+ * píxel RGBA por registro SSE2. Las filas se reparten entre threadCount hilos. Con
+ * useSimd = false se usa el camino escalar, que sirve de referencia.
+ */
+class MipGenerator {
+public:
+    /// Filtro de reducción.
+    enum Filter {
+        FILTER_BOX = 0, ///< Media de la huella del píxel (2x2 en tamaños pares).
+        FILTER_KAISER,  ///< Sinc con ventana de Kaiser (radio 3, alfa 4).
+        FILTER_LANCZOS  ///< Lanczos de 3 lóbulos.
+    };
+
+    /**
+     * @brief Opciones de generación.
+     */
+    struct Options {
+        Filter filter = FILTER_KAISER;
+        bool srgb = true;                   ///< Filtra el color en espacio lineal.
+        bool preserveAlphaCoverage = false; ///< Mantiene el % de píxeles con alfa > alphaReference.
+        float alphaReference = 0.5f;        ///< Umbral del alpha test para la cobertura.
+        unsigned int maxLevels = 0;         ///< Límite de niveles (0 = cadena completa).
+        unsigned int threadCount = 1;       ///< Hilos por nivel (0 = núcleos disponibles).
+        bool useSimd = true;                ///< false = camino escalar de referencia.
+    };
+
+    /// Niveles de la cadena completa para una imagen width x height.
+    static unsigned int levelCount(unsigned int width, unsigned int height);
+
+    /**
+     * @brief Genera la cadena de mips.
+     * @param pixels Imagen RGBA8 de width x height, nivel 0 de la cadena.
+     * @param levels Salida; levels[0] es una copia de la imagen.
+     */
+    static HRESULT generate(const uint8_t* pixels,
+        unsigned int width,
+        unsigned int height,
+        const Options& options,
+        std::vector<MipLevel>& levels);
+};
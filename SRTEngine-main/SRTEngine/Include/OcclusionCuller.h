@@ -0,0 +1,110 @@
+#pragma once
+#include "Prerequisites.h"
+#include "FrustumCuller.h"
+
+/**
+ * @class OcclusionCuller
+ * @brief Culling por oclusión en CPU con un búfer de profundidad de baja resolución.
+ *
+ * Cada frame se rasterizan unos pocos oclusores (mallas grandes y sencillas: edificios,
+ * muros, terreno) en un búfer de profundidad pequeño, y con él se construye una pirámide
+ * en la que cada texel guarda la profundidad más lejana de los cuatro de debajo. Un volumen
+ * está oculto si su punto más cercano queda detrás de todo lo que hay en su rectángulo de
+ * pantalla; se prueba en el nivel de la pirámide en que ese rectángulo ocupa como mucho
+ * 4x4 texeles.
+ *
+ * Los oclusores se rasterizan LANES píxeles a la vez con SSE2/AVX2, con la misma regla de
+ * cobertura que SoftRasterizer (centro del píxel, top-left) y descartando las caras
+ * traseras. Cada píxel guarda la profundidad del punto más lejano del triángulo dentro del
+ * píxel, y las pruebas miran también un píxel alrededor del rectángulo del volumen, para
+ * que los píxeles del borde de un oclusor (cubiertos por su centro) no oculten de más.
+ *
+ * Profundidad como en D3D: 0 en el plano cercano y 1 en el lejano.
+ */
+class OcclusionCuller {
+public:
+    /// Contadores desde el último beginFrame().
+    struct Stats {
+        unsigned int occluderTriangles = 0;   ///< Triángulos de oclusores enviados.
+        unsigned int rasterizedTriangles = 0; ///< Los que llegaron a rasterizarse.
+        unsigned int tested = 0;              ///< Volúmenes probados.
+        unsigned int occluded = 0;            ///< Volúmenes descartados por oclusión.
+    };
+
+    OcclusionCuller() = default;
+    ~OcclusionCuller();
+
+    /**
+     * @brief Reserva el búfer de profundidad y su pirámide.
+     * @param width Ancho en píxeles (se redondea a múltiplo de LANES en memoria).
+     * @param height Alto en píxeles.
+     */
+    HRESULT init(unsigned int width = 256, unsigned int height = 128);
+
+    void destroy();
+
+    /// Limpia el búfer de profundidad y fija la cámara del frame.
+    void beginFrame(const Matrix& view, const Matrix& projection);
+
+    /**
+     * @brief Rasteriza una malla oclusora.
+     * @param vertices Primer vértice; la posición (float3) va al principio de cada vértice.
+     * @param vertexStride Bytes entre vértices.
+     * @param vertexCount Número de vértices.
+     * @param indices Lista de triángulos.
+     * @param indexCount Número de índices (múltiplo de 3).
+     * @param world Matriz de mundo de la malla.
+     */
+    void addOccluder(const void* vertices, unsigned int vertexStride, unsigned int vertexCount,
+                     const uint16_t* indices, unsigned int indexCount, const Matrix& world);
+    void addOccluder(const void* vertices, unsigned int vertexStride, unsigned int vertexCount,
+                     const uint32_t* indices, unsigned int indexCount, const Matrix& world);
+
+    /// Construye la pirámide; hay que llamarla después del último addOccluder() del frame.
+    void finishOccluders();
+
+    /**
+     * @brief Prueba una caja alineada a los ejes en espacio de mundo.
+     * @return false si queda completamente oculta o fuera de la pantalla.
+     */
+    bool isBoxVisible(const Float3& center, const Float3& extents) const;
+
+    /// Quita de visible los índices de cajas ocultas (llama a finishOccluders() si hace falta).
+    void cullBoxes(const BoundingBoxes& boxes, std::vector<uint32_t>& visible);
+
+    /// Igual que cullBoxes() usando la caja que envuelve cada esfera.
+    void cullSpheres(const BoundingSpheres& spheres, std::vector<uint32_t>& visible);
+
+    unsigned int getWidth() const { return m_width; }
+    unsigned int getHeight() const { return m_height; }
+
+    /// Profundidad rasterizada (getPitch() floats por fila).
+    const float* getDepth() const { return m_levels.empty() ? nullptr : m_levels[0].depth.data(); }
+    unsigned int getPitch() const { return m_levels.empty() ? 0 : m_levels[0].pitch; }
+
+    const Stats& getStats() const { return m_stats; }
+
+private:
+    /// Nivel de la pirámide; el 0 es el búfer en el que se rasteriza.
+    struct Level {
+        unsigned int width = 0;
+        unsigned int height = 0;
+        unsigned int pitch = 0;
+        std::vector<float> depth;
+    };
+
+    void rasterizeMesh(const void* vertices, unsigned int vertexStride, unsigned int vertexCount,
+                       const void* indices, bool indices32, unsigned int indexCount, const Matrix& world);
+    void clipAndRasterize(const Float4& v0, const Float4& v1, const Float4& v2);
+    void rasterizeTriangle(const Float4& v0, const Float4& v1, const Float4& v2);
+
+private:
+    unsigned int m_width = 0;
+    unsigned int m_height = 0;
+    std::vector<Level> m_levels;
+    bool m_pyramidDirty = false;
+
+    Matrix m_viewProjection = MatrixIdentity();
+    std::vector<Float4> m_clip; ///< Vértices del oclusor actual en espacio de recorte.
+    Stats m_stats;
+};
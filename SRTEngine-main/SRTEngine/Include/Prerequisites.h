@@ -4,16 +4,40 @@
 #include <string>
 #include <sstream>
 #include <vector>
-#include <windows.h>
-#include <xnamath.h>
 #include <thread>
+#include <cstdint>
+#include <cstdio>
+
+#ifdef _WIN32
+#include <windows.h>
 
 // Libreras DirectX
 #include <d3d11.h>
+#include <d3d11_1.h>
 #include <d3dx11.h>
 #include <d3dcompiler.h>
 #include "Resource.h"
 #include "resource.h"
+#else
+// Fuera de Windows solo se compilan los mdulos de CPU (rasterizador por software,
+// etc.), as que se definen los cdigos HRESULT y la salida de depuracin que usan.
+typedef int32_t HRESULT;
+#define S_OK          ((HRESULT)0)
+#define S_FALSE       ((HRESULT)1)
+#define E_NOTIMPL     ((HRESULT)0x80004001)
+#define E_POINTER     ((HRESULT)0x80004003)
+#define E_FAIL        ((HRESULT)0x80004005)
+#define E_OUTOFMEMORY ((HRESULT)0x8007000E)
+#define E_INVALIDARG  ((HRESULT)0x80070057)
+#define SUCCEEDED(hr) (((HRESULT)(hr)) >= 0)
+#define FAILED(hr)    (((HRESULT)(hr)) < 0)
+
+// Con %ls stderr sigue siendo de bytes: fputws lo orientara a ancho y los fprintf posteriores se perderan.
+inline void OutputDebugStringW(const wchar_t* msg) { fprintf(stderr, "%ls", msg); }
+#endif
+
+// Vectores y matrices del motor (tambin define SRT_SIMD_SSE2 / SRT_SIMD_AVX2).
+#include "SRTMath.h"
 
 // MACROS PARA MANEJO DE RECURSOS Y DEPURACIN
 
@@ -51,36 +75,40 @@
 
    // ESTRUCTURAS PARA SHADERS Y CONSTANTES
 
+#ifdef _WIN32
+
    /**
     * @brief Representa un vrtice con posicin y coordenadas de textura.
     */
 struct SimpleVertex {
-    XMFLOAT3 Pos; ///< Posicin del vrtice.
-    XMFLOAT2 Tex; ///< Coordenadas de textura.
+    Float3 Pos; ///< Posicin del vrtice.
+    Float2 Tex; ///< Coordenadas de textura.
 };
 
 /**
  * @brief Contiene la matriz de vista para las transformaciones de cmara.
  */
 struct CBNeverChanges {
-    XMMATRIX mView; ///< Matriz de vista.
+    Matrix mView; ///< Matriz de vista.
 };
 
 /**
  * @brief Contiene la matriz de proyeccin, actualizada en cambios de tamao de ventana.
  */
 struct CBChangeOnResize {
-    XMMATRIX mProjection; ///< Matriz de proyeccin.
+    Matrix mProjection; ///< Matriz de proyeccin.
 };
 
 /**
  * @brief Contiene la matriz del mundo y el color de la malla, que pueden cambiar cada fotograma.
  */
 struct CBChangesEveryFrame {
-    XMMATRIX mWorld;     ///< Matriz de transformacin del mundo.
-    XMFLOAT4 vMeshColor; ///< Color de la malla.
+    Matrix mWorld;     ///< Matriz de transformacin del mundo.
+    Float4 vMeshColor; ///< Color de la malla.
 };
 
+#endif // _WIN32
+
 /**
  * @brief Define los tipos de extensin de imagen compatibles con el sistema.
  */
@@ -0,0 +1,112 @@
+#pragma once
+#include "Prerequisites.h"
+#include "CommandList.h"
+#include "StateCache.h"
+#include <unordered_map>
+
+/**
+ * @class RecordingContext
+ * @brief Contexto simulado que filtra con StateCache igual que DeviceContext y cuenta las
+ * llamadas que llegarían al driver.
+ *
+ * Es un executor de CommandList (mismos métodos que replay() espera), así que sirve para
+ * medir sin Direct3D cuántas llamadas de estado deja pasar la caché con una lista concreta,
+ * por ejemplo la que graba RenderQueue::submit, o como backend nulo de CommandQueue.
+ *
+ * Además lleva una copia de lo que el driver tiene enlazado en los SRV del pixel shader,
+ * aplicando la regla de riesgos de D3D11: al enlazar un render target o depth stencil se
+ * desenlazan los SRV de ese recurso, y un SRV de un recurso que es target se enlaza a nulo.
+ * La misma copia se lleva también como si todas las llamadas pasaran sin filtrar; cada draw
+ * compara las dos y cuenta en getStaleDrawCount() los que ven un SRV distinto por culpa de la
+ * caché. registerView() dice qué recurso hay detrás de cada vista; las vistas sin registrar
+ * tienen recurso desconocido.
+ */
+class RecordingContext {
+public:
+    /// Llamadas al driver que se cuentan.
+    enum Call {
+        CALL_INPUT_LAYOUT = 0,
+        CALL_VERTEX_BUFFERS,
+        CALL_INDEX_BUFFER,
+        CALL_PRIMITIVE_TOPOLOGY,
+        CALL_VS_SET_SHADER,
+        CALL_PS_SET_SHADER,
+        CALL_VS_CONSTANT_BUFFERS,
+        CALL_PS_CONSTANT_BUFFERS,
+        CALL_PS_SHADER_RESOURCES,
+        CALL_PS_SAMPLERS,
+        CALL_VIEWPORTS,
+        CALL_RENDER_TARGETS,
+        CALL_UPDATE_SUBRESOURCE,
+        CALL_DRAW_INDEXED,
+        CALL_DRAW_INDEXED_INSTANCED,
+        CALL_COUNT
+    };
+
+    RecordingContext() { reset(); }
+
+    /// Pone los contadores a cero y vuelve al estado inicial (como ClearState).
+    void reset();
+
+    /// Equivalente a DeviceContext::ClearState: el driver queda sin nada enlazado.
+    void ClearState();
+
+    /// Registra el recurso (textura) que hay detrás de una vista SRV, RTV o DSV.
+    void registerView(const void* view, const void* resource);
+
+    /// Llamadas de un tipo que llegaron al driver.
+    unsigned int getCallCount(Call call) const { return m_calls[call]; }
+
+    /// Llamadas de estado (todas menos UpdateSubresource y los draws) que llegaron al driver.
+    unsigned int getStateCallCount() const;
+
+    /// Draws con algún SRV distinto del que habría sin filtrar las llamadas.
+    unsigned int getStaleDrawCount() const { return m_staleDraws; }
+
+    /// SRV que tiene enlazado el driver en un slot del pixel shader.
+    const void* getDriverShaderResource(unsigned int slot) const { return m_driverViews[slot]; }
+
+    /// Reproduce una CommandList sobre el contexto.
+    void executeCommandList(const CommandList& commandList);
+
+    // Executor de CommandList::replay.
+    void setInputLayout(const void* inputLayout);
+    void setVertexBuffer(unsigned int slot, const void* buffer, unsigned int stride, unsigned int offset);
+    void setIndexBuffer(const void* buffer, CommandList::IndexWidth width, unsigned int offset);
+    void setPrimitiveTopology(unsigned int topology);
+    void setShader(StateCache::Stage stage, const void* shader);
+    void setConstantBuffer(StateCache::Stage stage, unsigned int slot, const void* buffer);
+    void setConstantBufferRange(StateCache::Stage stage, unsigned int slot, const void* buffer,
+                                unsigned int firstConstant, unsigned int numConstants);
+    void setShaderResource(StateCache::Stage stage, unsigned int slot, const void* view);
+    void setSampler(StateCache::Stage stage, unsigned int slot, const void* sampler);
+    void setViewport(const CommandList::Viewport& viewport);
+    void setRenderTargets(unsigned int numViews, const void* const* renderTargetViews, const void* depthStencilView);
+    void updateConstantBuffer(const void* buffer, const void* data, unsigned int size);
+    void drawIndexed(unsigned int indexCount, unsigned int startIndexLocation, int baseVertexLocation);
+    void drawIndexedInstanced(unsigned int indexCountPerInstance, unsigned int instanceCount,
+                              unsigned int startIndexLocation, int baseVertexLocation,
+                              unsigned int startInstanceLocation);
+
+public:
+    /// Copia en sombra del estado; se usa igual que la de DeviceContext.
+    StateCache m_stateCache;
+
+private:
+    void checkStaleViews();
+    const void* resourceOf(const void* view) const;
+    static bool isTarget(const void* const* targets, const void* resource);
+    void bindTargets(const void** targets, const void** views, unsigned int numViews,
+                     const void* const* renderTargetViews, const void* depthStencilView) const;
+
+private:
+    unsigned int m_calls[CALL_COUNT];
+    unsigned int m_staleDraws = 0;
+    std::unordered_map<const void*, const void*> m_viewResources;
+
+    // Recursos enlazados como target y SRV en el driver, con las llamadas filtradas y sin filtrar.
+    const void* m_driverTargets[StateCache::MAX_RENDER_TARGETS + 1];
+    const void* m_driverViews[StateCache::MAX_SHADER_RESOURCES];
+    const void* m_expectedTargets[StateCache::MAX_RENDER_TARGETS + 1];
+    const void* m_expectedViews[StateCache::MAX_SHADER_RESOURCES];
+};
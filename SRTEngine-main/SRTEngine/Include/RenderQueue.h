@@ -0,0 +1,140 @@
+#pragma once
+#include "Prerequisites.h"
+#include "CommandList.h"
+#include "JobSystem.h"
+
+/**
+ * @class RenderQueue
+ * @brief Cola de draws ordenada por una clave de 64 bits antes de grabarla en una CommandList.
+ *
+ * Cada draw lleva una clave con, de más a menos significativo, pasada, capa, shader,
+ * material, textura y profundidad (makeKey). Al ordenar por la clave los draws que comparten
+ * shader quedan juntos, dentro de ellos los que comparten material y textura, y los opacos
+ * de cada grupo van de delante hacia atrás. Las pasadas transparentes usan
+ * makeBackToFrontKey, que pone la profundidad invertida justo después de la capa.
+ *
+ * La ordenación es un radix sort LSD de 11 bits por pasada, estable, que se salta las
+ * pasadas en las que todas las claves tienen el mismo dígito (lo normal en los bits de
+ * pasada y capa). Con un JobSystem los histogramas y el reparto de cada pasada se hacen por
+ * tramos en paralelo.
+ *
+ * submit() graba los draws en orden y solo los binds que cambian respecto al draw anterior,
+ * así que la lista sale ya sin estado redundante y el número de cambios se puede comparar
+ * con y sin ordenar (setSortEnabled). Las constantes tampoco se vuelven a copiar si el draw
+ * anterior subió el mismo puntero al mismo búfer (los tramos de un mismo objeto), así que
+ * el contenido de Draw::constants no debe cambiar entre add() y submit().
+ */
+class RenderQueue {
+public:
+    /// Bits de cada campo de la clave.
+    static const unsigned int PASS_BITS = 4;
+    static const unsigned int LAYER_BITS = 4;
+    static const unsigned int SHADER_BITS = 12;
+    static const unsigned int MATERIAL_BITS = 12;
+    static const unsigned int TEXTURE_BITS = 12;
+    static const unsigned int DEPTH_BITS = 20;
+
+    /// Draw indexado con sus recursos como punteros opacos (mismo convenio que CommandList).
+    struct Draw {
+        const void* inputLayout = nullptr;
+        const void* vertexShader = nullptr;
+        const void* pixelShader = nullptr;
+        const void* vertexBuffer = nullptr;
+        unsigned int vertexStride = 0;
+        const void* indexBuffer = nullptr;
+        CommandList::IndexWidth indexWidth = CommandList::INDEX_16;
+        const void* constantBuffer = nullptr; ///< Slot 2 de VS y PS (constantes del objeto/material).
+        unsigned int firstConstant = 0;       ///< Con numConstants > 0 se enlaza solo ese rango
+        unsigned int numConstants = 0;        ///< (p. ej. una asignación del anillo de constantes).
+        const void* constants = nullptr;      ///< Sin rango, se copia a constantBuffer antes del draw.
+        unsigned int constantsSize = 0;
+        const void* texture = nullptr;        ///< Slot 0 del PS.
+        unsigned int indexCount = 0;
+        unsigned int startIndexLocation = 0;
+        int baseVertexLocation = 0;
+    };
+
+    /// Contadores del último sort() y submit().
+    struct Stats {
+        unsigned int draws = 0;
+        unsigned int stateChanges = 0;       ///< Suma de los cambios de abajo.
+        unsigned int inputLayoutChanges = 0;
+        unsigned int shaderChanges = 0;      ///< VS y PS cuentan por separado.
+        unsigned int bufferChanges = 0;      ///< Búferes de vértices e índices.
+        unsigned int constantChanges = 0;    ///< Binds del búfer de constantes.
+        unsigned int constantUploads = 0;    ///< Copias de constants (no cuentan en stateChanges).
+        unsigned int textureChanges = 0;
+        unsigned int radixPasses = 0;        ///< Pasadas de 11 bits que no se pudieron saltar.
+        double sortSeconds = 0.0;
+        double submitSeconds = 0.0;
+    };
+
+    RenderQueue() = default;
+
+    RenderQueue(const RenderQueue&) = delete;
+    RenderQueue& operator=(const RenderQueue&) = delete;
+
+    /**
+     * @brief Prepara la cola.
+     * @param jobs Sistema de trabajos para ordenar en paralelo (nullptr = en el hilo que llama).
+     */
+    HRESULT init(JobSystem* jobs = nullptr);
+
+    void destroy();
+
+    /// Vacía la cola conservando la memoria reservada.
+    void clear();
+
+    void reserve(unsigned int drawCount);
+
+    /// Encola un draw; los punteros de draw (y constants) tienen que seguir vivos hasta submit().
+    void add(uint64_t key, const Draw& draw);
+
+    /// Ordena los draws por clave (submit() lo hace si hace falta).
+    void sort();
+
+    /**
+     * @brief Graba los draws ordenados en commandList, con los binds mínimos.
+     * Empieza con la topología de lista de triángulos y sin suponer nada del estado anterior.
+     */
+    void submit(CommandList& commandList);
+
+    /// Activa o desactiva la ordenación; desactivada, los draws salen en el orden de add().
+    void setSortEnabled(bool enabled) { m_sortEnabled = enabled; }
+
+    unsigned int getDrawCount() const { return (unsigned int)m_draws.size(); }
+
+    /// Clave en la posición dada tras sort().
+    uint64_t getSortedKey(unsigned int position) const { return m_entries[position].key; }
+
+    const Stats& getStats() const { return m_stats; }
+
+    /**
+     * @brief Clave de un draw que se ordena por estado y después de delante hacia atrás.
+     * @param depth Profundidad normalizada en [0, 1] (0 = plano cercano).
+     */
+    static uint64_t makeKey(unsigned int pass, unsigned int layer, unsigned int shader,
+                            unsigned int material, unsigned int texture, float depth);
+
+    /// Clave de un draw transparente: de atrás hacia delante antes que por estado.
+    static uint64_t makeBackToFrontKey(unsigned int pass, unsigned int layer, float depth,
+                                       unsigned int shader, unsigned int material, unsigned int texture);
+
+private:
+    struct Entry {
+        uint64_t key;
+        uint32_t draw;
+    };
+
+    void radixSort();
+
+private:
+    JobSystem* m_jobs = nullptr;
+    std::vector<Draw> m_draws;
+    std::vector<Entry> m_entries;     ///< Clave e índice en m_draws, ordenados tras sort().
+    std::vector<Entry> m_scratch;
+    std::vector<uint32_t> m_histograms; ///< Contadores de cada dígito por tramo.
+    bool m_sorted = true;
+    bool m_sortEnabled = true;
+    Stats m_stats;
+};
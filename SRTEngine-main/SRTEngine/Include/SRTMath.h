@@ -0,0 +1,425 @@
+#pragma once
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+// Conjunto de instrucciones SIMD disponible en tiempo de compilación.
+#if defined(__AVX2__)
+#define SRT_SIMD_AVX2 1
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define SRT_SIMD_SSE2 1
+#endif
+
+// SRT_MATH_SCALAR fuerza la versión sin SIMD (sirve de referencia y para otras arquitecturas).
+#if defined(SRT_SIMD_SSE2) && !defined(SRT_MATH_SCALAR)
+#define SRT_MATH_SSE 1
+#include <emmintrin.h>
+#endif
+
+/**
+ * @file SRTMath.h
+ * @brief Vectores, matrices y cuaterniones del motor (sustituye a xnamath).
+ *
+ * Mismas convenciones que xnamath: sistema de mano izquierda, vectores fila (v * M) y
+ * matrices guardadas por filas, así que para subirlas a un constant buffer de HLSL se
+ * transponen con MatrixTranspose(). Los cuaterniones son (x, y, z, w) y
+ * QuaternionMultiply(q1, q2) aplica primero q1 y luego q2.
+ *
+ * Vector es el tipo de cálculo (un registro SSE con SSE2, cuatro floats si no). Float2,
+ * Float3 y Float4 son los tipos de almacenamiento para vértices y constantes; se pasa de
+ * unos a otros con VectorLoad / VectorStore.
+ *
+ * Las operaciones suman en el mismo orden en SSE y en escalar, así que sin contracción a
+ * FMA las dos versiones dan exactamente el mismo resultado. Las funciones *Stream
+ * transforman arrays enteros y usan AVX2 si está disponible.
+ */
+
+const float MATH_PI = 3.141592654f;
+const float MATH_2PI = 6.283185307f;
+const float MATH_PIDIV2 = 1.570796327f;
+const float MATH_PIDIV4 = 0.785398163f;
+
+#if defined(SRT_MATH_SSE)
+typedef __m128 Vector;
+#else
+struct alignas(16) Vector {
+    float v[4];
+};
+#endif
+
+/// Dos floats sin alinear (coordenadas de textura).
+struct Float2 {
+    float x, y;
+
+    Float2() = default;
+    Float2(float _x, float _y) : x(_x), y(_y) {}
+};
+
+/// Tres floats sin alinear (posiciones y normales).
+struct Float3 {
+    float x, y, z;
+
+    Float3() = default;
+    Float3(float _x, float _y, float _z) : x(_x), y(_y), z(_z) {}
+};
+
+/// Cuatro floats sin alinear (colores, cuaterniones guardados).
+struct Float4 {
+    float x, y, z, w;
+
+    Float4() = default;
+    Float4(float _x, float _y, float _z, float _w) : x(_x), y(_y), z(_z), w(_w) {}
+};
+
+/**
+ * @brief Matriz 4x4 por filas; r[3] es la traslación.
+ */
+struct alignas(16) Matrix {
+    Vector r[4];
+
+    Matrix() = default;
+    Matrix(float m00, float m01, float m02, float m03,
+           float m10, float m11, float m12, float m13,
+           float m20, float m21, float m22, float m23,
+           float m30, float m31, float m32, float m33);
+};
+
+// ---------------------------------------------------------------------------------------
+// Operaciones básicas (las únicas con dos implementaciones)
+// ---------------------------------------------------------------------------------------
+
+#if defined(SRT_MATH_SSE)
+
+inline Vector VectorSet(float x, float y, float z, float w) { return _mm_setr_ps(x, y, z, w); }
+inline Vector VectorReplicate(float value) { return _mm_set1_ps(value); }
+inline Vector VectorZero() { return _mm_setzero_ps(); }
+
+inline float VectorGetX(Vector v) { return _mm_cvtss_f32(v); }
+inline float VectorGetY(Vector v) { return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))); }
+inline float VectorGetZ(Vector v) { return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))); }
+inline float VectorGetW(Vector v) { return _mm_cvtss_f32(_mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3))); }
+
+inline Vector VectorSplatX(Vector v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)); }
+inline Vector VectorSplatY(Vector v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1)); }
+inline Vector VectorSplatZ(Vector v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2)); }
+inline Vector VectorSplatW(Vector v) { return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3)); }
+
+inline Vector VectorAdd(Vector a, Vector b) { return _mm_add_ps(a, b); }
+inline Vector VectorSubtract(Vector a, Vector b) { return _mm_sub_ps(a, b); }
+inline Vector VectorMultiply(Vector a, Vector b) { return _mm_mul_ps(a, b); }
+inline Vector VectorDivide(Vector a, Vector b) { return _mm_div_ps(a, b); }
+inline Vector VectorMin(Vector a, Vector b) { return _mm_min_ps(a, b); }
+inline Vector VectorMax(Vector a, Vector b) { return _mm_max_ps(a, b); }
+inline Vector VectorSqrt(Vector v) { return _mm_sqrt_ps(v); }
+
+inline Vector VectorLoad(const Float3& f) {
+    // x e y en una carga de 8 bytes; z aparte para no leer más allá del Float3.
+    const __m128 xy = _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(&f.x)));
+    return _mm_movelh_ps(xy, _mm_load_ss(&f.z));
+}
+inline Vector VectorLoad(const Float4& f) { return _mm_loadu_ps(&f.x); }
+inline void VectorStore(Float3& f, Vector v) {
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(&f.x), _mm_castps_si128(v));
+    _mm_store_ss(&f.z, _mm_movehl_ps(v, v));
+}
+inline void VectorStore(Float4& f, Vector v) { _mm_storeu_ps(&f.x, v); }
+
+/// Producto escalar de x, y, z replicado en los cuatro componentes.
+inline Vector Vector3Dot(Vector a, Vector b) {
+    const __m128 m = _mm_mul_ps(a, b);
+    __m128 sum = _mm_add_ss(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 1, 1, 1)));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 2, 2, 2)));
+    return _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(0, 0, 0, 0));
+}
+
+/// Producto escalar de los cuatro componentes, replicado.
+inline Vector Vector4Dot(Vector a, Vector b) {
+    const __m128 m = _mm_mul_ps(a, b);
+    __m128 sum = _mm_add_ss(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 1, 1, 1)));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 2, 2, 2)));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(m, m, _MM_SHUFFLE(3, 3, 3, 3)));
+    return _mm_shuffle_ps(sum, sum, _MM_SHUFFLE(0, 0, 0, 0));
+}
+
+/// Producto vectorial de x, y, z (w = 0).
+inline Vector Vector3Cross(Vector a, Vector b) {
+    const __m128 aYZX = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+    const __m128 bZXY = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 1, 0, 2));
+    const __m128 aZXY = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 1, 0, 2));
+    const __m128 bYZX = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+    const __m128 cross = _mm_sub_ps(_mm_mul_ps(aYZX, bZXY), _mm_mul_ps(aZXY, bYZX));
+    return _mm_and_ps(cross, _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0)));
+}
+
+/// Componentes de a donde value > 0 y cero en el resto.
+inline Vector VectorSelectPositive(Vector a, Vector value) {
+    return _mm_and_ps(a, _mm_cmpgt_ps(value, _mm_setzero_ps()));
+}
+
+/// Transpone una matriz 4x4.
+inline Matrix MatrixTranspose(const Matrix& m) {
+    Matrix t = m;
+    _MM_TRANSPOSE4_PS(t.r[0], t.r[1], t.r[2], t.r[3]);
+    return t;
+}
+
+#else
+
+inline Vector VectorSet(float x, float y, float z, float w) { return Vector{ { x, y, z, w } }; }
+inline Vector VectorReplicate(float value) { return Vector{ { value, value, value, value } }; }
+inline Vector VectorZero() { return Vector{ { 0.0f, 0.0f, 0.0f, 0.0f } }; }
+
+inline float VectorGetX(Vector v) { return v.v[0]; }
+inline float VectorGetY(Vector v) { return v.v[1]; }
+inline float VectorGetZ(Vector v) { return v.v[2]; }
+inline float VectorGetW(Vector v) { return v.v[3]; }
+
+inline Vector VectorSplatX(Vector v) { return VectorReplicate(v.v[0]); }
+inline Vector VectorSplatY(Vector v) { return VectorReplicate(v.v[1]); }
+inline Vector VectorSplatZ(Vector v) { return VectorReplicate(v.v[2]); }
+inline Vector VectorSplatW(Vector v) { return VectorReplicate(v.v[3]); }
+
+inline Vector VectorAdd(Vector a, Vector b) { for (int i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+inline Vector VectorSubtract(Vector a, Vector b) { for (int i = 0; i < 4; ++i) a.v[i] -= b.v[i]; return a; }
+inline Vector VectorMultiply(Vector a, Vector b) { for (int i = 0; i < 4; ++i) a.v[i] *= b.v[i]; return a; }
+inline Vector VectorDivide(Vector a, Vector b) { for (int i = 0; i < 4; ++i) a.v[i] /= b.v[i]; return a; }
+inline Vector VectorMin(Vector a, Vector b) { for (int i = 0; i < 4; ++i) a.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i]; return a; }
+inline Vector VectorMax(Vector a, Vector b) { for (int i = 0; i < 4; ++i) a.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i]; return a; }
+inline Vector VectorSqrt(Vector v) { for (int i = 0; i < 4; ++i) v.v[i] = std::sqrt(v.v[i]); return v; }
+
+inline Vector VectorLoad(const Float3& f) { return Vector{ { f.x, f.y, f.z, 0.0f } }; }
+inline Vector VectorLoad(const Float4& f) { return Vector{ { f.x, f.y, f.z, f.w } }; }
+inline void VectorStore(Float3& f, Vector v) { f = Float3(v.v[0], v.v[1], v.v[2]); }
+inline void VectorStore(Float4& f, Vector v) { f = Float4(v.v[0], v.v[1], v.v[2], v.v[3]); }
+
+inline Vector Vector3Dot(Vector a, Vector b) {
+    return VectorReplicate(a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2]);
+}
+
+inline Vector Vector4Dot(Vector a, Vector b) {
+    return VectorReplicate(a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2] + a.v[3] * b.v[3]);
+}
+
+inline Vector Vector3Cross(Vector a, Vector b) {
+    return VectorSet(a.v[1] * b.v[2] - a.v[2] * b.v[1],
+                     a.v[2] * b.v[0] - a.v[0] * b.v[2],
+                     a.v[0] * b.v[1] - a.v[1] * b.v[0], 0.0f);
+}
+
+inline Vector VectorSelectPositive(Vector a, Vector value) {
+    for (int i = 0; i < 4; ++i) a.v[i] = value.v[i] > 0.0f ? a.v[i] : 0.0f;
+    return a;
+}
+
+inline Matrix MatrixTranspose(const Matrix& m) {
+    Matrix t;
+    for (int row = 0; row < 4; ++row)
+        for (int col = 0; col < 4; ++col)
+            t.r[row].v[col] = m.r[col].v[row];
+    return t;
+}
+
+#endif
+
+// ---------------------------------------------------------------------------------------
+// Vectores
+// ---------------------------------------------------------------------------------------
+
+inline Vector VectorNegate(Vector v) { return VectorSubtract(VectorZero(), v); }
+inline Vector VectorScale(Vector v, float scale) { return VectorMultiply(v, VectorReplicate(scale)); }
+inline Vector VectorMultiplyAdd(Vector a, Vector b, Vector c) { return VectorAdd(VectorMultiply(a, b), c); }
+inline Vector VectorLerp(Vector a, Vector b, float t) {
+    return VectorAdd(a, VectorMultiply(VectorSubtract(b, a), VectorReplicate(t)));
+}
+
+inline Vector Vector3LengthSq(Vector v) { return Vector3Dot(v, v); }
+inline Vector Vector3Length(Vector v) { return VectorSqrt(Vector3Dot(v, v)); }
+inline Vector Vector4Length(Vector v) { return VectorSqrt(Vector4Dot(v, v)); }
+
+/// Normaliza x, y, z; un vector de longitud cero da cero (no NaN).
+inline Vector Vector3Normalize(Vector v) {
+    const Vector length = Vector3Length(v);
+    return VectorSelectPositive(VectorDivide(v, length), length);
+}
+
+inline Vector Vector4Normalize(Vector v) {
+    const Vector length = Vector4Length(v);
+    return VectorSelectPositive(VectorDivide(v, length), length);
+}
+
+// ---------------------------------------------------------------------------------------
+// Matrices
+// ---------------------------------------------------------------------------------------
+
+inline Matrix::Matrix(float m00, float m01, float m02, float m03,
+                      float m10, float m11, float m12, float m13,
+                      float m20, float m21, float m22, float m23,
+                      float m30, float m31, float m32, float m33) {
+    r[0] = VectorSet(m00, m01, m02, m03);
+    r[1] = VectorSet(m10, m11, m12, m13);
+    r[2] = VectorSet(m20, m21, m22, m23);
+    r[3] = VectorSet(m30, m31, m32, m33);
+}
+
+inline Matrix MatrixIdentity() {
+    return Matrix(1.0f, 0.0f, 0.0f, 0.0f,
+                  0.0f, 1.0f, 0.0f, 0.0f,
+                  0.0f, 0.0f, 1.0f, 0.0f,
+                  0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+/// Carga 16 floats por filas (por ejemplo de un constant buffer ya transpuesto).
+inline Matrix MatrixLoad(const float* m) {
+    return Matrix(m[0], m[1], m[2], m[3], m[4], m[5], m[6], m[7],
+                  m[8], m[9], m[10], m[11], m[12], m[13], m[14], m[15]);
+}
+
+/// v * M con v = (x, y, z, w).
+inline Vector Vector4Transform(Vector v, const Matrix& m) {
+    Vector result = VectorMultiply(VectorSplatX(v), m.r[0]);
+    result = VectorAdd(result, VectorMultiply(VectorSplatY(v), m.r[1]));
+    result = VectorAdd(result, VectorMultiply(VectorSplatZ(v), m.r[2]));
+    return VectorAdd(result, VectorMultiply(VectorSplatW(v), m.r[3]));
+}
+
+/// v * M con w = 1 (punto); devuelve el resultado homogéneo sin dividir.
+inline Vector Vector3Transform(Vector v, const Matrix& m) {
+    Vector result = VectorMultiply(VectorSplatX(v), m.r[0]);
+    result = VectorAdd(result, VectorMultiply(VectorSplatY(v), m.r[1]));
+    result = VectorAdd(result, VectorMultiply(VectorSplatZ(v), m.r[2]));
+    return VectorAdd(result, m.r[3]);
+}
+
+/// Como Vector3Transform pero dividiendo entre w.
+inline Vector Vector3TransformCoord(Vector v, const Matrix& m) {
+    const Vector result = Vector3Transform(v, m);
+    return VectorDivide(result, VectorSplatW(result));
+}
+
+/// v * M con w = 0 (dirección: sin traslación).
+inline Vector Vector3TransformNormal(Vector v, const Matrix& m) {
+    Vector result = VectorMultiply(VectorSplatX(v), m.r[0]);
+    result = VectorAdd(result, VectorMultiply(VectorSplatY(v), m.r[1]));
+    return VectorAdd(result, VectorMultiply(VectorSplatZ(v), m.r[2]));
+}
+
+/// a * b: primero se aplica a y luego b.
+inline Matrix MatrixMultiply(const Matrix& a, const Matrix& b) {
+    Matrix result;
+    result.r[0] = Vector4Transform(a.r[0], b);
+    result.r[1] = Vector4Transform(a.r[1], b);
+    result.r[2] = Vector4Transform(a.r[2], b);
+    result.r[3] = Vector4Transform(a.r[3], b);
+    return result;
+}
+
+inline Matrix MatrixTranslation(float x, float y, float z) {
+    return Matrix(1.0f, 0.0f, 0.0f, 0.0f,
+                  0.0f, 1.0f, 0.0f, 0.0f,
+                  0.0f, 0.0f, 1.0f, 0.0f,
+                  x, y, z, 1.0f);
+}
+
+inline Matrix MatrixScaling(float x, float y, float z) {
+    return Matrix(x, 0.0f, 0.0f, 0.0f,
+                  0.0f, y, 0.0f, 0.0f,
+                  0.0f, 0.0f, z, 0.0f,
+                  0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+Matrix MatrixRotationX(float angle);
+Matrix MatrixRotationY(float angle);
+Matrix MatrixRotationZ(float angle);
+
+/// Giro de angle radianes alrededor de un eje (no hace falta que esté normalizado).
+Matrix MatrixRotationAxis(Vector axis, float angle);
+
+/// Matriz de giro de un cuaternión unitario.
+Matrix MatrixRotationQuaternion(Vector quaternion);
+
+/// Escala, luego giro y luego traslación (la transformación local de un nodo).
+Matrix MatrixScaleRotationTranslation(Vector scale, Vector rotation, Vector translation);
+
+/**
+ * @brief Inversa general de una matriz 4x4.
+ * @param determinant Si no es nullptr recibe el determinante; con 0 la inversa no existe
+ * y se devuelve la identidad.
+ */
+Matrix MatrixInverse(const Matrix& m, float* determinant = nullptr);
+
+/// Proyección en perspectiva de mano izquierda (profundidad de 0 en near a 1 en far).
+Matrix MatrixPerspectiveFovLH(float fovY, float aspect, float nearZ, float farZ);
+
+/// Proyección ortográfica de mano izquierda centrada en el origen.
+Matrix MatrixOrthographicLH(float width, float height, float nearZ, float farZ);
+
+/// Vista desde eye mirando hacia direction.
+Matrix MatrixLookToLH(Vector eye, Vector direction, Vector up);
+
+/// Vista desde eye mirando al punto at.
+Matrix MatrixLookAtLH(Vector eye, Vector at, Vector up);
+
+// ---------------------------------------------------------------------------------------
+// Cuaterniones
+// ---------------------------------------------------------------------------------------
+
+inline Vector QuaternionIdentity() { return VectorSet(0.0f, 0.0f, 0.0f, 1.0f); }
+
+inline Vector QuaternionConjugate(Vector q) {
+    return VectorMultiply(q, VectorSet(-1.0f, -1.0f, -1.0f, 1.0f));
+}
+
+inline Vector QuaternionNormalize(Vector q) { return Vector4Normalize(q); }
+
+/// Giro q1 seguido de q2 (producto de Hamilton q2 * q1).
+inline Vector QuaternionMultiply(Vector q1, Vector q2) {
+    const float ax = VectorGetX(q2), ay = VectorGetY(q2), az = VectorGetZ(q2), aw = VectorGetW(q2);
+    const float bx = VectorGetX(q1), by = VectorGetY(q1), bz = VectorGetZ(q1), bw = VectorGetW(q1);
+    return VectorSet(aw * bx + ax * bw + ay * bz - az * by,
+                     aw * by - ax * bz + ay * bw + az * bx,
+                     aw * bz + ax * by - ay * bx + az * bw,
+                     aw * bw - ax * bx - ay * by - az * bz);
+}
+
+/// Gira un vector con un cuaternión unitario (igual que transformarlo con su matriz).
+inline Vector Vector3Rotate(Vector v, Vector q) {
+    const Vector twice = VectorReplicate(2.0f);
+    const Vector t = VectorMultiply(Vector3Cross(q, v), twice);
+    return VectorAdd(VectorAdd(v, VectorMultiply(VectorSplatW(q), t)), Vector3Cross(q, t));
+}
+
+/// Cuaternión de un giro de angle radianes alrededor de un eje (no hace falta normalizarlo).
+Vector QuaternionRotationAxis(Vector axis, float angle);
+
+/// Giro roll (Z), luego pitch (X) y luego yaw (Y), como MatrixRotationZ * X * Y.
+Vector QuaternionRotationRollPitchYaw(float pitch, float yaw, float roll);
+
+/// Interpolación esférica por el camino más corto.
+Vector QuaternionSlerp(Vector q0, Vector q1, float t);
+
+// ---------------------------------------------------------------------------------------
+// Transformaciones por lotes
+// ---------------------------------------------------------------------------------------
+
+/**
+ * @brief out[i] = in[i] * m para count matrices (out puede ser in).
+ */
+void MatrixMultiplyStream(Matrix* out, const Matrix* in, size_t count, const Matrix& m);
+
+/**
+ * @brief Transforma count puntos (w = 1) y escribe x, y, z, w sin dividir.
+ *
+ * Entrada y salida llevan su propio paso en bytes, así que se puede leer la posición de
+ * un vértice entrelazado y escribir en otra estructura. Cada salida ocupa 16 bytes.
+ */
+void Vector3TransformStream(void* out, size_t outStride, const void* in, size_t inStride,
+                            size_t count, const Matrix& m);
+
+/// Transforma count puntos dividiendo entre w (salida de 12 bytes por punto).
+void Vector3TransformCoordStream(void* out, size_t outStride, const void* in, size_t inStride,
+                                 size_t count, const Matrix& m);
+
+/// Transforma count direcciones sin traslación (salida de 12 bytes por vector).
+void Vector3TransformNormalStream(void* out, size_t outStride, const void* in, size_t inStride,
+                                  size_t count, const Matrix& m);
@@ -0,0 +1,319 @@
+#pragma once
+#include "Prerequisites.h"
+#include "VertexFormat.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+class CommandList;
+
+/**
+ * @brief Formato de los índices del rasterizador por software
+ * (equivalente a DXGI_FORMAT_R16_UINT / DXGI_FORMAT_R32_UINT).
+ */
+enum SoftIndexFormat {
+    SOFT_INDEX_16 = 0, ///< Índices de 16 bits (WORD).
+    SOFT_INDEX_32 = 1  ///< Índices de 32 bits.
+};
+
+/**
+ * @brief Modo de descarte de caras (equivalente a D3D11_CULL_MODE).
+ */
+enum SoftCullMode {
+    SOFT_CULL_NONE = 0,  ///< Dibuja ambas caras.
+    SOFT_CULL_FRONT = 1, ///< Descarta las caras frontales.
+    SOFT_CULL_BACK = 2   ///< Descarta las caras traseras (valor por defecto de D3D11).
+};
+
+/**
+ * @brief Búfer en memoria de sistema: vértices, índices o constantes.
+ */
+struct SoftBuffer {
+    std::vector<uint8_t> m_data; ///< Contenido del búfer.
+};
+
+/**
+ * @brief Textura RGBA8 (mismo orden de bytes que DXGI_FORMAT_R8G8B8A8_UNORM).
+ */
+struct SoftTexture {
+    unsigned int m_width = 0;        ///< Ancho en texeles.
+    unsigned int m_height = 0;       ///< Alto en texeles.
+    std::vector<uint32_t> m_texels;  ///< Texeles, fila por fila.
+};
+
+/**
+ * @brief Formato de los vértices del slot 0 (equivalente al input layout que sale de
+ * VertexFormat::getInputElements). Se leen POSITION y TEXCOORD en cualquier codificación de
+ * VertexFormat, convertidos como lo haría la GPU (UNORM16 en [0, 1], half a float).
+ */
+struct SoftInputLayout {
+    /// POSITION y TEXCOORD en float, como el SimpleVertex original.
+    SoftInputLayout();
+    explicit SoftInputLayout(const VertexFormat& format) : m_format(format) {}
+
+    VertexFormat m_format;
+};
+
+/**
+ * @brief Equivalente a D3D11_VIEWPORT.
+ */
+struct SoftViewport {
+    float TopLeftX = 0.0f;
+    float TopLeftY = 0.0f;
+    float Width = 0.0f;
+    float Height = 0.0f;
+    float MinDepth = 0.0f;
+    float MaxDepth = 1.0f;
+};
+
+/**
+ * @brief Render target de color RGBA8 con su búfer de profundidad.
+ *
+ * El pitch se redondea al tamaño de tile para que los bucles SIMD nunca se salgan de la fila.
+ */
+struct SoftRenderTarget {
+    unsigned int m_width = 0;      ///< Ancho visible en píxeles.
+    unsigned int m_height = 0;     ///< Alto visible en píxeles.
+    unsigned int m_pitch = 0;      ///< Píxeles por fila en memoria.
+    unsigned int m_rows = 0;       ///< Filas reservadas en memoria.
+    std::vector<uint32_t> m_color; ///< Color RGBA8.
+    std::vector<float> m_depth;    ///< Profundidad en [0, 1].
+};
+
+/**
+ * @class SoftRasterizer
+ * @brief Backend de rasterización por CPU con la misma superficie que DeviceContext.
+ *
+ * Rasteriza triángulos por tiles de 64x64 usando SSE2/AVX2 y reparte los tiles entre
+ * varios hilos. Los draws se transforman y se clasifican en tiles al llamar a DrawIndexed,
+ * y se rasterizan en flush() (que también llama present()), respetando el orden de envío
+ * dentro de cada tile.
+ *
+ * Los shaders son fijos y reproducen TurtleEngine.fx: los slots de constantes 0, 1 y 2
+ * contienen CBNeverChanges, CBChangeOnResize y CBChangesEveryFrame con las matrices
+ * transpuestas, tal y como las sube update(). DrawIndexedInstanced reproduce el shader de
+ * InstanceRenderer: el mundo y el color salen de cada InstanceData del slot 1 en lugar de
+ * CBChangesEveryFrame.
+ *
+ * Cada draw solo decodifica y transforma los vértices entre el menor y el mayor índice que
+ * usa, una vez para todas sus instancias la decodificación y una por instancia la
+ * transformación.
+ */
+class SoftRasterizer {
+public:
+    /**
+     * @brief Estadísticas acumuladas desde el último resetStats().
+     */
+    struct Stats {
+        uint64_t draws = 0;              ///< Llamadas a DrawIndexed y DrawIndexedInstanced.
+        uint64_t instances = 0;          ///< Instancias dibujadas (1 por DrawIndexed).
+        uint64_t verticesTransformed = 0;///< Vértices transformados, sumando todas las instancias.
+        uint64_t trianglesSubmitted = 0; ///< Triángulos enviados (por instancia).
+        uint64_t trianglesRasterized = 0;///< Triángulos que sobreviven al clipping y al culling.
+        uint64_t pixelsWritten = 0;      ///< Píxeles que pasan la prueba de profundidad.
+        double setupSeconds = 0.0;       ///< Tiempo de transformación y binning.
+        double rasterSeconds = 0.0;      ///< Tiempo de rasterización de tiles.
+    };
+
+    SoftRasterizer() = default;
+    ~SoftRasterizer();
+
+    /**
+     * @brief Crea el render target y los hilos de trabajo.
+     * @param width Ancho del render target.
+     * @param height Alto del render target.
+     * @param threadCount Número de hilos de rasterización (0 = núcleos disponibles).
+     */
+    HRESULT init(unsigned int width, unsigned int height, unsigned int threadCount = 0);
+
+    /// Rasteriza todo lo pendiente (equivalente a SwapChain::present).
+    void present();
+
+    /// Detiene los hilos y libera la memoria.
+    void destroy();
+
+    /// Rasteriza los triángulos clasificados hasta ahora.
+    void flush();
+
+    void RSSetViewports(unsigned int NumViewports, const SoftViewport* pViewports);
+
+    void RSSetState(SoftCullMode cullMode);
+
+    void IASetInputLayout(const SoftInputLayout* pInputLayout);
+
+    /// Slot 0: vértices con el formato del input layout. Slot 1: InstanceData por instancia.
+    void IASetVertexBuffers(unsigned int StartSlot,
+        unsigned int NumBuffers,
+        const SoftBuffer* const* ppVertexBuffers,
+        const unsigned int* pStrides,
+        const unsigned int* pOffsets);
+
+    void IASetIndexBuffer(const SoftBuffer* pIndexBuffer,
+        SoftIndexFormat Format,
+        unsigned int Offset);
+
+    void VSSetConstantBuffers(unsigned int StartSlot,
+        unsigned int NumBuffers,
+        const SoftBuffer* const* ppConstantBuffers);
+
+    void PSSetConstantBuffers(unsigned int StartSlot,
+        unsigned int NumBuffers,
+        const SoftBuffer* const* ppConstantBuffers);
+
+    /**
+     * @brief Enlaza rangos de búferes constantes (equivalente a VSSetConstantBuffers1).
+     * @param pFirstConstant Primera constante de 16 bytes de cada rango (nullptr = 0).
+     */
+    void VSSetConstantBuffers1(unsigned int StartSlot,
+        unsigned int NumBuffers,
+        const SoftBuffer* const* ppConstantBuffers,
+        const unsigned int* pFirstConstant,
+        const unsigned int* pNumConstants);
+
+    void PSSetConstantBuffers1(unsigned int StartSlot,
+        unsigned int NumBuffers,
+        const SoftBuffer* const* ppConstantBuffers,
+        const unsigned int* pFirstConstant,
+        const unsigned int* pNumConstants);
+
+    void PSSetShaderResources(unsigned int StartSlot,
+        unsigned int NumViews,
+        const SoftTexture* const* ppShaderResourceViews);
+
+    /**
+     * @brief Copia datos de CPU a un búfer (equivalente a UpdateSubresource).
+     */
+    void UpdateSubresource(SoftBuffer* pDstResource, const void* pSrcData, size_t size);
+
+    void ClearRenderTargetView(const float ColorRGBA[4]);
+
+    void ClearDepthStencilView(float Depth);
+
+    void DrawIndexed(unsigned int IndexCount,
+        unsigned int StartIndexLocation,
+        int BaseVertexLocation);
+
+    /**
+     * @brief Dibuja InstanceCount copias leyendo el mundo y el color de cada una de las
+     * InstanceData del slot 1, a partir de StartInstanceLocation.
+     */
+    void DrawIndexedInstanced(unsigned int IndexCountPerInstance,
+        unsigned int InstanceCount,
+        unsigned int StartIndexLocation,
+        int BaseVertexLocation,
+        unsigned int StartInstanceLocation);
+
+    /**
+     * @brief Reproduce una CommandList. Los punteros opacos deben ser SoftBuffer,
+     * SoftTexture y SoftInputLayout; shaders, samplers y render targets se ignoran
+     * porque la tubería es fija y solo hay un render target.
+     */
+    void executeCommandList(const CommandList& commandList);
+
+    /// Devuelve y conserva las estadísticas acumuladas.
+    const Stats& getStats() const { return m_stats; }
+
+    /// Pone a cero las estadísticas.
+    void resetStats() { m_stats = Stats(); }
+
+    /// Número de hilos que rasterizan (incluye el hilo que llama a flush()).
+    unsigned int getThreadCount() const { return (unsigned int)m_workers.size() + 1; }
+
+public:
+    SoftRenderTarget m_renderTarget; ///< Render target de salida.
+
+    static const int TILE_SIZE = 64; ///< Lado de un tile en píxeles.
+
+private:
+    /// Vértice en espacio de recorte con sus atributos.
+    struct ClipVertex {
+        float x, y, z, w; ///< Posición homogénea.
+        float u, v;       ///< Coordenadas de textura.
+    };
+
+    /// Estado de pixel shader capturado en cada DrawIndexed.
+    struct DrawState {
+        const SoftTexture* texture; ///< Textura del slot 0 (nullptr = blanco).
+        float meshColor[4];         ///< vMeshColor de CBChangesEveryFrame.
+    };
+
+    /// Triángulo preparado para rasterizar: ecuaciones de arista y planos de atributos.
+    struct Triangle {
+        int32_t minX, minY, maxX, maxY; ///< Caja en píxeles, recortada al viewport.
+        int32_t edgeA[3];               ///< Coeficiente x de cada arista (subpíxeles).
+        int32_t edgeB[3];               ///< Coeficiente y de cada arista (subpíxeles).
+        int64_t edgeC[3];               ///< Término constante con la regla top-left aplicada.
+        float z[3];                     ///< Plano de profundidad (ddx, ddy, c).
+        float invW[3];                  ///< Plano de 1/w.
+        float uOverW[3];                ///< Plano de u/w.
+        float vOverW[3];                ///< Plano de v/w.
+        uint32_t drawIndex;             ///< Índice en m_draws.
+    };
+
+    struct DrawJob;
+
+    void drawInstances(unsigned int indexCount, unsigned int instanceCount,
+        unsigned int startIndexLocation, int baseVertexLocation,
+        unsigned int startInstanceLocation, bool instanced);
+    void setupTriangle(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2,
+        uint32_t drawIndex, std::vector<Triangle>& out) const;
+    void clipAndSetup(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2,
+        uint32_t drawIndex, std::vector<Triangle>& out) const;
+    void rasterizeTile(unsigned int tileIndex);
+    void runParallel(unsigned int jobCount, void (*job)(SoftRasterizer*, unsigned int));
+    void workerLoop();
+
+private:
+    // Estado de la tubería.
+    const SoftBuffer* m_vertexBuffer = nullptr;
+    unsigned int m_vertexStride = 0;
+    unsigned int m_vertexOffset = 0;
+    const SoftBuffer* m_instanceBuffer = nullptr;
+    unsigned int m_instanceStride = 0;
+    unsigned int m_instanceOffset = 0;
+    const SoftBuffer* m_indexBuffer = nullptr;
+    SoftIndexFormat m_indexFormat = SOFT_INDEX_16;
+    unsigned int m_indexOffset = 0;
+    const SoftBuffer* m_vsConstants[3] = { nullptr, nullptr, nullptr };
+    const SoftBuffer* m_psConstants[3] = { nullptr, nullptr, nullptr };
+    unsigned int m_vsConstantOffsets[3] = { 0, 0, 0 }; ///< Bytes desde el inicio de cada búfer.
+    unsigned int m_psConstantOffsets[3] = { 0, 0, 0 };
+    const SoftTexture* m_texture = nullptr;
+    SoftInputLayout m_inputLayout;
+    SoftViewport m_viewport;
+    SoftCullMode m_cullMode = SOFT_CULL_BACK;
+    unsigned int m_subpixelBits = 4;
+
+    // Trabajo pendiente hasta el siguiente flush().
+    unsigned int m_tilesX = 0;
+    unsigned int m_tilesY = 0;
+    std::vector<DrawState> m_draws;
+    std::vector<Triangle> m_triangles;
+    std::vector<std::vector<uint32_t>> m_bins;
+    bool m_pendingColorClear = false;
+    bool m_pendingDepthClear = false;
+    uint32_t m_clearColor = 0;
+    float m_clearDepth = 1.0f;
+    std::atomic<uint64_t> m_pixelsWritten{ 0 };
+
+    // Datos temporales reutilizados entre draws.
+    std::vector<Float4> m_positions;   ///< POSITION decodificada del rango de vértices del draw.
+    std::vector<Float4> m_texcoords;   ///< TEXCOORD decodificada del mismo rango.
+    std::vector<ClipVertex> m_transformed;
+    std::vector<std::vector<Triangle>> m_chunkTriangles;
+    const DrawJob* m_drawJob = nullptr;
+
+    // Hilos de trabajo.
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeCondition;
+    std::condition_variable m_doneCondition;
+    void (*m_job)(SoftRasterizer*, unsigned int) = nullptr;
+    unsigned int m_jobCount = 0;
+    std::atomic<unsigned int> m_nextJob{ 0 };
+    unsigned int m_busyWorkers = 0;
+    uint64_t m_generation = 0;
+    bool m_quit = false;
+
+    Stats m_stats;
+};
@@ -0,0 +1,223 @@
+#pragma once
+#include "Prerequisites.h"
+
+/**
+ * @class StateCache
+ * @brief Copia en sombra del estado enlazado en el DeviceContext.
+ *
+ * Cada set* compara lo que se quiere enlazar con lo último que llegó al driver y devuelve
+ * false si la llamada no cambia nada. Las llamadas con varios slots se recortan al rango
+ * mínimo que sí cambia. No depende de Direct3D (los objetos se comparan como punteros),
+ * así que se puede usar con cualquier backend o con un contexto simulado.
+ *
+ * El estado empieza como desconocido: la primera llamada a cada slot siempre pasa.
+ *
+ * Para aplicar la regla de riesgos de D3D11 (un recurso no puede estar a la vez como SRV y
+ * como render target) el llamador puede pasar el recurso que hay detrás de cada vista. Sin
+ * esa información se supone lo peor y cualquier cambio de render targets olvida los SRV.
+ */
+class StateCache {
+public:
+    /// Etapas con constantes, recursos y samplers propios.
+    enum Stage {
+        VERTEX_STAGE = 0,
+        PIXEL_STAGE = 1,
+        STAGE_COUNT = 2
+    };
+
+    static const unsigned int MAX_VERTEX_BUFFERS = 16;   ///< Slots de vértices seguidos.
+    static const unsigned int MAX_CONSTANT_BUFFERS = 14; ///< D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT.
+    static const unsigned int MAX_SHADER_RESOURCES = 16; ///< Slots de SRV seguidos (el resto pasa siempre).
+    static const unsigned int MAX_SAMPLERS = 16;         ///< D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT.
+    static const unsigned int MAX_RENDER_TARGETS = 8;    ///< D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT.
+    static const unsigned int MAX_VIEWPORT_BYTES = 16 * 24; ///< 16 D3D11_VIEWPORT.
+
+    /**
+     * @brief Contadores de llamadas de estado.
+     */
+    struct Stats {
+        uint64_t issued = 0;   ///< Llamadas que llegaron al driver.
+        uint64_t filtered = 0; ///< Llamadas descartadas por no cambiar nada.
+    };
+
+    StateCache() { invalidate(); }
+    ~StateCache() = default;
+
+    /// Marca todo el estado como desconocido (después de ClearState o de usar el contexto por fuera).
+    void invalidate();
+
+    /// Activa o desactiva el filtrado; desactivado, todas las llamadas pasan y se cuentan como emitidas.
+    void setEnabled(bool enabled);
+
+    /// Cierra el fotograma: guarda los contadores actuales en getLastFrameStats() y los pone a cero.
+    void endFrame();
+
+    const Stats& getFrameStats() const { return m_frame; }
+    const Stats& getLastFrameStats() const { return m_lastFrame; }
+    const Stats& getTotalStats() const { return m_total; }
+
+    bool setInputLayout(const void* inputLayout);
+
+    /**
+     * @brief Filtra IASetVertexBuffers.
+     * @param first Primer slot que hay que enviar (salida).
+     * @param count Número de slots que hay que enviar (salida).
+     * @return true si hay que llamar al driver con [first, first + count).
+     */
+    bool setVertexBuffers(unsigned int startSlot,
+        unsigned int numBuffers,
+        const void* const* buffers,
+        const unsigned int* strides,
+        const unsigned int* offsets,
+        unsigned int& first,
+        unsigned int& count);
+
+    bool setIndexBuffer(const void* indexBuffer, unsigned int format, unsigned int offset);
+
+    bool setPrimitiveTopology(unsigned int topology);
+
+    /**
+     * @brief Filtra VSSetShader / PSSetShader. Con class instances la llamada siempre pasa.
+     */
+    bool setShader(Stage stage, const void* shader, unsigned int numClassInstances);
+
+    bool setConstantBuffers(Stage stage,
+        unsigned int startSlot,
+        unsigned int numBuffers,
+        const void* const* buffers,
+        unsigned int& first,
+        unsigned int& count);
+
+    /**
+     * @brief Filtra VSSetConstantBuffers1 / PSSetConstantBuffers1. El mismo búfer con otro
+     * rango de constantes cuenta como cambio. Con firstConstants o numConstants a nullptr
+     * se enlaza el búfer completo, igual que setConstantBuffers.
+     */
+    bool setConstantBufferRanges(Stage stage,
+        unsigned int startSlot,
+        unsigned int numBuffers,
+        const void* const* buffers,
+        const unsigned int* firstConstants,
+        const unsigned int* numConstants,
+        unsigned int& first,
+        unsigned int& count);
+
+    /**
+     * @brief Filtra PSSetShaderResources / VSSetShaderResources.
+     * @param resources Recurso de cada vista (ID3D11View::GetResource), o nullptr si no se conoce.
+     * Una vista cuyo recurso está enlazado como render target o depth stencil la deja a nulo el
+     * driver, así que ese slot queda como desconocido y la siguiente llamada pasa.
+     */
+    bool setShaderResources(Stage stage,
+        unsigned int startSlot,
+        unsigned int numViews,
+        const void* const* views,
+        unsigned int& first,
+        unsigned int& count,
+        const void* const* resources = nullptr);
+
+    bool setSamplers(Stage stage,
+        unsigned int startSlot,
+        unsigned int numSamplers,
+        const void* const* samplers,
+        unsigned int& first,
+        unsigned int& count);
+
+    bool setRasterizerState(const void* rasterizerState);
+
+    bool setBlendState(const void* blendState, const float blendFactor[4], unsigned int sampleMask);
+
+    /**
+     * @brief Filtra OMSetRenderTargets. Si cambia, olvida los SRV cuyo recurso pasa a ser
+     * render target o depth stencil, porque D3D11 los desenlaza.
+     * @param resources numViews + 1 recursos: los de cada render target y el del depth stencil
+     * (nullptr si no hay). Sin ellos, o si un SRV no dio su recurso, se olvidan todos los SRV.
+     */
+    bool setRenderTargets(unsigned int numViews,
+        const void* const* renderTargetViews,
+        const void* depthStencilView,
+        const void* const* resources = nullptr);
+
+    bool setViewports(unsigned int numViewports, const void* viewports, size_t viewportSize);
+
+private:
+    /// Slot con valor conocido o desconocido.
+    template<typename T>
+    struct Slot {
+        T value;
+        bool known;
+    };
+
+    struct VertexBinding {
+        const void* buffer;
+        unsigned int stride;
+        unsigned int offset;
+
+        bool operator==(const VertexBinding& o) const {
+            return buffer == o.buffer && stride == o.stride && offset == o.offset;
+        }
+    };
+
+    /// Búfer de constantes enlazado; firstConstant = numConstants = 0 es el búfer completo.
+    struct ConstantBinding {
+        const void* buffer;
+        unsigned int firstConstant;
+        unsigned int numConstants;
+
+        bool operator==(const ConstantBinding& o) const {
+            return buffer == o.buffer && firstConstant == o.firstConstant && numConstants == o.numConstants;
+        }
+    };
+
+    template<typename T>
+    bool filterSlots(Slot<T>* slots,
+        unsigned int slotCount,
+        unsigned int startSlot,
+        unsigned int num,
+        const T* values,
+        unsigned int& first,
+        unsigned int& count);
+
+    template<typename T>
+    bool filterSingle(Slot<T>& slot, const T& value);
+
+    bool record(bool changed);
+
+    /// true si resource está enlazado como render target o depth stencil.
+    bool isBoundAsTarget(const void* resource) const;
+
+    /// Olvida los SRV que el driver desenlaza al cambiar los render targets.
+    void invalidateTargetHazards();
+
+private:
+    bool m_enabled = true;
+
+    Slot<const void*> m_inputLayout;
+    Slot<VertexBinding> m_vertexBuffers[MAX_VERTEX_BUFFERS];
+    Slot<const void*> m_indexBuffer;
+    unsigned int m_indexFormat = 0;
+    unsigned int m_indexOffset = 0;
+    Slot<unsigned int> m_topology;
+    Slot<const void*> m_shaders[STAGE_COUNT];
+    Slot<ConstantBinding> m_constantBuffers[STAGE_COUNT][MAX_CONSTANT_BUFFERS];
+    Slot<const void*> m_shaderResources[STAGE_COUNT][MAX_SHADER_RESOURCES];
+    const void* m_shaderResourceOwners[STAGE_COUNT][MAX_SHADER_RESOURCES] = {}; ///< Recurso de cada SRV (nullptr = desconocido).
+    Slot<const void*> m_samplers[STAGE_COUNT][MAX_SAMPLERS];
+    Slot<const void*> m_rasterizerState;
+    Slot<const void*> m_blendState;
+    float m_blendFactor[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+    unsigned int m_sampleMask = 0;
+    bool m_renderTargetsKnown = false;
+    unsigned int m_numRenderTargets = 0;
+    const void* m_renderTargets[MAX_RENDER_TARGETS] = {};
+    const void* m_depthStencil = nullptr;
+    bool m_targetResourcesKnown = false;
+    const void* m_targetResources[MAX_RENDER_TARGETS + 1] = {}; ///< Recursos de los render targets y del depth stencil.
+    bool m_viewportsKnown = false;
+    size_t m_viewportBytes = 0;
+    uint8_t m_viewports[MAX_VIEWPORT_BYTES] = {};
+
+    Stats m_frame;
+    Stats m_lastFrame;
+    Stats m_total;
+};
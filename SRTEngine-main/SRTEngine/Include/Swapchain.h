@@ -35,8 +35,17 @@ public:
     // Libera los recursos utilizados por la cadena de intercambio.
     void destroy();
 
-    // Muestra el buffer trasero en la pantalla.
-    void present();
+    /**
+     * @brief Muestra el buffer trasero en la pantalla.
+     * @param syncInterval 0 = sin esperar a la sincronía vertical, 1..4 = esperar ese número de refrescos.
+     */
+    void present(unsigned int syncInterval = 0);
+
+    /**
+     * @brief Limita los frames que DXGI deja encolados antes de bloquear present().
+     * @param frames Entre 1 y 16; menos frames, menos latencia de entrada.
+     */
+    HRESULT setMaximumFrameLatency(unsigned int frames);
 
 public:
     IDXGISwapChain* m_swapchain = nullptr;  // Interfaz de la cadena de intercambio.
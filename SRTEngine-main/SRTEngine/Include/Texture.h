@@ -1,8 +1,11 @@
 #pragma once
 #include "Prerequisites.h"
+#include "MipGenerator.h"
+#include "BlockCompressor.h"
 
 class Device;
 class DeviceContext;
+class DDSFile;
 
 class Texture {
 public:
@@ -15,9 +18,11 @@ public:
     /// <param name="device">: Llamamos al dispositivo para generar los recursos en memoria.</param>
     /// <param name="textureName">: Nombre de la textura, para cargarla desde memoria.</param>
     /// <param name="extensionType">: Tipo de extensin de la imagen (ejemplo: DDS, PNG, JPG).</param>
+    /// <param name="compression">: Formato BC al que comprimir las imgenes PNG (BC_FORMAT_NONE = RGBA8).</param>
     HRESULT init(Device device,
         const std::string& textureName,
-        ExtensionType extensionType);
+        ExtensionType extensionType,
+        BCFormat compression = BC_FORMAT_NONE);
 
     /// <summary>
     /// Brief: Este mtodo es responsable de crear una textura 2D a partir de los datos proporcionados por el desarrollador.
@@ -35,6 +40,32 @@ public:
         unsigned int sampleCount = 1,
         unsigned int qualityLevels = 0);
 
+    /// <summary>
+    /// Brief: Crea la textura y su vista de shader a partir de una cadena de mips RGBA8 ya decodificada.
+    /// </summary>
+    /// <param name="device">: Proporciona los recursos para crear la textura 2D.</param>
+    /// <param name="levels">: Niveles de la cadena (levels[0] es la imagen completa), por ejemplo de MipGenerator.</param>
+    HRESULT initFromMipChain(Device device,
+        const std::vector<MipLevel>& levels);
+
+    /// <summary>
+    /// Brief: Crea la textura y su vista de shader a partir de un DDS ya abierto (1D, 2D, 3D, arrays y cubemaps).
+    /// </summary>
+    /// <param name="device">: Proporciona los recursos para crear la textura.</param>
+    /// <param name="dds">: Archivo proyectado en memoria; sus subrecursos se pasan a la GPU sin copiarlos.</param>
+    HRESULT initFromDDS(Device device,
+        const DDSFile& dds);
+
+    /// <summary>
+    /// Brief: Crea la textura y su vista de shader a partir de una cadena de mips ya comprimida por bloques.
+    /// </summary>
+    /// <param name="device">: Proporciona los recursos para crear la textura 2D.</param>
+    /// <param name="levels">: Niveles comprimidos (el nivel 0 debe medir mltiplos de 4), por ejemplo de BlockCompressor.</param>
+    /// <param name="format">: Formato de los bloques.</param>
+    HRESULT initFromCompressedChain(Device device,
+        const std::vector<CompressedLevel>& levels,
+        BCFormat format);
+
     /// <summary>
     /// Brief: Este mtodo es responsable de actualizar la lgica de la textura.
     /// </summary>
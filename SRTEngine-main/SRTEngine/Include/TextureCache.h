@@ -0,0 +1,123 @@
+#pragma once
+#include "Prerequisites.h"
+#include "BlockCompressor.h"
+#include "MipGenerator.h"
+#include <condition_variable>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+class AssetArchive;
+class Device;
+class Texture;
+
+/**
+ * @class TextureCache
+ * @brief Caché de texturas compartidas con conteo de referencias y expulsión LRU.
+ *
+ * acquire() busca primero por ruta y, si no la conoce, lee el archivo y busca por el hash
+ * de su contenido: el mismo archivo cargado con dos nombres comparte una sola textura.
+ * Cada acquire() que devuelve un handle válido debe emparejarse con un release().
+ *
+ * Las entradas sin referencias no se destruyen al momento: pasan a una lista LRU y solo
+ * se expulsan (la menos usada primero) cuando la memoria residente supera el
+ * presupuesto. Las entradas referenciadas nunca se expulsan, así que el presupuesto se
+ * puede superar mientras estén en uso.
+ *
+ * Es segura entre hilos. Si varios hilos piden la misma ruta a la vez, uno la carga y los
+ * demás esperan a que termine. Sin dispositivo (init con nullptr) las imágenes se quedan
+ * en memoria de CPU, lo que sirve para probar la caché sin ventana.
+ *
+ * Con setArchive() los nombres se buscan primero en el archivo empaquetado; las entradas
+ * guardadas sin comprimir se decodifican directamente desde su proyección en memoria.
+ */
+class TextureCache {
+public:
+    /// Identificador de una entrada; válido hasta el release() que lo empareja.
+    typedef unsigned int Handle;
+    static const Handle INVALID_HANDLE = ~0u;
+
+    /**
+     * @brief Contadores acumulados desde init().
+     */
+    struct Stats {
+        uint64_t hits = 0;          ///< acquire() resueltos por ruta.
+        uint64_t contentHits = 0;   ///< acquire() de una ruta nueva con contenido ya cargado.
+        uint64_t misses = 0;        ///< Cargas reales.
+        uint64_t failures = 0;      ///< Cargas fallidas.
+        uint64_t evictions = 0;     ///< Entradas expulsadas por el presupuesto.
+        uint64_t residentBytes = 0; ///< Memoria de las entradas cargadas.
+        uint64_t peakBytes = 0;     ///< Máximo de residentBytes.
+        unsigned int entries = 0;   ///< Entradas cargadas (en uso o en la LRU).
+    };
+
+    TextureCache();
+    ~TextureCache();
+
+    /**
+     * @brief Prepara la caché.
+     * @param device Dispositivo con el que crear las texturas; nullptr = solo CPU.
+     * @param budgetBytes Memoria a partir de la cual se expulsan las entradas sin referencias.
+     * @param compression Formato BC de las imágenes que no son DDS (BC_FORMAT_NONE = RGBA8).
+     */
+    HRESULT init(Device* device, uint64_t budgetBytes, BCFormat compression = BC_FORMAT_NONE);
+
+    /// Libera todas las entradas (también las que sigan referenciadas).
+    void destroy();
+
+    /**
+     * @brief Archivo empaquetado donde buscar antes que en disco (nullptr = solo archivos sueltos).
+     * Tiene que seguir abierto mientras se use la caché.
+     */
+    void setArchive(const AssetArchive* archive);
+
+    /**
+     * @brief Devuelve la textura de un archivo (DDS o cualquier imagen de stb_image), cargándola si hace falta.
+     * @return Handle con una referencia, o INVALID_HANDLE si no se pudo cargar.
+     */
+    Handle acquire(const std::string& fileName);
+
+    /// Suma una referencia a un handle ya adquirido.
+    void addRef(Handle handle);
+
+    /// Quita una referencia; al llegar a cero la entrada pasa a la LRU.
+    void release(Handle handle);
+
+    /// Textura de una entrada con dispositivo (nullptr sin dispositivo).
+    Texture* getTexture(Handle handle) const;
+
+    /// Cadena de mips en CPU de una imagen cargada sin dispositivo (nullptr en otro caso).
+    const std::vector<MipLevel>* getLevels(Handle handle) const;
+
+    /// Cambia el presupuesto y expulsa lo que sobre.
+    void setBudget(uint64_t budgetBytes);
+
+    /// Copia de los contadores.
+    Stats getStats() const;
+
+private:
+    struct Entry;
+
+    bool createPayload(Entry& entry, const std::string& fileName, const uint8_t* contents, size_t size);
+    Handle waitForEntry(std::unique_lock<std::mutex>& lock, Handle handle);
+    void evictOverBudget();
+    void removeEntry(Handle handle);
+    void releaseLocked(Handle handle);
+
+private:
+    Device* m_device = nullptr;
+    const AssetArchive* m_archive = nullptr;
+    BCFormat m_compression = BC_FORMAT_NONE;
+    uint64_t m_budget = 0;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_loaded;
+    std::vector<std::unique_ptr<Entry>> m_entries;
+    std::vector<Handle> m_freeSlots;
+    std::unordered_map<std::string, Handle> m_byPath;
+    std::unordered_map<uint64_t, Handle> m_byContent;
+    std::list<Handle> m_lru; ///< Entradas sin referencias, la más reciente delante.
+
+    Stats m_stats;
+};
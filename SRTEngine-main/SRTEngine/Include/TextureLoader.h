@@ -0,0 +1,135 @@
+#pragma once
+#include "Prerequisites.h"
+#include "BlockCompressor.h"
+#include "MipGenerator.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+class Device;
+class Texture;
+
+/**
+ * @class TextureLoader
+ * @brief Carga asíncrona de imágenes (PNG, JPG, ... cualquier formato de stb_image).
+ *
+ * load() devuelve un handle al momento y un conjunto de hilos lee el archivo, lo
+ * decodifica a RGBA8 y genera su cadena de mips con MipGenerator. La creación de la
+ * textura en la GPU se hace en el hilo principal desde update(), que termina como mucho
+ * byteBudget bytes por llamada para que una carga grande no congele el fotograma.
+ * Con un formato de compresión los hilos también comprimen la cadena por bloques, así
+ * que la GPU recibe (y el presupuesto cuenta) los bytes BC en vez de RGBA8.
+ *
+ * Sin dispositivo (update con nullptr) las imágenes se quedan en memoria de CPU y se
+ * pueden leer con getPixels(); sirve para medir la decodificación sin ventana.
+ */
+class TextureLoader {
+public:
+    /// Identificador de una carga.
+    typedef unsigned int Handle;
+    static const Handle INVALID_HANDLE = ~0u;
+
+    /// Estado de una carga.
+    enum State {
+        LOADING = 0, ///< En cola o decodificándose.
+        DECODED,     ///< Decodificada, esperando a update().
+        READY,       ///< Textura creada (o píxeles disponibles sin dispositivo).
+        FAILED       ///< No se pudo leer, decodificar o subir.
+    };
+
+    /**
+     * @brief Contadores acumulados desde init().
+     */
+    struct Stats {
+        unsigned int requested = 0;      ///< Llamadas a load().
+        unsigned int decoded = 0;        ///< Imágenes decodificadas.
+        unsigned int finalized = 0;      ///< Imágenes terminadas en update().
+        unsigned int failed = 0;         ///< Cargas fallidas.
+        uint64_t bytesRead = 0;          ///< Bytes leídos de disco.
+        uint64_t bytesDecoded = 0;       ///< Bytes RGBA8 decodificados, con todos los mips.
+        uint64_t bytesCompressed = 0;    ///< Bytes BC generados a partir de esos mips.
+        uint64_t bytesFinalized = 0;     ///< Bytes subidos en update(), con todos los mips.
+        double decodeSeconds = 0.0;      ///< Tiempo de lectura + decodificación + mips + compresión sumado entre hilos.
+        double lastUpdateSeconds = 0.0;  ///< Duración del último update() (tiempo robado al fotograma).
+        double worstUpdateSeconds = 0.0; ///< Peor update() desde init().
+    };
+
+    TextureLoader();
+    ~TextureLoader();
+
+    /**
+     * @brief Arranca los hilos de decodificación.
+     * @param threadCount Hilos de trabajo (0 = núcleos disponibles menos el principal).
+     * @param generateMips Genera la cadena de mips completa (filtro Kaiser en espacio sRGB).
+     * @param compression Formato BC de las texturas (BC_FORMAT_NONE = RGBA8). Las imágenes cuyo
+     * nivel 0 no mide múltiplos de 4 se quedan sin comprimir.
+     */
+    HRESULT init(unsigned int threadCount = 0, bool generateMips = true, BCFormat compression = BC_FORMAT_NONE);
+
+    /// Detiene los hilos, descarta lo pendiente y libera todas las texturas.
+    void destroy();
+
+    /**
+     * @brief Encola la carga de un archivo y devuelve su handle sin esperar.
+     */
+    Handle load(const std::string& fileName);
+
+    /**
+     * @brief Termina cargas decodificadas en orden de llegada hasta gastar byteBudget bytes.
+     * Siempre termina al menos una si hay alguna esperando, para no quedarse atascado con
+     * imágenes más grandes que el presupuesto. Se llama desde el hilo principal.
+     * @param device Dispositivo con el que crear las texturas; nullptr = solo CPU.
+     * @return Número de cargas terminadas.
+     */
+    unsigned int update(Device* device, uint64_t byteBudget);
+
+    /// Bloquea hasta que no quede nada en cola ni decodificándose.
+    void waitDecoded();
+
+    /// true si no queda ninguna carga en LOADING ni DECODED.
+    bool isIdle() const;
+
+    State getState(Handle handle) const;
+
+    /// Textura de una carga READY con dispositivo (nullptr en otro caso).
+    Texture* getTexture(Handle handle);
+
+    /// Píxeles RGBA8 del nivel 0 de una carga READY sin dispositivo ni compresión (nullptr en otro caso).
+    const unsigned char* getPixels(Handle handle, unsigned int& width, unsigned int& height) const;
+
+    /// Cadena de mips de una carga READY sin dispositivo (nullptr en otro caso).
+    const std::vector<MipLevel>* getLevels(Handle handle) const;
+
+    /// Cadena comprimida de una carga READY sin dispositivo (nullptr si no se comprimió).
+    const std::vector<CompressedLevel>* getCompressedLevels(Handle handle) const;
+
+    /// Copia de los contadores (los hilos los actualizan).
+    Stats getStats() const;
+
+    unsigned int getThreadCount() const { return (unsigned int)m_threads.size(); }
+
+private:
+    struct Entry;
+
+    void workerLoop();
+    void decode(Entry& entry);
+
+private:
+    std::vector<std::unique_ptr<Entry>> m_entries;
+    std::vector<std::thread> m_threads;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    std::deque<Entry*> m_pending;
+    std::deque<Entry*> m_decoded;
+    unsigned int m_busy = 0;
+    unsigned int m_unfinished = 0;
+    bool m_stop = false;
+    bool m_generateMips = true;
+    BCFormat m_compression = BC_FORMAT_NONE;
+
+    Stats m_stats;
+};
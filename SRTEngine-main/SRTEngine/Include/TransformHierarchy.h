@@ -0,0 +1,122 @@
+#pragma once
+#include "Prerequisites.h"
+#include "JobSystem.h"
+#include <atomic>
+
+/**
+ * @class TransformHierarchy
+ * @brief Jerarquía de transformaciones guardada como estructura de arrays.
+ *
+ * Posiciones, rotaciones (cuaterniones), escalas, padres y matrices de mundo viven en
+ * arrays separados ordenados por profundidad: primero todas las raíces, luego sus hijos,
+ * etc. Así el padre de cada nodo siempre está antes que él y los nodos de un mismo nivel
+ * son independientes, de modo que update() recorre los niveles en orden y reparte cada
+ * uno entre los hilos del JobSystem.
+ *
+ * Cambiar la transformación local de un nodo lo marca como sucio; update() solo vuelve a
+ * calcular los nodos sucios y sus descendientes (world = local * world del padre).
+ *
+ * Los Node son identificadores estables. Crear nodos más profundos que el último,
+ * reparentar o borrar reordena los arrays en el siguiente update(), así que los índices
+ * de getWorldMatrices() solo son válidos hasta el siguiente cambio de estructura.
+ *
+ * No es segura entre hilos: se modifica y se actualiza desde un solo hilo.
+ */
+class TransformHierarchy {
+public:
+    typedef uint32_t Node;
+    static const Node INVALID_NODE = ~0u;
+
+    /// Contadores del último update().
+    struct Stats {
+        unsigned int nodes = 0;        ///< Nodos vivos.
+        unsigned int levels = 0;       ///< Profundidad máxima + 1.
+        unsigned int updatedNodes = 0; ///< Matrices de mundo recalculadas.
+        bool reordered = false;        ///< Si hubo que reordenar los arrays.
+    };
+
+    TransformHierarchy() = default;
+    ~TransformHierarchy();
+
+    TransformHierarchy(const TransformHierarchy&) = delete;
+    TransformHierarchy& operator=(const TransformHierarchy&) = delete;
+
+    /**
+     * @brief Prepara la jerarquía.
+     * @param jobs Sistema de trabajos para update() (nullptr = todo en el hilo que llama).
+     */
+    HRESULT init(JobSystem* jobs = nullptr);
+
+    /// Borra todos los nodos.
+    void destroy();
+
+    /**
+     * @brief Crea un nodo con transformación identidad.
+     * @param parent Nodo padre o INVALID_NODE para una raíz.
+     */
+    Node createNode(Node parent = INVALID_NODE);
+
+    /// Borra un nodo y todos sus descendientes.
+    void destroyNode(Node node);
+
+    /// Cambia el padre de un nodo (falla si crearía un ciclo).
+    HRESULT setParent(Node node, Node parent);
+
+    Node getParent(Node node) const;
+
+    void setPosition(Node node, const Float3& position);
+    void setRotation(Node node, const Float4& rotation); ///< Cuaternión unitario (x, y, z, w).
+    void setScale(Node node, const Float3& scale);
+    void setLocal(Node node, const Float3& position, const Float4& rotation, const Float3& scale);
+
+    const Float3& getPosition(Node node) const { return m_positions[m_indexOf[node]]; }
+    const Float4& getRotation(Node node) const { return m_rotations[m_indexOf[node]]; }
+    const Float3& getScale(Node node) const { return m_scales[m_indexOf[node]]; }
+
+    /// Matriz de mundo calculada en el último update().
+    const Matrix& getWorld(Node node) const { return m_world[m_indexOf[node]]; }
+
+    bool isValid(Node node) const { return node < m_indexOf.size() && m_indexOf[node] != INVALID_NODE; }
+
+    /**
+     * @brief Recalcula las matrices de mundo de los nodos sucios y sus descendientes.
+     */
+    void update();
+
+    /// Matrices de mundo de todos los nodos en el orden interno (getNodeCount() elementos).
+    const Matrix* getWorldMatrices() const { return m_world.data(); }
+
+    /// Posición de un nodo en getWorldMatrices().
+    unsigned int getIndex(Node node) const { return m_indexOf[node]; }
+
+    unsigned int getNodeCount() const { return (unsigned int)m_parents.size(); }
+    unsigned int getThreadCount() const { return m_jobs ? m_jobs->getThreadCount() : 1; }
+    const Stats& getStats() const { return m_stats; }
+
+private:
+    void markDirty(unsigned int index);
+    void reorder();
+    void updateLevel(unsigned int begin, unsigned int end);
+
+private:
+    // Datos por nodo, en orden de profundidad.
+    std::vector<Float3> m_positions;
+    std::vector<Float4> m_rotations;
+    std::vector<Float3> m_scales;
+    std::vector<uint32_t> m_parents; ///< Índice del padre (INVALID_NODE en las raíces).
+    std::vector<uint32_t> m_depths;
+    std::vector<uint8_t> m_dirty;
+    std::vector<Matrix> m_world;
+    std::vector<Node> m_nodeAt;      ///< Node de cada índice.
+
+    std::vector<uint32_t> m_indexOf; ///< Índice de cada Node (INVALID_NODE si está libre).
+    std::vector<Node> m_freeNodes;
+    std::vector<uint32_t> m_levelStarts; ///< Primer índice de cada nivel y al final el total.
+
+    bool m_needsReorder = false;
+    bool m_anyDirty = false;
+    Stats m_stats;
+
+    JobSystem* m_jobs = nullptr;
+    std::atomic<unsigned int> m_updatedNodes{ 0 };
+};
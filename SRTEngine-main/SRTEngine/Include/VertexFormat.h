@@ -0,0 +1,129 @@
+#pragma once
+#include "Prerequisites.h"
+
+/// Significado de un atributo de vértice (y su nombre semántico en HLSL).
+enum VertexSemantic {
+    SEMANTIC_POSITION = 0, ///< "POSITION", de Float3.
+    SEMANTIC_NORMAL,       ///< "NORMAL", de Float3 unitario.
+    SEMANTIC_TEXCOORD,     ///< "TEXCOORD", de Float2.
+    SEMANTIC_COLOR,        ///< "COLOR", de Float4 en [0, 1].
+    SEMANTIC_COUNT
+};
+
+/// Codificación de un atributo en el búfer de vértices.
+enum VertexEncoding {
+    ENCODING_FLOAT2 = 0, ///< R32G32_FLOAT, 8 bytes.
+    ENCODING_FLOAT3,     ///< R32G32B32_FLOAT, 12 bytes.
+    ENCODING_FLOAT4,     ///< R32G32B32A32_FLOAT, 16 bytes.
+    ENCODING_HALF2,      ///< R16G16_FLOAT, 4 bytes.
+    ENCODING_HALF4,      ///< R16G16B16A16_FLOAT, 8 bytes (posiciones con w = 1).
+    ENCODING_UNORM16X2,  ///< R16G16_UNORM, 4 bytes (UV en [0, 1]; encode() rechaza las de fuera).
+    ENCODING_UNORM16X4,  ///< R16G16B16A16_UNORM, 8 bytes: posiciones relativas a la caja, w = 1.
+    ENCODING_SNORM8X4,   ///< R8G8B8A8_SNORM, 4 bytes (normales, w = 0).
+    ENCODING_OCT16,      ///< R16G16_SNORM, 4 bytes: normal en octaedro.
+    ENCODING_UNORM8X4,   ///< R8G8B8A8_UNORM, 4 bytes (colores).
+    ENCODING_COUNT
+};
+
+/**
+ * @brief Array de entrada de encode(): el elemento i está en data + i * stride.
+ */
+struct VertexStream {
+    const void* data = nullptr;
+    unsigned int stride = 0;
+};
+
+/**
+ * @class VertexFormat
+ * @brief Descripción declarativa de un vértice: de ella salen el stride, el input layout de
+ * D3D11 y los codificadores y decodificadores de CPU.
+ *
+ * Los atributos se colocan en el orden en que se añaden, cada uno alineado a 4 bytes (todas
+ * las codificaciones ocupan múltiplos de 4). Los formatos comprimidos se leen en el shader
+ * con la conversión de la propia GPU (half y normalizados a float), salvo dos casos:
+ *
+ * - ENCODING_UNORM16X4 en posiciones guarda (p - boundsMin) / (boundsMax - boundsMin) en
+ *   [0, 1]. Para no tocar el shader, getPositionDecodeMatrix() se multiplica por delante de
+ *   la matriz de mundo.
+ * - ENCODING_OCT16 proyecta la normal sobre el octaedro |x| + |y| + |z| = 1 y despliega la
+ *   mitad z < 0 sobre las esquinas (Cigolle et al. 2014). El codificador prueba los cuatro
+ *   redondeos vecinos y se queda con el de menor error angular. En HLSL se decodifica con:
+ *   n = float3(e, 1 - abs(e.x) - abs(e.y)); t = saturate(-n.z);
+ *   n.xy += n.xy >= 0 ? -t : t; n = normalize(n).
+ */
+class VertexFormat {
+public:
+    /// Atributo colocado en el vértice.
+    struct Attribute {
+        VertexSemantic semantic;
+        VertexEncoding encoding;
+        unsigned int offset;
+    };
+
+    /// Fuentes de encode(), una por semántica (las que el formato no usa pueden quedar vacías).
+    struct Source {
+        VertexStream streams[SEMANTIC_COUNT];
+    };
+
+    VertexFormat() = default;
+
+    /// Quita todos los atributos.
+    void clear();
+
+    /// Añade un atributo; cada semántica una sola vez y con una codificación que admita.
+    HRESULT add(VertexSemantic semantic, VertexEncoding encoding);
+
+    /// true si la codificación sirve para la semántica.
+    static bool isSupported(VertexSemantic semantic, VertexEncoding encoding);
+
+    /// Bytes de una codificación.
+    static unsigned int encodingSize(VertexEncoding encoding);
+
+    /// Caja de las posiciones cuantizadas con ENCODING_UNORM16X4.
+    void setBounds(const Float3& boundsMin, const Float3& boundsMax);
+
+    /// Matriz que lleva las posiciones cuantizadas a las de la malla (identidad si no se cuantizan).
+    Matrix getPositionDecodeMatrix() const;
+
+    unsigned int getStride() const { return m_stride; }
+    const std::vector<Attribute>& getAttributes() const { return m_attributes; }
+
+    /// Atributo de una semántica; nullptr si el formato no la tiene.
+    const Attribute* find(VertexSemantic semantic) const;
+
+    /**
+     * @brief Codifica count vértices en destination (count * getStride() bytes).
+     * @return E_INVALIDARG, sin escribir nada, si falta la fuente de un atributo o si una UV
+     * con ENCODING_UNORM16X2 sale de [0, 1] (UV repetidas: ENCODING_HALF2 o ENCODING_FLOAT2).
+     * Las posiciones UNORM16X4 fuera de la caja sí se recortan a ella.
+     */
+    HRESULT encode(const Source& source, size_t count, void* destination) const;
+
+    /**
+     * @brief Decodifica un atributo de count vértices a float (lo que leería el shader, con las
+     * posiciones ya en el espacio de la malla y las normales de octaedro desplegadas).
+     * @param meshSpace false = las posiciones UNORM16 se quedan en [0, 1], como las entrega el
+     * input assembler cuando getPositionDecodeMatrix() va delante de la matriz de mundo.
+     */
+    HRESULT decode(const void* vertices, size_t count, VertexSemantic semantic, Float4* destination,
+                   bool meshSpace = true) const;
+
+#ifdef _WIN32
+    /// Añade a elements los elementos del input layout en la ranura inputSlot.
+    void getInputElements(std::vector<D3D11_INPUT_ELEMENT_DESC>& elements, unsigned int inputSlot = 0) const;
+#endif
+
+    /// Conversión float <-> half (IEEE 754 binary16, redondeo al par más cercano).
+    static uint16_t floatToHalf(float value);
+    static float halfToFloat(uint16_t value);
+
+    /// Normal unitaria <-> octaedro en SNORM16 (ENCODING_OCT16).
+    static void encodeOctahedral(const Float3& normal, int16_t encoded[2]);
+    static Float3 decodeOctahedral(const int16_t encoded[2]);
+
+private:
+    std::vector<Attribute> m_attributes;
+    unsigned int m_stride = 0;
+    Float3 m_boundsMin = Float3(0.0f, 0.0f, 0.0f);
+    Float3 m_boundsMax = Float3(1.0f, 1.0f, 1.0f);
+};
@@ -6,6 +6,30 @@
 #include "Texture.h"
 #include "RenderTargetView.h"
 #include "DepthStencilView.h"
+#include "ConstantBufferManager.h"
+#include "TextureCache.h"
+#include "AssetArchive.h"
+#include "JobSystem.h"
+#include "FramePipeline.h"
+#include "GameClock.h"
+#include "FramePacer.h"
+#include "FrustumCuller.h"
+#include "OcclusionCuller.h"
+#include "InstanceBatcher.h"
+#include "InstanceRenderer.h"
+#include "RenderQueue.h"
+#include "MeshLoader.h"
+#include "MeshOptimizer.h"
+#include "MeshletBuilder.h"
+#include "MeshSimplifier.h"
+#include "LodSelector.h"
+#include "VertexFormat.h"
+#include "SoftRasterizer.h"
+#include "DDSFile.h"
+#include "BlockCompressor.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 
 //--------------------------------------------------------------------------------------
 // Variables globales
@@ -25,34 +49,132 @@ ID3D11PixelShader*					g_pPixelShader = nullptr;
 ID3D11InputLayout*					g_pVertexLayout = nullptr;
 ID3D11Buffer*						g_pVertexBuffer = nullptr;
 ID3D11Buffer*						g_pIndexBuffer = nullptr;
-ID3D11Buffer*						g_pCBNeverChanges = nullptr;
-ID3D11Buffer*						g_pCBChangeOnResize = nullptr;
-ID3D11Buffer*						g_pCBChangesEveryFrame = nullptr;
-ID3D11ShaderResourceView*			g_pTextureRV = nullptr;
 ID3D11SamplerState*					g_pSamplerLinear = nullptr;
 
 // Matrices para transformación de la escena
-XMMATRIX                            g_World;
-XMMATRIX                            g_View;
-XMMATRIX                            g_Projection;
-XMFLOAT4                            g_vMeshColor(0.7f, 0.7f, 0.7f, 1.0f);
+Matrix                              g_World;
+Matrix                              g_View;
+Matrix                              g_Projection;
+Float4                              g_vMeshColor(0.7f, 0.7f, 0.7f, 1.0f);
 
 // Buffers constantes para shaders
-CBChangesEveryFrame cb;
 CBNeverChanges cbNeverChanges;
-CBChangeOnResize cbChangesOnResize;
+
+// Subidas de constantes: bloques que solo se suben si cambian y anillo para lo de cada frame
+ConstantBufferManager				g_constantBuffers;
+ConstantBufferManager::BlockHandle	g_cbNeverChanges = ConstantBufferManager::INVALID_BLOCK;
+ConstantBufferManager::BlockHandle	g_cbChangeOnResize = ConstantBufferManager::INVALID_BLOCK;
+
+// Dibujo instanciado de las mallas repetidas; los lotes más pequeños se dibujan uno a uno con TurtleEngine.fx
+InstanceRenderer					g_instanceRenderer;
+std::vector<InstanceRenderer::MeshHandle>	g_meshChunks;	// Un mesh por tramo de índices de 16 bits, de todos los LODs
+const unsigned int					g_instancingThreshold = 4;
+
+// Malla de la escena: se importa de g_meshFileName (.obj, .gltf o .glb) si existe; si no, el cubo.
+// Se simplifica en una cadena de LODs, y cada LOD se parte en tramos con índices de 16 bits y en
+// meshlets que se descartan en CPU si miran hacia atrás. Todos los LODs comparten los búferes
+MeshLoader							g_meshLoader;
+const char*							g_meshFileName = "SRTEngine.glb";
+MeshletMesh							g_meshlets;
+std::vector<float>					g_lodErrors;		// Error geométrico de cada LOD
+std::vector<unsigned int>			g_lodFirstChunk;	// Tramos del LOD l: [g_lodFirstChunk[l], g_lodFirstChunk[l + 1])
+LodSelector							g_lodSelector;
+std::vector<MeshletBuilder::DrawRange>	g_meshletRanges;
+const unsigned int					g_meshletGapTriangles = 512;	// Huecos que se dibujan para no partir el draw
+
+// Vértices comprimidos: posición en UNORM16 relativa a la caja de la malla y UV en half (12 bytes
+// en vez de 20); las posiciones se descuantizan con una matriz delante de la de mundo
+VertexFormat						g_vertexFormat;
+Matrix								g_positionDecode;	// Cuantizado -> malla
+Matrix								g_positionEncode;	// Malla -> cuantizado
+
+// Draws por objeto: se ordenan por clave (shader, material, textura, profundidad) y se graban
+// en una lista con solo los binds que cambian. Las constantes de cada objeto van al anillo de
+// g_constantBuffers y se enlazan por desplazamiento; sin Direct3D 11.1 se suben a su búfer
+RenderQueue							g_renderQueue;
+CommandList							g_renderList;
+ID3D11Buffer*						g_pCBChangesEveryFrame = nullptr;
+std::vector<CBChangesEveryFrame>	g_objectConstants;
+const float							g_farPlane = 100.0f;
+
+// Campo shader de la clave de RenderQueue: uno por cada par VS/PS que se encola
+enum ShaderKey : unsigned int {
+	SHADER_KEY_TURTLE				// g_pVertexShader + g_pPixelShader (TurtleEngine.fx)
+};
+
+// Texturas compartidas por ruta y contenido, con expulsión LRU por encima de 256 MB
+TextureCache						g_textureCache;
+TextureCache::Handle				g_seafloorTexture = TextureCache::INVALID_HANDLE;
+
+// Recursos empaquetados; si el archivo no existe se leen los archivos sueltos
+AssetArchive						g_assets;
+const char*							g_assetArchiveName = "SRTEngine.pak";
+
+// Hilos de trabajo del frame (culling, jerarquías)
+JobSystem							g_jobs;
+
+// Volúmenes envolventes de los objetos y los que quedan dentro del frustum este frame
+FrustumCuller						g_culler;
+OcclusionCuller						g_occlusionCuller;
+BoundingSpheres						g_objectBounds;
+float								g_meshRadius = 1.7320508f; // Esfera que contiene la malla (el cubo de lado 2 por defecto)
+MeshData							g_occluderMesh;	// LOD más simple de la malla: lo rasteriza cada objeto como oclusor
+
+// Lo que la simulación de un frame deja para su render: constantes y objetos visibles
+struct FrameData {
+	CBChangeOnResize				changesOnResize;
+	std::vector<uint32_t>			visibleObjects;
+	InstanceBatcher					instances;		// Objetos visibles agrupados por malla y material
+	double							inputTime = 0.0; // FramePacer::now() al empezar a simular el frame
+};
+
+// Simulación del frame N+1 en su propio hilo mientras se dibuja el N (un hueco por frame en vuelo)
+FramePipeline						g_framePipeline;
+FrameData							g_frames[FramePipeline::MAX_FRAMES_IN_FLIGHT];
+const unsigned int					g_framesInFlight = 2;
+std::atomic<float>					g_aspectRatio{ 1.0f }; // Lo escribe WM_SIZE y lo lee la simulación
+std::atomic<float>					g_viewportHeight{ 1.0f }; // Igual; la selección de LOD mide en píxeles
+
+// Reloj de la simulación y ángulo del cubo en los dos últimos pasos fijos, para interpolar
+GameClock							g_clock;
+float								g_previousAngle = 0.0f;
+float								g_currentAngle = 0.0f;
+
+// Ritmo de presentación: sin tope de FPS, como mucho 2 frames encolados y sin sincronía vertical
+FramePacer							g_framePacer;
+const unsigned int					g_maxFramesInFlight = 2;
+const unsigned int					g_syncInterval = 0;
 
 // Viewport para definir el área de renderizado
 D3D11_VIEWPORT vp;
-unsigned int stride = sizeof(SimpleVertex);
-unsigned int offset = 0;
+
+// Backend de render: Direct3D 11 o el rasterizador por software (argumento -soft). Con el de
+// software la cola de draws se reproduce sobre SoftRasterizer con los mismos vértices comprimidos,
+// y el frame se copia a la ventana con GDI porque el back buffer tiene MSAA
+enum RenderBackend {
+	BACKEND_D3D11,
+	BACKEND_SOFTWARE
+};
+RenderBackend						g_backend = BACKEND_D3D11;
+SoftRasterizer						g_softRasterizer;
+SoftInputLayout						g_softLayout;
+SoftBuffer							g_softVertexBuffer;
+SoftBuffer							g_softIndexBuffer;
+SoftBuffer							g_softCBNeverChanges;
+SoftBuffer							g_softCBChangeOnResize;
+SoftBuffer							g_softCBChangesEveryFrame;
+SoftBuffer							g_softInstances;	// InstanceData del frame para los lotes instanciados
+SoftTexture							g_softSeafloor;
+std::vector<uint32_t>				g_softFrame;		// Color del frame en BGRA para SetDIBitsToDevice
 
 // Declaraciones de funciones
 HRESULT InitDevice();
 void CleanupDevice();
 LRESULT CALLBACK    WndProc(HWND, unsigned int, WPARAM, LPARAM);
-void update();
-void Render();
+void update(unsigned int frameSlot);
+void Render(unsigned int frameSlot);
+HRESULT LoadSoftTexture(const char* fileName, SoftTexture& texture);
+void PresentSoftFrame();
 
 
 //--------------------------------------------------------------------------------------
@@ -62,7 +184,10 @@ void Render();
 int WINAPI
 wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLine, int nCmdShow) {
 	UNREFERENCED_PARAMETER(hPrevInstance);
-	UNREFERENCED_PARAMETER(lpCmdLine);
+
+	// -soft dibuja con el rasterizador por software en lugar de Direct3D 11
+	if (lpCmdLine && wcsstr(lpCmdLine, L"-soft"))
+		g_backend = BACKEND_SOFTWARE;
 
 	// Inicializa la ventana
 	if (FAILED(g_window.init(hInstance, nCmdShow, WndProc)))
@@ -74,6 +199,14 @@ wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLine, int nCm
 		return 0;
 	}
 
+	// Hilo de simulación
+	if (FAILED(g_framePipeline.init(g_framesInFlight, [](void*, unsigned int frameSlot) {
+			update(frameSlot);
+		}, nullptr))) {
+		CleanupDevice();
+		return 0;
+	}
+
 	// Bucle principal de mensajes y renderizado
 	MSG msg = { 0 };
 	while (WM_QUIT != msg.message) {
@@ -82,11 +215,15 @@ wWinMain(HINSTANCE hInstance, HINSTANCE hPrevInstance, LPWSTR lpCmdLine, int nCm
 			DispatchMessage(&msg);
 		}
 		else {
-			update();
-			Render();
+			// Dibujar el frame ya simulado mientras se simula el siguiente
+			g_framePacer.beginFrame();
+			const unsigned int frameSlot = g_framePipeline.beginRender();
+			Render(frameSlot);
+			g_framePipeline.endRender();
 		}
 	}
 
+	g_framePipeline.destroy();
 	CleanupDevice();
 
 	return (int)msg.wParam;
@@ -107,9 +244,23 @@ CompileShaderFromFile(char* szFileName, LPCSTR szEntryPoint, LPCSTR szShaderMode
 	// la configuración de lanzamiento de este programa.
 	dwShaderFlags |= D3DCOMPILE_DEBUG;
 #endif
-	ID3DBlob* pErrorBlob;
-	hr = D3DX11CompileFromFile(szFileName, nullptr, nullptr, szEntryPoint, szShaderModel,
-		dwShaderFlags, 0, nullptr, ppBlobOut, &pErrorBlob, nullptr);
+	ID3DBlob* pErrorBlob = nullptr;
+	size_t sourceSize = 0;
+	const uint8_t* source = g_assets.view(szFileName, sourceSize);
+	std::vector<uint8_t> unpacked;
+	if (!source && g_assets.contains(szFileName) && SUCCEEDED(g_assets.read(szFileName, unpacked))) {
+		source = unpacked.data();
+		sourceSize = unpacked.size();
+	}
+	if (source) {
+		// El código del shader se compila directamente desde el archivo empaquetado
+		hr = D3DCompile(source, sourceSize, szFileName, nullptr, nullptr, szEntryPoint, szShaderModel,
+			dwShaderFlags, 0, ppBlobOut, &pErrorBlob);
+	}
+	else {
+		hr = D3DX11CompileFromFile(szFileName, nullptr, nullptr, szEntryPoint, szShaderModel,
+			dwShaderFlags, 0, nullptr, ppBlobOut, &pErrorBlob, nullptr);
+	}
 	if (FAILED(hr))	{
 		if (pErrorBlob != nullptr)
 			OutputDebugStringA((char*)pErrorBlob->GetBufferPointer());
@@ -127,6 +278,13 @@ HRESULT
 InitDevice() {
 	HRESULT hr = S_OK;
 
+	// Archivo de recursos empaquetados (opcional)
+	if (GetFileAttributesA(g_assetArchiveName) != INVALID_FILE_ATTRIBUTES) {
+		hr = g_assets.open(g_assetArchiveName);
+		if (FAILED(hr))
+			return hr;
+	}
+
 	// Inicializa Swapchain y BackBuffer
 	hr = g_swapchain.init(g_device, g_deviceContext, g_backBuffer, g_window);
 
@@ -134,6 +292,12 @@ InitDevice() {
 		return hr;
 	}
 
+	// Frames que la CPU puede adelantarse a la GPU (lo aplica DXGI dentro de Present)
+	hr = g_framePacer.init(0.0, g_maxFramesInFlight);
+	if (FAILED(hr))
+		return hr;
+	g_swapchain.setMaximumFrameLatency(g_maxFramesInFlight);
+
 	// Crea el Render Target View
 	hr = g_renderTargetView.init(g_device, 
 								 g_backBuffer, 
@@ -169,6 +333,8 @@ InitDevice() {
 	vp.MaxDepth = 1.0f;
 	vp.TopLeftX = 0;
 	vp.TopLeftY = 0;
+	g_aspectRatio = g_window.m_width / (float)g_window.m_height;
+	g_viewportHeight = (float)g_window.m_height;
 
 	// Compilación del Vertex Shader
 	ID3DBlob* pVSBlob = nullptr;
@@ -186,16 +352,15 @@ InitDevice() {
 		return hr;
 	}
 
-	// Definición del Input Layout
-	D3D11_INPUT_ELEMENT_DESC 
-	layout[] = {
-			{ "POSITION", 0, DXGI_FORMAT_R32G32B32_FLOAT, 0, 0, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-			{ "TEXCOORD", 0, DXGI_FORMAT_R32G32_FLOAT, 0, 12, D3D11_INPUT_PER_VERTEX_DATA, 0 },
-	};
-	unsigned int numElements = ARRAYSIZE(layout);
+	// Definición del Input Layout a partir del formato de vértice
+	g_vertexFormat.clear();
+	g_vertexFormat.add(SEMANTIC_POSITION, ENCODING_UNORM16X4);
+	g_vertexFormat.add(SEMANTIC_TEXCOORD, ENCODING_HALF2);
+	std::vector<D3D11_INPUT_ELEMENT_DESC> layout;
+	g_vertexFormat.getInputElements(layout);
 
 	// Creación del Input Layout
-	hr = g_device.CreateInputLayout(layout, numElements, pVSBlob->GetBufferPointer(),
+	hr = g_device.CreateInputLayout(layout.data(), (unsigned int)layout.size(), pVSBlob->GetBufferPointer(),
 		pVSBlob->GetBufferSize(), &g_pVertexLayout);
 	pVSBlob->Release();
 	if (FAILED(hr))
@@ -216,54 +381,67 @@ InitDevice() {
 	if (FAILED(hr))
 		return hr;
 
-	// Creación del Vertex Buffer
+	// Sistema de trabajos; el hilo principal cuenta como uno de sus hilos
+	hr = g_jobs.init();
+	if (FAILED(hr))
+		return hr;
+
+	// Importación de la malla (opcional); los tramos del archivo se analizan en los hilos de trabajo
+	MeshData mesh;
+	if (GetFileAttributesA(g_meshFileName) != INVALID_FILE_ATTRIBUTES) {
+		g_meshLoader.init(&g_jobs);
+		hr = g_meshLoader.load(g_meshFileName, mesh);
+		if (FAILED(hr))
+			return hr;
+		const MeshLoader::Stats& stats = g_meshLoader.getStats();
+		MESSAGE("SRTEngine", "InitDevice", (std::string(g_meshFileName) + ": " + std::to_string(stats.vertices) +
+			" vertices, " + std::to_string(stats.triangles) + " triangles").c_str());
+
+		// Orden de triángulos para la caché de vértices y el overdraw, y de vértices para su lectura
+		MeshOptimizer::Stats optimized;
+		hr = MeshOptimizer::optimize(mesh, MeshOptimizer::Options(), &optimized);
+		if (FAILED(hr))
+			return hr;
+		MESSAGE("SRTEngine", "InitDevice", ("ACMR " + std::to_string(optimized.before.acmr) + " -> " +
+			std::to_string(optimized.after.acmr) + ", ATVR " + std::to_string(optimized.before.atvr) + " -> " +
+			std::to_string(optimized.after.atvr)).c_str());
+	}
+
+	// Creación del Vertex Buffer (el cubo si no se importó ninguna malla)
 	SimpleVertex 
 	vertices[] =	{
-			{ XMFLOAT3(-1.0f, 1.0f, -1.0f), XMFLOAT2(0.0f, 0.0f) },
-			{ XMFLOAT3(1.0f, 1.0f, -1.0f), XMFLOAT2(1.0f, 0.0f) },
-			{ XMFLOAT3(1.0f, 1.0f, 1.0f), XMFLOAT2(1.0f, 1.0f) },
-			{ XMFLOAT3(-1.0f, 1.0f, 1.0f), XMFLOAT2(0.0f, 1.0f) },
-
-			{ XMFLOAT3(-1.0f, -1.0f, -1.0f), XMFLOAT2(0.0f, 0.0f) },
-			{ XMFLOAT3(1.0f, -1.0f, -1.0f), XMFLOAT2(1.0f, 0.0f) },
-			{ XMFLOAT3(1.0f, -1.0f, 1.0f), XMFLOAT2(1.0f, 1.0f) },
-			{ XMFLOAT3(-1.0f, -1.0f, 1.0f), XMFLOAT2(0.0f, 1.0f) },
-
-			{ XMFLOAT3(-1.0f, -1.0f, 1.0f), XMFLOAT2(0.0f, 0.0f) },
-			{ XMFLOAT3(-1.0f, -1.0f, -1.0f), XMFLOAT2(1.0f, 0.0f) },
-			{ XMFLOAT3(-1.0f, 1.0f, -1.0f), XMFLOAT2(1.0f, 1.0f) },
-			{ XMFLOAT3(-1.0f, 1.0f, 1.0f), XMFLOAT2(0.0f, 1.0f) },
-
-			{ XMFLOAT3(1.0f, -1.0f, 1.0f), XMFLOAT2(0.0f, 0.0f) },
-			{ XMFLOAT3(1.0f, -1.0f, -1.0f), XMFLOAT2(1.0f, 0.0f) },
-			{ XMFLOAT3(1.0f, 1.0f, -1.0f), XMFLOAT2(1.0f, 1.0f) },
-			{ XMFLOAT3(1.0f, 1.0f, 1.0f), XMFLOAT2(0.0f, 1.0f) },
-
-			{ XMFLOAT3(-1.0f, -1.0f, -1.0f), XMFLOAT2(0.0f, 0.0f) },
-			{ XMFLOAT3(1.0f, -1.0f, -1.0f), XMFLOAT2(1.0f, 0.0f) },
-			{ XMFLOAT3(1.0f, 1.0f, -1.0f), XMFLOAT2(1.0f, 1.0f) },
-			{ XMFLOAT3(-1.0f, 1.0f, -1.0f), XMFLOAT2(0.0f, 1.0f) },
-
-			{ XMFLOAT3(-1.0f, -1.0f, 1.0f), XMFLOAT2(0.0f, 0.0f) },
-			{ XMFLOAT3(1.0f, -1.0f, 1.0f), XMFLOAT2(1.0f, 0.0f) },
-			{ XMFLOAT3(1.0f, 1.0f, 1.0f), XMFLOAT2(1.0f, 1.0f) },
-			{ XMFLOAT3(-1.0f, 1.0f, 1.0f), XMFLOAT2(0.0f, 1.0f) },
+			{ Float3(-1.0f, 1.0f, -1.0f), Float2(0.0f, 0.0f) },
+			{ Float3(1.0f, 1.0f, -1.0f), Float2(1.0f, 0.0f) },
+			{ Float3(1.0f, 1.0f, 1.0f), Float2(1.0f, 1.0f) },
+			{ Float3(-1.0f, 1.0f, 1.0f), Float2(0.0f, 1.0f) },
+
+			{ Float3(-1.0f, -1.0f, -1.0f), Float2(0.0f, 0.0f) },
+			{ Float3(1.0f, -1.0f, -1.0f), Float2(1.0f, 0.0f) },
+			{ Float3(1.0f, -1.0f, 1.0f), Float2(1.0f, 1.0f) },
+			{ Float3(-1.0f, -1.0f, 1.0f), Float2(0.0f, 1.0f) },
+
+			{ Float3(-1.0f, -1.0f, 1.0f), Float2(0.0f, 0.0f) },
+			{ Float3(-1.0f, -1.0f, -1.0f), Float2(1.0f, 0.0f) },
+			{ Float3(-1.0f, 1.0f, -1.0f), Float2(1.0f, 1.0f) },
+			{ Float3(-1.0f, 1.0f, 1.0f), Float2(0.0f, 1.0f) },
+
+			{ Float3(1.0f, -1.0f, 1.0f), Float2(0.0f, 0.0f) },
+			{ Float3(1.0f, -1.0f, -1.0f), Float2(1.0f, 0.0f) },
+			{ Float3(1.0f, 1.0f, -1.0f), Float2(1.0f, 1.0f) },
+			{ Float3(1.0f, 1.0f, 1.0f), Float2(0.0f, 1.0f) },
+
+			{ Float3(-1.0f, -1.0f, -1.0f), Float2(0.0f, 0.0f) },
+			{ Float3(1.0f, -1.0f, -1.0f), Float2(1.0f, 0.0f) },
+			{ Float3(1.0f, 1.0f, -1.0f), Float2(1.0f, 1.0f) },
+			{ Float3(-1.0f, 1.0f, -1.0f), Float2(0.0f, 1.0f) },
+
+			{ Float3(-1.0f, -1.0f, 1.0f), Float2(0.0f, 0.0f) },
+			{ Float3(1.0f, -1.0f, 1.0f), Float2(1.0f, 0.0f) },
+			{ Float3(1.0f, 1.0f, 1.0f), Float2(1.0f, 1.0f) },
+			{ Float3(-1.0f, 1.0f, 1.0f), Float2(0.0f, 1.0f) },
 	};
 
-	D3D11_BUFFER_DESC bd;
-	ZeroMemory(&bd, sizeof(bd));
-	bd.Usage = D3D11_USAGE_DEFAULT;
-	bd.ByteWidth = sizeof(SimpleVertex) * 24;
-	bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
-	bd.CPUAccessFlags = 0;
-	D3D11_SUBRESOURCE_DATA InitData;
-	ZeroMemory(&InitData, sizeof(InitData));
-	InitData.pSysMem = vertices;
-	hr = g_device.CreateBuffer(&bd, &InitData, &g_pVertexBuffer);
-	if (FAILED(hr))
-		return hr;
-
-	// Creación del Index Buffer
+	// Índices del cubo
 	WORD indices[] = 
 	{
 			3,1,0,
@@ -285,38 +463,174 @@ InitDevice() {
 			23,20,22
 	};
 
+	if (mesh.vertices.empty()) {
+		for (const SimpleVertex& vertex : vertices)
+			mesh.vertices.push_back({ vertex.Pos, vertex.Tex });
+		mesh.indices.assign(indices, indices + ARRAYSIZE(indices));
+		mesh.boundsMin = Float3(-1.0f, -1.0f, -1.0f);
+		mesh.boundsMax = Float3(1.0f, 1.0f, 1.0f);
+	}
+
+	// Cadena de LODs por colapso de aristas (índices sobre los mismos vértices)
+	std::vector<MeshSimplifier::Lod> lods;
+	MeshSimplifier::Stats lodStats;
+	hr = MeshSimplifier::buildLods(mesh, MeshSimplifier::LodOptions(), lods, &lodStats);
+	if (FAILED(hr))
+		return hr;
+	MESSAGE("SRTEngine", "InitDevice", (std::to_string(lodStats.levels) + " LODs in " +
+		std::to_string(lodStats.seconds * 1000.0) + " ms").c_str());
+
+	// Cada LOD, en orden para la caché de vértices, se parte en tramos de 16 bits (el formato de
+	// índices más estrecho) y meshlets con sus conos de normales, detrás de los del LOD anterior
+	MeshletMesh lodMeshlets;
+	for (size_t l = 0; l < lods.size(); ++l) {
+		mesh.indices.swap(lods[l].indices);
+		if (l > 0)
+			MeshOptimizer::optimizeVertexCache(mesh.indices.data(), mesh.indices.size(), (unsigned int)mesh.vertices.size());
+		hr = MeshletBuilder::build(mesh, MeshletBuilder::Options(), lodMeshlets);
+		if (FAILED(hr))
+			return hr;
+		g_lodFirstChunk.push_back((unsigned int)g_meshlets.chunks.size());
+		hr = MeshletBuilder::append(g_meshlets, lodMeshlets);
+		if (FAILED(hr))
+			return hr;
+		g_lodErrors.push_back(lods[l].error);
+		MESSAGE("SRTEngine", "InitDevice", ("LOD " + std::to_string(l) + ": " + std::to_string(mesh.indices.size() / 3) +
+			" triangles, error " + std::to_string(lods[l].error)).c_str());
+	}
+	g_lodFirstChunk.push_back((unsigned int)g_meshlets.chunks.size());
+
+	// El último LOD (el que queda en mesh.indices) es el oclusor: sus vértices son los de la
+	// malla original, así que no sale de la esfera del objeto ni lo tapa a él mismo
+	g_occluderMesh.vertices = mesh.vertices;
+	g_occluderMesh.indices = mesh.indices;
+
+	// Vértices codificados con g_vertexFormat sobre la caja de la malla
+	g_vertexFormat.setBounds(mesh.boundsMin, mesh.boundsMax);
+	g_positionDecode = g_vertexFormat.getPositionDecodeMatrix();
+	g_positionEncode = MatrixInverse(g_positionDecode);
+	VertexFormat::Source source;
+	source.streams[SEMANTIC_POSITION] = { &g_meshlets.vertices[0].position, sizeof(MeshVertex) };
+	source.streams[SEMANTIC_TEXCOORD] = { &g_meshlets.vertices[0].texCoord, sizeof(MeshVertex) };
+	std::vector<uint8_t> vertexData(g_meshlets.vertices.size() * g_vertexFormat.getStride());
+	hr = g_vertexFormat.encode(source, g_meshlets.vertices.size(), vertexData.data());
+	if (FAILED(hr))
+		return hr;
+	MESSAGE("SRTEngine", "InitDevice", (std::to_string(g_vertexFormat.getStride()) + " bytes per vertex instead of " +
+		std::to_string(sizeof(MeshVertex))).c_str());
+
+	D3D11_BUFFER_DESC bd;
+	ZeroMemory(&bd, sizeof(bd));
 	bd.Usage = D3D11_USAGE_DEFAULT;
-	bd.ByteWidth = sizeof(WORD) * 36;
-	bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
+	bd.ByteWidth = (UINT)vertexData.size();
+	bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
 	bd.CPUAccessFlags = 0;
-	InitData.pSysMem = indices;
-	hr = g_device.CreateBuffer(&bd, &InitData, &g_pIndexBuffer);
+	D3D11_SUBRESOURCE_DATA InitData;
+	ZeroMemory(&InitData, sizeof(InitData));
+	InitData.pSysMem = vertexData.data();
+	hr = g_device.CreateBuffer(&bd, &InitData, &g_pVertexBuffer);
 	if (FAILED(hr))
 		return hr;
 
-	// Creación de los búferes de constantes
+	// Creación del Index Buffer
 	bd.Usage = D3D11_USAGE_DEFAULT;
-	bd.ByteWidth = sizeof(CBNeverChanges);
-	bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	bd.ByteWidth = (UINT)g_meshlets.indexData.size();
+	bd.BindFlags = D3D11_BIND_INDEX_BUFFER;
 	bd.CPUAccessFlags = 0;
-	hr = g_device.CreateBuffer(&bd, nullptr, &g_pCBNeverChanges);
+	InitData.pSysMem = g_meshlets.indexData.data();
+	hr = g_device.CreateBuffer(&bd, &InitData, &g_pIndexBuffer);
 	if (FAILED(hr))
 		return hr;
 
-	bd.ByteWidth = sizeof(CBChangeOnResize);
-	hr = g_device.CreateBuffer(&bd, nullptr, &g_pCBChangeOnResize);
+	// Con el rasterizador por software los mismos vértices e índices van en búferes de CPU
+	if (g_backend == BACKEND_SOFTWARE) {
+		hr = g_softRasterizer.init(g_window.m_width, g_window.m_height);
+		if (FAILED(hr))
+			return hr;
+		g_softLayout = SoftInputLayout(g_vertexFormat);
+		g_softVertexBuffer.m_data = vertexData;
+		g_softIndexBuffer.m_data = g_meshlets.indexData;
+		hr = LoadSoftTexture("seafloor.dds", g_softSeafloor);
+		if (FAILED(hr))
+			return hr;
+		MESSAGE("SRTEngine", "InitDevice", ("Software rasterizer with " +
+			std::to_string(g_softRasterizer.getThreadCount()) + " threads").c_str());
+	}
+
+	// La esfera se centra en el origen de la malla, que es el que sigue a la matriz de mundo
+	const Float3 extent(fmaxf(fabsf(mesh.boundsMin.x), fabsf(mesh.boundsMax.x)),
+		fmaxf(fabsf(mesh.boundsMin.y), fabsf(mesh.boundsMax.y)),
+		fmaxf(fabsf(mesh.boundsMin.z), fabsf(mesh.boundsMax.z)));
+	g_meshRadius = sqrtf(extent.x * extent.x + extent.y * extent.y + extent.z * extent.z);
+
+	// Dibujo instanciado; cada tramo de la malla de la escena es un mesh del InstanceRenderer
+	hr = g_instanceRenderer.init(&g_device, &g_deviceContext, 1024, &g_vertexFormat);
 	if (FAILED(hr))
 		return hr;
+	for (const MeshChunk& chunk : g_meshlets.chunks) {
+		InstanceRenderer::Mesh chunkMesh;
+		chunkMesh.indexCount = chunk.indexCount;
+		chunkMesh.startIndexLocation = chunk.firstIndex;
+		chunkMesh.baseVertexLocation = (int)chunk.baseVertex;
+		chunkMesh.vertexBuffer = g_pVertexBuffer;
+		chunkMesh.vertexStride = g_vertexFormat.getStride();
+		chunkMesh.indexBuffer = g_pIndexBuffer;
+		chunkMesh.indexFormat = g_meshlets.indexSize == 4 ? DXGI_FORMAT_R32_UINT : DXGI_FORMAT_R16_UINT;
+		const InstanceRenderer::MeshHandle handle = g_instanceRenderer.addMesh(chunkMesh);
+		if (handle == InstanceRenderer::INVALID_MESH)
+			return E_FAIL;
+		g_meshChunks.push_back(handle);
+	}
 
+	// Creación de los búferes de constantes (anillo de 4 MB para las constantes por objeto)
+	hr = g_constantBuffers.init(&g_device, &g_deviceContext, 4 * 1024 * 1024);
+	if (FAILED(hr))
+		return hr;
+
+	// Búfer de constantes de los draws por objeto (se actualiza desde la lista de comandos)
+	bd.Usage = D3D11_USAGE_DEFAULT;
 	bd.ByteWidth = sizeof(CBChangesEveryFrame);
+	bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	bd.CPUAccessFlags = 0;
 	hr = g_device.CreateBuffer(&bd, nullptr, &g_pCBChangesEveryFrame);
 	if (FAILED(hr))
 		return hr;
 
+	g_cbNeverChanges = g_constantBuffers.createBlock(sizeof(CBNeverChanges));
+	g_cbChangeOnResize = g_constantBuffers.createBlock(sizeof(CBChangeOnResize));
+	if (g_cbNeverChanges == ConstantBufferManager::INVALID_BLOCK ||
+		g_cbChangeOnResize == ConstantBufferManager::INVALID_BLOCK)
+		return E_FAIL;
+
 	// Carga de Textura
-	hr = D3DX11CreateShaderResourceViewFromFile(g_device.m_device, "seafloor.dds", nullptr, nullptr, &g_pTextureRV, nullptr);
+	hr = g_textureCache.init(&g_device, 256 * 1024 * 1024);
 	if (FAILED(hr))
 		return hr;
+	if (g_assets.isOpen())
+		g_textureCache.setArchive(&g_assets);
+
+	g_seafloorTexture = g_textureCache.acquire("seafloor.dds");
+	if (g_seafloorTexture == TextureCache::INVALID_HANDLE)
+		return E_FAIL;
+
+	// Culling de visibilidad
+	hr = g_culler.init(&g_jobs);
+	if (FAILED(hr))
+		return hr;
+
+	// Cola de draws; con muchos draws la ordenación se reparte entre los hilos de trabajo
+	hr = g_renderQueue.init(&g_jobs);
+	if (FAILED(hr))
+		return hr;
+	hr = g_occlusionCuller.init(256, 128);
+	if (FAILED(hr))
+		return hr;
+
+	// LOD por error en pantalla: como mucho un píxel, con histéresis para que no parpadee
+	hr = g_lodSelector.init(LodSelector::Options());
+	if (FAILED(hr))
+		return hr;
+	g_objectBounds.add(Float3(0.0f, 0.0f, 0.0f), g_meshRadius);
 
 	// Creación del Sampler State
 	D3D11_SAMPLER_DESC sampDesc;
@@ -333,13 +647,20 @@ InitDevice() {
 		return hr;
 
 	// Inicialización de las matrices del mundo
-	g_World = XMMatrixIdentity();
+	g_World = MatrixIdentity();
+
+	// Reloj de la simulación; con el rasterizador de referencia (muy lento) cada frame
+	// avanza un paso fijo, como si fuera a 60 Hz
+	hr = g_clock.init(1.0 / 60.0);
+	if (FAILED(hr))
+		return hr;
+	g_clock.setDeterministic(g_swapchain.m_driverType == D3D_DRIVER_TYPE_REFERENCE);
 
 	// Inicialización de View Matrix
-	XMVECTOR Eye = XMVectorSet(0.0f, 3.0f, -6.0f, 0.0f);
-	XMVECTOR At = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
-	XMVECTOR Up = XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
-	g_View = XMMatrixLookAtLH(Eye, At, Up);
+	Vector Eye = VectorSet(0.0f, 3.0f, -6.0f, 0.0f);
+	Vector At = VectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+	Vector Up = VectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+	g_View = MatrixLookAtLH(Eye, At, Up);
 
 	
 
@@ -352,15 +673,25 @@ InitDevice() {
 //--------------------------------------------------------------------------------------
 void 
 CleanupDevice() {
-	if (g_deviceContext.m_deviceContext) g_deviceContext.m_deviceContext->ClearState();
+	if (g_deviceContext.m_deviceContext) g_deviceContext.ClearState();
+
+	g_softRasterizer.destroy();
 
 	if (g_pSamplerLinear) g_pSamplerLinear->Release();
-	if (g_pTextureRV) g_pTextureRV->Release();
-	if (g_pCBNeverChanges) g_pCBNeverChanges->Release();
-	if (g_pCBChangeOnResize) g_pCBChangeOnResize->Release();
-	if (g_pCBChangesEveryFrame) g_pCBChangesEveryFrame->Release();
+	if (g_seafloorTexture != TextureCache::INVALID_HANDLE) g_textureCache.release(g_seafloorTexture);
+	g_textureCache.destroy();
+	g_constantBuffers.destroy();
+	g_instanceRenderer.destroy();
+	g_culler.destroy();
+	g_occlusionCuller.destroy();
+	g_lodSelector.destroy();
+	g_renderQueue.destroy();
+	g_meshLoader.destroy();
+	g_jobs.destroy();
+	g_assets.close();
 	if (g_pVertexBuffer) g_pVertexBuffer->Release();
 	if (g_pIndexBuffer) g_pIndexBuffer->Release();
+	if (g_pCBChangesEveryFrame) g_pCBChangesEveryFrame->Release();
 	if (g_pVertexLayout) g_pVertexLayout->Release();
 	if (g_pVertexShader) g_pVertexShader->Release();
 	if (g_pPixelShader) g_pPixelShader->Release();
@@ -465,10 +796,16 @@ WndProc(HWND hWnd, unsigned int message, WPARAM wParam, LPARAM lParam) {
 			g_deviceContext.RSSetViewports(1, &vp);
 
 			// Actualizar la proyecci�n
-			g_Projection = XMMatrixPerspectiveFovLH(XM_PIDIV4, g_window.m_width / (float)g_window.m_height, 0.01f, 100.0f);
-			CBChangeOnResize cbChangesOnResize;
-			cbChangesOnResize.mProjection = XMMatrixTranspose(g_Projection);
-			g_deviceContext.UpdateSubresource(g_pCBChangeOnResize, 0, nullptr, &cbChangesOnResize, 0, 0);
+			// (la simulación la recalcula a partir del siguiente frame)
+			g_aspectRatio = g_window.m_width / (float)g_window.m_height;
+			g_viewportHeight = (float)g_window.m_height;
+
+			// El render target del rasterizador por software sigue al tamaño de la ventana
+			if (g_backend == BACKEND_SOFTWARE && g_window.m_width > 0 && g_window.m_height > 0 &&
+				FAILED(g_softRasterizer.init(g_window.m_width, g_window.m_height))) {
+				MessageBox(hWnd, "Failed to resize the software rasterizer.", "Error", MB_OK);
+				PostQuitMessage(0);
+			}
 		}
 		break;
 
@@ -485,84 +822,307 @@ WndProc(HWND hWnd, unsigned int message, WPARAM wParam, LPARAM lParam) {
 
 
 //--------------------------------------------------------------------------------------
-// Update frame-specific variables
+// Update frame-specific variables (hilo de simulación: no usa el contexto de dispositivo)
 //--------------------------------------------------------------------------------------
-void update() {
-	// Actualizar tiempo y rotaci�n
-	static float t = 0.0f;
-	if (g_swapchain.m_driverType == D3D_DRIVER_TYPE_REFERENCE) {
-		t += (float)XM_PI * 0.0125f;
-	}
-	else {
-		static DWORD dwTimeStart = 0;
-		DWORD dwTimeCur = GetTickCount();
-		if (dwTimeStart == 0)
-			dwTimeStart = dwTimeCur;
-		t = (dwTimeCur - dwTimeStart) / 1000.0f;
+void update(unsigned int frameSlot) {
+	FrameData& frame = g_frames[frameSlot];
+	frame.inputTime = FramePacer::now();
+
+	// Actualizar tiempo y rotaci�n: el cubo gira a 1 rad/s en pasos fijos
+	g_clock.tick();
+	while (g_clock.step()) {
+		g_previousAngle = g_currentAngle;
+		g_currentAngle += (float)g_clock.getFixedStep();
 	}
+	const float t = g_previousAngle + (g_currentAngle - g_previousAngle) * g_clock.getAlpha();
 
 	// Actualizar la rotaci�n del objeto y el color
-	g_World = XMMatrixRotationY(t);
-	g_vMeshColor = XMFLOAT4(
+	g_World = MatrixRotationY(t);
+	g_vMeshColor = Float4(
 		(sinf(t * 1.0f) + 1.0f) * 0.5f,
 		(cosf(t * 3.0f) + 1.0f) * 0.5f,
 		(sinf(t * 5.0f) + 1.0f) * 0.5f,
 		1.0f
 	);
 
-	// Actualizar el buffer constante del frame
-	cb.mWorld = XMMatrixTranspose(g_World);
-	cb.vMeshColor = g_vMeshColor;
-	g_deviceContext.UpdateSubresource(g_pCBChangesEveryFrame, 0, nullptr, &cb, 0, 0);
-
 	// Actualizar la matriz de proyecci�n
-	g_Projection = XMMatrixPerspectiveFovLH(XM_PIDIV4, g_window.m_width / (float)g_window.m_height, 0.01f, 100.0f);
-
-	// Actualizar la vista (si es necesario cambiar din�micamente)
-	cbNeverChanges.mView = XMMatrixTranspose(g_View);
-	g_deviceContext.UpdateSubresource(g_pCBNeverChanges, 0, nullptr, &cbNeverChanges, 0, 0);
-
-	// Actualizar la proyecci�n en el buffer constante
-	cbChangesOnResize.mProjection = XMMatrixTranspose(g_Projection);
-	g_deviceContext.UpdateSubresource(g_pCBChangeOnResize, 0, nullptr, &cbChangesOnResize, 0, 0);
+	g_Projection = MatrixPerspectiveFovLH(MATH_PIDIV4, g_aspectRatio.load(), 0.01f, g_farPlane);
+	frame.changesOnResize.mProjection = MatrixTranspose(g_Projection);
+
+	// Visibilidad: la esfera sigue a la traslación del mundo (la rotación no la cambia)
+	Float3 cubeCenter;
+	VectorStore(cubeCenter, g_World.r[3]);
+	g_objectBounds.set(0, cubeCenter, g_meshRadius);
+	g_culler.setFrustum(g_View, g_Projection);
+	g_culler.cullSpheres(g_objectBounds, frame.visibleObjects);
+
+	// Oclusión: el objeto, si está dentro del frustum, rasteriza su LOD más simple y se
+	// descarta lo que quede detrás (el objeto 0 es el único y su mundo es g_World)
+	g_occlusionCuller.beginFrame(g_View, g_Projection);
+	if (!frame.visibleObjects.empty()) {
+		g_occlusionCuller.addOccluder(g_occluderMesh.vertices.data(), sizeof(MeshVertex),
+			(unsigned int)g_occluderMesh.vertices.size(), g_occluderMesh.indices.data(),
+			(unsigned int)g_occluderMesh.indices.size(), g_World);
+	}
+	g_occlusionCuller.finishOccluders();
+	g_occlusionCuller.cullSpheres(g_objectBounds, frame.visibleObjects);
+
+	// Agrupar los objetos visibles por malla y material para el render: cada objeto añade los
+	// tramos del LOD que le toca por su tamaño en pantalla (todos son la misma malla)
+	frame.instances.clear();
+	g_lodSelector.beginFrame(g_View, g_Projection, g_viewportHeight.load());
+	for (uint32_t object : frame.visibleObjects) {
+		const Float3 center(g_objectBounds.centerX[object], g_objectBounds.centerY[object], g_objectBounds.centerZ[object]);
+		const unsigned int lod = g_lodSelector.select(object, center, g_objectBounds.radius[object],
+			g_lodErrors.data(), (unsigned int)g_lodErrors.size());
+		for (unsigned int chunk = g_lodFirstChunk[lod]; chunk < g_lodFirstChunk[lod + 1]; ++chunk)
+			frame.instances.add(g_meshChunks[chunk], 0, MatrixMultiply(g_positionDecode, g_World), g_vMeshColor, chunk);
+	}
+	frame.instances.build();
 }
 
 //--------------------------------------------------------------------------------------
 // Render a frame
 //--------------------------------------------------------------------------------------
-void Render() {
+void Render(unsigned int frameSlot) {
+	const FrameData& frame = g_frames[frameSlot];
+
+	// Actualizar la vista (si es necesario cambiar din�micamente)
+	const bool software = g_backend == BACKEND_SOFTWARE;
+	cbNeverChanges.mView = MatrixTranspose(g_View);
+
 	// Limpiar los buffers
 	const float ClearColor[4] = { 0.0f, 0.125f, 0.3f, 1.0f }; // red, green, blue, alpha
 
-	// Establecer el Render Target View
-	g_renderTargetView.render(g_deviceContext, g_depthStencilView, 1, ClearColor);
+	// Plantilla de los draws por objeto con los recursos del backend
+	RenderQueue::Draw drawTemplate;
+	drawTemplate.vertexStride = g_vertexFormat.getStride();
+	drawTemplate.indexWidth = g_meshlets.indexSize == 4 ? CommandList::INDEX_32 : CommandList::INDEX_16;
+	if (software) {
+		// Mismo estado común en el rasterizador por software (el viewport es el de init())
+		g_softRasterizer.UpdateSubresource(&g_softCBNeverChanges, &cbNeverChanges, sizeof(cbNeverChanges));
+		g_softRasterizer.UpdateSubresource(&g_softCBChangeOnResize, &frame.changesOnResize, sizeof(frame.changesOnResize));
+		g_softRasterizer.ClearRenderTargetView(ClearColor);
+		g_softRasterizer.ClearDepthStencilView(1.0f);
+		const SoftBuffer* constantBuffers[2] = { &g_softCBNeverChanges, &g_softCBChangeOnResize };
+		g_softRasterizer.VSSetConstantBuffers(0, 2, constantBuffers);
+		drawTemplate.inputLayout = &g_softLayout;
+		drawTemplate.vertexBuffer = &g_softVertexBuffer;
+		drawTemplate.indexBuffer = &g_softIndexBuffer;
+		drawTemplate.texture = &g_softSeafloor;
+	}
+	else {
+		g_constantBuffers.updateBlock(g_cbNeverChanges, &cbNeverChanges, sizeof(cbNeverChanges));
+
+		// Actualizar la proyecci�n en el buffer constante (solo se sube si cambió)
+		g_constantBuffers.updateBlock(g_cbChangeOnResize, &frame.changesOnResize, sizeof(frame.changesOnResize));
+
+		// Establecer el Render Target View
+		g_renderTargetView.render(g_deviceContext, g_depthStencilView, 1, ClearColor);
+
+		// Establecer el Viewport
+		g_deviceContext.RSSetViewports(1, &vp);
+
+		// Establecer el Depth Stencil View
+		g_depthStencilView.render(g_deviceContext);
+
+		// Estado común a todos los draws: vista, proyección, textura y sampler
+		g_constantBuffers.bindBlock(StateCache::VERTEX_STAGE, 0, g_cbNeverChanges);
+		g_constantBuffers.bindBlock(StateCache::VERTEX_STAGE, 1, g_cbChangeOnResize);
+		Texture* seafloor = g_textureCache.getTexture(g_seafloorTexture);
+		seafloor->render(g_deviceContext, 0, 1);
+		g_deviceContext.PSSetSamplers(0, 1, &g_pSamplerLinear);
+		drawTemplate.inputLayout = g_pVertexLayout;
+		drawTemplate.vertexShader = g_pVertexShader;
+		drawTemplate.pixelShader = g_pPixelShader;
+		drawTemplate.vertexBuffer = g_pVertexBuffer;
+		drawTemplate.indexBuffer = g_pIndexBuffer;
+		drawTemplate.texture = seafloor->m_textureFromImg;
+	}
+
+	// Solo se dibuja lo que quedó dentro del frustum y sin tapar: los lotes pequeños objeto a objeto...
+	const InstanceData* instances = frame.instances.getInstances();
+	g_renderQueue.clear();
+	g_objectConstants.clear();
+	g_objectConstants.reserve(frame.instances.getInstanceCount()); // Los draws apuntan a sus constantes
+	// Con el anillo, todas las asignaciones del frame tienen que seguir vivas al reproducir la lista
+	const bool ringConstants = !software && g_constantBuffers.usesOffsetBinding() &&
+		g_constantBuffers.reserve(sizeof(CBChangesEveryFrame), frame.instances.getInstanceCount());
+	const Vector eye = MatrixInverse(g_View).r[3];
+	// Cámara en el espacio de la malla (sin la descuantización) y profundidad del objeto: como
+	// inverse(encode * world) = inverse(world) * decode, basta con invertir el mundo, y solo
+	// cuando cambia de una instancia a la siguiente (en la escena todas comparten el mismo)
+	Float4 eyeWorld[4];
+	Float3 localEye;
+	float depth = 0.0f;
+	bool eyeValid = false;
+	for (const InstanceBatcher::Batch& batch : frame.instances.getBatches()) {
+		if (batch.instanceCount >= g_instancingThreshold)
+			continue;
+		const unsigned int chunk = batch.userData;
+		for (unsigned int i = 0; i < batch.instanceCount; ++i) {
+			const InstanceData& instance = instances[batch.firstInstance + i];
+			Matrix world;
+			for (int row = 0; row < 4; ++row)
+				world.r[row] = VectorLoad(instance.world[row]);
+			g_objectConstants.emplace_back();
+			CBChangesEveryFrame& cb = g_objectConstants.back();
+			cb.mWorld = MatrixTranspose(world);
+			cb.vMeshColor = instance.color;
+
+			if (!eyeValid || memcmp(eyeWorld, instance.world, sizeof(eyeWorld)) != 0) {
+				memcpy(eyeWorld, instance.world, sizeof(eyeWorld));
+				VectorStore(localEye, Vector3Transform(eye, MatrixMultiply(MatrixInverse(world), g_positionDecode)));
+				// Profundidad en espacio de vista del origen de la malla, normalizada al plano lejano
+				const Vector origin = Vector3Transform(g_positionEncode.r[3], world);
+				depth = VectorGetZ(Vector3Transform(origin, g_View)) / g_farPlane;
+				eyeValid = true;
+			}
 
-	// Establecer el Viewport
-	g_deviceContext.RSSetViewports(1, &vp);
+			// Meshlets del tramo que miran a la cámara, en rangos seguidos
+			g_meshletRanges.clear();
+			MeshletBuilder::cull(g_meshlets, chunk, localEye, g_meshletGapTriangles, g_meshletRanges);
 
-	// Establecer el Depth Stencil View
-	g_depthStencilView.render(g_deviceContext);
-	
-	// Configurar los buffers y shaders para el pipeline
-	g_deviceContext.IASetInputLayout(g_pVertexLayout);
-	g_deviceContext.IASetVertexBuffers(0, 1, &g_pVertexBuffer, &stride, &offset);
-	g_deviceContext.IASetIndexBuffer(g_pIndexBuffer, DXGI_FORMAT_R16_UINT, 0);
-	g_deviceContext.IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
-
-	// Asignar shaders y buffers constantes
-	g_deviceContext.VSSetShader(g_pVertexShader, nullptr, 0);
-	g_deviceContext.VSSetConstantBuffers(0, 1, &g_pCBNeverChanges);
-	g_deviceContext.VSSetConstantBuffers(1, 1, &g_pCBChangeOnResize);
-	g_deviceContext.VSSetConstantBuffers(2, 1, &g_pCBChangesEveryFrame);
-
-	g_deviceContext.PSSetShader(g_pPixelShader, nullptr, 0);
-	g_deviceContext.PSSetConstantBuffers(2, 1, &g_pCBChangesEveryFrame);
-	g_deviceContext.PSSetShaderResources(0, 1, &g_pTextureRV);
-	g_deviceContext.PSSetSamplers(0, 1, &g_pSamplerLinear);
-
-	// Dibujar
-	g_deviceContext.DrawIndexed(36, 0, 0);
-
-	// Presentar el frame en pantalla
-	g_swapchain.present();
-}
\ No newline at end of file
+			RenderQueue::Draw draw = drawTemplate;
+			ConstantBufferManager::Allocation allocation;
+			if (ringConstants && g_constantBuffers.allocate(&cb, sizeof(cb), allocation)) {
+				draw.constantBuffer = g_constantBuffers.getRingBuffer();
+				draw.firstConstant = allocation.firstConstant;
+				draw.numConstants = allocation.numConstants;
+			}
+			else {
+				// Los tramos del objeto comparten el puntero: submit() solo sube el primero
+				draw.constantBuffer = software ? (const void*)&g_softCBChangesEveryFrame : g_pCBChangesEveryFrame;
+				draw.constants = &cb;
+				draw.constantsSize = sizeof(cb);
+			}
+
+			for (const MeshletBuilder::DrawRange& range : g_meshletRanges) {
+				draw.indexCount = range.indexCount;
+				draw.startIndexLocation = range.firstIndex;
+				draw.baseVertexLocation = range.baseVertex;
+				g_renderQueue.add(RenderQueue::makeKey(0, 0, SHADER_KEY_TURTLE, batch.material, g_seafloorTexture, depth), draw);
+			}
+		}
+	}
+	g_renderList.reset();
+	g_renderQueue.submit(g_renderList);
+	if (software) {
+		g_softRasterizer.executeCommandList(g_renderList);
+
+		// ...y los repetidos con un DrawIndexedInstanced por lote, con las instancias en el slot 1
+		g_softInstances.m_data.assign(reinterpret_cast<const uint8_t*>(instances),
+			reinterpret_cast<const uint8_t*>(instances + frame.instances.getInstanceCount()));
+		const SoftBuffer* vertexBuffers[2] = { &g_softVertexBuffer, &g_softInstances };
+		const unsigned int strides[2] = { g_vertexFormat.getStride(), sizeof(InstanceData) };
+		const unsigned int offsets[2] = { 0, 0 };
+		g_softRasterizer.IASetInputLayout(&g_softLayout);
+		g_softRasterizer.IASetVertexBuffers(0, 2, vertexBuffers, strides, offsets);
+		g_softRasterizer.IASetIndexBuffer(&g_softIndexBuffer, g_meshlets.indexSize == 4 ? SOFT_INDEX_32 : SOFT_INDEX_16, 0);
+		for (const InstanceBatcher::Batch& batch : frame.instances.getBatches()) {
+			if (batch.instanceCount < g_instancingThreshold)
+				continue;
+			const MeshChunk& chunk = g_meshlets.chunks[batch.userData];
+			g_softRasterizer.DrawIndexedInstanced(chunk.indexCount, batch.instanceCount, chunk.firstIndex,
+				(int)chunk.baseVertex, batch.firstInstance);
+		}
+
+		// Presentar el frame en pantalla
+		g_softRasterizer.present();
+		PresentSoftFrame();
+	}
+	else {
+		g_deviceContext.executeCommandList(g_renderList);
+
+		// ...y los repetidos con un dibujo instanciado por lote
+		g_instanceRenderer.submit(frame.instances, g_instancingThreshold);
+
+		// Presentar el frame en pantalla
+		g_swapchain.present(g_syncInterval);
+	}
+	g_framePacer.presented(frame.inputTime);
+
+	// Cerrar los contadores de llamadas de estado y de bytes subidos del frame
+	g_deviceContext.endFrame();
+	g_constantBuffers.endFrame();
+}
+//--------------------------------------------------------------------------------------
+// Carga el primer mip de una textura DDS en RGBA8 para el rasterizador por software: RGBA8 y
+// BGRA8 se copian y BC1/3/4/5/7 se descomprimen. Otros formatos se quedan en blanco
+//--------------------------------------------------------------------------------------
+HRESULT
+LoadSoftTexture(const char* fileName, SoftTexture& texture) {
+	DDSFile dds;
+	std::vector<uint8_t> archived;
+	HRESULT hr = g_assets.isOpen() && SUCCEEDED(g_assets.read(fileName, archived)) ?
+		dds.parse(archived.data(), archived.size()) : dds.open(fileName);
+	if (FAILED(hr))
+		return hr;
+
+	texture = SoftTexture();
+	const DDSFile::Subresource& level = dds.getSubresources()[0];
+	BCFormat bcFormat = BC_FORMAT_NONE;
+	switch (dds.getFormat()) {
+	case DXGI_FORMAT_BC1_UNORM: case DXGI_FORMAT_BC1_UNORM_SRGB: bcFormat = BC_FORMAT_BC1; break;
+	case DXGI_FORMAT_BC3_UNORM: case DXGI_FORMAT_BC3_UNORM_SRGB: bcFormat = BC_FORMAT_BC3; break;
+	case DXGI_FORMAT_BC4_UNORM: bcFormat = BC_FORMAT_BC4; break;
+	case DXGI_FORMAT_BC5_UNORM: bcFormat = BC_FORMAT_BC5; break;
+	case DXGI_FORMAT_BC7_UNORM: case DXGI_FORMAT_BC7_UNORM_SRGB: bcFormat = BC_FORMAT_BC7; break;
+	default: break;
+	}
+
+	if (bcFormat != BC_FORMAT_NONE) {
+		std::vector<uint8_t> pixels;
+		hr = BlockCompressor::decode(level.data, level.width, level.height, bcFormat, pixels);
+		if (FAILED(hr))
+			return hr;
+		texture.m_texels.resize((size_t)level.width * level.height);
+		memcpy(texture.m_texels.data(), pixels.data(), pixels.size());
+	}
+	else if (dds.getFormat() == DXGI_FORMAT_R8G8B8A8_UNORM || dds.getFormat() == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB ||
+		dds.getFormat() == DXGI_FORMAT_B8G8R8A8_UNORM || dds.getFormat() == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB) {
+		const bool bgra = dds.getFormat() == DXGI_FORMAT_B8G8R8A8_UNORM || dds.getFormat() == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+		texture.m_texels.resize((size_t)level.width * level.height);
+		for (unsigned int y = 0; y < level.height; ++y) {
+			uint32_t* row = &texture.m_texels[(size_t)y * level.width];
+			memcpy(row, level.data + (size_t)y * level.rowPitch, level.width * 4);
+			for (unsigned int x = 0; bgra && x < level.width; ++x)
+				row[x] = (row[x] & 0xFF00FF00u) | ((row[x] >> 16) & 0xFFu) | ((row[x] & 0xFFu) << 16);
+		}
+	}
+	else {
+		MESSAGE("SRTEngine", "LoadSoftTexture", (std::string(fileName) + ": format not supported by the software rasterizer, drawing white").c_str());
+		return S_OK;
+	}
+	texture.m_width = level.width;
+	texture.m_height = level.height;
+	return S_OK;
+}
+
+//--------------------------------------------------------------------------------------
+// Copia el render target del rasterizador por software a la ventana (GDI espera BGRA)
+//--------------------------------------------------------------------------------------
+void
+PresentSoftFrame() {
+	const SoftRenderTarget& target = g_softRasterizer.m_renderTarget;
+	g_softFrame.resize((size_t)target.m_width * target.m_height);
+	for (unsigned int y = 0; y < target.m_height; ++y) {
+		const uint32_t* source = &target.m_color[(size_t)y * target.m_pitch];
+		uint32_t* destination = &g_softFrame[(size_t)y * target.m_width];
+		for (unsigned int x = 0; x < target.m_width; ++x)
+			destination[x] = (source[x] & 0xFF00FF00u) | ((source[x] >> 16) & 0xFFu) | ((source[x] & 0xFFu) << 16);
+	}
+
+	BITMAPINFO info;
+	ZeroMemory(&info, sizeof(info));
+	info.bmiHeader.biSize = sizeof(info.bmiHeader);
+	info.bmiHeader.biWidth = (LONG)target.m_width;
+	info.bmiHeader.biHeight = -(LONG)target.m_height; // Filas de arriba abajo
+	info.bmiHeader.biPlanes = 1;
+	info.bmiHeader.biBitCount = 32;
+	info.bmiHeader.biCompression = BI_RGB;
+	HDC hdc = GetDC(g_window.m_hWnd);
+	SetDIBitsToDevice(hdc, 0, 0, target.m_width, target.m_height, 0, 0, 0, target.m_height,
+		g_softFrame.data(), &info, DIB_RGB_COLORS);
+	ReleaseDC(g_window.m_hWnd, hdc);
+}
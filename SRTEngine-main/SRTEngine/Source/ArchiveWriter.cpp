@@ -0,0 +1,134 @@
+#include "ArchiveWriter.h"
+#include "AssetArchive.h"
+#include "LZ4Codec.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+	bool readFile(const std::string& fileName, std::vector<uint8_t>& contents) {
+		std::ifstream stream(fileName, std::ios::binary | std::ios::ate);
+		if (!stream)
+			return false;
+		const std::streamoff size = stream.tellg();
+		if (size < 0)
+			return false;
+		contents.resize((size_t)size);
+		stream.seekg(0);
+		stream.read(reinterpret_cast<char*>(contents.data()), size);
+		return (bool)stream;
+	}
+
+	uint64_t alignUp(uint64_t value, uint64_t alignment) {
+		return (value + alignment - 1) / alignment * alignment;
+	}
+}
+
+void
+ArchiveWriter::addFile(const std::string& name, const std::string& sourcePath, bool compress) {
+	Source source;
+	source.name = AssetArchive::normalizeName(name);
+	source.path = sourcePath;
+	source.compress = compress;
+	m_sources.push_back(std::move(source));
+}
+
+void
+ArchiveWriter::addMemory(const std::string& name, const uint8_t* data, size_t size, bool compress) {
+	Source source;
+	source.name = AssetArchive::normalizeName(name);
+	source.data.assign(data, data + size);
+	source.compress = compress;
+	m_sources.push_back(std::move(source));
+}
+
+// Escribe cabecera, datos alineados y al final la tabla ordenada por hash.
+HRESULT
+ArchiveWriter::write(const std::string& fileName) const {
+	std::vector<AssetArchive::TocEntry> toc(m_sources.size());
+	std::vector<std::string> names;
+	for (const Source& source : m_sources)
+		names.push_back(source.name);
+	std::sort(names.begin(), names.end());
+	if (std::adjacent_find(names.begin(), names.end()) != names.end()) {
+		ERROR("ArchiveWriter", "write", "Duplicate entry name");
+		return E_FAIL;
+	}
+
+	std::ofstream stream(fileName, std::ios::binary | std::ios::trunc);
+	if (!stream) {
+		ERROR("ArchiveWriter", "write", ("Cannot create " + fileName).c_str());
+		return E_FAIL;
+	}
+
+	AssetArchive::Header header = {};
+	header.magic = AssetArchive::MAGIC;
+	header.version = AssetArchive::VERSION;
+	header.entryCount = (uint32_t)m_sources.size();
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	const char padding[AssetArchive::ALIGNMENT] = {};
+	uint64_t offset = sizeof(header);
+	std::string nameTable;
+	std::vector<uint8_t> contents;
+	std::vector<uint8_t> compressed;
+	for (size_t i = 0; i < m_sources.size(); ++i) {
+		const Source& source = m_sources[i];
+		const std::vector<uint8_t>* data = &source.data;
+		if (!source.path.empty()) {
+			if (!readFile(source.path, contents)) {
+				ERROR("ArchiveWriter", "write", ("Cannot read " + source.path).c_str());
+				return E_FAIL;
+			}
+			data = &contents;
+		}
+
+		AssetArchive::TocEntry& entry = toc[i];
+		entry = AssetArchive::TocEntry();
+		entry.nameHash = AssetArchive::hashName(source.name);
+		entry.size = data->size();
+		entry.nameOffset = (uint32_t)nameTable.size();
+		entry.nameLength = (uint32_t)source.name.size();
+		nameTable += source.name;
+
+		const uint8_t* stored = data->data();
+		entry.storedSize = data->size();
+		entry.compression = AssetArchive::COMPRESSION_NONE;
+		if (source.compress && !data->empty()) {
+			LZ4Codec::compress(data->data(), data->size(), compressed);
+			if (compressed.size() < data->size() - data->size() / 10) {
+				stored = compressed.data();
+				entry.storedSize = compressed.size();
+				entry.compression = AssetArchive::COMPRESSION_LZ4;
+			}
+		}
+
+		const uint64_t aligned = alignUp(offset, AssetArchive::ALIGNMENT);
+		stream.write(padding, (std::streamsize)(aligned - offset));
+		entry.offset = aligned;
+		stream.write(reinterpret_cast<const char*>(stored), (std::streamsize)entry.storedSize);
+		offset = aligned + entry.storedSize;
+	}
+
+	std::sort(toc.begin(), toc.end(), [](const AssetArchive::TocEntry& a, const AssetArchive::TocEntry& b) {
+		return a.nameHash < b.nameHash;
+	});
+
+	const uint64_t tocOffset = alignUp(offset, AssetArchive::ALIGNMENT);
+	stream.write(padding, (std::streamsize)(tocOffset - offset));
+	if (!toc.empty())
+		stream.write(reinterpret_cast<const char*>(toc.data()), (std::streamsize)(toc.size() * sizeof(toc[0])));
+	stream.write(nameTable.data(), (std::streamsize)nameTable.size());
+
+	header.tocOffset = tocOffset;
+	header.tocSize = toc.size() * sizeof(AssetArchive::TocEntry) + nameTable.size();
+	stream.seekp(0);
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	stream.close();
+	if (!stream) {
+		ERROR("ArchiveWriter", "write", ("Failed writing " + fileName).c_str());
+		return E_FAIL;
+	}
+	return S_OK;
+}
@@ -0,0 +1,149 @@
+#include "AssetArchive.h"
+#include "LZ4Codec.h"
+#include <cstring>
+
+static_assert(sizeof(AssetArchive::Header) == 32, "AssetArchive header layout changed");
+static_assert(sizeof(AssetArchive::TocEntry) == 48, "AssetArchive TOC layout changed");
+
+HRESULT
+AssetArchive::open(const std::string& fileName) {
+	close();
+	if (FAILED(m_file.open(fileName)))
+		return E_FAIL;
+
+	const uint8_t* data = m_file.data();
+	const size_t size = m_file.size();
+	Header header;
+	if (size < sizeof(header)) {
+		ERROR("AssetArchive", "open", ("Truncated archive " + fileName).c_str());
+		close();
+		return E_FAIL;
+	}
+	std::memcpy(&header, data, sizeof(header));
+	if (header.magic != MAGIC || header.version != VERSION) {
+		ERROR("AssetArchive", "open", ("Not a supported archive " + fileName).c_str());
+		close();
+		return E_FAIL;
+	}
+
+	const uint64_t recordsSize = (uint64_t)header.entryCount * sizeof(TocEntry);
+	if (header.tocOffset % alignof(TocEntry) != 0 || header.tocOffset > size ||
+		header.tocSize > size - header.tocOffset || recordsSize > header.tocSize) {
+		ERROR("AssetArchive", "open", ("Corrupt table of contents in " + fileName).c_str());
+		close();
+		return E_FAIL;
+	}
+
+	// Se valida todo aquí para que las búsquedas no tengan que volver a comprobar límites.
+	const TocEntry* toc = reinterpret_cast<const TocEntry*>(data + header.tocOffset);
+	const uint64_t namesSize = header.tocSize - recordsSize;
+	for (uint32_t i = 0; i < header.entryCount; ++i) {
+		const TocEntry& entry = toc[i];
+		const bool badData = entry.offset > size || entry.storedSize > size - entry.offset;
+		const bool badName = (uint64_t)entry.nameOffset + entry.nameLength > namesSize;
+		const bool badSize = entry.compression == COMPRESSION_NONE
+			? entry.storedSize != entry.size
+			: entry.compression != COMPRESSION_LZ4;
+		const bool unsorted = i > 0 && toc[i - 1].nameHash > entry.nameHash;
+		if (badData || badName || badSize || unsorted) {
+			ERROR("AssetArchive", "open", ("Corrupt table of contents in " + fileName).c_str());
+			close();
+			return E_FAIL;
+		}
+	}
+
+	m_toc = toc;
+	m_names = reinterpret_cast<const char*>(data + header.tocOffset + recordsSize);
+	m_entryCount = header.entryCount;
+	return S_OK;
+}
+
+void
+AssetArchive::close() {
+	m_file.close();
+	m_toc = nullptr;
+	m_names = nullptr;
+	m_entryCount = 0;
+}
+
+uint64_t
+AssetArchive::hashName(const std::string& name) {
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	for (char c : name) {
+		hash ^= (uint8_t)(c == '\\' ? '/' : c);
+		hash *= 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+std::string
+AssetArchive::normalizeName(const std::string& name) {
+	std::string normalized = name;
+	for (char& c : normalized) {
+		if (c == '\\')
+			c = '/';
+	}
+	return normalized;
+}
+
+// Búsqueda binaria por hash; entre hashes iguales se compara el nombre.
+const AssetArchive::TocEntry*
+AssetArchive::find(const std::string& name) const {
+	if (!m_toc)
+		return nullptr;
+	const uint64_t hash = hashName(name);
+	unsigned int low = 0, high = m_entryCount;
+	while (low < high) {
+		const unsigned int middle = (low + high) / 2;
+		if (m_toc[middle].nameHash < hash)
+			low = middle + 1;
+		else
+			high = middle;
+	}
+
+	const std::string normalized = normalizeName(name);
+	for (unsigned int i = low; i < m_entryCount && m_toc[i].nameHash == hash; ++i) {
+		const TocEntry& entry = m_toc[i];
+		if (entry.nameLength == normalized.size() &&
+			std::memcmp(m_names + entry.nameOffset, normalized.data(), normalized.size()) == 0)
+			return &entry;
+	}
+	return nullptr;
+}
+
+bool
+AssetArchive::contains(const std::string& name) const {
+	return find(name) != nullptr;
+}
+
+const uint8_t*
+AssetArchive::view(const std::string& name, size_t& size) const {
+	const TocEntry* entry = find(name);
+	if (!entry || entry->compression != COMPRESSION_NONE)
+		return nullptr;
+	size = (size_t)entry->size;
+	return m_file.data() + entry->offset;
+}
+
+HRESULT
+AssetArchive::read(const std::string& name, std::vector<uint8_t>& data) const {
+	const TocEntry* entry = find(name);
+	if (!entry) {
+		ERROR("AssetArchive", "read", ("Entry not found: " + name).c_str());
+		return E_FAIL;
+	}
+
+	const uint8_t* stored = m_file.data() + entry->offset;
+	data.resize((size_t)entry->size);
+	if (entry->compression == COMPRESSION_NONE) {
+		if (!data.empty())
+			std::memcpy(data.data(), stored, data.size());
+		return S_OK;
+	}
+	if (!LZ4Codec::decompress(stored, (size_t)entry->storedSize, data.data(), data.size())) {
+		ERROR("AssetArchive", "read", ("Corrupt compressed entry " + name).c_str());
+		data.clear();
+		return E_FAIL;
+	}
+	return S_OK;
+}
@@ -20,9 +20,13 @@ BaseApp::init() {
  *
  * Este mtodo debe ser sobrescrito por las clases derivadas para implementar la lgica de actualizacin
  * de la aplicacin, como la entrada del usuario, la fsica o la lgica de juego.
+ * Corre en el hilo de simulacin y solo debe escribir en los datos del hueco frameSlot.
+ *
+ * @param frameSlot Hueco de datos del frame que se est simulando.
  */
 void
-BaseApp::update() {
+BaseApp::update(unsigned int frameSlot) {
+	UNREFERENCED_PARAMETER(frameSlot);
 	// Lgica de actualizacin de la aplicacin.
 	// Debe ser implementada en clases derivadas.
 }
@@ -32,9 +36,13 @@ BaseApp::update() {
  *
  * Este mtodo debe ser sobrescrito por las clases derivadas para implementar el proceso de renderizacin
  * de la escena, que puede incluir la configuracin de las vistas, la presentacin de objetos, etc.
+ * Lee los datos que update() dej en el hueco frameSlot.
+ *
+ * @param frameSlot Hueco de datos del frame que se est dibujando.
  */
 void
-BaseApp::render() {
+BaseApp::render(unsigned int frameSlot) {
+	UNREFERENCED_PARAMETER(frameSlot);
 	// Lgica de renderizacin de la aplicacin.
 	// Debe ser implementada en clases derivadas.
 }
@@ -55,7 +63,8 @@ BaseApp::destroy() {
  * @brief Ejecuta el bucle principal de la aplicacin.
  *
  * Este mtodo maneja el ciclo de vida de la aplicacin, gestionando los mensajes de la ventana y ejecutando
- * las funciones de actualizacin y renderizacin en el bucle principal.
+ * las funciones de actualizacin y renderizacin en el bucle principal. La actualizacin del frame
+ * siguiente corre en el hilo de simulacin mientras aqu se renderiza el actual.
  *
  * @param hInstance Identificador de la instancia de la aplicacin.
  * @param hPrevInstance Identificador de la instancia anterior (no utilizado).
@@ -80,6 +89,14 @@ BaseApp::run(HINSTANCE hInstance,
 		return 0;
 	}
 
+	// Arranca el hilo de simulacin.
+	if (FAILED(m_framePipeline.init(m_framesInFlight, [](void* app, unsigned int frameSlot) {
+			static_cast<BaseApp*>(app)->update(frameSlot);
+		}, this))) {
+		destroy();
+		return 0;
+	}
+
 	// Bucle principal de mensajes y ejecucin de la aplicacin.
 	MSG msg = { 0 };
 	while (WM_QUIT != msg.message) {
@@ -89,13 +106,15 @@ BaseApp::run(HINSTANCE hInstance,
 			DispatchMessage(&msg);
 		}
 		else {
-			// Actualiza la lgica de la aplicacin y renderiza el contenido.
-			update();
-			render();
+			// Renderiza el frame ya simulado mientras se simula el siguiente.
+			const unsigned int frameSlot = m_framePipeline.beginRender();
+			render(frameSlot);
+			m_framePipeline.endRender();
 		}
 	}
 
-	// Limpieza de recursos antes de salir.
+	// Limpieza de recursos antes de salir (primero se para la simulacin).
+	m_framePipeline.destroy();
 	destroy();
 
 	// Devuelve el cdigo de salida de la aplicacin.
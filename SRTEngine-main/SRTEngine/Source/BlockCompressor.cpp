@@ -0,0 +1,1276 @@
+#include "BlockCompressor.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+
+#if defined(SRT_SIMD_AVX2)
+#include <immintrin.h>
+#elif defined(SRT_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+	// Un bloque 4x4 con los canales separados (16 valores seguidos por canal) para SIMD.
+	struct BlockPixels {
+		float c[4][16];
+	};
+
+	// Pesos de interpolación de BC7 (sobre 64) para índices de 2, 3 y 4 bits.
+	const int BC7_WEIGHTS2[4] = { 0, 21, 43, 64 };
+	const int BC7_WEIGHTS3[8] = { 0, 9, 18, 27, 37, 46, 55, 64 };
+	const int BC7_WEIGHTS4[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+	// Particiones de 2 subconjuntos de BC7: el bit i indica que el píxel i va al subconjunto 1.
+	const uint16_t BC7_PARTITIONS2[64] = {
+		0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80,
+		0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8, 0xFF00, 0xFFF0, 0xF000,
+		0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE,
+		0x088C, 0x3110, 0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C,
+		0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696, 0xA55A,
+		0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660,
+		0x0272, 0x04E4, 0x4E40, 0x2720, 0xC936, 0x936C, 0x39C6, 0x639C,
+		0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22
+	};
+
+	// Píxel ancla del subconjunto 1 en cada partición (el del subconjunto 0 es siempre el 0).
+	const uint8_t BC7_ANCHORS2[64] = {
+		15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15,
+		15,  2,  8,  2,  2,  8,  8, 15,  2,  8,  2,  2,  8,  8,  2,  2,
+		15, 15,  6,  8,  2,  8, 15, 15,  2,  8,  2,  2,  2, 15, 15,  6,
+		 6,  2,  6,  8, 15, 15,  2,  2, 15, 15, 15, 15, 15,  2,  2, 15
+	};
+
+	// Particiones de 2 subconjuntos que se prueban a fondo en el modo 1.
+	const unsigned int MODE1_CANDIDATES = 4;
+
+	// Formato de cada modo BC7: subconjuntos, bits de partición, rotación, selector de
+	// índices, color, alfa, p-bit por extremo, p-bit compartido e índices primarios/secundarios.
+	struct BC7Mode {
+		int subsets, partitionBits, rotationBits, indexSelectionBits;
+		int colorBits, alphaBits, endpointPBits, sharedPBits, indexBits, index2Bits;
+	};
+	const BC7Mode BC7_MODES[8] = {
+		{ 3, 4, 0, 0, 4, 0, 1, 0, 3, 0 },
+		{ 2, 6, 0, 0, 6, 0, 0, 1, 3, 0 },
+		{ 3, 6, 0, 0, 5, 0, 0, 0, 2, 0 },
+		{ 2, 6, 0, 0, 7, 0, 1, 0, 2, 0 },
+		{ 1, 0, 2, 1, 5, 6, 0, 0, 2, 3 },
+		{ 1, 0, 2, 0, 7, 8, 0, 0, 2, 2 },
+		{ 1, 0, 0, 0, 7, 7, 1, 0, 4, 0 },
+		{ 2, 6, 0, 0, 5, 5, 1, 0, 2, 0 }
+	};
+
+	// Escribe campos de bits desde el bit menos significativo (la salida debe estar a cero).
+	struct BitWriter {
+		uint8_t* out;
+		unsigned int pos;
+
+		void put(uint32_t value, unsigned int bits) {
+			for (unsigned int i = 0; i < bits; ++i, ++pos) {
+				if ((value >> i) & 1)
+					out[pos >> 3] |= (uint8_t)(1u << (pos & 7));
+			}
+		}
+	};
+
+	struct BitReader {
+		const uint8_t* in;
+		unsigned int pos;
+
+		uint32_t get(unsigned int bits) {
+			uint32_t value = 0;
+			for (unsigned int i = 0; i < bits; ++i, ++pos)
+				value |= (uint32_t)((in[pos >> 3] >> (pos & 7)) & 1) << i;
+			return value;
+		}
+	};
+
+	void parallelRows(unsigned int count, unsigned int threadCount,
+		const std::function<void(unsigned int, unsigned int)>& job) {
+		threadCount = std::max(1u, std::min(threadCount, count));
+		if (threadCount == 1) {
+			job(0, count);
+			return;
+		}
+		std::vector<std::thread> threads;
+		const unsigned int chunk = (count + threadCount - 1) / threadCount;
+		for (unsigned int t = 1; t < threadCount; ++t) {
+			const unsigned int begin = std::min(count, t * chunk);
+			const unsigned int end = std::min(count, begin + chunk);
+			threads.emplace_back(job, begin, end);
+		}
+		job(0, std::min(count, chunk));
+		for (std::thread& thread : threads)
+			thread.join();
+	}
+
+	// Copia un bloque repitiendo la última fila/columna en los bordes.
+	void loadBlock(const uint8_t* pixels, unsigned int width, unsigned int height,
+		unsigned int bx, unsigned int by, BlockPixels& block) {
+		for (unsigned int y = 0; y < 4; ++y) {
+			const unsigned int sy = std::min(by * 4 + y, height - 1);
+			for (unsigned int x = 0; x < 4; ++x) {
+				const unsigned int sx = std::min(bx * 4 + x, width - 1);
+				const uint8_t* p = pixels + ((size_t)sy * width + sx) * 4;
+				for (int c = 0; c < 4; ++c)
+					block.c[c][y * 4 + x] = p[c];
+			}
+		}
+	}
+
+	int clampInt(int value, int low, int high) {
+		return value < low ? low : (value > high ? high : value);
+	}
+
+	float clamp255(float value) {
+		return value < 0.0f ? 0.0f : (value > 255.0f ? 255.0f : value);
+	}
+
+	// Media y eje principal (iteración de potencia sobre la covarianza) de los píxeles de mask.
+	void principalAxis(const BlockPixels& block, int first, int count, uint16_t mask,
+		float mean[4], float axis[4]) {
+		int n = 0;
+		for (int k = 0; k < 4; ++k)
+			mean[k] = 0.0f;
+		for (int i = 0; i < 16; ++i) {
+			if (!((mask >> i) & 1))
+				continue;
+			for (int k = 0; k < count; ++k)
+				mean[k] += block.c[first + k][i];
+			++n;
+		}
+		if (n == 0)
+			n = 1;
+		for (int k = 0; k < count; ++k)
+			mean[k] /= n;
+
+		float cov[4][4] = {};
+		for (int i = 0; i < 16; ++i) {
+			if (!((mask >> i) & 1))
+				continue;
+			float d[4];
+			for (int k = 0; k < count; ++k)
+				d[k] = block.c[first + k][i] - mean[k];
+			for (int a = 0; a < count; ++a)
+				for (int b = a; b < count; ++b)
+					cov[a][b] += d[a] * d[b];
+		}
+		for (int a = 0; a < count; ++a)
+			for (int b = 0; b < a; ++b)
+				cov[a][b] = cov[b][a];
+
+		// Empieza por la columna de mayor varianza para no arrancar ortogonal al eje.
+		int start = 0;
+		for (int k = 1; k < count; ++k) {
+			if (cov[k][k] > cov[start][start])
+				start = k;
+		}
+		for (int k = 0; k < count; ++k)
+			axis[k] = cov[k][start];
+
+		for (int iteration = 0; iteration < 8; ++iteration) {
+			float next[4] = {};
+			float length = 0.0f;
+			for (int a = 0; a < count; ++a) {
+				for (int b = 0; b < count; ++b)
+					next[a] += cov[a][b] * axis[b];
+				length += next[a] * next[a];
+			}
+			if (length < 1e-12f)
+				break;
+			length = 1.0f / std::sqrt(length);
+			for (int k = 0; k < count; ++k)
+				axis[k] = next[k] * length;
+		}
+
+		float length = 0.0f;
+		for (int k = 0; k < count; ++k)
+			length += axis[k] * axis[k];
+		if (length < 1e-12f) {
+			for (int k = 0; k < count; ++k)
+				axis[k] = 1.0f;
+			length = (float)count;
+		}
+		length = 1.0f / std::sqrt(length);
+		for (int k = 0; k < count; ++k)
+			axis[k] *= length;
+	}
+
+	// Extremos de la proyección de los píxeles de mask sobre el eje, acercados inset * rango.
+	void axisExtremes(const BlockPixels& block, int first, int count, uint16_t mask,
+		const float mean[4], const float axis[4], float inset, float e0[4], float e1[4]) {
+		float low = 0.0f, high = 0.0f;
+		bool any = false;
+		for (int i = 0; i < 16; ++i) {
+			if (!((mask >> i) & 1))
+				continue;
+			float t = 0.0f;
+			for (int k = 0; k < count; ++k)
+				t += (block.c[first + k][i] - mean[k]) * axis[k];
+			low = any ? std::min(low, t) : t;
+			high = any ? std::max(high, t) : t;
+			any = true;
+		}
+		const float shrink = (high - low) * inset;
+		low += shrink;
+		high -= shrink;
+		for (int k = 0; k < count; ++k) {
+			e0[k] = clamp255(mean[k] + axis[k] * low);
+			e1[k] = clamp255(mean[k] + axis[k] * high);
+		}
+	}
+
+	// Mínimos cuadrados de los extremos dado el peso (0..1) de cada píxel de mask.
+	bool fitEndpoints(const BlockPixels& block, int first, int count, uint16_t mask,
+		const float weight[16], float e0[4], float e1[4]) {
+		float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+		float x[4] = {}, y[4] = {};
+		for (int i = 0; i < 16; ++i) {
+			if (!((mask >> i) & 1))
+				continue;
+			const float w = weight[i];
+			const float v = 1.0f - w;
+			aa += v * v;
+			ab += v * w;
+			bb += w * w;
+			for (int k = 0; k < count; ++k) {
+				x[k] += v * block.c[first + k][i];
+				y[k] += w * block.c[first + k][i];
+			}
+		}
+		const float det = aa * bb - ab * ab;
+		if (std::fabs(det) < 1e-6f)
+			return false;
+		const float inv = 1.0f / det;
+		for (int k = 0; k < count; ++k) {
+			e0[k] = clamp255((bb * x[k] - ab * y[k]) * inv);
+			e1[k] = clamp255((aa * y[k] - ab * x[k]) * inv);
+		}
+		return true;
+	}
+
+	// Asigna a cada píxel de mask el nivel (0..levels-1) más cercano sobre la recta e0 -> e1.
+	// Los niveles de la paleta son colineales, así que basta con proyectar y redondear;
+	// weights (0..1, crecientes) corrige el redondeo cuando los niveles no son uniformes.
+	void projectIndices(const BlockPixels& block, int first, int count, uint16_t mask,
+		const float e0[4], const float e1[4], const float* weights, int levels,
+		uint8_t indices[16], bool useSimd) {
+		float d[4] = {};
+		float length = 0.0f;
+		for (int k = 0; k < count; ++k) {
+			d[k] = e1[k] - e0[k];
+			length += d[k] * d[k];
+		}
+		if (length < 1e-6f) {
+			for (int i = 0; i < 16; ++i) {
+				if ((mask >> i) & 1)
+					indices[i] = 0;
+			}
+			return;
+		}
+		const float scale = (levels - 1) / length;
+
+		float t[16];
+#if defined(SRT_SIMD_SSE2)
+		if (useSimd) {
+			const __m128 vscale = _mm_set1_ps(scale);
+			for (int i = 0; i < 16; i += 4) {
+				__m128 acc = _mm_setzero_ps();
+				for (int k = 0; k < count; ++k) {
+					const __m128 diff = _mm_sub_ps(_mm_loadu_ps(&block.c[first + k][i]), _mm_set1_ps(e0[k]));
+					acc = _mm_add_ps(acc, _mm_mul_ps(diff, _mm_set1_ps(d[k])));
+				}
+				_mm_storeu_ps(t + i, _mm_mul_ps(acc, vscale));
+			}
+		}
+		else
+#endif
+		{
+			(void)useSimd;
+			for (int i = 0; i < 16; ++i) {
+				float acc = 0.0f;
+				for (int k = 0; k < count; ++k)
+					acc = acc + (block.c[first + k][i] - e0[k]) * d[k];
+				t[i] = acc * scale;
+			}
+		}
+
+		for (int i = 0; i < 16; ++i) {
+			if (!((mask >> i) & 1))
+				continue;
+			int level = std::min((int)(std::max(t[i], 0.0f) + 0.5f), levels - 1);
+			const float target = t[i] / (levels - 1);
+			if (level > 0 && std::fabs(target - weights[level - 1]) < std::fabs(target - weights[level]))
+				--level;
+			else if (level < levels - 1 && std::fabs(target - weights[level + 1]) < std::fabs(target - weights[level]))
+				++level;
+			indices[i] = (uint8_t)level;
+		}
+	}
+
+	// ---------------------------------------------------------------- BC1
+
+	const float BC1_LEVELS4[4] = { 0.0f, 1.0f / 3.0f, 2.0f / 3.0f, 1.0f };
+	const float BC1_LEVELS3[3] = { 0.0f, 0.5f, 1.0f };
+	const uint8_t BC1_ORDER4[4] = { 0, 2, 3, 1 };  // Nivel sobre la recta -> índice de la paleta.
+	const uint8_t BC1_ORDER3[3] = { 0, 2, 1 };
+	const float BC1_WEIGHT4[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f }; // Índice -> peso.
+	const float BC1_WEIGHT3[4] = { 0.0f, 1.0f, 0.5f, 0.0f };
+
+	uint16_t to565(const float color[3]) {
+		const int r = clampInt((int)(color[0] * (31.0f / 255.0f) + 0.5f), 0, 31);
+		const int g = clampInt((int)(color[1] * (63.0f / 255.0f) + 0.5f), 0, 63);
+		const int b = clampInt((int)(color[2] * (31.0f / 255.0f) + 0.5f), 0, 31);
+		return (uint16_t)((r << 11) | (g << 5) | b);
+	}
+
+	void from565(uint16_t value, int color[4]) {
+		const int r = (value >> 11) & 31;
+		const int g = (value >> 5) & 63;
+		const int b = value & 31;
+		color[0] = (r << 3) | (r >> 2);
+		color[1] = (g << 2) | (g >> 4);
+		color[2] = (b << 3) | (b >> 2);
+		color[3] = 255;
+	}
+
+	// Paleta de un bloque BC1; forceFourColors es el comportamiento del bloque de color de BC3.
+	void bc1Palette(uint16_t c0, uint16_t c1, bool forceFourColors, int palette[4][4]) {
+		from565(c0, palette[0]);
+		from565(c1, palette[1]);
+		if (forceFourColors || c0 > c1) {
+			for (int k = 0; k < 3; ++k) {
+				palette[2][k] = (2 * palette[0][k] + palette[1][k]) / 3;
+				palette[3][k] = (palette[0][k] + 2 * palette[1][k]) / 3;
+			}
+			palette[2][3] = palette[3][3] = 255;
+		}
+		else {
+			for (int k = 0; k < 3; ++k) {
+				palette[2][k] = (palette[0][k] + palette[1][k]) / 2;
+				palette[3][k] = 0;
+			}
+			palette[2][3] = 255;
+			palette[3][3] = 0;
+		}
+	}
+
+	struct BC1Candidate {
+		uint16_t c0 = 0, c1 = 0;
+		bool threeColors = false;
+		uint8_t indices[16] = {};
+		float error = 1e30f;
+	};
+
+	// Índices y error de unos extremos ya cuantizados. Los píxeles fuera de opaque usan el índice 3 (transparente).
+	void bc1Evaluate(const BlockPixels& block, uint16_t q0, uint16_t q1, bool threeColors,
+		uint16_t opaque, bool forceFourColors, bool useSimd, BC1Candidate& candidate) {
+		if (threeColors ? q0 > q1 : q0 < q1)
+			std::swap(q0, q1);
+		candidate.c0 = q0;
+		candidate.c1 = q1;
+		candidate.threeColors = threeColors;
+
+		int palette[4][4];
+		bc1Palette(q0, q1, forceFourColors, palette);
+		const bool fourColors = forceFourColors || q0 > q1;
+		const float e0[4] = { (float)palette[0][0], (float)palette[0][1], (float)palette[0][2], 0.0f };
+		const float e1[4] = { (float)palette[1][0], (float)palette[1][1], (float)palette[1][2], 0.0f };
+
+		uint8_t levels[16] = {};
+		if (fourColors) {
+			projectIndices(block, 0, 3, opaque, e0, e1, BC1_LEVELS4, 4, levels, useSimd);
+			for (int i = 0; i < 16; ++i)
+				candidate.indices[i] = BC1_ORDER4[levels[i]];
+		}
+		else if (threeColors) {
+			projectIndices(block, 0, 3, opaque, e0, e1, BC1_LEVELS3, 3, levels, useSimd);
+			for (int i = 0; i < 16; ++i)
+				candidate.indices[i] = ((opaque >> i) & 1) ? BC1_ORDER3[levels[i]] : 3;
+		}
+		else {
+			// Extremos iguales en un bloque opaco: todos los píxeles usan c0.
+			for (int i = 0; i < 16; ++i)
+				candidate.indices[i] = 0;
+		}
+
+		float error = 0.0f;
+		for (int i = 0; i < 16; ++i) {
+			if (!((opaque >> i) & 1))
+				continue;
+			const int* color = palette[candidate.indices[i]];
+			for (int k = 0; k < 3; ++k) {
+				const float diff = color[k] - block.c[k][i];
+				error += diff * diff;
+			}
+		}
+		candidate.error = error;
+	}
+
+	// Refina por mínimos cuadrados desde los índices de best mientras mejore.
+	void bc1Refine(const BlockPixels& block, uint16_t opaque, bool forceFourColors,
+		int iterations, bool useSimd, BC1Candidate& best) {
+		for (int iteration = 0; iteration < iterations; ++iteration) {
+			const float* table = best.threeColors ? BC1_WEIGHT3 : BC1_WEIGHT4;
+			float weight[16];
+			for (int i = 0; i < 16; ++i)
+				weight[i] = table[best.indices[i]];
+			float e0[4], e1[4];
+			if (!fitEndpoints(block, 0, 3, opaque, weight, e0, e1))
+				return;
+			BC1Candidate candidate;
+			bc1Evaluate(block, to565(e0), to565(e1), best.threeColors, opaque, forceFourColors, useSimd, candidate);
+			if (candidate.error >= best.error)
+				return;
+			best = candidate;
+		}
+	}
+
+	// Prueba a mover cada componente 565 de los extremos en +-1 hasta que nada mejore.
+	void bc1LocalSearch(const BlockPixels& block, uint16_t opaque, bool forceFourColors,
+		bool useSimd, BC1Candidate& best) {
+		const int shifts[3] = { 11, 5, 0 };
+		const int limits[3] = { 31, 63, 31 };
+		for (int pass = 0; pass < 8; ++pass) {
+			bool improved = false;
+			for (int endpoint = 0; endpoint < 2; ++endpoint) {
+				for (int k = 0; k < 3; ++k) {
+					for (int delta = -1; delta <= 1; delta += 2) {
+						uint16_t q[2] = { best.c0, best.c1 };
+						const int value = ((q[endpoint] >> shifts[k]) & limits[k]) + delta;
+						if (value < 0 || value > limits[k])
+							continue;
+						q[endpoint] = (uint16_t)((q[endpoint] & ~(limits[k] << shifts[k])) | (value << shifts[k]));
+						BC1Candidate candidate;
+						bc1Evaluate(block, q[0], q[1], best.threeColors, opaque, forceFourColors, useSimd, candidate);
+						if (candidate.error < best.error) {
+							best = candidate;
+							improved = true;
+						}
+					}
+				}
+			}
+			if (!improved)
+				break;
+		}
+	}
+
+	// Codifica el color de un bloque (8 bytes). allowTransparent activa el alfa de 1 bit de BC1.
+	void encodeBC1(const BlockPixels& block, BCQuality quality, bool allowTransparent,
+		bool useSimd, uint8_t* out) {
+		uint16_t opaque = 0xFFFF;
+		if (allowTransparent) {
+			for (int i = 0; i < 16; ++i) {
+				if (block.c[3][i] < 128.0f)
+					opaque &= (uint16_t)~(1u << i);
+			}
+		}
+		const bool forceFourColors = !allowTransparent;
+
+		BC1Candidate best;
+		if (opaque == 0) {
+			// Todo transparente: extremos a cero y todos los índices a 3.
+			best.threeColors = true;
+			for (int i = 0; i < 16; ++i)
+				best.indices[i] = 3;
+		}
+		else {
+			float mean[4], axis[4], e0[4], e1[4];
+			principalAxis(block, 0, 3, opaque, mean, axis);
+			axisExtremes(block, 0, 3, opaque, mean, axis, 1.0f / 16.0f, e0, e1);
+
+			const bool mustUseThree = opaque != 0xFFFF;
+			bc1Evaluate(block, to565(e0), to565(e1), mustUseThree, opaque, forceFourColors, useSimd, best);
+			if (quality >= BC_QUALITY_NORMAL)
+				bc1Refine(block, opaque, forceFourColors, quality == BC_QUALITY_SLOW ? 8 : 2, useSimd, best);
+
+			if (quality == BC_QUALITY_SLOW) {
+				// En bloques opacos el modo de 3 colores a veces ajusta mejor dos grupos de color.
+				if (!mustUseThree && allowTransparent) {
+					BC1Candidate three;
+					axisExtremes(block, 0, 3, opaque, mean, axis, 0.0f, e0, e1);
+					bc1Evaluate(block, to565(e0), to565(e1), true, opaque, false, useSimd, three);
+					bc1Refine(block, opaque, false, 8, useSimd, three);
+					if (three.error < best.error)
+						best = three;
+				}
+				bc1LocalSearch(block, opaque, forceFourColors, useSimd, best);
+			}
+		}
+
+		uint32_t bits = 0;
+		for (int i = 0; i < 16; ++i)
+			bits |= (uint32_t)best.indices[i] << (i * 2);
+		out[0] = (uint8_t)(best.c0 & 0xFF);
+		out[1] = (uint8_t)(best.c0 >> 8);
+		out[2] = (uint8_t)(best.c1 & 0xFF);
+		out[3] = (uint8_t)(best.c1 >> 8);
+		for (int k = 0; k < 4; ++k)
+			out[4 + k] = (uint8_t)(bits >> (k * 8));
+	}
+
+	void decodeBC1(const uint8_t* in, bool forceFourColors, uint8_t* out, size_t rowPitch,
+		unsigned int columns, unsigned int rows) {
+		const uint16_t c0 = (uint16_t)(in[0] | (in[1] << 8));
+		const uint16_t c1 = (uint16_t)(in[2] | (in[3] << 8));
+		const uint32_t bits = (uint32_t)in[4] | ((uint32_t)in[5] << 8) | ((uint32_t)in[6] << 16) | ((uint32_t)in[7] << 24);
+		int palette[4][4];
+		bc1Palette(c0, c1, forceFourColors, palette);
+		for (unsigned int y = 0; y < rows; ++y) {
+			for (unsigned int x = 0; x < columns; ++x) {
+				const int* color = palette[(bits >> ((y * 4 + x) * 2)) & 3];
+				uint8_t* pixel = out + y * rowPitch + x * 4;
+				for (int k = 0; k < 4; ++k)
+					pixel[k] = (uint8_t)color[k];
+			}
+		}
+	}
+
+	// ---------------------------------------------------------------- BC4
+
+	void bc4Palette(int e0, int e1, int palette[8]) {
+		palette[0] = e0;
+		palette[1] = e1;
+		if (e0 > e1) {
+			for (int i = 1; i < 7; ++i)
+				palette[i + 1] = ((7 - i) * e0 + i * e1 + 3) / 7;
+		}
+		else {
+			for (int i = 1; i < 5; ++i)
+				palette[i + 1] = ((5 - i) * e0 + i * e1 + 2) / 5;
+			palette[6] = 0;
+			palette[7] = 255;
+		}
+	}
+
+	struct BC4Candidate {
+		int e0 = 0, e1 = 0;
+		uint8_t indices[16] = {};
+		int error = 0x7FFFFFFF;
+	};
+
+	// Índice de la paleta más cercano a cada valor (8 entradas: se recorren todas).
+	void bc4Evaluate(const int values[16], int e0, int e1, BC4Candidate& candidate) {
+		int palette[8];
+		bc4Palette(e0, e1, palette);
+		candidate.e0 = e0;
+		candidate.e1 = e1;
+		int error = 0;
+		for (int i = 0; i < 16; ++i) {
+			int bestIndex = 0;
+			int bestError = 0x7FFFFFFF;
+			for (int k = 0; k < 8; ++k) {
+				const int diff = palette[k] - values[i];
+				if (diff * diff < bestError) {
+					bestError = diff * diff;
+					bestIndex = k;
+				}
+			}
+			candidate.indices[i] = (uint8_t)bestIndex;
+			error += bestError;
+		}
+		candidate.error = error;
+	}
+
+	// Mueve cada extremo en +-1 respetando el orden que define el modo.
+	void bc4LocalSearch(const int values[16], bool eightValues, BC4Candidate& best) {
+		for (int pass = 0; pass < 16 && best.error > 0; ++pass) {
+			bool improved = false;
+			for (int endpoint = 0; endpoint < 2; ++endpoint) {
+				for (int delta = -1; delta <= 1; delta += 2) {
+					int e[2] = { best.e0, best.e1 };
+					e[endpoint] += delta;
+					if (e[endpoint] < 0 || e[endpoint] > 255 || (eightValues ? e[0] <= e[1] : e[0] > e[1]))
+						continue;
+					BC4Candidate candidate;
+					bc4Evaluate(values, e[0], e[1], candidate);
+					if (candidate.error < best.error) {
+						best = candidate;
+						improved = true;
+					}
+				}
+			}
+			if (!improved)
+				break;
+		}
+	}
+
+	// Codifica un canal del bloque (8 bytes).
+	void encodeBC4(const float channel[16], BCQuality quality, uint8_t* out) {
+		int values[16];
+		int low = 255, high = 0;
+		int innerLow = 255, innerHigh = 0;
+		for (int i = 0; i < 16; ++i) {
+			values[i] = (int)channel[i];
+			low = std::min(low, values[i]);
+			high = std::max(high, values[i]);
+			if (values[i] != 0 && values[i] != 255) {
+				innerLow = std::min(innerLow, values[i]);
+				innerHigh = std::max(innerHigh, values[i]);
+			}
+		}
+
+		// Modo de 8 valores (e0 > e1) entre el mínimo y el máximo.
+		BC4Candidate best;
+		bc4Evaluate(values, high, low, best);
+
+		if (quality >= BC_QUALITY_NORMAL && best.error > 0) {
+			if (quality == BC_QUALITY_SLOW && high > low)
+				bc4LocalSearch(values, true, best);
+
+			// Modo de 6 valores (e0 <= e1) con 0 y 255 exactos: gana si hay valores extremos sueltos.
+			if (innerLow > innerHigh) {
+				innerLow = innerHigh = low;
+			}
+			BC4Candidate six;
+			bc4Evaluate(values, innerLow, innerHigh, six);
+			if (quality == BC_QUALITY_SLOW)
+				bc4LocalSearch(values, false, six);
+			if (six.error < best.error)
+				best = six;
+		}
+
+		out[0] = (uint8_t)best.e0;
+		out[1] = (uint8_t)best.e1;
+		uint64_t bits = 0;
+		for (int i = 0; i < 16; ++i)
+			bits |= (uint64_t)best.indices[i] << (i * 3);
+		for (int k = 0; k < 6; ++k)
+			out[2 + k] = (uint8_t)(bits >> (k * 8));
+	}
+
+	void decodeBC4(const uint8_t* in, uint8_t* out, size_t rowPitch, int channel,
+		unsigned int columns, unsigned int rows) {
+		int palette[8];
+		bc4Palette(in[0], in[1], palette);
+		uint64_t bits = 0;
+		for (int k = 0; k < 6; ++k)
+			bits |= (uint64_t)in[2 + k] << (k * 8);
+		for (unsigned int y = 0; y < rows; ++y) {
+			for (unsigned int x = 0; x < columns; ++x)
+				out[y * rowPitch + x * 4 + channel] = (uint8_t)palette[(bits >> ((y * 4 + x) * 3)) & 7];
+		}
+	}
+
+	// ---------------------------------------------------------------- BC7
+
+	int bc7Interpolate(int e0, int e1, int weight) {
+		return ((64 - weight) * e0 + weight * e1 + 32) >> 6;
+	}
+
+	void normalizedWeights(const int* weights, int count, float* out) {
+		for (int i = 0; i < count; ++i)
+			out[i] = weights[i] / 64.0f;
+	}
+
+	// Modo 6: un subconjunto RGBA, extremos de 7 bits + p-bit por extremo, índices de 4 bits.
+	struct Mode6Candidate {
+		int q[2][4] = {};
+		int p[2] = {};
+		uint8_t indices[16] = {};
+		float error = 1e30f;
+	};
+
+	void mode6Evaluate(const BlockPixels& block, const int q[2][4], const int p[2], bool useSimd,
+		Mode6Candidate& candidate) {
+		static const float* levels = []() {
+			static float table[16];
+			normalizedWeights(BC7_WEIGHTS4, 16, table);
+			return table;
+		}();
+
+		int decoded[2][4];
+		float e0[4], e1[4];
+		for (int k = 0; k < 4; ++k) {
+			decoded[0][k] = (q[0][k] << 1) | p[0];
+			decoded[1][k] = (q[1][k] << 1) | p[1];
+			e0[k] = (float)decoded[0][k];
+			e1[k] = (float)decoded[1][k];
+		}
+		projectIndices(block, 0, 4, 0xFFFF, e0, e1, levels, 16, candidate.indices, useSimd);
+
+		float error = 0.0f;
+		for (int i = 0; i < 16; ++i) {
+			const int weight = BC7_WEIGHTS4[candidate.indices[i]];
+			for (int k = 0; k < 4; ++k) {
+				const float diff = bc7Interpolate(decoded[0][k], decoded[1][k], weight) - block.c[k][i];
+				error += diff * diff;
+			}
+		}
+		std::memcpy(candidate.q, q, sizeof(candidate.q));
+		candidate.p[0] = p[0];
+		candidate.p[1] = p[1];
+		candidate.error = error;
+	}
+
+	// Cuantiza un extremo a 7 bits con el p-bit dado; devuelve el error de cuantización.
+	float mode6Quantize(const float endpoint[4], int pbit, int q[4]) {
+		float error = 0.0f;
+		for (int k = 0; k < 4; ++k) {
+			q[k] = clampInt((int)((endpoint[k] - pbit) * 0.5f + 0.5f), 0, 127);
+			const float diff = (float)((q[k] << 1) | pbit) - endpoint[k];
+			error += diff * diff;
+		}
+		return error;
+	}
+
+	// Prueba los p-bits (el mejor por extremo, o las cuatro combinaciones si exhaustive).
+	void mode6Try(const BlockPixels& block, const float e0[4], const float e1[4], bool exhaustive,
+		bool useSimd, Mode6Candidate& best) {
+		int q[2][2][4];
+		float error[2][2];
+		for (int pbit = 0; pbit < 2; ++pbit) {
+			error[0][pbit] = mode6Quantize(e0, pbit, q[0][pbit]);
+			error[1][pbit] = mode6Quantize(e1, pbit, q[1][pbit]);
+		}
+		for (int p0 = 0; p0 < 2; ++p0) {
+			for (int p1 = 0; p1 < 2; ++p1) {
+				if (!exhaustive && (error[0][p0] > error[0][p0 ^ 1] || error[1][p1] > error[1][p1 ^ 1]))
+					continue;
+				const int quantized[2][4] = {
+					{ q[0][p0][0], q[0][p0][1], q[0][p0][2], q[0][p0][3] },
+					{ q[1][p1][0], q[1][p1][1], q[1][p1][2], q[1][p1][3] } };
+				const int pbits[2] = { p0, p1 };
+				Mode6Candidate candidate;
+				mode6Evaluate(block, quantized, pbits, useSimd, candidate);
+				if (candidate.error < best.error)
+					best = candidate;
+			}
+		}
+	}
+
+	void encodeMode6(const BlockPixels& block, BCQuality quality, bool useSimd, Mode6Candidate& best) {
+		float mean[4], axis[4], e0[4], e1[4];
+		principalAxis(block, 0, 4, 0xFFFF, mean, axis);
+		axisExtremes(block, 0, 4, 0xFFFF, mean, axis, 0.0f, e0, e1);
+
+		const bool exhaustive = quality == BC_QUALITY_SLOW;
+		mode6Try(block, e0, e1, exhaustive, useSimd, best);
+
+		const int iterations = quality == BC_QUALITY_FAST ? 0 : (quality == BC_QUALITY_NORMAL ? 2 : 4);
+		for (int iteration = 0; iteration < iterations && best.error > 0.0f; ++iteration) {
+			float weight[16];
+			for (int i = 0; i < 16; ++i)
+				weight[i] = BC7_WEIGHTS4[best.indices[i]] / 64.0f;
+			if (!fitEndpoints(block, 0, 4, 0xFFFF, weight, e0, e1))
+				break;
+			const float previous = best.error;
+			mode6Try(block, e0, e1, exhaustive, useSimd, best);
+			if (best.error >= previous)
+				break;
+		}
+	}
+
+	void writeMode6(Mode6Candidate block, uint8_t* out) {
+		// El índice del píxel 0 se guarda con 3 bits: su bit alto tiene que ser 0.
+		if (block.indices[0] >= 8) {
+			for (int k = 0; k < 4; ++k)
+				std::swap(block.q[0][k], block.q[1][k]);
+			std::swap(block.p[0], block.p[1]);
+			for (int i = 0; i < 16; ++i)
+				block.indices[i] = (uint8_t)(15 - block.indices[i]);
+		}
+
+		std::memset(out, 0, 16);
+		BitWriter writer = { out, 0 };
+		writer.put(1u << 6, 7);
+		for (int k = 0; k < 4; ++k) {
+			writer.put(block.q[0][k], 7);
+			writer.put(block.q[1][k], 7);
+		}
+		writer.put(block.p[0], 1);
+		writer.put(block.p[1], 1);
+		for (int i = 0; i < 16; ++i)
+			writer.put(block.indices[i], i == 0 ? 3 : 4);
+	}
+
+	// Modo 1: dos subconjuntos RGB, extremos de 6 bits + p-bit compartido, índices de 3 bits.
+	struct Mode1Subset {
+		int q[2][3] = {};
+		int p = 0;
+		float error = 1e30f;
+	};
+
+	int mode1Expand(int q, int pbit) {
+		const int value = (q << 1) | pbit;
+		return (value << 1) | (value >> 6);
+	}
+
+	void mode1Quantize(const float endpoint[4], int pbit, int q[3]) {
+		for (int k = 0; k < 3; ++k) {
+			const int guess = clampInt((int)((endpoint[k] - 2 * pbit) * 0.25f + 0.5f), 0, 63);
+			int best = guess;
+			float bestError = 1e30f;
+			for (int candidate = std::max(0, guess - 1); candidate <= std::min(63, guess + 1); ++candidate) {
+				const float diff = mode1Expand(candidate, pbit) - endpoint[k];
+				if (diff * diff < bestError) {
+					bestError = diff * diff;
+					best = candidate;
+				}
+			}
+			q[k] = best;
+		}
+	}
+
+	// Error de un subconjunto (RGB y el alfa fijo a 255) con sus índices en indices[].
+	float mode1Evaluate(const BlockPixels& block, uint16_t mask, const int q[2][3], int pbit,
+		bool useSimd, uint8_t indices[16]) {
+		static const float* levels = []() {
+			static float table[8];
+			normalizedWeights(BC7_WEIGHTS3, 8, table);
+			return table;
+		}();
+
+		int decoded[2][3];
+		float e0[4] = {}, e1[4] = {};
+		for (int k = 0; k < 3; ++k) {
+			decoded[0][k] = mode1Expand(q[0][k], pbit);
+			decoded[1][k] = mode1Expand(q[1][k], pbit);
+			e0[k] = (float)decoded[0][k];
+			e1[k] = (float)decoded[1][k];
+		}
+		projectIndices(block, 0, 3, mask, e0, e1, levels, 8, indices, useSimd);
+
+		float error = 0.0f;
+		for (int i = 0; i < 16; ++i) {
+			if (!((mask >> i) & 1))
+				continue;
+			const int weight = BC7_WEIGHTS3[indices[i]];
+			for (int k = 0; k < 3; ++k) {
+				const float diff = bc7Interpolate(decoded[0][k], decoded[1][k], weight) - block.c[k][i];
+				error += diff * diff;
+			}
+		}
+		return error;
+	}
+
+	float mode1FitSubset(const BlockPixels& block, uint16_t mask, bool useSimd,
+		Mode1Subset& best, uint8_t indices[16]) {
+		float mean[4], axis[4], e0[4], e1[4];
+		principalAxis(block, 0, 3, mask, mean, axis);
+		axisExtremes(block, 0, 3, mask, mean, axis, 0.0f, e0, e1);
+
+		for (int iteration = 0; iteration < 3; ++iteration) {
+			bool improved = false;
+			for (int pbit = 0; pbit < 2; ++pbit) {
+				Mode1Subset candidate;
+				uint8_t candidateIndices[16];
+				mode1Quantize(e0, pbit, candidate.q[0]);
+				mode1Quantize(e1, pbit, candidate.q[1]);
+				candidate.p = pbit;
+				candidate.error = mode1Evaluate(block, mask, candidate.q, pbit, useSimd, candidateIndices);
+				if (candidate.error < best.error) {
+					best = candidate;
+					for (int i = 0; i < 16; ++i) {
+						if ((mask >> i) & 1)
+							indices[i] = candidateIndices[i];
+					}
+					improved = true;
+				}
+			}
+			if (!improved || best.error == 0.0f)
+				break;
+
+			float weight[16];
+			for (int i = 0; i < 16; ++i)
+				weight[i] = BC7_WEIGHTS3[indices[i]] / 64.0f;
+			if (!fitEndpoints(block, 0, 3, mask, weight, e0, e1))
+				break;
+		}
+		return best.error;
+	}
+
+	// Error estimado de una partición: varianza que queda fuera del eje principal de cada subconjunto.
+	float partitionEstimate(const BlockPixels& block, uint16_t partition) {
+		float total = 0.0f;
+		for (int subset = 0; subset < 2; ++subset) {
+			const uint16_t mask = subset ? partition : (uint16_t)~partition;
+			float mean[4], axis[4];
+			principalAxis(block, 0, 3, mask, mean, axis);
+			for (int i = 0; i < 16; ++i) {
+				if (!((mask >> i) & 1))
+					continue;
+				float length = 0.0f, along = 0.0f;
+				for (int k = 0; k < 3; ++k) {
+					const float d = block.c[k][i] - mean[k];
+					length += d * d;
+					along += d * axis[k];
+				}
+				total += length - along * along;
+			}
+		}
+		return total;
+	}
+
+	// Devuelve el error del mejor modo 1 y lo escribe en out.
+	float encodeMode1(const BlockPixels& block, bool useSimd, uint8_t* out) {
+		std::pair<float, int> order[64];
+		for (int i = 0; i < 64; ++i)
+			order[i] = std::make_pair(partitionEstimate(block, BC7_PARTITIONS2[i]), i);
+		std::partial_sort(order, order + MODE1_CANDIDATES, order + 64);
+
+		float bestError = 1e30f;
+		int bestPartition = 0;
+		Mode1Subset bestSubsets[2];
+		uint8_t bestIndices[16] = {};
+		for (unsigned int c = 0; c < MODE1_CANDIDATES; ++c) {
+			const int partition = order[c].second;
+			Mode1Subset subsets[2];
+			uint8_t indices[16] = {};
+			float error = 0.0f;
+			for (int subset = 0; subset < 2; ++subset) {
+				const uint16_t mask = subset ? BC7_PARTITIONS2[partition] : (uint16_t)~BC7_PARTITIONS2[partition];
+				error += mode1FitSubset(block, mask, useSimd, subsets[subset], indices);
+			}
+			if (error < bestError) {
+				bestError = error;
+				bestPartition = partition;
+				bestSubsets[0] = subsets[0];
+				bestSubsets[1] = subsets[1];
+				std::memcpy(bestIndices, indices, sizeof(indices));
+			}
+		}
+
+		// Los índices de los píxeles ancla se guardan con 2 bits: invierte el subconjunto si hace falta.
+		const uint16_t partitionMask = BC7_PARTITIONS2[bestPartition];
+		const int anchors[2] = { 0, BC7_ANCHORS2[bestPartition] };
+		for (int subset = 0; subset < 2; ++subset) {
+			if (bestIndices[anchors[subset]] < 4)
+				continue;
+			for (int k = 0; k < 3; ++k)
+				std::swap(bestSubsets[subset].q[0][k], bestSubsets[subset].q[1][k]);
+			for (int i = 0; i < 16; ++i) {
+				if ((int)((partitionMask >> i) & 1) == subset)
+					bestIndices[i] = (uint8_t)(7 - bestIndices[i]);
+			}
+		}
+
+		std::memset(out, 0, 16);
+		BitWriter writer = { out, 0 };
+		writer.put(1u << 1, 2);
+		writer.put(bestPartition, 6);
+		for (int k = 0; k < 3; ++k) {
+			for (int subset = 0; subset < 2; ++subset) {
+				writer.put(bestSubsets[subset].q[0][k], 6);
+				writer.put(bestSubsets[subset].q[1][k], 6);
+			}
+		}
+		writer.put(bestSubsets[0].p, 1);
+		writer.put(bestSubsets[1].p, 1);
+		for (int i = 0; i < 16; ++i)
+			writer.put(bestIndices[i], (i == anchors[0] || i == anchors[1]) ? 2 : 3);
+		return bestError;
+	}
+
+	void encodeBC7(const BlockPixels& block, BCQuality quality, bool useSimd, uint8_t* out) {
+		Mode6Candidate mode6;
+		encodeMode6(block, quality, useSimd, mode6);
+		writeMode6(mode6, out);
+
+		if (quality != BC_QUALITY_SLOW || mode6.error == 0.0f)
+			return;
+		for (int i = 0; i < 16; ++i) {
+			if (block.c[3][i] != 255.0f)
+				return;
+		}
+		uint8_t mode1[16];
+		if (encodeMode1(block, useSimd, mode1) < mode6.error)
+			std::memcpy(out, mode1, 16);
+	}
+
+	int bc7Expand(int value, int bits) {
+		return bits >= 8 ? value : (value << (8 - bits)) | (value >> (2 * bits - 8));
+	}
+
+	void decodeBC7(const uint8_t* in, uint8_t* out, size_t rowPitch, unsigned int columns, unsigned int rows) {
+		int mode = 0;
+		while (mode < 8 && !((in[0] >> mode) & 1))
+			++mode;
+
+		// Modos reservados y de 3 subconjuntos (no soportados) se decodifican a cero.
+		const bool supported = mode < 8 && BC7_MODES[mode].subsets < 3;
+		if (!supported) {
+			for (unsigned int y = 0; y < rows; ++y)
+				std::memset(out + y * rowPitch, 0, columns * 4);
+			return;
+		}
+
+		const BC7Mode& info = BC7_MODES[mode];
+		BitReader reader = { in, (unsigned int)mode + 1 };
+		const int partition = (int)reader.get(info.partitionBits);
+		const int rotation = (int)reader.get(info.rotationBits);
+		const int indexSelection = (int)reader.get(info.indexSelectionBits);
+
+		const int endpointCount = info.subsets * 2;
+		int endpoints[4][4];
+		for (int k = 0; k < 3; ++k) {
+			for (int e = 0; e < endpointCount; ++e)
+				endpoints[e][k] = (int)reader.get(info.colorBits);
+		}
+		for (int e = 0; e < endpointCount; ++e)
+			endpoints[e][3] = info.alphaBits ? (int)reader.get(info.alphaBits) : 255;
+
+		int colorBits = info.colorBits;
+		int alphaBits = info.alphaBits;
+		if (info.endpointPBits || info.sharedPBits) {
+			int pbits[4];
+			if (info.endpointPBits) {
+				for (int e = 0; e < endpointCount; ++e)
+					pbits[e] = (int)reader.get(1);
+			}
+			else {
+				for (int s = 0; s < info.subsets; ++s)
+					pbits[s * 2] = pbits[s * 2 + 1] = (int)reader.get(1);
+			}
+			for (int e = 0; e < endpointCount; ++e) {
+				for (int k = 0; k < 3; ++k)
+					endpoints[e][k] = (endpoints[e][k] << 1) | pbits[e];
+				if (info.alphaBits)
+					endpoints[e][3] = (endpoints[e][3] << 1) | pbits[e];
+			}
+			++colorBits;
+			if (alphaBits)
+				++alphaBits;
+		}
+		for (int e = 0; e < endpointCount; ++e) {
+			for (int k = 0; k < 3; ++k)
+				endpoints[e][k] = bc7Expand(endpoints[e][k], colorBits);
+			if (alphaBits)
+				endpoints[e][3] = bc7Expand(endpoints[e][3], alphaBits);
+		}
+
+		const uint16_t partitionMask = info.subsets == 2 ? BC7_PARTITIONS2[partition] : 0;
+		const int anchor2 = info.subsets == 2 ? BC7_ANCHORS2[partition] : -1;
+		int indices[16], indices2[16] = {};
+		for (int i = 0; i < 16; ++i)
+			indices[i] = (int)reader.get(info.indexBits - ((i == 0 || i == anchor2) ? 1 : 0));
+		if (info.index2Bits) {
+			for (int i = 0; i < 16; ++i)
+				indices2[i] = (int)reader.get(info.index2Bits - (i == 0 ? 1 : 0));
+		}
+
+		const int* weightTables[5] = { nullptr, nullptr, BC7_WEIGHTS2, BC7_WEIGHTS3, BC7_WEIGHTS4 };
+		for (unsigned int y = 0; y < rows; ++y) {
+			for (unsigned int x = 0; x < columns; ++x) {
+				const int i = (int)(y * 4 + x);
+				const int subset = (partitionMask >> i) & 1;
+				const int* e0 = endpoints[subset * 2];
+				const int* e1 = endpoints[subset * 2 + 1];
+
+				int colorWeight, alphaWeight;
+				if (!info.index2Bits) {
+					colorWeight = alphaWeight = weightTables[info.indexBits][indices[i]];
+				}
+				else if (indexSelection == 0) {
+					colorWeight = weightTables[info.indexBits][indices[i]];
+					alphaWeight = weightTables[info.index2Bits][indices2[i]];
+				}
+				else {
+					colorWeight = weightTables[info.index2Bits][indices2[i]];
+					alphaWeight = weightTables[info.indexBits][indices[i]];
+				}
+
+				int color[4];
+				for (int k = 0; k < 3; ++k)
+					color[k] = bc7Interpolate(e0[k], e1[k], colorWeight);
+				color[3] = bc7Interpolate(e0[3], e1[3], alphaWeight);
+				if (rotation)
+					std::swap(color[3], color[rotation - 1]);
+
+				uint8_t* pixel = out + y * rowPitch + x * 4;
+				for (int k = 0; k < 4; ++k)
+					pixel[k] = (uint8_t)color[k];
+			}
+		}
+	}
+
+	void encodeBlock(const BlockPixels& block, BCFormat format, const BlockCompressor::Options& options,
+		uint8_t* out) {
+		switch (format) {
+		case BC_FORMAT_BC1:
+			encodeBC1(block, options.quality, true, options.useSimd, out);
+			break;
+		case BC_FORMAT_BC3:
+			encodeBC4(block.c[3], options.quality, out);
+			encodeBC1(block, options.quality, false, options.useSimd, out + 8);
+			break;
+		case BC_FORMAT_BC4:
+			encodeBC4(block.c[0], options.quality, out);
+			break;
+		case BC_FORMAT_BC5:
+			encodeBC4(block.c[0], options.quality, out);
+			encodeBC4(block.c[1], options.quality, out + 8);
+			break;
+		case BC_FORMAT_BC7:
+			encodeBC7(block, options.quality, options.useSimd, out);
+			break;
+		default:
+			break;
+		}
+	}
+}
+
+unsigned int
+BlockCompressor::blockBytes(BCFormat format) {
+	switch (format) {
+	case BC_FORMAT_BC1:
+	case BC_FORMAT_BC4:
+		return 8;
+	case BC_FORMAT_BC3:
+	case BC_FORMAT_BC5:
+	case BC_FORMAT_BC7:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+size_t
+BlockCompressor::compressedSize(BCFormat format, unsigned int width, unsigned int height) {
+	return (size_t)((width + 3) / 4) * ((height + 3) / 4) * blockBytes(format);
+}
+
+// Comprime una imagen RGBA8 repartiendo las filas de bloques entre hilos.
+HRESULT
+BlockCompressor::encode(const uint8_t* pixels,
+	unsigned int width,
+	unsigned int height,
+	BCFormat format,
+	const Options& options,
+	std::vector<uint8_t>& blocks) {
+	if (!pixels || width == 0 || height == 0) {
+		ERROR("BlockCompressor", "encode", "Invalid source image");
+		return E_INVALIDARG;
+	}
+	const unsigned int bytes = blockBytes(format);
+	if (bytes == 0) {
+		ERROR("BlockCompressor", "encode", "Unsupported block format");
+		return E_INVALIDARG;
+	}
+
+	const unsigned int blocksWide = (width + 3) / 4;
+	const unsigned int blocksHigh = (height + 3) / 4;
+	blocks.assign((size_t)blocksWide * blocksHigh * bytes, 0);
+
+	unsigned int threads = options.threadCount;
+	if (threads == 0)
+		threads = std::max(1u, std::thread::hardware_concurrency());
+
+	parallelRows(blocksHigh, threads, [&](unsigned int begin, unsigned int end) {
+		BlockPixels block;
+		for (unsigned int by = begin; by < end; ++by) {
+			for (unsigned int bx = 0; bx < blocksWide; ++bx) {
+				loadBlock(pixels, width, height, bx, by, block);
+				encodeBlock(block, format, options, blocks.data() + ((size_t)by * blocksWide + bx) * bytes);
+			}
+		}
+		});
+	return S_OK;
+}
+
+HRESULT
+BlockCompressor::encodeChain(const std::vector<MipLevel>& levels,
+	BCFormat format,
+	const Options& options,
+	std::vector<CompressedLevel>& compressed) {
+	compressed.clear();
+	compressed.resize(levels.size());
+	for (size_t i = 0; i < levels.size(); ++i) {
+		compressed[i].width = levels[i].width;
+		compressed[i].height = levels[i].height;
+		const HRESULT hr = encode(levels[i].pixels.data(), levels[i].width, levels[i].height,
+			format, options, compressed[i].blocks);
+		if (FAILED(hr)) {
+			compressed.clear();
+			return hr;
+		}
+	}
+	return S_OK;
+}
+
+HRESULT
+BlockCompressor::decode(const uint8_t* blocks,
+	unsigned int width,
+	unsigned int height,
+	BCFormat format,
+	std::vector<uint8_t>& pixels) {
+	const unsigned int bytes = blockBytes(format);
+	if (!blocks || width == 0 || height == 0 || bytes == 0) {
+		ERROR("BlockCompressor", "decode", "Invalid compressed image");
+		return E_INVALIDARG;
+	}
+
+	pixels.assign((size_t)width * height * 4, 0);
+	const unsigned int blocksWide = (width + 3) / 4;
+	const unsigned int blocksHigh = (height + 3) / 4;
+	const size_t rowPitch = (size_t)width * 4;
+	for (unsigned int by = 0; by < blocksHigh; ++by) {
+		for (unsigned int bx = 0; bx < blocksWide; ++bx) {
+			const uint8_t* in = blocks + ((size_t)by * blocksWide + bx) * bytes;
+			uint8_t* out = pixels.data() + (size_t)by * 4 * rowPitch + bx * 16;
+			const unsigned int columns = std::min(4u, width - bx * 4);
+			const unsigned int rows = std::min(4u, height - by * 4);
+
+			switch (format) {
+			case BC_FORMAT_BC1:
+				decodeBC1(in, false, out, rowPitch, columns, rows);
+				break;
+			case BC_FORMAT_BC3:
+				decodeBC1(in + 8, true, out, rowPitch, columns, rows);
+				decodeBC4(in, out, rowPitch, 3, columns, rows);
+				break;
+			case BC_FORMAT_BC4:
+			case BC_FORMAT_BC5:
+				decodeBC4(in, out, rowPitch, 0, columns, rows);
+				if (format == BC_FORMAT_BC5)
+					decodeBC4(in + 8, out, rowPitch, 1, columns, rows);
+				for (unsigned int y = 0; y < rows; ++y) {
+					for (unsigned int x = 0; x < columns; ++x)
+						out[y * rowPitch + x * 4 + 3] = 255;
+				}
+				break;
+			case BC_FORMAT_BC7:
+				decodeBC7(in, out, rowPitch, columns, rows);
+				break;
+			default:
+				break;
+			}
+		}
+	}
+	return S_OK;
+}
+
+double
+BlockCompressor::psnr(const uint8_t* a, const uint8_t* b, size_t pixelCount, unsigned int channelMask) {
+	double sum = 0.0;
+	size_t samples = 0;
+	for (int k = 0; k < 4; ++k) {
+		if (!((channelMask >> k) & 1))
+			continue;
+		for (size_t i = 0; i < pixelCount; ++i) {
+			const double diff = (double)a[i * 4 + k] - (double)b[i * 4 + k];
+			sum += diff * diff;
+		}
+		samples += pixelCount;
+	}
+	if (samples == 0 || sum == 0.0)
+		return 100.0;
+	const double mse = sum / samples;
+	return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+#ifdef _WIN32
+DXGI_FORMAT
+BlockCompressor::dxgiFormat(BCFormat format) {
+	switch (format) {
+	case BC_FORMAT_BC1: return DXGI_FORMAT_BC1_UNORM;
+	case BC_FORMAT_BC3: return DXGI_FORMAT_BC3_UNORM;
+	case BC_FORMAT_BC4: return DXGI_FORMAT_BC4_UNORM;
+	case BC_FORMAT_BC5: return DXGI_FORMAT_BC5_UNORM;
+	case BC_FORMAT_BC7: return DXGI_FORMAT_BC7_UNORM;
+	default: return DXGI_FORMAT_R8G8B8A8_UNORM;
+	}
+}
+#endif
@@ -0,0 +1,164 @@
+#include "CommandList.h"
+#include <algorithm>
+
+// Vacía la lista sin liberar memoria para que el siguiente fotograma no reserve.
+void
+CommandList::reset() {
+	m_size = 0;
+	m_commandCount = 0;
+	m_drawCount = 0;
+}
+
+// Añade un comando al final del bloque, alineado a 8 bytes.
+void*
+CommandList::push(CommandType type, size_t payloadSize, size_t extraBytes) {
+	const size_t size = (sizeof(Header) + payloadSize + extraBytes + 7) & ~(size_t)7;
+	if (m_size + size > m_data.size()) {
+		m_data.resize(std::max(m_data.size() * 2, m_size + size));
+	}
+
+	uint8_t* command = m_data.data() + m_size;
+	Header* header = reinterpret_cast<Header*>(command);
+	header->type = type;
+	header->reserved = 0;
+	header->size = (uint32_t)size;
+	m_size += size;
+	++m_commandCount;
+	return command + sizeof(Header);
+}
+
+void
+CommandList::setInputLayout(const void* inputLayout) {
+	BindPayload* p = static_cast<BindPayload*>(push(CMD_SET_INPUT_LAYOUT, sizeof(BindPayload)));
+	p->stage = 0;
+	p->slot = 0;
+	p->object = inputLayout;
+}
+
+void
+CommandList::setVertexBuffer(unsigned int slot, const void* buffer, unsigned int stride, unsigned int offset) {
+	VertexBufferPayload* p = static_cast<VertexBufferPayload*>(push(CMD_SET_VERTEX_BUFFER, sizeof(VertexBufferPayload)));
+	p->buffer = buffer;
+	p->slot = slot;
+	p->stride = stride;
+	p->offset = offset;
+}
+
+void
+CommandList::setIndexBuffer(const void* buffer, IndexWidth width, unsigned int offset) {
+	IndexBufferPayload* p = static_cast<IndexBufferPayload*>(push(CMD_SET_INDEX_BUFFER, sizeof(IndexBufferPayload)));
+	p->buffer = buffer;
+	p->width = width;
+	p->offset = offset;
+}
+
+void
+CommandList::setPrimitiveTopology(unsigned int topology) {
+	BindPayload* p = static_cast<BindPayload*>(push(CMD_SET_PRIMITIVE_TOPOLOGY, sizeof(BindPayload)));
+	p->stage = 0;
+	p->slot = topology;
+	p->object = nullptr;
+}
+
+void
+CommandList::setShader(StateCache::Stage stage, const void* shader) {
+	BindPayload* p = static_cast<BindPayload*>(push(CMD_SET_SHADER, sizeof(BindPayload)));
+	p->stage = stage;
+	p->slot = 0;
+	p->object = shader;
+}
+
+void
+CommandList::setConstantBuffer(StateCache::Stage stage, unsigned int slot, const void* buffer) {
+	BindPayload* p = static_cast<BindPayload*>(push(CMD_SET_CONSTANT_BUFFER, sizeof(BindPayload)));
+	p->stage = stage;
+	p->slot = slot;
+	p->object = buffer;
+}
+
+void
+CommandList::setConstantBufferRange(StateCache::Stage stage, unsigned int slot, const void* buffer,
+	unsigned int firstConstant, unsigned int numConstants) {
+	RangePayload* p = static_cast<RangePayload*>(push(CMD_SET_CONSTANT_BUFFER_RANGE, sizeof(RangePayload)));
+	p->buffer = buffer;
+	p->stage = stage;
+	p->slot = slot;
+	p->firstConstant = firstConstant;
+	p->numConstants = numConstants;
+}
+
+void
+CommandList::setShaderResource(StateCache::Stage stage, unsigned int slot, const void* view) {
+	BindPayload* p = static_cast<BindPayload*>(push(CMD_SET_SHADER_RESOURCE, sizeof(BindPayload)));
+	p->stage = stage;
+	p->slot = slot;
+	p->object = view;
+}
+
+void
+CommandList::setSampler(StateCache::Stage stage, unsigned int slot, const void* sampler) {
+	BindPayload* p = static_cast<BindPayload*>(push(CMD_SET_SAMPLER, sizeof(BindPayload)));
+	p->stage = stage;
+	p->slot = slot;
+	p->object = sampler;
+}
+
+void
+CommandList::setViewport(const Viewport& viewport) {
+	Viewport* p = static_cast<Viewport*>(push(CMD_SET_VIEWPORT, sizeof(Viewport)));
+	*p = viewport;
+}
+
+void
+CommandList::setRenderTargets(unsigned int numViews, const void* const* renderTargetViews, const void* depthStencilView) {
+	if (numViews > 8 || (numViews > 0 && !renderTargetViews)) {
+		ERROR("CommandList", "setRenderTargets", "Invalid render target count or array");
+		return;
+	}
+	RenderTargetsPayload* p = static_cast<RenderTargetsPayload*>(push(CMD_SET_RENDER_TARGETS, sizeof(RenderTargetsPayload)));
+	for (unsigned int i = 0; i < 8; ++i)
+		p->renderTargets[i] = i < numViews ? renderTargetViews[i] : nullptr;
+	p->depthStencil = depthStencilView;
+	p->numViews = numViews;
+}
+
+void
+CommandList::updateConstantBuffer(const void* buffer, const void* pSrcData, unsigned int size) {
+	if (!buffer || !pSrcData) {
+		ERROR("CommandList", "updateConstantBuffer", "buffer or pSrcData is nullptr");
+		return;
+	}
+	UpdatePayload* p = static_cast<UpdatePayload*>(push(CMD_UPDATE_CONSTANT_BUFFER, sizeof(UpdatePayload), size));
+	p->buffer = buffer;
+	p->size = size;
+	memcpy(p + 1, pSrcData, size);
+}
+
+void
+CommandList::drawIndexed(unsigned int indexCount, unsigned int startIndexLocation, int baseVertexLocation) {
+	if (indexCount == 0) {
+		ERROR("CommandList", "drawIndexed", "IndexCount is zero");
+		return;
+	}
+	DrawPayload* p = static_cast<DrawPayload*>(push(CMD_DRAW_INDEXED, sizeof(DrawPayload)));
+	p->indexCount = indexCount;
+	p->startIndexLocation = startIndexLocation;
+	p->baseVertexLocation = baseVertexLocation;
+	++m_drawCount;
+}
+
+void
+CommandList::drawIndexedInstanced(unsigned int indexCountPerInstance, unsigned int instanceCount,
+	unsigned int startIndexLocation, int baseVertexLocation, unsigned int startInstanceLocation) {
+	if (indexCountPerInstance == 0 || instanceCount == 0) {
+		ERROR("CommandList", "drawIndexedInstanced", "IndexCountPerInstance or InstanceCount is zero");
+		return;
+	}
+	DrawInstancedPayload* p = static_cast<DrawInstancedPayload*>(push(CMD_DRAW_INDEXED_INSTANCED, sizeof(DrawInstancedPayload)));
+	p->indexCountPerInstance = indexCountPerInstance;
+	p->instanceCount = instanceCount;
+	p->startIndexLocation = startIndexLocation;
+	p->baseVertexLocation = baseVertexLocation;
+	p->startInstanceLocation = startInstanceLocation;
+	++m_drawCount;
+}
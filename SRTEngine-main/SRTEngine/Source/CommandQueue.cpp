@@ -0,0 +1,105 @@
+#include "CommandQueue.h"
+#include <atomic>
+#include <chrono>
+#ifdef _WIN32
+#include "Device.h"
+#include "DeviceContext.h"
+#endif
+
+// Crea listCount listas vacías.
+HRESULT
+CommandQueue::init(unsigned int listCount, JobSystem* jobs) {
+	if (listCount == 0) {
+		ERROR("CommandQueue", "init", "listCount must be greater than 0");
+		return E_INVALIDARG;
+	}
+	destroy();
+	m_jobs = jobs;
+	m_lists.resize(listCount);
+	return S_OK;
+}
+
+// Libera las listas y los contextos diferidos.
+void
+CommandQueue::destroy() {
+#ifdef _WIN32
+	for (DeviceContext* context : m_deferredContexts) {
+		context->destroy();
+		delete context;
+	}
+	m_deferredContexts.clear();
+#endif
+	m_lists.clear();
+	m_jobs = nullptr;
+	m_stats = Stats();
+}
+
+double
+CommandQueue::now() {
+	return std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Vacía y graba todas las listas en paralelo.
+void
+CommandQueue::record(const std::function<void(unsigned int, CommandList&)>& recordFn) {
+	const double start = now();
+	forEachList([&](unsigned int index) {
+		CommandList& list = m_lists[index];
+		list.reset();
+		recordFn(index, list);
+		});
+	m_stats.recordSeconds = now() - start;
+
+	m_stats.commands = 0;
+	m_stats.draws = 0;
+	for (const CommandList& list : m_lists) {
+		m_stats.commands += list.getCommandCount();
+		m_stats.draws += list.getDrawCount();
+	}
+}
+
+#ifdef _WIN32
+// Traduce cada lista en su propio contexto diferido y ejecuta el resultado en orden.
+HRESULT
+CommandQueue::submitDeferred(Device& device, DeviceContext& immediateContext) {
+	const double start = now();
+
+	while (m_deferredContexts.size() < m_lists.size()) {
+		DeviceContext* context = new DeviceContext();
+		HRESULT hr = device.CreateDeferredContext(&context->m_deviceContext);
+		if (FAILED(hr)) {
+			delete context;
+			ERROR("CommandQueue", "submitDeferred", "Failed to create deferred context");
+			return hr;
+		}
+		m_deferredContexts.push_back(context);
+	}
+
+	std::vector<ID3D11CommandList*> d3dLists(m_lists.size(), nullptr);
+	std::atomic<bool> failed{ false };
+	forEachList([&](unsigned int index) {
+		DeviceContext& context = *m_deferredContexts[index];
+		context.executeCommandList(m_lists[index]);
+		if (FAILED(context.FinishCommandList(false, &d3dLists[index])))
+			failed = true;
+		});
+
+	// Con una lista fallida el frame quedaría incompleto: se liberan todas sin ejecutar.
+	const bool execute = !failed;
+	for (ID3D11CommandList* list : d3dLists) {
+		if (list) {
+			if (execute)
+				immediateContext.ExecuteCommandList(list, false);
+			list->Release();
+		}
+	}
+
+	m_stats.submitSeconds = now() - start;
+	if (!execute) {
+		ERROR("CommandQueue", "submitDeferred", "Failed to finish one or more command lists");
+		return E_FAIL;
+	}
+	return S_OK;
+}
+#endif
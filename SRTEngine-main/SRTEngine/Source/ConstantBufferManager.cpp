@@ -0,0 +1,334 @@
+#include "ConstantBufferManager.h"
+#include <cstring>
+#ifdef _WIN32
+#include "Device.h"
+#include "DeviceContext.h"
+#endif
+
+// Crea el anillo en la GPU si el dispositivo admite desplazamientos y, si no, en CPU.
+HRESULT
+ConstantBufferManager::init(Device* device, DeviceContext* deviceContext, unsigned int ringSize) {
+	destroy();
+	if (ringSize == 0) {
+		ERROR("ConstantBufferManager", "init", "ringSize must be greater than 0");
+		return E_INVALIDARG;
+	}
+	if ((device == nullptr) != (deviceContext == nullptr)) {
+		ERROR("ConstantBufferManager", "init", "device and deviceContext must both be set or both be nullptr");
+		return E_INVALIDARG;
+	}
+
+	m_device = device;
+	m_deviceContext = deviceContext;
+	m_ringSize = (ringSize + CONSTANT_ALIGNMENT - 1) & ~(CONSTANT_ALIGNMENT - 1);
+	m_ringHead = 0;
+	m_ringDiscarded = false;
+
+#ifdef _WIN32
+	if (m_device) {
+		// Hace falta enlazar por desplazamiento y poder mapear con NO_OVERWRITE un búfer constante.
+		D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+		if (SUCCEEDED(m_device->m_device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options)))) {
+			m_offsetBinding = options.ConstantBufferOffsetting && options.MapNoOverwriteOnDynamicConstantBuffer;
+		}
+	}
+
+	if (m_offsetBinding) {
+		D3D11_BUFFER_DESC bd = {};
+		bd.Usage = D3D11_USAGE_DYNAMIC;
+		bd.ByteWidth = m_ringSize;
+		bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+		bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		HRESULT hr = m_device->CreateBuffer(&bd, nullptr, &m_ringBuffer);
+		if (FAILED(hr)) {
+			ERROR("ConstantBufferManager", "init", "Failed to create ring buffer");
+			return hr;
+		}
+		MESSAGE("ConstantBufferManager", "init", "Ring buffer created with offset binding");
+		return S_OK;
+	}
+#endif
+
+	m_cpuRing.resize(m_ringSize);
+	return S_OK;
+}
+
+// Libera todos los búferes y pone los contadores a cero.
+void
+ConstantBufferManager::destroy() {
+#ifdef _WIN32
+	for (Block& block : m_blocks) {
+		SAFE_RELEASE(block.buffer);
+	}
+	SAFE_RELEASE(m_ringBuffer);
+	for (unsigned int stage = 0; stage < StateCache::STAGE_COUNT; ++stage) {
+		for (FallbackBuffer& fallback : m_fallback[stage]) {
+			SAFE_RELEASE(fallback.buffer);
+			fallback.size = 0;
+		}
+	}
+#endif
+	m_blocks.clear();
+	m_cpuRing.clear();
+	m_cpuRing.shrink_to_fit();
+	m_ringSize = 0;
+	m_ringHead = 0;
+	m_ringDiscarded = false;
+	m_offsetBinding = false;
+	m_device = nullptr;
+	m_deviceContext = nullptr;
+	m_frame = Stats();
+	m_lastFrame = Stats();
+	m_total = Stats();
+}
+
+// Crea un bloque persistente; el tamaño se redondea a 16 bytes como exige D3D11.
+ConstantBufferManager::BlockHandle
+ConstantBufferManager::createBlock(unsigned int size) {
+	if (size == 0 || size > MAX_ALLOCATION_SIZE) {
+		ERROR("ConstantBufferManager", "createBlock", "Invalid block size");
+		return INVALID_BLOCK;
+	}
+
+	Block block;
+	block.data.assign((size + 15) & ~15u, 0);
+#ifdef _WIN32
+	if (m_device) {
+		D3D11_BUFFER_DESC bd = {};
+		bd.Usage = D3D11_USAGE_DEFAULT;
+		bd.ByteWidth = (unsigned int)block.data.size();
+		bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+		bd.CPUAccessFlags = 0;
+		HRESULT hr = m_device->CreateBuffer(&bd, nullptr, &block.buffer);
+		if (FAILED(hr)) {
+			ERROR("ConstantBufferManager", "createBlock", "Failed to create constant buffer");
+			return INVALID_BLOCK;
+		}
+	}
+#endif
+	m_blocks.push_back(std::move(block));
+	return (BlockHandle)(m_blocks.size() - 1);
+}
+
+// Solo marca el bloque como sucio si los bytes cambian.
+bool
+ConstantBufferManager::updateBlock(BlockHandle block, const void* data, unsigned int size) {
+	if (block >= m_blocks.size() || !data || size > m_blocks[block].data.size()) {
+		ERROR("ConstantBufferManager", "updateBlock", "Invalid block, data or size");
+		return false;
+	}
+
+	Block& target = m_blocks[block];
+	if (memcmp(target.data.data(), data, size) == 0) {
+		++m_frame.blockSkips;
+		m_frame.bytesSkipped += size;
+		return false;
+	}
+	memcpy(target.data.data(), data, size);
+	target.dirty = true;
+	return true;
+}
+
+void
+ConstantBufferManager::commitBlocks() {
+	for (Block& block : m_blocks) {
+		uploadBlock(block);
+	}
+}
+
+void
+ConstantBufferManager::uploadBlock(Block& block) {
+	if (!block.dirty)
+		return;
+#ifdef _WIN32
+	if (m_deviceContext && block.buffer) {
+		m_deviceContext->UpdateSubresource(block.buffer, 0, nullptr, block.data.data(), 0, 0);
+	}
+#endif
+	block.dirty = false;
+	++m_frame.blockUploads;
+	countUpload((unsigned int)block.data.size());
+}
+
+void
+ConstantBufferManager::bindBlock(StateCache::Stage stage, unsigned int slot, BlockHandle block) {
+	if (block >= m_blocks.size()) {
+		ERROR("ConstantBufferManager", "bindBlock", "Invalid block");
+		return;
+	}
+	uploadBlock(m_blocks[block]);
+#ifdef _WIN32
+	if (!m_deviceContext)
+		return;
+	ID3D11Buffer* buffer = m_blocks[block].buffer;
+	if (stage == StateCache::VERTEX_STAGE)
+		m_deviceContext->VSSetConstantBuffers(slot, 1, &buffer);
+	else
+		m_deviceContext->PSSetConstantBuffers(slot, 1, &buffer);
+#else
+	(void)stage;
+	(void)slot;
+#endif
+}
+
+// Reserva el siguiente hueco del anillo; si no cabe, vuelve al principio.
+bool
+ConstantBufferManager::allocate(const void* data, unsigned int size, Allocation& allocation) {
+	const unsigned int alignedSize = (size + CONSTANT_ALIGNMENT - 1) & ~(CONSTANT_ALIGNMENT - 1);
+	if (!data || size == 0 || size > MAX_ALLOCATION_SIZE || alignedSize > m_ringSize) {
+		ERROR("ConstantBufferManager", "allocate", "Invalid data or size");
+		return false;
+	}
+
+	const bool wrap = m_ringHead + alignedSize > m_ringSize;
+	if (wrap) {
+		m_ringHead = 0;
+		++m_frame.ringWraps;
+	}
+
+	// Se descarta al empezar y al dar la vuelta; el resto de escrituras no pisan datos en uso.
+	const bool discard = wrap || !m_ringDiscarded;
+	allocation.offset = m_ringHead;
+	allocation.size = alignedSize;
+	allocation.firstConstant = m_ringHead / 16;
+	allocation.numConstants = alignedSize / 16;
+	m_ringHead += alignedSize;
+	++m_frame.allocations;
+
+#ifdef _WIN32
+	if (m_offsetBinding) {
+		const D3D11_MAP mapType = discard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE;
+		D3D11_MAPPED_SUBRESOURCE mapped;
+		HRESULT hr = m_deviceContext->Map(m_ringBuffer, 0, mapType, 0, &mapped);
+		if (FAILED(hr)) {
+			ERROR("ConstantBufferManager", "allocate", "Failed to map ring buffer");
+			return false;
+		}
+		memcpy(static_cast<uint8_t*>(mapped.pData) + allocation.offset, data, size);
+		m_deviceContext->Unmap(m_ringBuffer, 0);
+		m_ringDiscarded = true;
+		m_frame.ringDiscards += discard;
+		countUpload(size);
+		return true;
+	}
+#endif
+
+	memcpy(m_cpuRing.data() + allocation.offset, data, size);
+	// En CPU no hay Map, pero se cuenta con el mismo criterio para poder comprobarlo sin GPU.
+	m_ringDiscarded = true;
+	m_frame.ringDiscards += discard;
+	if (!m_deviceContext) {
+		// Sin dispositivo no hay enlace que copie: se cuenta aquí.
+		countUpload(size);
+	}
+	return true;
+}
+
+// Si el lote no cabe hasta el final, se fuerza la vuelta en la siguiente asignación.
+bool
+ConstantBufferManager::reserve(unsigned int size, unsigned int count) {
+	const uint64_t bytes = (uint64_t)((size + CONSTANT_ALIGNMENT - 1) & ~(CONSTANT_ALIGNMENT - 1)) * count;
+	if (size > MAX_ALLOCATION_SIZE || bytes > m_ringSize)
+		return false;
+	if (m_ringHead + bytes > m_ringSize)
+		m_ringHead = m_ringSize;
+	return true;
+}
+
+void
+ConstantBufferManager::bindAllocation(StateCache::Stage stage, unsigned int slot, const Allocation& allocation) {
+#ifdef _WIN32
+	if (!m_deviceContext)
+		return;
+
+	if (m_offsetBinding) {
+		if (stage == StateCache::VERTEX_STAGE)
+			m_deviceContext->VSSetConstantBuffers1(slot, 1, &m_ringBuffer, &allocation.firstConstant, &allocation.numConstants);
+		else
+			m_deviceContext->PSSetConstantBuffers1(slot, 1, &m_ringBuffer, &allocation.firstConstant, &allocation.numConstants);
+		return;
+	}
+
+	ID3D11Buffer* buffer = fillFallbackBuffer(stage, slot, allocation);
+	if (!buffer)
+		return;
+	if (stage == StateCache::VERTEX_STAGE)
+		m_deviceContext->VSSetConstantBuffers(slot, 1, &buffer);
+	else
+		m_deviceContext->PSSetConstantBuffers(slot, 1, &buffer);
+#else
+	(void)stage;
+	(void)slot;
+	(void)allocation;
+#endif
+}
+
+#ifdef _WIN32
+// Copia la asignación a un búfer dinámico propio del slot (se recrea si se queda pequeño).
+ID3D11Buffer*
+ConstantBufferManager::fillFallbackBuffer(StateCache::Stage stage, unsigned int slot, const Allocation& allocation) {
+	if (slot >= StateCache::MAX_CONSTANT_BUFFERS || allocation.offset + allocation.size > m_cpuRing.size()) {
+		ERROR("ConstantBufferManager", "bindAllocation", "Invalid slot or allocation");
+		return nullptr;
+	}
+
+	FallbackBuffer& fallback = m_fallback[stage][slot];
+	if (fallback.size < allocation.size) {
+		SAFE_RELEASE(fallback.buffer);
+		D3D11_BUFFER_DESC bd = {};
+		bd.Usage = D3D11_USAGE_DYNAMIC;
+		bd.ByteWidth = allocation.size;
+		bd.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+		bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		if (FAILED(m_device->CreateBuffer(&bd, nullptr, &fallback.buffer))) {
+			ERROR("ConstantBufferManager", "bindAllocation", "Failed to create fallback buffer");
+			fallback.size = 0;
+			return nullptr;
+		}
+		fallback.size = allocation.size;
+	}
+
+	D3D11_MAPPED_SUBRESOURCE mapped;
+	if (FAILED(m_deviceContext->Map(fallback.buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped))) {
+		ERROR("ConstantBufferManager", "bindAllocation", "Failed to map fallback buffer");
+		return nullptr;
+	}
+	memcpy(mapped.pData, m_cpuRing.data() + allocation.offset, allocation.size);
+	m_deviceContext->Unmap(fallback.buffer, 0);
+	countUpload(allocation.size);
+	return fallback.buffer;
+}
+#endif
+
+const void*
+ConstantBufferManager::getRingBuffer() const {
+#ifdef _WIN32
+	return m_offsetBinding ? m_ringBuffer : nullptr;
+#else
+	return nullptr;
+#endif
+}
+
+void
+ConstantBufferManager::countUpload(unsigned int bytes) {
+	m_frame.bytesUploaded += bytes;
+}
+
+// Cierra el fotograma y acumula sus contadores en el total.
+void
+ConstantBufferManager::endFrame() {
+	m_total.bytesUploaded += m_frame.bytesUploaded;
+	m_total.bytesSkipped += m_frame.bytesSkipped;
+	m_total.blockUploads += m_frame.blockUploads;
+	m_total.blockSkips += m_frame.blockSkips;
+	m_total.allocations += m_frame.allocations;
+	m_total.ringWraps += m_frame.ringWraps;
+	m_total.ringDiscards += m_frame.ringDiscards;
+	m_lastFrame = m_frame;
+	m_frame = Stats();
+}
+
+const uint8_t*
+ConstantBufferManager::getBlockData(BlockHandle block) const {
+	return block < m_blocks.size() ? m_blocks[block].data.data() : nullptr;
+}
@@ -0,0 +1,298 @@
+#include "DDSFile.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+	const uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+	const size_t DDS_HEADER_SIZE = 124;
+	const size_t DDS_HEADER_DX10_SIZE = 20;
+
+	// Banderas de la cabecera.
+	const uint32_t DDSD_DEPTH = 0x800000;
+	const uint32_t DDSCAPS2_CUBEMAP = 0x200;
+	const uint32_t DDSCAPS2_CUBEMAP_ALLFACES = 0xFC00;
+	const uint32_t DDSCAPS2_VOLUME = 0x200000;
+	const uint32_t DDPF_ALPHA = 0x2;
+	const uint32_t DDPF_FOURCC = 0x4;
+	const uint32_t DDPF_RGB = 0x40;
+	const uint32_t DDPF_LUMINANCE = 0x20000;
+	const uint32_t DDS_RESOURCE_MISC_TEXTURECUBE = 0x4;
+
+	// Valores de DXGI_FORMAT que produce la cabecera clásica.
+	const unsigned int FORMAT_R32G32B32A32_FLOAT = 2;
+	const unsigned int FORMAT_R16G16B16A16_FLOAT = 10;
+	const unsigned int FORMAT_R16G16B16A16_UNORM = 11;
+	const unsigned int FORMAT_R16G16B16A16_SNORM = 13;
+	const unsigned int FORMAT_R32G32_FLOAT = 16;
+	const unsigned int FORMAT_R10G10B10A2_UNORM = 24;
+	const unsigned int FORMAT_R8G8B8A8_UNORM = 28;
+	const unsigned int FORMAT_R16G16_FLOAT = 34;
+	const unsigned int FORMAT_R16G16_UNORM = 35;
+	const unsigned int FORMAT_R32_FLOAT = 41;
+	const unsigned int FORMAT_R8G8_UNORM = 49;
+	const unsigned int FORMAT_R16_FLOAT = 54;
+	const unsigned int FORMAT_R16_UNORM = 56;
+	const unsigned int FORMAT_R8_UNORM = 61;
+	const unsigned int FORMAT_A8_UNORM = 65;
+	const unsigned int FORMAT_BC1_UNORM = 71;
+	const unsigned int FORMAT_BC2_UNORM = 74;
+	const unsigned int FORMAT_BC3_UNORM = 77;
+	const unsigned int FORMAT_BC4_UNORM = 80;
+	const unsigned int FORMAT_BC4_SNORM = 81;
+	const unsigned int FORMAT_BC5_UNORM = 83;
+	const unsigned int FORMAT_BC5_SNORM = 84;
+	const unsigned int FORMAT_B5G6R5_UNORM = 85;
+	const unsigned int FORMAT_B5G5R5A1_UNORM = 86;
+	const unsigned int FORMAT_B8G8R8A8_UNORM = 87;
+	const unsigned int FORMAT_B8G8R8X8_UNORM = 88;
+	const unsigned int FORMAT_B4G4R4A4_UNORM = 115;
+
+	uint32_t fourCC(char a, char b, char c, char d) {
+		return (uint32_t)(uint8_t)a | ((uint32_t)(uint8_t)b << 8) | ((uint32_t)(uint8_t)c << 16) | ((uint32_t)(uint8_t)d << 24);
+	}
+
+	uint32_t readU32(const uint8_t* data, size_t offset) {
+		uint32_t value;
+		std::memcpy(&value, data + offset, sizeof(value));
+		return value;
+	}
+
+	// Traduce el DDS_PIXELFORMAT clásico a DXGI_FORMAT (0 si no se reconoce).
+	unsigned int legacyFormat(const uint8_t* pf) {
+		const uint32_t flags = readU32(pf, 4);
+		const uint32_t code = readU32(pf, 8);
+		const uint32_t bits = readU32(pf, 12);
+		const uint32_t r = readU32(pf, 16);
+		const uint32_t g = readU32(pf, 20);
+		const uint32_t b = readU32(pf, 24);
+		const uint32_t a = readU32(pf, 28);
+
+		if (flags & DDPF_FOURCC) {
+			if (code == fourCC('D', 'X', 'T', '1')) return FORMAT_BC1_UNORM;
+			if (code == fourCC('D', 'X', 'T', '2') || code == fourCC('D', 'X', 'T', '3')) return FORMAT_BC2_UNORM;
+			if (code == fourCC('D', 'X', 'T', '4') || code == fourCC('D', 'X', 'T', '5')) return FORMAT_BC3_UNORM;
+			if (code == fourCC('A', 'T', 'I', '1') || code == fourCC('B', 'C', '4', 'U')) return FORMAT_BC4_UNORM;
+			if (code == fourCC('B', 'C', '4', 'S')) return FORMAT_BC4_SNORM;
+			if (code == fourCC('A', 'T', 'I', '2') || code == fourCC('B', 'C', '5', 'U')) return FORMAT_BC5_UNORM;
+			if (code == fourCC('B', 'C', '5', 'S')) return FORMAT_BC5_SNORM;
+			// FourCC numéricos de D3DFORMAT.
+			switch (code) {
+			case 36:  return FORMAT_R16G16B16A16_UNORM;
+			case 110: return FORMAT_R16G16B16A16_SNORM;
+			case 111: return FORMAT_R16_FLOAT;
+			case 112: return FORMAT_R16G16_FLOAT;
+			case 113: return FORMAT_R16G16B16A16_FLOAT;
+			case 114: return FORMAT_R32_FLOAT;
+			case 115: return FORMAT_R32G32_FLOAT;
+			case 116: return FORMAT_R32G32B32A32_FLOAT;
+			default:  return 0;
+			}
+		}
+		if (flags & DDPF_RGB) {
+			if (bits == 32) {
+				if (r == 0x000000FF && g == 0x0000FF00 && b == 0x00FF0000 && a == 0xFF000000) return FORMAT_R8G8B8A8_UNORM;
+				if (r == 0x00FF0000 && g == 0x0000FF00 && b == 0x000000FF && a == 0xFF000000) return FORMAT_B8G8R8A8_UNORM;
+				if (r == 0x00FF0000 && g == 0x0000FF00 && b == 0x000000FF && a == 0) return FORMAT_B8G8R8X8_UNORM;
+				if (r == 0x000003FF && g == 0x000FFC00 && b == 0x3FF00000) return FORMAT_R10G10B10A2_UNORM;
+				if (r == 0x0000FFFF && g == 0xFFFF0000 && b == 0 && a == 0) return FORMAT_R16G16_UNORM;
+				if (r == 0xFFFFFFFF && g == 0 && b == 0 && a == 0) return FORMAT_R32_FLOAT;
+			}
+			else if (bits == 16) {
+				if (r == 0xF800 && g == 0x07E0 && b == 0x001F && a == 0) return FORMAT_B5G6R5_UNORM;
+				if (r == 0x7C00 && g == 0x03E0 && b == 0x001F && a == 0x8000) return FORMAT_B5G5R5A1_UNORM;
+				if (r == 0x0F00 && g == 0x00F0 && b == 0x000F && a == 0xF000) return FORMAT_B4G4R4A4_UNORM;
+			}
+			return 0;
+		}
+		if (flags & DDPF_LUMINANCE) {
+			if (bits == 8 && r == 0xFF) return FORMAT_R8_UNORM;
+			if (bits == 16 && r == 0xFFFF) return FORMAT_R16_UNORM;
+			if (bits == 16 && r == 0x00FF && a == 0xFF00) return FORMAT_R8G8_UNORM;
+			return 0;
+		}
+		if ((flags & DDPF_ALPHA) && bits == 8)
+			return FORMAT_A8_UNORM;
+		return 0;
+	}
+
+	// Bytes por bloque 4x4 de los formatos BC (0 si no es BC).
+	unsigned int blockBytes(unsigned int format) {
+		if ((format >= 70 && format <= 72) || (format >= 79 && format <= 81))
+			return 8;   // BC1, BC4
+		if ((format >= 73 && format <= 78) || (format >= 82 && format <= 84) || (format >= 94 && format <= 99))
+			return 16;  // BC2, BC3, BC5, BC6H, BC7
+		return 0;
+	}
+
+	// Bits por píxel de los formatos sin comprimir (0 si no se soporta).
+	unsigned int bitsPerPixel(unsigned int format) {
+		if (format >= 1 && format <= 4) return 128;
+		if (format >= 5 && format <= 8) return 96;
+		if (format >= 9 && format <= 22) return 64;
+		if ((format >= 23 && format <= 47) || format == 67 || (format >= 87 && format <= 93)) return 32;
+		if ((format >= 48 && format <= 59) || format == 85 || format == 86 || format == 115) return 16;
+		if (format >= 60 && format <= 65) return 8;
+		return 0;
+	}
+}
+
+DDSFile::~DDSFile() {
+	close();
+}
+
+// Proyecta el archivo en memoria de solo lectura.
+HRESULT
+DDSFile::open(const std::string& fileName) {
+	close();
+	HRESULT hr = m_file.open(fileName);
+	if (FAILED(hr))
+		return hr;
+
+	hr = readHeaders(m_file.data(), m_file.size());
+	if (FAILED(hr)) {
+		ERROR("DDSFile", "open", ("Invalid DDS file " + fileName).c_str());
+		close();
+	}
+	return hr;
+}
+
+HRESULT
+DDSFile::parse(const uint8_t* data, size_t size) {
+	close();
+	if (!data) {
+		ERROR("DDSFile", "parse", "Data is nullptr");
+		return E_POINTER;
+	}
+	const HRESULT hr = readHeaders(data, size);
+	if (FAILED(hr))
+		close();
+	return hr;
+}
+
+void
+DDSFile::close() {
+	m_file.close();
+	m_dimension = DIMENSION_UNKNOWN;
+	m_format = 0;
+	m_width = m_height = m_depth = 0;
+	m_mipCount = m_arraySize = 0;
+	m_cubemap = false;
+	m_blockBytes = m_bitsPerPixel = 0;
+	m_dataSize = 0;
+	m_subresources.clear();
+}
+
+// Lee las cabeceras y calcula dónde empieza cada subrecurso.
+HRESULT
+DDSFile::readHeaders(const uint8_t* data, size_t size) {
+	if (size < 4 + DDS_HEADER_SIZE || readU32(data, 0) != DDS_MAGIC || readU32(data, 4) != DDS_HEADER_SIZE) {
+		ERROR("DDSFile", "readHeaders", "Missing DDS magic or header");
+		return E_FAIL;
+	}
+
+	const uint8_t* header = data + 4;
+	const uint32_t flags = readU32(header, 4);
+	m_height = readU32(header, 8);
+	m_width = readU32(header, 12);
+	m_depth = (flags & DDSD_DEPTH) ? std::max(1u, readU32(header, 20)) : 1;
+	m_mipCount = std::max(1u, readU32(header, 24));
+	const uint8_t* pixelFormat = header + 72;
+	const uint32_t caps2 = readU32(header, 108);
+
+	size_t offset = 4 + DDS_HEADER_SIZE;
+	m_arraySize = 1;
+	if ((readU32(pixelFormat, 4) & DDPF_FOURCC) && readU32(pixelFormat, 8) == fourCC('D', 'X', '1', '0')) {
+		if (size < offset + DDS_HEADER_DX10_SIZE) {
+			ERROR("DDSFile", "readHeaders", "Truncated DX10 header");
+			return E_FAIL;
+		}
+		const uint8_t* dx10 = data + offset;
+		m_format = readU32(dx10, 0);
+		m_dimension = (Dimension)readU32(dx10, 4);
+		m_cubemap = (readU32(dx10, 8) & DDS_RESOURCE_MISC_TEXTURECUBE) != 0;
+		m_arraySize = readU32(dx10, 12);
+		offset += DDS_HEADER_DX10_SIZE;
+
+		if (m_arraySize == 0 ||
+			(m_dimension != DIMENSION_TEXTURE1D && m_dimension != DIMENSION_TEXTURE2D && m_dimension != DIMENSION_TEXTURE3D) ||
+			(m_dimension == DIMENSION_TEXTURE3D && m_arraySize != 1) ||
+			(m_cubemap && m_dimension != DIMENSION_TEXTURE2D)) {
+			ERROR("DDSFile", "readHeaders", "Unsupported DX10 resource layout");
+			return E_FAIL;
+		}
+		if (m_dimension != DIMENSION_TEXTURE3D)
+			m_depth = 1;
+		if (m_dimension == DIMENSION_TEXTURE1D)
+			m_height = 1;
+		if (m_cubemap)
+			m_arraySize *= 6;
+	}
+	else {
+		m_format = legacyFormat(pixelFormat);
+		if (caps2 & DDSCAPS2_VOLUME) {
+			m_dimension = DIMENSION_TEXTURE3D;
+		}
+		else {
+			m_dimension = DIMENSION_TEXTURE2D;
+			m_depth = 1;
+			if (caps2 & DDSCAPS2_CUBEMAP) {
+				// D3D11 no admite cubos con caras sueltas.
+				if ((caps2 & DDSCAPS2_CUBEMAP_ALLFACES) != DDSCAPS2_CUBEMAP_ALLFACES) {
+					ERROR("DDSFile", "readHeaders", "Partial cubemaps are not supported");
+					return E_FAIL;
+				}
+				m_cubemap = true;
+				m_arraySize = 6;
+			}
+		}
+	}
+
+	m_blockBytes = blockBytes(m_format);
+	m_bitsPerPixel = m_blockBytes ? 0 : bitsPerPixel(m_format);
+	if (!m_blockBytes && !m_bitsPerPixel) {
+		ERROR("DDSFile", "readHeaders", "Unsupported pixel format");
+		return E_FAIL;
+	}
+	if (m_width == 0 || m_height == 0 || m_mipCount > 32) {
+		ERROR("DDSFile", "readHeaders", "Invalid texture dimensions");
+		return E_FAIL;
+	}
+
+	// Subrecursos en orden D3D11: elemento del array mayor, mip menor.
+	m_subresources.reserve((size_t)m_arraySize * m_mipCount);
+	for (unsigned int item = 0; item < m_arraySize; ++item) {
+		unsigned int width = m_width, height = m_height, depth = m_depth;
+		for (unsigned int mip = 0; mip < m_mipCount; ++mip) {
+			Subresource sub;
+			sub.width = width;
+			sub.height = height;
+			sub.depth = depth;
+			size_t rows;
+			if (m_blockBytes) {
+				sub.rowPitch = std::max(1u, (width + 3) / 4) * m_blockBytes;
+				rows = std::max(1u, (height + 3) / 4);
+			}
+			else {
+				sub.rowPitch = (width * m_bitsPerPixel + 7) / 8;
+				rows = height;
+			}
+			sub.slicePitch = (unsigned int)(sub.rowPitch * rows);
+			const size_t bytes = (size_t)sub.slicePitch * depth;
+			if (offset + bytes > size) {
+				ERROR("DDSFile", "readHeaders", "File is smaller than its mip chain");
+				m_subresources.clear();
+				return E_FAIL;
+			}
+			sub.data = data + offset;
+			m_subresources.push_back(sub);
+			offset += bytes;
+			m_dataSize += bytes;
+
+			width = std::max(1u, width / 2);
+			height = std::max(1u, height / 2);
+			depth = std::max(1u, depth / 2);
+		}
+	}
+	return S_OK;
+}
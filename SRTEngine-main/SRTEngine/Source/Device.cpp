@@ -311,3 +311,25 @@ HRESULT Device::CreateBlendState(const D3D11_BLEND_DESC* pBlendStateDesc,
 
     return hr;
 }
+
+// Crea un contexto diferido (ID3D11DeviceContext) para grabar comandos en otro hilo.
+// ppDeferredContext: Puntero de salida que recibe el contexto diferido.
+// Devuelve un HRESULT que indica el resultado de la operacin.
+HRESULT Device::CreateDeferredContext(ID3D11DeviceContext** ppDeferredContext) {
+    if (!ppDeferredContext) {
+        ERROR("Device", "CreateDeferredContext", "ppDeferredContext is nullptr");
+        return E_POINTER;
+    }
+
+    HRESULT hr = m_device->CreateDeferredContext(0, ppDeferredContext);
+
+    if (SUCCEEDED(hr)) {
+        MESSAGE("Device", "CreateDeferredContext", "Deferred context created successfully");
+    }
+    else {
+        ERROR("Device", "CreateDeferredContext",
+            ("Failed to create deferred context. HRESULT: " + std::to_string(hr)).c_str());
+    }
+
+    return hr;
+}
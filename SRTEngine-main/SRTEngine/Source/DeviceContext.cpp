@@ -1,10 +1,44 @@
 ﻿#include "DeviceContext.h"
+#include "CommandList.h"
+
+namespace {
+	// Recurso que hay detrás de una vista, solo como identidad para la StateCache: la vista
+	// mantiene su propia referencia, así que la de GetResource se suelta enseguida.
+	const void* viewResource(ID3D11View* view) {
+		if (!view)
+			return nullptr;
+		ID3D11Resource* resource = nullptr;
+		view->GetResource(&resource);
+		if (resource)
+			resource->Release();
+		return resource;
+	}
+}
 
 // Libera los recursos del contexto del dispositivo.
 void
 DeviceContext::destroy() {
 	// Liberamos el contexto del dispositivo, asegurándonos de que no haya fugas de memoria.
+	SAFE_RELEASE(m_deviceContext1);
 	SAFE_RELEASE(m_deviceContext);
+	m_stateCache.invalidate();
+}
+
+// Restablece el estado del pipeline y la copia en sombra.
+void
+DeviceContext::ClearState() {
+	if (!m_deviceContext) {
+		ERROR("DeviceContext", "ClearState", "m_deviceContext is nullptr");
+		return;
+	}
+	m_deviceContext->ClearState();
+	m_stateCache.invalidate();
+}
+
+// Cierra los contadores de llamadas emitidas/filtradas del fotograma.
+void
+DeviceContext::endFrame() {
+	m_stateCache.endFrame();
 }
 
 // Configura las dimensiones y características de las viewports.
@@ -16,6 +50,9 @@ DeviceContext::RSSetViewports(unsigned int NumViewports,
 		ERROR("DeviceContext", "RSSetViewports", "pViewports is nullptr");
 		return;
 	}
+	// Si las viewports no cambian no llegamos al driver.
+	if (!m_stateCache.setViewports(NumViewports, pViewports, sizeof(D3D11_VIEWPORT)))
+		return;
 	// Configuramos las viewports en el contexto de dispositivo.
 	m_deviceContext->RSSetViewports(NumViewports, pViewports);
 }
@@ -31,8 +68,19 @@ DeviceContext::PSSetShaderResources(unsigned int StartSlot,
 		ERROR("DeviceContext", "PSSetShaderResources", "ppShaderResourceViews is nullptr");
 		return;
 	}
+	// Recursos de las vistas, para saber si alguna choca con un render target enlazado.
+	const void* resources[StateCache::MAX_SHADER_RESOURCES];
+	const bool knownResources = NumViews <= StateCache::MAX_SHADER_RESOURCES;
+	for (unsigned int i = 0; knownResources && i < NumViews; ++i)
+		resources[i] = viewResource(ppShaderResourceViews[i]);
+	// Enviamos solo el rango de slots que cambia.
+	unsigned int first, count;
+	if (!m_stateCache.setShaderResources(StateCache::PIXEL_STAGE, StartSlot, NumViews,
+		reinterpret_cast<const void* const*>(ppShaderResourceViews), first, count,
+		knownResources ? resources : nullptr))
+		return;
 	// Configuramos los recursos de shader para el pixel shader.
-	m_deviceContext->PSSetShaderResources(StartSlot, NumViews, ppShaderResourceViews);
+	m_deviceContext->PSSetShaderResources(first, count, ppShaderResourceViews + (first - StartSlot));
 }
 
 // Define la estructura de entrada de los vértices.
@@ -43,6 +91,8 @@ DeviceContext::IASetInputLayout(ID3D11InputLayout* pInputLayout) {
 		ERROR("DeviceContext", "IASetInputLayout", "pInputLayout is nullptr");
 		return;
 	}
+	if (!m_stateCache.setInputLayout(pInputLayout))
+		return;
 	// Establecemos el layout de entrada en el contexto de dispositivo.
 	m_deviceContext->IASetInputLayout(pInputLayout);
 }
@@ -57,6 +107,8 @@ DeviceContext::VSSetShader(ID3D11VertexShader* pVertexShader,
 		ERROR("DeviceContext", "VSSetShader", "pVertexShader is nullptr");
 		return;
 	}
+	if (!m_stateCache.setShader(StateCache::VERTEX_STAGE, pVertexShader, NumClassInstances))
+		return;
 	// Establecemos el shader de vértices en el contexto de dispositivo.
 	m_deviceContext->VSSetShader(pVertexShader, ppClassInstances, NumClassInstances);
 }
@@ -71,6 +123,8 @@ DeviceContext::PSSetShader(ID3D11PixelShader* pPixelShader,
 		ERROR("DeviceContext", "PSSetShader", "pPixelShader is nullptr");
 		return;
 	}
+	if (!m_stateCache.setShader(StateCache::PIXEL_STAGE, pPixelShader, NumClassInstances))
+		return;
 	// Establecemos el shader de píxeles en el contexto de dispositivo.
 	m_deviceContext->PSSetShader(pPixelShader, ppClassInstances, NumClassInstances);
 }
@@ -113,12 +167,18 @@ DeviceContext::IASetVertexBuffers(unsigned int StartSlot,
 			"Invalid arguments: ppVertexBuffers, pStrides, or pOffsets is nullptr");
 		return;
 	}
+	// Enviamos solo el rango de slots que cambia.
+	unsigned int first, count;
+	if (!m_stateCache.setVertexBuffers(StartSlot, NumBuffers,
+		reinterpret_cast<const void* const*>(ppVertexBuffers), pStrides, pOffsets, first, count))
+		return;
 	// Configuramos los búferes de vértices en el contexto de dispositivo.
-	m_deviceContext->IASetVertexBuffers(StartSlot,
-		NumBuffers,
-		ppVertexBuffers,
-		pStrides,
-		pOffsets);
+	const unsigned int skipped = first - StartSlot;
+	m_deviceContext->IASetVertexBuffers(first,
+		count,
+		ppVertexBuffers + skipped,
+		pStrides + skipped,
+		pOffsets + skipped);
 }
 
 // Establece el búfer de índices para la etapa de entrada de la tubería gráfica.
@@ -132,6 +192,8 @@ DeviceContext::IASetIndexBuffer(ID3D11Buffer* pIndexBuffer,
 		ERROR("DeviceContext", "IASetIndexBuffer", "pIndexBuffer is nullptr");
 		return;
 	}
+	if (!m_stateCache.setIndexBuffer(pIndexBuffer, Format, Offset))
+		return;
 	// Establecemos el búfer de índices en el contexto de dispositivo.
 	m_deviceContext->IASetIndexBuffer(pIndexBuffer, Format, Offset);
 }
@@ -147,8 +209,12 @@ DeviceContext::PSSetSamplers(unsigned int StartSlot,
 		ERROR("DeviceContext", "PSSetSamplers", "ppSamplers is nullptr");
 		return;
 	}
+	unsigned int first, count;
+	if (!m_stateCache.setSamplers(StateCache::PIXEL_STAGE, StartSlot, NumSamplers,
+		reinterpret_cast<const void* const*>(ppSamplers), first, count))
+		return;
 	// Establecemos los estados de muestreo en el contexto de dispositivo.
-	m_deviceContext->PSSetSamplers(StartSlot, NumSamplers, ppSamplers);
+	m_deviceContext->PSSetSamplers(first, count, ppSamplers + (first - StartSlot));
 }
 
 // Configura el estado de rasterización en la tubería gráfica.
@@ -159,6 +225,8 @@ DeviceContext::RSSetState(ID3D11RasterizerState* pRasterizerState) {
 		ERROR("DeviceContext", "RSSetState", "pRasterizerState is nullptr");
 		return;
 	}
+	if (!m_stateCache.setRasterizerState(pRasterizerState))
+		return;
 	// Establecemos el estado de rasterización en el contexto de dispositivo.
 	m_deviceContext->RSSetState(pRasterizerState);
 }
@@ -174,6 +242,8 @@ DeviceContext::OMSetBlendState(ID3D11BlendState* pBlendState,
 		ERROR("DeviceContext", "OMSetBlendState", "pBlendState is nullptr");
 		return;
 	}
+	if (!m_stateCache.setBlendState(pBlendState, BlendFactor, SampleMask))
+		return;
 	// Establecemos el estado de mezcla en el contexto de dispositivo.
 	m_deviceContext->OMSetBlendState(pBlendState, BlendFactor, SampleMask);
 }
@@ -197,6 +267,18 @@ DeviceContext::OMSetRenderTargets(unsigned int NumViews,
 		return;
 	}
 
+	// El driver desenlaza los SRV cuyo recurso pasa a ser target; la caché los identifica por recurso.
+	const void* resources[StateCache::MAX_RENDER_TARGETS + 1];
+	const bool knownResources = NumViews <= StateCache::MAX_RENDER_TARGETS;
+	if (knownResources) {
+		for (unsigned int i = 0; i < NumViews; ++i)
+			resources[i] = viewResource(ppRenderTargetViews[i]);
+		resources[NumViews] = viewResource(pDepthStencilView);
+	}
+	if (!m_stateCache.setRenderTargets(NumViews,
+		reinterpret_cast<const void* const*>(ppRenderTargetViews), pDepthStencilView,
+		knownResources ? resources : nullptr))
+		return;
 	// Asignamos los objetivos de renderizado y el depth stencil en el contexto de dispositivo.
 	m_deviceContext->OMSetRenderTargets(NumViews, ppRenderTargetViews, pDepthStencilView);
 }
@@ -211,6 +293,8 @@ DeviceContext::IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY Topology) {
 		return;
 	}
 
+	if (!m_stateCache.setPrimitiveTopology(Topology))
+		return;
 	// Establecemos la topología en el contexto de dispositivo.
 	m_deviceContext->IASetPrimitiveTopology(Topology);
 }
@@ -270,8 +354,12 @@ DeviceContext::VSSetConstantBuffers(unsigned int StartSlot,
 		return;
 	}
 
+	unsigned int first, count;
+	if (!m_stateCache.setConstantBuffers(StateCache::VERTEX_STAGE, StartSlot, NumBuffers,
+		reinterpret_cast<const void* const*>(ppConstantBuffers), first, count))
+		return;
 	// Asignamos los búferes constantes al Vertex Shader.
-	m_deviceContext->VSSetConstantBuffers(StartSlot, NumBuffers, ppConstantBuffers);
+	m_deviceContext->VSSetConstantBuffers(first, count, ppConstantBuffers + (first - StartSlot));
 }
 
 // Establece los búferes constantes para el pixel shader.
@@ -286,8 +374,101 @@ DeviceContext::PSSetConstantBuffers(unsigned int StartSlot,
 		return;
 	}
 
+	unsigned int first, count;
+	if (!m_stateCache.setConstantBuffers(StateCache::PIXEL_STAGE, StartSlot, NumBuffers,
+		reinterpret_cast<const void* const*>(ppConstantBuffers), first, count))
+		return;
 	// Asignamos los búferes constantes al Pixel Shader.
-	m_deviceContext->PSSetConstantBuffers(StartSlot, NumBuffers, ppConstantBuffers);
+	m_deviceContext->PSSetConstantBuffers(first, count, ppConstantBuffers + (first - StartSlot));
+}
+
+// Obtiene la interfaz ID3D11DeviceContext1 del contexto (nullptr si el runtime es anterior a 11.1).
+static ID3D11DeviceContext1*
+queryContext1(ID3D11DeviceContext* context, ID3D11DeviceContext1*& cached) {
+	if (!cached && context)
+		context->QueryInterface(__uuidof(ID3D11DeviceContext1), reinterpret_cast<void**>(&cached));
+	return cached;
+}
+
+// Enlaza rangos de búferes constantes al vertex shader.
+void
+DeviceContext::VSSetConstantBuffers1(unsigned int StartSlot,
+	unsigned int NumBuffers,
+	ID3D11Buffer* const* ppConstantBuffers,
+	const unsigned int* pFirstConstant,
+	const unsigned int* pNumConstants) {
+
+	if (!ppConstantBuffers) {
+		ERROR("DeviceContext", "VSSetConstantBuffers1", "ppConstantBuffers is nullptr");
+		return;
+	}
+	ID3D11DeviceContext1* context1 = queryContext1(m_deviceContext, m_deviceContext1);
+	if (!context1) {
+		ERROR("DeviceContext", "VSSetConstantBuffers1", "ID3D11DeviceContext1 is not available");
+		return;
+	}
+
+	unsigned int first, count;
+	if (!m_stateCache.setConstantBufferRanges(StateCache::VERTEX_STAGE, StartSlot, NumBuffers,
+		reinterpret_cast<const void* const*>(ppConstantBuffers), pFirstConstant, pNumConstants, first, count))
+		return;
+	const unsigned int skip = first - StartSlot;
+	context1->VSSetConstantBuffers1(first, count, ppConstantBuffers + skip,
+		pFirstConstant ? pFirstConstant + skip : nullptr,
+		pNumConstants ? pNumConstants + skip : nullptr);
+}
+
+// Enlaza rangos de búferes constantes al pixel shader.
+void
+DeviceContext::PSSetConstantBuffers1(unsigned int StartSlot,
+	unsigned int NumBuffers,
+	ID3D11Buffer* const* ppConstantBuffers,
+	const unsigned int* pFirstConstant,
+	const unsigned int* pNumConstants) {
+
+	if (!ppConstantBuffers) {
+		ERROR("DeviceContext", "PSSetConstantBuffers1", "ppConstantBuffers is nullptr");
+		return;
+	}
+	ID3D11DeviceContext1* context1 = queryContext1(m_deviceContext, m_deviceContext1);
+	if (!context1) {
+		ERROR("DeviceContext", "PSSetConstantBuffers1", "ID3D11DeviceContext1 is not available");
+		return;
+	}
+
+	unsigned int first, count;
+	if (!m_stateCache.setConstantBufferRanges(StateCache::PIXEL_STAGE, StartSlot, NumBuffers,
+		reinterpret_cast<const void* const*>(ppConstantBuffers), pFirstConstant, pNumConstants, first, count))
+		return;
+	const unsigned int skip = first - StartSlot;
+	context1->PSSetConstantBuffers1(first, count, ppConstantBuffers + skip,
+		pFirstConstant ? pFirstConstant + skip : nullptr,
+		pNumConstants ? pNumConstants + skip : nullptr);
+}
+
+// Mapea un recurso dinámico para escribirlo desde la CPU.
+HRESULT
+DeviceContext::Map(ID3D11Resource* pResource,
+	unsigned int Subresource,
+	D3D11_MAP MapType,
+	unsigned int MapFlags,
+	D3D11_MAPPED_SUBRESOURCE* pMappedResource) {
+
+	if (!pResource || !pMappedResource) {
+		ERROR("DeviceContext", "Map", "pResource or pMappedResource is nullptr");
+		return E_INVALIDARG;
+	}
+	return m_deviceContext->Map(pResource, Subresource, MapType, MapFlags, pMappedResource);
+}
+
+// Desmapea un recurso.
+void
+DeviceContext::Unmap(ID3D11Resource* pResource, unsigned int Subresource) {
+	if (!pResource) {
+		ERROR("DeviceContext", "Unmap", "pResource is nullptr");
+		return;
+	}
+	m_deviceContext->Unmap(pResource, Subresource);
 }
 
 // Dibuja los índices de los vértices.
@@ -305,3 +486,153 @@ DeviceContext::DrawIndexed(unsigned int IndexCount,
 	// Ejecutamos el comando para dibujar los índices de vértices.
 	m_deviceContext->DrawIndexed(IndexCount, StartIndexLocation, BaseVertexLocation);
 }
+
+void
+DeviceContext::DrawIndexedInstanced(unsigned int IndexCountPerInstance,
+	unsigned int InstanceCount,
+	unsigned int StartIndexLocation,
+	int BaseVertexLocation,
+	unsigned int StartInstanceLocation) {
+
+	// Sin índices o sin instancias no hay nada que dibujar.
+	if (IndexCountPerInstance == 0 || InstanceCount == 0) {
+		ERROR("DeviceContext", "DrawIndexedInstanced", "IndexCountPerInstance or InstanceCount is zero");
+		return;
+	}
+
+	m_deviceContext->DrawIndexedInstanced(IndexCountPerInstance, InstanceCount,
+		StartIndexLocation, BaseVertexLocation, StartInstanceLocation);
+}
+
+namespace {
+	// Traduce los comandos neutrales de CommandList a llamadas del DeviceContext.
+	struct CommandListExecutor {
+		DeviceContext& context;
+
+		template<typename T>
+		static T* cast(const void* object) {
+			return static_cast<T*>(const_cast<void*>(object));
+		}
+
+		void setInputLayout(const void* inputLayout) {
+			context.IASetInputLayout(cast<ID3D11InputLayout>(inputLayout));
+		}
+		void setVertexBuffer(unsigned int slot, const void* buffer, unsigned int stride, unsigned int offset) {
+			ID3D11Buffer* vertexBuffer = cast<ID3D11Buffer>(buffer);
+			context.IASetVertexBuffers(slot, 1, &vertexBuffer, &stride, &offset);
+		}
+		void setIndexBuffer(const void* buffer, CommandList::IndexWidth width, unsigned int offset) {
+			context.IASetIndexBuffer(cast<ID3D11Buffer>(buffer),
+				width == CommandList::INDEX_16 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT,
+				offset);
+		}
+		void setPrimitiveTopology(unsigned int topology) {
+			context.IASetPrimitiveTopology((D3D11_PRIMITIVE_TOPOLOGY)topology);
+		}
+		void setShader(StateCache::Stage stage, const void* shader) {
+			if (stage == StateCache::VERTEX_STAGE)
+				context.VSSetShader(cast<ID3D11VertexShader>(shader), nullptr, 0);
+			else
+				context.PSSetShader(cast<ID3D11PixelShader>(shader), nullptr, 0);
+		}
+		void setConstantBuffer(StateCache::Stage stage, unsigned int slot, const void* buffer) {
+			ID3D11Buffer* constantBuffer = cast<ID3D11Buffer>(buffer);
+			if (stage == StateCache::VERTEX_STAGE)
+				context.VSSetConstantBuffers(slot, 1, &constantBuffer);
+			else
+				context.PSSetConstantBuffers(slot, 1, &constantBuffer);
+		}
+		void setConstantBufferRange(StateCache::Stage stage, unsigned int slot, const void* buffer,
+			unsigned int firstConstant, unsigned int numConstants) {
+			ID3D11Buffer* constantBuffer = cast<ID3D11Buffer>(buffer);
+			if (stage == StateCache::VERTEX_STAGE)
+				context.VSSetConstantBuffers1(slot, 1, &constantBuffer, &firstConstant, &numConstants);
+			else
+				context.PSSetConstantBuffers1(slot, 1, &constantBuffer, &firstConstant, &numConstants);
+		}
+		void setShaderResource(StateCache::Stage stage, unsigned int slot, const void* view) {
+			ID3D11ShaderResourceView* srv = cast<ID3D11ShaderResourceView>(view);
+			if (stage == StateCache::PIXEL_STAGE)
+				context.PSSetShaderResources(slot, 1, &srv);
+		}
+		void setSampler(StateCache::Stage stage, unsigned int slot, const void* sampler) {
+			ID3D11SamplerState* samplerState = cast<ID3D11SamplerState>(sampler);
+			if (stage == StateCache::PIXEL_STAGE)
+				context.PSSetSamplers(slot, 1, &samplerState);
+		}
+		void setViewport(const CommandList::Viewport& viewport) {
+			D3D11_VIEWPORT vp;
+			vp.TopLeftX = viewport.TopLeftX;
+			vp.TopLeftY = viewport.TopLeftY;
+			vp.Width = viewport.Width;
+			vp.Height = viewport.Height;
+			vp.MinDepth = viewport.MinDepth;
+			vp.MaxDepth = viewport.MaxDepth;
+			context.RSSetViewports(1, &vp);
+		}
+		void setRenderTargets(unsigned int numViews, const void* const* renderTargetViews, const void* depthStencilView) {
+			ID3D11RenderTargetView* views[8];
+			for (unsigned int i = 0; i < numViews; ++i)
+				views[i] = cast<ID3D11RenderTargetView>(renderTargetViews[i]);
+			context.OMSetRenderTargets(numViews, numViews ? views : nullptr,
+				cast<ID3D11DepthStencilView>(depthStencilView));
+		}
+		void updateConstantBuffer(const void* buffer, const void* data, unsigned int) {
+			context.UpdateSubresource(cast<ID3D11Buffer>(buffer), 0, nullptr, data, 0, 0);
+		}
+		void drawIndexed(unsigned int indexCount, unsigned int startIndexLocation, int baseVertexLocation) {
+			context.DrawIndexed(indexCount, startIndexLocation, baseVertexLocation);
+		}
+		void drawIndexedInstanced(unsigned int indexCountPerInstance, unsigned int instanceCount,
+			unsigned int startIndexLocation, int baseVertexLocation, unsigned int startInstanceLocation) {
+			context.DrawIndexedInstanced(indexCountPerInstance, instanceCount, startIndexLocation,
+				baseVertexLocation, startInstanceLocation);
+		}
+	};
+}
+
+// Reproduce una lista de comandos neutral sobre este contexto.
+void
+DeviceContext::executeCommandList(const CommandList& commandList) {
+	if (!m_deviceContext) {
+		ERROR("DeviceContext", "executeCommandList", "m_deviceContext is nullptr");
+		return;
+	}
+	CommandListExecutor executor{ *this };
+	commandList.replay(executor);
+}
+
+// Cierra la grabación de un contexto diferido y devuelve la lista de comandos de D3D11.
+HRESULT
+DeviceContext::FinishCommandList(bool RestoreDeferredContextState, ID3D11CommandList** ppCommandList) {
+	if (!ppCommandList) {
+		ERROR("DeviceContext", "FinishCommandList", "ppCommandList is nullptr");
+		return E_POINTER;
+	}
+
+	HRESULT hr = m_deviceContext->FinishCommandList(RestoreDeferredContextState ? TRUE : FALSE, ppCommandList);
+	if (FAILED(hr)) {
+		ERROR("DeviceContext", "FinishCommandList", "Failed to finish command list");
+		return hr;
+	}
+
+	// Sin restaurar, el contexto diferido vuelve al estado por defecto.
+	if (!RestoreDeferredContextState)
+		m_stateCache.invalidate();
+	return hr;
+}
+
+// Ejecuta una lista grabada en un contexto diferido.
+void
+DeviceContext::ExecuteCommandList(ID3D11CommandList* pCommandList, bool RestoreContextState) {
+	if (!pCommandList) {
+		ERROR("DeviceContext", "ExecuteCommandList", "pCommandList is nullptr");
+		return;
+	}
+
+	m_deviceContext->ExecuteCommandList(pCommandList, RestoreContextState ? TRUE : FALSE);
+
+	// Sin restaurar, el contexto inmediato queda en el estado por defecto.
+	if (!RestoreContextState)
+		m_stateCache.invalidate();
+}
@@ -0,0 +1,182 @@
+#include "FramePacer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+	// Límites superiores de las cubetas de jitter en milisegundos (la última no tiene).
+	const double JITTER_LIMITS_MS[] = { 0.25, 0.5, 1.0, 2.0, 4.0, 8.0, 16.0 };
+
+	// Mientras la GPU no termina un frame se duerme un poco entre consultas.
+	const double THROTTLE_POLL_SECONDS = 0.0002;
+}
+
+HRESULT
+FramePacer::init(double targetFps, unsigned int maxFramesInFlight) {
+	if (targetFps < 0.0 || maxFramesInFlight == 0) {
+		ERROR("FramePacer", "init", "targetFps must be >= 0 and maxFramesInFlight > 0");
+		return E_INVALIDARG;
+	}
+	m_targetFps = targetFps;
+	m_maxFramesInFlight = maxFramesInFlight;
+	m_presentedFrames = 0;
+	m_nextDeadline = 0.0;
+	m_lastPresent = 0.0;
+	m_averageInterval = 0.0;
+	resetStats();
+	return S_OK;
+}
+
+void
+FramePacer::setTargetFps(double targetFps) {
+	m_targetFps = targetFps > 0.0 ? targetFps : 0.0;
+	m_nextDeadline = 0.0;
+}
+
+void
+FramePacer::setCompletedFramesQuery(CompletedFramesQuery query, void* data) {
+	m_completedFrames = query;
+	m_completedFramesData = data;
+}
+
+void
+FramePacer::setClock(ClockFunction clock, SleepFunction sleepFunction, void* data) {
+	m_clock = clock;
+	m_sleep = sleepFunction;
+	m_clockData = data;
+	m_nextDeadline = 0.0;
+	m_lastPresent = 0.0;
+}
+
+double
+FramePacer::now() {
+	return std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+double
+FramePacer::currentTime() const {
+	return m_clock ? m_clock(m_clockData) : now();
+}
+
+void
+FramePacer::sleep(double seconds) {
+	if (m_sleep)
+		m_sleep(m_clockData, seconds);
+	else if (seconds > 0.0)
+		std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+	else
+		std::this_thread::yield();
+}
+
+// Duerme hasta m_spinSeconds antes de deadline y espera el resto girando.
+void
+FramePacer::waitUntil(double deadline) {
+	double current = currentTime();
+	const double sleepSeconds = deadline - current - m_spinSeconds;
+	if (sleepSeconds > 0.0) {
+		sleep(sleepSeconds);
+		current = currentTime();
+	}
+	while (current < deadline) {
+		sleep(0.0);
+		current = currentTime();
+	}
+}
+
+void
+FramePacer::beginFrame() {
+	// Frames en vuelo: sin hueco hasta que la GPU termine el más antiguo.
+	if (m_completedFrames) {
+		const double start = currentTime();
+		bool waited = false;
+		while (m_presentedFrames - std::min(m_presentedFrames, m_completedFrames(m_completedFramesData)) >=
+			m_maxFramesInFlight) {
+			sleep(THROTTLE_POLL_SECONDS);
+			waited = true;
+		}
+		if (waited)
+			m_stats.throttleSeconds += currentTime() - start;
+	}
+
+	// Tope de FPS.
+	if (m_targetFps > 0.0) {
+		const double interval = 1.0 / m_targetFps;
+		const double start = currentTime();
+		// Si se ha ido más de un intervalo por detrás, se vuelve a empezar desde ahora en vez
+		// de encadenar frames sin esperar para recuperar.
+		if (m_nextDeadline == 0.0 || start - m_nextDeadline > interval) {
+			m_nextDeadline = start;
+		}
+		else {
+			waitUntil(m_nextDeadline);
+			m_stats.capSeconds += currentTime() - start;
+		}
+		m_nextDeadline += interval;
+	}
+}
+
+void
+FramePacer::presented(double inputTime) {
+	const double current = currentTime();
+	++m_presentedFrames;
+	++m_stats.frames;
+
+	if (m_lastPresent > 0.0) {
+		const double interval = current - m_lastPresent;
+		const double intervalMs = interval * 1000.0;
+		m_intervalSum += intervalMs;
+		++m_intervals;
+		m_stats.minIntervalMs = m_intervals == 1 ? intervalMs : std::min(m_stats.minIntervalMs, intervalMs);
+		m_stats.maxIntervalMs = std::max(m_stats.maxIntervalMs, intervalMs);
+		m_stats.averageIntervalMs = m_intervalSum / m_intervals;
+
+		// Sin tope el objetivo es la media reciente: el jitter mide lo irregular, no lo lento.
+		m_averageInterval = m_averageInterval == 0.0 ? interval : m_averageInterval + (interval - m_averageInterval) * 0.05;
+		const double target = m_targetFps > 0.0 ? 1.0 / m_targetFps : m_averageInterval;
+		const double jitterMs = std::fabs(interval - target) * 1000.0;
+		m_jitterSum += jitterMs;
+		m_stats.averageJitterMs = m_jitterSum / m_intervals;
+		unsigned int bucket = 0;
+		while (bucket < JITTER_BUCKETS - 1 && jitterMs >= JITTER_LIMITS_MS[bucket])
+			++bucket;
+		++m_stats.jitter[bucket];
+	}
+	m_lastPresent = current;
+
+	if (inputTime > 0.0) {
+		const double latencyMs = (current - inputTime) * 1000.0;
+		m_latencySum += latencyMs;
+		++m_latencies;
+		m_stats.averageLatencyMs = m_latencySum / m_latencies;
+		m_stats.maxLatencyMs = std::max(m_stats.maxLatencyMs, latencyMs);
+		m_latencyMs[m_latencyNext] = (float)latencyMs;
+		m_latencyNext = (m_latencyNext + 1) % LATENCY_HISTORY;
+		if (m_latencyCount < LATENCY_HISTORY)
+			++m_latencyCount;
+	}
+}
+
+FramePacer::Stats
+FramePacer::getStats() const {
+	Stats stats = m_stats;
+	if (m_latencyCount > 0) {
+		float sorted[LATENCY_HISTORY];
+		std::copy(m_latencyMs, m_latencyMs + m_latencyCount, sorted);
+		std::sort(sorted, sorted + m_latencyCount);
+		stats.p99LatencyMs = sorted[(m_latencyCount * 99 + 99) / 100 - 1];
+	}
+	return stats;
+}
+
+void
+FramePacer::resetStats() {
+	m_stats = Stats();
+	m_intervalSum = 0.0;
+	m_intervals = 0;
+	m_jitterSum = 0.0;
+	m_latencySum = 0.0;
+	m_latencies = 0;
+	m_latencyCount = 0;
+	m_latencyNext = 0;
+}
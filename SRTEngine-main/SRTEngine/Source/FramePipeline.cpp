@@ -0,0 +1,118 @@
+#include "FramePipeline.h"
+#include <chrono>
+
+namespace {
+	double now() {
+		return std::chrono::duration<double>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+}
+
+FramePipeline::~FramePipeline() {
+	destroy();
+}
+
+HRESULT
+FramePipeline::init(unsigned int framesInFlight, SimulateFunction simulate, void* data) {
+	destroy();
+	if (framesInFlight == 0 || framesInFlight > MAX_FRAMES_IN_FLIGHT || simulate == nullptr) {
+		ERROR("FramePipeline", "init", "framesInFlight must be between 1 and MAX_FRAMES_IN_FLIGHT");
+		return E_INVALIDARG;
+	}
+
+	m_framesInFlight = framesInFlight;
+	m_simulate = simulate;
+	m_data = data;
+	m_simulatedFrames = 0;
+	m_renderedFrames = 0;
+	m_rendering = false;
+	m_quit = false;
+	m_stats = Stats();
+	if (m_framesInFlight > 1) {
+		m_thread = std::thread(&FramePipeline::simulationLoop, this);
+	}
+	return S_OK;
+}
+
+void
+FramePipeline::destroy() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_quit = true;
+	}
+	m_releasedCondition.notify_all();
+	if (m_thread.joinable()) {
+		m_thread.join();
+	}
+	m_framesInFlight = 0;
+	m_simulate = nullptr;
+	m_data = nullptr;
+}
+
+unsigned int
+FramePipeline::beginRender() {
+	if (m_framesInFlight <= 1) {
+		// Sin hilo de simulación: el frame se simula aquí mismo en el único hueco.
+		const double start = now();
+		m_simulate(m_data, 0);
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stats.simulateSeconds += now() - start;
+		++m_stats.simulated;
+		++m_simulatedFrames;
+		m_rendering = true;
+		return 0;
+	}
+
+	const double start = now();
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_simulatedCondition.wait(lock, [this] { return m_simulatedFrames > m_renderedFrames; });
+	m_stats.renderWaitSeconds += now() - start;
+	m_rendering = true;
+	return (unsigned int)(m_renderedFrames % m_framesInFlight);
+}
+
+void
+FramePipeline::endRender() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (!m_rendering)
+			return;
+		m_rendering = false;
+		++m_renderedFrames;
+		++m_stats.rendered;
+	}
+	m_releasedCondition.notify_one();
+}
+
+// Simula frames mientras haya huecos que el render ya soltó.
+void
+FramePipeline::simulationLoop() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (true) {
+		const double waitStart = now();
+		m_releasedCondition.wait(lock, [this] {
+			return m_quit || m_simulatedFrames - m_renderedFrames < m_framesInFlight;
+		});
+		if (m_quit)
+			return;
+		m_stats.simulateWaitSeconds += now() - waitStart;
+		const unsigned int slot = (unsigned int)(m_simulatedFrames % m_framesInFlight);
+
+		lock.unlock();
+		const double start = now();
+		m_simulate(m_data, slot);
+		const double seconds = now() - start;
+		lock.lock();
+
+		m_stats.simulateSeconds += seconds;
+		++m_stats.simulated;
+		++m_simulatedFrames;
+		m_simulatedCondition.notify_one();
+	}
+}
+
+FramePipeline::Stats
+FramePipeline::getStats() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
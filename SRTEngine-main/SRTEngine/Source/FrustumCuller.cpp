@@ -0,0 +1,252 @@
+#include "FrustumCuller.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(SRT_MATH_SSE) && defined(SRT_SIMD_AVX2)
+#include <immintrin.h>
+#define SRT_CULL_AVX2 1
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace {
+
+#if defined(SRT_MATH_SSE)
+	unsigned int lowestBit(uint32_t mask) {
+#if defined(_MSC_VER)
+		unsigned long index;
+		_BitScanForward(&index, mask);
+		return (unsigned int)index;
+#else
+		return (unsigned int)__builtin_ctz(mask);
+#endif
+	}
+
+	// Añade a la salida base + i por cada bit i de mask.
+	void appendMask(uint32_t mask, uint32_t base, uint32_t* out, unsigned int& count) {
+		while (mask != 0) {
+			out[count++] = base + lowestBit(mask);
+			mask &= mask - 1;
+		}
+	}
+#endif
+
+	// Versión escalar; las SIMD suman en el mismo orden, así que dan el mismo resultado.
+	bool sphereVisible(const Float4* planes, float x, float y, float z, float radius) {
+		for (int p = 0; p < FrustumCuller::PLANE_COUNT; ++p) {
+			const Float4& plane = planes[p];
+			const float distance = plane.x * x + plane.y * y + plane.z * z + plane.w;
+			if (!(distance >= -radius))
+				return false;
+		}
+		return true;
+	}
+
+	bool boxVisible(const Float4* planes, float x, float y, float z, float ex, float ey, float ez) {
+		for (int p = 0; p < FrustumCuller::PLANE_COUNT; ++p) {
+			const Float4& plane = planes[p];
+			const float distance = plane.x * x + plane.y * y + plane.z * z + plane.w;
+			const float radius = std::fabs(plane.x) * ex + std::fabs(plane.y) * ey + std::fabs(plane.z) * ez;
+			if (!(distance + radius >= 0.0f))
+				return false;
+		}
+		return true;
+	}
+
+#if defined(SRT_CULL_AVX2)
+	typedef __m256 Lanes;
+	const unsigned int LANES = 8;
+	inline Lanes lanesLoad(const float* p) { return _mm256_loadu_ps(p); }
+	inline Lanes lanesSet(float value) { return _mm256_set1_ps(value); }
+	inline Lanes lanesAdd(Lanes a, Lanes b) { return _mm256_add_ps(a, b); }
+	inline Lanes lanesMul(Lanes a, Lanes b) { return _mm256_mul_ps(a, b); }
+	inline Lanes lanesAnd(Lanes a, Lanes b) { return _mm256_and_ps(a, b); }
+	inline Lanes lanesGreaterEqual(Lanes a, Lanes b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+	inline uint32_t lanesMask(Lanes a) { return (uint32_t)_mm256_movemask_ps(a); }
+#elif defined(SRT_MATH_SSE)
+	typedef __m128 Lanes;
+	const unsigned int LANES = 4;
+	inline Lanes lanesLoad(const float* p) { return _mm_loadu_ps(p); }
+	inline Lanes lanesSet(float value) { return _mm_set1_ps(value); }
+	inline Lanes lanesAdd(Lanes a, Lanes b) { return _mm_add_ps(a, b); }
+	inline Lanes lanesMul(Lanes a, Lanes b) { return _mm_mul_ps(a, b); }
+	inline Lanes lanesAnd(Lanes a, Lanes b) { return _mm_and_ps(a, b); }
+	inline Lanes lanesGreaterEqual(Lanes a, Lanes b) { return _mm_cmpge_ps(a, b); }
+	inline uint32_t lanesMask(Lanes a) { return (uint32_t)_mm_movemask_ps(a); }
+#endif
+
+	unsigned int cullSphereRange(const Float4* planes, const BoundingSpheres& spheres,
+		unsigned int begin, unsigned int end, uint32_t* out) {
+		unsigned int visible = 0;
+		unsigned int i = begin;
+#if defined(SRT_MATH_SSE)
+		Lanes a[FrustumCuller::PLANE_COUNT], b[FrustumCuller::PLANE_COUNT];
+		Lanes c[FrustumCuller::PLANE_COUNT], d[FrustumCuller::PLANE_COUNT];
+		for (int p = 0; p < FrustumCuller::PLANE_COUNT; ++p) {
+			a[p] = lanesSet(planes[p].x);
+			b[p] = lanesSet(planes[p].y);
+			c[p] = lanesSet(planes[p].z);
+			d[p] = lanesSet(planes[p].w);
+		}
+		const Lanes zero = lanesSet(0.0f);
+		for (; i + LANES <= end; i += LANES) {
+			const Lanes x = lanesLoad(&spheres.centerX[i]);
+			const Lanes y = lanesLoad(&spheres.centerY[i]);
+			const Lanes z = lanesLoad(&spheres.centerZ[i]);
+			const Lanes negRadius = lanesMul(lanesLoad(&spheres.radius[i]), lanesSet(-1.0f));
+			Lanes inside = lanesGreaterEqual(zero, zero);
+			for (int p = 0; p < FrustumCuller::PLANE_COUNT; ++p) {
+				const Lanes distance = lanesAdd(lanesAdd(lanesAdd(lanesMul(a[p], x), lanesMul(b[p], y)),
+					lanesMul(c[p], z)), d[p]);
+				inside = lanesAnd(inside, lanesGreaterEqual(distance, negRadius));
+			}
+			appendMask(lanesMask(inside), i, out, visible);
+		}
+#endif
+		for (; i < end; ++i) {
+			if (sphereVisible(planes, spheres.centerX[i], spheres.centerY[i], spheres.centerZ[i], spheres.radius[i]))
+				out[visible++] = i;
+		}
+		return visible;
+	}
+
+	unsigned int cullBoxRange(const Float4* planes, const BoundingBoxes& boxes,
+		unsigned int begin, unsigned int end, uint32_t* out) {
+		unsigned int visible = 0;
+		unsigned int i = begin;
+#if defined(SRT_MATH_SSE)
+		Lanes a[FrustumCuller::PLANE_COUNT], b[FrustumCuller::PLANE_COUNT];
+		Lanes c[FrustumCuller::PLANE_COUNT], d[FrustumCuller::PLANE_COUNT];
+		Lanes absA[FrustumCuller::PLANE_COUNT], absB[FrustumCuller::PLANE_COUNT];
+		Lanes absC[FrustumCuller::PLANE_COUNT];
+		for (int p = 0; p < FrustumCuller::PLANE_COUNT; ++p) {
+			a[p] = lanesSet(planes[p].x);
+			b[p] = lanesSet(planes[p].y);
+			c[p] = lanesSet(planes[p].z);
+			d[p] = lanesSet(planes[p].w);
+			absA[p] = lanesSet(std::fabs(planes[p].x));
+			absB[p] = lanesSet(std::fabs(planes[p].y));
+			absC[p] = lanesSet(std::fabs(planes[p].z));
+		}
+		const Lanes zero = lanesSet(0.0f);
+		for (; i + LANES <= end; i += LANES) {
+			const Lanes x = lanesLoad(&boxes.centerX[i]);
+			const Lanes y = lanesLoad(&boxes.centerY[i]);
+			const Lanes z = lanesLoad(&boxes.centerZ[i]);
+			const Lanes ex = lanesLoad(&boxes.extentX[i]);
+			const Lanes ey = lanesLoad(&boxes.extentY[i]);
+			const Lanes ez = lanesLoad(&boxes.extentZ[i]);
+			Lanes inside = lanesGreaterEqual(zero, zero);
+			for (int p = 0; p < FrustumCuller::PLANE_COUNT; ++p) {
+				const Lanes distance = lanesAdd(lanesAdd(lanesAdd(lanesMul(a[p], x), lanesMul(b[p], y)),
+					lanesMul(c[p], z)), d[p]);
+				const Lanes radius = lanesAdd(lanesAdd(lanesMul(absA[p], ex), lanesMul(absB[p], ey)),
+					lanesMul(absC[p], ez));
+				inside = lanesAnd(inside, lanesGreaterEqual(lanesAdd(distance, radius), zero));
+			}
+			appendMask(lanesMask(inside), i, out, visible);
+		}
+#endif
+		for (; i < end; ++i) {
+			if (boxVisible(planes, boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i],
+				boxes.extentX[i], boxes.extentY[i], boxes.extentZ[i]))
+				out[visible++] = i;
+		}
+		return visible;
+	}
+}
+
+HRESULT
+FrustumCuller::init(JobSystem* jobs) {
+	m_jobs = jobs;
+	m_stats = Stats();
+	return S_OK;
+}
+
+void
+FrustumCuller::destroy() {
+	m_jobs = nullptr;
+	m_stats = Stats();
+}
+
+void
+FrustumCuller::setFrustum(const Matrix& view, const Matrix& projection) {
+	extractPlanes(MatrixMultiply(view, projection), m_planes);
+}
+
+// Con vectores fila clip = v * M, así que cada plano es una combinación de columnas de M.
+void
+FrustumCuller::extractPlanes(const Matrix& viewProjection, Float4 planes[PLANE_COUNT]) {
+	const Matrix columns = MatrixTranspose(viewProjection);
+	Vector result[PLANE_COUNT];
+	result[PLANE_LEFT] = VectorAdd(columns.r[3], columns.r[0]);
+	result[PLANE_RIGHT] = VectorSubtract(columns.r[3], columns.r[0]);
+	result[PLANE_BOTTOM] = VectorAdd(columns.r[3], columns.r[1]);
+	result[PLANE_TOP] = VectorSubtract(columns.r[3], columns.r[1]);
+	result[PLANE_NEAR] = columns.r[2];
+	result[PLANE_FAR] = VectorSubtract(columns.r[3], columns.r[2]);
+	for (int p = 0; p < PLANE_COUNT; ++p) {
+		const float length = VectorGetX(Vector3Length(result[p]));
+		VectorStore(planes[p], length > 0.0f ? VectorScale(result[p], 1.0f / length) : result[p]);
+	}
+}
+
+void
+FrustumCuller::cullSpheres(const BoundingSpheres& spheres, std::vector<uint32_t>& visible) {
+	m_spheres = &spheres;
+	cull(spheres.size(), visible, [](FrustumCuller* self, unsigned int chunk) {
+		const unsigned int begin = chunk * BOUNDS_CHUNK;
+		const unsigned int end = std::min(self->m_count, begin + BOUNDS_CHUNK);
+		self->m_chunkVisible[chunk] = cullSphereRange(self->m_planes, *self->m_spheres, begin, end,
+			self->m_output + begin);
+	});
+	m_spheres = nullptr;
+}
+
+void
+FrustumCuller::cullBoxes(const BoundingBoxes& boxes, std::vector<uint32_t>& visible) {
+	m_boxes = &boxes;
+	cull(boxes.size(), visible, [](FrustumCuller* self, unsigned int chunk) {
+		const unsigned int begin = chunk * BOUNDS_CHUNK;
+		const unsigned int end = std::min(self->m_count, begin + BOUNDS_CHUNK);
+		self->m_chunkVisible[chunk] = cullBoxRange(self->m_planes, *self->m_boxes, begin, end,
+			self->m_output + begin);
+	});
+	m_boxes = nullptr;
+}
+
+// Cada bloque escribe a partir de su primer índice; luego se juntan los tramos en orden.
+void
+FrustumCuller::cull(unsigned int count, std::vector<uint32_t>& visible,
+	void (*job)(FrustumCuller*, unsigned int)) {
+	const unsigned int chunks = (count + BOUNDS_CHUNK - 1) / BOUNDS_CHUNK;
+	visible.resize(count);
+	m_count = count;
+	m_output = visible.data();
+	m_chunkVisible.assign(chunks, 0);
+	if (m_jobs) {
+		m_jobs->parallelFor(chunks, 1, [&](unsigned int begin, unsigned int end) {
+			for (unsigned int chunk = begin; chunk < end; ++chunk)
+				job(this, chunk);
+		});
+	}
+	else {
+		for (unsigned int chunk = 0; chunk < chunks; ++chunk)
+			job(this, chunk);
+	}
+
+	unsigned int total = 0;
+	for (unsigned int chunk = 0; chunk < chunks; ++chunk) {
+		const unsigned int chunkVisible = m_chunkVisible[chunk];
+		if (total != chunk * BOUNDS_CHUNK && chunkVisible > 0) {
+			std::memmove(m_output + total, m_output + chunk * BOUNDS_CHUNK, chunkVisible * sizeof(uint32_t));
+		}
+		total += chunkVisible;
+	}
+	visible.resize(total);
+	m_output = nullptr;
+
+	m_stats.tested = count;
+	m_stats.visible = total;
+}
@@ -0,0 +1,93 @@
+#include "InstanceBatcher.h"
+#include <algorithm>
+
+void
+InstanceBatcher::clear() {
+	m_unsorted.clear();
+	m_batchOf.clear();
+	m_sorted.clear();
+	m_batches.clear();
+	m_batchIndex.clear();
+	m_lastKey = ~0ull;
+	m_lastBatch = 0;
+	m_inOrder = true;
+}
+
+void
+InstanceBatcher::reserve(unsigned int instanceCount) {
+	m_unsorted.reserve(instanceCount);
+	m_batchOf.reserve(instanceCount);
+	m_sorted.reserve(instanceCount);
+}
+
+void
+InstanceBatcher::add(uint32_t mesh, uint32_t material, const Matrix& world, const Float4& color, uint32_t userData) {
+	const uint64_t key = batchKey(mesh, material);
+	if (key != m_lastKey) {
+		auto found = m_batchIndex.find(key);
+		if (found == m_batchIndex.end()) {
+			// Un lote nuevo solo mantiene el orden si va después del último por malla y material.
+			if (!m_batches.empty() && key < batchKey(m_batches.back().mesh, m_batches.back().material))
+				m_inOrder = false;
+			Batch batch;
+			batch.mesh = mesh;
+			batch.material = material;
+			batch.userData = userData;
+			found = m_batchIndex.emplace(key, (uint32_t)m_batches.size()).first;
+			m_batches.push_back(batch);
+		}
+		else {
+			// Volver a un lote anterior rompe la contigüidad.
+			m_inOrder = false;
+		}
+		m_lastKey = key;
+		m_lastBatch = found->second;
+	}
+
+	InstanceData instance;
+	VectorStore(instance.world[0], world.r[0]);
+	VectorStore(instance.world[1], world.r[1]);
+	VectorStore(instance.world[2], world.r[2]);
+	VectorStore(instance.world[3], world.r[3]);
+	instance.color = color;
+	m_unsorted.push_back(instance);
+	m_batchOf.push_back(m_lastBatch);
+	++m_batches[m_lastBatch].instanceCount;
+}
+
+// Ordenación por conteo: los lotes se ordenan entre sí (son pocos) y cada instancia se copia
+// una sola vez a su sitio, así que el coste es lineal en el número de instancias.
+void
+InstanceBatcher::build() {
+	if (m_inOrder) {
+		// Caso habitual (objetos ya agrupados): basta con numerar los lotes y reutilizar el búfer.
+		unsigned int first = 0;
+		for (Batch& batch : m_batches) {
+			batch.firstInstance = first;
+			first += batch.instanceCount;
+		}
+		m_sorted.swap(m_unsorted);
+		m_unsorted.clear();
+		return;
+	}
+
+	std::vector<Batch> ordered(m_batches);
+	std::sort(ordered.begin(), ordered.end(), [](const Batch& a, const Batch& b) {
+		return a.mesh != b.mesh ? a.mesh < b.mesh : a.material < b.material;
+	});
+
+	// Cursor de escritura de cada lote, indexado por su posición en orden de llegada.
+	std::vector<unsigned int> cursor(m_batches.size());
+	unsigned int first = 0;
+	for (Batch& batch : ordered) {
+		batch.firstInstance = first;
+		cursor[m_batchIndex[batchKey(batch.mesh, batch.material)]] = first;
+		first += batch.instanceCount;
+	}
+
+	m_sorted.resize(m_unsorted.size());
+	for (size_t i = 0; i < m_unsorted.size(); ++i) {
+		m_sorted[cursor[m_batchOf[i]]++] = m_unsorted[i];
+	}
+	m_batches.swap(ordered);
+}
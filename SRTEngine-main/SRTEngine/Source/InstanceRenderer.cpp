@@ -0,0 +1,324 @@
+#include "InstanceRenderer.h"
+#include <chrono>
+#include <cstring>
+#ifdef _WIN32
+#include "Device.h"
+#include "DeviceContext.h"
+#endif
+
+namespace {
+#ifdef _WIN32
+	// Mismos registros que TurtleEngine.fx; la matriz de mundo llega por instancia en filas.
+	const char g_instanceShaderSource[] =
+		"cbuffer cbNeverChanges : register(b0) { matrix View; };\n"
+		"cbuffer cbChangeOnResize : register(b1) { matrix Projection; };\n"
+		"Texture2D txDiffuse : register(t0);\n"
+		"SamplerState samLinear : register(s0);\n"
+		"struct VS_INPUT {\n"
+		"    float4 Pos : POSITION;\n"
+		"    float2 Tex : TEXCOORD0;\n"
+		"    float4 World0 : WORLD0;\n"
+		"    float4 World1 : WORLD1;\n"
+		"    float4 World2 : WORLD2;\n"
+		"    float4 World3 : WORLD3;\n"
+		"    float4 Color : COLOR0;\n"
+		"};\n"
+		"struct PS_INPUT {\n"
+		"    float4 Pos : SV_POSITION;\n"
+		"    float2 Tex : TEXCOORD0;\n"
+		"    float4 Color : COLOR0;\n"
+		"};\n"
+		"PS_INPUT VS(VS_INPUT input) {\n"
+		"    float4x4 world = float4x4(input.World0, input.World1, input.World2, input.World3);\n"
+		"    PS_INPUT output;\n"
+		"    output.Pos = mul(float4(input.Pos.xyz, 1.0f), world);\n"
+		"    output.Pos = mul(output.Pos, View);\n"
+		"    output.Pos = mul(output.Pos, Projection);\n"
+		"    output.Tex = input.Tex;\n"
+		"    output.Color = input.Color;\n"
+		"    return output;\n"
+		"}\n"
+		"float4 PS(PS_INPUT input) : SV_Target {\n"
+		"    return txDiffuse.Sample(samLinear, input.Tex) * input.Color;\n"
+		"}\n";
+
+	HRESULT
+	compileInstanceShader(const char* entryPoint, const char* shaderModel, ID3DBlob** blob) {
+		DWORD flags = D3DCOMPILE_ENABLE_STRICTNESS;
+#if defined(DEBUG) || defined(_DEBUG)
+		flags |= D3DCOMPILE_DEBUG;
+#endif
+		ID3DBlob* errorBlob = nullptr;
+		HRESULT hr = D3DCompile(g_instanceShaderSource, sizeof(g_instanceShaderSource) - 1, "InstanceRenderer",
+			nullptr, nullptr, entryPoint, shaderModel, flags, 0, blob, &errorBlob);
+		if (errorBlob) {
+			OutputDebugStringA((char*)errorBlob->GetBufferPointer());
+			errorBlob->Release();
+		}
+		return hr;
+	}
+#endif
+}
+
+HRESULT
+InstanceRenderer::init(Device* device, DeviceContext* deviceContext, unsigned int maxInstances,
+	const VertexFormat* vertexFormat) {
+	destroy();
+	if (maxInstances == 0) {
+		ERROR("InstanceRenderer", "init", "maxInstances must be greater than 0");
+		return E_INVALIDARG;
+	}
+	if ((device == nullptr) != (deviceContext == nullptr)) {
+		ERROR("InstanceRenderer", "init", "device and deviceContext must both be set or both be nullptr");
+		return E_INVALIDARG;
+	}
+
+	if (vertexFormat) {
+		if (!vertexFormat->find(SEMANTIC_POSITION) || !vertexFormat->find(SEMANTIC_TEXCOORD) ||
+			vertexFormat->find(SEMANTIC_COLOR)) {
+			ERROR("InstanceRenderer", "init", "vertexFormat needs POSITION and TEXCOORD and cannot have COLOR");
+			return E_INVALIDARG;
+		}
+		m_vertexFormat = *vertexFormat;
+	}
+	else {
+		m_vertexFormat.clear();
+		m_vertexFormat.add(SEMANTIC_POSITION, ENCODING_FLOAT3);
+		m_vertexFormat.add(SEMANTIC_TEXCOORD, ENCODING_FLOAT2);
+	}
+
+	m_device = device;
+	m_deviceContext = deviceContext;
+	m_capacity = maxInstances;
+	m_head = 0;
+
+#ifdef _WIN32
+	if (m_device) {
+		HRESULT hr = createShaders();
+		if (FAILED(hr))
+			return hr;
+		return createInstanceBuffer(maxInstances);
+	}
+#endif
+
+	m_cpuInstances.reserve(maxInstances);
+	return S_OK;
+}
+
+void
+InstanceRenderer::destroy() {
+#ifdef _WIN32
+	SAFE_RELEASE(m_instanceBuffer);
+	SAFE_RELEASE(m_vertexShader);
+	SAFE_RELEASE(m_pixelShader);
+	SAFE_RELEASE(m_inputLayout);
+#endif
+	m_meshes.clear();
+	m_cpuInstances.clear();
+	m_cpuInstances.shrink_to_fit();
+	m_materialFunction = nullptr;
+	m_materialData = nullptr;
+	m_capacity = 0;
+	m_head = 0;
+	m_device = nullptr;
+	m_deviceContext = nullptr;
+	m_stats = Stats();
+}
+
+InstanceRenderer::MeshHandle
+InstanceRenderer::addMesh(const Mesh& mesh) {
+	if (mesh.indexCount == 0) {
+		ERROR("InstanceRenderer", "addMesh", "indexCount is zero");
+		return INVALID_MESH;
+	}
+#ifdef _WIN32
+	if (m_device && (!mesh.vertexBuffer || !mesh.indexBuffer || mesh.vertexStride == 0)) {
+		ERROR("InstanceRenderer", "addMesh", "Invalid vertex or index buffer");
+		return INVALID_MESH;
+	}
+#endif
+	m_meshes.push_back(mesh);
+	return (MeshHandle)(m_meshes.size() - 1);
+}
+
+void
+InstanceRenderer::setMaterialFunction(MaterialFunction function, void* data) {
+	m_materialFunction = function;
+	m_materialData = data;
+}
+
+// Un Map para todas las instancias del frame y un dibujo por lote.
+void
+InstanceRenderer::submit(const InstanceBatcher& batcher, unsigned int minInstances) {
+	const auto start = std::chrono::steady_clock::now();
+	m_stats = Stats();
+
+	const unsigned int count = batcher.getInstanceCount();
+	if (count == 0 || m_capacity == 0)
+		return;
+
+	// Si ningún lote llega al mínimo no se sube nada ni se cambian los shaders.
+	bool anyBatch = false;
+	for (const InstanceBatcher::Batch& batch : batcher.getBatches()) {
+		if (batch.instanceCount >= minInstances) {
+			anyBatch = true;
+			break;
+		}
+	}
+	if (!anyBatch) {
+		m_stats.batches = (unsigned int)batcher.getBatches().size();
+		m_stats.skippedBatches = m_stats.batches;
+		return;
+	}
+
+	unsigned int first = 0;
+#ifdef _WIN32
+	if (m_device) {
+		// Si el frame no cabe entero se recrea el búfer; si no cabe a continuación, se da la vuelta.
+		bool discard = false;
+		if (count > m_capacity) {
+			unsigned int capacity = m_capacity * 2;
+			if (capacity < count)
+				capacity = count;
+			if (FAILED(createInstanceBuffer(capacity)))
+				return;
+			++m_stats.bufferGrows;
+		}
+		if (m_head == 0 || m_head + count > m_capacity) {
+			m_head = 0;
+			discard = true;
+		}
+
+		D3D11_MAPPED_SUBRESOURCE mapped;
+		HRESULT hr = m_deviceContext->Map(m_instanceBuffer, 0,
+			discard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mapped);
+		if (FAILED(hr)) {
+			ERROR("InstanceRenderer", "submit", "Failed to map instance buffer");
+			return;
+		}
+		memcpy(static_cast<InstanceData*>(mapped.pData) + m_head, batcher.getInstances(), count * sizeof(InstanceData));
+		m_deviceContext->Unmap(m_instanceBuffer, 0);
+		first = m_head;
+		m_head += count;
+
+		const unsigned int instanceStride = sizeof(InstanceData);
+		const unsigned int instanceOffset = 0;
+		m_deviceContext->IASetVertexBuffers(1, 1, &m_instanceBuffer, &instanceStride, &instanceOffset);
+		m_deviceContext->IASetInputLayout(m_inputLayout);
+		m_deviceContext->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+		m_deviceContext->VSSetShader(m_vertexShader, nullptr, 0);
+		m_deviceContext->PSSetShader(m_pixelShader, nullptr, 0);
+	}
+	else
+#endif
+	{
+		m_cpuInstances.assign(batcher.getInstances(), batcher.getInstances() + count);
+	}
+	m_stats.bytesUploaded = (uint64_t)count * sizeof(InstanceData);
+
+	// Los lotes llegan ordenados por malla y material: solo se cambia lo que cambia.
+	uint32_t boundMesh = INVALID_MESH;
+	uint32_t boundMaterial = ~0u;
+	for (const InstanceBatcher::Batch& batch : batcher.getBatches()) {
+		if (batch.instanceCount < minInstances) {
+			++m_stats.skippedBatches;
+			continue;
+		}
+		if (batch.mesh >= m_meshes.size()) {
+			ERROR("InstanceRenderer", "submit", "Batch references an unknown mesh");
+			continue;
+		}
+		const Mesh& mesh = m_meshes[batch.mesh];
+		if (batch.mesh != boundMesh) {
+#ifdef _WIN32
+			if (m_deviceContext) {
+				const unsigned int vertexOffset = 0;
+				m_deviceContext->IASetVertexBuffers(0, 1, &mesh.vertexBuffer, &mesh.vertexStride, &vertexOffset);
+				m_deviceContext->IASetIndexBuffer(mesh.indexBuffer, mesh.indexFormat, 0);
+			}
+#endif
+			boundMesh = batch.mesh;
+		}
+		if (batch.material != boundMaterial) {
+			if (m_materialFunction)
+				m_materialFunction(m_materialData, batch.material);
+			boundMaterial = batch.material;
+		}
+
+#ifdef _WIN32
+		if (m_deviceContext)
+			m_deviceContext->DrawIndexedInstanced(mesh.indexCount, batch.instanceCount, mesh.startIndexLocation,
+				mesh.baseVertexLocation, first + batch.firstInstance);
+#else
+		(void)mesh;
+		(void)first;
+#endif
+		++m_stats.drawCalls;
+		m_stats.instances += batch.instanceCount;
+	}
+	m_stats.batches = (unsigned int)batcher.getBatches().size();
+	m_stats.submitSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+#ifdef _WIN32
+HRESULT
+InstanceRenderer::createShaders() {
+	ID3DBlob* vsBlob = nullptr;
+	HRESULT hr = compileInstanceShader("VS", "vs_4_0", &vsBlob);
+	if (FAILED(hr)) {
+		ERROR("InstanceRenderer", "createShaders", "Failed to compile instanced vertex shader");
+		return hr;
+	}
+	hr = m_device->CreateVertexShader(vsBlob->GetBufferPointer(), vsBlob->GetBufferSize(), nullptr, &m_vertexShader);
+	if (FAILED(hr)) {
+		vsBlob->Release();
+		return hr;
+	}
+
+	// Ranura 0: vértices de la malla (m_vertexFormat). Ranura 1: InstanceData, una vez por instancia.
+	const D3D11_INPUT_ELEMENT_DESC instanceLayout[] = {
+		{ "WORLD", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 0, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+		{ "WORLD", 1, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 16, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+		{ "WORLD", 2, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 32, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+		{ "WORLD", 3, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 48, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+		{ "COLOR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 1, 64, D3D11_INPUT_PER_INSTANCE_DATA, 1 },
+	};
+	std::vector<D3D11_INPUT_ELEMENT_DESC> layout;
+	m_vertexFormat.getInputElements(layout, 0);
+	layout.insert(layout.end(), instanceLayout, instanceLayout + ARRAYSIZE(instanceLayout));
+	hr = m_device->CreateInputLayout(layout.data(), (UINT)layout.size(), vsBlob->GetBufferPointer(),
+		vsBlob->GetBufferSize(), &m_inputLayout);
+	vsBlob->Release();
+	if (FAILED(hr))
+		return hr;
+
+	ID3DBlob* psBlob = nullptr;
+	hr = compileInstanceShader("PS", "ps_4_0", &psBlob);
+	if (FAILED(hr)) {
+		ERROR("InstanceRenderer", "createShaders", "Failed to compile instanced pixel shader");
+		return hr;
+	}
+	hr = m_device->CreatePixelShader(psBlob->GetBufferPointer(), psBlob->GetBufferSize(), nullptr, &m_pixelShader);
+	psBlob->Release();
+	return hr;
+}
+
+HRESULT
+InstanceRenderer::createInstanceBuffer(unsigned int capacity) {
+	SAFE_RELEASE(m_instanceBuffer);
+	D3D11_BUFFER_DESC bd = {};
+	bd.Usage = D3D11_USAGE_DYNAMIC;
+	bd.ByteWidth = capacity * sizeof(InstanceData);
+	bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	HRESULT hr = m_device->CreateBuffer(&bd, nullptr, &m_instanceBuffer);
+	if (FAILED(hr)) {
+		ERROR("InstanceRenderer", "createInstanceBuffer", "Failed to create instance buffer");
+		m_capacity = 0;
+		return hr;
+	}
+	m_capacity = capacity;
+	m_head = 0;
+	return S_OK;
+}
+#endif
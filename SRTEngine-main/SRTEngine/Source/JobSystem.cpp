@@ -0,0 +1,261 @@
+#include "JobSystem.h"
+
+namespace {
+
+	// Vueltas sin trabajo antes de dormir el hilo.
+	const unsigned int IDLE_SPINS = 64;
+
+	// Sistema y cola del hilo actual (nullptr fuera de los hilos de un JobSystem).
+	thread_local const JobSystem* t_system = nullptr;
+	thread_local unsigned int t_queue = 0;
+
+	std::atomic<uint64_t> s_nextCounterId{ 1 };
+}
+
+uint64_t
+JobCounter::nextId() {
+	return s_nextCounterId.fetch_add(1, std::memory_order_relaxed);
+}
+
+JobSystem::~JobSystem() {
+	destroy();
+}
+
+HRESULT
+JobSystem::init(unsigned int threadCount) {
+	destroy();
+	if (threadCount == 0) {
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+	for (unsigned int i = 0; i < threadCount; ++i) {
+		m_queues.emplace_back(new WorkQueue());
+	}
+	m_quit = false;
+	t_system = this;
+	t_queue = 0;
+	for (unsigned int i = 1; i < threadCount; ++i) {
+		m_workers.emplace_back(&JobSystem::workerLoop, this, i);
+	}
+	return S_OK;
+}
+
+void
+JobSystem::destroy() {
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_quit = true;
+	}
+	m_wakeCondition.notify_all();
+	for (std::thread& worker : m_workers) {
+		worker.join();
+	}
+	m_workers.clear();
+	m_queues.clear();
+	m_queuedJobs = 0;
+	m_dependents.clear();
+	m_dependentCount = 0;
+	if (t_system == this)
+		t_system = nullptr;
+}
+
+// Hilo 0 para el que llamó a init() y para cualquier hilo ajeno al sistema.
+unsigned int
+JobSystem::currentQueue() const {
+	return t_system == this ? t_queue : 0;
+}
+
+void
+JobSystem::run(JobFunction function, void* data, unsigned int jobCount, JobCounter* counter) {
+	if (jobCount == 0)
+		return;
+	if (counter)
+		counter->m_pending.fetch_add(jobCount, std::memory_order_relaxed);
+	enqueue(function, data, jobCount, counter);
+}
+
+void
+JobSystem::runAfter(JobCounter& dependency, JobFunction function, void* data, unsigned int jobCount,
+	JobCounter* counter) {
+	if (jobCount == 0)
+		return;
+	// El contador cuenta desde ahora, aunque los trabajos se encolen más tarde.
+	if (counter)
+		counter->m_pending.fetch_add(jobCount, std::memory_order_relaxed);
+	{
+		// m_dependentCount sube antes de mirar el contador: si finish() lo deja a cero después,
+		// verá que hay dependencias y esperará al mutex para recogerlas.
+		std::lock_guard<std::mutex> lock(m_dependentMutex);
+		m_dependentCount.fetch_add(1);
+		if (dependency.m_pending.load() != 0) {
+			m_dependents.push_back(Dependent{ dependency.m_id, function, data, jobCount, counter });
+			return;
+		}
+		m_dependentCount.fetch_sub(1);
+	}
+	enqueue(function, data, jobCount, counter);
+}
+
+// Encola un lote cuyo contador ya se incrementó.
+void
+JobSystem::enqueue(JobFunction function, void* data, unsigned int jobCount, JobCounter* counter) {
+	if (m_queues.empty()) {
+		// Sin init() todo se ejecuta en el hilo que llama.
+		for (unsigned int i = 0; i < jobCount; ++i) {
+			function(data, i);
+			if (counter)
+				finish(*counter);
+		}
+		return;
+	}
+
+	// Se encolan al revés para que el dueño, que saca del final, empiece por el índice 0.
+	m_queuedJobs.fetch_add(jobCount);
+	WorkQueue& queue = *m_queues[currentQueue()];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		for (unsigned int i = jobCount; i-- > 0;) {
+			queue.jobs.push_back(Job{ function, data, i, counter });
+		}
+	}
+
+	// Si algún hilo se está durmiendo, se toma el mutex para no perder el aviso.
+	if (m_sleepingWorkers.load() > 0) {
+		{
+			std::lock_guard<std::mutex> lock(m_sleepMutex);
+		}
+		if (jobCount == 1)
+			m_wakeCondition.notify_one();
+		else
+			m_wakeCondition.notify_all();
+	}
+}
+
+void
+JobSystem::wait(JobCounter& counter) {
+	const unsigned int queueIndex = currentQueue();
+	unsigned int idle = 0;
+	while (!counter.isDone()) {
+		Job job;
+		if (!m_queues.empty() && popOrSteal(queueIndex, job)) {
+			execute(queueIndex, job);
+			idle = 0;
+		}
+		else if (++idle > IDLE_SPINS) {
+			std::this_thread::yield();
+		}
+	}
+}
+
+// Primero el final de la cola propia; si está vacía, el principio de las demás.
+bool
+JobSystem::popOrSteal(unsigned int queueIndex, Job& job) {
+	if (m_queuedJobs.load(std::memory_order_relaxed) == 0)
+		return false;
+
+	{
+		WorkQueue& own = *m_queues[queueIndex];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if (own.jobs.size() > own.head) {
+			job = own.jobs.back();
+			own.jobs.pop_back();
+			if (own.jobs.size() == own.head) {
+				own.jobs.clear();
+				own.head = 0;
+			}
+			m_queuedJobs.fetch_sub(1);
+			return true;
+		}
+	}
+
+	const unsigned int queueCount = (unsigned int)m_queues.size();
+	for (unsigned int offset = 1; offset < queueCount; ++offset) {
+		WorkQueue& victim = *m_queues[(queueIndex + offset) % queueCount];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (victim.jobs.size() > victim.head) {
+			job = victim.jobs[victim.head++];
+			if (victim.jobs.size() == victim.head) {
+				victim.jobs.clear();
+				victim.head = 0;
+			}
+			else if (victim.head > 64 && victim.head * 2 > victim.jobs.size()) {
+				victim.jobs.erase(victim.jobs.begin(), victim.jobs.begin() + victim.head);
+				victim.head = 0;
+			}
+			m_queuedJobs.fetch_sub(1);
+			m_queues[queueIndex]->stolen.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+	return false;
+}
+
+void
+JobSystem::execute(unsigned int queueIndex, const Job& job) {
+	job.function(job.data, job.index);
+	m_queues[queueIndex]->executed.fetch_add(1, std::memory_order_relaxed);
+	if (job.counter)
+		finish(*job.counter);
+}
+
+// El último trabajo de un contador encola los lotes que esperaban por él. En cuanto el
+// contador llega a cero quien lo espera puede destruirlo, así que después solo se usa su id.
+void
+JobSystem::finish(JobCounter& counter) {
+	const uint64_t id = counter.m_id;
+	if (counter.m_pending.fetch_sub(1) != 1)
+		return;
+	if (m_dependentCount.load() == 0)
+		return;
+
+	std::vector<Dependent> ready;
+	{
+		std::lock_guard<std::mutex> lock(m_dependentMutex);
+		size_t kept = 0;
+		for (size_t i = 0; i < m_dependents.size(); ++i) {
+			if (m_dependents[i].dependency == id)
+				ready.push_back(m_dependents[i]);
+			else
+				m_dependents[kept++] = m_dependents[i];
+		}
+		m_dependents.resize(kept);
+		m_dependentCount.fetch_sub((unsigned int)ready.size());
+	}
+	for (const Dependent& dependent : ready) {
+		enqueue(dependent.function, dependent.data, dependent.jobCount, dependent.counter);
+	}
+}
+
+void
+JobSystem::workerLoop(unsigned int queueIndex) {
+	t_system = this;
+	t_queue = queueIndex;
+	unsigned int idle = 0;
+	while (!m_quit.load(std::memory_order_relaxed)) {
+		Job job;
+		if (popOrSteal(queueIndex, job)) {
+			execute(queueIndex, job);
+			idle = 0;
+			continue;
+		}
+		if (++idle < IDLE_SPINS) {
+			std::this_thread::yield();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_sleepMutex);
+		m_sleepingWorkers.fetch_add(1);
+		m_wakeCondition.wait(lock, [&] { return m_quit.load() || m_queuedJobs.load() > 0; });
+		m_sleepingWorkers.fetch_sub(1);
+		idle = 0;
+	}
+}
+
+JobSystem::Stats
+JobSystem::getStats() const {
+	Stats stats;
+	for (const std::unique_ptr<WorkQueue>& queue : m_queues) {
+		stats.executed += queue->executed.load(std::memory_order_relaxed);
+		stats.stolen += queue->stolen.load(std::memory_order_relaxed);
+	}
+	return stats;
+}
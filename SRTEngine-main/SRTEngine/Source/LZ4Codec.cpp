@@ -0,0 +1,160 @@
+#include "LZ4Codec.h"
+#include <cstring>
+
+namespace {
+
+	const size_t MIN_MATCH = 4;
+	const size_t LAST_LITERALS = 5;   // El formato exige que los últimos 5 bytes sean literales.
+	const size_t MATCH_LIMIT = 12;    // Y que la última coincidencia empiece 12 bytes antes del final.
+	const size_t MAX_OFFSET = 65535;
+	const unsigned int HASH_BITS = 16;
+	const uint32_t EMPTY = 0xFFFFFFFF;
+
+	uint32_t read32(const uint8_t* p) {
+		uint32_t value;
+		std::memcpy(&value, p, sizeof(value));
+		return value;
+	}
+
+	uint32_t hashSequence(uint32_t sequence) {
+		return (sequence * 2654435761u) >> (32 - HASH_BITS);
+	}
+
+	// Longitudes de 15 o más siguen en bytes de 255 hasta uno menor.
+	uint8_t* writeLength(uint8_t* out, size_t length) {
+		while (length >= 255) {
+			*out++ = 255;
+			length -= 255;
+		}
+		*out++ = (uint8_t)length;
+		return out;
+	}
+
+	uint8_t* writeSequence(uint8_t* out, const uint8_t* literals, size_t literalCount,
+		size_t offset, size_t matchLength) {
+		uint8_t* token = out++;
+		*token = (uint8_t)((literalCount >= 15 ? 15 : literalCount) << 4);
+		if (literalCount >= 15)
+			out = writeLength(out, literalCount - 15);
+		if (literalCount > 0)
+			std::memcpy(out, literals, literalCount);
+		out += literalCount;
+
+		if (matchLength == 0)
+			return out; // Última secuencia: solo literales.
+
+		*out++ = (uint8_t)(offset & 0xFF);
+		*out++ = (uint8_t)(offset >> 8);
+		const size_t code = matchLength - MIN_MATCH;
+		*token |= (uint8_t)(code >= 15 ? 15 : code);
+		if (code >= 15)
+			out = writeLength(out, code - 15);
+		return out;
+	}
+
+	// Lee una longitud extendida; false si se sale del bloque.
+	bool readLength(const uint8_t*& in, const uint8_t* end, size_t& length) {
+		uint8_t byte;
+		do {
+			if (in >= end)
+				return false;
+			byte = *in++;
+			length += byte;
+		} while (byte == 255);
+		return true;
+	}
+}
+
+size_t
+LZ4Codec::compressBound(size_t size) {
+	return size + size / 255 + 16;
+}
+
+void
+LZ4Codec::compress(const uint8_t* data, size_t size, std::vector<uint8_t>& compressed) {
+	compressed.resize(compressBound(size));
+	uint8_t* out = compressed.data();
+	size_t anchor = 0;
+
+	if (size > MATCH_LIMIT) {
+		std::vector<uint32_t> table((size_t)1 << HASH_BITS, EMPTY);
+		const size_t limit = size - MATCH_LIMIT;
+		size_t pos = 0;
+		while (pos < limit) {
+			const uint32_t sequence = read32(data + pos);
+			const uint32_t hash = hashSequence(sequence);
+			const uint32_t candidate = table[hash];
+			table[hash] = (uint32_t)pos;
+
+			if (candidate == EMPTY || pos - candidate > MAX_OFFSET || read32(data + candidate) != sequence) {
+				// Sin coincidencia: avanza más deprisa cuanto más tiempo lleva sin encontrar ninguna.
+				pos += 1 + ((pos - anchor) >> 6);
+				continue;
+			}
+
+			size_t length = MIN_MATCH;
+			const size_t matchEnd = size - LAST_LITERALS;
+			while (pos + length < matchEnd && data[candidate + length] == data[pos + length])
+				++length;
+
+			out = writeSequence(out, data + anchor, pos - anchor, pos - candidate, length);
+			pos += length;
+			anchor = pos;
+			if (pos >= 2 && pos < limit)
+				table[hashSequence(read32(data + pos - 2))] = (uint32_t)(pos - 2);
+		}
+	}
+
+	out = writeSequence(out, data + anchor, size - anchor, 0, 0);
+	compressed.resize((size_t)(out - compressed.data()));
+}
+
+bool
+LZ4Codec::decompress(const uint8_t* compressed, size_t compressedSize, uint8_t* output, size_t outputSize) {
+	const uint8_t* in = compressed;
+	const uint8_t* end = compressed + compressedSize;
+	uint8_t* out = output;
+	uint8_t* outEnd = output + outputSize;
+
+	while (in < end) {
+		const uint8_t token = *in++;
+		size_t literals = token >> 4;
+		if (literals == 15 && !readLength(in, end, literals))
+			return false;
+		if ((size_t)(end - in) < literals || (size_t)(outEnd - out) < literals)
+			return false;
+		if (literals > 0)
+			std::memcpy(out, in, literals);
+		in += literals;
+		out += literals;
+
+		if (in == end)
+			break; // La última secuencia no lleva coincidencia.
+
+		if (end - in < 2)
+			return false;
+		const size_t offset = (size_t)in[0] | ((size_t)in[1] << 8);
+		in += 2;
+		if (offset == 0 || offset > (size_t)(out - output))
+			return false;
+
+		size_t length = token & 15;
+		if (length == 15 && !readLength(in, end, length))
+			return false;
+		length += MIN_MATCH;
+		if ((size_t)(outEnd - out) < length)
+			return false;
+
+		// La copia puede solaparse con lo que escribe (offset < longitud repite un patrón).
+		const uint8_t* match = out - offset;
+		if (offset >= length) {
+			std::memcpy(out, match, length);
+			out += length;
+		}
+		else {
+			for (size_t i = 0; i < length; ++i)
+				*out++ = match[i];
+		}
+	}
+	return out == outEnd;
+}
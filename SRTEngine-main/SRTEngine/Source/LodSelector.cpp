@@ -0,0 +1,65 @@
+#include "LodSelector.h"
+#include <cmath>
+
+HRESULT
+LodSelector::init(const Options& options) {
+	if (options.maxPixelError <= 0.0f || options.hysteresis < 0.0f || options.hysteresis >= 1.0f) {
+		ERROR("LodSelector", "init", "Invalid pixel error or hysteresis");
+		return E_INVALIDARG;
+	}
+	m_options = options;
+	m_current.clear();
+	m_stats = Stats();
+	return S_OK;
+}
+
+void
+LodSelector::destroy() {
+	m_current.clear();
+	m_current.shrink_to_fit();
+	m_stats = Stats();
+}
+
+void
+LodSelector::beginFrame(const Matrix& view, const Matrix& projection, float viewportHeight) {
+	VectorStore(m_eye, MatrixInverse(view).r[3]);
+	m_pixelScale = VectorGetY(projection.r[1]) * viewportHeight * 0.5f;
+	m_stats = Stats();
+}
+
+float
+LodSelector::getPixelError(const Float3& center, float radius, float error) const {
+	const float dx = center.x - m_eye.x, dy = center.y - m_eye.y, dz = center.z - m_eye.z;
+	const float distance = sqrtf(dx * dx + dy * dy + dz * dz) - radius;
+	if (distance <= 0.0f)
+		return error > 0.0f ? INFINITY : 0.0f;
+	return error * m_pixelScale / distance;
+}
+
+// Se prueba del nivel más simple al más detallado; el primero que cumple su umbral se queda.
+unsigned int
+LodSelector::select(uint32_t object, const Float3& center, float radius, const float* lodErrors,
+	unsigned int lodCount, float scale) {
+	if (lodCount == 0)
+		return 0;
+	if (object >= m_current.size())
+		m_current.resize(object + 1, 0);
+	const unsigned int current = m_current[object] < lodCount ? m_current[object] : lodCount - 1;
+	const float pixelsPerError = getPixelError(center, radius, scale);
+
+	unsigned int lod = 0;
+	for (unsigned int level = lodCount - 1; level > 0; --level) {
+		const float limit = level > current ?
+			m_options.maxPixelError * (1.0f - m_options.hysteresis) : m_options.maxPixelError;
+		if (lodErrors[level] * pixelsPerError <= limit) {
+			lod = level;
+			break;
+		}
+	}
+
+	++m_stats.objects;
+	if (lod != m_current[object])
+		++m_stats.switches;
+	m_current[object] = (uint8_t)lod;
+	return lod;
+}
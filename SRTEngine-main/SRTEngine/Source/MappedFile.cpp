@@ -0,0 +1,82 @@
+#include "MappedFile.h"
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+// Proyecta el archivo en memoria de solo lectura.
+HRESULT
+MappedFile::open(const std::string& fileName) {
+	close();
+
+	size_t size = 0;
+#ifdef _WIN32
+	m_file = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_file == INVALID_HANDLE_VALUE) {
+		ERROR("MappedFile", "open", ("Cannot open " + fileName).c_str());
+		return E_FAIL;
+	}
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart == 0) {
+		ERROR("MappedFile", "open", ("Empty or unreadable file " + fileName).c_str());
+		close();
+		return E_FAIL;
+	}
+	size = (size_t)fileSize.QuadPart;
+	m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mapping) {
+		m_view = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+	}
+#else
+	const int fd = ::open(fileName.c_str(), O_RDONLY);
+	if (fd < 0) {
+		ERROR("MappedFile", "open", ("Cannot open " + fileName).c_str());
+		return E_FAIL;
+	}
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size == 0) {
+		ERROR("MappedFile", "open", ("Empty or unreadable file " + fileName).c_str());
+		::close(fd);
+		return E_FAIL;
+	}
+	size = (size_t)info.st_size;
+	void* view = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd); // La proyección sigue viva sin el descriptor.
+	if (view != MAP_FAILED) {
+		m_view = static_cast<const uint8_t*>(view);
+	}
+#endif
+	if (!m_view) {
+		ERROR("MappedFile", "open", ("Cannot map " + fileName).c_str());
+		close();
+		return E_FAIL;
+	}
+	m_size = size;
+	return S_OK;
+}
+
+void
+MappedFile::close() {
+#ifdef _WIN32
+	if (m_view)
+		UnmapViewOfFile(m_view);
+	if (m_mapping)
+		CloseHandle(m_mapping);
+	if (m_file != INVALID_HANDLE_VALUE)
+		CloseHandle(m_file);
+	m_mapping = nullptr;
+	m_file = INVALID_HANDLE_VALUE;
+#else
+	if (m_view)
+		munmap(const_cast<uint8_t*>(m_view), m_size);
+#endif
+	m_view = nullptr;
+	m_size = 0;
+}
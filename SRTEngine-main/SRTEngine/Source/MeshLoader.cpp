@@ -0,0 +1,1184 @@
+#include "MeshLoader.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+
+namespace {
+	const unsigned int INVALID_INDEX = ~0u;
+	const size_t OBJ_MIN_CHUNK = 1 << 20;        // Tramos de al menos 1 MB de texto.
+	const unsigned int DECODE_GRAIN = 16384;      // Vértices o índices por trabajo al decodificar.
+	const unsigned int MAX_NODE_DEPTH = 64;       // Jerarquías más profundas se consideran corruptas.
+
+	const double POW10[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+
+	double
+	timeSince(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// ---------------------------------------------------------------------------------------
+	// Tokenizer: funciones sobre punteros al texto, sin copiar ni reservar memoria.
+	// ---------------------------------------------------------------------------------------
+
+	inline bool
+	isBlank(char c) {
+		return c == ' ' || c == '\t' || c == '\r';
+	}
+
+	inline void
+	skipBlanks(const char*& p, const char* end) {
+		while (p < end && isBlank(*p))
+			++p;
+	}
+
+	inline void
+	skipLine(const char*& p, const char* end) {
+		const void* newline = memchr(p, '\n', end - p);
+		p = newline ? static_cast<const char*>(newline) + 1 : end;
+	}
+
+	/// Número decimal con signo, parte fraccionaria y exponente (sin depender del locale).
+	bool
+	parseDouble(const char*& p, const char* end, double& value) {
+		const char* s = p;
+		bool negative = false;
+		if (s < end && (*s == '-' || *s == '+')) {
+			negative = *s == '-';
+			++s;
+		}
+
+		uint64_t mantissa = 0;
+		int exponent = 0;
+		int digits = 0;
+		bool any = false;
+		for (; s < end && *s >= '0' && *s <= '9'; ++s, any = true) {
+			if (digits < 19) {
+				mantissa = mantissa * 10 + (uint64_t)(*s - '0');
+				if (mantissa)
+					++digits;
+			}
+			else {
+				++exponent;
+			}
+		}
+		if (s < end && *s == '.') {
+			for (++s; s < end && *s >= '0' && *s <= '9'; ++s, any = true) {
+				if (digits < 19) {
+					mantissa = mantissa * 10 + (uint64_t)(*s - '0');
+					if (mantissa)
+						++digits;
+					--exponent;
+				}
+			}
+		}
+		if (!any)
+			return false;
+		if (s < end && (*s == 'e' || *s == 'E')) {
+			const char* e = s + 1;
+			bool negativeExponent = false;
+			if (e < end && (*e == '-' || *e == '+')) {
+				negativeExponent = *e == '-';
+				++e;
+			}
+			if (e < end && *e >= '0' && *e <= '9') {
+				int written = 0;
+				for (; e < end && *e >= '0' && *e <= '9'; ++e) {
+					if (written < 10000)
+						written = written * 10 + (*e - '0');
+				}
+				exponent += negativeExponent ? -written : written;
+				s = e;
+			}
+		}
+
+		double result = (double)mantissa;
+		if (mantissa != 0) {
+			while (exponent > 22) {
+				result *= POW10[22];
+				exponent -= 22;
+			}
+			while (exponent < -22) {
+				result /= POW10[22];
+				exponent += 22;
+			}
+			result = exponent >= 0 ? result * POW10[exponent] : result / POW10[-exponent];
+		}
+		value = negative ? -result : result;
+		p = s;
+		return true;
+	}
+
+	inline bool
+	parseFloat(const char*& p, const char* end, float& value) {
+		double number;
+		if (!parseDouble(p, end, number))
+			return false;
+		value = (float)number;
+		return true;
+	}
+
+	inline bool
+	parseInt(const char*& p, const char* end, int& value) {
+		const char* s = p;
+		bool negative = false;
+		if (s < end && (*s == '-' || *s == '+')) {
+			negative = *s == '-';
+			++s;
+		}
+		if (s == end || *s < '0' || *s > '9')
+			return false;
+		int64_t result = 0;
+		for (; s < end && *s >= '0' && *s <= '9'; ++s) {
+			if (result < INT32_MAX)
+				result = result * 10 + (*s - '0');
+		}
+		if (result > INT32_MAX)
+			result = INT32_MAX;
+		value = (int)(negative ? -result : result);
+		p = s;
+		return true;
+	}
+
+	// ---------------------------------------------------------------------------------------
+	// OBJ
+	// ---------------------------------------------------------------------------------------
+
+	/// Esquina de un triángulo: índices en base 0 (texCoord -1 = sin UV).
+	struct ObjCorner {
+		int32_t position;
+		int32_t texCoord;
+	};
+
+	/// Resultado de analizar un tramo de líneas.
+	struct ObjChunk {
+		const char* begin = nullptr;
+		const char* end = nullptr;
+		std::vector<Float3> positions;
+		std::vector<Float2> texCoords;
+		std::vector<ObjCorner> corners;
+		std::vector<uint8_t> relative; ///< Por esquina, desde el primer índice negativo: bit 0 posición, bit 1 UV.
+		bool hasRelative = false;
+		unsigned int firstPosition = 0;
+		unsigned int firstTexCoord = 0;
+		unsigned int firstCorner = 0;
+		bool failed = false;
+	};
+
+	/// Índice de cara OBJ: positivo en base 1 o negativo relativo a lo leído hasta ahora.
+	inline int32_t
+	objIndex(int value, size_t countSoFar, bool& relative) {
+		relative = value < 0;
+		return relative ? (int32_t)countSoFar + value : value - 1;
+	}
+
+	void
+	parseObjChunk(ObjChunk& chunk) {
+		const char* p = chunk.begin;
+		const char* end = chunk.end;
+		std::vector<ObjCorner> polygon;
+		std::vector<uint8_t> polygonRelative;
+
+		while (p < end) {
+			skipBlanks(p, end);
+			if (p + 1 >= end) {
+				skipLine(p, end);
+				continue;
+			}
+
+			if (p[0] == 'v' && isBlank(p[1])) {
+				Float3 position;
+				p += 2;
+				skipBlanks(p, end);
+				bool ok = parseFloat(p, end, position.x);
+				skipBlanks(p, end);
+				ok = ok && parseFloat(p, end, position.y);
+				skipBlanks(p, end);
+				ok = ok && parseFloat(p, end, position.z);
+				if (!ok) {
+					chunk.failed = true;
+					return;
+				}
+				chunk.positions.push_back(position);
+			}
+			else if (p[0] == 'v' && p[1] == 't' && p + 2 < end && isBlank(p[2])) {
+				Float2 texCoord(0.0f, 0.0f);
+				p += 3;
+				skipBlanks(p, end);
+				if (!parseFloat(p, end, texCoord.x)) {
+					chunk.failed = true;
+					return;
+				}
+				skipBlanks(p, end);
+				parseFloat(p, end, texCoord.y); // La v es opcional.
+				chunk.texCoords.push_back(texCoord);
+			}
+			else if (p[0] == 'f' && isBlank(p[1])) {
+				p += 2;
+				polygon.clear();
+				polygonRelative.clear();
+				bool anyRelative = false;
+				for (;;) {
+					skipBlanks(p, end);
+					if (p >= end || *p == '\n' || *p == '#')
+						break;
+
+					int value = 0;
+					if (!parseInt(p, end, value) || value == 0) {
+						chunk.failed = true;
+						return;
+					}
+					ObjCorner corner;
+					bool positionRelative = false;
+					bool texCoordRelative = false;
+					corner.position = objIndex(value, chunk.positions.size(), positionRelative);
+					corner.texCoord = -1;
+					if (p < end && *p == '/') {
+						++p;
+						if (p < end && *p != '/') {
+							if (!parseInt(p, end, value) || value == 0) {
+								chunk.failed = true;
+								return;
+							}
+							corner.texCoord = objIndex(value, chunk.texCoords.size(), texCoordRelative);
+						}
+						if (p < end && *p == '/') {
+							++p;
+							parseInt(p, end, value); // La normal no se usa.
+						}
+					}
+					polygon.push_back(corner);
+					polygonRelative.push_back((uint8_t)((positionRelative ? 1 : 0) | (texCoordRelative ? 2 : 0)));
+					anyRelative = anyRelative || positionRelative || texCoordRelative;
+				}
+				if (polygon.size() < 3) {
+					chunk.failed = true;
+					return;
+				}
+
+				// Los índices relativos se guardan respecto al principio del tramo.
+				if (anyRelative && !chunk.hasRelative) {
+					chunk.relative.assign(chunk.corners.size(), 0);
+					chunk.hasRelative = true;
+				}
+				for (size_t i = 1; i + 1 < polygon.size(); ++i) {
+					const size_t fan[3] = { 0, i, i + 1 };
+					for (size_t corner : fan) {
+						chunk.corners.push_back(polygon[corner]);
+						if (chunk.hasRelative)
+							chunk.relative.push_back(polygonRelative[corner]);
+					}
+				}
+			}
+			skipLine(p, end);
+		}
+	}
+
+	// ---------------------------------------------------------------------------------------
+	// JSON (solo lo que hace falta para glTF: sin decodificar escapes en las cadenas)
+	// ---------------------------------------------------------------------------------------
+
+	class JsonDocument {
+	public:
+		enum Type : uint8_t { JSON_NULL, JSON_BOOL, JSON_NUMBER, JSON_STRING, JSON_ARRAY, JSON_OBJECT };
+
+		struct Node {
+			Type type = JSON_NULL;
+			const char* key = nullptr;  ///< Nombre del miembro si el padre es un objeto.
+			uint32_t keyLength = 0;
+			const char* text = nullptr; ///< Contenido de la cadena (sin comillas).
+			uint32_t length = 0;
+			double number = 0.0;
+			uint32_t firstChild = INVALID_INDEX;
+			uint32_t next = INVALID_INDEX;
+		};
+
+		bool parse(const char* begin, const char* end) {
+			m_nodes.clear();
+			m_end = end;
+			const char* p = begin;
+			if (parseValue(p, 0) == INVALID_INDEX)
+				return false;
+			skipWhitespace(p);
+			return p == end || *p == '\0';
+		}
+
+		const Node& node(uint32_t index) const { return m_nodes[index]; }
+
+		uint32_t member(uint32_t object, const char* name) const {
+			if (object == INVALID_INDEX || m_nodes[object].type != JSON_OBJECT)
+				return INVALID_INDEX;
+			const size_t nameLength = strlen(name);
+			for (uint32_t child = m_nodes[object].firstChild; child != INVALID_INDEX; child = m_nodes[child].next) {
+				const Node& n = m_nodes[child];
+				if (n.keyLength == nameLength && memcmp(n.key, name, nameLength) == 0)
+					return child;
+			}
+			return INVALID_INDEX;
+		}
+
+		/// Elementos de un array (vacío si no es un array).
+		std::vector<uint32_t> elements(uint32_t array) const {
+			std::vector<uint32_t> result;
+			if (array != INVALID_INDEX && m_nodes[array].type == JSON_ARRAY) {
+				for (uint32_t child = m_nodes[array].firstChild; child != INVALID_INDEX; child = m_nodes[child].next)
+					result.push_back(child);
+			}
+			return result;
+		}
+
+		double number(uint32_t object, const char* name, double fallback) const {
+			const uint32_t n = member(object, name);
+			return n != INVALID_INDEX && m_nodes[n].type == JSON_NUMBER ? m_nodes[n].number : fallback;
+		}
+
+		int integer(uint32_t object, const char* name, int fallback) const {
+			return (int)number(object, name, fallback);
+		}
+
+		bool boolean(uint32_t object, const char* name) const {
+			const uint32_t n = member(object, name);
+			return n != INVALID_INDEX && m_nodes[n].type == JSON_BOOL && m_nodes[n].number != 0.0;
+		}
+
+		/// Lee hasta count números de un array miembro; devuelve cuántos leyó.
+		unsigned int numbers(uint32_t object, const char* name, float* values, unsigned int count) const {
+			unsigned int read = 0;
+			const uint32_t array = member(object, name);
+			if (array == INVALID_INDEX || m_nodes[array].type != JSON_ARRAY)
+				return 0;
+			for (uint32_t child = m_nodes[array].firstChild; child != INVALID_INDEX && read < count; child = m_nodes[child].next) {
+				if (m_nodes[child].type == JSON_NUMBER)
+					values[read++] = (float)m_nodes[child].number;
+			}
+			return read;
+		}
+
+	private:
+		static const unsigned int MAX_DEPTH = 128;
+
+		void skipWhitespace(const char*& p) const {
+			while (p < m_end && (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r'))
+				++p;
+		}
+
+		bool parseString(const char*& p, const char*& text, uint32_t& length) const {
+			if (p >= m_end || *p != '"')
+				return false;
+			const char* s = ++p;
+			while (p < m_end && *p != '"') {
+				if (*p == '\\')
+					++p;
+				++p;
+			}
+			if (p >= m_end)
+				return false;
+			text = s;
+			length = (uint32_t)(p - s);
+			++p;
+			return true;
+		}
+
+		bool matchLiteral(const char*& p, const char* literal) const {
+			const size_t length = strlen(literal);
+			if ((size_t)(m_end - p) < length || memcmp(p, literal, length) != 0)
+				return false;
+			p += length;
+			return true;
+		}
+
+		uint32_t parseValue(const char*& p, unsigned int depth) {
+			skipWhitespace(p);
+			if (p >= m_end || depth > MAX_DEPTH)
+				return INVALID_INDEX;
+
+			const uint32_t index = (uint32_t)m_nodes.size();
+			m_nodes.emplace_back();
+			switch (*p) {
+			case '{':
+			case '[': {
+				const bool object = *p == '{';
+				const char close = object ? '}' : ']';
+				m_nodes[index].type = object ? JSON_OBJECT : JSON_ARRAY;
+				++p;
+				skipWhitespace(p);
+				if (p < m_end && *p == close) {
+					++p;
+					return index;
+				}
+				uint32_t last = INVALID_INDEX;
+				for (;;) {
+					const char* key = nullptr;
+					uint32_t keyLength = 0;
+					if (object) {
+						skipWhitespace(p);
+						if (!parseString(p, key, keyLength))
+							return INVALID_INDEX;
+						skipWhitespace(p);
+						if (p >= m_end || *p != ':')
+							return INVALID_INDEX;
+						++p;
+					}
+					const uint32_t child = parseValue(p, depth + 1);
+					if (child == INVALID_INDEX)
+						return INVALID_INDEX;
+					m_nodes[child].key = key;
+					m_nodes[child].keyLength = keyLength;
+					if (last == INVALID_INDEX)
+						m_nodes[index].firstChild = child;
+					else
+						m_nodes[last].next = child;
+					last = child;
+
+					skipWhitespace(p);
+					if (p < m_end && *p == ',') {
+						++p;
+						continue;
+					}
+					if (p < m_end && *p == close) {
+						++p;
+						return index;
+					}
+					return INVALID_INDEX;
+				}
+			}
+			case '"':
+				m_nodes[index].type = JSON_STRING;
+				return parseString(p, m_nodes[index].text, m_nodes[index].length) ? index : INVALID_INDEX;
+			case 't':
+			case 'f':
+				m_nodes[index].type = JSON_BOOL;
+				m_nodes[index].number = *p == 't' ? 1.0 : 0.0;
+				return matchLiteral(p, *p == 't' ? "true" : "false") ? index : INVALID_INDEX;
+			case 'n':
+				return matchLiteral(p, "null") ? index : INVALID_INDEX;
+			default:
+				m_nodes[index].type = JSON_NUMBER;
+				return parseDouble(p, m_end, m_nodes[index].number) ? index : INVALID_INDEX;
+			}
+		}
+
+		std::vector<Node> m_nodes;
+		const char* m_end = nullptr;
+	};
+
+	// ---------------------------------------------------------------------------------------
+	// glTF
+	// ---------------------------------------------------------------------------------------
+
+	const uint32_t GLB_MAGIC = 0x46546C67;      // "glTF"
+	const uint32_t GLB_CHUNK_JSON = 0x4E4F534A; // "JSON"
+	const uint32_t GLB_CHUNK_BIN = 0x004E4942;  // "BIN\0"
+
+	enum ComponentType {
+		COMPONENT_BYTE = 5120,
+		COMPONENT_UNSIGNED_BYTE = 5121,
+		COMPONENT_SHORT = 5122,
+		COMPONENT_UNSIGNED_SHORT = 5123,
+		COMPONENT_UNSIGNED_INT = 5125,
+		COMPONENT_FLOAT = 5126
+	};
+
+	const int PRIMITIVE_TRIANGLES = 4;
+
+	struct ByteRange {
+		const uint8_t* data = nullptr;
+		size_t size = 0;
+	};
+
+	struct BufferView {
+		ByteRange range;
+		unsigned int stride = 0; ///< 0 = elementos seguidos.
+	};
+
+	/// Accessor ya resuelto a un puntero y un paso en bytes.
+	struct Accessor {
+		const uint8_t* data = nullptr;
+		unsigned int count = 0;
+		unsigned int componentType = 0;
+		unsigned int components = 0;
+		unsigned int stride = 0;
+		bool normalized = false;
+	};
+
+	struct Primitive {
+		int position = -1;
+		int texCoord = -1;
+		int indices = -1;
+		Matrix world;
+		unsigned int firstVertex = 0;
+		unsigned int vertexCount = 0;
+		unsigned int firstIndex = 0;
+		unsigned int indexCount = 0;
+	};
+
+	unsigned int
+	componentSize(unsigned int componentType) {
+		switch (componentType) {
+		case COMPONENT_BYTE:
+		case COMPONENT_UNSIGNED_BYTE:
+			return 1;
+		case COMPONENT_SHORT:
+		case COMPONENT_UNSIGNED_SHORT:
+			return 2;
+		case COMPONENT_UNSIGNED_INT:
+		case COMPONENT_FLOAT:
+			return 4;
+		default:
+			return 0;
+		}
+	}
+
+	unsigned int
+	componentCount(const JsonDocument::Node& type) {
+		if (type.type != JsonDocument::JSON_STRING)
+			return 0;
+		const char* names[] = { "SCALAR", "VEC2", "VEC3", "VEC4" };
+		for (unsigned int i = 0; i < 4; ++i) {
+			if (type.length == strlen(names[i]) && memcmp(type.text, names[i], type.length) == 0)
+				return i + 1;
+		}
+		return 0;
+	}
+
+	/// Componente como float, normalizado si el accessor lo pide.
+	inline float
+	readComponent(const uint8_t* p, unsigned int componentType, bool normalized) {
+		switch (componentType) {
+		case COMPONENT_FLOAT: {
+			float value;
+			memcpy(&value, p, 4);
+			return value;
+		}
+		case COMPONENT_UNSIGNED_BYTE:
+			return normalized ? *p / 255.0f : (float)*p;
+		case COMPONENT_BYTE: {
+			const float value = (float)(int8_t)*p;
+			return normalized ? std::max(value / 127.0f, -1.0f) : value;
+		}
+		case COMPONENT_UNSIGNED_SHORT: {
+			uint16_t value;
+			memcpy(&value, p, 2);
+			return normalized ? value / 65535.0f : (float)value;
+		}
+		case COMPONENT_SHORT: {
+			int16_t value;
+			memcpy(&value, p, 2);
+			return normalized ? std::max(value / 32767.0f, -1.0f) : (float)value;
+		}
+		default:
+			return 0.0f;
+		}
+	}
+
+	inline uint32_t
+	readIndex(const uint8_t* p, unsigned int componentType) {
+		switch (componentType) {
+		case COMPONENT_UNSIGNED_BYTE:
+			return *p;
+		case COMPONENT_UNSIGNED_SHORT: {
+			uint16_t value;
+			memcpy(&value, p, 2);
+			return value;
+		}
+		default: {
+			uint32_t value;
+			memcpy(&value, p, 4);
+			return value;
+		}
+		}
+	}
+
+	int
+	base64Value(char c) {
+		if (c >= 'A' && c <= 'Z') return c - 'A';
+		if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+		if (c >= '0' && c <= '9') return c - '0' + 52;
+		if (c == '+' || c == '-') return 62;
+		if (c == '/' || c == '_') return 63;
+		return -1;
+	}
+
+	bool
+	decodeBase64(const char* text, size_t length, std::vector<uint8_t>& out) {
+		out.clear();
+		out.reserve(length / 4 * 3);
+		uint32_t accumulator = 0;
+		int bits = 0;
+		for (size_t i = 0; i < length; ++i) {
+			if (text[i] == '=')
+				break;
+			const int value = base64Value(text[i]);
+			if (value < 0)
+				return false;
+			accumulator = (accumulator << 6) | (uint32_t)value;
+			bits += 6;
+			if (bits >= 8) {
+				bits -= 8;
+				out.push_back((uint8_t)(accumulator >> bits));
+			}
+		}
+		return true;
+	}
+
+	Matrix
+	nodeTransform(const JsonDocument& json, uint32_t node) {
+		float values[16];
+		if (json.numbers(node, "matrix", values, 16) == 16) {
+			// glTF guarda por columnas para vectores columna: leído por filas es la matriz
+			// equivalente para vectores fila (v * M) que usa el motor.
+			return MatrixLoad(values);
+		}
+		float t[3] = { 0.0f, 0.0f, 0.0f };
+		float r[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+		float s[3] = { 1.0f, 1.0f, 1.0f };
+		json.numbers(node, "translation", t, 3);
+		json.numbers(node, "rotation", r, 4);
+		json.numbers(node, "scale", s, 3);
+		return MatrixScaleRotationTranslation(VectorSet(s[0], s[1], s[2], 0.0f),
+			VectorSet(r[0], r[1], r[2], r[3]), VectorSet(t[0], t[1], t[2], 0.0f));
+	}
+}
+
+HRESULT
+MeshLoader::init(JobSystem* jobs) {
+	m_jobs = jobs;
+	m_stats = Stats();
+	return S_OK;
+}
+
+void
+MeshLoader::destroy() {
+	m_buffers.clear();
+	m_jobs = nullptr;
+	m_stats = Stats();
+}
+
+// Elige el formato por la extensión y analiza el archivo proyectado en memoria.
+HRESULT
+MeshLoader::load(const std::string& fileName, MeshData& mesh) {
+	const size_t dot = fileName.find_last_of('.');
+	std::string extension = dot == std::string::npos ? std::string() : fileName.substr(dot + 1);
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](char c) {
+		return (char)tolower((unsigned char)c);
+	});
+	if (extension != "obj" && extension != "gltf" && extension != "glb") {
+		ERROR("MeshLoader", "load", ("Unsupported mesh format " + fileName).c_str());
+		return E_INVALIDARG;
+	}
+
+	MappedFile file;
+	HRESULT hr = file.open(fileName);
+	if (FAILED(hr))
+		return hr;
+
+	if (extension == "obj")
+		return parseObj(file.data(), file.size(), mesh);
+
+	const size_t slash = fileName.find_last_of("/\\");
+	const std::string baseDirectory = slash == std::string::npos ? std::string() : fileName.substr(0, slash + 1);
+	return parseGltf(file.data(), file.size(), baseDirectory, mesh);
+}
+
+// Analiza los tramos en paralelo, junta posiciones y UV y unifica las esquinas iguales.
+HRESULT
+MeshLoader::parseObj(const uint8_t* data, size_t size, MeshData& mesh) {
+	const auto start = std::chrono::steady_clock::now();
+	mesh.clear();
+	m_stats = Stats();
+	m_stats.bytes = size;
+	if (!data || size == 0) {
+		ERROR("MeshLoader", "parseObj", "Empty OBJ data");
+		return E_INVALIDARG;
+	}
+
+	// Tramos que empiezan justo después de un salto de línea.
+	const char* text = reinterpret_cast<const char*>(data);
+	const char* textEnd = text + size;
+	size_t chunkSize = size / (getThreadCount() * 4) + 1;
+	if (chunkSize < OBJ_MIN_CHUNK)
+		chunkSize = OBJ_MIN_CHUNK;
+	std::vector<ObjChunk> chunks;
+	for (const char* p = text; p < textEnd;) {
+		const char* end = (size_t)(textEnd - p) > chunkSize ? p + chunkSize : textEnd;
+		skipLine(end, textEnd);
+		chunks.emplace_back();
+		chunks.back().begin = p;
+		chunks.back().end = end;
+		p = end;
+	}
+
+	parallelFor((unsigned int)chunks.size(), 1, [&](unsigned int begin, unsigned int end) {
+		for (unsigned int i = begin; i < end; ++i)
+			parseObjChunk(chunks[i]);
+	});
+
+	unsigned int positionCount = 0;
+	unsigned int texCoordCount = 0;
+	unsigned int cornerCount = 0;
+	for (ObjChunk& chunk : chunks) {
+		if (chunk.failed) {
+			ERROR("MeshLoader", "parseObj", "Malformed OBJ vertex or face");
+			return E_FAIL;
+		}
+		chunk.firstPosition = positionCount;
+		chunk.firstTexCoord = texCoordCount;
+		chunk.firstCorner = cornerCount;
+		positionCount += (unsigned int)chunk.positions.size();
+		texCoordCount += (unsigned int)chunk.texCoords.size();
+		cornerCount += (unsigned int)chunk.corners.size();
+	}
+	if (cornerCount == 0) {
+		ERROR("MeshLoader", "parseObj", "OBJ has no faces");
+		return E_FAIL;
+	}
+
+	// Posiciones y UV de todos los tramos, y esquinas con índices absolutos y comprobados.
+	std::vector<Float3> positions(positionCount);
+	std::vector<Float2> texCoords(texCoordCount);
+	std::vector<ObjCorner> corners(cornerCount);
+	std::atomic<bool> outOfRange{ false };
+	parallelFor((unsigned int)chunks.size(), 1, [&](unsigned int begin, unsigned int end) {
+		for (unsigned int i = begin; i < end; ++i) {
+			const ObjChunk& chunk = chunks[i];
+			if (!chunk.positions.empty())
+				memcpy(&positions[chunk.firstPosition], chunk.positions.data(), chunk.positions.size() * sizeof(Float3));
+			if (!chunk.texCoords.empty())
+				memcpy(&texCoords[chunk.firstTexCoord], chunk.texCoords.data(), chunk.texCoords.size() * sizeof(Float2));
+			bool bad = false;
+			for (size_t c = 0; c < chunk.corners.size(); ++c) {
+				ObjCorner corner = chunk.corners[c];
+				const uint8_t relative = chunk.hasRelative ? chunk.relative[c] : 0;
+				if (relative & 1)
+					corner.position += (int32_t)chunk.firstPosition;
+				if (relative & 2)
+					corner.texCoord += (int32_t)chunk.firstTexCoord;
+				bad = bad || corner.position < 0 || (uint32_t)corner.position >= positionCount ||
+					corner.texCoord < -1 || (corner.texCoord >= 0 && (uint32_t)corner.texCoord >= texCoordCount);
+				corners[chunk.firstCorner + c] = corner;
+			}
+			if (bad)
+				outOfRange = true;
+		}
+	});
+	if (outOfRange) {
+		ERROR("MeshLoader", "parseObj", "OBJ face index out of range");
+		return E_FAIL;
+	}
+	chunks.clear();
+	m_stats.parseSeconds = timeSince(start);
+
+	// Un vértice por par (posición, UV) distinto, en el orden en que aparecen. Los vértices de
+	// cada posición se encadenan desde firstVertex, que casi siempre tiene uno solo.
+	const auto weldStart = std::chrono::steady_clock::now();
+	std::vector<uint32_t> firstVertex(positionCount, INVALID_INDEX);
+	std::vector<uint32_t> nextVertex;
+	std::vector<int32_t> vertexTexCoord;
+	nextVertex.reserve(positionCount);
+	vertexTexCoord.reserve(positionCount);
+	mesh.vertices.reserve(positionCount);
+	mesh.indices.resize(cornerCount);
+	for (unsigned int c = 0; c < cornerCount; ++c) {
+		const ObjCorner& corner = corners[c];
+		uint32_t index = firstVertex[corner.position];
+		while (index != INVALID_INDEX && vertexTexCoord[index] != corner.texCoord)
+			index = nextVertex[index];
+		if (index == INVALID_INDEX) {
+			index = (uint32_t)mesh.vertices.size();
+			nextVertex.push_back(firstVertex[corner.position]);
+			vertexTexCoord.push_back(corner.texCoord);
+			firstVertex[corner.position] = index;
+			const Float3& position = positions[corner.position];
+			MeshVertex vertex;
+			vertex.position = Float3(position.x, position.y, -position.z);
+			vertex.texCoord = Float2(0.0f, 0.0f);
+			if (corner.texCoord >= 0) {
+				const Float2& texCoord = texCoords[corner.texCoord];
+				vertex.texCoord = Float2(texCoord.x, 1.0f - texCoord.y);
+			}
+			mesh.vertices.push_back(vertex);
+		}
+		mesh.indices[c] = index;
+	}
+	m_stats.weldSeconds = timeSince(weldStart);
+
+	computeBounds(mesh);
+	m_stats.sourceVertices = cornerCount;
+	m_stats.vertices = (unsigned int)mesh.vertices.size();
+	m_stats.triangles = cornerCount / 3;
+	return S_OK;
+}
+
+// Lee el JSON, resuelve búferes, vistas y accessors, recorre la escena y decodifica.
+HRESULT
+MeshLoader::parseGltf(const uint8_t* data, size_t size, const std::string& baseDirectory, MeshData& mesh) {
+	const auto start = std::chrono::steady_clock::now();
+	mesh.clear();
+	m_buffers.clear();
+	m_stats = Stats();
+	if (!data || size == 0) {
+		ERROR("MeshLoader", "parseGltf", "Empty glTF data");
+		return E_INVALIDARG;
+	}
+
+	// .glb: cabecera de 12 bytes y trozos JSON y BIN; .gltf: el archivo entero es el JSON.
+	const char* jsonBegin = reinterpret_cast<const char*>(data);
+	const char* jsonEnd = jsonBegin + size;
+	ByteRange binaryChunk;
+	uint32_t magic = 0;
+	if (size >= 12)
+		memcpy(&magic, data, 4);
+	if (magic == GLB_MAGIC) {
+		uint32_t header[3];
+		memcpy(header, data, sizeof(header));
+		if (header[1] != 2 || header[2] > size) {
+			ERROR("MeshLoader", "parseGltf", "Unsupported GLB version or truncated file");
+			return E_FAIL;
+		}
+		jsonBegin = nullptr;
+		size_t offset = 12;
+		while (offset + 8 <= header[2]) {
+			uint32_t chunk[2];
+			memcpy(chunk, data + offset, sizeof(chunk));
+			offset += 8;
+			if (chunk[0] > header[2] - offset)
+				break;
+			if (chunk[1] == GLB_CHUNK_JSON && !jsonBegin) {
+				jsonBegin = reinterpret_cast<const char*>(data + offset);
+				jsonEnd = jsonBegin + chunk[0];
+			}
+			else if (chunk[1] == GLB_CHUNK_BIN && !binaryChunk.data) {
+				binaryChunk.data = data + offset;
+				binaryChunk.size = chunk[0];
+			}
+			offset += (chunk[0] + 3) & ~3u;
+		}
+		if (!jsonBegin) {
+			ERROR("MeshLoader", "parseGltf", "GLB has no JSON chunk");
+			return E_FAIL;
+		}
+	}
+	// El JSON del .glb puede acabar en espacios de relleno.
+	while (jsonEnd > jsonBegin && (jsonEnd[-1] == ' ' || jsonEnd[-1] == '\0'))
+		--jsonEnd;
+
+	JsonDocument json;
+	if (!json.parse(jsonBegin, jsonEnd)) {
+		ERROR("MeshLoader", "parseGltf", "Malformed glTF JSON");
+		return E_FAIL;
+	}
+	const uint32_t root = 0;
+	m_stats.bytes = (uint64_t)(jsonEnd - jsonBegin);
+
+	// Búferes: el trozo BIN del .glb, un "data:" en base64 o un archivo externo proyectado.
+	std::vector<ByteRange> buffers;
+	std::vector<std::vector<uint8_t>> decoded;
+	for (uint32_t buffer : json.elements(json.member(root, "buffers"))) {
+		ByteRange range;
+		const uint32_t uri = json.member(buffer, "uri");
+		const double byteLength = json.number(buffer, "byteLength", 0.0);
+		if (uri == INVALID_INDEX) {
+			range = binaryChunk;
+		}
+		else {
+			const JsonDocument::Node& uriNode = json.node(uri);
+			const char* dataPrefix = "data:";
+			if (uriNode.length > 5 && memcmp(uriNode.text, dataPrefix, 5) == 0) {
+				const char* comma = static_cast<const char*>(memchr(uriNode.text, ',', uriNode.length));
+				decoded.emplace_back();
+				if (!comma || !decodeBase64(comma + 1, uriNode.length - (comma + 1 - uriNode.text), decoded.back())) {
+					ERROR("MeshLoader", "parseGltf", "Invalid base64 buffer");
+					return E_FAIL;
+				}
+				range.data = decoded.back().data();
+				range.size = decoded.back().size();
+			}
+			else {
+				m_buffers.emplace_back(new MappedFile());
+				const std::string path = baseDirectory + std::string(uriNode.text, uriNode.length);
+				if (FAILED(m_buffers.back()->open(path)))
+					return E_FAIL;
+				range.data = m_buffers.back()->data();
+				range.size = m_buffers.back()->size();
+			}
+		}
+		if (!range.data || range.size < (size_t)byteLength) {
+			ERROR("MeshLoader", "parseGltf", "Missing or truncated glTF buffer");
+			return E_FAIL;
+		}
+		range.size = (size_t)byteLength;
+		m_stats.bytes += range.size;
+		buffers.push_back(range);
+	}
+
+	std::vector<BufferView> views;
+	for (uint32_t view : json.elements(json.member(root, "bufferViews"))) {
+		const int buffer = json.integer(view, "buffer", -1);
+		const double offset = json.number(view, "byteOffset", 0.0);
+		const double length = json.number(view, "byteLength", 0.0);
+		if (buffer < 0 || buffer >= (int)buffers.size() || offset < 0.0 || offset + length > (double)buffers[buffer].size) {
+			ERROR("MeshLoader", "parseGltf", "Invalid bufferView");
+			return E_FAIL;
+		}
+		BufferView result;
+		result.range.data = buffers[buffer].data + (size_t)offset;
+		result.range.size = (size_t)length;
+		result.stride = (unsigned int)json.integer(view, "byteStride", 0);
+		views.push_back(result);
+	}
+
+	std::vector<Accessor> accessors;
+	for (uint32_t accessor : json.elements(json.member(root, "accessors"))) {
+		Accessor result;
+		result.count = (unsigned int)json.integer(accessor, "count", 0);
+		result.componentType = (unsigned int)json.integer(accessor, "componentType", 0);
+		result.normalized = json.boolean(accessor, "normalized");
+		const uint32_t type = json.member(accessor, "type");
+		result.components = type == INVALID_INDEX ? 0 : componentCount(json.node(type));
+		const unsigned int elementSize = componentSize(result.componentType) * result.components;
+		const int view = json.integer(accessor, "bufferView", -1);
+		const double offset = json.number(accessor, "byteOffset", 0.0);
+		if (json.member(accessor, "sparse") != INVALID_INDEX || elementSize == 0 || view >= (int)views.size()) {
+			// Se guarda vacío: solo es un error si alguna primitiva lo usa.
+			accessors.push_back(Accessor());
+			continue;
+		}
+		if (view >= 0) {
+			const BufferView& bufferView = views[view];
+			result.stride = bufferView.stride ? bufferView.stride : elementSize;
+			const double needed = offset + (result.count ? (double)result.stride * (result.count - 1) + elementSize : 0.0);
+			if (offset < 0.0 || needed > (double)bufferView.range.size) {
+				ERROR("MeshLoader", "parseGltf", "Accessor out of its bufferView");
+				return E_FAIL;
+			}
+			result.data = bufferView.range.data + (size_t)offset;
+		}
+		accessors.push_back(result);
+	}
+
+	// Primitivas de triángulos de la escena con la transformación acumulada de su nodo.
+	const std::vector<uint32_t> meshes = json.elements(json.member(root, "meshes"));
+	const std::vector<uint32_t> nodes = json.elements(json.member(root, "nodes"));
+	std::vector<Primitive> primitives;
+	auto addMesh = [&](int meshIndex, const Matrix& world) {
+		if (meshIndex < 0 || meshIndex >= (int)meshes.size())
+			return;
+		for (uint32_t primitive : json.elements(json.member(meshes[meshIndex], "primitives"))) {
+			if (json.integer(primitive, "mode", PRIMITIVE_TRIANGLES) != PRIMITIVE_TRIANGLES)
+				continue;
+			const uint32_t attributes = json.member(primitive, "attributes");
+			Primitive result;
+			result.position = json.integer(attributes, "POSITION", -1);
+			result.texCoord = json.integer(attributes, "TEXCOORD_0", -1);
+			result.indices = json.integer(primitive, "indices", -1);
+			result.world = world;
+			primitives.push_back(result);
+		}
+	};
+
+	std::vector<uint32_t> roots;
+	const std::vector<uint32_t> scenes = json.elements(json.member(root, "scenes"));
+	const int scene = json.integer(root, "scene", 0);
+	if (scene >= 0 && scene < (int)scenes.size()) {
+		for (uint32_t node : json.elements(json.member(scenes[scene], "nodes")))
+			roots.push_back((uint32_t)json.node(node).number);
+	}
+	if (!roots.empty()) {
+		struct Pending {
+			uint32_t node;
+			Matrix parent;
+			unsigned int depth;
+		};
+		std::vector<Pending> stack;
+		for (uint32_t node : roots)
+			stack.push_back({ node, MatrixIdentity(), 0 });
+		while (!stack.empty()) {
+			const Pending pending = stack.back();
+			stack.pop_back();
+			if (pending.node >= nodes.size() || pending.depth > MAX_NODE_DEPTH) {
+				ERROR("MeshLoader", "parseGltf", "Invalid node index or hierarchy too deep");
+				return E_FAIL;
+			}
+			const uint32_t node = nodes[pending.node];
+			const Matrix world = MatrixMultiply(nodeTransform(json, node), pending.parent);
+			addMesh(json.integer(node, "mesh", -1), world);
+			for (uint32_t child : json.elements(json.member(node, "children")))
+				stack.push_back({ (uint32_t)json.node(child).number, world, pending.depth + 1 });
+		}
+	}
+	else {
+		// Sin escena se toman todas las mallas tal cual.
+		for (unsigned int i = 0; i < meshes.size(); ++i)
+			addMesh((int)i, MatrixIdentity());
+	}
+
+	// Reparto de la salida y comprobación de los accessors de cada primitiva.
+	uint64_t vertexCount = 0;
+	uint64_t indexCount = 0;
+	for (Primitive& primitive : primitives) {
+		const Accessor* position = primitive.position >= 0 && primitive.position < (int)accessors.size() ? &accessors[primitive.position] : nullptr;
+		if (!position || !position->data || position->components != 3) {
+			ERROR("MeshLoader", "parseGltf", "Primitive without a readable VEC3 POSITION");
+			return E_FAIL;
+		}
+		if (primitive.texCoord >= (int)accessors.size() ||
+			(primitive.texCoord >= 0 && (!accessors[primitive.texCoord].data || accessors[primitive.texCoord].components != 2 ||
+				accessors[primitive.texCoord].count < position->count))) {
+			ERROR("MeshLoader", "parseGltf", "Invalid TEXCOORD_0 accessor");
+			return E_FAIL;
+		}
+		if (primitive.indices >= (int)accessors.size() ||
+			(primitive.indices >= 0 && (!accessors[primitive.indices].data || accessors[primitive.indices].components != 1 ||
+				accessors[primitive.indices].componentType == COMPONENT_FLOAT))) {
+			ERROR("MeshLoader", "parseGltf", "Invalid indices accessor");
+			return E_FAIL;
+		}
+		primitive.firstVertex = (unsigned int)vertexCount;
+		primitive.vertexCount = position->count;
+		primitive.firstIndex = (unsigned int)indexCount;
+		primitive.indexCount = (primitive.indices >= 0 ? accessors[primitive.indices].count : position->count) / 3 * 3;
+		vertexCount += primitive.vertexCount;
+		indexCount += primitive.indexCount;
+	}
+	if (indexCount == 0 || vertexCount > UINT32_MAX || indexCount > UINT32_MAX) {
+		ERROR("MeshLoader", "parseGltf", "glTF has no triangles or too many vertices");
+		return E_FAIL;
+	}
+	mesh.vertices.resize((size_t)vertexCount);
+	mesh.indices.resize((size_t)indexCount);
+
+	// Trabajos de DECODE_GRAIN vértices o índices de una primitiva cada uno.
+	struct Range {
+		unsigned int primitive;
+		unsigned int begin;
+		unsigned int end;
+		bool indices;
+	};
+	std::vector<Range> ranges;
+	for (unsigned int i = 0; i < primitives.size(); ++i) {
+		for (unsigned int v = 0; v < primitives[i].vertexCount; v += DECODE_GRAIN)
+			ranges.push_back({ i, v, std::min(primitives[i].vertexCount, v + DECODE_GRAIN), false });
+		for (unsigned int n = 0; n < primitives[i].indexCount; n += DECODE_GRAIN)
+			ranges.push_back({ i, n, std::min(primitives[i].indexCount, n + DECODE_GRAIN), true });
+	}
+
+	std::atomic<bool> badIndex{ false };
+	parallelFor((unsigned int)ranges.size(), 1, [&](unsigned int begin, unsigned int end) {
+		for (unsigned int r = begin; r < end; ++r) {
+			const Range& range = ranges[r];
+			const Primitive& primitive = primitives[range.primitive];
+			if (range.indices) {
+				uint32_t* out = mesh.indices.data() + primitive.firstIndex;
+				if (primitive.indices < 0) {
+					for (unsigned int i = range.begin; i < range.end; ++i)
+						out[i] = primitive.firstVertex + i;
+					continue;
+				}
+				const Accessor& accessor = accessors[primitive.indices];
+				bool bad = false;
+				for (unsigned int i = range.begin; i < range.end; ++i) {
+					const uint32_t index = readIndex(accessor.data + (size_t)i * accessor.stride, accessor.componentType);
+					bad = bad || index >= primitive.vertexCount;
+					out[i] = primitive.firstVertex + index;
+				}
+				if (bad)
+					badIndex = true;
+				continue;
+			}
+
+			const Accessor& position = accessors[primitive.position];
+			const Accessor* texCoord = primitive.texCoord >= 0 ? &accessors[primitive.texCoord] : nullptr;
+			MeshVertex* out = mesh.vertices.data() + primitive.firstVertex;
+			const unsigned int positionSize = componentSize(position.componentType);
+			for (unsigned int i = range.begin; i < range.end; ++i) {
+				const uint8_t* p = position.data + (size_t)i * position.stride;
+				const Vector local = VectorSet(readComponent(p, position.componentType, position.normalized),
+					readComponent(p + positionSize, position.componentType, position.normalized),
+					readComponent(p + 2 * positionSize, position.componentType, position.normalized), 1.0f);
+				const Vector world = Vector3Transform(local, primitive.world);
+				out[i].position = Float3(VectorGetX(world), VectorGetY(world), -VectorGetZ(world));
+				out[i].texCoord = Float2(0.0f, 0.0f);
+				if (texCoord) {
+					const uint8_t* t = texCoord->data + (size_t)i * texCoord->stride;
+					const unsigned int texSize = componentSize(texCoord->componentType);
+					out[i].texCoord = Float2(readComponent(t, texCoord->componentType, texCoord->normalized),
+						readComponent(t + texSize, texCoord->componentType, texCoord->normalized));
+				}
+			}
+		}
+	});
+	m_buffers.clear();
+	if (badIndex) {
+		ERROR("MeshLoader", "parseGltf", "glTF index out of range");
+		mesh.clear();
+		return E_FAIL;
+	}
+	m_stats.parseSeconds = timeSince(start);
+	m_stats.sourceVertices = (unsigned int)vertexCount;
+
+	const auto weldStart = std::chrono::steady_clock::now();
+	weld(mesh);
+	m_stats.weldSeconds = timeSince(weldStart);
+
+	computeBounds(mesh);
+	m_stats.vertices = (unsigned int)mesh.vertices.size();
+	m_stats.triangles = (unsigned int)(mesh.indices.size() / 3);
+	return S_OK;
+}
+
+// Los vértices con los mismos bits (p. ej. separados solo por la normal) pasan a ser uno.
+void
+MeshLoader::weld(MeshData& mesh) {
+	const unsigned int count = (unsigned int)mesh.vertices.size();
+	size_t capacity = 64;
+	while (capacity < (size_t)count * 2)
+		capacity <<= 1;
+	std::vector<uint32_t> table(capacity, INVALID_INDEX);
+	std::vector<uint32_t> remap(count);
+
+	unsigned int unique = 0;
+	for (unsigned int v = 0; v < count; ++v) {
+		const MeshVertex& vertex = mesh.vertices[v];
+		uint32_t words[5];
+		memcpy(words, &vertex, sizeof(words));
+		uint64_t hash = 0xcbf29ce484222325ull;
+		for (uint32_t word : words)
+			hash = (hash ^ word) * 0x100000001b3ull;
+
+		size_t slot = (size_t)(hash ^ (hash >> 32)) & (capacity - 1);
+		for (;;) {
+			const uint32_t candidate = table[slot];
+			if (candidate == INVALID_INDEX) {
+				table[slot] = unique;
+				mesh.vertices[unique] = vertex;
+				remap[v] = unique++;
+				break;
+			}
+			if (memcmp(&mesh.vertices[candidate], &vertex, sizeof(MeshVertex)) == 0) {
+				remap[v] = candidate;
+				break;
+			}
+			slot = (slot + 1) & (capacity - 1);
+		}
+	}
+	mesh.vertices.resize(unique);
+	for (uint32_t& index : mesh.indices)
+		index = remap[index];
+}
+
+void
+MeshLoader::computeBounds(MeshData& mesh) {
+	if (mesh.vertices.empty())
+		return;
+	Float3 minimum = mesh.vertices[0].position;
+	Float3 maximum = minimum;
+	for (const MeshVertex& vertex : mesh.vertices) {
+		minimum = Float3(std::min(minimum.x, vertex.position.x), std::min(minimum.y, vertex.position.y), std::min(minimum.z, vertex.position.z));
+		maximum = Float3(std::max(maximum.x, vertex.position.x), std::max(maximum.y, vertex.position.y), std::max(maximum.z, vertex.position.z));
+	}
+	mesh.boundsMin = minimum;
+	mesh.boundsMax = maximum;
+}
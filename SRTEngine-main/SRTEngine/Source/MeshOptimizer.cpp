@@ -0,0 +1,317 @@
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+	const uint32_t INVALID_VERTEX = ~0u;
+
+	double
+	timeSince(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	/// Caché FIFO por marcas de tiempo: un vértice está dentro si entró hace menos de size fallos.
+	class FifoCache {
+	public:
+		FifoCache(unsigned int vertexCount, unsigned int size)
+			: m_stamps(vertexCount, 0), m_size(size), m_time(size + 1) {}
+
+		/// Devuelve 1 si el vértice falla (y lo mete en la caché) o 0 si ya estaba.
+		unsigned int access(uint32_t vertex) {
+			if (m_time - m_stamps[vertex] <= m_size)
+				return 0;
+			m_stamps[vertex] = m_time++;
+			return 1;
+		}
+
+		/// Vacía la caché sin recorrer las marcas.
+		void flush() { m_time += m_size + 1; }
+
+	private:
+		std::vector<uint32_t> m_stamps;
+		uint32_t m_size;
+		uint32_t m_time;
+	};
+
+	struct Cluster {
+		uint32_t firstTriangle;
+		uint32_t triangleCount;
+		float sortKey;
+	};
+}
+
+HRESULT
+MeshOptimizer::optimize(MeshData& mesh, const Options& options, Stats* stats) {
+	const size_t indexCount = mesh.indices.size();
+	const unsigned int vertexCount = (unsigned int)mesh.vertices.size();
+	if (indexCount % 3 != 0 || options.cacheSize < 3) {
+		ERROR("MeshOptimizer", "optimize", "Index count is not a triangle list or cache is too small");
+		return E_INVALIDARG;
+	}
+	for (uint32_t index : mesh.indices) {
+		if (index >= vertexCount) {
+			ERROR("MeshOptimizer", "optimize", "Index out of range");
+			return E_INVALIDARG;
+		}
+	}
+
+	Stats result;
+	result.before = analyzeVertexCache(mesh.indices.data(), indexCount, vertexCount, options.cacheSize);
+
+	auto start = std::chrono::steady_clock::now();
+	optimizeVertexCache(mesh.indices.data(), indexCount, vertexCount, options.cacheSize);
+	result.cacheSeconds = timeSince(start);
+
+	if (options.optimizeOverdraw) {
+		start = std::chrono::steady_clock::now();
+		result.clusters = optimizeOverdraw(mesh.indices.data(), indexCount, mesh.vertices.data(), vertexCount,
+			options.cacheSize, options.overdrawThreshold);
+		result.overdrawSeconds = timeSince(start);
+	}
+
+	start = std::chrono::steady_clock::now();
+	optimizeVertexFetch(mesh);
+	result.fetchSeconds = timeSince(start);
+
+	result.after = analyzeVertexCache(mesh.indices.data(), indexCount, (unsigned int)mesh.vertices.size(), options.cacheSize);
+	if (stats)
+		*stats = result;
+	return S_OK;
+}
+
+// Tipsify: abanicos alrededor de un vértice eligiendo como siguiente el vértice recién emitido
+// que más tiempo lleva en la caché sin que sus triángulos pendientes lo vayan a expulsar.
+void
+MeshOptimizer::optimizeVertexCache(uint32_t* indices, size_t indexCount, unsigned int vertexCount, unsigned int cacheSize) {
+	const uint32_t triangleCount = (uint32_t)(indexCount / 3);
+	if (triangleCount == 0 || vertexCount == 0)
+		return;
+
+	// Triángulos de cada vértice (CSR) y triángulos que le quedan por emitir.
+	std::vector<uint32_t> live(vertexCount, 0);
+	for (size_t i = 0; i < (size_t)triangleCount * 3; ++i)
+		++live[indices[i]];
+	std::vector<uint32_t> offsets(vertexCount + 1, 0);
+	for (unsigned int v = 0; v < vertexCount; ++v)
+		offsets[v + 1] = offsets[v] + live[v];
+	std::vector<uint32_t> adjacency(offsets[vertexCount]);
+	std::vector<uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+	for (uint32_t t = 0; t < triangleCount; ++t) {
+		for (unsigned int k = 0; k < 3; ++k)
+			adjacency[cursor[indices[t * 3 + k]]++] = t;
+	}
+
+	std::vector<uint32_t> cacheTime(vertexCount, 0);
+	std::vector<uint8_t> emitted(triangleCount, 0);
+	std::vector<uint32_t> deadEnds;
+	std::vector<uint32_t> candidates;
+	std::vector<uint32_t> output;
+	deadEnds.reserve(indexCount);
+	output.reserve(indexCount);
+	uint32_t time = cacheSize + 1;
+	unsigned int scan = 0;
+
+	// En un callejón sin salida: el último vértice emitido con triángulos o, si no hay, el siguiente en orden.
+	auto skipDeadEnd = [&]() -> uint32_t {
+		while (!deadEnds.empty()) {
+			const uint32_t vertex = deadEnds.back();
+			deadEnds.pop_back();
+			if (live[vertex] > 0)
+				return vertex;
+		}
+		for (; scan < vertexCount; ++scan) {
+			if (live[scan] > 0)
+				return scan;
+		}
+		return INVALID_VERTEX;
+	};
+
+	uint32_t fanning = skipDeadEnd();
+	while (fanning != INVALID_VERTEX) {
+		candidates.clear();
+		for (uint32_t a = offsets[fanning]; a < offsets[fanning + 1]; ++a) {
+			const uint32_t t = adjacency[a];
+			if (emitted[t])
+				continue;
+			emitted[t] = 1;
+			for (unsigned int k = 0; k < 3; ++k) {
+				const uint32_t vertex = indices[t * 3 + k];
+				output.push_back(vertex);
+				deadEnds.push_back(vertex);
+				candidates.push_back(vertex);
+				--live[vertex];
+				if (time - cacheTime[vertex] > cacheSize)
+					cacheTime[vertex] = time++;
+			}
+		}
+
+		// Prioridad: edad en la caché si al abrir su abanico el vértice seguirá dentro.
+		uint32_t next = INVALID_VERTEX;
+		int64_t bestPriority = -1;
+		for (uint32_t vertex : candidates) {
+			if (live[vertex] == 0)
+				continue;
+			int64_t priority = 0;
+			const uint32_t age = time - cacheTime[vertex];
+			if ((uint64_t)age + 2ull * live[vertex] <= cacheSize)
+				priority = age;
+			if (priority > bestPriority) {
+				bestPriority = priority;
+				next = vertex;
+			}
+		}
+		fanning = next != INVALID_VERTEX ? next : skipDeadEnd();
+	}
+
+	memcpy(indices, output.data(), output.size() * sizeof(uint32_t));
+}
+
+// Cortes duros donde la caché se vacía y blandos donde el grupo ya amortizó sus fallos; los grupos
+// se ordenan por lo que miran hacia fuera desde el centro de la malla.
+unsigned int
+MeshOptimizer::optimizeOverdraw(uint32_t* indices, size_t indexCount, const MeshVertex* vertices,
+	unsigned int vertexCount, unsigned int cacheSize, float threshold) {
+	const uint32_t triangleCount = (uint32_t)(indexCount / 3);
+	if (triangleCount == 0)
+		return 0;
+
+	FifoCache cache(vertexCount, cacheSize);
+	std::vector<uint32_t> hardStarts;
+	for (uint32_t t = 0; t < triangleCount; ++t) {
+		const unsigned int misses = cache.access(indices[t * 3]) + cache.access(indices[t * 3 + 1]) + cache.access(indices[t * 3 + 2]);
+		if (t == 0 || misses == 3)
+			hardStarts.push_back(t);
+	}
+	hardStarts.push_back(triangleCount);
+
+	std::vector<Cluster> clusters;
+	for (size_t h = 0; h + 1 < hardStarts.size(); ++h) {
+		const uint32_t begin = hardStarts[h];
+		const uint32_t end = hardStarts[h + 1];
+
+		cache.flush();
+		unsigned int misses = 0;
+		for (uint32_t t = begin; t < end; ++t)
+			misses += cache.access(indices[t * 3]) + cache.access(indices[t * 3 + 1]) + cache.access(indices[t * 3 + 2]);
+		const float limit = threshold * (float)misses / (float)(end - begin);
+
+		cache.flush();
+		uint32_t clusterStart = begin;
+		misses = 0;
+		for (uint32_t t = begin; t < end; ++t) {
+			misses += cache.access(indices[t * 3]) + cache.access(indices[t * 3 + 1]) + cache.access(indices[t * 3 + 2]);
+			if (t + 1 < end && (float)misses <= limit * (float)(t + 1 - clusterStart)) {
+				clusters.push_back({ clusterStart, t + 1 - clusterStart, 0.0f });
+				clusterStart = t + 1;
+				misses = 0;
+				cache.flush();
+			}
+		}
+		clusters.push_back({ clusterStart, end - clusterStart, 0.0f });
+	}
+
+	// Centro y normal de cada grupo ponderados por área (la normal sin normalizar ya lo está).
+	std::vector<Float3> centers(clusters.size());
+	std::vector<Float3> normals(clusters.size());
+	std::vector<float> areas(clusters.size());
+	Float3 meshCenter(0.0f, 0.0f, 0.0f);
+	float meshArea = 0.0f;
+	for (size_t c = 0; c < clusters.size(); ++c) {
+		Float3 center(0.0f, 0.0f, 0.0f);
+		Float3 normal(0.0f, 0.0f, 0.0f);
+		float area = 0.0f;
+		for (uint32_t t = clusters[c].firstTriangle; t < clusters[c].firstTriangle + clusters[c].triangleCount; ++t) {
+			const Float3& a = vertices[indices[t * 3]].position;
+			const Float3& b = vertices[indices[t * 3 + 1]].position;
+			const Float3& d = vertices[indices[t * 3 + 2]].position;
+			const Float3 ab(b.x - a.x, b.y - a.y, b.z - a.z);
+			const Float3 ad(d.x - a.x, d.y - a.y, d.z - a.z);
+			const Float3 n(ab.y * ad.z - ab.z * ad.y, ab.z * ad.x - ab.x * ad.z, ab.x * ad.y - ab.y * ad.x);
+			const float doubleArea = sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+			center.x += (a.x + b.x + d.x) * doubleArea;
+			center.y += (a.y + b.y + d.y) * doubleArea;
+			center.z += (a.z + b.z + d.z) * doubleArea;
+			normal.x += n.x;
+			normal.y += n.y;
+			normal.z += n.z;
+			area += doubleArea;
+		}
+		meshCenter.x += center.x;
+		meshCenter.y += center.y;
+		meshCenter.z += center.z;
+		meshArea += area;
+		if (area > 0.0f) {
+			const float scale = 1.0f / (3.0f * area);
+			center = Float3(center.x * scale, center.y * scale, center.z * scale);
+		}
+		centers[c] = center;
+		normals[c] = normal;
+		areas[c] = area;
+	}
+	if (meshArea > 0.0f) {
+		const float scale = 1.0f / (3.0f * meshArea);
+		meshCenter = Float3(meshCenter.x * scale, meshCenter.y * scale, meshCenter.z * scale);
+	}
+
+	for (size_t c = 0; c < clusters.size(); ++c) {
+		const Float3& n = normals[c];
+		const float length = sqrtf(n.x * n.x + n.y * n.y + n.z * n.z);
+		if (areas[c] <= 0.0f || length <= 0.0f)
+			continue;
+		clusters[c].sortKey = ((centers[c].x - meshCenter.x) * n.x + (centers[c].y - meshCenter.y) * n.y +
+			(centers[c].z - meshCenter.z) * n.z) / length;
+	}
+
+	std::stable_sort(clusters.begin(), clusters.end(), [](const Cluster& a, const Cluster& b) {
+		return a.sortKey > b.sortKey;
+	});
+
+	std::vector<uint32_t> sorted;
+	sorted.reserve(indexCount);
+	for (const Cluster& cluster : clusters)
+		sorted.insert(sorted.end(), indices + cluster.firstTriangle * 3, indices + (cluster.firstTriangle + cluster.triangleCount) * 3);
+	memcpy(indices, sorted.data(), sorted.size() * sizeof(uint32_t));
+	return (unsigned int)clusters.size();
+}
+
+void
+MeshOptimizer::optimizeVertexFetch(MeshData& mesh) {
+	std::vector<uint32_t> remap(mesh.vertices.size(), INVALID_VERTEX);
+	uint32_t next = 0;
+	for (uint32_t& index : mesh.indices) {
+		if (remap[index] == INVALID_VERTEX)
+			remap[index] = next++;
+		index = remap[index];
+	}
+
+	std::vector<MeshVertex> vertices(next);
+	for (size_t v = 0; v < mesh.vertices.size(); ++v) {
+		if (remap[v] != INVALID_VERTEX)
+			vertices[remap[v]] = mesh.vertices[v];
+	}
+	mesh.vertices.swap(vertices);
+}
+
+MeshOptimizer::CacheStats
+MeshOptimizer::analyzeVertexCache(const uint32_t* indices, size_t indexCount, unsigned int vertexCount, unsigned int cacheSize) {
+	CacheStats result;
+	const size_t triangleCount = indexCount / 3;
+	if (triangleCount == 0 || vertexCount == 0)
+		return result;
+
+	FifoCache cache(vertexCount, cacheSize);
+	std::vector<uint8_t> used(vertexCount, 0);
+	size_t misses = 0;
+	size_t usedCount = 0;
+	for (size_t i = 0; i < triangleCount * 3; ++i) {
+		misses += cache.access(indices[i]);
+		if (!used[indices[i]]) {
+			used[indices[i]] = 1;
+			++usedCount;
+		}
+	}
+	result.acmr = (float)misses / (float)triangleCount;
+	result.atvr = (float)misses / (float)usedCount;
+	return result;
+}
@@ -0,0 +1,485 @@
+#include "MeshSimplifier.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+namespace {
+	const uint32_t INVALID_VERTEX = ~0u;
+
+	/// Peso de los planos perpendiculares a los bordes abiertos respecto a los de los triángulos.
+	const float BORDER_WEIGHT = 10.0f;
+
+	/// Cada pasada acepta colapsos hasta este múltiplo del coste del que alcanzaría su objetivo.
+	const float PASS_ERROR_SLACK = 1.5f;
+
+	/// Un colapso no puede girar la normal de un triángulo vecino más de 60 grados.
+	const float MIN_NORMAL_COS = 0.5f;
+
+	/// Cubos de la ordenación por coste: los 16 bits altos del float (exponente y 7 de mantisa).
+	const unsigned int COST_BUCKETS = 1 << 16;
+
+	enum VertexKind : uint8_t {
+		KIND_MANIFOLD = 0, ///< Interior, con una sola UV.
+		KIND_BORDER,       ///< En un borde abierto: solo colapsa a lo largo del borde.
+		KIND_SEAM,         ///< En una costura de UV: todas sus copias colapsan juntas.
+		KIND_LOCKED        ///< Arista no manifold, o borde y costura a la vez: no se mueve.
+	};
+
+	double
+	timeSince(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	inline Float3
+	subtract(const Float3& a, const Float3& b) {
+		return Float3(a.x - b.x, a.y - b.y, a.z - b.z);
+	}
+
+	inline float
+	dot(const Float3& a, const Float3& b) {
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	}
+
+	inline Float3
+	cross(const Float3& a, const Float3& b) {
+		return Float3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+	}
+
+	/// Cuádrica simétrica (A, b, c): error(p) = p·A·p + 2·b·p + c, normalizado por weight.
+	struct Quadric {
+		float a00 = 0.0f, a11 = 0.0f, a22 = 0.0f, a01 = 0.0f, a02 = 0.0f, a12 = 0.0f;
+		float b0 = 0.0f, b1 = 0.0f, b2 = 0.0f;
+		float c = 0.0f;
+		float weight = 0.0f;
+	};
+
+	/// Suma a q el plano n·p + d = 0 (n unitaria) con peso w.
+	void
+	addPlane(Quadric& q, const Float3& n, float d, float w) {
+		q.a00 += w * n.x * n.x;
+		q.a11 += w * n.y * n.y;
+		q.a22 += w * n.z * n.z;
+		q.a01 += w * n.x * n.y;
+		q.a02 += w * n.x * n.z;
+		q.a12 += w * n.y * n.z;
+		q.b0 += w * n.x * d;
+		q.b1 += w * n.y * d;
+		q.b2 += w * n.z * d;
+		q.c += w * d * d;
+	}
+
+	void
+	addQuadric(Quadric& q, const Quadric& r) {
+		q.a00 += r.a00;
+		q.a11 += r.a11;
+		q.a22 += r.a22;
+		q.a01 += r.a01;
+		q.a02 += r.a02;
+		q.a12 += r.a12;
+		q.b0 += r.b0;
+		q.b1 += r.b1;
+		q.b2 += r.b2;
+		q.c += r.c;
+		q.weight += r.weight;
+	}
+
+	/// Distancia cuadrática media de p a los planos de q.
+	float
+	evaluate(const Quadric& q, const Float3& p) {
+		const float r = q.a00 * p.x * p.x + q.a11 * p.y * p.y + q.a22 * p.z * p.z +
+			2.0f * (q.a01 * p.x * p.y + q.a02 * p.x * p.z + q.a12 * p.y * p.z) +
+			2.0f * (q.b0 * p.x + q.b1 * p.y + q.b2 * p.z) + q.c;
+		return fabsf(q.weight > 0.0f ? r / q.weight : r);
+	}
+
+	inline uint32_t
+	hashPosition(const Float3& p) {
+		uint32_t bits[3];
+		memcpy(bits, &p.x, sizeof(bits));
+		return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+	}
+
+	/**
+	 * Agrupa los vértices usados por posición exacta: remap lleva al primero del grupo y wedge
+	 * enlaza los del grupo en un anillo (las copias de una costura de UV).
+	 */
+	void
+	buildPositionClasses(const MeshVertex* vertices, unsigned int vertexCount, const std::vector<uint8_t>& used,
+		std::vector<uint32_t>& remap, std::vector<uint32_t>& wedge) {
+		size_t tableSize = 1;
+		while (tableSize < (size_t)vertexCount * 2)
+			tableSize *= 2;
+		std::vector<uint32_t> table(tableSize, INVALID_VERTEX);
+		remap.resize(vertexCount);
+		wedge.resize(vertexCount);
+		for (uint32_t v = 0; v < vertexCount; ++v) {
+			remap[v] = v;
+			wedge[v] = v;
+			if (!used[v])
+				continue;
+			const Float3& p = vertices[v].position;
+			size_t slot = hashPosition(p) & (tableSize - 1);
+			for (;;) {
+				const uint32_t entry = table[slot];
+				if (entry == INVALID_VERTEX) {
+					table[slot] = v;
+					break;
+				}
+				const Float3& q = vertices[entry].position;
+				if (q.x == p.x && q.y == p.y && q.z == p.z) {
+					remap[v] = entry;
+					wedge[v] = wedge[entry];
+					wedge[entry] = v;
+					break;
+				}
+				slot = (slot + 1) & (tableSize - 1);
+			}
+		}
+	}
+}
+
+HRESULT
+MeshSimplifier::buildLods(const MeshData& mesh, const LodOptions& options, std::vector<Lod>& lods, Stats* stats) {
+	const unsigned int vertexCount = (unsigned int)mesh.vertices.size();
+	if (mesh.indices.size() % 3 != 0 || options.maxLods == 0 || options.reduction <= 0.0f || options.reduction >= 1.0f) {
+		ERROR("MeshSimplifier", "buildLods", "Mesh is not a triangle list or options are out of range");
+		return E_INVALIDARG;
+	}
+	for (uint32_t index : mesh.indices) {
+		if (index >= vertexCount) {
+			ERROR("MeshSimplifier", "buildLods", "Index out of range");
+			return E_INVALIDARG;
+		}
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+	lods.clear();
+	lods.emplace_back();
+	lods[0].indices = mesh.indices;
+
+	const Float3 extent = subtract(mesh.boundsMax, mesh.boundsMin);
+	const float maxError = options.maxError * 0.5f * sqrtf(dot(extent, extent));
+	while (lods.size() < options.maxLods) {
+		const Lod& previous = lods.back();
+		const size_t previousTriangles = previous.indices.size() / 3;
+		const size_t targetTriangles = (size_t)(previousTriangles * options.reduction);
+		if (targetTriangles < options.minTriangles || previous.error >= maxError)
+			break;
+
+		Lod lod;
+		lod.indices.resize(previous.indices.size());
+		float error = 0.0f;
+		const size_t indexCount = simplify(lod.indices.data(), previous.indices.data(), previous.indices.size(),
+			mesh.vertices.data(), vertexCount, targetTriangles * 3, maxError - previous.error, options.lockBorder, &error);
+		// Un nivel que no llega a la mitad del camino hacia su objetivo no compensa su memoria.
+		if (indexCount / 3 > previousTriangles - (previousTriangles - targetTriangles) / 2)
+			break;
+		lod.indices.resize(indexCount);
+		lod.error = previous.error + error;
+		lods.push_back(std::move(lod));
+	}
+
+	if (stats) {
+		stats->levels = (unsigned int)lods.size();
+		stats->seconds = timeSince(start);
+	}
+	return S_OK;
+}
+
+size_t
+MeshSimplifier::simplify(uint32_t* destination, const uint32_t* indices, size_t indexCount, const MeshVertex* vertices,
+	unsigned int vertexCount, size_t targetIndexCount, float targetError, bool lockBorder, float* resultError) {
+	// Las posiciones se llevan al cubo unidad para que las cuádricas en float no pierdan precisión.
+	Float3 minimum(0.0f, 0.0f, 0.0f), maximum(0.0f, 0.0f, 0.0f);
+	if (vertexCount > 0) {
+		minimum = maximum = vertices[0].position;
+		for (unsigned int v = 1; v < vertexCount; ++v) {
+			const Float3& p = vertices[v].position;
+			minimum = Float3(fminf(minimum.x, p.x), fminf(minimum.y, p.y), fminf(minimum.z, p.z));
+			maximum = Float3(fmaxf(maximum.x, p.x), fmaxf(maximum.y, p.y), fmaxf(maximum.z, p.z));
+		}
+	}
+	float scale = fmaxf(maximum.x - minimum.x, fmaxf(maximum.y - minimum.y, maximum.z - minimum.z));
+	if (scale <= 0.0f)
+		scale = 1.0f;
+	std::vector<Float3> positions(vertexCount);
+	for (unsigned int v = 0; v < vertexCount; ++v) {
+		const Float3 p = subtract(vertices[v].position, minimum);
+		positions[v] = Float3(p.x / scale, p.y / scale, p.z / scale);
+	}
+
+	// Los vértices que no usa esta lista (los que ya quitó un LOD anterior) no cuentan como costura.
+	std::vector<uint8_t> used(vertexCount, 0);
+	for (size_t i = 0; i < indexCount; ++i)
+		used[indices[i]] = 1;
+	std::vector<uint32_t> remap, wedge;
+	buildPositionClasses(vertices, vertexCount, used, remap, wedge);
+
+	// Copia de trabajo sin los triángulos que ya tienen dos esquinas en la misma posición.
+	std::vector<uint32_t> result;
+	result.reserve(indexCount);
+	for (size_t i = 0; i + 2 < indexCount; i += 3) {
+		const uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+		if (remap[a] != remap[b] && remap[b] != remap[c] && remap[a] != remap[c]) {
+			result.push_back(a);
+			result.push_back(b);
+			result.push_back(c);
+		}
+	}
+
+	// Aristas salientes de cada posición para clasificar bordes, costuras y aristas no manifold.
+	std::vector<uint32_t> edgeOffsets(vertexCount + 1, 0);
+	std::vector<uint32_t> edgeTargets(result.size());
+	for (size_t i = 0; i < result.size(); ++i)
+		++edgeOffsets[remap[result[i]] + 1];
+	for (unsigned int v = 0; v < vertexCount; ++v)
+		edgeOffsets[v + 1] += edgeOffsets[v];
+	{
+		std::vector<uint32_t> fill(edgeOffsets.begin(), edgeOffsets.end() - 1);
+		for (size_t i = 0; i < result.size(); i += 3) {
+			for (unsigned int k = 0; k < 3; ++k)
+				edgeTargets[fill[remap[result[i + k]]]++] = remap[result[i + (k + 1) % 3]];
+		}
+	}
+	auto countEdges = [&](uint32_t from, uint32_t to) {
+		unsigned int count = 0;
+		for (uint32_t e = edgeOffsets[from]; e < edgeOffsets[from + 1]; ++e)
+			count += edgeTargets[e] == to ? 1 : 0;
+		return count;
+	};
+
+	std::vector<uint8_t> border(vertexCount, 0), locked(vertexCount, 0);
+	for (uint32_t a = 0; a < vertexCount; ++a) {
+		for (uint32_t e = edgeOffsets[a]; e < edgeOffsets[a + 1]; ++e) {
+			const uint32_t b = edgeTargets[e];
+			const unsigned int opposite = countEdges(b, a);
+			if (countEdges(a, b) > 1 || opposite > 1)
+				locked[a] = locked[b] = 1;
+			else if (opposite == 0)
+				border[a] = border[b] = 1;
+		}
+	}
+	std::vector<uint8_t> kind(vertexCount, KIND_MANIFOLD);
+	for (uint32_t v = 0; v < vertexCount; ++v) {
+		if (remap[v] != v)
+			continue;
+		const bool seam = wedge[v] != v;
+		if (locked[v] || (border[v] && (seam || lockBorder)))
+			kind[v] = KIND_LOCKED;
+		else if (border[v])
+			kind[v] = KIND_BORDER;
+		else if (seam)
+			kind[v] = KIND_SEAM;
+	}
+
+	// Cuádricas por posición: planos de los triángulos y planos perpendiculares a los bordes.
+	std::vector<Quadric> quadrics(vertexCount);
+	for (size_t i = 0; i < result.size(); i += 3) {
+		const Float3& p0 = positions[result[i]];
+		const Float3 normal = cross(subtract(positions[result[i + 1]], p0), subtract(positions[result[i + 2]], p0));
+		const float length = sqrtf(dot(normal, normal));
+		if (length <= 0.0f)
+			continue;
+		const Float3 n(normal.x / length, normal.y / length, normal.z / length);
+		const float area = length * 0.5f;
+		Quadric plane;
+		addPlane(plane, n, -dot(n, p0), area);
+		plane.weight = area;
+		for (unsigned int k = 0; k < 3; ++k) {
+			const uint32_t a = remap[result[i + k]];
+			const uint32_t b = remap[result[i + (k + 1) % 3]];
+			addQuadric(quadrics[a], plane);
+			if (border[a] && border[b] && countEdges(b, a) == 0) {
+				const Float3 edge = subtract(positions[b], positions[a]);
+				const float edgeLength = sqrtf(dot(edge, edge));
+				const Float3 side = cross(edge, n);
+				const float sideLength = sqrtf(dot(side, side));
+				if (sideLength <= 0.0f)
+					continue;
+				const Float3 m(side.x / sideLength, side.y / sideLength, side.z / sideLength);
+				const float w = edgeLength * edgeLength * BORDER_WEIGHT;
+				addPlane(quadrics[a], m, -dot(m, positions[a]), w);
+				addPlane(quadrics[b], m, -dot(m, positions[a]), w);
+			}
+		}
+	}
+	edgeTargets.clear();
+	edgeTargets.shrink_to_fit();
+
+	const float errorLimit = targetError / scale * (targetError / scale);
+	std::vector<uint32_t> collapseRemap(vertexCount);
+	for (uint32_t v = 0; v < vertexCount; ++v)
+		collapseRemap[v] = v;
+	std::vector<uint32_t> passStamp(vertexCount, 0);
+	std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+	std::vector<uint32_t> adjacency;
+	struct Candidate {
+		uint32_t from;
+		uint32_t to;
+		float cost;
+	};
+	std::vector<Candidate> candidates;
+	std::vector<uint32_t> order;
+	std::vector<uint32_t> bucketOffsets(COST_BUCKETS + 1);
+	std::vector<std::pair<uint32_t, uint32_t>> wedgeTargets;
+	float maxCost = 0.0f;
+	bool relaxed = false; // La pasada anterior avanzó poco: esta llega hasta el error pedido.
+
+	// Colapsa la posición from en to si es válido; devuelve los triángulos que desaparecen (0 = no).
+	auto tryCollapse = [&](uint32_t from, uint32_t to) -> unsigned int {
+		wedgeTargets.clear();
+		unsigned int shared = 0;
+		uint32_t w = from;
+		do {
+			uint32_t target = INVALID_VERTEX;
+			bool live = false;
+			for (uint32_t a = adjacencyOffsets[w]; a < adjacencyOffsets[w + 1]; ++a) {
+				const uint32_t* triangle = &result[adjacency[a] * 3];
+				const uint32_t x[3] = { collapseRemap[triangle[0]], collapseRemap[triangle[1]], collapseRemap[triangle[2]] };
+				if (x[0] == x[1] || x[1] == x[2] || x[0] == x[2])
+					continue; // Ya desapareció con otro colapso de esta pasada.
+				live = true;
+				unsigned int slot = 0, other = 3;
+				for (unsigned int k = 0; k < 3; ++k) {
+					if (x[k] == w)
+						slot = k;
+					else if (remap[x[k]] == to)
+						other = k;
+				}
+				if (other != 3) {
+					// Cada copia de from tiene que ir a una sola copia de to (la del lado de su costura).
+					if (target != INVALID_VERTEX && target != x[other])
+						return 0;
+					target = x[other];
+					++shared;
+					continue;
+				}
+				Float3 p[3] = { positions[x[0]], positions[x[1]], positions[x[2]] };
+				const Float3 before = cross(subtract(p[1], p[0]), subtract(p[2], p[0]));
+				p[slot] = positions[to];
+				const Float3 after = cross(subtract(p[1], p[0]), subtract(p[2], p[0]));
+				if (dot(before, after) <= MIN_NORMAL_COS * sqrtf(dot(before, before) * dot(after, after)))
+					return 0;
+			}
+			if (target == INVALID_VERTEX && live)
+				return 0;
+			if (live)
+				wedgeTargets.push_back({ w, target });
+			w = wedge[w];
+		} while (w != from);
+		// Un vértice de borde solo se mueve por una arista abierta (un solo triángulo).
+		if (kind[from] == KIND_BORDER && shared != 1)
+			return 0;
+		for (const std::pair<uint32_t, uint32_t>& target : wedgeTargets)
+			collapseRemap[target.first] = target.second;
+		return shared;
+	};
+
+	auto collapseCost = [&](uint32_t from, uint32_t to) {
+		const uint8_t fromKind = kind[remap[from]];
+		const uint8_t toKind = kind[remap[to]];
+		if (fromKind == KIND_LOCKED || (fromKind == KIND_BORDER && toKind != KIND_BORDER && toKind != KIND_LOCKED))
+			return INFINITY;
+		return evaluate(quadrics[remap[from]], positions[to]);
+	};
+
+	for (uint32_t pass = 1; result.size() > targetIndexCount; ++pass) {
+		// Triángulos de cada vértice.
+		const size_t triangleCount = result.size() / 3;
+		std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+		for (uint32_t index : result)
+			++adjacencyOffsets[index + 1];
+		for (unsigned int v = 0; v < vertexCount; ++v)
+			adjacencyOffsets[v + 1] += adjacencyOffsets[v];
+		adjacency.resize(result.size());
+		{
+			std::vector<uint32_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+			for (size_t i = 0; i < result.size(); ++i)
+				adjacency[fill[result[i]]++] = (uint32_t)(i / 3);
+		}
+
+		// Coste de cada arista en su dirección más barata; las interiores se ven desde un solo lado.
+		candidates.clear();
+		for (size_t i = 0; i < result.size(); i += 3) {
+			for (unsigned int k = 0; k < 3; ++k) {
+				const uint32_t a = result[i + k];
+				const uint32_t b = result[i + (k + 1) % 3];
+				if (remap[a] > remap[b] && kind[remap[a]] != KIND_BORDER && kind[remap[b]] != KIND_BORDER)
+					continue;
+				const float forward = collapseCost(a, b);
+				const float backward = collapseCost(b, a);
+				if (forward == INFINITY && backward == INFINITY)
+					continue;
+				if (forward <= backward)
+					candidates.push_back({ remap[a], remap[b], forward });
+				else
+					candidates.push_back({ remap[b], remap[a], backward });
+			}
+		}
+		if (candidates.empty())
+			break;
+
+		// Orden aproximado por coste en una pasada de conteo.
+		std::fill(bucketOffsets.begin(), bucketOffsets.end(), 0);
+		auto bucket = [](float cost) {
+			uint32_t bits;
+			memcpy(&bits, &cost, sizeof(bits));
+			return bits >> 16;
+		};
+		for (const Candidate& candidate : candidates)
+			++bucketOffsets[bucket(candidate.cost) + 1];
+		for (unsigned int b = 0; b < COST_BUCKETS; ++b)
+			bucketOffsets[b + 1] += bucketOffsets[b];
+		order.resize(candidates.size());
+		for (uint32_t c = 0; c < (uint32_t)candidates.size(); ++c)
+			order[bucketOffsets[bucket(candidates[c].cost)]++] = c;
+
+		// Cada colapso quita unos dos triángulos; la pasada no acepta colapsos mucho más caros
+		// que el que alcanzaría su objetivo, para que los baratos de la siguiente vayan antes.
+		const size_t removeGoal = (result.size() - targetIndexCount) / 3;
+		const size_t goalCandidate = removeGoal / 2 < order.size() ? removeGoal / 2 : order.size() - 1;
+		const float passLimit = relaxed ? errorLimit : fminf(errorLimit, candidates[order[goalCandidate]].cost * PASS_ERROR_SLACK);
+		size_t removed = 0;
+		unsigned int collapses = 0;
+		for (uint32_t c : order) {
+			const Candidate& candidate = candidates[c];
+			if (candidate.cost > passLimit || removed >= removeGoal)
+				break;
+			if (passStamp[candidate.from] == pass || passStamp[candidate.to] == pass)
+				continue;
+			const unsigned int shared = tryCollapse(candidate.from, candidate.to);
+			if (shared == 0)
+				continue;
+			addQuadric(quadrics[candidate.to], quadrics[candidate.from]);
+			passStamp[candidate.from] = passStamp[candidate.to] = pass;
+			maxCost = fmaxf(maxCost, candidate.cost);
+			removed += shared;
+			++collapses;
+		}
+		if (collapses == 0) {
+			if (relaxed || passLimit >= errorLimit)
+				break;
+			relaxed = true;
+			continue;
+		}
+		relaxed = removed * 8 < removeGoal;
+
+		size_t write = 0;
+		for (size_t i = 0; i < triangleCount * 3; i += 3) {
+			const uint32_t a = collapseRemap[result[i]];
+			const uint32_t b = collapseRemap[result[i + 1]];
+			const uint32_t c = collapseRemap[result[i + 2]];
+			if (a == b || b == c || a == c)
+				continue;
+			result[write++] = a;
+			result[write++] = b;
+			result[write++] = c;
+		}
+		result.resize(write);
+	}
+
+	memcpy(destination, result.data(), result.size() * sizeof(uint32_t));
+	if (resultError)
+		*resultError = sqrtf(maxCost) * scale;
+	return result.size();
+}
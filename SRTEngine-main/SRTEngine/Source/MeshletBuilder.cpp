@@ -0,0 +1,255 @@
+#include "MeshletBuilder.h"
+#include <cmath>
+#include <cstring>
+
+namespace {
+	const uint32_t INVALID_VERTEX = ~0u;
+
+	inline Float3
+	subtract(const Float3& a, const Float3& b) {
+		return Float3(a.x - b.x, a.y - b.y, a.z - b.z);
+	}
+
+	inline float
+	dot(const Float3& a, const Float3& b) {
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	}
+
+	inline Float3
+	cross(const Float3& a, const Float3& b) {
+		return Float3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+	}
+
+	/// Esfera de la caja de los vértices y cono de las normales de sus triángulos.
+	void
+	computeBounds(Meshlet& meshlet, const MeshData& mesh, size_t firstTriangle, const std::vector<uint32_t>& meshletVertices) {
+		Float3 minimum = mesh.vertices[meshletVertices[0]].position;
+		Float3 maximum = minimum;
+		for (uint32_t vertex : meshletVertices) {
+			const Float3& p = mesh.vertices[vertex].position;
+			minimum = Float3(fminf(minimum.x, p.x), fminf(minimum.y, p.y), fminf(minimum.z, p.z));
+			maximum = Float3(fmaxf(maximum.x, p.x), fmaxf(maximum.y, p.y), fmaxf(maximum.z, p.z));
+		}
+		meshlet.center = Float3((minimum.x + maximum.x) * 0.5f, (minimum.y + maximum.y) * 0.5f, (minimum.z + maximum.z) * 0.5f);
+		float radiusSquared = 0.0f;
+		for (uint32_t vertex : meshletVertices) {
+			const Float3 d = subtract(mesh.vertices[vertex].position, meshlet.center);
+			radiusSquared = fmaxf(radiusSquared, dot(d, d));
+		}
+		meshlet.radius = sqrtf(radiusSquared);
+
+		// Normales de cara en el sentido horario del motor: miran hacia fuera.
+		Float3 axis(0.0f, 0.0f, 0.0f);
+		const uint32_t* triangles = mesh.indices.data() + firstTriangle * 3;
+		for (uint32_t t = 0; t < meshlet.triangleCount; ++t) {
+			const Float3& a = mesh.vertices[triangles[t * 3]].position;
+			const Float3 n = cross(subtract(mesh.vertices[triangles[t * 3 + 1]].position, a),
+				subtract(mesh.vertices[triangles[t * 3 + 2]].position, a));
+			const float length = sqrtf(dot(n, n));
+			if (length > 0.0f)
+				axis = Float3(axis.x + n.x / length, axis.y + n.y / length, axis.z + n.z / length);
+		}
+		const float axisLength = sqrtf(dot(axis, axis));
+		meshlet.coneCutoff = 1.0f;
+		if (axisLength <= 1e-6f)
+			return;
+		axis = Float3(axis.x / axisLength, axis.y / axisLength, axis.z / axisLength);
+
+		float minimumDot = 1.0f;
+		for (uint32_t t = 0; t < meshlet.triangleCount; ++t) {
+			const Float3& a = mesh.vertices[triangles[t * 3]].position;
+			const Float3 n = cross(subtract(mesh.vertices[triangles[t * 3 + 1]].position, a),
+				subtract(mesh.vertices[triangles[t * 3 + 2]].position, a));
+			const float length = sqrtf(dot(n, n));
+			if (length > 0.0f)
+				minimumDot = fminf(minimumDot, dot(n, axis) / length);
+		}
+		meshlet.coneAxis = axis;
+		// Con normales a más de 90 grados del eje el meshlet siempre tiene alguna cara de frente.
+		if (minimumDot > 0.0f)
+			meshlet.coneCutoff = sqrtf(1.0f - minimumDot * minimumDot);
+	}
+
+}
+
+// Meshlets voraces en el orden de los triángulos y tramos de meshlets que caben en maxChunkVertices.
+HRESULT
+MeshletBuilder::build(const MeshData& mesh, const Options& options, MeshletMesh& result) {
+	result.clear();
+	const size_t triangleCount = mesh.indices.size() / 3;
+	const unsigned int vertexCount = (unsigned int)mesh.vertices.size();
+	if (mesh.indices.size() % 3 != 0 || triangleCount == 0) {
+		ERROR("MeshletBuilder", "build", "Mesh is not a non-empty triangle list");
+		return E_INVALIDARG;
+	}
+	if (options.maxVertices < 3 || options.maxTriangles == 0 || options.maxChunkVertices < options.maxVertices ||
+		options.maxChunkVertices > MAX_16BIT_VERTICES) {
+		ERROR("MeshletBuilder", "build", "Invalid meshlet or chunk limits");
+		return E_INVALIDARG;
+	}
+	for (uint32_t index : mesh.indices) {
+		if (index >= vertexCount) {
+			ERROR("MeshletBuilder", "build", "Index out of range");
+			return E_INVALIDARG;
+		}
+	}
+
+	// Sin partir, el tramo único usa 16 bits si cabe y 32 si no.
+	const bool singleChunk = !options.splitChunks;
+	result.indexSize = singleChunk && vertexCount > MAX_16BIT_VERTICES ? 4 : 2;
+	const uint32_t chunkLimit = singleChunk ? UINT32_MAX : options.maxChunkVertices;
+
+	std::vector<uint32_t> localIndex(vertexCount, INVALID_VERTEX); // Índice dentro del tramo actual.
+	std::vector<uint32_t> meshletStamp(vertexCount, INVALID_VERTEX);
+	std::vector<uint32_t> chunkVertices;
+	std::vector<uint32_t> meshletVertices;
+	result.vertices.reserve(vertexCount);
+	result.indexData.reserve(mesh.indices.size() * result.indexSize);
+	result.meshlets.reserve(triangleCount / options.maxTriangles + 1);
+
+	MeshChunk chunk;
+	auto appendIndex = [&](uint32_t local) {
+		if (result.indexSize == 2) {
+			const uint16_t narrow = (uint16_t)local;
+			result.indexData.insert(result.indexData.end(), (const uint8_t*)&narrow, (const uint8_t*)&narrow + 2);
+		}
+		else {
+			result.indexData.insert(result.indexData.end(), (const uint8_t*)&local, (const uint8_t*)&local + 4);
+		}
+	};
+
+	size_t t = 0;
+	while (t < triangleCount) {
+		// Crecer el meshlet mientras quepan sus vértices y triángulos.
+		const uint32_t meshletId = (uint32_t)result.meshlets.size();
+		const size_t firstTriangle = t;
+		meshletVertices.clear();
+		while (t < triangleCount && t - firstTriangle < options.maxTriangles) {
+			const uint32_t a = mesh.indices[t * 3];
+			const uint32_t b = mesh.indices[t * 3 + 1];
+			const uint32_t c = mesh.indices[t * 3 + 2];
+			const unsigned int added = (meshletStamp[a] != meshletId ? 1 : 0) +
+				(meshletStamp[b] != meshletId && b != a ? 1 : 0) +
+				(meshletStamp[c] != meshletId && c != a && c != b ? 1 : 0);
+			if (meshletVertices.size() + added > options.maxVertices)
+				break;
+			for (uint32_t vertex : { a, b, c }) {
+				if (meshletStamp[vertex] != meshletId) {
+					meshletStamp[vertex] = meshletId;
+					meshletVertices.push_back(vertex);
+				}
+			}
+			++t;
+		}
+
+		// Si sus vértices nuevos no caben en el tramo, se cierra y el meshlet abre otro.
+		unsigned int newVertices = 0;
+		for (uint32_t vertex : meshletVertices)
+			newVertices += localIndex[vertex] == INVALID_VERTEX ? 1 : 0;
+		if (chunk.vertexCount + newVertices > chunkLimit) {
+			result.chunks.push_back(chunk);
+			for (uint32_t vertex : chunkVertices)
+				localIndex[vertex] = INVALID_VERTEX;
+			chunkVertices.clear();
+			chunk = MeshChunk();
+			chunk.baseVertex = (uint32_t)result.vertices.size();
+			chunk.firstIndex = (uint32_t)(result.indexData.size() / result.indexSize);
+			chunk.firstMeshlet = meshletId;
+		}
+
+		// Los vértices del tramo se copian en orden de primer uso y los índices son locales a él.
+		Meshlet meshlet;
+		meshlet.firstIndex = (uint32_t)(result.indexData.size() / result.indexSize);
+		meshlet.triangleCount = (uint32_t)(t - firstTriangle);
+		meshlet.vertexCount = (uint32_t)meshletVertices.size();
+		for (size_t i = firstTriangle * 3; i < t * 3; ++i) {
+			const uint32_t vertex = mesh.indices[i];
+			if (localIndex[vertex] == INVALID_VERTEX) {
+				localIndex[vertex] = chunk.vertexCount++;
+				chunkVertices.push_back(vertex);
+				result.vertices.push_back(mesh.vertices[vertex]);
+			}
+			appendIndex(localIndex[vertex]);
+		}
+		chunk.indexCount += meshlet.triangleCount * 3;
+		++chunk.meshletCount;
+		computeBounds(meshlet, mesh, firstTriangle, meshletVertices);
+		result.meshlets.push_back(meshlet);
+	}
+	result.chunks.push_back(chunk);
+	return S_OK;
+}
+
+HRESULT
+MeshletBuilder::append(MeshletMesh& mesh, const MeshletMesh& source) {
+	if (mesh.chunks.empty()) {
+		mesh = source;
+		return S_OK;
+	}
+	if (mesh.indexSize != source.indexSize) {
+		ERROR("MeshletBuilder", "append", "Meshes use different index sizes");
+		return E_INVALIDARG;
+	}
+
+	// Los tramos y meshlets de source se desplazan al final de los búferes de mesh.
+	const uint32_t vertexBase = (uint32_t)mesh.vertices.size();
+	const uint32_t indexBase = mesh.getIndexCount();
+	const uint32_t meshletBase = (uint32_t)mesh.meshlets.size();
+	mesh.vertices.insert(mesh.vertices.end(), source.vertices.begin(), source.vertices.end());
+	mesh.indexData.insert(mesh.indexData.end(), source.indexData.begin(), source.indexData.end());
+	for (MeshChunk chunk : source.chunks) {
+		chunk.baseVertex += vertexBase;
+		chunk.firstIndex += indexBase;
+		chunk.firstMeshlet += meshletBase;
+		mesh.chunks.push_back(chunk);
+	}
+	for (Meshlet meshlet : source.meshlets) {
+		meshlet.firstIndex += indexBase;
+		mesh.meshlets.push_back(meshlet);
+	}
+	return S_OK;
+}
+
+// Prueba del cono contra la esfera: todo el meshlet mira hacia atrás si la dirección desde la
+// cámara a cualquier punto de la esfera queda dentro del cono complementario al de las normales.
+void
+MeshletBuilder::cull(const MeshletMesh& mesh, unsigned int chunk, const Float3& cameraPosition,
+	unsigned int maxGapTriangles, std::vector<DrawRange>& ranges, CullStats* stats) {
+	const MeshChunk& source = mesh.chunks[chunk];
+	CullStats counters;
+	bool open = false;
+	uint32_t gap = 0; // Triángulos descartados desde el último rango.
+	for (uint32_t m = source.firstMeshlet; m < source.firstMeshlet + source.meshletCount; ++m) {
+		const Meshlet& meshlet = mesh.meshlets[m];
+		const Float3 toCenter = subtract(meshlet.center, cameraPosition);
+		const bool backFacing = dot(toCenter, meshlet.coneAxis) >=
+			meshlet.coneCutoff * sqrtf(dot(toCenter, toCenter)) + meshlet.radius;
+		++counters.meshletsTested;
+		counters.trianglesTested += meshlet.triangleCount;
+		if (backFacing) {
+			++counters.meshletsCulled;
+			counters.trianglesCulled += meshlet.triangleCount;
+			gap += meshlet.triangleCount;
+			continue;
+		}
+		// Los meshlets del tramo están seguidos en el búfer: los visibles consecutivos (o separados por
+		// menos de maxGapTriangles descartados, que la GPU vuelve a descartar) son un solo draw.
+		if (open && gap <= maxGapTriangles) {
+			ranges.back().indexCount = meshlet.firstIndex + meshlet.triangleCount * 3 - ranges.back().firstIndex;
+			counters.trianglesCulled -= gap;
+		}
+		else {
+			ranges.push_back({ meshlet.firstIndex, meshlet.triangleCount * 3, (int32_t)source.baseVertex });
+			++counters.ranges;
+			open = true;
+		}
+		gap = 0;
+	}
+	if (stats) {
+		stats->meshletsTested += counters.meshletsTested;
+		stats->meshletsCulled += counters.meshletsCulled;
+		stats->trianglesTested += counters.trianglesTested;
+		stats->trianglesCulled += counters.trianglesCulled;
+		stats->ranges += counters.ranges;
+	}
+}
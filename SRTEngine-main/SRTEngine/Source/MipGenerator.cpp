@@ -0,0 +1,375 @@
+#include "MipGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <functional>
+
+#if defined(SRT_SIMD_AVX2)
+#include <immintrin.h>
+#elif defined(SRT_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+	const float PI = 3.14159265358979f;
+
+	// Por debajo de este número de píxeles un nivel no compensa repartirlo entre hilos.
+	const size_t MIN_PARALLEL_PIXELS = 64 * 1024;
+
+	// Tablas de conversión sRGB <-> lineal (se construyen una vez, de forma segura entre hilos).
+	const float* srgbToLinearTable() {
+		static const std::vector<float> table = []() {
+			std::vector<float> t(256);
+			for (int i = 0; i < 256; ++i) {
+				const float c = i / 255.0f;
+				t[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+			}
+			return t;
+		}();
+		return table.data();
+	}
+
+	// Indexada por round(lineal * LINEAR_STEPS); con 16 bits el error es < 0.1 LSB en los oscuros.
+	const unsigned int LINEAR_STEPS = 65535;
+	const uint8_t* linearToSrgbTable() {
+		static const std::vector<uint8_t> table = []() {
+			std::vector<uint8_t> t(LINEAR_STEPS + 1);
+			for (unsigned int i = 0; i <= LINEAR_STEPS; ++i) {
+				const float l = (float)i / LINEAR_STEPS;
+				const float s = l <= 0.0031308f ? l * 12.92f : 1.055f * std::pow(l, 1.0f / 2.4f) - 0.055f;
+				t[i] = (uint8_t)(s * 255.0f + 0.5f);
+			}
+			return t;
+		}();
+		return table.data();
+	}
+
+	float sinc(float x) {
+		if (x == 0.0f)
+			return 1.0f;
+		x *= PI;
+		return std::sin(x) / x;
+	}
+
+	// Función de Bessel modificada de orden 0 (serie de potencias).
+	float besselI0(float x) {
+		float sum = 1.0f;
+		float term = 1.0f;
+		const float halfX2 = x * x * 0.25f;
+		for (int k = 1; k < 32; ++k) {
+			term *= halfX2 / (float)(k * k);
+			sum += term;
+			if (term < sum * 1e-8f)
+				break;
+		}
+		return sum;
+	}
+
+	float filterRadius(MipGenerator::Filter filter) {
+		return filter == MipGenerator::FILTER_BOX ? 0.5f : 3.0f;
+	}
+
+	float evalFilter(MipGenerator::Filter filter, float x) {
+		const float ax = std::fabs(x);
+		switch (filter) {
+		case MipGenerator::FILTER_BOX:
+			return ax <= 0.5f ? 1.0f : 0.0f;
+		case MipGenerator::FILTER_KAISER: {
+			const float radius = 3.0f;
+			const float alpha = 4.0f;
+			if (ax >= radius)
+				return 0.0f;
+			const float r = x / radius;
+			return sinc(x) * besselI0(alpha * std::sqrt(1.0f - r * r)) / besselI0(alpha);
+		}
+		default:
+			return ax < 3.0f ? sinc(x) * sinc(x / 3.0f) : 0.0f;
+		}
+	}
+
+	// Pesos de reducción de un eje: para cada píxel de salida, los índices de origen y sus pesos.
+	struct Kernel {
+		std::vector<unsigned int> first;
+		std::vector<unsigned int> count;
+		std::vector<unsigned int> index;
+		std::vector<float> weight;
+	};
+
+	void buildKernel(MipGenerator::Filter filter, unsigned int srcSize, unsigned int dstSize, Kernel& kernel) {
+		kernel.first.resize(dstSize);
+		kernel.count.resize(dstSize);
+		kernel.index.clear();
+		kernel.weight.clear();
+
+		const float scale = (float)srcSize / (float)dstSize;
+		const float support = filterRadius(filter) * scale;
+		for (unsigned int i = 0; i < dstSize; ++i) {
+			kernel.first[i] = (unsigned int)kernel.index.size();
+			if (srcSize == dstSize) {
+				kernel.index.push_back(i);
+				kernel.weight.push_back(1.0f);
+				kernel.count[i] = 1;
+				continue;
+			}
+
+			const float center = (i + 0.5f) * scale - 0.5f;
+			const int jMin = (int)std::ceil(center - support);
+			const int jMax = (int)std::floor(center + support);
+			float sum = 0.0f;
+			for (int j = jMin; j <= jMax; ++j) {
+				const float w = evalFilter(filter, (j - center) / scale);
+				if (w == 0.0f)
+					continue;
+				kernel.index.push_back((unsigned int)std::min(std::max(j, 0), (int)srcSize - 1));
+				kernel.weight.push_back(w);
+				sum += w;
+			}
+			kernel.count[i] = (unsigned int)kernel.index.size() - kernel.first[i];
+			for (unsigned int t = kernel.first[i]; t < kernel.index.size(); ++t)
+				kernel.weight[t] /= sum;
+		}
+	}
+
+	// Reparte [0, count) en bloques contiguos entre threadCount hilos.
+	void parallelRows(unsigned int count, unsigned int threadCount,
+		const std::function<void(unsigned int, unsigned int)>& job) {
+		threadCount = std::max(1u, std::min(threadCount, count));
+		if (threadCount == 1) {
+			job(0, count);
+			return;
+		}
+		std::vector<std::thread> threads;
+		const unsigned int chunk = (count + threadCount - 1) / threadCount;
+		for (unsigned int t = 1; t < threadCount; ++t) {
+			const unsigned int begin = std::min(count, t * chunk);
+			const unsigned int end = std::min(count, begin + chunk);
+			threads.emplace_back(job, begin, end);
+		}
+		job(0, std::min(count, chunk));
+		for (std::thread& thread : threads)
+			thread.join();
+	}
+
+	// Reduce una fila RGBA a dstWidth píxeles.
+	void filterRow(const float* srcRow, float* dstRow, unsigned int dstWidth, const Kernel& kernel, bool useSimd) {
+		for (unsigned int x = 0; x < dstWidth; ++x) {
+			const unsigned int first = kernel.first[x];
+			const unsigned int count = kernel.count[x];
+#if defined(SRT_SIMD_SSE2)
+			if (useSimd) {
+				__m128 acc = _mm_setzero_ps();
+				for (unsigned int t = 0; t < count; ++t) {
+					const __m128 pixel = _mm_loadu_ps(srcRow + kernel.index[first + t] * 4);
+					acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(kernel.weight[first + t]), pixel));
+				}
+				_mm_storeu_ps(dstRow + x * 4, acc);
+				continue;
+			}
+#else
+			(void)useSimd;
+#endif
+			float acc[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			for (unsigned int t = 0; t < count; ++t) {
+				const float* pixel = srcRow + kernel.index[first + t] * 4;
+				const float w = kernel.weight[first + t];
+				for (int c = 0; c < 4; ++c)
+					acc[c] += w * pixel[c];
+			}
+			memcpy(dstRow + x * 4, acc, sizeof(acc));
+		}
+	}
+
+	// Pasa una fila RGBA8 a coma flotante (color en lineal si srgb).
+	void toFloats(const uint8_t* src, float* dst, unsigned int width, bool srgb) {
+		const float* toLinear = srgbToLinearTable();
+		for (unsigned int x = 0; x < width; ++x) {
+			const uint8_t* p = src + x * 4;
+			float* o = dst + x * 4;
+			for (int c = 0; c < 3; ++c)
+				o[c] = srgb ? toLinear[p[c]] : p[c] / 255.0f;
+			o[3] = p[3] / 255.0f;
+		}
+	}
+
+	// Filas de salida [rowBegin, rowEnd): cada una es una combinación de filas completas de src.
+	void verticalPass(const float* src, float* dst, unsigned int width,
+		const Kernel& kernel, unsigned int rowBegin, unsigned int rowEnd, bool useSimd) {
+		const size_t rowFloats = (size_t)width * 4;
+		for (unsigned int y = rowBegin; y < rowEnd; ++y) {
+			const unsigned int first = kernel.first[y];
+			const unsigned int count = kernel.count[y];
+			float* dstRow = dst + (size_t)y * rowFloats;
+			size_t x = 0;
+			if (useSimd) {
+#if defined(SRT_SIMD_AVX2)
+				for (; x + 8 <= rowFloats; x += 8) {
+					__m256 acc = _mm256_setzero_ps();
+					for (unsigned int t = 0; t < count; ++t) {
+						const __m256 v = _mm256_loadu_ps(src + kernel.index[first + t] * rowFloats + x);
+						acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_set1_ps(kernel.weight[first + t]), v));
+					}
+					_mm256_storeu_ps(dstRow + x, acc);
+				}
+#endif
+#if defined(SRT_SIMD_SSE2)
+				for (; x + 4 <= rowFloats; x += 4) {
+					__m128 acc = _mm_setzero_ps();
+					for (unsigned int t = 0; t < count; ++t) {
+						const __m128 v = _mm_loadu_ps(src + kernel.index[first + t] * rowFloats + x);
+						acc = _mm_add_ps(acc, _mm_mul_ps(_mm_set1_ps(kernel.weight[first + t]), v));
+					}
+					_mm_storeu_ps(dstRow + x, acc);
+				}
+#endif
+			}
+			for (; x < rowFloats; ++x) {
+				float acc = 0.0f;
+				for (unsigned int t = 0; t < count; ++t)
+					acc += kernel.weight[first + t] * src[kernel.index[first + t] * rowFloats + x];
+				dstRow[x] = acc;
+			}
+		}
+	}
+
+	inline unsigned int quantize(float v, float steps) {
+		v = v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+		return (unsigned int)(v * steps + 0.5f);
+	}
+
+	void toBytes(const float* src, uint8_t* dst, size_t pixelBegin, size_t pixelEnd, bool srgb, float alphaScale) {
+		const uint8_t* toSrgb = linearToSrgbTable();
+		for (size_t i = pixelBegin; i < pixelEnd; ++i) {
+			const float* p = src + i * 4;
+			uint8_t* o = dst + i * 4;
+			for (int c = 0; c < 3; ++c)
+				o[c] = srgb ? toSrgb[quantize(p[c], (float)LINEAR_STEPS)] : (uint8_t)quantize(p[c], 255.0f);
+			o[3] = (uint8_t)quantize(p[3] * alphaScale, 255.0f);
+		}
+	}
+
+	float alphaCoverage(const float* image, size_t pixelCount, float reference, float scale) {
+		size_t covered = 0;
+		for (size_t i = 0; i < pixelCount; ++i)
+			covered += image[i * 4 + 3] * scale > reference ? 1 : 0;
+		return (float)covered / (float)pixelCount;
+	}
+
+	// Escala de alfa con la que el nivel cubre la misma fracción que el original (Castaño).
+	float coverageScale(const float* image, size_t pixelCount, float reference, float target) {
+		float low = 0.0f;
+		float high = 1.0f;
+		float threshold = reference;
+		for (int i = 0; i < 12; ++i) {
+			threshold = 0.5f * (low + high);
+			if (alphaCoverage(image, pixelCount, threshold, 1.0f) > target)
+				low = threshold;
+			else
+				high = threshold;
+		}
+		return threshold > 0.0f ? reference / threshold : 1.0f;
+	}
+}
+
+unsigned int
+MipGenerator::levelCount(unsigned int width, unsigned int height) {
+	unsigned int levels = 1;
+	unsigned int size = std::max(width, height);
+	while (size > 1) {
+		size >>= 1;
+		++levels;
+	}
+	return levels;
+}
+
+// Filtra cada nivel desde el anterior en coma flotante y lo cuantiza a RGBA8.
+HRESULT
+MipGenerator::generate(const uint8_t* pixels,
+	unsigned int width,
+	unsigned int height,
+	const Options& options,
+	std::vector<MipLevel>& levels) {
+	if (!pixels || width == 0 || height == 0) {
+		ERROR("MipGenerator", "generate", "Invalid pixels or size");
+		return E_INVALIDARG;
+	}
+
+	unsigned int levelTotal = levelCount(width, height);
+	if (options.maxLevels > 0)
+		levelTotal = std::min(levelTotal, options.maxLevels);
+	unsigned int threadCount = options.threadCount;
+	if (threadCount == 0)
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+	levels.resize(levelTotal);
+	levels[0].width = width;
+	levels[0].height = height;
+	levels[0].pixels.assign(pixels, pixels + (size_t)width * height * 4);
+	if (levelTotal == 1)
+		return S_OK;
+
+	// Cobertura de alfa del original.
+	const size_t pixelCount = (size_t)width * height;
+	float targetCoverage = 0.0f;
+	if (options.preserveAlphaCoverage) {
+		size_t coveredPixels = 0;
+		for (size_t i = 0; i < pixelCount; ++i)
+			coveredPixels += pixels[i * 4 + 3] / 255.0f > options.alphaReference ? 1 : 0;
+		targetCoverage = (float)coveredPixels / (float)pixelCount;
+	}
+
+	// El nivel 0 no se pasa entero a coma flotante: cada hilo convierte la fila que filtra.
+	std::vector<float> current;
+	std::vector<float> rows;
+	std::vector<float> next;
+	Kernel horizontal;
+	Kernel vertical;
+	unsigned int srcWidth = width;
+	unsigned int srcHeight = height;
+	for (unsigned int level = 1; level < levelTotal; ++level) {
+		const unsigned int dstWidth = std::max(1u, srcWidth >> 1);
+		const unsigned int dstHeight = std::max(1u, srcHeight >> 1);
+		buildKernel(options.filter, srcWidth, dstWidth, horizontal);
+		buildKernel(options.filter, srcHeight, dstHeight, vertical);
+
+		const unsigned int threads = (size_t)srcWidth * srcHeight >= MIN_PARALLEL_PIXELS ? threadCount : 1;
+		rows.resize((size_t)dstWidth * srcHeight * 4);
+		next.resize((size_t)dstWidth * dstHeight * 4);
+		parallelRows(srcHeight, threads, [&](unsigned int begin, unsigned int end) {
+			std::vector<float> scratch(level == 1 ? (size_t)srcWidth * 4 : 0);
+			for (unsigned int y = begin; y < end; ++y) {
+				const float* srcRow;
+				if (level == 1) {
+					toFloats(pixels + (size_t)y * srcWidth * 4, scratch.data(), srcWidth, options.srgb);
+					srcRow = scratch.data();
+				}
+				else {
+					srcRow = current.data() + (size_t)y * srcWidth * 4;
+				}
+				filterRow(srcRow, rows.data() + (size_t)y * dstWidth * 4, dstWidth, horizontal, options.useSimd);
+			}
+			});
+		parallelRows(dstHeight, threads, [&](unsigned int begin, unsigned int end) {
+			verticalPass(rows.data(), next.data(), dstWidth, vertical, begin, end, options.useSimd);
+			});
+
+		const size_t dstPixels = (size_t)dstWidth * dstHeight;
+		float alphaScale = 1.0f;
+		if (options.preserveAlphaCoverage && targetCoverage > 0.0f && targetCoverage < 1.0f)
+			alphaScale = coverageScale(next.data(), dstPixels, options.alphaReference, targetCoverage);
+
+		MipLevel& out = levels[level];
+		out.width = dstWidth;
+		out.height = dstHeight;
+		out.pixels.resize(dstPixels * 4);
+		parallelRows(dstHeight, threads, [&](unsigned int begin, unsigned int end) {
+			toBytes(next.data(), out.pixels.data(), (size_t)begin * dstWidth, (size_t)end * dstWidth,
+				options.srgb, alphaScale);
+			});
+
+		current.swap(next);
+		srcWidth = dstWidth;
+		srcHeight = dstHeight;
+	}
+	return S_OK;
+}
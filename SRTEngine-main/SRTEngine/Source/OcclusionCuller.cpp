@@ -0,0 +1,467 @@
+#include "OcclusionCuller.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(SRT_SIMD_AVX2)
+#include <immintrin.h>
+#elif defined(SRT_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+	// Mismo envoltorio de SIMD que SoftRasterizer, con lo que necesita el bucle de profundidad.
+#if defined(SRT_SIMD_AVX2)
+	const int LANES = 8;
+	typedef __m256 VecF;
+	typedef __m256i VecI;
+
+	inline VecI iSet(int32_t a) { return _mm256_set1_epi32(a); }
+	inline VecI iRamp(int32_t step) {
+		return _mm256_setr_epi32(0, step, 2 * step, 3 * step, 4 * step, 5 * step, 6 * step, 7 * step);
+	}
+	inline VecI iAdd(VecI a, VecI b) { return _mm256_add_epi32(a, b); }
+	inline VecI iOr(VecI a, VecI b) { return _mm256_or_si256(a, b); }
+	inline int iSignMask(VecI a) { return _mm256_movemask_ps(_mm256_castsi256_ps(a)); }
+
+	inline VecF fSet(float a) { return _mm256_set1_ps(a); }
+	inline VecF fRamp(float step) {
+		return _mm256_setr_ps(0.0f, step, 2 * step, 3 * step, 4 * step, 5 * step, 6 * step, 7 * step);
+	}
+	inline VecF fAdd(VecF a, VecF b) { return _mm256_add_ps(a, b); }
+	inline VecF fMin(VecF a, VecF b) { return _mm256_min_ps(a, b); }
+	inline VecF fLoad(const float* p) { return _mm256_loadu_ps(p); }
+	inline void fStore(float* p, VecF a) { _mm256_storeu_ps(p, a); }
+	inline VecF fSelect(VecF a, VecF b, int mask) {
+		const VecI bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+		VecI m = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(mask), bits), bits);
+		return _mm256_blendv_ps(a, b, _mm256_castsi256_ps(m));
+	}
+#elif defined(SRT_SIMD_SSE2)
+	const int LANES = 4;
+	typedef __m128 VecF;
+	typedef __m128i VecI;
+
+	inline VecI iSet(int32_t a) { return _mm_set1_epi32(a); }
+	inline VecI iRamp(int32_t step) { return _mm_setr_epi32(0, step, 2 * step, 3 * step); }
+	inline VecI iAdd(VecI a, VecI b) { return _mm_add_epi32(a, b); }
+	inline VecI iOr(VecI a, VecI b) { return _mm_or_si128(a, b); }
+	inline int iSignMask(VecI a) { return _mm_movemask_ps(_mm_castsi128_ps(a)); }
+
+	inline VecF fSet(float a) { return _mm_set1_ps(a); }
+	inline VecF fRamp(float step) { return _mm_setr_ps(0.0f, step, 2 * step, 3 * step); }
+	inline VecF fAdd(VecF a, VecF b) { return _mm_add_ps(a, b); }
+	inline VecF fMin(VecF a, VecF b) { return _mm_min_ps(a, b); }
+	inline VecF fLoad(const float* p) { return _mm_loadu_ps(p); }
+	inline void fStore(float* p, VecF a) { _mm_storeu_ps(p, a); }
+	inline VecF fSelect(VecF a, VecF b, int mask) {
+		const VecI bits = _mm_setr_epi32(1, 2, 4, 8);
+		VecF m = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(mask), bits), bits));
+		return _mm_or_ps(_mm_and_ps(m, b), _mm_andnot_ps(m, a));
+	}
+#else
+	const int LANES = 4;
+	struct VecF { float v[4]; };
+	struct VecI { int32_t v[4]; };
+
+	inline VecI iSet(int32_t a) { return VecI{ { a, a, a, a } }; }
+	inline VecI iRamp(int32_t step) { return VecI{ { 0, step, 2 * step, 3 * step } }; }
+	inline VecI iAdd(VecI a, VecI b) { for (int i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+	inline VecI iOr(VecI a, VecI b) { for (int i = 0; i < 4; ++i) a.v[i] |= b.v[i]; return a; }
+	inline int iSignMask(VecI a) {
+		int m = 0;
+		for (int i = 0; i < 4; ++i) m |= (a.v[i] < 0 ? 1 : 0) << i;
+		return m;
+	}
+
+	inline VecF fSet(float a) { return VecF{ { a, a, a, a } }; }
+	inline VecF fRamp(float step) { return VecF{ { 0.0f, step, 2 * step, 3 * step } }; }
+	inline VecF fAdd(VecF a, VecF b) { for (int i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+	inline VecF fMin(VecF a, VecF b) { for (int i = 0; i < 4; ++i) a.v[i] = b.v[i] < a.v[i] ? b.v[i] : a.v[i]; return a; }
+	inline VecF fLoad(const float* p) { return VecF{ { p[0], p[1], p[2], p[3] } }; }
+	inline void fStore(float* p, VecF a) { memcpy(p, a.v, sizeof(a.v)); }
+	inline VecF fSelect(VecF a, VecF b, int mask) {
+		for (int i = 0; i < 4; ++i) if (mask & (1 << i)) a.v[i] = b.v[i];
+		return a;
+	}
+#endif
+
+	const int FULL_MASK = (1 << LANES) - 1;
+	const int SUBPIXEL_BITS = 4;
+
+	// Los triángulos se recortan a |x|, |y| <= GUARD_BAND * w para que las aristas en punto
+	// fijo no desborden; lo que queda fuera de la pantalla lo descarta la caja del triángulo.
+	const float GUARD_BAND = 2.0f;
+
+	// Bits de recorte: guarda en x e y y plano cercano (el lejano no hace falta).
+	unsigned int outcode(const Float4& v) {
+		unsigned int code = 0;
+		if (v.x > GUARD_BAND * v.w) code |= 1;
+		if (v.x < -GUARD_BAND * v.w) code |= 2;
+		if (v.y > GUARD_BAND * v.w) code |= 4;
+		if (v.y < -GUARD_BAND * v.w) code |= 8;
+		if (v.z < 0.0f) code |= 16;
+		return code;
+	}
+
+	float planeDistance(const Float4& v, int plane) {
+		switch (plane) {
+		case 0: return GUARD_BAND * v.w - v.x;
+		case 1: return GUARD_BAND * v.w + v.x;
+		case 2: return GUARD_BAND * v.w - v.y;
+		case 3: return GUARD_BAND * v.w + v.y;
+		default: return v.z;
+		}
+	}
+}
+
+OcclusionCuller::~OcclusionCuller() {
+	destroy();
+}
+
+HRESULT
+OcclusionCuller::init(unsigned int width, unsigned int height) {
+	destroy();
+	if (width == 0 || height == 0) {
+		ERROR("OcclusionCuller", "init", "Invalid depth buffer size");
+		return E_INVALIDARG;
+	}
+	m_width = width;
+	m_height = height;
+
+	// El nivel 0 tiene pitch múltiplo de 8 para que el bucle SIMD no se salga de la fila.
+	unsigned int levelWidth = width;
+	unsigned int levelHeight = height;
+	for (;;) {
+		Level level;
+		level.width = levelWidth;
+		level.height = levelHeight;
+		level.pitch = m_levels.empty() ? (levelWidth + 7) & ~7u : levelWidth;
+		level.depth.assign((size_t)level.pitch * levelHeight, 1.0f);
+		m_levels.push_back(std::move(level));
+		if (levelWidth == 1 && levelHeight == 1)
+			break;
+		levelWidth = std::max(1u, (levelWidth + 1) / 2);
+		levelHeight = std::max(1u, (levelHeight + 1) / 2);
+	}
+	return S_OK;
+}
+
+void
+OcclusionCuller::destroy() {
+	m_levels.clear();
+	m_clip.clear();
+	m_width = 0;
+	m_height = 0;
+	m_pyramidDirty = false;
+	m_stats = Stats();
+}
+
+void
+OcclusionCuller::beginFrame(const Matrix& view, const Matrix& projection) {
+	m_viewProjection = MatrixMultiply(view, projection);
+	for (Level& level : m_levels)
+		std::fill(level.depth.begin(), level.depth.end(), 1.0f);
+	m_pyramidDirty = false;
+	m_stats = Stats();
+}
+
+void
+OcclusionCuller::addOccluder(const void* vertices, unsigned int vertexStride, unsigned int vertexCount,
+	const uint16_t* indices, unsigned int indexCount, const Matrix& world) {
+	rasterizeMesh(vertices, vertexStride, vertexCount, indices, false, indexCount, world);
+}
+
+void
+OcclusionCuller::addOccluder(const void* vertices, unsigned int vertexStride, unsigned int vertexCount,
+	const uint32_t* indices, unsigned int indexCount, const Matrix& world) {
+	rasterizeMesh(vertices, vertexStride, vertexCount, indices, true, indexCount, world);
+}
+
+void
+OcclusionCuller::rasterizeMesh(const void* vertices, unsigned int vertexStride, unsigned int vertexCount,
+	const void* indices, bool indices32, unsigned int indexCount, const Matrix& world) {
+	if (m_levels.empty() || vertexCount == 0)
+		return;
+
+	m_clip.resize(vertexCount);
+	Vector3TransformStream(m_clip.data(), sizeof(Float4), vertices, vertexStride, vertexCount,
+		MatrixMultiply(world, m_viewProjection));
+
+	const uint16_t* indices16 = static_cast<const uint16_t*>(indices);
+	const uint32_t* indices32Ptr = static_cast<const uint32_t*>(indices);
+	for (unsigned int i = 0; i + 2 < indexCount; i += 3) {
+		uint32_t tri[3];
+		for (int k = 0; k < 3; ++k)
+			tri[k] = indices32 ? indices32Ptr[i + k] : indices16[i + k];
+		if (tri[0] >= vertexCount || tri[1] >= vertexCount || tri[2] >= vertexCount) {
+			ERROR("OcclusionCuller", "addOccluder", "Index out of range");
+			return;
+		}
+		++m_stats.occluderTriangles;
+		clipAndRasterize(m_clip[tri[0]], m_clip[tri[1]], m_clip[tri[2]]);
+	}
+	m_pyramidDirty = true;
+}
+
+void
+OcclusionCuller::clipAndRasterize(const Float4& v0, const Float4& v1, const Float4& v2) {
+	const unsigned int c0 = outcode(v0);
+	const unsigned int c1 = outcode(v1);
+	const unsigned int c2 = outcode(v2);
+	if (c0 & c1 & c2)
+		return;
+	if ((c0 | c1 | c2) == 0) {
+		rasterizeTriangle(v0, v1, v2);
+		return;
+	}
+
+	// Cada plano añade como mucho un vértice: 3 + 5 = 8.
+	Float4 polygon[2][8];
+	int count = 3;
+	polygon[0][0] = v0;
+	polygon[0][1] = v1;
+	polygon[0][2] = v2;
+	int src = 0;
+	const unsigned int planes = c0 | c1 | c2;
+	for (int plane = 0; plane < 5 && count >= 3; ++plane) {
+		if (!(planes & (1u << plane)))
+			continue;
+		const Float4* in = polygon[src];
+		Float4* dst = polygon[src ^ 1];
+		int outCount = 0;
+		for (int i = 0; i < count; ++i) {
+			const Float4& a = in[i];
+			const Float4& b = in[(i + 1) % count];
+			const float da = planeDistance(a, plane);
+			const float db = planeDistance(b, plane);
+			if (da >= 0.0f)
+				dst[outCount++] = a;
+			if ((da >= 0.0f) != (db >= 0.0f)) {
+				const float t = da / (da - db);
+				dst[outCount++] = Float4(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t,
+					a.z + (b.z - a.z) * t, a.w + (b.w - a.w) * t);
+			}
+		}
+		count = outCount;
+		src ^= 1;
+	}
+
+	for (int i = 1; i + 1 < count; ++i)
+		rasterizeTriangle(polygon[src][0], polygon[src][i], polygon[src][i + 1]);
+}
+
+// Aristas en punto fijo como SoftRasterizer; cada píxel cubierto se queda con la profundidad
+// más cercana entre la que tenía y la del punto más lejano del triángulo dentro del píxel.
+void
+OcclusionCuller::rasterizeTriangle(const Float4& v0, const Float4& v1, const Float4& v2) {
+	const Float4* v[3] = { &v0, &v1, &v2 };
+	const float subpixel = (float)(1 << SUBPIXEL_BITS);
+	float sx[3], sy[3], sz[3];
+	int32_t fx[3], fy[3];
+	for (int i = 0; i < 3; ++i) {
+		if (v[i]->w <= 0.0f)
+			return;
+		const float invW = 1.0f / v[i]->w;
+		fx[i] = (int32_t)std::lround((v[i]->x * invW * 0.5f + 0.5f) * m_width * subpixel);
+		fy[i] = (int32_t)std::lround((0.5f - v[i]->y * invW * 0.5f) * m_height * subpixel);
+		sx[i] = fx[i] / subpixel;
+		sy[i] = fy[i] / subpixel;
+		sz[i] = v[i]->z * invW;
+	}
+
+	// Solo caras frontales (sentido horario en pantalla, como el culling por defecto de D3D11).
+	const int64_t area = (int64_t)(fx[1] - fx[0]) * (fy[2] - fy[0]) - (int64_t)(fy[1] - fy[0]) * (fx[2] - fx[0]);
+	if (area <= 0)
+		return;
+
+	const int32_t half = 1 << SUBPIXEL_BITS >> 1;
+	const int32_t mask = (1 << SUBPIXEL_BITS) - 1;
+	const int32_t minX = std::max(0, (std::min(fx[0], std::min(fx[1], fx[2])) - half + mask) >> SUBPIXEL_BITS);
+	const int32_t minY = std::max(0, (std::min(fy[0], std::min(fy[1], fy[2])) - half + mask) >> SUBPIXEL_BITS);
+	const int32_t maxX = std::min((int32_t)m_width - 1, (std::max(fx[0], std::max(fx[1], fx[2])) - half) >> SUBPIXEL_BITS);
+	const int32_t maxY = std::min((int32_t)m_height - 1, (std::max(fy[0], std::max(fy[1], fy[2])) - half) >> SUBPIXEL_BITS);
+	if (minX > maxX || minY > maxY)
+		return;
+	++m_stats.rasterizedTriangles;
+
+	// Arista k opuesta al vértice k, con la regla top-left.
+	int32_t edgeA[3], edgeB[3];
+	int64_t edgeC[3];
+	for (int k = 0; k < 3; ++k) {
+		const int a = (k + 1) % 3;
+		const int b = (k + 2) % 3;
+		const int32_t dx = fx[b] - fx[a];
+		const int32_t dy = fy[b] - fy[a];
+		edgeA[k] = -dy;
+		edgeB[k] = dx;
+		edgeC[k] = (int64_t)dy * fx[a] - (int64_t)dx * fy[a];
+		const bool topLeft = dy < 0 || (dy == 0 && dx > 0);
+		if (!topLeft)
+			edgeC[k] -= 1;
+	}
+
+	// Plano de profundidad desplazado al punto más lejano del píxel, sin pasar del triángulo.
+	const float x10 = sx[1] - sx[0], y10 = sy[1] - sy[0];
+	const float x20 = sx[2] - sx[0], y20 = sy[2] - sy[0];
+	const float invArea = 1.0f / (x10 * y20 - x20 * y10);
+	const float d10 = sz[1] - sz[0];
+	const float d20 = sz[2] - sz[0];
+	const float dzdx = (d10 * y20 - d20 * y10) * invArea;
+	const float dzdy = (d20 * x10 - d10 * x20) * invArea;
+	const float z0 = sz[0] - dzdx * sx[0] - dzdy * sy[0] + 0.5f * (std::fabs(dzdx) + std::fabs(dzdy));
+	const VecF zFar = fSet(std::max(sz[0], std::max(sz[1], sz[2])));
+
+	const int32_t sub = 1 << SUBPIXEL_BITS;
+	VecI edgeLaneOffset[3];
+	VecI edgeStepX[3];
+	for (int k = 0; k < 3; ++k) {
+		edgeLaneOffset[k] = iRamp(edgeA[k] * sub);
+		edgeStepX[k] = iSet(edgeA[k] * sub * LANES);
+	}
+	const VecF zStep = fSet(dzdx * LANES);
+	const VecF zLane = fRamp(dzdx);
+
+	Level& target = m_levels[0];
+	const int xStart = minX & ~(LANES - 1);
+	for (int y = minY; y <= maxY; ++y) {
+		const int64_t py = (int64_t)y * sub + half;
+		const int64_t px = (int64_t)xStart * sub + half;
+		VecI e[3];
+		for (int k = 0; k < 3; ++k)
+			e[k] = iAdd(iSet((int32_t)(edgeA[k] * px + edgeB[k] * py + edgeC[k])), edgeLaneOffset[k]);
+		VecF z = fAdd(fSet(z0 + dzdx * (xStart + 0.5f) + dzdy * (y + 0.5f)), zLane);
+		float* row = target.depth.data() + (size_t)y * target.pitch;
+
+		for (int x = xStart; x <= maxX; x += LANES) {
+			int covered = ~iSignMask(iOr(iOr(e[0], e[1]), e[2])) & FULL_MASK;
+			if (x < minX)
+				covered &= FULL_MASK << (minX - x);
+			if (x + LANES - 1 > maxX)
+				covered &= FULL_MASK >> (x + LANES - 1 - maxX);
+			if (covered) {
+				const VecF old = fLoad(row + x);
+				fStore(row + x, fSelect(old, fMin(old, fMin(z, zFar)), covered));
+			}
+			for (int k = 0; k < 3; ++k)
+				e[k] = iAdd(e[k], edgeStepX[k]);
+			z = fAdd(z, zStep);
+		}
+	}
+}
+
+// Cada texel de un nivel es el máximo (lo más lejano) de sus 2x2 texeles del nivel anterior.
+void
+OcclusionCuller::finishOccluders() {
+	for (size_t l = 1; l < m_levels.size(); ++l) {
+		const Level& src = m_levels[l - 1];
+		Level& dst = m_levels[l];
+		for (unsigned int y = 0; y < dst.height; ++y) {
+			const float* row0 = src.depth.data() + (size_t)std::min(2 * y, src.height - 1) * src.pitch;
+			const float* row1 = src.depth.data() + (size_t)std::min(2 * y + 1, src.height - 1) * src.pitch;
+			float* out = dst.depth.data() + (size_t)y * dst.pitch;
+			for (unsigned int x = 0; x < dst.width; ++x) {
+				const unsigned int x0 = std::min(2 * x, src.width - 1);
+				const unsigned int x1 = std::min(2 * x + 1, src.width - 1);
+				out[x] = std::max(std::max(row0[x0], row0[x1]), std::max(row1[x0], row1[x1]));
+			}
+		}
+	}
+	m_pyramidDirty = false;
+}
+
+// Proyecta las ocho esquinas y compara su profundidad más cercana con la pirámide.
+bool
+OcclusionCuller::isBoxVisible(const Float3& center, const Float3& extents) const {
+	if (m_levels.empty())
+		return true;
+
+	const Matrix& m = m_viewProjection;
+	const Vector clipCenter = Vector3Transform(VectorLoad(center), m);
+	const Vector axisX = VectorScale(m.r[0], extents.x);
+	const Vector axisY = VectorScale(m.r[1], extents.y);
+	const Vector axisZ = VectorScale(m.r[2], extents.z);
+
+	float minX = 1e30f, minY = 1e30f, maxX = -1e30f, maxY = -1e30f, minZ = 1e30f;
+	for (int corner = 0; corner < 8; ++corner) {
+		Vector p = clipCenter;
+		p = (corner & 1) ? VectorAdd(p, axisX) : VectorSubtract(p, axisX);
+		p = (corner & 2) ? VectorAdd(p, axisY) : VectorSubtract(p, axisY);
+		p = (corner & 4) ? VectorAdd(p, axisZ) : VectorSubtract(p, axisZ);
+		Float4 clip;
+		VectorStore(clip, p);
+		// Si cruza el plano cercano no se puede acotar en pantalla: se da por visible.
+		if (clip.z < 0.0f || clip.w <= 0.0f)
+			return true;
+		const float invW = 1.0f / clip.w;
+		minX = std::min(minX, clip.x * invW);
+		maxX = std::max(maxX, clip.x * invW);
+		minY = std::min(minY, clip.y * invW);
+		maxY = std::max(maxY, clip.y * invW);
+		minZ = std::min(minZ, clip.z * invW);
+	}
+
+	// Rectángulo en píxeles del nivel 0 (y hacia abajo), recortado a la pantalla.
+	const float left = (minX * 0.5f + 0.5f) * m_width;
+	const float right = (maxX * 0.5f + 0.5f) * m_width;
+	const float top = (0.5f - maxY * 0.5f) * m_height;
+	const float bottom = (0.5f - minY * 0.5f) * m_height;
+	if (right < 0.0f || bottom < 0.0f || left >= (float)m_width || top >= (float)m_height)
+		return false;
+	// Un píxel más por cada lado: un píxel del borde de un oclusor puede estar marcado como
+	// cubierto (por su centro) aunque la caja asome por la parte que no tapa; el vecino del
+	// otro lado de la arista sí queda sin cubrir.
+	unsigned int x0 = (unsigned int)std::max(0.0f, std::floor(left) - 1.0f);
+	unsigned int y0 = (unsigned int)std::max(0.0f, std::floor(top) - 1.0f);
+	unsigned int x1 = (unsigned int)std::min((float)m_width - 1.0f, std::floor(right) + 1.0f);
+	unsigned int y1 = (unsigned int)std::min((float)m_height - 1.0f, std::floor(bottom) + 1.0f);
+
+	size_t l = 0;
+	while (l + 1 < m_levels.size() && ((x1 >> l) - (x0 >> l) > 3 || (y1 >> l) - (y0 >> l) > 3))
+		++l;
+	const Level& level = m_levels[l];
+	x0 >>= l;
+	x1 >>= l;
+	y0 >>= l;
+	y1 >>= l;
+	for (unsigned int y = y0; y <= y1; ++y) {
+		const float* row = level.depth.data() + (size_t)y * level.pitch;
+		for (unsigned int x = x0; x <= x1; ++x) {
+			if (row[x] >= minZ)
+				return true;
+		}
+	}
+	return false;
+}
+
+void
+OcclusionCuller::cullBoxes(const BoundingBoxes& boxes, std::vector<uint32_t>& visible) {
+	if (m_pyramidDirty)
+		finishOccluders();
+	size_t kept = 0;
+	for (uint32_t index : visible) {
+		if (isBoxVisible(Float3(boxes.centerX[index], boxes.centerY[index], boxes.centerZ[index]),
+			Float3(boxes.extentX[index], boxes.extentY[index], boxes.extentZ[index])))
+			visible[kept++] = index;
+	}
+	m_stats.tested += (unsigned int)visible.size();
+	m_stats.occluded += (unsigned int)(visible.size() - kept);
+	visible.resize(kept);
+}
+
+void
+OcclusionCuller::cullSpheres(const BoundingSpheres& spheres, std::vector<uint32_t>& visible) {
+	if (m_pyramidDirty)
+		finishOccluders();
+	size_t kept = 0;
+	for (uint32_t index : visible) {
+		const float r = spheres.radius[index];
+		if (isBoxVisible(Float3(spheres.centerX[index], spheres.centerY[index], spheres.centerZ[index]),
+			Float3(r, r, r)))
+			visible[kept++] = index;
+	}
+	m_stats.tested += (unsigned int)visible.size();
+	m_stats.occluded += (unsigned int)(visible.size() - kept);
+	visible.resize(kept);
+}
@@ -0,0 +1,201 @@
+#include "RecordingContext.h"
+#include "CommandList.h"
+
+// Contadores a cero y driver y caché en el estado inicial; las vistas registradas se conservan.
+void
+RecordingContext::reset() {
+	for (unsigned int& calls : m_calls)
+		calls = 0;
+	m_staleDraws = 0;
+	ClearState();
+}
+
+void
+RecordingContext::ClearState() {
+	for (unsigned int slot = 0; slot < StateCache::MAX_SHADER_RESOURCES; ++slot) {
+		m_driverViews[slot] = nullptr;
+		m_expectedViews[slot] = nullptr;
+	}
+	for (unsigned int i = 0; i <= StateCache::MAX_RENDER_TARGETS; ++i) {
+		m_driverTargets[i] = nullptr;
+		m_expectedTargets[i] = nullptr;
+	}
+	m_stateCache.invalidate();
+}
+
+void
+RecordingContext::registerView(const void* view, const void* resource) {
+	m_viewResources[view] = resource;
+}
+
+unsigned int
+RecordingContext::getStateCallCount() const {
+	unsigned int total = 0;
+	for (unsigned int call = 0; call < CALL_UPDATE_SUBRESOURCE; ++call)
+		total += m_calls[call];
+	return total;
+}
+
+const void*
+RecordingContext::resourceOf(const void* view) const {
+	if (!view)
+		return nullptr;
+	const auto found = m_viewResources.find(view);
+	return found != m_viewResources.end() ? found->second : nullptr;
+}
+
+bool
+RecordingContext::isTarget(const void* const* targets, const void* resource) {
+	if (!resource)
+		return false;
+	for (unsigned int i = 0; i <= StateCache::MAX_RENDER_TARGETS; ++i) {
+		if (targets[i] == resource)
+			return true;
+	}
+	return false;
+}
+
+void
+RecordingContext::executeCommandList(const CommandList& commandList) {
+	commandList.replay(*this);
+}
+
+// Los filtros son los mismos que hace DeviceContext antes de llamar al driver.
+void
+RecordingContext::setInputLayout(const void* inputLayout) {
+	if (m_stateCache.setInputLayout(inputLayout))
+		++m_calls[CALL_INPUT_LAYOUT];
+}
+
+void
+RecordingContext::setVertexBuffer(unsigned int slot, const void* buffer, unsigned int stride, unsigned int offset) {
+	unsigned int first, count;
+	if (m_stateCache.setVertexBuffers(slot, 1, &buffer, &stride, &offset, first, count))
+		++m_calls[CALL_VERTEX_BUFFERS];
+}
+
+void
+RecordingContext::setIndexBuffer(const void* buffer, CommandList::IndexWidth width, unsigned int offset) {
+	if (m_stateCache.setIndexBuffer(buffer, width, offset))
+		++m_calls[CALL_INDEX_BUFFER];
+}
+
+void
+RecordingContext::setPrimitiveTopology(unsigned int topology) {
+	if (m_stateCache.setPrimitiveTopology(topology))
+		++m_calls[CALL_PRIMITIVE_TOPOLOGY];
+}
+
+void
+RecordingContext::setShader(StateCache::Stage stage, const void* shader) {
+	if (m_stateCache.setShader(stage, shader, 0))
+		++m_calls[stage == StateCache::VERTEX_STAGE ? CALL_VS_SET_SHADER : CALL_PS_SET_SHADER];
+}
+
+void
+RecordingContext::setConstantBuffer(StateCache::Stage stage, unsigned int slot, const void* buffer) {
+	unsigned int first, count;
+	if (m_stateCache.setConstantBuffers(stage, slot, 1, &buffer, first, count))
+		++m_calls[stage == StateCache::VERTEX_STAGE ? CALL_VS_CONSTANT_BUFFERS : CALL_PS_CONSTANT_BUFFERS];
+}
+
+void
+RecordingContext::setConstantBufferRange(StateCache::Stage stage, unsigned int slot, const void* buffer,
+	unsigned int firstConstant, unsigned int numConstants) {
+	unsigned int first, count;
+	if (m_stateCache.setConstantBufferRanges(stage, slot, 1, &buffer, &firstConstant, &numConstants, first, count))
+		++m_calls[stage == StateCache::VERTEX_STAGE ? CALL_VS_CONSTANT_BUFFERS : CALL_PS_CONSTANT_BUFFERS];
+}
+
+// Como DeviceContext, solo el pixel shader tiene texturas. Si la vista es de un recurso que
+// está enlazado como target, el driver la deja a nulo.
+void
+RecordingContext::setShaderResource(StateCache::Stage stage, unsigned int slot, const void* view) {
+	if (stage != StateCache::PIXEL_STAGE || slot >= StateCache::MAX_SHADER_RESOURCES)
+		return;
+	const void* resource = resourceOf(view);
+	m_expectedViews[slot] = isTarget(m_expectedTargets, resource) ? nullptr : view;
+	unsigned int first, count;
+	if (!m_stateCache.setShaderResources(stage, slot, 1, &view, first, count, &resource))
+		return;
+	++m_calls[CALL_PS_SHADER_RESOURCES];
+	m_driverViews[slot] = isTarget(m_driverTargets, resource) ? nullptr : view;
+}
+
+void
+RecordingContext::setSampler(StateCache::Stage stage, unsigned int slot, const void* sampler) {
+	if (stage != StateCache::PIXEL_STAGE)
+		return;
+	unsigned int first, count;
+	if (m_stateCache.setSamplers(stage, slot, 1, &sampler, first, count))
+		++m_calls[CALL_PS_SAMPLERS];
+}
+
+void
+RecordingContext::setViewport(const CommandList::Viewport& viewport) {
+	if (m_stateCache.setViewports(1, &viewport, sizeof(viewport)))
+		++m_calls[CALL_VIEWPORTS];
+}
+
+// Enlaza los targets en una de las copias del driver y quita los SRV de esos recursos.
+void
+RecordingContext::bindTargets(const void** targets, const void** views, unsigned int numViews,
+	const void* const* renderTargetViews, const void* depthStencilView) const {
+	for (unsigned int i = 0; i <= StateCache::MAX_RENDER_TARGETS; ++i)
+		targets[i] = nullptr;
+	for (unsigned int i = 0; i < numViews && i < StateCache::MAX_RENDER_TARGETS; ++i)
+		targets[i] = resourceOf(renderTargetViews[i]);
+	targets[StateCache::MAX_RENDER_TARGETS] = resourceOf(depthStencilView);
+	for (unsigned int slot = 0; slot < StateCache::MAX_SHADER_RESOURCES; ++slot) {
+		if (isTarget(targets, resourceOf(views[slot])))
+			views[slot] = nullptr;
+	}
+}
+
+// El driver desenlaza los SRV cuyo recurso pasa a ser render target o depth stencil.
+void
+RecordingContext::setRenderTargets(unsigned int numViews, const void* const* renderTargetViews,
+	const void* depthStencilView) {
+	bindTargets(m_expectedTargets, m_expectedViews, numViews, renderTargetViews, depthStencilView);
+
+	const void* resources[StateCache::MAX_RENDER_TARGETS + 1];
+	const bool knownResources = numViews <= StateCache::MAX_RENDER_TARGETS;
+	if (knownResources) {
+		for (unsigned int i = 0; i < numViews; ++i)
+			resources[i] = resourceOf(renderTargetViews[i]);
+		resources[numViews] = resourceOf(depthStencilView);
+	}
+	if (!m_stateCache.setRenderTargets(numViews, renderTargetViews, depthStencilView,
+		knownResources ? resources : nullptr))
+		return;
+	++m_calls[CALL_RENDER_TARGETS];
+	bindTargets(m_driverTargets, m_driverViews, numViews, renderTargetViews, depthStencilView);
+}
+
+void
+RecordingContext::updateConstantBuffer(const void*, const void*, unsigned int) {
+	++m_calls[CALL_UPDATE_SUBRESOURCE];
+}
+
+void
+RecordingContext::drawIndexed(unsigned int, unsigned int, int) {
+	++m_calls[CALL_DRAW_INDEXED];
+	checkStaleViews();
+}
+
+void
+RecordingContext::drawIndexedInstanced(unsigned int, unsigned int, unsigned int, int, unsigned int) {
+	++m_calls[CALL_DRAW_INDEXED_INSTANCED];
+	checkStaleViews();
+}
+
+// Un SRV distinto del que habría sin filtrar es estado que la caché dio por bueno sin serlo.
+void
+RecordingContext::checkStaleViews() {
+	for (unsigned int slot = 0; slot < StateCache::MAX_SHADER_RESOURCES; ++slot) {
+		if (m_driverViews[slot] != m_expectedViews[slot]) {
+			++m_staleDraws;
+			return;
+		}
+	}
+}
@@ -0,0 +1,296 @@
+#include "RenderQueue.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+	const unsigned int RADIX_BITS = 11;
+	const unsigned int RADIX_BUCKETS = 1u << RADIX_BITS;
+	const unsigned int RADIX_DIGITS = (64 + RADIX_BITS - 1) / RADIX_BITS;
+	const unsigned int MIN_CHUNK_SIZE = 16384; // Por debajo, repartir cuesta más que ordenar.
+	const unsigned int TRIANGLE_LIST = 4;      // D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST
+
+	inline uint64_t
+	field(unsigned int value, unsigned int bits) {
+		return (uint64_t)(value & ((1u << bits) - 1));
+	}
+
+	inline uint64_t
+	quantizeDepth(float depth, unsigned int bits) {
+		if (!(depth > 0.0f))
+			depth = 0.0f;
+		if (depth > 1.0f)
+			depth = 1.0f;
+		return (uint64_t)(depth * (float)((1u << bits) - 1) + 0.5f);
+	}
+
+	inline unsigned int
+	digitOf(uint64_t key, unsigned int digit) {
+		return (unsigned int)(key >> (digit * RADIX_BITS)) & (RADIX_BUCKETS - 1);
+	}
+}
+
+HRESULT
+RenderQueue::init(JobSystem* jobs) {
+	m_jobs = jobs;
+	m_sortEnabled = true;
+	clear();
+	return S_OK;
+}
+
+void
+RenderQueue::destroy() {
+	clear();
+	m_draws.shrink_to_fit();
+	m_entries.shrink_to_fit();
+	m_scratch.clear();
+	m_scratch.shrink_to_fit();
+	m_histograms.clear();
+	m_histograms.shrink_to_fit();
+	m_jobs = nullptr;
+	m_stats = Stats();
+}
+
+void
+RenderQueue::clear() {
+	m_draws.clear();
+	m_entries.clear();
+	m_sorted = true;
+}
+
+void
+RenderQueue::reserve(unsigned int drawCount) {
+	m_draws.reserve(drawCount);
+	m_entries.reserve(drawCount);
+	m_scratch.reserve(drawCount);
+}
+
+void
+RenderQueue::add(uint64_t key, const Draw& draw) {
+	Entry entry;
+	entry.key = key;
+	entry.draw = (uint32_t)m_draws.size();
+	m_entries.push_back(entry);
+	m_draws.push_back(draw);
+	m_sorted = false;
+}
+
+void
+RenderQueue::sort() {
+	const auto start = std::chrono::steady_clock::now();
+	m_stats.radixPasses = 0;
+	if (!m_sorted)
+		radixSort();
+	m_sorted = true;
+	m_stats.sortSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Radix sort LSD estable por tramos: cada tramo cuenta sus dígitos, un prefijo por dígito y
+// tramo le da a cada uno su zona de destino, y los tramos reparten en paralelo sin pisarse.
+void
+RenderQueue::radixSort() {
+	const unsigned int count = (unsigned int)m_entries.size();
+	if (count < 2)
+		return;
+
+	const unsigned int threads = m_jobs ? m_jobs->getThreadCount() : 1;
+	unsigned int chunkSize = (count + threads * 4 - 1) / (threads * 4);
+	if (chunkSize < MIN_CHUNK_SIZE)
+		chunkSize = MIN_CHUNK_SIZE;
+	const unsigned int chunks = (count + chunkSize - 1) / chunkSize;
+
+	auto forEachChunk = [&](const auto& job) {
+		if (m_jobs) {
+			m_jobs->parallelFor(chunks, 1, [&](unsigned int begin, unsigned int end) {
+				for (unsigned int chunk = begin; chunk < end; ++chunk)
+					job(chunk, chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize));
+			});
+		}
+		else {
+			for (unsigned int chunk = 0; chunk < chunks; ++chunk)
+				job(chunk, chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize));
+		}
+	};
+
+	// Histogramas de todos los dígitos en una sola lectura, para saber qué pasadas se pueden saltar.
+	m_histograms.assign((size_t)chunks * RADIX_DIGITS * RADIX_BUCKETS, 0);
+	const Entry* source = m_entries.data();
+	forEachChunk([&](unsigned int chunk, unsigned int begin, unsigned int end) {
+		uint32_t* histogram = m_histograms.data() + (size_t)chunk * RADIX_DIGITS * RADIX_BUCKETS;
+		for (unsigned int i = begin; i < end; ++i) {
+			const uint64_t key = source[i].key;
+			for (unsigned int digit = 0; digit < RADIX_DIGITS; ++digit)
+				++histogram[digit * RADIX_BUCKETS + digitOf(key, digit)];
+		}
+	});
+
+	bool needed[RADIX_DIGITS];
+	for (unsigned int digit = 0; digit < RADIX_DIGITS; ++digit) {
+		needed[digit] = true;
+		for (unsigned int bucket = 0; bucket < RADIX_BUCKETS && needed[digit]; ++bucket) {
+			uint32_t total = 0;
+			for (unsigned int chunk = 0; chunk < chunks; ++chunk)
+				total += m_histograms[((size_t)chunk * RADIX_DIGITS + digit) * RADIX_BUCKETS + bucket];
+			if (total == count)
+				needed[digit] = false;
+		}
+	}
+
+	m_scratch.resize(count);
+	Entry* from = m_entries.data();
+	Entry* to = m_scratch.data();
+	std::vector<uint32_t> offsets((size_t)chunks * RADIX_BUCKETS);
+	bool firstPass = true;
+	for (unsigned int digit = 0; digit < RADIX_DIGITS; ++digit) {
+		if (!needed[digit])
+			continue;
+
+		// En la primera pasada los tramos siguen como al principio y sirve el histograma global.
+		if (firstPass) {
+			for (unsigned int chunk = 0; chunk < chunks; ++chunk) {
+				memcpy(offsets.data() + (size_t)chunk * RADIX_BUCKETS,
+					m_histograms.data() + ((size_t)chunk * RADIX_DIGITS + digit) * RADIX_BUCKETS,
+					RADIX_BUCKETS * sizeof(uint32_t));
+			}
+		}
+		else {
+			forEachChunk([&](unsigned int chunk, unsigned int begin, unsigned int end) {
+				uint32_t* histogram = offsets.data() + (size_t)chunk * RADIX_BUCKETS;
+				memset(histogram, 0, RADIX_BUCKETS * sizeof(uint32_t));
+				for (unsigned int i = begin; i < end; ++i)
+					++histogram[digitOf(from[i].key, digit)];
+			});
+		}
+		firstPass = false;
+
+		// Prefijo por dígito y, dentro de cada dígito, por tramo: así el reparto es estable.
+		uint32_t running = 0;
+		for (unsigned int bucket = 0; bucket < RADIX_BUCKETS; ++bucket) {
+			for (unsigned int chunk = 0; chunk < chunks; ++chunk) {
+				uint32_t& slot = offsets[(size_t)chunk * RADIX_BUCKETS + bucket];
+				const uint32_t bucketCount = slot;
+				slot = running;
+				running += bucketCount;
+			}
+		}
+
+		forEachChunk([&](unsigned int chunk, unsigned int begin, unsigned int end) {
+			uint32_t* cursor = offsets.data() + (size_t)chunk * RADIX_BUCKETS;
+			for (unsigned int i = begin; i < end; ++i)
+				to[cursor[digitOf(from[i].key, digit)]++] = from[i];
+		});
+		std::swap(from, to);
+		++m_stats.radixPasses;
+	}
+
+	if (from != m_entries.data())
+		m_entries.swap(m_scratch);
+}
+
+// Graba los draws con los binds que cambian respecto al anterior.
+void
+RenderQueue::submit(CommandList& commandList) {
+	if (m_sortEnabled && !m_sorted)
+		sort();
+
+	const auto start = std::chrono::steady_clock::now();
+	m_stats.draws = 0;
+	m_stats.stateChanges = 0;
+	m_stats.inputLayoutChanges = 0;
+	m_stats.shaderChanges = 0;
+	m_stats.bufferChanges = 0;
+	m_stats.constantChanges = 0;
+	m_stats.constantUploads = 0;
+	m_stats.textureChanges = 0;
+
+	commandList.setPrimitiveTopology(TRIANGLE_LIST);
+
+	const Draw* previous = nullptr;
+	const unsigned int count = (unsigned int)m_draws.size();
+	for (unsigned int i = 0; i < count; ++i) {
+		const Draw& draw = m_draws[m_sortEnabled ? m_entries[i].draw : i];
+
+		if (!previous || draw.inputLayout != previous->inputLayout) {
+			commandList.setInputLayout(draw.inputLayout);
+			++m_stats.inputLayoutChanges;
+		}
+		if (!previous || draw.vertexShader != previous->vertexShader) {
+			commandList.setShader(StateCache::VERTEX_STAGE, draw.vertexShader);
+			++m_stats.shaderChanges;
+		}
+		if (!previous || draw.pixelShader != previous->pixelShader) {
+			commandList.setShader(StateCache::PIXEL_STAGE, draw.pixelShader);
+			++m_stats.shaderChanges;
+		}
+		if (!previous || draw.vertexBuffer != previous->vertexBuffer || draw.vertexStride != previous->vertexStride) {
+			commandList.setVertexBuffer(0, draw.vertexBuffer, draw.vertexStride, 0);
+			++m_stats.bufferChanges;
+		}
+		if (!previous || draw.indexBuffer != previous->indexBuffer || draw.indexWidth != previous->indexWidth) {
+			commandList.setIndexBuffer(draw.indexBuffer, draw.indexWidth, 0);
+			++m_stats.bufferChanges;
+		}
+		if (draw.constantBuffer) {
+			const bool sameBuffer = previous && draw.constantBuffer == previous->constantBuffer;
+			if (draw.numConstants > 0) {
+				// Rango ya escrito (anillo de constantes): solo se enlaza si cambia.
+				if (!sameBuffer || draw.firstConstant != previous->firstConstant ||
+					draw.numConstants != previous->numConstants) {
+					commandList.setConstantBufferRange(StateCache::VERTEX_STAGE, 2, draw.constantBuffer,
+						draw.firstConstant, draw.numConstants);
+					commandList.setConstantBufferRange(StateCache::PIXEL_STAGE, 2, draw.constantBuffer,
+						draw.firstConstant, draw.numConstants);
+					++m_stats.constantChanges;
+				}
+			}
+			else {
+				if (draw.constants && (!sameBuffer || previous->numConstants > 0 || draw.constants != previous->constants)) {
+					commandList.updateConstantBuffer(draw.constantBuffer, draw.constants, draw.constantsSize);
+					++m_stats.constantUploads;
+				}
+				if (!sameBuffer || previous->numConstants > 0) {
+					commandList.setConstantBuffer(StateCache::VERTEX_STAGE, 2, draw.constantBuffer);
+					commandList.setConstantBuffer(StateCache::PIXEL_STAGE, 2, draw.constantBuffer);
+					++m_stats.constantChanges;
+				}
+			}
+		}
+		if (draw.texture && (!previous || draw.texture != previous->texture)) {
+			commandList.setShaderResource(StateCache::PIXEL_STAGE, 0, draw.texture);
+			++m_stats.textureChanges;
+		}
+
+		commandList.drawIndexed(draw.indexCount, draw.startIndexLocation, draw.baseVertexLocation);
+		++m_stats.draws;
+		previous = &draw;
+	}
+
+	m_stats.stateChanges = m_stats.inputLayoutChanges + m_stats.shaderChanges + m_stats.bufferChanges +
+		m_stats.constantChanges + m_stats.textureChanges;
+	m_stats.submitSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+uint64_t
+RenderQueue::makeKey(unsigned int pass, unsigned int layer, unsigned int shader,
+	unsigned int material, unsigned int texture, float depth) {
+	uint64_t key = field(pass, PASS_BITS);
+	key = (key << LAYER_BITS) | field(layer, LAYER_BITS);
+	key = (key << SHADER_BITS) | field(shader, SHADER_BITS);
+	key = (key << MATERIAL_BITS) | field(material, MATERIAL_BITS);
+	key = (key << TEXTURE_BITS) | field(texture, TEXTURE_BITS);
+	key = (key << DEPTH_BITS) | quantizeDepth(depth, DEPTH_BITS);
+	return key;
+}
+
+uint64_t
+RenderQueue::makeBackToFrontKey(unsigned int pass, unsigned int layer, float depth,
+	unsigned int shader, unsigned int material, unsigned int texture) {
+	const uint64_t farthestFirst = field((1u << DEPTH_BITS) - 1, DEPTH_BITS) - quantizeDepth(depth, DEPTH_BITS);
+	uint64_t key = field(pass, PASS_BITS);
+	key = (key << LAYER_BITS) | field(layer, LAYER_BITS);
+	key = (key << DEPTH_BITS) | farthestFirst;
+	key = (key << SHADER_BITS) | field(shader, SHADER_BITS);
+	key = (key << MATERIAL_BITS) | field(material, MATERIAL_BITS);
+	key = (key << TEXTURE_BITS) | field(texture, TEXTURE_BITS);
+	return key;
+}
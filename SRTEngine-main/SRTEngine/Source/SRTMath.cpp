@@ -0,0 +1,307 @@
+#include "SRTMath.h"
+
+#if defined(SRT_MATH_SSE) && defined(SRT_SIMD_AVX2)
+#include <immintrin.h>
+#define SRT_MATH_AVX2 1
+#endif
+
+namespace {
+
+	void storeMatrix(float* out, const Matrix& m) {
+		for (int row = 0; row < 4; ++row)
+			VectorStore(*reinterpret_cast<Float4*>(out + row * 4), m.r[row]);
+	}
+
+	const Float3& loadAt(const void* base, size_t stride, size_t index) {
+		return *reinterpret_cast<const Float3*>(static_cast<const uint8_t*>(base) + index * stride);
+	}
+
+	uint8_t* outputAt(void* base, size_t stride, size_t index) {
+		return static_cast<uint8_t*>(base) + index * stride;
+	}
+
+#if defined(SRT_MATH_AVX2)
+	// Dos puntos por registro: la mitad baja es el punto i y la alta el i + 1.
+	__m256 loadPair(const void* in, size_t inStride, size_t index) {
+		const __m128 first = VectorLoad(loadAt(in, inStride, index));
+		const __m128 second = VectorLoad(loadAt(in, inStride, index + 1));
+		return _mm256_insertf128_ps(_mm256_castps128_ps256(first), second, 1);
+	}
+
+	// Mismo orden de sumas que Vector3Transform / Vector3TransformNormal.
+	__m256 transformPair(__m256 points, const __m256 rows[4], bool translate) {
+		__m256 result = _mm256_mul_ps(_mm256_permute_ps(points, 0x00), rows[0]);
+		result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_permute_ps(points, 0x55), rows[1]));
+		result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_permute_ps(points, 0xAA), rows[2]));
+		return translate ? _mm256_add_ps(result, rows[3]) : result;
+	}
+
+	void broadcastRows(const Matrix& m, __m256 rows[4]) {
+		for (int row = 0; row < 4; ++row)
+			rows[row] = _mm256_broadcast_ps(&m.r[row]);
+	}
+#endif
+}
+
+Matrix
+MatrixRotationX(float angle) {
+	const float s = std::sin(angle), c = std::cos(angle);
+	return Matrix(1.0f, 0.0f, 0.0f, 0.0f,
+		0.0f, c, s, 0.0f,
+		0.0f, -s, c, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+Matrix
+MatrixRotationY(float angle) {
+	const float s = std::sin(angle), c = std::cos(angle);
+	return Matrix(c, 0.0f, -s, 0.0f,
+		0.0f, 1.0f, 0.0f, 0.0f,
+		s, 0.0f, c, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+Matrix
+MatrixRotationZ(float angle) {
+	const float s = std::sin(angle), c = std::cos(angle);
+	return Matrix(c, s, 0.0f, 0.0f,
+		-s, c, 0.0f, 0.0f,
+		0.0f, 0.0f, 1.0f, 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+Matrix
+MatrixRotationAxis(Vector axis, float angle) {
+	return MatrixRotationQuaternion(QuaternionRotationAxis(axis, angle));
+}
+
+Matrix
+MatrixRotationQuaternion(Vector quaternion) {
+	const float x = VectorGetX(quaternion), y = VectorGetY(quaternion);
+	const float z = VectorGetZ(quaternion), w = VectorGetW(quaternion);
+	const float xx = x * x, yy = y * y, zz = z * z;
+	const float xy = x * y, xz = x * z, yz = y * z;
+	const float wx = w * x, wy = w * y, wz = w * z;
+	return Matrix(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), 0.0f,
+		2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx), 0.0f,
+		2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy), 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f);
+}
+
+Matrix
+MatrixScaleRotationTranslation(Vector scale, Vector rotation, Vector translation) {
+	Matrix m = MatrixRotationQuaternion(rotation);
+	m.r[0] = VectorMultiply(m.r[0], VectorSplatX(scale));
+	m.r[1] = VectorMultiply(m.r[1], VectorSplatY(scale));
+	m.r[2] = VectorMultiply(m.r[2], VectorSplatZ(scale));
+	m.r[3] = VectorSet(VectorGetX(translation), VectorGetY(translation), VectorGetZ(translation), 1.0f);
+	return m;
+}
+
+// Inversa por cofactores a partir de los doce menores 2x2 de las dos mitades de la matriz.
+Matrix
+MatrixInverse(const Matrix& m, float* determinant) {
+	float a[16];
+	storeMatrix(a, m);
+
+	const float s0 = a[0] * a[5] - a[4] * a[1];
+	const float s1 = a[0] * a[6] - a[4] * a[2];
+	const float s2 = a[0] * a[7] - a[4] * a[3];
+	const float s3 = a[1] * a[6] - a[5] * a[2];
+	const float s4 = a[1] * a[7] - a[5] * a[3];
+	const float s5 = a[2] * a[7] - a[6] * a[3];
+
+	const float c5 = a[10] * a[15] - a[14] * a[11];
+	const float c4 = a[9] * a[15] - a[13] * a[11];
+	const float c3 = a[9] * a[14] - a[13] * a[10];
+	const float c2 = a[8] * a[15] - a[12] * a[11];
+	const float c1 = a[8] * a[14] - a[12] * a[10];
+	const float c0 = a[8] * a[13] - a[12] * a[9];
+
+	const float det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+	if (determinant)
+		*determinant = det;
+	if (det == 0.0f)
+		return MatrixIdentity();
+
+	const float inv = 1.0f / det;
+	return Matrix(
+		(a[5] * c5 - a[6] * c4 + a[7] * c3) * inv,
+		(-a[1] * c5 + a[2] * c4 - a[3] * c3) * inv,
+		(a[13] * s5 - a[14] * s4 + a[15] * s3) * inv,
+		(-a[9] * s5 + a[10] * s4 - a[11] * s3) * inv,
+
+		(-a[4] * c5 + a[6] * c2 - a[7] * c1) * inv,
+		(a[0] * c5 - a[2] * c2 + a[3] * c1) * inv,
+		(-a[12] * s5 + a[14] * s2 - a[15] * s1) * inv,
+		(a[8] * s5 - a[10] * s2 + a[11] * s1) * inv,
+
+		(a[4] * c4 - a[5] * c2 + a[7] * c0) * inv,
+		(-a[0] * c4 + a[1] * c2 - a[3] * c0) * inv,
+		(a[12] * s4 - a[13] * s2 + a[15] * s0) * inv,
+		(-a[8] * s4 + a[9] * s2 - a[11] * s0) * inv,
+
+		(-a[4] * c3 + a[5] * c1 - a[6] * c0) * inv,
+		(a[0] * c3 - a[1] * c1 + a[2] * c0) * inv,
+		(-a[12] * s3 + a[13] * s1 - a[14] * s0) * inv,
+		(a[8] * s3 - a[9] * s1 + a[10] * s0) * inv);
+}
+
+Matrix
+MatrixPerspectiveFovLH(float fovY, float aspect, float nearZ, float farZ) {
+	const float height = std::cos(0.5f * fovY) / std::sin(0.5f * fovY);
+	const float width = height / aspect;
+	const float range = farZ / (farZ - nearZ);
+	return Matrix(width, 0.0f, 0.0f, 0.0f,
+		0.0f, height, 0.0f, 0.0f,
+		0.0f, 0.0f, range, 1.0f,
+		0.0f, 0.0f, -range * nearZ, 0.0f);
+}
+
+Matrix
+MatrixOrthographicLH(float width, float height, float nearZ, float farZ) {
+	const float range = 1.0f / (farZ - nearZ);
+	return Matrix(2.0f / width, 0.0f, 0.0f, 0.0f,
+		0.0f, 2.0f / height, 0.0f, 0.0f,
+		0.0f, 0.0f, range, 0.0f,
+		0.0f, 0.0f, -range * nearZ, 1.0f);
+}
+
+// Base de la cámara en columnas y la posición proyectada sobre cada eje en la última fila.
+Matrix
+MatrixLookToLH(Vector eye, Vector direction, Vector up) {
+	const Vector zAxis = Vector3Normalize(direction);
+	const Vector xAxis = Vector3Normalize(Vector3Cross(up, zAxis));
+	const Vector yAxis = Vector3Cross(zAxis, xAxis);
+	const Vector negEye = VectorNegate(eye);
+	return Matrix(VectorGetX(xAxis), VectorGetX(yAxis), VectorGetX(zAxis), 0.0f,
+		VectorGetY(xAxis), VectorGetY(yAxis), VectorGetY(zAxis), 0.0f,
+		VectorGetZ(xAxis), VectorGetZ(yAxis), VectorGetZ(zAxis), 0.0f,
+		VectorGetX(Vector3Dot(xAxis, negEye)), VectorGetX(Vector3Dot(yAxis, negEye)),
+		VectorGetX(Vector3Dot(zAxis, negEye)), 1.0f);
+}
+
+Matrix
+MatrixLookAtLH(Vector eye, Vector at, Vector up) {
+	return MatrixLookToLH(eye, VectorSubtract(at, eye), up);
+}
+
+Vector
+QuaternionRotationAxis(Vector axis, float angle) {
+	const Vector normal = Vector3Normalize(axis);
+	const float s = std::sin(0.5f * angle);
+	return VectorSet(VectorGetX(normal) * s, VectorGetY(normal) * s, VectorGetZ(normal) * s,
+		std::cos(0.5f * angle));
+}
+
+Vector
+QuaternionRotationRollPitchYaw(float pitch, float yaw, float roll) {
+	const Vector qx = QuaternionRotationAxis(VectorSet(1.0f, 0.0f, 0.0f, 0.0f), pitch);
+	const Vector qy = QuaternionRotationAxis(VectorSet(0.0f, 1.0f, 0.0f, 0.0f), yaw);
+	const Vector qz = QuaternionRotationAxis(VectorSet(0.0f, 0.0f, 1.0f, 0.0f), roll);
+	return QuaternionMultiply(QuaternionMultiply(qz, qx), qy);
+}
+
+Vector
+QuaternionSlerp(Vector q0, Vector q1, float t) {
+	float cosine = VectorGetX(Vector4Dot(q0, q1));
+	if (cosine < 0.0f) {
+		// q y -q son el mismo giro; se toma el que queda más cerca.
+		q1 = VectorNegate(q1);
+		cosine = -cosine;
+	}
+	if (cosine > 0.9995f) {
+		// Casi paralelos: el seno se acerca a cero y basta con interpolar linealmente.
+		return QuaternionNormalize(VectorLerp(q0, q1, t));
+	}
+	const float angle = std::acos(cosine);
+	const float invSine = 1.0f / std::sin(angle);
+	const float w0 = std::sin((1.0f - t) * angle) * invSine;
+	const float w1 = std::sin(t * angle) * invSine;
+	return VectorAdd(VectorScale(q0, w0), VectorScale(q1, w1));
+}
+
+void
+MatrixMultiplyStream(Matrix* out, const Matrix* in, size_t count, const Matrix& m) {
+#if defined(SRT_MATH_AVX2)
+	// Dos filas por registro: cada mitad multiplica su fila por las cuatro filas de m.
+	__m256 rows[4];
+	broadcastRows(m, rows);
+	for (size_t i = 0; i < count; ++i) {
+		const float* source = reinterpret_cast<const float*>(&in[i]);
+		const __m256 halves[2] = { _mm256_loadu_ps(source), _mm256_loadu_ps(source + 8) };
+		float* target = reinterpret_cast<float*>(&out[i]);
+		for (int half = 0; half < 2; ++half) {
+			const __m256 a = halves[half];
+			__m256 result = _mm256_mul_ps(_mm256_permute_ps(a, 0x00), rows[0]);
+			result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_permute_ps(a, 0x55), rows[1]));
+			result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_permute_ps(a, 0xAA), rows[2]));
+			result = _mm256_add_ps(result, _mm256_mul_ps(_mm256_permute_ps(a, 0xFF), rows[3]));
+			_mm256_storeu_ps(target + half * 8, result);
+		}
+	}
+#else
+	// Copia local: out podría solaparse con m y obligaría a recargarla en cada vuelta.
+	const Matrix rows = m;
+	for (size_t i = 0; i < count; ++i)
+		out[i] = MatrixMultiply(in[i], rows);
+#endif
+}
+
+void
+Vector3TransformStream(void* out, size_t outStride, const void* in, size_t inStride,
+	size_t count, const Matrix& m) {
+	size_t i = 0;
+#if defined(SRT_MATH_AVX2)
+	__m256 rows[4];
+	broadcastRows(m, rows);
+	for (; i + 2 <= count; i += 2) {
+		const __m256 result = transformPair(loadPair(in, inStride, i), rows, true);
+		VectorStore(*reinterpret_cast<Float4*>(outputAt(out, outStride, i)), _mm256_castps256_ps128(result));
+		VectorStore(*reinterpret_cast<Float4*>(outputAt(out, outStride, i + 1)), _mm256_extractf128_ps(result, 1));
+	}
+#endif
+	for (; i < count; ++i) {
+		const Vector result = Vector3Transform(VectorLoad(loadAt(in, inStride, i)), m);
+		VectorStore(*reinterpret_cast<Float4*>(outputAt(out, outStride, i)), result);
+	}
+}
+
+void
+Vector3TransformCoordStream(void* out, size_t outStride, const void* in, size_t inStride,
+	size_t count, const Matrix& m) {
+	size_t i = 0;
+#if defined(SRT_MATH_AVX2)
+	__m256 rows[4];
+	broadcastRows(m, rows);
+	for (; i + 2 <= count; i += 2) {
+		__m256 result = transformPair(loadPair(in, inStride, i), rows, true);
+		result = _mm256_div_ps(result, _mm256_permute_ps(result, 0xFF));
+		VectorStore(*reinterpret_cast<Float3*>(outputAt(out, outStride, i)), _mm256_castps256_ps128(result));
+		VectorStore(*reinterpret_cast<Float3*>(outputAt(out, outStride, i + 1)), _mm256_extractf128_ps(result, 1));
+	}
+#endif
+	for (; i < count; ++i) {
+		const Vector result = Vector3TransformCoord(VectorLoad(loadAt(in, inStride, i)), m);
+		VectorStore(*reinterpret_cast<Float3*>(outputAt(out, outStride, i)), result);
+	}
+}
+
+void
+Vector3TransformNormalStream(void* out, size_t outStride, const void* in, size_t inStride,
+	size_t count, const Matrix& m) {
+	size_t i = 0;
+#if defined(SRT_MATH_AVX2)
+	__m256 rows[4];
+	broadcastRows(m, rows);
+	for (; i + 2 <= count; i += 2) {
+		const __m256 result = transformPair(loadPair(in, inStride, i), rows, false);
+		VectorStore(*reinterpret_cast<Float3*>(outputAt(out, outStride, i)), _mm256_castps256_ps128(result));
+		VectorStore(*reinterpret_cast<Float3*>(outputAt(out, outStride, i + 1)), _mm256_extractf128_ps(result, 1));
+	}
+#endif
+	for (; i < count; ++i) {
+		const Vector result = Vector3TransformNormal(VectorLoad(loadAt(in, inStride, i)), m);
+		VectorStore(*reinterpret_cast<Float3*>(outputAt(out, outStride, i)), result);
+	}
+}
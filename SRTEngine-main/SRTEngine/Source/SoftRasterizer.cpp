@@ -0,0 +1,1080 @@
+#include "SoftRasterizer.h"
+#include "CommandList.h"
+#include "InstanceBatcher.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+#if defined(SRT_SIMD_AVX2)
+#include <immintrin.h>
+#elif defined(SRT_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+	// Envoltorio mínimo de SIMD para que el bucle de píxeles se escriba una sola vez.
+#if defined(SRT_SIMD_AVX2)
+	const int LANES = 8;
+	typedef __m256 VecF;
+	typedef __m256i VecI;
+
+	inline VecI iSet(int32_t a) { return _mm256_set1_epi32(a); }
+	inline VecI iRamp(int32_t step) {
+		return _mm256_setr_epi32(0, step, 2 * step, 3 * step, 4 * step, 5 * step, 6 * step, 7 * step);
+	}
+	inline VecI iAdd(VecI a, VecI b) { return _mm256_add_epi32(a, b); }
+	inline VecI iOr(VecI a, VecI b) { return _mm256_or_si256(a, b); }
+	// Bit a 1 en los carriles con valor negativo.
+	inline int iSignMask(VecI a) { return _mm256_movemask_ps(_mm256_castsi256_ps(a)); }
+
+	inline VecF fSet(float a) { return _mm256_set1_ps(a); }
+	inline VecF fRamp(float step) {
+		return _mm256_setr_ps(0.0f, step, 2 * step, 3 * step, 4 * step, 5 * step, 6 * step, 7 * step);
+	}
+	inline VecF fAdd(VecF a, VecF b) { return _mm256_add_ps(a, b); }
+	inline VecF fMul(VecF a, VecF b) { return _mm256_mul_ps(a, b); }
+	inline VecF fDiv(VecF a, VecF b) { return _mm256_div_ps(a, b); }
+	inline VecF fLoad(const float* p) { return _mm256_loadu_ps(p); }
+	inline void fStore(float* p, VecF a) { _mm256_storeu_ps(p, a); }
+	inline int fLessMask(VecF a, VecF b) { return _mm256_movemask_ps(_mm256_cmp_ps(a, b, _CMP_LT_OQ)); }
+	inline VecF fSelect(VecF a, VecF b, int mask) {
+		const VecI bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+		VecI m = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(mask), bits), bits);
+		return _mm256_blendv_ps(a, b, _mm256_castsi256_ps(m));
+	}
+#elif defined(SRT_SIMD_SSE2)
+	const int LANES = 4;
+	typedef __m128 VecF;
+	typedef __m128i VecI;
+
+	inline VecI iSet(int32_t a) { return _mm_set1_epi32(a); }
+	inline VecI iRamp(int32_t step) { return _mm_setr_epi32(0, step, 2 * step, 3 * step); }
+	inline VecI iAdd(VecI a, VecI b) { return _mm_add_epi32(a, b); }
+	inline VecI iOr(VecI a, VecI b) { return _mm_or_si128(a, b); }
+	inline int iSignMask(VecI a) { return _mm_movemask_ps(_mm_castsi128_ps(a)); }
+
+	inline VecF fSet(float a) { return _mm_set1_ps(a); }
+	inline VecF fRamp(float step) { return _mm_setr_ps(0.0f, step, 2 * step, 3 * step); }
+	inline VecF fAdd(VecF a, VecF b) { return _mm_add_ps(a, b); }
+	inline VecF fMul(VecF a, VecF b) { return _mm_mul_ps(a, b); }
+	inline VecF fDiv(VecF a, VecF b) { return _mm_div_ps(a, b); }
+	inline VecF fLoad(const float* p) { return _mm_loadu_ps(p); }
+	inline void fStore(float* p, VecF a) { _mm_storeu_ps(p, a); }
+	inline int fLessMask(VecF a, VecF b) { return _mm_movemask_ps(_mm_cmplt_ps(a, b)); }
+	inline VecF fSelect(VecF a, VecF b, int mask) {
+		const VecI bits = _mm_setr_epi32(1, 2, 4, 8);
+		VecF m = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(mask), bits), bits));
+		return _mm_or_ps(_mm_and_ps(m, b), _mm_andnot_ps(m, a));
+	}
+#else
+	const int LANES = 4;
+	struct VecF { float v[4]; };
+	struct VecI { int32_t v[4]; };
+
+	inline VecI iSet(int32_t a) { return VecI{ { a, a, a, a } }; }
+	inline VecI iRamp(int32_t step) { return VecI{ { 0, step, 2 * step, 3 * step } }; }
+	inline VecI iAdd(VecI a, VecI b) { for (int i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+	inline VecI iOr(VecI a, VecI b) { for (int i = 0; i < 4; ++i) a.v[i] |= b.v[i]; return a; }
+	inline int iSignMask(VecI a) {
+		int m = 0;
+		for (int i = 0; i < 4; ++i) m |= (a.v[i] < 0 ? 1 : 0) << i;
+		return m;
+	}
+
+	inline VecF fSet(float a) { return VecF{ { a, a, a, a } }; }
+	inline VecF fRamp(float step) { return VecF{ { 0.0f, step, 2 * step, 3 * step } }; }
+	inline VecF fAdd(VecF a, VecF b) { for (int i = 0; i < 4; ++i) a.v[i] += b.v[i]; return a; }
+	inline VecF fMul(VecF a, VecF b) { for (int i = 0; i < 4; ++i) a.v[i] *= b.v[i]; return a; }
+	inline VecF fDiv(VecF a, VecF b) { for (int i = 0; i < 4; ++i) a.v[i] /= b.v[i]; return a; }
+	inline VecF fLoad(const float* p) { return VecF{ { p[0], p[1], p[2], p[3] } }; }
+	inline void fStore(float* p, VecF a) { memcpy(p, a.v, sizeof(a.v)); }
+	inline int fLessMask(VecF a, VecF b) {
+		int m = 0;
+		for (int i = 0; i < 4; ++i) m |= (a.v[i] < b.v[i] ? 1 : 0) << i;
+		return m;
+	}
+	inline VecF fSelect(VecF a, VecF b, int mask) {
+		for (int i = 0; i < 4; ++i) if (mask & (1 << i)) a.v[i] = b.v[i];
+		return a;
+	}
+#endif
+
+	const int FULL_MASK = (1 << LANES) - 1;
+
+	// Datos de un búfer de constantes desde el rango enlazado, o nullptr si no llegan a size bytes.
+	const uint8_t* constantData(const SoftBuffer* buffer, unsigned int offset, size_t size) {
+		if (!buffer || buffer->m_data.size() < offset + size)
+			return nullptr;
+		return buffer->m_data.data() + offset;
+	}
+
+	// Las constantes se suben transpuestas (MatrixTranspose), así que se deshace aquí.
+	Matrix loadTransposed(const uint8_t* data) {
+		float raw[16];
+		memcpy(raw, data, sizeof(raw));
+		return MatrixTranspose(MatrixLoad(raw));
+	}
+
+	uint32_t packColor(float r, float g, float b, float a) {
+		auto toByte = [](float c) {
+			c = c < 0.0f ? 0.0f : (c > 1.0f ? 1.0f : c);
+			return (uint32_t)(c * 255.0f + 0.5f);
+		};
+		return toByte(r) | (toByte(g) << 8) | (toByte(b) << 16) | (toByte(a) << 24);
+	}
+
+	// Muestreo bilineal con direccionamiento WRAP (D3D11_FILTER_MIN_MAG_MIP_LINEAR sin mips).
+	void sampleBilinear(const SoftTexture& tex, float u, float v, float out[4]) {
+		const float fx = u * tex.m_width - 0.5f;
+		const float fy = v * tex.m_height - 0.5f;
+		const float flx = std::floor(fx);
+		const float fly = std::floor(fy);
+		const float ax = fx - flx;
+		const float ay = fy - fly;
+		const int w = (int)tex.m_width;
+		const int h = (int)tex.m_height;
+		int x0 = (int)flx % w; if (x0 < 0) x0 += w;
+		int y0 = (int)fly % h; if (y0 < 0) y0 += h;
+		const int x1 = (x0 + 1 == w) ? 0 : x0 + 1;
+		const int y1 = (y0 + 1 == h) ? 0 : y0 + 1;
+
+		const uint32_t t00 = tex.m_texels[y0 * w + x0];
+		const uint32_t t10 = tex.m_texels[y0 * w + x1];
+		const uint32_t t01 = tex.m_texels[y1 * w + x0];
+		const uint32_t t11 = tex.m_texels[y1 * w + x1];
+		const float w00 = (1.0f - ax) * (1.0f - ay);
+		const float w10 = ax * (1.0f - ay);
+		const float w01 = (1.0f - ax) * ay;
+		const float w11 = ax * ay;
+		for (int c = 0; c < 4; ++c) {
+			const int shift = c * 8;
+			out[c] = (((t00 >> shift) & 0xFF) * w00 + ((t10 >> shift) & 0xFF) * w10 +
+				((t01 >> shift) & 0xFF) * w01 + ((t11 >> shift) & 0xFF) * w11) * (1.0f / 255.0f);
+		}
+	}
+
+	// Bits de clipping de un vértice homogéneo contra el volumen de D3D (0 <= z <= w).
+	unsigned int outcode(float x, float y, float z, float w) {
+		unsigned int code = 0;
+		if (x > w) code |= 1;
+		if (x < -w) code |= 2;
+		if (y > w) code |= 4;
+		if (y < -w) code |= 8;
+		if (z < 0.0f) code |= 16;
+		if (z > w) code |= 32;
+		return code;
+	}
+
+	// Distancia con signo al plano de recorte; positiva = dentro.
+	template<typename V>
+	float planeDistance(const V& v, int plane) {
+		switch (plane) {
+		case 0: return v.w - v.x;
+		case 1: return v.w + v.x;
+		case 2: return v.w - v.y;
+		case 3: return v.w + v.y;
+		case 4: return v.z;
+		default: return v.w - v.z;
+		}
+	}
+
+	// Evalúa un plano de atributo (ddx, ddy, c) en el centro del píxel.
+	inline float evalPlane(const float p[3], float x, float y) {
+		return p[0] * x + p[1] * y + p[2];
+	}
+
+	double secondsSince(std::chrono::steady_clock::time_point start) {
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	const unsigned int SETUP_CHUNK = 4096;   // Triángulos por trabajo de preparación.
+	const unsigned int VERTEX_CHUNK = 16384; // Vértices por trabajo de transformación.
+}
+
+// Parámetros de un DrawIndexed compartidos con los hilos de preparación.
+struct SoftRasterizer::DrawJob {
+	const uint8_t* indices;
+	SoftIndexFormat indexFormat;
+	int64_t baseVertex;
+	unsigned int vertexCount;  // Vértices del rango que usan los índices
+	unsigned int triangleCount;
+	uint32_t drawIndex;
+	const uint8_t* vertices;
+	unsigned int stride;
+	Matrix worldViewProj;
+};
+
+SoftInputLayout::SoftInputLayout() {
+	m_format.add(SEMANTIC_POSITION, ENCODING_FLOAT3);
+	m_format.add(SEMANTIC_TEXCOORD, ENCODING_FLOAT2);
+}
+
+SoftRasterizer::~SoftRasterizer() {
+	destroy();
+}
+
+// Crea el render target y arranca los hilos de trabajo.
+HRESULT
+SoftRasterizer::init(unsigned int width, unsigned int height, unsigned int threadCount) {
+	if (width == 0 || height == 0) {
+		ERROR("SoftRasterizer", "init", "Width and height must be greater than 0");
+		return E_INVALIDARG;
+	}
+	destroy();
+
+	m_renderTarget.m_width = width;
+	m_renderTarget.m_height = height;
+	m_renderTarget.m_pitch = (width + TILE_SIZE - 1) / TILE_SIZE * TILE_SIZE;
+	m_renderTarget.m_rows = (height + TILE_SIZE - 1) / TILE_SIZE * TILE_SIZE;
+	m_renderTarget.m_color.assign((size_t)m_renderTarget.m_pitch * m_renderTarget.m_rows, 0);
+	m_renderTarget.m_depth.assign((size_t)m_renderTarget.m_pitch * m_renderTarget.m_rows, 1.0f);
+
+	m_tilesX = m_renderTarget.m_pitch / TILE_SIZE;
+	m_tilesY = m_renderTarget.m_rows / TILE_SIZE;
+	m_bins.assign((size_t)m_tilesX * m_tilesY, std::vector<uint32_t>());
+
+	// Las aristas se evalúan en enteros de 32 bits: |E| <= 2 * W * H * 4^bits.
+	m_subpixelBits = 8;
+	while (m_subpixelBits > 0 &&
+		2.0 * width * height * (double)(1u << (2 * m_subpixelBits)) >= 2147483647.0) {
+		--m_subpixelBits;
+	}
+
+	m_viewport = SoftViewport();
+	m_viewport.Width = (float)width;
+	m_viewport.Height = (float)height;
+
+	if (threadCount == 0) {
+		threadCount = std::max(1u, std::thread::hardware_concurrency());
+	}
+	m_quit = false;
+	for (unsigned int i = 1; i < threadCount; ++i) {
+		m_workers.emplace_back(&SoftRasterizer::workerLoop, this);
+	}
+	return S_OK;
+}
+
+// Detiene los hilos y libera la memoria.
+void
+SoftRasterizer::destroy() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_quit = true;
+	}
+	m_wakeCondition.notify_all();
+	for (std::thread& worker : m_workers) {
+		worker.join();
+	}
+	m_workers.clear();
+	// Los hilos del próximo init() empiezan esperando la generación 0: si el contador siguiera
+	// adelantado, ejecutarían un trabajo que no les han dado y descontarían m_busyWorkers antes
+	// de que runParallel() lo fije. No se lee al arrancar cada hilo porque uno que arranque
+	// tarde se saltaría la primera generación y runParallel() lo esperaría para siempre.
+	m_generation = 0;
+	m_busyWorkers = 0;
+
+	m_triangles.clear();
+	m_draws.clear();
+	m_bins.clear();
+	m_renderTarget = SoftRenderTarget();
+	m_pendingColorClear = false;
+	m_pendingDepthClear = false;
+}
+
+// Bucle de cada hilo: espera una nueva generación de trabajo y toma índices del contador.
+void
+SoftRasterizer::workerLoop() {
+	uint64_t seenGeneration = 0;
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wakeCondition.wait(lock, [&] { return m_quit || m_generation != seenGeneration; });
+			if (m_quit)
+				return;
+			seenGeneration = m_generation;
+		}
+
+		unsigned int job;
+		while ((job = m_nextJob.fetch_add(1)) < m_jobCount) {
+			m_job(this, job);
+		}
+
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (--m_busyWorkers == 0)
+			m_doneCondition.notify_one();
+	}
+}
+
+// Ejecuta jobCount trabajos repartidos entre los hilos y el hilo que llama.
+void
+SoftRasterizer::runParallel(unsigned int jobCount, void (*job)(SoftRasterizer*, unsigned int)) {
+	if (m_workers.empty() || jobCount <= 1) {
+		for (unsigned int i = 0; i < jobCount; ++i)
+			job(this, i);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_job = job;
+		m_jobCount = jobCount;
+		m_nextJob = 0;
+		m_busyWorkers = (unsigned int)m_workers.size();
+		++m_generation;
+	}
+	m_wakeCondition.notify_all();
+
+	unsigned int index;
+	while ((index = m_nextJob.fetch_add(1)) < jobCount) {
+		job(this, index);
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_doneCondition.wait(lock, [&] { return m_busyWorkers == 0; });
+}
+
+void
+SoftRasterizer::RSSetViewports(unsigned int NumViewports, const SoftViewport* pViewports) {
+	if (!pViewports || NumViewports == 0) {
+		ERROR("SoftRasterizer", "RSSetViewports", "pViewports is nullptr");
+		return;
+	}
+	m_viewport = pViewports[0];
+}
+
+void
+SoftRasterizer::RSSetState(SoftCullMode cullMode) {
+	m_cullMode = cullMode;
+}
+
+void
+SoftRasterizer::IASetInputLayout(const SoftInputLayout* pInputLayout) {
+	if (!pInputLayout) {
+		ERROR("SoftRasterizer", "IASetInputLayout", "pInputLayout is nullptr");
+		return;
+	}
+	m_inputLayout = *pInputLayout;
+}
+
+void
+SoftRasterizer::IASetVertexBuffers(unsigned int StartSlot,
+	unsigned int NumBuffers,
+	const SoftBuffer* const* ppVertexBuffers,
+	const unsigned int* pStrides,
+	const unsigned int* pOffsets) {
+	if (!ppVertexBuffers || !pStrides || !pOffsets) {
+		ERROR("SoftRasterizer", "IASetVertexBuffers",
+			"Invalid arguments: ppVertexBuffers, pStrides, or pOffsets is nullptr");
+		return;
+	}
+	// El input layout lee todos los atributos del slot 0; el slot 1 son las instancias.
+	for (unsigned int i = 0; i < NumBuffers; ++i) {
+		if (StartSlot + i == 0) {
+			m_vertexBuffer = ppVertexBuffers[i];
+			m_vertexStride = pStrides[i];
+			m_vertexOffset = pOffsets[i];
+		}
+		else if (StartSlot + i == 1) {
+			m_instanceBuffer = ppVertexBuffers[i];
+			m_instanceStride = pStrides[i];
+			m_instanceOffset = pOffsets[i];
+		}
+	}
+}
+
+void
+SoftRasterizer::IASetIndexBuffer(const SoftBuffer* pIndexBuffer,
+	SoftIndexFormat Format,
+	unsigned int Offset) {
+	if (!pIndexBuffer) {
+		ERROR("SoftRasterizer", "IASetIndexBuffer", "pIndexBuffer is nullptr");
+		return;
+	}
+	m_indexBuffer = pIndexBuffer;
+	m_indexFormat = Format;
+	m_indexOffset = Offset;
+}
+
+void
+SoftRasterizer::VSSetConstantBuffers(unsigned int StartSlot,
+	unsigned int NumBuffers,
+	const SoftBuffer* const* ppConstantBuffers) {
+	if (!ppConstantBuffers) {
+		ERROR("SoftRasterizer", "VSSetConstantBuffers", "ppConstantBuffers is nullptr");
+		return;
+	}
+	VSSetConstantBuffers1(StartSlot, NumBuffers, ppConstantBuffers, nullptr, nullptr);
+}
+
+void
+SoftRasterizer::PSSetConstantBuffers(unsigned int StartSlot,
+	unsigned int NumBuffers,
+	const SoftBuffer* const* ppConstantBuffers) {
+	if (!ppConstantBuffers) {
+		ERROR("SoftRasterizer", "PSSetConstantBuffers", "ppConstantBuffers is nullptr");
+		return;
+	}
+	PSSetConstantBuffers1(StartSlot, NumBuffers, ppConstantBuffers, nullptr, nullptr);
+}
+
+// El tamaño del rango no se guarda: los shaders fijos solo leen el principio de cada búfer.
+void
+SoftRasterizer::VSSetConstantBuffers1(unsigned int StartSlot,
+	unsigned int NumBuffers,
+	const SoftBuffer* const* ppConstantBuffers,
+	const unsigned int* pFirstConstant,
+	const unsigned int*) {
+	if (!ppConstantBuffers) {
+		ERROR("SoftRasterizer", "VSSetConstantBuffers1", "ppConstantBuffers is nullptr");
+		return;
+	}
+	for (unsigned int i = 0; i < NumBuffers && StartSlot + i < 3; ++i) {
+		m_vsConstants[StartSlot + i] = ppConstantBuffers[i];
+		m_vsConstantOffsets[StartSlot + i] = pFirstConstant ? pFirstConstant[i] * 16 : 0;
+	}
+}
+
+void
+SoftRasterizer::PSSetConstantBuffers1(unsigned int StartSlot,
+	unsigned int NumBuffers,
+	const SoftBuffer* const* ppConstantBuffers,
+	const unsigned int* pFirstConstant,
+	const unsigned int*) {
+	if (!ppConstantBuffers) {
+		ERROR("SoftRasterizer", "PSSetConstantBuffers1", "ppConstantBuffers is nullptr");
+		return;
+	}
+	for (unsigned int i = 0; i < NumBuffers && StartSlot + i < 3; ++i) {
+		m_psConstants[StartSlot + i] = ppConstantBuffers[i];
+		m_psConstantOffsets[StartSlot + i] = pFirstConstant ? pFirstConstant[i] * 16 : 0;
+	}
+}
+
+void
+SoftRasterizer::PSSetShaderResources(unsigned int StartSlot,
+	unsigned int NumViews,
+	const SoftTexture* const* ppShaderResourceViews) {
+	if (!ppShaderResourceViews) {
+		ERROR("SoftRasterizer", "PSSetShaderResources", "ppShaderResourceViews is nullptr");
+		return;
+	}
+	if (StartSlot == 0 && NumViews > 0) {
+		m_texture = ppShaderResourceViews[0];
+	}
+}
+
+void
+SoftRasterizer::UpdateSubresource(SoftBuffer* pDstResource, const void* pSrcData, size_t size) {
+	if (!pDstResource || !pSrcData) {
+		ERROR("SoftRasterizer", "UpdateSubresource",
+			"Invalid arguments: pDstResource or pSrcData is nullptr");
+		return;
+	}
+	// Los draws ya clasificados guardan sus matrices, así que no hace falta vaciar antes.
+	pDstResource->m_data.resize(size);
+	memcpy(pDstResource->m_data.data(), pSrcData, size);
+}
+
+void
+SoftRasterizer::ClearRenderTargetView(const float ColorRGBA[4]) {
+	if (!ColorRGBA) {
+		ERROR("SoftRasterizer", "ClearRenderTargetView", "ColorRGBA is nullptr");
+		return;
+	}
+	// Lo que ya está clasificado se dibuja antes de limpiar para respetar el orden.
+	if (!m_triangles.empty())
+		flush();
+	m_pendingColorClear = true;
+	m_clearColor = packColor(ColorRGBA[0], ColorRGBA[1], ColorRGBA[2], ColorRGBA[3]);
+}
+
+void
+SoftRasterizer::ClearDepthStencilView(float Depth) {
+	if (!m_triangles.empty())
+		flush();
+	m_pendingDepthClear = true;
+	m_clearDepth = Depth;
+}
+
+// Transforma los vértices, recorta y clasifica los triángulos del draw en los tiles.
+void
+SoftRasterizer::DrawIndexed(unsigned int IndexCount,
+	unsigned int StartIndexLocation,
+	int BaseVertexLocation) {
+	drawInstances(IndexCount, 1, StartIndexLocation, BaseVertexLocation, 0, false);
+}
+
+void
+SoftRasterizer::DrawIndexedInstanced(unsigned int IndexCountPerInstance,
+	unsigned int InstanceCount,
+	unsigned int StartIndexLocation,
+	int BaseVertexLocation,
+	unsigned int StartInstanceLocation) {
+	if (InstanceCount == 0) {
+		ERROR("SoftRasterizer", "DrawIndexedInstanced", "InstanceCount is zero");
+		return;
+	}
+	if (!m_instanceBuffer || m_instanceStride < sizeof(InstanceData) ||
+		m_instanceOffset + ((size_t)StartInstanceLocation + InstanceCount - 1) * m_instanceStride + sizeof(InstanceData) >
+		m_instanceBuffer->m_data.size()) {
+		ERROR("SoftRasterizer", "DrawIndexedInstanced", "Instance buffer in slot 1 is missing or too small");
+		return;
+	}
+	drawInstances(IndexCountPerInstance, InstanceCount, StartIndexLocation, BaseVertexLocation,
+		StartInstanceLocation, true);
+}
+
+// Decodifica una vez el rango de vértices que usan los índices y, por instancia, lo transforma,
+// recorta y clasifica los triángulos en los tiles.
+void
+SoftRasterizer::drawInstances(unsigned int indexCount, unsigned int instanceCount,
+	unsigned int startIndexLocation, int baseVertexLocation,
+	unsigned int startInstanceLocation, bool instanced) {
+	if (indexCount == 0) {
+		ERROR("SoftRasterizer", "DrawIndexed", "IndexCount is zero");
+		return;
+	}
+	if (m_renderTarget.m_color.empty()) {
+		ERROR("SoftRasterizer", "DrawIndexed", "Render target is not initialized");
+		return;
+	}
+	if (!m_vertexBuffer || !m_indexBuffer || m_vertexStride == 0) {
+		ERROR("SoftRasterizer", "DrawIndexed", "Vertex or index buffer is not bound");
+		return;
+	}
+	if (!m_inputLayout.m_format.find(SEMANTIC_POSITION)) {
+		ERROR("SoftRasterizer", "DrawIndexed", "Input layout has no POSITION");
+		return;
+	}
+	const uint8_t* cbView = constantData(m_vsConstants[0], m_vsConstantOffsets[0], 64);
+	const uint8_t* cbProjection = constantData(m_vsConstants[1], m_vsConstantOffsets[1], 64);
+	const uint8_t* cbFrame = constantData(m_vsConstants[2], m_vsConstantOffsets[2], 64);
+	if (!cbView || !cbProjection || (!cbFrame && !instanced)) {
+		ERROR("SoftRasterizer", "DrawIndexed", "Constant buffers 0-2 are not bound");
+		return;
+	}
+
+	const auto start = std::chrono::steady_clock::now();
+
+	const unsigned int indexSize = m_indexFormat == SOFT_INDEX_16 ? 2 : 4;
+	const size_t firstIndexByte = m_indexOffset + (size_t)startIndexLocation * indexSize;
+	if (firstIndexByte + (size_t)indexCount * indexSize > m_indexBuffer->m_data.size()) {
+		ERROR("SoftRasterizer", "DrawIndexed", "Index range exceeds the index buffer");
+		return;
+	}
+
+	DrawJob job;
+	job.indices = m_indexBuffer->m_data.data() + firstIndexByte;
+	job.indexFormat = m_indexFormat;
+	job.triangleCount = indexCount / 3;
+	job.vertices = m_vertexBuffer->m_data.data() + m_vertexOffset;
+	job.stride = m_vertexStride;
+	const unsigned int bufferVertices = m_vertexBuffer->m_data.size() > m_vertexOffset ?
+		(unsigned int)((m_vertexBuffer->m_data.size() - m_vertexOffset) / m_vertexStride) : 0;
+
+	// Rango de vértices que usan los índices (dentro del búfer); solo ese se decodifica y transforma.
+	uint32_t minIndex = ~0u, maxIndex = 0;
+	for (unsigned int i = 0; i < job.triangleCount * 3; ++i) {
+		uint32_t index;
+		if (job.indexFormat == SOFT_INDEX_16) {
+			uint16_t v;
+			memcpy(&v, job.indices + i * 2, 2);
+			index = v;
+		}
+		else {
+			memcpy(&index, job.indices + i * 4, 4);
+		}
+		minIndex = std::min(minIndex, index);
+		maxIndex = std::max(maxIndex, index);
+	}
+	const int64_t firstVertex = std::max<int64_t>(0, (int64_t)minIndex + baseVertexLocation);
+	const int64_t lastVertex = std::min<int64_t>((int64_t)bufferVertices - 1, (int64_t)maxIndex + baseVertexLocation);
+	job.vertexCount = lastVertex >= firstVertex ? (unsigned int)(lastVertex - firstVertex + 1) : 0;
+	job.baseVertex = (int64_t)baseVertexLocation - firstVertex; // Índice -> posición en el rango
+	job.vertices += (size_t)firstVertex * job.stride;
+
+	// Input assembler: POSITION y TEXCOORD a float, como los recibe el vertex shader.
+	m_positions.resize(job.vertexCount);
+	m_texcoords.resize(job.vertexCount);
+	m_transformed.resize(job.vertexCount);
+	m_drawJob = &job;
+	const unsigned int vertexChunks = (job.vertexCount + VERTEX_CHUNK - 1) / VERTEX_CHUNK;
+	runParallel(vertexChunks, [](SoftRasterizer* self, unsigned int chunk) {
+		const DrawJob& dj = *self->m_drawJob;
+		const unsigned int first = chunk * VERTEX_CHUNK;
+		const unsigned int count = std::min(dj.vertexCount, first + VERTEX_CHUNK) - first;
+		const VertexFormat& format = self->m_inputLayout.m_format;
+		const uint8_t* vertices = dj.vertices + (size_t)first * dj.stride;
+		format.decode(vertices, count, SEMANTIC_POSITION, &self->m_positions[first], false);
+		if (format.find(SEMANTIC_TEXCOORD))
+			format.decode(vertices, count, SEMANTIC_TEXCOORD, &self->m_texcoords[first], false);
+		else
+			std::fill(self->m_texcoords.begin() + first, self->m_texcoords.begin() + first + count, Float4(0.0f, 0.0f, 0.0f, 0.0f));
+		for (unsigned int i = first; i < first + count; ++i) {
+			self->m_transformed[i].u = self->m_texcoords[i].x;
+			self->m_transformed[i].v = self->m_texcoords[i].y;
+		}
+	});
+
+	// Color del pixel shader fuera de la instancia: vMeshColor (PS slot 2, o el del VS).
+	const uint8_t* cbColor = m_psConstants[2] ?
+		constantData(m_psConstants[2], m_psConstantOffsets[2], 80) :
+		constantData(m_vsConstants[2], m_vsConstantOffsets[2], 80);
+	const Matrix viewProjection = MatrixMultiply(loadTransposed(cbView), loadTransposed(cbProjection));
+	const unsigned int chunkCount = (job.triangleCount + SETUP_CHUNK - 1) / SETUP_CHUNK;
+	if (m_chunkTriangles.size() < chunkCount)
+		m_chunkTriangles.resize(chunkCount);
+
+	for (unsigned int instance = 0; instance < instanceCount; ++instance) {
+		DrawState state;
+		state.texture = (m_texture && !m_texture->m_texels.empty()) ? m_texture : nullptr;
+		Matrix world;
+		if (instanced) {
+			InstanceData data;
+			memcpy(&data, m_instanceBuffer->m_data.data() + m_instanceOffset +
+				(size_t)(startInstanceLocation + instance) * m_instanceStride, sizeof(data));
+			for (int row = 0; row < 4; ++row)
+				world.r[row] = VectorLoad(data.world[row]);
+			memcpy(state.meshColor, &data.color, sizeof(state.meshColor));
+		}
+		else {
+			world = loadTransposed(cbFrame);
+			if (cbColor)
+				memcpy(state.meshColor, cbColor + 64, sizeof(state.meshColor));
+			else
+				state.meshColor[0] = state.meshColor[1] = state.meshColor[2] = state.meshColor[3] = 1.0f;
+		}
+		job.worldViewProj = MatrixMultiply(world, viewProjection);
+		job.drawIndex = (uint32_t)m_draws.size();
+		m_draws.push_back(state);
+
+		// Vertex shader: mul(mul(mul(Pos, World), View), Projection).
+		runParallel(vertexChunks, [](SoftRasterizer* self, unsigned int chunk) {
+			const DrawJob& dj = *self->m_drawJob;
+			const unsigned int first = chunk * VERTEX_CHUNK;
+			const unsigned int last = std::min(dj.vertexCount, first + VERTEX_CHUNK);
+			// x, y, z, w van al principio de ClipVertex, así que se transforman de una vez.
+			Vector3TransformStream(&self->m_transformed[first], sizeof(ClipVertex),
+				&self->m_positions[first], sizeof(Float4), last - first, dj.worldViewProj);
+		});
+
+		// Ensamblado, recorte y preparación de triángulos por bloques.
+		runParallel(chunkCount, [](SoftRasterizer* self, unsigned int chunk) {
+			const DrawJob& dj = *self->m_drawJob;
+			std::vector<Triangle>& out = self->m_chunkTriangles[chunk];
+			out.clear();
+			const unsigned int first = chunk * SETUP_CHUNK;
+			const unsigned int last = std::min(dj.triangleCount, first + SETUP_CHUNK);
+			for (unsigned int t = first; t < last; ++t) {
+				int64_t idx[3];
+				for (int k = 0; k < 3; ++k) {
+					const unsigned int i = t * 3 + k;
+					if (dj.indexFormat == SOFT_INDEX_16) {
+						uint16_t v;
+						memcpy(&v, dj.indices + i * 2, 2);
+						idx[k] = (int64_t)v + dj.baseVertex;
+					}
+					else {
+						uint32_t v;
+						memcpy(&v, dj.indices + i * 4, 4);
+						idx[k] = (int64_t)v + dj.baseVertex;
+					}
+				}
+				if (idx[0] < 0 || idx[1] < 0 || idx[2] < 0 ||
+					idx[0] >= dj.vertexCount || idx[1] >= dj.vertexCount || idx[2] >= dj.vertexCount) {
+					continue;
+				}
+				self->clipAndSetup(self->m_transformed[(size_t)idx[0]],
+					self->m_transformed[(size_t)idx[1]],
+					self->m_transformed[(size_t)idx[2]],
+					dj.drawIndex, out);
+			}
+		});
+
+		// Binning en orden de envío para que cada tile dibuje de forma determinista.
+		for (unsigned int c = 0; c < chunkCount; ++c) {
+			for (const Triangle& tri : m_chunkTriangles[c]) {
+				const uint32_t triIndex = (uint32_t)m_triangles.size();
+				m_triangles.push_back(tri);
+				const int tx0 = tri.minX / TILE_SIZE;
+				const int tx1 = tri.maxX / TILE_SIZE;
+				const int ty0 = tri.minY / TILE_SIZE;
+				const int ty1 = tri.maxY / TILE_SIZE;
+				for (int ty = ty0; ty <= ty1; ++ty)
+					for (int tx = tx0; tx <= tx1; ++tx)
+						m_bins[(size_t)ty * m_tilesX + tx].push_back(triIndex);
+			}
+		}
+	}
+	m_drawJob = nullptr;
+
+	++m_stats.draws;
+	m_stats.instances += instanceCount;
+	m_stats.verticesTransformed += (uint64_t)job.vertexCount * instanceCount;
+	m_stats.trianglesSubmitted += (uint64_t)job.triangleCount * instanceCount;
+	m_stats.setupSeconds += secondsSince(start);
+}
+
+// Recorta el triángulo contra el volumen de visión (Sutherland-Hodgman) si hace falta.
+void
+SoftRasterizer::clipAndSetup(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2,
+	uint32_t drawIndex, std::vector<Triangle>& out) const {
+	const unsigned int c0 = outcode(v0.x, v0.y, v0.z, v0.w);
+	const unsigned int c1 = outcode(v1.x, v1.y, v1.z, v1.w);
+	const unsigned int c2 = outcode(v2.x, v2.y, v2.z, v2.w);
+	if (c0 & c1 & c2)
+		return;
+	if ((c0 | c1 | c2) == 0) {
+		setupTriangle(v0, v1, v2, drawIndex, out);
+		return;
+	}
+
+	// Cada plano añade como mucho un vértice: 3 + 6 = 9.
+	ClipVertex polygon[2][9];
+	int count = 3;
+	polygon[0][0] = v0;
+	polygon[0][1] = v1;
+	polygon[0][2] = v2;
+	int src = 0;
+	const unsigned int planes = c0 | c1 | c2;
+	for (int plane = 0; plane < 6 && count >= 3; ++plane) {
+		if (!(planes & (1u << plane)))
+			continue;
+		const ClipVertex* in = polygon[src];
+		ClipVertex* dst = polygon[src ^ 1];
+		int outCount = 0;
+		for (int i = 0; i < count; ++i) {
+			const ClipVertex& a = in[i];
+			const ClipVertex& b = in[(i + 1) % count];
+			const float da = planeDistance(a, plane);
+			const float db = planeDistance(b, plane);
+			if (da >= 0.0f)
+				dst[outCount++] = a;
+			if ((da >= 0.0f) != (db >= 0.0f)) {
+				const float t = da / (da - db);
+				ClipVertex& v = dst[outCount++];
+				v.x = a.x + (b.x - a.x) * t;
+				v.y = a.y + (b.y - a.y) * t;
+				v.z = a.z + (b.z - a.z) * t;
+				v.w = a.w + (b.w - a.w) * t;
+				v.u = a.u + (b.u - a.u) * t;
+				v.v = a.v + (b.v - a.v) * t;
+			}
+		}
+		count = outCount;
+		src ^= 1;
+	}
+
+	for (int i = 1; i + 1 < count; ++i) {
+		setupTriangle(polygon[src][0], polygon[src][i], polygon[src][i + 1], drawIndex, out);
+	}
+}
+
+// Proyecta el triángulo, aplica el culling y calcula aristas en punto fijo y planos de atributos.
+void
+SoftRasterizer::setupTriangle(const ClipVertex& v0, const ClipVertex& v1, const ClipVertex& v2,
+	uint32_t drawIndex, std::vector<Triangle>& out) const {
+	const ClipVertex* v[3] = { &v0, &v1, &v2 };
+	const float subpixel = (float)(1 << m_subpixelBits);
+	const float depthRange = m_viewport.MaxDepth - m_viewport.MinDepth;
+
+	float sx[3], sy[3], sz[3], invW[3];
+	int32_t fx[3], fy[3];
+	for (int i = 0; i < 3; ++i) {
+		if (v[i]->w <= 0.0f)
+			return;
+		invW[i] = 1.0f / v[i]->w;
+		const float ndcX = v[i]->x * invW[i];
+		const float ndcY = v[i]->y * invW[i];
+		const float ndcZ = v[i]->z * invW[i];
+		fx[i] = (int32_t)std::lround((m_viewport.TopLeftX + (ndcX * 0.5f + 0.5f) * m_viewport.Width) * subpixel);
+		fy[i] = (int32_t)std::lround((m_viewport.TopLeftY + (0.5f - ndcY * 0.5f) * m_viewport.Height) * subpixel);
+		sx[i] = fx[i] / subpixel;
+		sy[i] = fy[i] / subpixel;
+		sz[i] = m_viewport.MinDepth + ndcZ * depthRange;
+	}
+
+	// Área con signo en subpíxeles: positiva = sentido horario en pantalla = cara frontal.
+	int64_t area = (int64_t)(fx[1] - fx[0]) * (fy[2] - fy[0]) - (int64_t)(fy[1] - fy[0]) * (fx[2] - fx[0]);
+	if (area == 0)
+		return;
+	const bool front = area > 0;
+	if ((front && m_cullMode == SOFT_CULL_FRONT) || (!front && m_cullMode == SOFT_CULL_BACK))
+		return;
+
+	int order[3] = { 0, 1, 2 };
+	if (!front) {
+		order[1] = 2;
+		order[2] = 1;
+		area = -area;
+	}
+
+	const int32_t half = 1 << m_subpixelBits >> 1;
+	const int32_t minFx = std::min(fx[0], std::min(fx[1], fx[2]));
+	const int32_t maxFx = std::max(fx[0], std::max(fx[1], fx[2]));
+	const int32_t minFy = std::min(fy[0], std::min(fy[1], fy[2]));
+	const int32_t maxFy = std::max(fy[0], std::max(fy[1], fy[2]));
+
+	Triangle tri;
+	const int32_t vpMinX = std::max(0, (int32_t)std::floor(m_viewport.TopLeftX));
+	const int32_t vpMinY = std::max(0, (int32_t)std::floor(m_viewport.TopLeftY));
+	const int32_t vpMaxX = std::min((int32_t)m_renderTarget.m_width - 1,
+		(int32_t)std::ceil(m_viewport.TopLeftX + m_viewport.Width) - 1);
+	const int32_t vpMaxY = std::min((int32_t)m_renderTarget.m_height - 1,
+		(int32_t)std::ceil(m_viewport.TopLeftY + m_viewport.Height) - 1);
+	const int32_t mask = (1 << m_subpixelBits) - 1;
+	tri.minX = std::max(vpMinX, (minFx - half + mask) >> m_subpixelBits);
+	tri.minY = std::max(vpMinY, (minFy - half + mask) >> m_subpixelBits);
+	tri.maxX = std::min(vpMaxX, (maxFx - half) >> m_subpixelBits);
+	tri.maxY = std::min(vpMaxY, (maxFy - half) >> m_subpixelBits);
+	if (tri.minX > tri.maxX || tri.minY > tri.maxY)
+		return;
+
+	// Arista k opuesta al vértice k: E(p) = (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x).
+	for (int k = 0; k < 3; ++k) {
+		const int a = order[(k + 1) % 3];
+		const int b = order[(k + 2) % 3];
+		const int32_t dx = fx[b] - fx[a];
+		const int32_t dy = fy[b] - fy[a];
+		tri.edgeA[k] = -dy;
+		tri.edgeB[k] = dx;
+		tri.edgeC[k] = (int64_t)dy * fx[a] - (int64_t)dx * fy[a];
+		// Regla top-left: las aristas superiores e izquierdas incluyen los píxeles sobre la arista.
+		const bool topLeft = dy < 0 || (dy == 0 && dx > 0);
+		if (!topLeft)
+			tri.edgeC[k] -= 1;
+	}
+
+	// Planos de atributos en coordenadas de píxel.
+	const int i0 = order[0], i1 = order[1], i2 = order[2];
+	const float x10 = sx[i1] - sx[i0], y10 = sy[i1] - sy[i0];
+	const float x20 = sx[i2] - sx[i0], y20 = sy[i2] - sy[i0];
+	const float invArea = 1.0f / (x10 * y20 - x20 * y10);
+	auto makePlane = [&](float a0, float a1, float a2, float plane[3]) {
+		const float d10 = a1 - a0;
+		const float d20 = a2 - a0;
+		plane[0] = (d10 * y20 - d20 * y10) * invArea;
+		plane[1] = (d20 * x10 - d10 * x20) * invArea;
+		plane[2] = a0 - plane[0] * sx[i0] - plane[1] * sy[i0];
+	};
+	makePlane(sz[i0], sz[i1], sz[i2], tri.z);
+	makePlane(invW[i0], invW[i1], invW[i2], tri.invW);
+	makePlane(v[i0]->u * invW[i0], v[i1]->u * invW[i1], v[i2]->u * invW[i2], tri.uOverW);
+	makePlane(v[i0]->v * invW[i0], v[i1]->v * invW[i1], v[i2]->v * invW[i2], tri.vOverW);
+	tri.drawIndex = drawIndex;
+	out.push_back(tri);
+}
+
+// Rasteriza todos los triángulos clasificados en un tile, LANES píxeles por paso.
+void
+SoftRasterizer::rasterizeTile(unsigned int tileIndex) {
+	const int tileX = (int)(tileIndex % m_tilesX) * TILE_SIZE;
+	const int tileY = (int)(tileIndex / m_tilesX) * TILE_SIZE;
+	const unsigned int pitch = m_renderTarget.m_pitch;
+	uint32_t* color = m_renderTarget.m_color.data();
+	float* depth = m_renderTarget.m_depth.data();
+
+	if (m_pendingColorClear || m_pendingDepthClear) {
+		for (int y = tileY; y < tileY + TILE_SIZE; ++y) {
+			const size_t row = (size_t)y * pitch + tileX;
+			if (m_pendingColorClear)
+				std::fill(color + row, color + row + TILE_SIZE, m_clearColor);
+			if (m_pendingDepthClear)
+				std::fill(depth + row, depth + row + TILE_SIZE, m_clearDepth);
+		}
+	}
+
+	const int32_t subpixel = 1 << m_subpixelBits;
+	const int32_t half = subpixel >> 1;
+	uint64_t pixels = 0;
+	alignas(32) float uLanes[LANES];
+	alignas(32) float vLanes[LANES];
+
+	for (uint32_t triIndex : m_bins[tileIndex]) {
+		const Triangle& tri = m_triangles[triIndex];
+		const DrawState& draw = m_draws[tri.drawIndex];
+		const int x0 = std::max(tri.minX, tileX);
+		const int x1 = std::min(tri.maxX, tileX + TILE_SIZE - 1);
+		const int y0 = std::max(tri.minY, tileY);
+		const int y1 = std::min(tri.maxY, tileY + TILE_SIZE - 1);
+		if (x0 > x1 || y0 > y1)
+			continue;
+		const int xStart = x0 & ~(LANES - 1);
+
+		// Incrementos de cada arista por paso SIMD y por fila.
+		VecI edgeLaneOffset[3];
+		VecI edgeStepX[3];
+		for (int k = 0; k < 3; ++k) {
+			edgeLaneOffset[k] = iRamp(tri.edgeA[k] * subpixel);
+			edgeStepX[k] = iSet(tri.edgeA[k] * subpixel * LANES);
+		}
+		const VecF laneOffset = fRamp(1.0f);
+		const VecF zStep = fSet(tri.z[0] * LANES);
+		const VecF zLane = fMul(fSet(tri.z[0]), laneOffset);
+
+		for (int y = y0; y <= y1; ++y) {
+			const int64_t py = (int64_t)y * subpixel + half;
+			const int64_t px = (int64_t)xStart * subpixel + half;
+			VecI e[3];
+			for (int k = 0; k < 3; ++k) {
+				const int32_t rowStart = (int32_t)(tri.edgeA[k] * px + tri.edgeB[k] * py + tri.edgeC[k]);
+				e[k] = iAdd(iSet(rowStart), edgeLaneOffset[k]);
+			}
+			const float fy = y + 0.5f;
+			VecF z = fAdd(fSet(evalPlane(tri.z, xStart + 0.5f, fy)), zLane);
+			float* depthRow = depth + (size_t)y * pitch;
+			uint32_t* colorRow = color + (size_t)y * pitch;
+
+			for (int x = xStart; x <= x1; x += LANES) {
+				// Cubierto si las tres aristas son >= 0, es decir, si el OR no tiene bit de signo.
+				int mask = ~iSignMask(iOr(iOr(e[0], e[1]), e[2])) & FULL_MASK;
+				if (x < x0)
+					mask &= FULL_MASK << (x0 - x);
+				if (x + LANES - 1 > x1)
+					mask &= FULL_MASK >> (x + LANES - 1 - x1);
+
+				if (mask) {
+					const VecF oldDepth = fLoad(depthRow + x);
+					mask &= fLessMask(z, oldDepth);
+					if (mask) {
+						fStore(depthRow + x, fSelect(oldDepth, z, mask));
+
+						// Interpolación con corrección de perspectiva.
+						const VecF fx = fAdd(fSet(x + 0.5f), laneOffset);
+						const VecF fyv = fSet(fy);
+						const VecF iw = fAdd(fAdd(fMul(fSet(tri.invW[0]), fx), fMul(fSet(tri.invW[1]), fyv)), fSet(tri.invW[2]));
+						const VecF w = fDiv(fSet(1.0f), iw);
+						const VecF uw = fAdd(fAdd(fMul(fSet(tri.uOverW[0]), fx), fMul(fSet(tri.uOverW[1]), fyv)), fSet(tri.uOverW[2]));
+						const VecF vw = fAdd(fAdd(fMul(fSet(tri.vOverW[0]), fx), fMul(fSet(tri.vOverW[1]), fyv)), fSet(tri.vOverW[2]));
+						fStore(uLanes, fMul(uw, w));
+						fStore(vLanes, fMul(vw, w));
+
+						// Pixel shader: txDiffuse.Sample(samLinear, Tex) * vMeshColor.
+						for (int lane = 0; lane < LANES; ++lane) {
+							if (!(mask & (1 << lane)))
+								continue;
+							float texel[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+							if (draw.texture)
+								sampleBilinear(*draw.texture, uLanes[lane], vLanes[lane], texel);
+							colorRow[x + lane] = packColor(texel[0] * draw.meshColor[0],
+								texel[1] * draw.meshColor[1],
+								texel[2] * draw.meshColor[2],
+								texel[3] * draw.meshColor[3]);
+							++pixels;
+						}
+					}
+				}
+
+				for (int k = 0; k < 3; ++k)
+					e[k] = iAdd(e[k], edgeStepX[k]);
+				z = fAdd(z, zStep);
+			}
+		}
+	}
+
+	m_pixelsWritten.fetch_add(pixels, std::memory_order_relaxed);
+}
+
+// Rasteriza los tiles en paralelo y vacía las listas de trabajo pendientes.
+void
+SoftRasterizer::flush() {
+	if (m_triangles.empty() && !m_pendingColorClear && !m_pendingDepthClear)
+		return;
+
+	const auto start = std::chrono::steady_clock::now();
+	m_pixelsWritten = 0;
+	runParallel(m_tilesX * m_tilesY, [](SoftRasterizer* self, unsigned int tile) {
+		self->rasterizeTile(tile);
+		});
+
+	m_stats.trianglesRasterized += m_triangles.size();
+	m_stats.pixelsWritten += m_pixelsWritten.load();
+	m_stats.rasterSeconds += secondsSince(start);
+
+	m_triangles.clear();
+	m_draws.clear();
+	for (std::vector<uint32_t>& bin : m_bins)
+		bin.clear();
+	m_pendingColorClear = false;
+	m_pendingDepthClear = false;
+}
+
+void
+SoftRasterizer::present() {
+	flush();
+}
+
+namespace {
+	// Traduce los comandos neutrales de CommandList a la superficie del SoftRasterizer.
+	struct SoftCommandExecutor {
+		SoftRasterizer& rasterizer;
+
+		void setInputLayout(const void* inputLayout) {
+			if (inputLayout)
+				rasterizer.IASetInputLayout(static_cast<const SoftInputLayout*>(inputLayout));
+		}
+		void setVertexBuffer(unsigned int slot, const void* buffer, unsigned int stride, unsigned int offset) {
+			const SoftBuffer* vertexBuffer = static_cast<const SoftBuffer*>(buffer);
+			rasterizer.IASetVertexBuffers(slot, 1, &vertexBuffer, &stride, &offset);
+		}
+		void setIndexBuffer(const void* buffer, CommandList::IndexWidth width, unsigned int offset) {
+			rasterizer.IASetIndexBuffer(static_cast<const SoftBuffer*>(buffer),
+				width == CommandList::INDEX_16 ? SOFT_INDEX_16 : SOFT_INDEX_32,
+				offset);
+		}
+		void setPrimitiveTopology(unsigned int) {}
+		void setShader(StateCache::Stage, const void*) {}
+		void setConstantBuffer(StateCache::Stage stage, unsigned int slot, const void* buffer) {
+			const SoftBuffer* constantBuffer = static_cast<const SoftBuffer*>(buffer);
+			if (stage == StateCache::VERTEX_STAGE)
+				rasterizer.VSSetConstantBuffers(slot, 1, &constantBuffer);
+			else
+				rasterizer.PSSetConstantBuffers(slot, 1, &constantBuffer);
+		}
+		void setConstantBufferRange(StateCache::Stage stage, unsigned int slot, const void* buffer,
+			unsigned int firstConstant, unsigned int numConstants) {
+			const SoftBuffer* constantBuffer = static_cast<const SoftBuffer*>(buffer);
+			if (stage == StateCache::VERTEX_STAGE)
+				rasterizer.VSSetConstantBuffers1(slot, 1, &constantBuffer, &firstConstant, &numConstants);
+			else
+				rasterizer.PSSetConstantBuffers1(slot, 1, &constantBuffer, &firstConstant, &numConstants);
+		}
+		void setShaderResource(StateCache::Stage stage, unsigned int slot, const void* view) {
+			const SoftTexture* texture = static_cast<const SoftTexture*>(view);
+			if (stage == StateCache::PIXEL_STAGE)
+				rasterizer.PSSetShaderResources(slot, 1, &texture);
+		}
+		void setSampler(StateCache::Stage, unsigned int, const void*) {}
+		void setViewport(const CommandList::Viewport& viewport) {
+			SoftViewport vp;
+			vp.TopLeftX = viewport.TopLeftX;
+			vp.TopLeftY = viewport.TopLeftY;
+			vp.Width = viewport.Width;
+			vp.Height = viewport.Height;
+			vp.MinDepth = viewport.MinDepth;
+			vp.MaxDepth = viewport.MaxDepth;
+			rasterizer.RSSetViewports(1, &vp);
+		}
+		void setRenderTargets(unsigned int, const void* const*, const void*) {}
+		void updateConstantBuffer(const void* buffer, const void* data, unsigned int size) {
+			rasterizer.UpdateSubresource(static_cast<SoftBuffer*>(const_cast<void*>(buffer)), data, size);
+		}
+		void drawIndexed(unsigned int indexCount, unsigned int startIndexLocation, int baseVertexLocation) {
+			rasterizer.DrawIndexed(indexCount, startIndexLocation, baseVertexLocation);
+		}
+		void drawIndexedInstanced(unsigned int indexCountPerInstance, unsigned int instanceCount,
+			unsigned int startIndexLocation, int baseVertexLocation, unsigned int startInstanceLocation) {
+			rasterizer.DrawIndexedInstanced(indexCountPerInstance, instanceCount, startIndexLocation,
+				baseVertexLocation, startInstanceLocation);
+		}
+	};
+}
+
+// Reproduce una lista de comandos neutral sobre el rasterizador.
+void
+SoftRasterizer::executeCommandList(const CommandList& commandList) {
+	SoftCommandExecutor executor{ *this };
+	commandList.replay(executor);
+}
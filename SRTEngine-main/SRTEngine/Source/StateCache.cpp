@@ -0,0 +1,321 @@
+#include "StateCache.h"
+#include <cstring>
+
+// Olvida todo el estado: la siguiente llamada a cada slot llegará al driver.
+void
+StateCache::invalidate() {
+	m_inputLayout.known = false;
+	m_indexBuffer.known = false;
+	m_topology.known = false;
+	m_rasterizerState.known = false;
+	m_blendState.known = false;
+	m_renderTargetsKnown = false;
+	m_targetResourcesKnown = false;
+	m_viewportsKnown = false;
+	for (Slot<VertexBinding>& slot : m_vertexBuffers)
+		slot.known = false;
+	for (unsigned int stage = 0; stage < STAGE_COUNT; ++stage) {
+		m_shaders[stage].known = false;
+		for (Slot<ConstantBinding>& slot : m_constantBuffers[stage])
+			slot.known = false;
+		for (Slot<const void*>& slot : m_shaderResources[stage])
+			slot.known = false;
+		for (Slot<const void*>& slot : m_samplers[stage])
+			slot.known = false;
+	}
+}
+
+void
+StateCache::setEnabled(bool enabled) {
+	m_enabled = enabled;
+	invalidate();
+}
+
+void
+StateCache::endFrame() {
+	m_lastFrame = m_frame;
+	m_frame = Stats();
+}
+
+// Suma la llamada a los contadores y devuelve si hay que enviarla.
+bool
+StateCache::record(bool changed) {
+	if (changed) {
+		++m_frame.issued;
+		++m_total.issued;
+	}
+	else {
+		++m_frame.filtered;
+		++m_total.filtered;
+	}
+	return changed;
+}
+
+template<typename T>
+bool
+StateCache::filterSingle(Slot<T>& slot, const T& value) {
+	const bool changed = !m_enabled || !slot.known || !(slot.value == value);
+	slot.value = value;
+	slot.known = true;
+	return record(changed);
+}
+
+// Compara un rango de slots y lo recorta al primer y último slot que cambian.
+// Los slots fuera de la copia en sombra siempre cuentan como cambiados.
+template<typename T>
+bool
+StateCache::filterSlots(Slot<T>* slots,
+	unsigned int slotCount,
+	unsigned int startSlot,
+	unsigned int num,
+	const T* values,
+	unsigned int& first,
+	unsigned int& count) {
+	first = startSlot;
+	count = num;
+	if (!m_enabled)
+		return record(true);
+
+	unsigned int firstChanged = startSlot + num;
+	unsigned int lastChanged = startSlot;
+	for (unsigned int i = 0; i < num; ++i) {
+		const unsigned int slot = startSlot + i;
+		bool changed = true;
+		if (slot < slotCount) {
+			changed = !slots[slot].known || !(slots[slot].value == values[i]);
+			slots[slot].value = values[i];
+			slots[slot].known = true;
+		}
+		if (changed) {
+			if (slot < firstChanged)
+				firstChanged = slot;
+			lastChanged = slot;
+		}
+	}
+
+	if (firstChanged == startSlot + num)
+		return record(false);
+	first = firstChanged;
+	count = lastChanged - firstChanged + 1;
+	return record(true);
+}
+
+bool
+StateCache::setInputLayout(const void* inputLayout) {
+	return filterSingle(m_inputLayout, inputLayout);
+}
+
+bool
+StateCache::setVertexBuffers(unsigned int startSlot,
+	unsigned int numBuffers,
+	const void* const* buffers,
+	const unsigned int* strides,
+	const unsigned int* offsets,
+	unsigned int& first,
+	unsigned int& count) {
+	VertexBinding bindings[MAX_VERTEX_BUFFERS];
+	if (numBuffers > MAX_VERTEX_BUFFERS) {
+		// Más slots de los que seguimos: se envía tal cual y se olvida lo cacheado.
+		for (Slot<VertexBinding>& slot : m_vertexBuffers)
+			slot.known = false;
+		first = startSlot;
+		count = numBuffers;
+		return record(true);
+	}
+	for (unsigned int i = 0; i < numBuffers; ++i) {
+		bindings[i].buffer = buffers[i];
+		bindings[i].stride = strides[i];
+		bindings[i].offset = offsets[i];
+	}
+	return filterSlots(m_vertexBuffers, MAX_VERTEX_BUFFERS, startSlot, numBuffers, bindings, first, count);
+}
+
+bool
+StateCache::setIndexBuffer(const void* indexBuffer, unsigned int format, unsigned int offset) {
+	const bool changed = !m_enabled || !m_indexBuffer.known || m_indexBuffer.value != indexBuffer ||
+		m_indexFormat != format || m_indexOffset != offset;
+	m_indexBuffer.value = indexBuffer;
+	m_indexBuffer.known = true;
+	m_indexFormat = format;
+	m_indexOffset = offset;
+	return record(changed);
+}
+
+bool
+StateCache::setPrimitiveTopology(unsigned int topology) {
+	return filterSingle(m_topology, topology);
+}
+
+bool
+StateCache::setShader(Stage stage, const void* shader, unsigned int numClassInstances) {
+	if (numClassInstances > 0) {
+		// Las class instances no se siguen: la llamada pasa y el shader queda desconocido.
+		m_shaders[stage].known = false;
+		return record(true);
+	}
+	return filterSingle(m_shaders[stage], shader);
+}
+
+bool
+StateCache::setConstantBuffers(Stage stage,
+	unsigned int startSlot,
+	unsigned int numBuffers,
+	const void* const* buffers,
+	unsigned int& first,
+	unsigned int& count) {
+	return setConstantBufferRanges(stage, startSlot, numBuffers, buffers, nullptr, nullptr, first, count);
+}
+
+bool
+StateCache::setConstantBufferRanges(Stage stage,
+	unsigned int startSlot,
+	unsigned int numBuffers,
+	const void* const* buffers,
+	const unsigned int* firstConstants,
+	const unsigned int* numConstants,
+	unsigned int& first,
+	unsigned int& count) {
+	ConstantBinding bindings[MAX_CONSTANT_BUFFERS];
+	if (numBuffers > MAX_CONSTANT_BUFFERS) {
+		for (Slot<ConstantBinding>& slot : m_constantBuffers[stage])
+			slot.known = false;
+		first = startSlot;
+		count = numBuffers;
+		return record(true);
+	}
+	const bool ranged = firstConstants && numConstants;
+	for (unsigned int i = 0; i < numBuffers; ++i) {
+		bindings[i].buffer = buffers[i];
+		bindings[i].firstConstant = ranged ? firstConstants[i] : 0;
+		bindings[i].numConstants = ranged ? numConstants[i] : 0;
+	}
+	return filterSlots(m_constantBuffers[stage], MAX_CONSTANT_BUFFERS, startSlot, numBuffers, bindings, first, count);
+}
+
+bool
+StateCache::setShaderResources(Stage stage,
+	unsigned int startSlot,
+	unsigned int numViews,
+	const void* const* views,
+	unsigned int& first,
+	unsigned int& count,
+	const void* const* resources) {
+	const bool changed = filterSlots(m_shaderResources[stage], MAX_SHADER_RESOURCES, startSlot, numViews, views,
+		first, count);
+	for (unsigned int i = 0; i < numViews && startSlot + i < MAX_SHADER_RESOURCES; ++i) {
+		const unsigned int slot = startSlot + i;
+		const void* resource = resources ? resources[i] : nullptr;
+		m_shaderResourceOwners[stage][slot] = resource;
+		// El driver deja a nulo una vista cuyo recurso es render target: lo cacheado no vale.
+		if (views[i] && resource && isBoundAsTarget(resource))
+			m_shaderResources[stage][slot].known = false;
+	}
+	return changed;
+}
+
+bool
+StateCache::setSamplers(Stage stage,
+	unsigned int startSlot,
+	unsigned int numSamplers,
+	const void* const* samplers,
+	unsigned int& first,
+	unsigned int& count) {
+	return filterSlots(m_samplers[stage], MAX_SAMPLERS, startSlot, numSamplers, samplers, first, count);
+}
+
+bool
+StateCache::setRasterizerState(const void* rasterizerState) {
+	return filterSingle(m_rasterizerState, rasterizerState);
+}
+
+bool
+StateCache::setBlendState(const void* blendState, const float blendFactor[4], unsigned int sampleMask) {
+	// Un BlendFactor nulo equivale a { 1, 1, 1, 1 } en D3D11.
+	const float defaultFactor[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	const float* factor = blendFactor ? blendFactor : defaultFactor;
+	const bool changed = !m_enabled || !m_blendState.known || m_blendState.value != blendState ||
+		memcmp(m_blendFactor, factor, sizeof(m_blendFactor)) != 0 || m_sampleMask != sampleMask;
+	m_blendState.value = blendState;
+	m_blendState.known = true;
+	memcpy(m_blendFactor, factor, sizeof(m_blendFactor));
+	m_sampleMask = sampleMask;
+	return record(changed);
+}
+
+bool
+StateCache::isBoundAsTarget(const void* resource) const {
+	if (!m_targetResourcesKnown)
+		return false;
+	for (unsigned int i = 0; i < m_numRenderTargets; ++i) {
+		if (m_targetResources[i] == resource)
+			return true;
+	}
+	return m_targetResources[MAX_RENDER_TARGETS] == resource;
+}
+
+// Un SRV se mantiene solo si se sabe que su recurso no es ninguno de los targets nuevos.
+void
+StateCache::invalidateTargetHazards() {
+	for (unsigned int stage = 0; stage < STAGE_COUNT; ++stage) {
+		for (unsigned int slot = 0; slot < MAX_SHADER_RESOURCES; ++slot) {
+			Slot<const void*>& view = m_shaderResources[stage][slot];
+			if (!view.known || !view.value)
+				continue;
+			const void* resource = m_shaderResourceOwners[stage][slot];
+			if (!m_targetResourcesKnown || !resource || isBoundAsTarget(resource))
+				view.known = false;
+		}
+	}
+}
+
+bool
+StateCache::setRenderTargets(unsigned int numViews,
+	const void* const* renderTargetViews,
+	const void* depthStencilView,
+	const void* const* resources) {
+	if (numViews > MAX_RENDER_TARGETS) {
+		m_renderTargetsKnown = false;
+		m_targetResourcesKnown = false;
+		invalidateTargetHazards();
+		return record(true);
+	}
+
+	bool changed = !m_enabled || !m_renderTargetsKnown || m_numRenderTargets != numViews ||
+		m_depthStencil != depthStencilView;
+	for (unsigned int i = 0; i < numViews && !changed; ++i) {
+		changed = m_renderTargets[i] != renderTargetViews[i];
+	}
+
+	m_renderTargetsKnown = true;
+	m_numRenderTargets = numViews;
+	m_depthStencil = depthStencilView;
+	for (unsigned int i = 0; i < numViews; ++i) {
+		m_renderTargets[i] = renderTargetViews[i];
+	}
+
+	if (changed) {
+		// D3D11 quita de los slots de SRV cualquier recurso que pase a ser render target.
+		m_targetResourcesKnown = resources != nullptr;
+		for (unsigned int i = 0; i < numViews; ++i)
+			m_targetResources[i] = resources ? resources[i] : nullptr;
+		m_targetResources[MAX_RENDER_TARGETS] = resources ? resources[numViews] : nullptr;
+		invalidateTargetHazards();
+	}
+	return record(changed);
+}
+
+bool
+StateCache::setViewports(unsigned int numViewports, const void* viewports, size_t viewportSize) {
+	const size_t bytes = (size_t)numViewports * viewportSize;
+	if (bytes > MAX_VIEWPORT_BYTES) {
+		m_viewportsKnown = false;
+		return record(true);
+	}
+
+	const bool changed = !m_enabled || !m_viewportsKnown || m_viewportBytes != bytes ||
+		memcmp(m_viewports, viewports, bytes) != 0;
+	m_viewportsKnown = true;
+	m_viewportBytes = bytes;
+	memcpy(m_viewports, viewports, bytes);
+	return record(changed);
+}
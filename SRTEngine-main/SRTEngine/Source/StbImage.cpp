@@ -0,0 +1,3 @@
+// Implementación de stb_image para todo el motor (Texture, TextureCache, TextureLoader).
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
@@ -82,7 +82,9 @@ HRESULT SwapChain::init(Device& device,
     // Configurar la descripción del SwapChain.
     DXGI_SWAP_CHAIN_DESC sd;
     memset(&sd, 0, sizeof(sd));
-    sd.BufferCount = 1;
+    // Un buffer trasero más para que la GPU dibuje el siguiente frame mientras se muestra el actual.
+    // El swap effect sigue siendo DISCARD: los modelos FLIP no admiten buffers con MSAA.
+    sd.BufferCount = 2;
     sd.BufferDesc.Width = window.m_width;
     sd.BufferDesc.Height = window.m_height;
     sd.BufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
@@ -159,10 +161,11 @@ void SwapChain::destroy() {
 /**
  * Presenta el contenido renderizado en la pantalla.
  * Presenta el frame en la pantalla, mostrando el contenido del buffer de la cadena de intercambio.
+ * @param syncInterval Refrescos verticales que se espera (0 = presentar en cuanto se pueda).
  */
-void SwapChain::present() {
+void SwapChain::present(unsigned int syncInterval) {
     if (m_swapchain) {
-        HRESULT hr = m_swapchain->Present(0, 0);
+        HRESULT hr = m_swapchain->Present(syncInterval, 0);
         if (FAILED(hr)) {
             ERROR("SwapChain", "present", "Failed to present swap chain");
         }
@@ -171,3 +174,30 @@ void SwapChain::present() {
         ERROR("SwapChain", "present", "SwapChain is nullptr");
     }
 }
+
+/**
+ * Limita los frames que la CPU puede adelantarse a la GPU.
+ * DXGI bloquea Present() cuando ya hay ese número de frames encolados.
+ * @param frames Número máximo de frames en cola (1 a 16).
+ * @return HRESULT indicando si se pudo aplicar el límite.
+ */
+HRESULT SwapChain::setMaximumFrameLatency(unsigned int frames) {
+    if (!m_dxgiDevice) {
+        ERROR("SwapChain", "setMaximumFrameLatency", "DXGI device is nullptr");
+        return E_POINTER;
+    }
+
+    IDXGIDevice1* dxgiDevice1 = nullptr;
+    HRESULT hr = m_dxgiDevice->QueryInterface(__uuidof(IDXGIDevice1), reinterpret_cast<void**>(&dxgiDevice1));
+    if (FAILED(hr)) {
+        ERROR("SwapChain", "setMaximumFrameLatency", "Failed to query IDXGIDevice1");
+        return hr;
+    }
+
+    hr = dxgiDevice1->SetMaximumFrameLatency(frames);
+    SAFE_RELEASE(dxgiDevice1);
+    if (FAILED(hr)) {
+        ERROR("SwapChain", "setMaximumFrameLatency", "Failed to set maximum frame latency");
+    }
+    return hr;
+}
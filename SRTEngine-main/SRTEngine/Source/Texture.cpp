@@ -1,8 +1,8 @@
-﻿#define STB_IMAGE_IMPLEMENTATION
-#include "stb_image.h"
+﻿#include "stb_image.h"
 #include "Texture.h"
 #include "Device.h"
 #include "DeviceContext.h"
+#include "DDSFile.h"
 
 /**
  * Inicializa una textura desde un archivo dependiendo de la extensión.
@@ -10,9 +10,10 @@
  * @param device Dispositivo de DirectX 11 para interactuar con la GPU.
  * @param textureName Nombre del archivo de la textura a cargar.
  * @param extensionType Tipo de extensión del archivo (DDS, PNG).
+ * @param compression Formato BC al que comprimir las imágenes PNG (BC_FORMAT_NONE = RGBA8).
  * @return HRESULT que indica el éxito o fracaso de la operación.
  */
-HRESULT Texture::init(Device device, const std::string& textureName, ExtensionType extensionType) {
+HRESULT Texture::init(Device device, const std::string& textureName, ExtensionType extensionType, BCFormat compression) {
     if (!device.m_device) {
         ERROR("Texture", "init", "Device is nullptr in texture loading method");
         return E_POINTER;
@@ -22,23 +23,22 @@ HRESULT Texture::init(Device device, const std::string& textureName, ExtensionTy
 
     // Dependiendo del tipo de extensión, se maneja de diferente forma
     switch (extensionType) {
-    case DDS:
-        // Cargar textura DDS utilizando DirectX 11.
-        hr = D3DX11CreateShaderResourceViewFromFile(
-            device.m_device,
-            textureName.c_str(),
-            nullptr,
-            nullptr,
-            &m_textureFromImg,
-            nullptr
-        );
-
+    case DDS: {
+        // Proyectar el archivo en memoria y pasar sus mips directamente a la GPU.
+        DDSFile dds;
+        hr = dds.open(textureName);
         if (FAILED(hr)) {
             ERROR("Texture", "init",
                 ("Failed to load DDS texture. Verify filepath: " + textureName).c_str());
             return hr;
         }
+
+        hr = initFromDDS(device, dds);
+        if (FAILED(hr)) {
+            return hr;
+        }
         break;
+    }
 
     case PNG: {
         int width, height, channels;
@@ -49,41 +49,31 @@ HRESULT Texture::init(Device device, const std::string& textureName, ExtensionTy
             return E_FAIL;
         }
 
-        // Crear la descripción de la textura para la GPU.
-        D3D11_TEXTURE2D_DESC textureDesc = {};
-        textureDesc.Width = width;
-        textureDesc.Height = height;
-        textureDesc.MipLevels = 1;
-        textureDesc.ArraySize = 1;
-        textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
-        textureDesc.SampleDesc.Count = 1;
-        textureDesc.Usage = D3D11_USAGE_DEFAULT;
-        textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-
-        // Crear la textura en la GPU usando los datos cargados de la imagen.
-        D3D11_SUBRESOURCE_DATA initData = {};
-        initData.pSysMem = data;
-        initData.SysMemPitch = width * 4;
-
-        hr = device.CreateTexture2D(&textureDesc, &initData, &m_texture);
+        // Generar la cadena de mips en CPU para que el sampler lineal no produzca aliasing al reducir.
+        std::vector<MipLevel> levels;
+        MipGenerator::Options mipOptions;
+        mipOptions.threadCount = 0;
+        hr = MipGenerator::generate(data, width, height, mipOptions, levels);
         stbi_image_free(data); // Liberar la memoria de la imagen.
-
         if (FAILED(hr)) {
-            ERROR("Texture", "init", "Failed to create texture from PNG data");
             return hr;
         }
 
-        // Crear vista del recurso de la textura para ser usado en shaders.
-        D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-        srvDesc.Format = textureDesc.Format;
-        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
-        srvDesc.Texture2D.MipLevels = 1;
-
-        hr = device.m_device->CreateShaderResourceView(m_texture, &srvDesc, &m_textureFromImg);
-        SAFE_RELEASE(m_texture); // Liberar la textura intermedia.
-
+        // Direct3D 11 exige que el nivel 0 de una textura BC mida múltiplos de 4; si no, se sube sin comprimir.
+        if (compression != BC_FORMAT_NONE && width % 4 == 0 && height % 4 == 0) {
+            std::vector<CompressedLevel> compressed;
+            BlockCompressor::Options bcOptions;
+            bcOptions.threadCount = 0;
+            hr = BlockCompressor::encodeChain(levels, compression, bcOptions, compressed);
+            if (FAILED(hr)) {
+                return hr;
+            }
+            hr = initFromCompressedChain(device, compressed, compression);
+        }
+        else {
+            hr = initFromMipChain(device, levels);
+        }
         if (FAILED(hr)) {
-            ERROR("Texture", "init", "Failed to create shader resource view for PNG texture");
             return hr;
         }
         break;
@@ -148,6 +138,255 @@ HRESULT Texture::init(Device device,
     return hr;
 }
 
+/**
+ * Crea la textura en la GPU a partir de una cadena de mips RGBA8 y su vista para los shaders.
+ * Lo usan la carga síncrona de PNG y el TextureLoader al terminar de decodificar en otro hilo.
+ * @param device Dispositivo de DirectX 11 para interactuar con la GPU.
+ * @param levels Niveles de la cadena, del más grande al más pequeño.
+ * @return HRESULT que indica el éxito o fracaso de la operación.
+ */
+HRESULT Texture::initFromMipChain(Device device, const std::vector<MipLevel>& levels) {
+    if (!device.m_device) {
+        ERROR("Texture", "initFromMipChain", "Device is nullptr");
+        return E_POINTER;
+    }
+    if (levels.empty() || levels[0].width == 0 || levels[0].height == 0) {
+        ERROR("Texture", "initFromMipChain", "Invalid mip chain");
+        return E_INVALIDARG;
+    }
+
+    // Crear la descripción de la textura para la GPU.
+    D3D11_TEXTURE2D_DESC textureDesc = {};
+    textureDesc.Width = levels[0].width;
+    textureDesc.Height = levels[0].height;
+    textureDesc.MipLevels = (unsigned int)levels.size();
+    textureDesc.ArraySize = 1;
+    textureDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+    textureDesc.SampleDesc.Count = 1;
+    textureDesc.Usage = D3D11_USAGE_DEFAULT;
+    textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+    // Un D3D11_SUBRESOURCE_DATA por nivel.
+    std::vector<D3D11_SUBRESOURCE_DATA> initData(levels.size());
+    for (size_t i = 0; i < levels.size(); ++i) {
+        initData[i].pSysMem = levels[i].pixels.data();
+        initData[i].SysMemPitch = levels[i].width * 4;
+        initData[i].SysMemSlicePitch = 0;
+    }
+
+    HRESULT hr = device.CreateTexture2D(&textureDesc, initData.data(), &m_texture);
+    if (FAILED(hr)) {
+        ERROR("Texture", "initFromMipChain", "Failed to create texture from mip chain");
+        return hr;
+    }
+
+    // Crear vista del recurso de la textura para ser usado en shaders.
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = textureDesc.Format;
+    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Texture2D.MipLevels = textureDesc.MipLevels;
+
+    hr = device.m_device->CreateShaderResourceView(m_texture, &srvDesc, &m_textureFromImg);
+    SAFE_RELEASE(m_texture); // Liberar la textura intermedia.
+
+    if (FAILED(hr)) {
+        ERROR("Texture", "initFromMipChain", "Failed to create shader resource view");
+        return hr;
+    }
+    return hr;
+}
+
+/**
+ * Crea la textura en la GPU a partir de un archivo DDS y su vista para los shaders.
+ * Los D3D11_SUBRESOURCE_DATA apuntan a la proyección del archivo, así que los datos van del
+ * disco al driver sin copias intermedias en el motor.
+ * @param device Dispositivo de DirectX 11 para interactuar con la GPU.
+ * @param dds Archivo DDS abierto; tiene que seguir abierto durante la llamada.
+ * @return HRESULT que indica el éxito o fracaso de la operación.
+ */
+HRESULT Texture::initFromDDS(Device device, const DDSFile& dds) {
+    if (!device.m_device) {
+        ERROR("Texture", "initFromDDS", "Device is nullptr");
+        return E_POINTER;
+    }
+    const std::vector<DDSFile::Subresource>& subresources = dds.getSubresources();
+    if (subresources.empty()) {
+        ERROR("Texture", "initFromDDS", "DDS file is not open");
+        return E_INVALIDARG;
+    }
+
+    std::vector<D3D11_SUBRESOURCE_DATA> initData(subresources.size());
+    for (size_t i = 0; i < subresources.size(); ++i) {
+        initData[i].pSysMem = subresources[i].data;
+        initData[i].SysMemPitch = subresources[i].rowPitch;
+        initData[i].SysMemSlicePitch = subresources[i].slicePitch;
+    }
+
+    const DXGI_FORMAT format = (DXGI_FORMAT)dds.getFormat();
+    const unsigned int arraySize = dds.getArraySize();
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = format;
+    ID3D11Resource* resource = nullptr;
+    HRESULT hr = E_FAIL;
+
+    switch (dds.getDimension()) {
+    case DDSFile::DIMENSION_TEXTURE1D: {
+        D3D11_TEXTURE1D_DESC desc = {};
+        desc.Width = dds.getWidth();
+        desc.MipLevels = dds.getMipCount();
+        desc.ArraySize = arraySize;
+        desc.Format = format;
+        desc.Usage = D3D11_USAGE_IMMUTABLE;
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+        ID3D11Texture1D* texture = nullptr;
+        hr = device.m_device->CreateTexture1D(&desc, initData.data(), &texture);
+        resource = texture;
+        if (arraySize > 1) {
+            srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE1DARRAY;
+            srvDesc.Texture1DArray.MipLevels = desc.MipLevels;
+            srvDesc.Texture1DArray.ArraySize = arraySize;
+        }
+        else {
+            srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE1D;
+            srvDesc.Texture1D.MipLevels = desc.MipLevels;
+        }
+        break;
+    }
+
+    case DDSFile::DIMENSION_TEXTURE2D: {
+        D3D11_TEXTURE2D_DESC desc = {};
+        desc.Width = dds.getWidth();
+        desc.Height = dds.getHeight();
+        desc.MipLevels = dds.getMipCount();
+        desc.ArraySize = arraySize;
+        desc.Format = format;
+        desc.SampleDesc.Count = 1;
+        desc.Usage = D3D11_USAGE_IMMUTABLE;
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+        desc.MiscFlags = dds.isCubemap() ? D3D11_RESOURCE_MISC_TEXTURECUBE : 0;
+
+        hr = device.CreateTexture2D(&desc, initData.data(), &m_texture);
+        resource = m_texture;
+        m_texture = nullptr;
+        if (dds.isCubemap() && arraySize > 6) {
+            srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBEARRAY;
+            srvDesc.TextureCubeArray.MipLevels = desc.MipLevels;
+            srvDesc.TextureCubeArray.NumCubes = arraySize / 6;
+        }
+        else if (dds.isCubemap()) {
+            srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURECUBE;
+            srvDesc.TextureCube.MipLevels = desc.MipLevels;
+        }
+        else if (arraySize > 1) {
+            srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2DARRAY;
+            srvDesc.Texture2DArray.MipLevels = desc.MipLevels;
+            srvDesc.Texture2DArray.ArraySize = arraySize;
+        }
+        else {
+            srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+            srvDesc.Texture2D.MipLevels = desc.MipLevels;
+        }
+        break;
+    }
+
+    case DDSFile::DIMENSION_TEXTURE3D: {
+        D3D11_TEXTURE3D_DESC desc = {};
+        desc.Width = dds.getWidth();
+        desc.Height = dds.getHeight();
+        desc.Depth = dds.getDepth();
+        desc.MipLevels = dds.getMipCount();
+        desc.Format = format;
+        desc.Usage = D3D11_USAGE_IMMUTABLE;
+        desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+        ID3D11Texture3D* texture = nullptr;
+        hr = device.m_device->CreateTexture3D(&desc, initData.data(), &texture);
+        resource = texture;
+        srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE3D;
+        srvDesc.Texture3D.MipLevels = desc.MipLevels;
+        break;
+    }
+
+    default:
+        ERROR("Texture", "initFromDDS", "Unsupported DDS resource dimension");
+        return E_INVALIDARG;
+    }
+
+    if (FAILED(hr)) {
+        ERROR("Texture", "initFromDDS", "Failed to create texture from DDS data");
+        SAFE_RELEASE(resource);
+        return hr;
+    }
+
+    // Crear vista del recurso y liberar la referencia intermedia a la textura.
+    hr = device.m_device->CreateShaderResourceView(resource, &srvDesc, &m_textureFromImg);
+    SAFE_RELEASE(resource);
+
+    if (FAILED(hr)) {
+        ERROR("Texture", "initFromDDS", "Failed to create shader resource view");
+        return hr;
+    }
+    return hr;
+}
+
+/**
+ * Crea la textura en la GPU a partir de una cadena de mips comprimida por bloques (BC1/BC3/BC4/BC5/BC7).
+ * Cada fila de bloques ocupa ceil(width / 4) * bytes por bloque, que es el pitch que espera Direct3D.
+ * @param device Dispositivo de DirectX 11 para interactuar con la GPU.
+ * @param levels Niveles comprimidos, del más grande al más pequeño.
+ * @param format Formato de los bloques.
+ * @return HRESULT que indica el éxito o fracaso de la operación.
+ */
+HRESULT Texture::initFromCompressedChain(Device device, const std::vector<CompressedLevel>& levels, BCFormat format) {
+    if (!device.m_device) {
+        ERROR("Texture", "initFromCompressedChain", "Device is nullptr");
+        return E_POINTER;
+    }
+    const unsigned int blockBytes = BlockCompressor::blockBytes(format);
+    if (levels.empty() || blockBytes == 0 || levels[0].width % 4 != 0 || levels[0].height % 4 != 0) {
+        ERROR("Texture", "initFromCompressedChain", "Invalid compressed mip chain");
+        return E_INVALIDARG;
+    }
+
+    D3D11_TEXTURE2D_DESC textureDesc = {};
+    textureDesc.Width = levels[0].width;
+    textureDesc.Height = levels[0].height;
+    textureDesc.MipLevels = (unsigned int)levels.size();
+    textureDesc.ArraySize = 1;
+    textureDesc.Format = BlockCompressor::dxgiFormat(format);
+    textureDesc.SampleDesc.Count = 1;
+    textureDesc.Usage = D3D11_USAGE_IMMUTABLE;
+    textureDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+
+    std::vector<D3D11_SUBRESOURCE_DATA> initData(levels.size());
+    for (size_t i = 0; i < levels.size(); ++i) {
+        initData[i].pSysMem = levels[i].blocks.data();
+        initData[i].SysMemPitch = ((levels[i].width + 3) / 4) * blockBytes;
+        initData[i].SysMemSlicePitch = 0;
+    }
+
+    HRESULT hr = device.CreateTexture2D(&textureDesc, initData.data(), &m_texture);
+    if (FAILED(hr)) {
+        ERROR("Texture", "initFromCompressedChain", "Failed to create compressed texture");
+        return hr;
+    }
+
+    D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = textureDesc.Format;
+    srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Texture2D.MipLevels = textureDesc.MipLevels;
+
+    hr = device.m_device->CreateShaderResourceView(m_texture, &srvDesc, &m_textureFromImg);
+    SAFE_RELEASE(m_texture);
+
+    if (FAILED(hr)) {
+        ERROR("Texture", "initFromCompressedChain", "Failed to create shader resource view");
+        return hr;
+    }
+    return hr;
+}
+
 /**
  * Método para actualizar la textura. Actualmente no realiza ninguna acción, pero se puede implementar
  * futuras actualizaciones o animaciones de la textura.
@@ -165,9 +404,7 @@ void Texture::update() {
  */
 void Texture::render(DeviceContext& deviceContext, unsigned int StartSlot, unsigned int NumViews) {
     if (m_textureFromImg) {
-        // Liberar los recursos previos para evitar conflictos.
-        ID3D11ShaderResourceView* nullSRV[] = { nullptr };
-        deviceContext.PSSetShaderResources(StartSlot, NumViews, nullSRV);
+        // El DeviceContext descarta el enlace si la textura ya está en el slot.
         deviceContext.PSSetShaderResources(StartSlot, NumViews, &m_textureFromImg);
     }
     else {
@@ -0,0 +1,440 @@
+#include "TextureCache.h"
+#include "AssetArchive.h"
+#include "DDSFile.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#ifdef _WIN32
+#include "Device.h"
+#include "Texture.h"
+#endif
+
+namespace {
+
+	const uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+	const uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+	const uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+	const uint64_t PRIME4 = 0x85EBCA77C2B2AE63ULL;
+	const uint64_t PRIME5 = 0x27D4EB2F165667C5ULL;
+
+	uint64_t rotl(uint64_t value, int bits) {
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	uint64_t read64(const uint8_t* data) {
+		uint64_t value;
+		std::memcpy(&value, data, sizeof(value));
+		return value;
+	}
+
+	uint64_t round64(uint64_t acc, uint64_t input) {
+		return rotl(acc + input * PRIME2, 31) * PRIME1;
+	}
+
+	uint64_t merge64(uint64_t acc, uint64_t value) {
+		return (acc ^ round64(0, value)) * PRIME1 + PRIME4;
+	}
+
+	// Hash de 64 bits del contenido (XXH64 con semilla 0): cuatro acumuladores independientes
+	// de 8 bytes, así que va a la velocidad de la memoria y no limita la lectura del archivo.
+	uint64_t hashContents(const uint8_t* data, size_t size) {
+		const uint8_t* p = data;
+		const uint8_t* end = data + size;
+		uint64_t hash;
+		if (size >= 32) {
+			uint64_t v1 = PRIME1 + PRIME2, v2 = PRIME2, v3 = 0, v4 = 0 - PRIME1;
+			for (; p + 32 <= end; p += 32) {
+				v1 = round64(v1, read64(p));
+				v2 = round64(v2, read64(p + 8));
+				v3 = round64(v3, read64(p + 16));
+				v4 = round64(v4, read64(p + 24));
+			}
+			hash = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+			hash = merge64(hash, v1);
+			hash = merge64(hash, v2);
+			hash = merge64(hash, v3);
+			hash = merge64(hash, v4);
+		}
+		else {
+			hash = PRIME5;
+		}
+		hash += (uint64_t)size;
+
+		for (; p + 8 <= end; p += 8)
+			hash = rotl(hash ^ round64(0, read64(p)), 27) * PRIME1 + PRIME4;
+		if (p + 4 <= end) {
+			uint32_t word;
+			std::memcpy(&word, p, sizeof(word));
+			hash = rotl(hash ^ (word * PRIME1), 23) * PRIME2 + PRIME3;
+			p += 4;
+		}
+		for (; p < end; ++p)
+			hash = rotl(hash ^ (*p * PRIME5), 11) * PRIME1;
+
+		hash ^= hash >> 33;
+		hash *= PRIME2;
+		hash ^= hash >> 29;
+		hash *= PRIME3;
+		hash ^= hash >> 32;
+		return hash;
+	}
+
+	bool readFile(const std::string& fileName, std::vector<uint8_t>& contents) {
+		std::ifstream stream(fileName, std::ios::binary | std::ios::ate);
+		if (!stream)
+			return false;
+		const std::streamoff size = stream.tellg();
+		if (size <= 0 || size >= INT32_MAX)
+			return false;
+		contents.resize((size_t)size);
+		stream.seekg(0);
+		stream.read(reinterpret_cast<char*>(contents.data()), size);
+		return (bool)stream;
+	}
+}
+
+// Una textura de la caché; puede tener varias rutas si el contenido se repite.
+struct TextureCache::Entry {
+	enum State { LOADING, READY, FAILED };
+
+	State state = LOADING;
+	unsigned int refs = 0;
+	uint64_t contentKey = 0;
+	uint64_t bytes = 0;
+	std::vector<std::string> paths;
+	std::list<Handle>::iterator lruPosition;
+	bool inLru = false;
+	std::vector<MipLevel> levels;
+#ifdef _WIN32
+	Texture* texture = nullptr;
+#endif
+
+	~Entry() {
+#ifdef _WIN32
+		if (texture) {
+			texture->destroy();
+			delete texture;
+		}
+#endif
+	}
+};
+
+TextureCache::TextureCache() = default;
+
+TextureCache::~TextureCache() {
+	destroy();
+}
+
+HRESULT
+TextureCache::init(Device* device, uint64_t budgetBytes, BCFormat compression) {
+	destroy();
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_device = device;
+	m_budget = budgetBytes;
+	m_compression = compression;
+	m_stats = Stats();
+	return S_OK;
+}
+
+void
+TextureCache::destroy() {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_lru.clear();
+	m_byPath.clear();
+	m_byContent.clear();
+	m_entries.clear();
+	m_freeSlots.clear();
+	m_stats.residentBytes = 0;
+	m_stats.entries = 0;
+}
+
+void
+TextureCache::setArchive(const AssetArchive* archive) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_archive = archive;
+}
+
+// Busca por ruta; si no está, lee el archivo y busca por contenido antes de cargar.
+TextureCache::Handle
+TextureCache::acquire(const std::string& fileName) {
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		auto found = m_byPath.find(fileName);
+		if (found != m_byPath.end()) {
+			++m_stats.hits;
+			return waitForEntry(lock, found->second);
+		}
+	}
+
+	// La lectura y el hash se hacen sin el candado: otros hilos pueden seguir usando la caché.
+	// Una entrada sin comprimir del archivo empaquetado se usa en el sitio, sin copiarla.
+	const AssetArchive* archive;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		archive = m_archive;
+	}
+	std::vector<uint8_t> contents;
+	const uint8_t* data = nullptr;
+	size_t size = 0;
+	if (archive && archive->contains(fileName)) {
+		data = archive->view(fileName, size);
+		if (!data && SUCCEEDED(archive->read(fileName, contents))) {
+			data = contents.data();
+			size = contents.size();
+		}
+	}
+	else if (readFile(fileName, contents)) {
+		data = contents.data();
+		size = contents.size();
+	}
+	if (!data || size == 0 || size >= INT32_MAX) {
+		ERROR("TextureCache", "acquire", ("Cannot read " + fileName).c_str());
+		std::lock_guard<std::mutex> lock(m_mutex);
+		++m_stats.failures;
+		return INVALID_HANDLE;
+	}
+	// El tamaño entra en la clave para que una colisión del hash exija además la misma longitud.
+	const uint64_t key = hashContents(data, size) ^ ((uint64_t)size * PRIME3);
+
+	Handle handle;
+	Entry* entry;
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+		// Otro hilo pudo cargar la misma ruta o el mismo contenido mientras se leía.
+		auto found = m_byPath.find(fileName);
+		if (found != m_byPath.end()) {
+			++m_stats.hits;
+			return waitForEntry(lock, found->second);
+		}
+		auto sameContent = m_byContent.find(key);
+		if (sameContent != m_byContent.end()) {
+			++m_stats.contentHits;
+			m_byPath[fileName] = sameContent->second;
+			m_entries[sameContent->second]->paths.push_back(fileName);
+			return waitForEntry(lock, sameContent->second);
+		}
+
+		++m_stats.misses;
+		if (!m_freeSlots.empty()) {
+			handle = m_freeSlots.back();
+			m_freeSlots.pop_back();
+		}
+		else {
+			handle = (Handle)m_entries.size();
+			m_entries.emplace_back();
+		}
+		m_entries[handle].reset(new Entry());
+		entry = m_entries[handle].get();
+		entry->refs = 1;
+		entry->contentKey = key;
+		entry->paths.push_back(fileName);
+		m_byPath[fileName] = handle;
+		m_byContent[key] = handle;
+	}
+
+	const bool loaded = createPayload(*entry, fileName, data, size);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (loaded) {
+		entry->state = Entry::READY;
+		++m_stats.entries;
+		m_stats.residentBytes += entry->bytes;
+		m_stats.peakBytes = std::max(m_stats.peakBytes, m_stats.residentBytes);
+	}
+	else {
+		// Se quita de los índices ya para que un acquire() posterior lo vuelva a intentar.
+		entry->state = Entry::FAILED;
+		++m_stats.failures;
+		for (const std::string& path : entry->paths)
+			m_byPath.erase(path);
+		m_byContent.erase(key);
+		entry->paths.clear();
+	}
+	m_loaded.notify_all();
+
+	if (!loaded) {
+		releaseLocked(handle);
+		return INVALID_HANDLE;
+	}
+	evictOverBudget();
+	return handle;
+}
+
+// Toma una referencia a una entrada y espera a que termine de cargarse (con el candado tomado).
+TextureCache::Handle
+TextureCache::waitForEntry(std::unique_lock<std::mutex>& lock, Handle handle) {
+	Entry* entry = m_entries[handle].get();
+	++entry->refs;
+	if (entry->inLru) {
+		m_lru.erase(entry->lruPosition);
+		entry->inLru = false;
+	}
+	m_loaded.wait(lock, [entry]() { return entry->state != Entry::LOADING; });
+	if (entry->state == Entry::FAILED) {
+		releaseLocked(handle);
+		return INVALID_HANDLE;
+	}
+	return handle;
+}
+
+void
+TextureCache::addRef(Handle handle) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (handle < m_entries.size() && m_entries[handle] && m_entries[handle]->refs > 0)
+		++m_entries[handle]->refs;
+}
+
+void
+TextureCache::release(Handle handle) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (handle >= m_entries.size() || !m_entries[handle] || m_entries[handle]->refs == 0) {
+		ERROR("TextureCache", "release", "Handle is not acquired");
+		return;
+	}
+	releaseLocked(handle);
+}
+
+void
+TextureCache::releaseLocked(Handle handle) {
+	Entry& entry = *m_entries[handle];
+	if (--entry.refs > 0)
+		return;
+	if (entry.state == Entry::FAILED) {
+		removeEntry(handle);
+		return;
+	}
+	m_lru.push_front(handle);
+	entry.lruPosition = m_lru.begin();
+	entry.inLru = true;
+	evictOverBudget();
+}
+
+// Expulsa entradas sin referencias, la menos usada primero, hasta volver al presupuesto.
+void
+TextureCache::evictOverBudget() {
+	while (m_stats.residentBytes > m_budget && !m_lru.empty()) {
+		const Handle handle = m_lru.back();
+		m_lru.pop_back();
+		m_entries[handle]->inLru = false;
+		++m_stats.evictions;
+		removeEntry(handle);
+	}
+}
+
+void
+TextureCache::removeEntry(Handle handle) {
+	Entry& entry = *m_entries[handle];
+	for (const std::string& path : entry.paths) {
+		auto found = m_byPath.find(path);
+		if (found != m_byPath.end() && found->second == handle)
+			m_byPath.erase(found);
+	}
+	auto found = m_byContent.find(entry.contentKey);
+	if (found != m_byContent.end() && found->second == handle)
+		m_byContent.erase(found);
+	if (entry.state == Entry::READY) {
+		m_stats.residentBytes -= entry.bytes;
+		--m_stats.entries;
+	}
+	m_entries[handle].reset();
+	m_freeSlots.push_back(handle);
+}
+
+// Decodifica el archivo y crea la textura (sin el candado; la entrada aún no es visible como READY).
+bool
+TextureCache::createPayload(Entry& entry, const std::string& fileName, const uint8_t* contents, size_t size) {
+	if (size >= 4 && std::memcmp(contents, "DDS ", 4) == 0) {
+		DDSFile dds;
+		if (FAILED(dds.parse(contents, size))) {
+			ERROR("TextureCache", "createPayload", ("Invalid DDS file " + fileName).c_str());
+			return false;
+		}
+		entry.bytes = dds.getDataSize();
+#ifdef _WIN32
+		if (m_device) {
+			entry.texture = new Texture();
+			return SUCCEEDED(entry.texture->initFromDDS(*m_device, dds));
+		}
+#endif
+		// Sin dispositivo un DDS solo se valida.
+		return true;
+	}
+
+	int width = 0, height = 0, channels = 0;
+	unsigned char* pixels = stbi_load_from_memory(contents, (int)size, &width, &height, &channels, 4);
+	if (!pixels) {
+		ERROR("TextureCache", "createPayload",
+			("Failed to load " + fileName + ": " + std::string(stbi_failure_reason())).c_str());
+		return false;
+	}
+
+	std::vector<MipLevel> levels;
+	MipGenerator::Options mipOptions;
+	const HRESULT hr = MipGenerator::generate(pixels, (unsigned int)width, (unsigned int)height, mipOptions, levels);
+	stbi_image_free(pixels);
+	if (FAILED(hr))
+		return false;
+
+	std::vector<CompressedLevel> compressed;
+	if (m_compression != BC_FORMAT_NONE && width % 4 == 0 && height % 4 == 0) {
+		BlockCompressor::Options bcOptions;
+		if (FAILED(BlockCompressor::encodeChain(levels, m_compression, bcOptions, compressed)))
+			return false;
+	}
+
+#ifdef _WIN32
+	if (m_device) {
+		entry.bytes = 0;
+		for (const CompressedLevel& level : compressed)
+			entry.bytes += level.blocks.size();
+		if (compressed.empty()) {
+			for (const MipLevel& level : levels)
+				entry.bytes += level.pixels.size();
+		}
+		entry.texture = new Texture();
+		return SUCCEEDED(compressed.empty()
+			? entry.texture->initFromMipChain(*m_device, levels)
+			: entry.texture->initFromCompressedChain(*m_device, compressed, m_compression));
+	}
+#endif
+	entry.bytes = 0;
+	for (const MipLevel& level : levels)
+		entry.bytes += level.pixels.size();
+	entry.levels.swap(levels);
+	return true;
+}
+
+Texture*
+TextureCache::getTexture(Handle handle) const {
+#ifdef _WIN32
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (handle < m_entries.size() && m_entries[handle] && m_entries[handle]->state == Entry::READY)
+		return m_entries[handle]->texture;
+#else
+	(void)handle;
+#endif
+	return nullptr;
+}
+
+const std::vector<MipLevel>*
+TextureCache::getLevels(Handle handle) const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	if (handle >= m_entries.size() || !m_entries[handle] || m_entries[handle]->state != Entry::READY ||
+		m_entries[handle]->levels.empty())
+		return nullptr;
+	return &m_entries[handle]->levels;
+}
+
+void
+TextureCache::setBudget(uint64_t budgetBytes) {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_budget = budgetBytes;
+	evictOverBudget();
+}
+
+TextureCache::Stats
+TextureCache::getStats() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
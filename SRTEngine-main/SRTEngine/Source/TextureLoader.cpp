@@ -0,0 +1,331 @@
+#include "TextureLoader.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#ifdef _WIN32
+#include "Device.h"
+#include "Texture.h"
+#endif
+
+namespace {
+	double now() {
+		return std::chrono::duration<double>(
+			std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+}
+
+// Una carga: la rellena un hilo de trabajo y la termina el hilo principal.
+struct TextureLoader::Entry {
+	std::string fileName;
+	std::atomic<int> state{ LOADING };
+	std::vector<MipLevel> levels;
+	std::vector<CompressedLevel> compressed;
+#ifdef _WIN32
+	Texture* texture = nullptr;
+#endif
+
+	uint64_t byteSize() const {
+		uint64_t bytes = 0;
+		for (const MipLevel& level : levels)
+			bytes += level.pixels.size();
+		for (const CompressedLevel& level : compressed)
+			bytes += level.blocks.size();
+		return bytes;
+	}
+
+	~Entry() {
+#ifdef _WIN32
+		if (texture) {
+			texture->destroy();
+			delete texture;
+		}
+#endif
+	}
+};
+
+TextureLoader::TextureLoader() = default;
+
+TextureLoader::~TextureLoader() {
+	destroy();
+}
+
+// Arranca los hilos de decodificación.
+HRESULT
+TextureLoader::init(unsigned int threadCount, bool generateMips, BCFormat compression) {
+	destroy();
+	m_generateMips = generateMips;
+	m_compression = compression;
+	if (threadCount == 0) {
+		const unsigned int cores = std::thread::hardware_concurrency();
+		threadCount = cores > 1 ? cores - 1 : 1;
+	}
+
+	m_stop = false;
+	m_stats = Stats();
+	for (unsigned int i = 0; i < threadCount; ++i) {
+		m_threads.emplace_back(&TextureLoader::workerLoop, this);
+	}
+	return S_OK;
+}
+
+// Detiene los hilos sin esperar a las cargas en cola.
+void
+TextureLoader::destroy() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_stop = true;
+		m_pending.clear();
+	}
+	m_wake.notify_all();
+	for (std::thread& thread : m_threads) {
+		thread.join();
+	}
+	m_threads.clear();
+
+	m_decoded.clear();
+	m_entries.clear();
+	m_busy = 0;
+	m_unfinished = 0;
+}
+
+TextureLoader::Handle
+TextureLoader::load(const std::string& fileName) {
+	if (m_threads.empty()) {
+		ERROR("TextureLoader", "load", "Loader is not initialized");
+		return INVALID_HANDLE;
+	}
+
+	std::unique_ptr<Entry> entry(new Entry());
+	entry->fileName = fileName;
+	Entry* pending = entry.get();
+	m_entries.push_back(std::move(entry));
+	++m_unfinished;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_pending.push_back(pending);
+		++m_stats.requested;
+	}
+	m_wake.notify_one();
+	return (Handle)(m_entries.size() - 1);
+}
+
+void
+TextureLoader::workerLoop() {
+	for (;;) {
+		Entry* entry;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_wake.wait(lock, [this]() { return m_stop || !m_pending.empty(); });
+			if (m_stop)
+				return;
+			entry = m_pending.front();
+			m_pending.pop_front();
+			++m_busy;
+		}
+
+		decode(*entry);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_decoded.push_back(entry);
+			--m_busy;
+		}
+		m_idle.notify_all();
+	}
+}
+
+// Lee el archivo entero, lo decodifica a RGBA8, genera los mips y los comprime (se ejecuta en un hilo de trabajo).
+void
+TextureLoader::decode(Entry& entry) {
+	const double start = now();
+
+	std::vector<unsigned char> file;
+	std::ifstream stream(entry.fileName, std::ios::binary | std::ios::ate);
+	if (stream) {
+		const std::streamoff size = stream.tellg();
+		if (size > 0 && size < INT32_MAX) {
+			file.resize((size_t)size);
+			stream.seekg(0);
+			stream.read(reinterpret_cast<char*>(file.data()), size);
+			if (!stream)
+				file.clear();
+		}
+	}
+
+	int width = 0, height = 0, channels = 0;
+	unsigned char* pixels = nullptr;
+	if (!file.empty()) {
+		pixels = stbi_load_from_memory(file.data(), (int)file.size(), &width, &height, &channels, 4);
+	}
+
+	if (!pixels) {
+		ERROR("TextureLoader", "decode",
+			("Failed to load " + entry.fileName + ": " +
+				(file.empty() ? std::string("cannot read file") : std::string(stbi_failure_reason()))).c_str());
+	}
+
+	bool decoded = pixels != nullptr;
+	if (pixels) {
+		// Un hilo por imagen: el paralelismo ya está en cargar varias a la vez.
+		MipGenerator::Options mipOptions;
+		mipOptions.maxLevels = m_generateMips ? 0 : 1;
+		mipOptions.threadCount = 1;
+		decoded = SUCCEEDED(MipGenerator::generate(pixels, (unsigned int)width, (unsigned int)height, mipOptions, entry.levels));
+		stbi_image_free(pixels);
+	}
+
+	uint64_t decodedBytes = entry.byteSize();
+	if (decoded && m_compression != BC_FORMAT_NONE && width % 4 == 0 && height % 4 == 0) {
+		BlockCompressor::Options bcOptions;
+		bcOptions.threadCount = 1;
+		decoded = SUCCEEDED(BlockCompressor::encodeChain(entry.levels, m_compression, bcOptions, entry.compressed));
+		// Solo se sube la versión comprimida.
+		std::vector<MipLevel>().swap(entry.levels);
+	}
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_stats.bytesRead += file.size();
+	m_stats.decodeSeconds += now() - start;
+	if (decoded) {
+		++m_stats.decoded;
+		m_stats.bytesDecoded += decodedBytes;
+		for (const CompressedLevel& level : entry.compressed)
+			m_stats.bytesCompressed += level.blocks.size();
+	}
+	entry.state = decoded ? DECODED : FAILED;
+}
+
+// Termina cargas decodificadas hasta gastar el presupuesto de bytes del fotograma.
+unsigned int
+TextureLoader::update(Device* device, uint64_t byteBudget) {
+	const double start = now();
+	unsigned int finalized = 0;
+	unsigned int succeeded = 0;
+	unsigned int failed = 0;
+	uint64_t spent = 0;
+	uint64_t uploaded = 0;
+
+	for (;;) {
+		Entry* entry;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_decoded.empty())
+				break;
+			entry = m_decoded.front();
+			const uint64_t bytes = entry->byteSize();
+			if (finalized > 0 && spent + bytes > byteBudget)
+				break;
+			m_decoded.pop_front();
+			spent += bytes;
+		}
+
+		--m_unfinished;
+		++finalized;
+		if (entry->state == FAILED) {
+			++failed;
+			continue;
+		}
+
+		int state = READY;
+#ifdef _WIN32
+		if (device) {
+			entry->texture = new Texture();
+			const HRESULT hr = entry->compressed.empty()
+				? entry->texture->initFromMipChain(*device, entry->levels)
+				: entry->texture->initFromCompressedChain(*device, entry->compressed, m_compression);
+			if (FAILED(hr)) {
+				ERROR("TextureLoader", "update", ("Failed to create texture for " + entry->fileName).c_str());
+				state = FAILED;
+			}
+		}
+#else
+		(void)device;
+#endif
+		if (state == FAILED) {
+			++failed;
+		}
+		else {
+			++succeeded;
+			uploaded += entry->byteSize();
+		}
+#ifdef _WIN32
+		// Con dispositivo la copia en CPU ya no hace falta.
+		if (device) {
+			std::vector<MipLevel>().swap(entry->levels);
+			std::vector<CompressedLevel>().swap(entry->compressed);
+		}
+#endif
+		entry->state = state;
+	}
+
+	const double elapsed = now() - start;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	m_stats.finalized += succeeded;
+	m_stats.failed += failed;
+	m_stats.bytesFinalized += uploaded;
+	m_stats.lastUpdateSeconds = elapsed;
+	m_stats.worstUpdateSeconds = std::max(m_stats.worstUpdateSeconds, elapsed);
+	return finalized;
+}
+
+void
+TextureLoader::waitDecoded() {
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_idle.wait(lock, [this]() { return m_pending.empty() && m_busy == 0; });
+}
+
+bool
+TextureLoader::isIdle() const {
+	return m_unfinished == 0;
+}
+
+TextureLoader::State
+TextureLoader::getState(Handle handle) const {
+	if (handle >= m_entries.size())
+		return FAILED;
+	return (State)m_entries[handle]->state.load();
+}
+
+Texture*
+TextureLoader::getTexture(Handle handle) {
+#ifdef _WIN32
+	if (handle < m_entries.size() && m_entries[handle]->state == READY)
+		return m_entries[handle]->texture;
+#else
+	(void)handle;
+#endif
+	return nullptr;
+}
+
+const unsigned char*
+TextureLoader::getPixels(Handle handle, unsigned int& width, unsigned int& height) const {
+	if (handle >= m_entries.size() || m_entries[handle]->state != READY)
+		return nullptr;
+	const Entry& entry = *m_entries[handle];
+	if (entry.levels.empty())
+		return nullptr;
+	width = entry.levels[0].width;
+	height = entry.levels[0].height;
+	return entry.levels[0].pixels.data();
+}
+
+const std::vector<MipLevel>*
+TextureLoader::getLevels(Handle handle) const {
+	if (handle >= m_entries.size() || m_entries[handle]->state != READY || m_entries[handle]->levels.empty())
+		return nullptr;
+	return &m_entries[handle]->levels;
+}
+
+const std::vector<CompressedLevel>*
+TextureLoader::getCompressedLevels(Handle handle) const {
+	if (handle >= m_entries.size() || m_entries[handle]->state != READY || m_entries[handle]->compressed.empty())
+		return nullptr;
+	return &m_entries[handle]->compressed;
+}
+
+TextureLoader::Stats
+TextureLoader::getStats() const {
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_stats;
+}
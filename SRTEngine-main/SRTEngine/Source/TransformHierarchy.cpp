@@ -0,0 +1,317 @@
+#include "TransformHierarchy.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+	// Nodos por trabajo de update(); por debajo de esto un nivel se hace en el hilo que llama.
+	const unsigned int NODE_CHUNK = 2048;
+
+	// Índice inexistente (padre de una raíz, nodo borrado).
+	const uint32_t NO_INDEX = TransformHierarchy::INVALID_NODE;
+
+	template <typename T>
+	void permute(std::vector<T>& values, const std::vector<uint32_t>& order) {
+		std::vector<T> sorted(order.size());
+		for (size_t i = 0; i < order.size(); ++i)
+			sorted[i] = values[order[i]];
+		values.swap(sorted);
+	}
+}
+
+TransformHierarchy::~TransformHierarchy() {
+	destroy();
+}
+
+// Los nodos se pueden crear también sin llamar a init(); entonces update() usa un solo hilo.
+HRESULT
+TransformHierarchy::init(JobSystem* jobs) {
+	destroy();
+	m_jobs = jobs;
+	return S_OK;
+}
+
+void
+TransformHierarchy::destroy() {
+	m_jobs = nullptr;
+	m_positions.clear();
+	m_rotations.clear();
+	m_scales.clear();
+	m_parents.clear();
+	m_depths.clear();
+	m_dirty.clear();
+	m_world.clear();
+	m_nodeAt.clear();
+	m_indexOf.clear();
+	m_freeNodes.clear();
+	m_levelStarts.clear();
+	m_needsReorder = false;
+	m_anyDirty = false;
+	m_stats = Stats();
+}
+
+// Añade el nodo al final; si es menos profundo que el último el orden se rehace en update().
+TransformHierarchy::Node
+TransformHierarchy::createNode(Node parent) {
+	if (parent != INVALID_NODE && !isValid(parent)) {
+		ERROR("TransformHierarchy", "createNode", "Invalid parent node");
+		return INVALID_NODE;
+	}
+
+	Node node;
+	if (!m_freeNodes.empty()) {
+		node = m_freeNodes.back();
+		m_freeNodes.pop_back();
+	}
+	else {
+		node = (Node)m_indexOf.size();
+		m_indexOf.push_back(NO_INDEX);
+	}
+
+	const uint32_t index = (uint32_t)m_parents.size();
+	const uint32_t parentIndex = parent == INVALID_NODE ? NO_INDEX : m_indexOf[parent];
+	const uint32_t depth = parent == INVALID_NODE ? 0 : m_depths[parentIndex] + 1;
+	m_positions.push_back(Float3(0.0f, 0.0f, 0.0f));
+	m_rotations.push_back(Float4(0.0f, 0.0f, 0.0f, 1.0f));
+	m_scales.push_back(Float3(1.0f, 1.0f, 1.0f));
+	m_parents.push_back(parentIndex);
+	m_depths.push_back(depth);
+	m_dirty.push_back(1);
+	m_world.push_back(MatrixIdentity());
+	m_nodeAt.push_back(node);
+	m_indexOf[node] = index;
+	m_anyDirty = true;
+
+	if (!m_needsReorder) {
+		if (index > 0 && depth < m_depths[index - 1]) {
+			m_needsReorder = true;
+		}
+		else if (depth + 1 == m_levelStarts.size() || m_levelStarts.empty()) {
+			// Primer nodo de un nivel nuevo: su inicio es el total anterior.
+			if (m_levelStarts.empty())
+				m_levelStarts.push_back(0);
+			m_levelStarts.push_back(index + 1);
+		}
+		else {
+			m_levelStarts.back() = index + 1;
+		}
+	}
+	return node;
+}
+
+// Marca el subárbol (los descendientes siempre van detrás) y compacta sin cambiar el orden.
+void
+TransformHierarchy::destroyNode(Node node) {
+	if (!isValid(node)) {
+		ERROR("TransformHierarchy", "destroyNode", "Invalid node");
+		return;
+	}
+	if (m_needsReorder)
+		reorder();
+
+	const uint32_t count = (uint32_t)m_parents.size();
+	const uint32_t first = m_indexOf[node];
+	std::vector<uint8_t> removed(count, 0);
+	removed[first] = 1;
+	for (uint32_t i = first + 1; i < count; ++i) {
+		if (m_parents[i] != NO_INDEX && removed[m_parents[i]])
+			removed[i] = 1;
+	}
+
+	std::vector<uint32_t> kept;
+	std::vector<uint32_t> newIndex(count, NO_INDEX);
+	kept.reserve(count);
+	for (uint32_t i = 0; i < count; ++i) {
+		if (removed[i]) {
+			m_indexOf[m_nodeAt[i]] = NO_INDEX;
+			m_freeNodes.push_back(m_nodeAt[i]);
+		}
+		else {
+			newIndex[i] = (uint32_t)kept.size();
+			kept.push_back(i);
+		}
+	}
+
+	permute(m_positions, kept);
+	permute(m_rotations, kept);
+	permute(m_scales, kept);
+	permute(m_parents, kept);
+	permute(m_depths, kept);
+	permute(m_dirty, kept);
+	permute(m_world, kept);
+	permute(m_nodeAt, kept);
+	for (uint32_t i = 0; i < (uint32_t)kept.size(); ++i) {
+		if (m_parents[i] != NO_INDEX)
+			m_parents[i] = newIndex[m_parents[i]];
+		m_indexOf[m_nodeAt[i]] = i;
+	}
+
+	m_levelStarts.clear();
+	for (uint32_t i = 0; i < (uint32_t)kept.size(); ++i) {
+		if (i == 0 || m_depths[i] != m_depths[i - 1])
+			m_levelStarts.push_back(i);
+	}
+	m_levelStarts.push_back((uint32_t)kept.size());
+}
+
+HRESULT
+TransformHierarchy::setParent(Node node, Node parent) {
+	if (!isValid(node) || (parent != INVALID_NODE && !isValid(parent))) {
+		ERROR("TransformHierarchy", "setParent", "Invalid node");
+		return E_INVALIDARG;
+	}
+	const uint32_t index = m_indexOf[node];
+	const uint32_t parentIndex = parent == INVALID_NODE ? NO_INDEX : m_indexOf[parent];
+	for (uint32_t ancestor = parentIndex; ancestor != NO_INDEX; ancestor = m_parents[ancestor]) {
+		if (ancestor == index) {
+			ERROR("TransformHierarchy", "setParent", "The new parent is a descendant of the node");
+			return E_INVALIDARG;
+		}
+	}
+	m_parents[index] = parentIndex;
+	m_needsReorder = true;
+	markDirty(index);
+	return S_OK;
+}
+
+TransformHierarchy::Node
+TransformHierarchy::getParent(Node node) const {
+	const uint32_t parentIndex = m_parents[m_indexOf[node]];
+	return parentIndex == NO_INDEX ? INVALID_NODE : m_nodeAt[parentIndex];
+}
+
+void
+TransformHierarchy::setPosition(Node node, const Float3& position) {
+	m_positions[m_indexOf[node]] = position;
+	markDirty(m_indexOf[node]);
+}
+
+void
+TransformHierarchy::setRotation(Node node, const Float4& rotation) {
+	m_rotations[m_indexOf[node]] = rotation;
+	markDirty(m_indexOf[node]);
+}
+
+void
+TransformHierarchy::setScale(Node node, const Float3& scale) {
+	m_scales[m_indexOf[node]] = scale;
+	markDirty(m_indexOf[node]);
+}
+
+void
+TransformHierarchy::setLocal(Node node, const Float3& position, const Float4& rotation, const Float3& scale) {
+	const uint32_t index = m_indexOf[node];
+	m_positions[index] = position;
+	m_rotations[index] = rotation;
+	m_scales[index] = scale;
+	markDirty(index);
+}
+
+void
+TransformHierarchy::markDirty(unsigned int index) {
+	m_dirty[index] = 1;
+	m_anyDirty = true;
+}
+
+// Recalcula las profundidades y ordena todos los arrays por profundidad (orden estable).
+void
+TransformHierarchy::reorder() {
+	const uint32_t count = (uint32_t)m_parents.size();
+	const uint32_t UNKNOWN = NO_INDEX;
+	std::fill(m_depths.begin(), m_depths.end(), UNKNOWN);
+	std::vector<uint32_t> chain;
+	uint32_t levels = 0;
+	for (uint32_t i = 0; i < count; ++i) {
+		// Sube hasta un antepasado con profundidad conocida y baja asignando.
+		uint32_t current = i;
+		while (current != NO_INDEX && m_depths[current] == UNKNOWN) {
+			chain.push_back(current);
+			current = m_parents[current];
+		}
+		uint32_t depth = current == NO_INDEX ? 0 : m_depths[current] + 1;
+		while (!chain.empty()) {
+			m_depths[chain.back()] = depth++;
+			chain.pop_back();
+		}
+		levels = std::max(levels, m_depths[i] + 1);
+	}
+
+	m_levelStarts.assign(levels + 1, 0);
+	for (uint32_t i = 0; i < count; ++i)
+		++m_levelStarts[m_depths[i] + 1];
+	for (uint32_t level = 0; level < levels; ++level)
+		m_levelStarts[level + 1] += m_levelStarts[level];
+
+	std::vector<uint32_t> order(count);
+	std::vector<uint32_t> newIndex(count);
+	std::vector<uint32_t> next(m_levelStarts.begin(), m_levelStarts.end() - 1);
+	for (uint32_t i = 0; i < count; ++i) {
+		const uint32_t position = next[m_depths[i]]++;
+		order[position] = i;
+		newIndex[i] = position;
+	}
+
+	permute(m_positions, order);
+	permute(m_rotations, order);
+	permute(m_scales, order);
+	permute(m_parents, order);
+	permute(m_depths, order);
+	permute(m_dirty, order);
+	permute(m_world, order);
+	permute(m_nodeAt, order);
+	for (uint32_t i = 0; i < count; ++i) {
+		if (m_parents[i] != NO_INDEX)
+			m_parents[i] = newIndex[m_parents[i]];
+		m_indexOf[m_nodeAt[i]] = i;
+	}
+	m_needsReorder = false;
+}
+
+// Un nivel cada vez: los padres ya tienen su matriz y su marca de sucio de este update().
+void
+TransformHierarchy::update() {
+	m_stats.reordered = m_needsReorder;
+	if (m_needsReorder)
+		reorder();
+	m_stats.nodes = getNodeCount();
+	m_stats.levels = m_levelStarts.empty() ? 0 : (unsigned int)m_levelStarts.size() - 1;
+	m_stats.updatedNodes = 0;
+	if (!m_anyDirty)
+		return;
+
+	m_updatedNodes = 0;
+	for (unsigned int level = 0; level < m_stats.levels; ++level) {
+		const unsigned int levelBegin = m_levelStarts[level];
+		const unsigned int levelEnd = m_levelStarts[level + 1];
+		if (!m_jobs) {
+			updateLevel(levelBegin, levelEnd);
+			continue;
+		}
+		m_jobs->parallelFor(levelEnd - levelBegin, NODE_CHUNK, [&](unsigned int begin, unsigned int end) {
+			updateLevel(levelBegin + begin, levelBegin + end);
+		});
+	}
+	m_stats.updatedNodes = m_updatedNodes;
+
+	std::memset(m_dirty.data(), 0, m_dirty.size());
+	m_anyDirty = false;
+}
+
+void
+TransformHierarchy::updateLevel(unsigned int begin, unsigned int end) {
+	unsigned int updated = 0;
+	for (unsigned int i = begin; i < end; ++i) {
+		const uint32_t parent = m_parents[i];
+		if (!m_dirty[i]) {
+			if (parent == NO_INDEX || !m_dirty[parent])
+				continue;
+			m_dirty[i] = 1; // Para que lo vean sus hijos en el siguiente nivel.
+		}
+		const Matrix local = MatrixScaleRotationTranslation(VectorLoad(m_scales[i]),
+			VectorLoad(m_rotations[i]), VectorLoad(m_positions[i]));
+		m_world[i] = parent == NO_INDEX ? local : MatrixMultiply(local, m_world[parent]);
+		++updated;
+	}
+	if (updated > 0)
+		m_updatedNodes += updated;
+}
@@ -0,0 +1,397 @@
+#include "VertexFormat.h"
+#include <cmath>
+#include <cstring>
+
+namespace {
+	/// Componentes float de la fuente de cada semántica.
+	const unsigned int SOURCE_COMPONENTS[SEMANTIC_COUNT] = { 3, 3, 2, 4 };
+
+	const char* const SEMANTIC_NAMES[SEMANTIC_COUNT] = { "POSITION", "NORMAL", "TEXCOORD", "COLOR" };
+
+	const unsigned int ENCODING_SIZES[ENCODING_COUNT] = { 8, 12, 16, 4, 8, 4, 8, 4, 4, 4 };
+
+#ifdef _WIN32
+	const DXGI_FORMAT ENCODING_FORMATS[ENCODING_COUNT] = {
+		DXGI_FORMAT_R32G32_FLOAT,
+		DXGI_FORMAT_R32G32B32_FLOAT,
+		DXGI_FORMAT_R32G32B32A32_FLOAT,
+		DXGI_FORMAT_R16G16_FLOAT,
+		DXGI_FORMAT_R16G16B16A16_FLOAT,
+		DXGI_FORMAT_R16G16_UNORM,
+		DXGI_FORMAT_R16G16B16A16_UNORM,
+		DXGI_FORMAT_R8G8B8A8_SNORM,
+		DXGI_FORMAT_R16G16_SNORM,
+		DXGI_FORMAT_R8G8B8A8_UNORM
+	};
+#endif
+
+	inline float
+	saturate(float value) {
+		return value < 0.0f ? 0.0f : (value > 1.0f ? 1.0f : value);
+	}
+
+	inline uint16_t
+	toUnorm16(float value) {
+		return (uint16_t)(saturate(value) * 65535.0f + 0.5f);
+	}
+
+	inline uint8_t
+	toUnorm8(float value) {
+		return (uint8_t)(saturate(value) * 255.0f + 0.5f);
+	}
+
+	inline int8_t
+	toSnorm8(float value) {
+		const float clamped = value < -1.0f ? -1.0f : (value > 1.0f ? 1.0f : value);
+		return (int8_t)lrintf(clamped * 127.0f);
+	}
+
+	/// Conversión de SNORM a float de D3D: -128 y -32768 también dan -1.
+	inline float
+	fromSnorm(int value, float maximum) {
+		const float result = value / maximum;
+		return result < -1.0f ? -1.0f : result;
+	}
+
+	inline float
+	signNotZero(float value) {
+		return value >= 0.0f ? 1.0f : -1.0f;
+	}
+
+	inline float
+	bitsToFloat(uint32_t bits) {
+		float value;
+		memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	inline uint32_t
+	floatToBits(float value) {
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+}
+
+void
+VertexFormat::clear() {
+	m_attributes.clear();
+	m_stride = 0;
+}
+
+bool
+VertexFormat::isSupported(VertexSemantic semantic, VertexEncoding encoding) {
+	switch (semantic) {
+	case SEMANTIC_POSITION:
+		return encoding == ENCODING_FLOAT3 || encoding == ENCODING_HALF4 || encoding == ENCODING_UNORM16X4;
+	case SEMANTIC_NORMAL:
+		return encoding == ENCODING_FLOAT3 || encoding == ENCODING_SNORM8X4 || encoding == ENCODING_OCT16;
+	case SEMANTIC_TEXCOORD:
+		return encoding == ENCODING_FLOAT2 || encoding == ENCODING_HALF2 || encoding == ENCODING_UNORM16X2;
+	case SEMANTIC_COLOR:
+		return encoding == ENCODING_FLOAT4 || encoding == ENCODING_HALF4 || encoding == ENCODING_UNORM8X4;
+	default:
+		return false;
+	}
+}
+
+unsigned int
+VertexFormat::encodingSize(VertexEncoding encoding) {
+	return encoding < ENCODING_COUNT ? ENCODING_SIZES[encoding] : 0;
+}
+
+HRESULT
+VertexFormat::add(VertexSemantic semantic, VertexEncoding encoding) {
+	if (!isSupported(semantic, encoding)) {
+		ERROR("VertexFormat", "add", "Encoding not supported for this semantic");
+		return E_INVALIDARG;
+	}
+	if (find(semantic)) {
+		ERROR("VertexFormat", "add", "Semantic already in the format");
+		return E_INVALIDARG;
+	}
+	m_attributes.push_back({ semantic, encoding, m_stride });
+	m_stride += ENCODING_SIZES[encoding];
+	return S_OK;
+}
+
+const VertexFormat::Attribute*
+VertexFormat::find(VertexSemantic semantic) const {
+	for (const Attribute& attribute : m_attributes) {
+		if (attribute.semantic == semantic)
+			return &attribute;
+	}
+	return nullptr;
+}
+
+// Un eje sin extensión se deja con escala 1 para que la matriz de decodificación sea invertible.
+void
+VertexFormat::setBounds(const Float3& boundsMin, const Float3& boundsMax) {
+	m_boundsMin = boundsMin;
+	m_boundsMax = Float3(boundsMax.x > boundsMin.x ? boundsMax.x : boundsMin.x + 1.0f,
+		boundsMax.y > boundsMin.y ? boundsMax.y : boundsMin.y + 1.0f,
+		boundsMax.z > boundsMin.z ? boundsMax.z : boundsMin.z + 1.0f);
+}
+
+Matrix
+VertexFormat::getPositionDecodeMatrix() const {
+	const Attribute* position = find(SEMANTIC_POSITION);
+	if (!position || position->encoding != ENCODING_UNORM16X4)
+		return MatrixIdentity();
+	return MatrixMultiply(MatrixScaling(m_boundsMax.x - m_boundsMin.x, m_boundsMax.y - m_boundsMin.y, m_boundsMax.z - m_boundsMin.z),
+		MatrixTranslation(m_boundsMin.x, m_boundsMin.y, m_boundsMin.z));
+}
+
+HRESULT
+VertexFormat::encode(const Source& source, size_t count, void* destination) const {
+	for (const Attribute& attribute : m_attributes) {
+		if (!source.streams[attribute.semantic].data) {
+			ERROR("VertexFormat", "encode", "Missing source stream for an attribute");
+			return E_INVALIDARG;
+		}
+		// UNORM16X2 no repite: una UV fuera de [0, 1] se recortaría al borde sin avisar.
+		if (attribute.encoding == ENCODING_UNORM16X2) {
+			const VertexStream& stream = source.streams[attribute.semantic];
+			const uint8_t* input = (const uint8_t*)stream.data;
+			for (size_t i = 0; i < count; ++i, input += stream.stride) {
+				float v[2];
+				memcpy(v, input, sizeof(v));
+				if (!(v[0] >= 0.0f && v[0] <= 1.0f && v[1] >= 0.0f && v[1] <= 1.0f)) {
+					ERROR("VertexFormat", "encode", "Texture coordinate outside [0, 1] with ENCODING_UNORM16X2");
+					return E_INVALIDARG;
+				}
+			}
+		}
+	}
+
+	const Float3 extent(m_boundsMax.x - m_boundsMin.x, m_boundsMax.y - m_boundsMin.y, m_boundsMax.z - m_boundsMin.z);
+	for (const Attribute& attribute : m_attributes) {
+		const VertexStream& stream = source.streams[attribute.semantic];
+		const unsigned int components = SOURCE_COMPONENTS[attribute.semantic];
+		const uint8_t* input = (const uint8_t*)stream.data;
+		uint8_t* output = (uint8_t*)destination + attribute.offset;
+		for (size_t i = 0; i < count; ++i, input += stream.stride, output += m_stride) {
+			float v[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+			memcpy(v, input, components * sizeof(float));
+			switch (attribute.encoding) {
+			case ENCODING_FLOAT2:
+			case ENCODING_FLOAT3:
+			case ENCODING_FLOAT4:
+				memcpy(output, v, ENCODING_SIZES[attribute.encoding]);
+				break;
+			case ENCODING_HALF2:
+			case ENCODING_HALF4: {
+				uint16_t h[4];
+				for (unsigned int c = 0; c < 4; ++c)
+					h[c] = floatToHalf(v[c]);
+				memcpy(output, h, ENCODING_SIZES[attribute.encoding]);
+				break;
+			}
+			case ENCODING_UNORM16X2: {
+				const uint16_t q[2] = { toUnorm16(v[0]), toUnorm16(v[1]) };
+				memcpy(output, q, sizeof(q));
+				break;
+			}
+			case ENCODING_UNORM16X4: {
+				const uint16_t q[4] = { toUnorm16((v[0] - m_boundsMin.x) / extent.x),
+					toUnorm16((v[1] - m_boundsMin.y) / extent.y), toUnorm16((v[2] - m_boundsMin.z) / extent.z), 65535 };
+				memcpy(output, q, sizeof(q));
+				break;
+			}
+			case ENCODING_SNORM8X4: {
+				const int8_t q[4] = { toSnorm8(v[0]), toSnorm8(v[1]), toSnorm8(v[2]), 0 };
+				memcpy(output, q, sizeof(q));
+				break;
+			}
+			case ENCODING_OCT16: {
+				int16_t q[2];
+				encodeOctahedral(Float3(v[0], v[1], v[2]), q);
+				memcpy(output, q, sizeof(q));
+				break;
+			}
+			case ENCODING_UNORM8X4: {
+				const uint8_t q[4] = { toUnorm8(v[0]), toUnorm8(v[1]), toUnorm8(v[2]), toUnorm8(v[3]) };
+				memcpy(output, q, sizeof(q));
+				break;
+			}
+			default:
+				break;
+			}
+		}
+	}
+	return S_OK;
+}
+
+HRESULT
+VertexFormat::decode(const void* vertices, size_t count, VertexSemantic semantic, Float4* destination,
+	bool meshSpace) const {
+	const Attribute* attribute = find(semantic);
+	if (!attribute) {
+		ERROR("VertexFormat", "decode", "Semantic not in the format");
+		return E_INVALIDARG;
+	}
+
+	const Float3 extent = meshSpace ?
+		Float3(m_boundsMax.x - m_boundsMin.x, m_boundsMax.y - m_boundsMin.y, m_boundsMax.z - m_boundsMin.z) :
+		Float3(1.0f, 1.0f, 1.0f);
+	const Float3 origin = meshSpace ? m_boundsMin : Float3(0.0f, 0.0f, 0.0f);
+	const float w = semantic == SEMANTIC_POSITION ? 1.0f : 0.0f; // Lo que pone D3D11 si faltan componentes.
+	const uint8_t* input = (const uint8_t*)vertices + attribute->offset;
+	for (size_t i = 0; i < count; ++i, input += m_stride) {
+		Float4& out = destination[i];
+		switch (attribute->encoding) {
+		case ENCODING_FLOAT2:
+		case ENCODING_FLOAT3:
+		case ENCODING_FLOAT4: {
+			float v[4] = { 0.0f, 0.0f, 0.0f, w };
+			memcpy(v, input, ENCODING_SIZES[attribute->encoding]);
+			out = Float4(v[0], v[1], v[2], v[3]);
+			break;
+		}
+		case ENCODING_HALF2:
+		case ENCODING_HALF4: {
+			uint16_t h[4] = { 0, 0, 0, floatToHalf(w) };
+			memcpy(h, input, ENCODING_SIZES[attribute->encoding]);
+			out = Float4(halfToFloat(h[0]), halfToFloat(h[1]), halfToFloat(h[2]), halfToFloat(h[3]));
+			break;
+		}
+		case ENCODING_UNORM16X2: {
+			uint16_t q[2];
+			memcpy(q, input, sizeof(q));
+			out = Float4(q[0] / 65535.0f, q[1] / 65535.0f, 0.0f, w);
+			break;
+		}
+		case ENCODING_UNORM16X4: {
+			uint16_t q[4];
+			memcpy(q, input, sizeof(q));
+			out = Float4(origin.x + q[0] / 65535.0f * extent.x, origin.y + q[1] / 65535.0f * extent.y,
+				origin.z + q[2] / 65535.0f * extent.z, q[3] / 65535.0f);
+			break;
+		}
+		case ENCODING_SNORM8X4: {
+			int8_t q[4];
+			memcpy(q, input, sizeof(q));
+			out = Float4(fromSnorm(q[0], 127.0f), fromSnorm(q[1], 127.0f), fromSnorm(q[2], 127.0f), fromSnorm(q[3], 127.0f));
+			break;
+		}
+		case ENCODING_OCT16: {
+			int16_t q[2];
+			memcpy(q, input, sizeof(q));
+			const Float3 n = decodeOctahedral(q);
+			out = Float4(n.x, n.y, n.z, 0.0f);
+			break;
+		}
+		case ENCODING_UNORM8X4:
+			out = Float4(input[0] / 255.0f, input[1] / 255.0f, input[2] / 255.0f, input[3] / 255.0f);
+			break;
+		default:
+			break;
+		}
+	}
+	return S_OK;
+}
+
+#ifdef _WIN32
+void
+VertexFormat::getInputElements(std::vector<D3D11_INPUT_ELEMENT_DESC>& elements, unsigned int inputSlot) const {
+	for (const Attribute& attribute : m_attributes) {
+		D3D11_INPUT_ELEMENT_DESC element = {};
+		element.SemanticName = SEMANTIC_NAMES[attribute.semantic];
+		element.SemanticIndex = 0;
+		element.Format = ENCODING_FORMATS[attribute.encoding];
+		element.InputSlot = inputSlot;
+		element.AlignedByteOffset = attribute.offset;
+		element.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
+		element.InstanceDataStepRate = 0;
+		elements.push_back(element);
+	}
+}
+#endif
+
+// Conversión por sumas en coma flotante (redondea como la FPU, al par más cercano).
+uint16_t
+VertexFormat::floatToHalf(float value) {
+	uint32_t bits = floatToBits(value);
+	const uint32_t sign = bits & 0x80000000u;
+	bits ^= sign;
+
+	uint32_t result;
+	if (bits >= (127u + 16u) << 23) {
+		result = bits > 0x7f800000u ? 0x7e00u : 0x7c00u; // NaN o infinito (también lo que desborda).
+	}
+	else if (bits < 113u << 23) {
+		// Subnormal en half: la suma alinea la mantisa y redondea.
+		const uint32_t magic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+		result = floatToBits(bitsToFloat(bits) + bitsToFloat(magic)) - magic;
+	}
+	else {
+		const uint32_t mantissaOdd = (bits >> 13) & 1u;
+		bits += ((uint32_t)(15 - 127) << 23) + 0xfffu + mantissaOdd;
+		result = bits >> 13;
+	}
+	return (uint16_t)(result | (sign >> 16));
+}
+
+float
+VertexFormat::halfToFloat(uint16_t value) {
+	const uint32_t shiftedExponent = 0x7c00u << 13;
+	uint32_t bits = (uint32_t)(value & 0x7fffu) << 13;
+	const uint32_t exponent = bits & shiftedExponent;
+	bits += (127u - 15u) << 23;
+	if (exponent == shiftedExponent) {
+		bits += (128u - 16u) << 23; // Infinito o NaN.
+	}
+	else if (exponent == 0) {
+		bits += 1u << 23; // Subnormal: se normaliza restando el implícito.
+		bits = floatToBits(bitsToFloat(bits) - bitsToFloat(113u << 23));
+	}
+	return bitsToFloat(bits | ((uint32_t)(value & 0x8000u) << 16));
+}
+
+// De los cuatro redondeos de (x, y) se queda el que decodifica más cerca de la normal.
+void
+VertexFormat::encodeOctahedral(const Float3& normal, int16_t encoded[2]) {
+	const float length = fabsf(normal.x) + fabsf(normal.y) + fabsf(normal.z);
+	if (length <= 0.0f) {
+		encoded[0] = encoded[1] = 0;
+		return;
+	}
+	float x = normal.x / length, y = normal.y / length;
+	if (normal.z < 0.0f) {
+		const float foldedX = (1.0f - fabsf(y)) * signNotZero(x);
+		y = (1.0f - fabsf(x)) * signNotZero(y);
+		x = foldedX;
+	}
+
+	const float unit = 1.0f / sqrtf(normal.x * normal.x + normal.y * normal.y + normal.z * normal.z);
+	const Float3 target(normal.x * unit, normal.y * unit, normal.z * unit);
+	const float baseX = floorf(x * 32767.0f), baseY = floorf(y * 32767.0f);
+	float bestDot = -2.0f;
+	for (int dy = 0; dy < 2; ++dy) {
+		for (int dx = 0; dx < 2; ++dx) {
+			const int16_t candidate[2] = {
+				(int16_t)fminf(fmaxf(baseX + dx, -32767.0f), 32767.0f),
+				(int16_t)fminf(fmaxf(baseY + dy, -32767.0f), 32767.0f)
+			};
+			const Float3 decoded = decodeOctahedral(candidate);
+			const float d = decoded.x * target.x + decoded.y * target.y + decoded.z * target.z;
+			if (d > bestDot) {
+				bestDot = d;
+				encoded[0] = candidate[0];
+				encoded[1] = candidate[1];
+			}
+		}
+	}
+}
+
+// Mismas operaciones que la decodificación en HLSL de la descripción de la clase.
+Float3
+VertexFormat::decodeOctahedral(const int16_t encoded[2]) {
+	float x = fromSnorm(encoded[0], 32767.0f), y = fromSnorm(encoded[1], 32767.0f);
+	const float z = 1.0f - fabsf(x) - fabsf(y);
+	const float t = z < 0.0f ? -z : 0.0f;
+	x += x >= 0.0f ? -t : t;
+	y += y >= 0.0f ? -t : t;
+	const float length = sqrtf(x * x + y * y + z * z);
+	return Float3(x / length, y / length, z / length);
+}
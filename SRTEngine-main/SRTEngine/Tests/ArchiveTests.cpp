@@ -0,0 +1,190 @@
+#include "ArchiveWriter.h"
+#include "AssetArchive.h"
+#include "LZ4Codec.h"
+#include "TestCommon.h"
+#include <cstring>
+#include <fstream>
+
+// LZ4Codec (ida y vuelta de datos de todo tipo y bloques corruptos) y el ciclo completo del
+// archivo de recursos: ArchiveWriter escribe, AssetArchive proyecta y se leen las entradas
+// comprimidas y las guardadas tal cual, además de las búsquedas en la tabla con muchas
+// entradas y los nombres que no existen.
+
+namespace {
+
+	std::vector<uint8_t> randomBytes(size_t size, uint32_t seed) {
+		std::vector<uint8_t> bytes(size);
+		for (uint8_t& byte : bytes) {
+			seed = seed * 1664525u + 1013904223u;
+			byte = (uint8_t)(seed >> 24);
+		}
+		return bytes;
+	}
+
+	// Texto con mucha repetición, como un shader o un .obj.
+	std::vector<uint8_t> textBytes(size_t size) {
+		const char* words[] = { "float4 ", "position", " = mul(", "world, ", "input);\n", "v 0.5 1.0 -2.0\n" };
+		std::vector<uint8_t> bytes;
+		for (size_t i = 0; bytes.size() < size; ++i) {
+			const char* word = words[(i * 7 + i / 5) % 6];
+			bytes.insert(bytes.end(), word, word + strlen(word));
+		}
+		bytes.resize(size);
+		return bytes;
+	}
+
+	bool roundTrip(const std::vector<uint8_t>& data) {
+		std::vector<uint8_t> compressed;
+		LZ4Codec::compress(data.data(), data.size(), compressed);
+		if (compressed.size() > LZ4Codec::compressBound(data.size()))
+			return false;
+		std::vector<uint8_t> output(data.size() + 1, 0xCD);
+		if (!LZ4Codec::decompress(compressed.data(), compressed.size(), output.data(), data.size()))
+			return false;
+		// Ni un byte de más.
+		return output[data.size()] == 0xCD && std::equal(data.begin(), data.end(), output.begin());
+	}
+
+	void testLZ4() {
+		CHECK(roundTrip({}));
+		CHECK(roundTrip({ 42 }));
+		CHECK(roundTrip(randomBytes(13, 1)));
+		CHECK(roundTrip(randomBytes(100000, 2)));
+		CHECK(roundTrip(textBytes(100000)));
+		// Literales y coincidencias de más de 15 + 255 bytes (longitudes con varios bytes extra).
+		std::vector<uint8_t> runs = randomBytes(1000, 3);
+		runs.insert(runs.end(), 5000, 7);
+		const std::vector<uint8_t> tail = randomBytes(70000, 4);
+		runs.insert(runs.end(), tail.begin(), tail.end());
+		runs.insert(runs.end(), runs.begin(), runs.begin() + 20000);
+		CHECK(roundTrip(runs));
+
+		std::vector<uint8_t> compressed;
+		const std::vector<uint8_t> text = textBytes(65536);
+		LZ4Codec::compress(text.data(), text.size(), compressed);
+		CHECK(compressed.size() < text.size() / 4);
+
+		// Los bloques corruptos se rechazan sin escribir fuera del búfer.
+		std::vector<uint8_t> output(text.size());
+		CHECK(!LZ4Codec::decompress(compressed.data(), compressed.size() - 1, output.data(), output.size()));
+		CHECK(!LZ4Codec::decompress(compressed.data(), compressed.size(), output.data(), output.size() - 1));
+		CHECK(!LZ4Codec::decompress(compressed.data(), compressed.size(), output.data(), output.size() + 1));
+		// Basura: basta con que no se salga del búfer (se nota con AddressSanitizer).
+		for (size_t i = 0; i < 64; ++i) {
+			std::vector<uint8_t> garbage = randomBytes(256, 100 + (uint32_t)i);
+			LZ4Codec::decompress(garbage.data(), garbage.size(), output.data(), output.size());
+		}
+	}
+
+	void testArchive() {
+		const std::vector<uint8_t> text = textBytes(50000);
+		const std::vector<uint8_t> noise = randomBytes(30000, 5);
+		const std::vector<uint8_t> loose = textBytes(777);
+		{
+			std::ofstream out("ArchiveTests_loose.txt", std::ios::binary);
+			out.write((const char*)loose.data(), loose.size());
+		}
+
+		ArchiveWriter writer;
+		writer.addMemory("Shaders\\Text.fx", text.data(), text.size(), true);
+		writer.addMemory("Textures/Noise.dds", noise.data(), noise.size(), true);
+		writer.addMemory("Stored.fx", text.data(), text.size(), false);
+		writer.addMemory("Empty", nullptr, 0, true);
+		writer.addFile("Models/Loose.obj", "ArchiveTests_loose.txt", true);
+		CHECK(SUCCEEDED(writer.write("ArchiveTests.pak")));
+
+		AssetArchive archive;
+		CHECK(SUCCEEDED(archive.open("ArchiveTests.pak")));
+		CHECK(archive.getEntryCount() == 5);
+
+		// Comprimida: no hay vista sin copia, read() descomprime.
+		std::vector<uint8_t> data;
+		size_t size = 0;
+		CHECK(archive.contains("Shaders/Text.fx") && archive.contains("Shaders\\Text.fx"));
+		CHECK(archive.view("Shaders/Text.fx", size) == nullptr);
+		CHECK(SUCCEEDED(archive.read("Shaders/Text.fx", data)) && data == text);
+		CHECK(SUCCEEDED(archive.read("Models\\Loose.obj", data)) && data == loose);
+
+		// El ruido no gana un 10 % al comprimirlo y se guarda tal cual, alineado.
+		const uint8_t* view = archive.view("Textures/Noise.dds", size);
+		CHECK(view && size == noise.size() && memcmp(view, noise.data(), size) == 0);
+		CHECK(view && (uintptr_t)view % AssetArchive::ALIGNMENT == 0);
+		CHECK(SUCCEEDED(archive.read("Textures/Noise.dds", data)) && data == noise);
+		view = archive.view("Stored.fx", size);
+		CHECK(view && size == text.size() && memcmp(view, text.data(), size) == 0);
+		CHECK(SUCCEEDED(archive.read("Empty", data)) && data.empty());
+
+		// Nombres que no están.
+		CHECK(!archive.contains("Missing.fx") && !archive.contains("shaders/text.fx") && !archive.contains(""));
+		CHECK(archive.view("Missing.fx", size) == nullptr);
+		data.assign(3, 1);
+		CHECK(archive.read("Missing.fx", data) == E_FAIL);
+		archive.close();
+		CHECK(!archive.isOpen() && !archive.contains("Stored.fx"));
+
+		// Los nombres repetidos (con cualquier separador) no se escriben.
+		writer.addMemory("Shaders/Text.fx", loose.data(), loose.size(), false);
+		CHECK(writer.write("ArchiveTests_duplicate.pak") == E_FAIL);
+		writer.clear();
+		writer.addFile("Gone", "ArchiveTests_missing.txt", false);
+		CHECK(writer.write("ArchiveTests_duplicate.pak") == E_FAIL);
+
+		std::remove("ArchiveTests.pak");
+		std::remove("ArchiveTests_duplicate.pak");
+		std::remove("ArchiveTests_loose.txt");
+	}
+
+	// Con muchas entradas, cada búsqueda binaria por hash encuentra la suya.
+	void testLookups() {
+		const unsigned int count = 2000;
+		ArchiveWriter writer;
+		for (unsigned int i = 0; i < count; ++i) {
+			const std::string name = "Assets/" + std::to_string(i % 37) + "/File" + std::to_string(i) + ".bin";
+			const uint32_t value = i * 2654435761u;
+			writer.addMemory(name, (const uint8_t*)&value, sizeof(value), i % 2 == 0);
+		}
+		CHECK(SUCCEEDED(writer.write("ArchiveTests_lookups.pak")));
+
+		AssetArchive archive;
+		CHECK(SUCCEEDED(archive.open("ArchiveTests_lookups.pak")));
+		CHECK(archive.getEntryCount() == count);
+		unsigned int found = 0;
+		std::vector<uint8_t> data;
+		for (unsigned int i = 0; i < count; ++i) {
+			const std::string name = "Assets/" + std::to_string(i % 37) + "/File" + std::to_string(i) + ".bin";
+			uint32_t value = 0;
+			if (SUCCEEDED(archive.read(name, data)) && data.size() == sizeof(value)) {
+				memcpy(&value, data.data(), sizeof(value));
+				found += value == i * 2654435761u;
+			}
+		}
+		CHECK(found == count);
+		CHECK(!archive.contains("Assets/0/File1.bin") && !archive.contains("Assets/0/File2000.bin"));
+		archive.close();
+
+		// Un archivo que no es .pak, uno truncado y uno que no existe.
+		std::ifstream in("ArchiveTests_lookups.pak", std::ios::binary);
+		std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+		in.close();
+		{
+			std::ofstream out("ArchiveTests_lookups.pak", std::ios::binary | std::ios::trunc);
+			out.write(bytes.data(), bytes.size() / 2);
+		}
+		CHECK(archive.open("ArchiveTests_lookups.pak") == E_FAIL && !archive.isOpen());
+		{
+			std::ofstream out("ArchiveTests_lookups.pak", std::ios::binary | std::ios::trunc);
+			out.write("DDS not a pak file at all, just some bytes", 40);
+		}
+		CHECK(archive.open("ArchiveTests_lookups.pak") == E_FAIL);
+		CHECK(archive.open("ArchiveTests_missing.pak") == E_FAIL);
+		std::remove("ArchiveTests_lookups.pak");
+	}
+}
+
+int
+main() {
+	testLZ4();
+	testArchive();
+	testLookups();
+	return testResult("ArchiveTests");
+}
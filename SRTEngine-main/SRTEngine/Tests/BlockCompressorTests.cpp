@@ -0,0 +1,244 @@
+#include "BlockCompressor.h"
+#include "TestCommon.h"
+#include <cstring>
+
+// BlockCompressor: PSNR de codificar y decodificar una imagen de prueba en cada formato y
+// calidad por encima de un mínimo (y sin empeorar al subir la calidad), los bloques de un
+// color casi sin pérdida, el camino SIMD y el escalar (y uno o varios hilos) con los mismos
+// bytes, y cadenas de mips con niveles que no son múltiplo de 4 hasta 1x1.
+
+namespace {
+
+	const unsigned int SIZE = 64;
+
+	// Degradados suaves, algo de ruido, bordes duros y un alfa que va de 0 a 255 (o opaca: en
+	// BC1 los píxeles con alfa < 128 pasan a negro transparente y el PSNR del color no diría nada).
+	std::vector<uint8_t> makeImage(unsigned int width, unsigned int height, unsigned int seed, bool opaque = false) {
+		std::vector<uint8_t> pixels((size_t)width * height * 4);
+		uint32_t random = seed;
+		for (unsigned int y = 0; y < height; ++y) {
+			for (unsigned int x = 0; x < width; ++x) {
+				uint8_t* p = &pixels[((size_t)y * width + x) * 4];
+				random = random * 1664525u + 1013904223u;
+				const int noise = (int)((random >> 24) % 9) - 4;
+				const bool stripe = (x / 8 + y / 16) % 3 == 0;
+				p[0] = (uint8_t)std::min(255, std::max(0, (int)(x * 255 / std::max(1u, width - 1)) + noise));
+				p[1] = (uint8_t)std::min(255, std::max(0, (int)(y * 200 / std::max(1u, height - 1)) + 30 - noise));
+				p[2] = (uint8_t)(stripe ? 220 : 40 + (x + y) % 32);
+				p[3] = opaque ? 255 : (uint8_t)((x + y) * 255 / std::max(1u, width + height - 2));
+			}
+		}
+		return pixels;
+	}
+
+	// Canales que guarda cada formato para el PSNR.
+	unsigned int channelMask(BCFormat format) {
+		switch (format) {
+		case BC_FORMAT_BC1: return 0x7;
+		case BC_FORMAT_BC4: return 0x1;
+		case BC_FORMAT_BC5: return 0x3;
+		default: return 0xF;
+		}
+	}
+
+	double roundTrip(const std::vector<uint8_t>& image, unsigned int width, unsigned int height,
+		BCFormat format, const BlockCompressor::Options& options) {
+		std::vector<uint8_t> blocks, decoded;
+		CHECK(SUCCEEDED(BlockCompressor::encode(image.data(), width, height, format, options, blocks)));
+		CHECK(blocks.size() == BlockCompressor::compressedSize(format, width, height));
+		CHECK(SUCCEEDED(BlockCompressor::decode(blocks.data(), width, height, format, decoded)));
+		return BlockCompressor::psnr(image.data(), decoded.data(), (size_t)width * height, channelMask(format));
+	}
+
+	// Mínimos en dB con las imágenes de makeImage(), unos 2 dB por debajo de lo que dan hoy:
+	// BC4 y BC5 guardan un canal por mitad de bloque y son los que menos pierden.
+	void testQuality() {
+		struct Expected {
+			BCFormat format;
+			double minimum[3]; // FAST, NORMAL, SLOW
+		};
+		const Expected expected[] = {
+			{ BC_FORMAT_BC1, { 36.0, 36.0, 36.5 } },
+			{ BC_FORMAT_BC3, { 37.5, 37.5, 38.0 } },
+			{ BC_FORMAT_BC4, { 49.0, 49.0, 50.0 } },
+			{ BC_FORMAT_BC5, { 49.0, 49.0, 50.0 } },
+			{ BC_FORMAT_BC7, { 38.0, 38.0, 38.0 } },
+		};
+		const std::vector<uint8_t> image = makeImage(SIZE, SIZE, 5);
+		const std::vector<uint8_t> opaque = makeImage(SIZE, SIZE, 5, true);
+		for (const Expected& e : expected) {
+			double previous = 0.0;
+			for (int quality = BC_QUALITY_FAST; quality <= BC_QUALITY_SLOW; ++quality) {
+				BlockCompressor::Options options;
+				options.quality = (BCQuality)quality;
+				const double psnr = roundTrip(e.format == BC_FORMAT_BC1 ? opaque : image, SIZE, SIZE, e.format, options);
+				CHECK(psnr >= e.minimum[quality]);
+				CHECK(psnr >= previous - 0.05);
+				if (psnr < e.minimum[quality] || psnr < previous - 0.05)
+					fprintf(stderr, "    format %d quality %d: %.2f dB\n", (int)e.format, quality, psnr);
+				previous = psnr;
+			}
+		}
+	}
+
+	// Un color por bloque: BC4/BC5 lo reproducen exacto, y BC7 (extremos de 7 bits más el bit p)
+	// y BC1 (565) casi.
+	void testSolidBlocks() {
+		std::vector<uint8_t> image((size_t)16 * 16 * 4);
+		for (unsigned int i = 0; i < 16 * 16; ++i) {
+			const unsigned int block = (i % 16) / 4 + (i / 16) / 4 * 4;
+			image[i * 4 + 0] = (uint8_t)(block * 17);
+			image[i * 4 + 1] = (uint8_t)(255 - block * 13);
+			image[i * 4 + 2] = (uint8_t)(block * 7 + 3);
+			image[i * 4 + 3] = 255;
+		}
+		BlockCompressor::Options options;
+		CHECK(roundTrip(image, 16, 16, BC_FORMAT_BC7, options) >= 50.0);
+		CHECK(roundTrip(image, 16, 16, BC_FORMAT_BC4, options) == 100.0);
+		CHECK(roundTrip(image, 16, 16, BC_FORMAT_BC5, options) == 100.0);
+		CHECK(roundTrip(image, 16, 16, BC_FORMAT_BC1, options) >= 40.0);
+
+		// BC4 y BC5 se decodifican como la GPU: (R, 0, 0, 255) y (R, G, 0, 255).
+		std::vector<uint8_t> blocks, decoded;
+		CHECK(SUCCEEDED(BlockCompressor::encode(image.data(), 16, 16, BC_FORMAT_BC4, options, blocks)));
+		CHECK(SUCCEEDED(BlockCompressor::decode(blocks.data(), 16, 16, BC_FORMAT_BC4, decoded)));
+		CHECK(decoded[4 * 5 + 1] == 0 && decoded[4 * 5 + 2] == 0 && decoded[4 * 5 + 3] == 255);
+		CHECK(SUCCEEDED(BlockCompressor::encode(image.data(), 16, 16, BC_FORMAT_BC5, options, blocks)));
+		CHECK(SUCCEEDED(BlockCompressor::decode(blocks.data(), 16, 16, BC_FORMAT_BC5, decoded)));
+		CHECK(decoded[4 * 5 + 1] == image[4 * 5 + 1] && decoded[4 * 5 + 2] == 0 && decoded[4 * 5 + 3] == 255);
+	}
+
+	// SSE2/AVX2 contra escalar, y 1 contra 3 hilos: mismos bytes en todos los formatos y calidades.
+	void testSimdMatchesScalar() {
+		const unsigned int width = 40, height = 28;
+		const std::vector<uint8_t> image = makeImage(width, height, 11);
+		for (BCFormat format : { BC_FORMAT_BC1, BC_FORMAT_BC3, BC_FORMAT_BC4, BC_FORMAT_BC5, BC_FORMAT_BC7 }) {
+			for (int quality = BC_QUALITY_FAST; quality <= BC_QUALITY_SLOW; ++quality) {
+				BlockCompressor::Options scalar;
+				scalar.quality = (BCQuality)quality;
+				scalar.useSimd = false;
+				BlockCompressor::Options simd = scalar;
+				simd.useSimd = true;
+				simd.threadCount = 3;
+				std::vector<uint8_t> a, b;
+				CHECK(SUCCEEDED(BlockCompressor::encode(image.data(), width, height, format, scalar, a)));
+				CHECK(SUCCEEDED(BlockCompressor::encode(image.data(), width, height, format, simd, b)));
+				CHECK(a == b);
+			}
+		}
+	}
+
+	// Imagen con los bordes repetidos hasta el siguiente múltiplo de 4.
+	std::vector<uint8_t> padded(const std::vector<uint8_t>& pixels, unsigned int width, unsigned int height) {
+		const unsigned int paddedWidth = (width + 3) / 4 * 4, paddedHeight = (height + 3) / 4 * 4;
+		std::vector<uint8_t> out((size_t)paddedWidth * paddedHeight * 4);
+		for (unsigned int y = 0; y < paddedHeight; ++y)
+			for (unsigned int x = 0; x < paddedWidth; ++x)
+				memcpy(&out[((size_t)y * paddedWidth + x) * 4],
+					&pixels[((size_t)std::min(y, height - 1) * width + std::min(x, width - 1)) * 4], 4);
+		return out;
+	}
+
+	// Cadena de point sampling desde width x height hasta 1x1.
+	std::vector<MipLevel> makeChain(unsigned int width, unsigned int height, unsigned int seed) {
+		std::vector<MipLevel> levels(1);
+		levels[0].width = width;
+		levels[0].height = height;
+		levels[0].pixels = makeImage(width, height, seed);
+		while (levels.back().width > 1 || levels.back().height > 1) {
+			const MipLevel& last = levels.back();
+			MipLevel next;
+			next.width = std::max(1u, last.width / 2);
+			next.height = std::max(1u, last.height / 2);
+			for (unsigned int y = 0; y < next.height; ++y)
+				for (unsigned int x = 0; x < next.width; ++x)
+					for (int c = 0; c < 4; ++c)
+						next.pixels.push_back(last.pixels[((size_t)(2 * y) * last.width + 2 * x) * 4 + c]);
+			levels.push_back(next);
+		}
+		return levels;
+	}
+
+	// Cadenas de 13x7 (6x3, 3x1, 1x1) y 10x10 (5x5, 2x2, 1x1) por encodeChain: cada nivel
+	// incompleto se codifica igual que la imagen con los bordes repetidos a mano, y al
+	// decodificar solo se escriben los píxeles que hay (los mismos que en el recorte de la
+	// imagen rellenada). El nivel 1x1 es un bloque de un color y sale casi exacto; en BC1 no
+	// se mira porque el píxel puede ser transparente.
+	void testEdgeLevels() {
+		for (const std::vector<MipLevel>& levels : { makeChain(13, 7, 3), makeChain(10, 10, 4) }) {
+			CHECK(levels.size() == 4);
+			for (BCFormat format : { BC_FORMAT_BC1, BC_FORMAT_BC3, BC_FORMAT_BC4, BC_FORMAT_BC5, BC_FORMAT_BC7 }) {
+				std::vector<CompressedLevel> compressed;
+				BlockCompressor::Options options;
+				CHECK(SUCCEEDED(BlockCompressor::encodeChain(levels, format, options, compressed)));
+				CHECK(compressed.size() == levels.size());
+				for (size_t i = 0; i < compressed.size(); ++i) {
+					const MipLevel& source = levels[i];
+					const CompressedLevel& level = compressed[i];
+					CHECK(level.width == source.width && level.height == source.height);
+					CHECK(level.blocks.size() == BlockCompressor::compressedSize(format, level.width, level.height));
+
+					const unsigned int paddedWidth = (source.width + 3) / 4 * 4, paddedHeight = (source.height + 3) / 4 * 4;
+					const std::vector<uint8_t> full = padded(source.pixels, source.width, source.height);
+					std::vector<uint8_t> fullBlocks, fullDecoded, decoded;
+					CHECK(SUCCEEDED(BlockCompressor::encode(full.data(), paddedWidth, paddedHeight, format, options, fullBlocks)));
+					CHECK(fullBlocks == level.blocks);
+					CHECK(SUCCEEDED(BlockCompressor::decode(level.blocks.data(), level.width, level.height, format, decoded)));
+					CHECK(SUCCEEDED(BlockCompressor::decode(fullBlocks.data(), paddedWidth, paddedHeight, format, fullDecoded)));
+					CHECK(decoded.size() == source.pixels.size());
+					bool cropMatches = true;
+					for (unsigned int y = 0; y < level.height; ++y)
+						cropMatches = cropMatches && memcmp(&decoded[(size_t)y * level.width * 4],
+							&fullDecoded[(size_t)y * paddedWidth * 4], level.width * 4) == 0;
+					CHECK(cropMatches);
+				}
+				if (format != BC_FORMAT_BC1) {
+					std::vector<uint8_t> decoded;
+					CHECK(SUCCEEDED(BlockCompressor::decode(compressed.back().blocks.data(), 1, 1, format, decoded)));
+					CHECK(BlockCompressor::psnr(levels.back().pixels.data(), decoded.data(), 1, channelMask(format)) >= 40.0);
+				}
+			}
+		}
+		CHECK(BlockCompressor::compressedSize(BC_FORMAT_BC1, 1, 1) == 8);
+		CHECK(BlockCompressor::compressedSize(BC_FORMAT_BC7, 5, 9) == 16 * 2 * 3);
+	}
+
+	// BC1 con alfa: los píxeles con alfa < 128 se decodifican como negro transparente y el
+	// resto como opacos.
+	void testBC1Alpha() {
+		const std::vector<uint8_t> image = makeImage(SIZE, SIZE, 9);
+		std::vector<uint8_t> blocks, decoded;
+		BlockCompressor::Options options;
+		CHECK(SUCCEEDED(BlockCompressor::encode(image.data(), SIZE, SIZE, BC_FORMAT_BC1, options, blocks)));
+		CHECK(SUCCEEDED(BlockCompressor::decode(blocks.data(), SIZE, SIZE, BC_FORMAT_BC1, decoded)));
+		unsigned int wrong = 0;
+		for (size_t i = 0; i < (size_t)SIZE * SIZE; ++i) {
+			const bool transparent = image[i * 4 + 3] < 128;
+			if (transparent ? decoded[i * 4 + 3] != 0 || decoded[i * 4] != 0 || decoded[i * 4 + 1] != 0 || decoded[i * 4 + 2] != 0
+				: decoded[i * 4 + 3] != 255)
+				++wrong;
+		}
+		CHECK(wrong == 0);
+	}
+
+	void testInvalid() {
+		std::vector<uint8_t> blocks, pixels(16 * 4, 0);
+		BlockCompressor::Options options;
+		CHECK(BlockCompressor::encode(nullptr, 4, 4, BC_FORMAT_BC1, options, blocks) == E_INVALIDARG);
+		CHECK(BlockCompressor::encode(pixels.data(), 0, 4, BC_FORMAT_BC1, options, blocks) == E_INVALIDARG);
+		CHECK(BlockCompressor::encode(pixels.data(), 4, 4, BC_FORMAT_NONE, options, blocks) == E_INVALIDARG);
+		CHECK(BlockCompressor::decode(nullptr, 4, 4, BC_FORMAT_BC7, pixels) == E_INVALIDARG);
+		CHECK(BlockCompressor::psnr(pixels.data(), pixels.data(), 16) == 100.0);
+	}
+}
+
+int
+main() {
+	testQuality();
+	testSolidBlocks();
+	testSimdMatchesScalar();
+	testEdgeLevels();
+	testBC1Alpha();
+	testInvalid();
+	return testResult("BlockCompressorTests");
+}
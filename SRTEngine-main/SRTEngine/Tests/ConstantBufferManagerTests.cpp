@@ -0,0 +1,200 @@
+#include "ConstantBufferManager.h"
+#include "TestCommon.h"
+#include <cstring>
+
+// ConstantBufferManager sin dispositivo: los bloques persistentes solo se suben cuando su
+// contenido cambia (y una vez por fotograma aunque se actualicen varias veces), el anillo
+// reparte desplazamientos alineados a 256 bytes (16 constantes), escribe con DISCARD la
+// primera vez y al dar la vuelta y con NO_OVERWRITE el resto, y reserve() adelanta la vuelta
+// cuando un lote no cabe hasta el final.
+
+namespace {
+
+	struct View {
+		float view[16];
+		float eye[4];
+	};
+
+	void testInit() {
+		ConstantBufferManager manager;
+		CHECK(manager.init(nullptr, nullptr, 0) == E_INVALIDARG);
+		int notAContext = 0;
+		CHECK(manager.init(nullptr, reinterpret_cast<DeviceContext*>(&notAContext), 4096) == E_INVALIDARG);
+		CHECK(SUCCEEDED(manager.init(nullptr, nullptr, 1000)));
+		CHECK(manager.getRingSize() == 1024);
+		CHECK(!manager.usesOffsetBinding());
+		CHECK(manager.getRingBuffer() == nullptr);
+		CHECK(manager.getRingData() != nullptr);
+	}
+
+	// Vista, proyección y un bloque que no cambia nunca: solo se suben los que cambian.
+	void testDirtyBlocks() {
+		ConstantBufferManager manager;
+		CHECK(SUCCEEDED(manager.init(nullptr, nullptr, 4096)));
+		CHECK(manager.createBlock(0) == ConstantBufferManager::INVALID_BLOCK);
+		CHECK(manager.createBlock(ConstantBufferManager::MAX_ALLOCATION_SIZE + 1) == ConstantBufferManager::INVALID_BLOCK);
+		const ConstantBufferManager::BlockHandle never = manager.createBlock(64);
+		const ConstantBufferManager::BlockHandle view = manager.createBlock(sizeof(View));
+		const ConstantBufferManager::BlockHandle odd = manager.createBlock(20); // Se redondea a 32
+		CHECK(never == 0 && view == 1 && odd == 2);
+
+		// Los bloques nuevos están sucios: el primer fotograma los sube todos.
+		manager.commitBlocks();
+		CHECK(manager.getFrameStats().blockUploads == 3);
+		CHECK(manager.getFrameStats().bytesUploaded == 64 + sizeof(View) + 32);
+		manager.endFrame();
+
+		// Mismo contenido: no se marca ni se sube.
+		float zeros[16] = {};
+		CHECK(!manager.updateBlock(never, zeros, sizeof(zeros)));
+		manager.commitBlocks();
+		CHECK(manager.getFrameStats().blockUploads == 0 && manager.getFrameStats().bytesUploaded == 0);
+		CHECK(manager.getFrameStats().blockSkips == 1 && manager.getFrameStats().bytesSkipped == 64);
+		manager.endFrame();
+
+		// Tres cambios de la vista en un fotograma se suben una sola vez, al enlazar.
+		View data = {};
+		for (int i = 0; i < 3; ++i) {
+			data.eye[0] = (float)(i + 1);
+			CHECK(manager.updateBlock(view, &data, sizeof(data)));
+		}
+		CHECK(manager.getFrameStats().blockUploads == 0);
+		manager.bindBlock(StateCache::VERTEX_STAGE, 0, view);
+		manager.bindBlock(StateCache::PIXEL_STAGE, 0, view);
+		manager.commitBlocks();
+		CHECK(manager.getFrameStats().blockUploads == 1);
+		CHECK(manager.getFrameStats().bytesUploaded == sizeof(View));
+		CHECK(memcmp(manager.getBlockData(view), &data, sizeof(data)) == 0);
+
+		// Actualización parcial: solo se compara y copia el principio del bloque.
+		const float head[2] = { 7.0f, 8.0f };
+		CHECK(manager.updateBlock(odd, head, sizeof(head)));
+		CHECK(!manager.updateBlock(odd, head, sizeof(head)));
+		manager.commitBlocks();
+		CHECK(manager.getFrameStats().blockUploads == 2);
+		CHECK(manager.getFrameStats().bytesUploaded == sizeof(View) + 32);
+
+		// Errores: bloque inexistente, tamaño mayor que el bloque, sin datos.
+		CHECK(!manager.updateBlock(99, head, sizeof(head)));
+		CHECK(!manager.updateBlock(odd, zeros, sizeof(zeros)));
+		CHECK(!manager.updateBlock(odd, nullptr, 4));
+		CHECK(manager.getBlockData(99) == nullptr);
+		manager.endFrame();
+		CHECK(manager.getLastFrameStats().blockUploads == 2);
+		CHECK(manager.getTotalStats().blockUploads == 5);
+
+		// 600 fotogramas con la cámara moviéndose uno de cada diez: 60 subidas en vez de 600.
+		uint64_t uploaded = 0;
+		for (int frame = 0; frame < 600; ++frame) {
+			if (frame % 10 == 0)
+				data.view[0] = (float)(frame + 1);
+			manager.updateBlock(view, &data, sizeof(data));
+			manager.updateBlock(never, zeros, sizeof(zeros));
+			manager.bindBlock(StateCache::VERTEX_STAGE, 0, view);
+			manager.bindBlock(StateCache::VERTEX_STAGE, 1, never);
+			manager.endFrame();
+			uploaded += manager.getLastFrameStats().bytesUploaded;
+		}
+		CHECK(uploaded == 60 * sizeof(View));
+	}
+
+	// Anillo de 16 huecos de 256 bytes.
+	void testRing() {
+		ConstantBufferManager manager;
+		CHECK(SUCCEEDED(manager.init(nullptr, nullptr, 16 * 256)));
+		ConstantBufferManager::Allocation allocation;
+		uint8_t data[1024];
+		for (unsigned int i = 0; i < sizeof(data); ++i)
+			data[i] = (uint8_t)(i * 7 + 1);
+
+		// Errores: sin datos, tamaño 0, mayor que MAX_ALLOCATION_SIZE o que el anillo.
+		CHECK(!manager.allocate(nullptr, 16, allocation));
+		CHECK(!manager.allocate(data, 0, allocation));
+		CHECK(!manager.allocate(data, ConstantBufferManager::MAX_ALLOCATION_SIZE + 1, allocation));
+		CHECK(!manager.allocate(data, 16 * 256 + 1, allocation));
+		CHECK(manager.getFrameStats().allocations == 0);
+
+		// Desplazamientos y tamaños alineados a 256 bytes / 16 constantes; los datos quedan en su sitio.
+		const unsigned int sizes[] = { 64, 256, 300, 16, 1000, 257 };
+		unsigned int expectedOffset = 0;
+		bool aligned = true, contents = true, offsets = true;
+		for (unsigned int size : sizes) {
+			CHECK(manager.allocate(data, size, allocation));
+			offsets &= allocation.offset == expectedOffset;
+			aligned &= allocation.offset % ConstantBufferManager::CONSTANT_ALIGNMENT == 0 &&
+				allocation.size % ConstantBufferManager::CONSTANT_ALIGNMENT == 0 && allocation.size >= size &&
+				allocation.firstConstant == allocation.offset / 16 && allocation.firstConstant % 16 == 0 &&
+				allocation.numConstants == allocation.size / 16 && allocation.numConstants % 16 == 0;
+			contents &= memcmp(manager.getRingData() + allocation.offset, data, size) == 0;
+			expectedOffset += allocation.size;
+		}
+		CHECK(offsets && aligned && contents);
+		CHECK(expectedOffset == 256 + 256 + 512 + 256 + 1024 + 512);
+		ConstantBufferManager::Stats stats = manager.getFrameStats();
+		CHECK(stats.allocations == 6 && stats.ringWraps == 0);
+		CHECK(stats.ringDiscards == 1); // Solo la primera escritura descarta
+		CHECK(stats.bytesUploaded == 64 + 256 + 300 + 16 + 1000 + 257);
+
+		// Quedan 1280 bytes: 1024 caben con NO_OVERWRITE; los siguientes 512 ya no y dan la vuelta con DISCARD.
+		CHECK(manager.allocate(data, 1024, allocation));
+		CHECK(allocation.offset == 2816 && manager.getFrameStats().ringDiscards == 1);
+		CHECK(manager.allocate(data, 512, allocation));
+		CHECK(allocation.offset == 0);
+		stats = manager.getFrameStats();
+		CHECK(stats.ringWraps == 1 && stats.ringDiscards == 2);
+		manager.endFrame();
+
+		// Los fotogramas siguientes siguen donde se quedó el anillo, sin descartar.
+		CHECK(manager.allocate(data, 16, allocation));
+		CHECK(allocation.offset == 512);
+		CHECK(manager.getFrameStats().ringDiscards == 0);
+
+		// 40 asignaciones de 256 bytes: vuelta cada 16 huecos, una DISCARD por vuelta.
+		for (int i = 0; i < 40; ++i)
+			manager.allocate(data, 256, allocation);
+		stats = manager.getFrameStats();
+		CHECK(stats.ringWraps == 2 && stats.ringDiscards == 2);
+		CHECK(allocation.offset == 10 * 256);
+		manager.endFrame();
+		CHECK(manager.getTotalStats().ringWraps == 3 && manager.getTotalStats().ringDiscards == 4);
+		CHECK(manager.getTotalStats().allocations == 8 + 41);
+	}
+
+	// reserve(): un lote que no cabe hasta el final empieza desde el principio.
+	void testReserve() {
+		ConstantBufferManager manager;
+		CHECK(SUCCEEDED(manager.init(nullptr, nullptr, 16 * 256)));
+		uint8_t data[256] = {};
+		ConstantBufferManager::Allocation allocation;
+		for (int i = 0; i < 12; ++i)
+			manager.allocate(data, 256, allocation);
+
+		// Caben 4: no cambia nada.
+		CHECK(manager.reserve(200, 4));
+		CHECK(manager.allocate(data, 200, allocation));
+		CHECK(allocation.offset == 12 * 256);
+		// Quedan 3 y el lote es de 8: vuelta con DISCARD antes del lote, y el lote entero sin vuelta.
+		CHECK(manager.reserve(256, 8));
+		unsigned int wraps = manager.getFrameStats().ringWraps;
+		bool contiguous = true;
+		for (unsigned int i = 0; i < 8; ++i) {
+			manager.allocate(data, 256, allocation);
+			contiguous &= allocation.offset == i * 256;
+		}
+		CHECK(contiguous);
+		CHECK(manager.getFrameStats().ringWraps == wraps + 1);
+		CHECK(manager.getFrameStats().ringDiscards == 2);
+		// Lotes que no caben ni con el anillo vacío.
+		CHECK(!manager.reserve(256, 17));
+		CHECK(!manager.reserve(ConstantBufferManager::MAX_ALLOCATION_SIZE + 1, 1));
+	}
+}
+
+int
+main() {
+	testInit();
+	testDirtyBlocks();
+	testRing();
+	testReserve();
+	return testResult("ConstantBufferManagerTests");
+}
@@ -0,0 +1,347 @@
+#include "DDSFile.h"
+#include "TestCommon.h"
+#include <cstring>
+#include <fstream>
+
+// DDSFile con cabeceras escritas en memoria: formatos de la cabecera clásica (FourCC y
+// máscaras) y de la extensión DX10, tamaños y orden de los subrecursos (mips, arrays,
+// cubemaps, volúmenes y niveles que no son múltiplo de 4), y archivos que se rechazan:
+// truncados, sin la firma o con una disposición que D3D11 no admite. Por último open() de
+// un archivo real para pasar por MappedFile.
+
+namespace {
+
+	const uint32_t DDSD_DEPTH = 0x800000;
+	const uint32_t DDSCAPS2_CUBEMAP = 0x200;
+	const uint32_t DDSCAPS2_CUBEMAP_ALLFACES = 0xFC00;
+	const uint32_t DDSCAPS2_VOLUME = 0x200000;
+	const uint32_t DDPF_FOURCC = 0x4;
+	const uint32_t DDPF_RGB = 0x40;
+	const uint32_t DDPF_LUMINANCE = 0x20000;
+
+	const unsigned int FORMAT_R8G8B8A8_UNORM = 28;
+	const unsigned int FORMAT_R8_UNORM = 61;
+	const unsigned int FORMAT_BC1_UNORM = 71;
+	const unsigned int FORMAT_BC3_UNORM = 77;
+	const unsigned int FORMAT_BC5_UNORM = 83;
+	const unsigned int FORMAT_B5G6R5_UNORM = 85;
+	const unsigned int FORMAT_B8G8R8A8_UNORM = 87;
+	const unsigned int FORMAT_BC7_UNORM = 98;
+	const unsigned int FORMAT_R16G16B16A16_FLOAT = 10;
+
+	uint32_t fourCC(const char* code) {
+		return (uint32_t)(uint8_t)code[0] | ((uint32_t)(uint8_t)code[1] << 8) |
+			((uint32_t)(uint8_t)code[2] << 16) | ((uint32_t)(uint8_t)code[3] << 24);
+	}
+
+	// Cabeceras de un DDS; bytes() añade dataBytes de datos con un patrón que depende del
+	// desplazamiento, para comprobar adónde apunta cada subrecurso.
+	struct Builder {
+		uint32_t width = 4, height = 4, depth = 0, mips = 1, flags = 0x1007, caps2 = 0;
+		uint32_t pfFlags = 0, code = 0, bits = 0, masks[4] = {};
+		bool dx10 = false;
+		uint32_t dxgiFormat = 0, dimension = 3, miscFlag = 0, arraySize = 1;
+
+		static Builder fourCCFormat(const char* code) {
+			Builder b;
+			b.pfFlags = DDPF_FOURCC;
+			b.code = fourCC(code);
+			return b;
+		}
+
+		static Builder rgbFormat(uint32_t bits, uint32_t r, uint32_t g, uint32_t b, uint32_t a) {
+			Builder builder;
+			builder.pfFlags = DDPF_RGB;
+			builder.bits = bits;
+			builder.masks[0] = r;
+			builder.masks[1] = g;
+			builder.masks[2] = b;
+			builder.masks[3] = a;
+			return builder;
+		}
+
+		static Builder dx10Format(uint32_t format, uint32_t dimension, uint32_t arraySize) {
+			Builder b = fourCCFormat("DX10");
+			b.dx10 = true;
+			b.dxgiFormat = format;
+			b.dimension = dimension;
+			b.arraySize = arraySize;
+			return b;
+		}
+
+		std::vector<uint8_t> bytes(size_t dataBytes) const {
+			std::vector<uint8_t> out(4 + 124 + (dx10 ? 20 : 0), 0);
+			auto put = [&](size_t offset, uint32_t value) { memcpy(&out[offset], &value, 4); };
+			put(0, fourCC("DDS "));
+			put(4, 124);
+			put(8, flags | (depth ? DDSD_DEPTH : 0));
+			put(12, height);
+			put(16, width);
+			put(24, depth);
+			put(28, mips);
+			put(4 + 72, 32);
+			put(4 + 76, pfFlags);
+			put(4 + 80, code);
+			put(4 + 84, bits);
+			for (int i = 0; i < 4; ++i)
+				put(4 + 88 + 4 * i, masks[i]);
+			put(4 + 104, 0x1000);
+			put(4 + 108, caps2);
+			if (dx10) {
+				put(128, dxgiFormat);
+				put(132, dimension);
+				put(136, miscFlag);
+				put(140, arraySize);
+			}
+			for (size_t i = 0; i < dataBytes; ++i)
+				out.push_back((uint8_t)((i * 7 + 3) & 0xFF));
+			return out;
+		}
+	};
+
+	size_t headerSize(const Builder& builder) {
+		return 4 + 124 + (builder.dx10 ? 20 : 0);
+	}
+
+	// Los subrecursos van seguidos desde el final de las cabeceras, sin huecos.
+	bool contiguous(const DDSFile& dds, const uint8_t* data, size_t header) {
+		const uint8_t* expected = data + header;
+		for (const DDSFile::Subresource& sub : dds.getSubresources()) {
+			if (sub.data != expected)
+				return false;
+			expected += (size_t)sub.slicePitch * sub.depth;
+		}
+		return (size_t)(expected - data - header) == dds.getDataSize();
+	}
+
+	// FourCC y máscaras de la cabecera clásica.
+	void testLegacyFormats() {
+		struct Case {
+			Builder builder;
+			unsigned int format;
+		};
+		const Case cases[] = {
+			{ Builder::fourCCFormat("DXT1"), FORMAT_BC1_UNORM },
+			{ Builder::fourCCFormat("DXT5"), FORMAT_BC3_UNORM },
+			{ Builder::fourCCFormat("ATI2"), FORMAT_BC5_UNORM },
+			{ Builder::fourCCFormat("q\0\0\0"), FORMAT_R16G16B16A16_FLOAT }, // D3DFMT_A16B16G16R16F = 113
+			{ Builder::rgbFormat(32, 0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000), FORMAT_R8G8B8A8_UNORM },
+			{ Builder::rgbFormat(32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000), FORMAT_B8G8R8A8_UNORM },
+			{ Builder::rgbFormat(16, 0xF800, 0x07E0, 0x001F, 0), FORMAT_B5G6R5_UNORM },
+		};
+		for (const Case& c : cases) {
+			const std::vector<uint8_t> file = c.builder.bytes(1024);
+			DDSFile dds;
+			CHECK(SUCCEEDED(dds.parse(file.data(), file.size())));
+			CHECK(dds.getFormat() == c.format);
+			CHECK(dds.getDimension() == DDSFile::DIMENSION_TEXTURE2D);
+			CHECK(dds.getArraySize() == 1 && dds.getMipCount() == 1 && dds.getDepth() == 1);
+		}
+
+		Builder luminance;
+		luminance.pfFlags = DDPF_LUMINANCE;
+		luminance.bits = 8;
+		luminance.masks[0] = 0xFF;
+		std::vector<uint8_t> file = luminance.bytes(16);
+		DDSFile dds;
+		CHECK(SUCCEEDED(dds.parse(file.data(), file.size())));
+		CHECK(dds.getFormat() == FORMAT_R8_UNORM && !dds.isBlockCompressed());
+
+		// Máscaras que no corresponden a ningún DXGI_FORMAT.
+		file = Builder::rgbFormat(24, 0xFF0000, 0x00FF00, 0x0000FF, 0).bytes(1024);
+		CHECK(dds.parse(file.data(), file.size()) == E_FAIL);
+		file = Builder::fourCCFormat("XYZW").bytes(1024);
+		CHECK(dds.parse(file.data(), file.size()) == E_FAIL);
+	}
+
+	// BC1 de 256x128 con los 9 mips: filas de bloques de 4 píxeles, mínimo un bloque.
+	void testMipChain() {
+		Builder builder = Builder::fourCCFormat("DXT1");
+		builder.width = 256;
+		builder.height = 128;
+		builder.mips = 9;
+		size_t expectedBytes = 0;
+		for (unsigned int mip = 0; mip < 9; ++mip)
+			expectedBytes += (size_t)std::max(1u, (256u >> mip) / 4) * std::max(1u, std::max(1u, 128u >> mip) / 4) * 8;
+		CHECK(expectedBytes == 21864);
+		std::vector<uint8_t> file = builder.bytes(expectedBytes);
+
+		DDSFile dds;
+		CHECK(SUCCEEDED(dds.parse(file.data(), file.size())));
+		CHECK(dds.isBlockCompressed() && dds.getMipCount() == 9);
+		const std::vector<DDSFile::Subresource>& subs = dds.getSubresources();
+		CHECK(subs.size() == 9);
+		CHECK(subs[0].width == 256 && subs[0].height == 128 && subs[0].rowPitch == 64 * 8 && subs[0].slicePitch == 64 * 32 * 8);
+		CHECK(subs[6].width == 4 && subs[6].height == 2 && subs[6].rowPitch == 8 && subs[6].slicePitch == 8);
+		CHECK(subs[8].width == 1 && subs[8].height == 1 && subs[8].slicePitch == 8);
+		CHECK(dds.getDataSize() == expectedBytes);
+		CHECK(contiguous(dds, file.data(), headerSize(builder)));
+		CHECK(subs[1].data[0] == (uint8_t)((64 * 32 * 8 * 7 + 3) & 0xFF));
+
+		// Sin comprimir y de tamaño impar: 5x3 RGBA8 con 3 mips (5x3, 2x1, 1x1).
+		builder = Builder::rgbFormat(32, 0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000);
+		builder.width = 5;
+		builder.height = 3;
+		builder.mips = 3;
+		file = builder.bytes(5 * 3 * 4 + 2 * 4 + 4);
+		CHECK(SUCCEEDED(dds.parse(file.data(), file.size())));
+		CHECK(dds.getSubresources().size() == 3);
+		CHECK(dds.getSubresources()[0].rowPitch == 20 && dds.getSubresources()[0].slicePitch == 60);
+		CHECK(dds.getSubresources()[1].width == 2 && dds.getSubresources()[1].height == 1 && dds.getSubresources()[1].rowPitch == 8);
+		CHECK(dds.getSubresources()[2].slicePitch == 4);
+		CHECK(contiguous(dds, file.data(), headerSize(builder)));
+
+		// 0 mips en la cabecera cuenta como 1; más de 32 no es válido.
+		builder.mips = 0;
+		file = builder.bytes(60);
+		CHECK(SUCCEEDED(dds.parse(file.data(), file.size())) && dds.getMipCount() == 1);
+		builder.mips = 33;
+		file = builder.bytes(4096);
+		CHECK(dds.parse(file.data(), file.size()) == E_FAIL);
+	}
+
+	// Cubemap y volumen en la cabecera clásica.
+	void testLegacyLayouts() {
+		Builder cube = Builder::fourCCFormat("DXT5");
+		cube.width = cube.height = 8;
+		cube.mips = 2;
+		cube.caps2 = DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_ALLFACES;
+		const size_t face = 2 * 2 * 16 + 16;
+		std::vector<uint8_t> file = cube.bytes(6 * face);
+		DDSFile dds;
+		CHECK(SUCCEEDED(dds.parse(file.data(), file.size())));
+		CHECK(dds.isCubemap() && dds.getArraySize() == 6 && dds.getSubresources().size() == 12);
+		// Cada cara lleva todos sus mips antes que la siguiente.
+		CHECK(dds.getSubresources()[2].data == file.data() + headerSize(cube) + face);
+		CHECK(dds.getSubresources()[3].width == 4);
+		CHECK(contiguous(dds, file.data(), headerSize(cube)));
+
+		cube.caps2 = DDSCAPS2_CUBEMAP | 0x400 | 0x800; // Solo dos caras
+		file = cube.bytes(6 * face);
+		CHECK(dds.parse(file.data(), file.size()) == E_FAIL);
+
+		Builder volume = Builder::rgbFormat(32, 0x000000FF, 0x0000FF00, 0x00FF0000, 0xFF000000);
+		volume.width = 4;
+		volume.height = 4;
+		volume.depth = 4;
+		volume.mips = 3;
+		volume.caps2 = DDSCAPS2_VOLUME;
+		file = volume.bytes(4 * 4 * 4 * 4 + 2 * 2 * 2 * 4 + 4);
+		CHECK(SUCCEEDED(dds.parse(file.data(), file.size())));
+		CHECK(dds.getDimension() == DDSFile::DIMENSION_TEXTURE3D && dds.getDepth() == 4);
+		CHECK(dds.getSubresources()[0].slicePitch == 64 && dds.getSubresources()[0].depth == 4);
+		CHECK(dds.getSubresources()[1].depth == 2 && dds.getSubresources()[2].depth == 1);
+		CHECK(dds.getDataSize() == 256 + 32 + 4);
+	}
+
+	// Cabecera DX10: arrays, cubemaps, 1D y combinaciones que no se admiten.
+	void testDX10() {
+		Builder array = Builder::dx10Format(FORMAT_BC7_UNORM, DDSFile::DIMENSION_TEXTURE2D, 3);
+		array.width = array.height = 64;
+		array.mips = 7;
+		size_t item = 0;
+		for (unsigned int mip = 0; mip < 7; ++mip)
+			item += (size_t)std::max(1u, (64u >> mip) / 4) * std::max(1u, (64u >> mip) / 4) * 16;
+		std::vector<uint8_t> file = array.bytes(3 * item);
+		DDSFile dds;
+		CHECK(SUCCEEDED(dds.parse(file.data(), file.size())));
+		CHECK(dds.getFormat() == FORMAT_BC7_UNORM && dds.getArraySize() == 3 && !dds.isCubemap());
+		CHECK(dds.getSubresources().size() == 21);
+		CHECK(dds.getSubresources()[7].width == 64 && dds.getSubresources()[7].data == file.data() + headerSize(array) + item);
+		CHECK(dds.getDataSize() == 3 * item);
+		CHECK(contiguous(dds, file.data(), headerSize(array)));
+
+		// Truncado un byte antes del final del último mip.
+		CHECK(dds.parse(file.data(), file.size() - 1) == E_FAIL);
+		CHECK(dds.getSubresources().empty() && dds.getDataSize() == 0);
+
+		Builder cube = Builder::dx10Format(FORMAT_R8G8B8A8_UNORM, DDSFile::DIMENSION_TEXTURE2D, 2);
+		cube.miscFlag = 0x4;
+		file = cube.bytes(12 * 4 * 4 * 4);
+		CHECK(SUCCEEDED(dds.parse(file.data(), file.size())));
+		CHECK(dds.isCubemap() && dds.getArraySize() == 12 && dds.getSubresources().size() == 12);
+
+		Builder line = Builder::dx10Format(FORMAT_R8G8B8A8_UNORM, DDSFile::DIMENSION_TEXTURE1D, 1);
+		line.width = 16;
+		line.height = 8; // Se ignora en 1D
+		file = line.bytes(16 * 4);
+		CHECK(SUCCEEDED(dds.parse(file.data(), file.size())));
+		CHECK(dds.getDimension() == DDSFile::DIMENSION_TEXTURE1D && dds.getHeight() == 1);
+
+		Builder bad = Builder::dx10Format(FORMAT_R8G8B8A8_UNORM, DDSFile::DIMENSION_TEXTURE3D, 2);
+		file = bad.bytes(4096);
+		CHECK(dds.parse(file.data(), file.size()) == E_FAIL);
+		bad = Builder::dx10Format(FORMAT_R8G8B8A8_UNORM, DDSFile::DIMENSION_TEXTURE2D, 0);
+		file = bad.bytes(4096);
+		CHECK(dds.parse(file.data(), file.size()) == E_FAIL);
+		bad = Builder::dx10Format(FORMAT_R8G8B8A8_UNORM, 7, 1);
+		file = bad.bytes(4096);
+		CHECK(dds.parse(file.data(), file.size()) == E_FAIL);
+		bad = Builder::dx10Format(FORMAT_R8G8B8A8_UNORM, DDSFile::DIMENSION_TEXTURE1D, 1);
+		bad.miscFlag = 0x4;
+		file = bad.bytes(4096);
+		CHECK(dds.parse(file.data(), file.size()) == E_FAIL);
+		bad = Builder::dx10Format(0, DDSFile::DIMENSION_TEXTURE2D, 1);
+		file = bad.bytes(4096);
+		CHECK(dds.parse(file.data(), file.size()) == E_FAIL);
+
+		// La cabecera DX10 cortada.
+		file = Builder::dx10Format(FORMAT_BC7_UNORM, DDSFile::DIMENSION_TEXTURE2D, 1).bytes(0);
+		CHECK(dds.parse(file.data(), 4 + 124 + 10) == E_FAIL);
+	}
+
+	// Firma, tamaño de cabecera y dimensiones.
+	void testInvalidHeaders() {
+		std::vector<uint8_t> file = Builder::fourCCFormat("DXT1").bytes(8);
+		DDSFile dds;
+		CHECK(SUCCEEDED(dds.parse(file.data(), file.size())));
+		CHECK(dds.parse(file.data(), 100) == E_FAIL);
+		CHECK(dds.parse(file.data(), file.size() - 1) == E_FAIL);
+		CHECK(dds.parse(nullptr, 0) == E_POINTER);
+
+		std::vector<uint8_t> badMagic = file;
+		badMagic[0] = 'X';
+		CHECK(dds.parse(badMagic.data(), badMagic.size()) == E_FAIL);
+		std::vector<uint8_t> badSize = file;
+		badSize[4] = 123;
+		CHECK(dds.parse(badSize.data(), badSize.size()) == E_FAIL);
+
+		Builder empty = Builder::fourCCFormat("DXT1");
+		empty.width = 0;
+		file = empty.bytes(8);
+		CHECK(dds.parse(file.data(), file.size()) == E_FAIL);
+		CHECK(dds.getWidth() == 0 && dds.getSubresources().empty());
+	}
+
+	// open() proyecta el archivo y los subrecursos apuntan a la proyección.
+	void testOpen() {
+		Builder builder = Builder::fourCCFormat("DXT1");
+		builder.width = builder.height = 16;
+		builder.mips = 5;
+		const std::vector<uint8_t> bytes = builder.bytes(16 * 8 + 4 * 8 + 3 * 8);
+		{
+			std::ofstream out("DDSFileTests.dds", std::ios::binary);
+			out.write((const char*)bytes.data(), bytes.size());
+		}
+		DDSFile dds;
+		CHECK(SUCCEEDED(dds.open("DDSFileTests.dds")));
+		CHECK(dds.getSubresources().size() == 5 && dds.getDataSize() == bytes.size() - headerSize(builder));
+		CHECK(!dds.getSubresources().empty() &&
+			memcmp(dds.getSubresources()[0].data, bytes.data() + headerSize(builder), 16 * 8) == 0);
+		dds.close();
+		CHECK(dds.getSubresources().empty());
+		CHECK(FAILED(dds.open("DDSFileTests_missing.dds")));
+		std::remove("DDSFileTests.dds");
+	}
+}
+
+int
+main() {
+	testLegacyFormats();
+	testMipChain();
+	testLegacyLayouts();
+	testDX10();
+	testInvalidHeaders();
+	testOpen();
+	return testResult("DDSFileTests");
+}
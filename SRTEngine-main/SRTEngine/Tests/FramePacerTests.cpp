@@ -0,0 +1,206 @@
+#include "FramePacer.h"
+#include "TestCommon.h"
+#include <algorithm>
+#include <random>
+
+// FramePacer con un reloj falso (las esperas avanzan el tiempo, con un retraso opcional
+// como el de Sleep) y una GPU falsa que termina cada frame un tiempo fijo después del
+// anterior: tope de FPS sin deriva, el margen que se espera girando, frames más lentos que
+// el tope, límite de frames en vuelo y estadísticas de intervalo, jitter y latencia.
+
+namespace {
+
+	struct FakeTime {
+		double now = 100.0;
+		double maxOvershoot = 0.0; ///< Sleep se pasa hasta esto (al azar).
+		std::mt19937 random{ 4 };
+	};
+
+	double readClock(void* data) {
+		return static_cast<FakeTime*>(data)->now;
+	}
+
+	// Ceder el hilo cuesta 10 us; dormir, lo pedido más un retraso al azar.
+	void fakeSleep(void* data, double seconds) {
+		FakeTime& time = *static_cast<FakeTime*>(data);
+		if (seconds <= 0.0) {
+			time.now += 1e-5;
+			return;
+		}
+		time.now += seconds + std::uniform_real_distribution<double>(0.0, time.maxOvershoot)(time.random);
+	}
+
+	// Ejecuta los frames uno detrás de otro a partir de que se presentan.
+	struct FakeGpu {
+		FakeTime* time = nullptr;
+		double frameSeconds = 0.0;
+		std::vector<double> completions;
+
+		void present() {
+			const double start = completions.empty() ? time->now : std::max(time->now, completions.back());
+			completions.push_back(start + frameSeconds);
+		}
+	};
+
+	uint64_t completedFrames(void* data) {
+		const FakeGpu& gpu = *static_cast<const FakeGpu*>(data);
+		return (uint64_t)(std::upper_bound(gpu.completions.begin(), gpu.completions.end(), gpu.time->now) -
+			gpu.completions.begin());
+	}
+
+	// Un frame: espera del pacer, entrada, CPU y presentación. Devuelve los frames que
+	// seguían en vuelo al empezar.
+	uint64_t runFrame(FramePacer& pacer, FakeTime& time, FakeGpu* gpu, double cpuSeconds) {
+		pacer.beginFrame();
+		const uint64_t inFlight = gpu ? gpu->completions.size() - completedFrames(gpu) : 0;
+		const double input = time.now;
+		time.now += cpuSeconds;
+		pacer.presented(input);
+		if (gpu)
+			gpu->present();
+		return inFlight;
+	}
+
+	void testFpsCap() {
+		FakeTime time;
+		FramePacer pacer;
+		CHECK(pacer.init(-1.0) == E_INVALIDARG);
+		CHECK(pacer.init(60.0, 0) == E_INVALIDARG);
+		CHECK(SUCCEEDED(pacer.init(100.0)));
+		pacer.setClock(readClock, fakeSleep, &time);
+
+		// 3 ms de CPU con tope de 100 FPS: 10 ms exactos entre frames.
+		const double start = time.now;
+		for (int i = 0; i < 300; ++i)
+			runFrame(pacer, time, nullptr, 0.003);
+		FramePacer::Stats stats = pacer.getStats();
+		CHECK(stats.frames == 300);
+		CHECK_NEAR(stats.averageIntervalMs, 10.0, 0.01);
+		CHECK_NEAR(stats.minIntervalMs, 10.0, 0.02);
+		CHECK_NEAR(stats.maxIntervalMs, 10.0, 0.02);
+		CHECK(stats.jitter[0] == 299);
+		CHECK_NEAR(stats.capSeconds, 299 * 0.007, 0.01);
+		CHECK_NEAR(time.now - start, 3.0 - 0.007, 0.001);
+
+		// Sleep se pasa hasta 1.5 ms: con 2 ms de espera girando no se nota; sin ella sí.
+		time.maxOvershoot = 0.0015;
+		pacer.resetStats();
+		for (int i = 0; i < 300; ++i)
+			runFrame(pacer, time, nullptr, 0.003);
+		const double spinJitter = pacer.getStats().averageJitterMs;
+		CHECK(spinJitter < 0.02);
+		pacer.setSpinSeconds(0.0);
+		pacer.resetStats();
+		for (int i = 0; i < 300; ++i)
+			runFrame(pacer, time, nullptr, 0.003);
+		stats = pacer.getStats();
+		CHECK(stats.averageJitterMs > 0.2);
+		// Los instantes se encadenan: aun así la media no se desvía.
+		CHECK_NEAR(stats.averageIntervalMs, 10.0, 0.02);
+
+		// 1000 frames a 60 FPS sin deriva acumulada.
+		CHECK(SUCCEEDED(pacer.init(60.0)));
+		pacer.setSpinSeconds(0.002);
+		pacer.setClock(readClock, fakeSleep, &time);
+		pacer.beginFrame();
+		const double first = time.now;
+		for (int i = 0; i < 1000; ++i) {
+			time.now += 0.004;
+			pacer.presented();
+			pacer.beginFrame();
+		}
+		CHECK_NEAR(time.now - first, 1000.0 / 60.0, 1e-4);
+
+		// Más lentos que el tope: no se espera nada.
+		CHECK(SUCCEEDED(pacer.init(100.0)));
+		pacer.setClock(readClock, fakeSleep, &time);
+		for (int i = 0; i < 100; ++i)
+			runFrame(pacer, time, nullptr, 0.015);
+		stats = pacer.getStats();
+		CHECK_NEAR(stats.averageIntervalMs, 15.0, 0.01);
+		CHECK(stats.capSeconds < 0.001);
+		// Con 5 ms de más frente al objetivo van todos a la cubeta de 4..8 ms.
+		CHECK(stats.jitter[5] == 99);
+	}
+
+	// GPU de 20 ms por frame y CPU de 2 ms: el límite de frames en vuelo marca el ritmo. Con
+	// un solo frame en vuelo la CPU no se solapa con la GPU y el frame dura 22 ms.
+	void testFramesInFlight() {
+		for (unsigned int maxFrames = 1; maxFrames <= 3; ++maxFrames) {
+			FakeTime time;
+			FakeGpu gpu;
+			gpu.time = &time;
+			gpu.frameSeconds = 0.020;
+			FramePacer pacer;
+			CHECK(SUCCEEDED(pacer.init(0.0, maxFrames)));
+			CHECK(pacer.getMaxFramesInFlight() == maxFrames);
+			pacer.setClock(readClock, fakeSleep, &time);
+			pacer.setCompletedFramesQuery(completedFrames, &gpu);
+
+			uint64_t maxInFlight = 0;
+			for (int i = 0; i < 50; ++i)
+				maxInFlight = std::max(maxInFlight, runFrame(pacer, time, &gpu, 0.002));
+			pacer.resetStats();
+			for (int i = 0; i < 200; ++i)
+				maxInFlight = std::max(maxInFlight, runFrame(pacer, time, &gpu, 0.002));
+			const FramePacer::Stats stats = pacer.getStats();
+			const double intervalMs = maxFrames == 1 ? 22.0 : 20.0;
+			CHECK(maxInFlight == maxFrames - 1);
+			CHECK_NEAR(stats.averageIntervalMs, intervalMs, 0.25);
+			CHECK_NEAR(stats.throttleSeconds, 200 * (intervalMs - 2.0) * 0.001, 0.06);
+			// La latencia de entrada a presentación es solo la CPU: la espera va antes.
+			CHECK_NEAR(stats.averageLatencyMs, 2.0, 1e-6);
+		}
+
+		// Sin consulta no se frena: la CPU va por delante de la GPU.
+		FakeTime time;
+		FakeGpu gpu;
+		gpu.time = &time;
+		gpu.frameSeconds = 0.020;
+		FramePacer pacer;
+		CHECK(SUCCEEDED(pacer.init(0.0, 2)));
+		pacer.setClock(readClock, fakeSleep, &time);
+		uint64_t maxInFlight = 0;
+		for (int i = 0; i < 20; ++i)
+			maxInFlight = std::max(maxInFlight, runFrame(pacer, time, &gpu, 0.002));
+		CHECK(maxInFlight > 10);
+		CHECK(pacer.getStats().throttleSeconds == 0.0);
+	}
+
+	// Latencias de 1..100 ms desordenadas: media 50.5, máximo 100 y p99 99.
+	void testLatencyStats() {
+		FakeTime time;
+		FramePacer pacer;
+		CHECK(SUCCEEDED(pacer.init()));
+		pacer.setClock(readClock, fakeSleep, &time);
+		std::vector<int> latencies;
+		for (int i = 1; i <= 100; ++i)
+			latencies.push_back(i);
+		std::shuffle(latencies.begin(), latencies.end(), time.random);
+		for (int ms : latencies)
+			runFrame(pacer, time, nullptr, ms * 0.001);
+		// Un frame sin instante de entrada no cuenta para la latencia.
+		pacer.beginFrame();
+		time.now += 0.5;
+		pacer.presented();
+
+		const FramePacer::Stats stats = pacer.getStats();
+		CHECK(stats.frames == 101);
+		CHECK_NEAR(stats.averageLatencyMs, 50.5, 1e-6);
+		CHECK_NEAR(stats.maxLatencyMs, 100.0, 1e-6);
+		CHECK_NEAR(stats.p99LatencyMs, 99.0, 1e-3);
+		CHECK_NEAR(stats.maxIntervalMs, 500.0, 1e-6);
+		uint64_t bucketed = 0;
+		for (uint64_t count : stats.jitter)
+			bucketed += count;
+		CHECK(bucketed == 100);
+	}
+}
+
+int
+main() {
+	testFpsCap();
+	testFramesInFlight();
+	testLatencyStats();
+	return testResult("FramePacerTests");
+}
@@ -0,0 +1,197 @@
+#include "FramePipeline.h"
+#include "TestCommon.h"
+#include <atomic>
+#include <chrono>
+
+// FramePipeline con funciones de simulación y de render de prueba: la simulación del frame
+// N+1 empieza mientras el render del frame N sigue abierto, los frames llegan al render en
+// orden y cada hueco trae lo que escribió su frame. Los datos de los huecos son variables
+// normales: compilado con -DSRT_ENABLE_TSAN=ON, ThreadSanitizer avisa si un hueco se lee
+// mientras se escribe; además cada hueco lleva marcas de escritura y lectura que el test
+// comprueba sin ThreadSanitizer.
+
+namespace {
+
+	const unsigned int PAYLOAD = 512;
+
+	struct Slot {
+		uint64_t frame = 0;
+		uint64_t payload[PAYLOAD] = {}; ///< frame * PAYLOAD + i, como unas constantes de frame.
+	};
+
+	struct Scene {
+		Slot slots[FramePipeline::MAX_FRAMES_IN_FLIGHT];
+		std::atomic<bool> writing[FramePipeline::MAX_FRAMES_IN_FLIGHT] = {};
+		std::atomic<bool> reading[FramePipeline::MAX_FRAMES_IN_FLIGHT] = {};
+		std::atomic<uint64_t> started{ 0 };   ///< Simulaciones empezadas.
+		std::atomic<unsigned int> collisions{ 0 };
+		uint64_t nextFrame = 0;               ///< Solo lo toca la simulación.
+		std::thread::id simulationThread;
+	};
+
+	void simulate(void* data, unsigned int slot) {
+		Scene& scene = *static_cast<Scene*>(data);
+		scene.started.fetch_add(1);
+		scene.simulationThread = std::this_thread::get_id();
+		if (scene.reading[slot].load())
+			scene.collisions.fetch_add(1);
+		scene.writing[slot].store(true);
+		Slot& target = scene.slots[slot];
+		const uint64_t frame = scene.nextFrame++;
+		target.frame = frame;
+		for (unsigned int i = 0; i < PAYLOAD; ++i) {
+			target.payload[i] = frame * PAYLOAD + i;
+			if (i % 128 == 0)
+				std::this_thread::yield();
+		}
+		scene.writing[slot].store(false);
+	}
+
+	// Lee el hueco como lo haría el render; devuelve si trae el frame esperado entero.
+	bool readSlot(Scene& scene, unsigned int slot, uint64_t frame) {
+		scene.reading[slot].store(true);
+		if (scene.writing[slot].load())
+			scene.collisions.fetch_add(1);
+		bool whole = scene.slots[slot].frame == frame;
+		for (unsigned int i = 0; i < PAYLOAD; ++i) {
+			whole &= scene.slots[slot].payload[i] == frame * PAYLOAD + i;
+			if (i % 128 == 0)
+				std::this_thread::yield();
+		}
+		if (scene.writing[slot].load())
+			scene.collisions.fetch_add(1);
+		scene.reading[slot].store(false);
+		return whole;
+	}
+
+	// Espera hasta 5 s a que se hayan empezado count simulaciones.
+	bool waitStarted(const Scene& scene, uint64_t count) {
+		const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+		while (scene.started.load() < count) {
+			if (std::chrono::steady_clock::now() > deadline)
+				return false;
+			std::this_thread::yield();
+		}
+		return true;
+	}
+
+	void testInit() {
+		Scene scene;
+		FramePipeline pipeline;
+		CHECK(pipeline.init(0, simulate, &scene) == E_INVALIDARG);
+		CHECK(pipeline.init(FramePipeline::MAX_FRAMES_IN_FLIGHT + 1, simulate, &scene) == E_INVALIDARG);
+		CHECK(pipeline.init(2, nullptr, &scene) == E_INVALIDARG);
+		CHECK(pipeline.getFramesInFlight() == 0);
+		// endRender() sin beginRender() no suelta nada.
+		CHECK(SUCCEEDED(pipeline.init(2, simulate, &scene)));
+		pipeline.endRender();
+		CHECK(pipeline.getStats().rendered == 0);
+		pipeline.destroy();
+	}
+
+	// Con el hueco del frame N abierto en el render, la simulación del frame N + slots - 1
+	// tiene que poder empezar; cada frame llega en orden y entero.
+	void testOverlap(unsigned int framesInFlight) {
+		const uint64_t frames = 200;
+		Scene scene;
+		FramePipeline pipeline;
+		CHECK(SUCCEEDED(pipeline.init(framesInFlight, simulate, &scene)));
+		CHECK(pipeline.getFramesInFlight() == framesInFlight);
+
+		unsigned int overlapped = 0, whole = 0, inOrder = 0;
+		for (uint64_t frame = 0; frame < frames; ++frame) {
+			const unsigned int slot = pipeline.beginRender();
+			inOrder += slot == frame % framesInFlight;
+			if (framesInFlight > 1)
+				overlapped += waitStarted(scene, frame + framesInFlight);
+			whole += readSlot(scene, slot, frame);
+			pipeline.endRender();
+		}
+		pipeline.destroy();
+		const std::thread::id simulationThread = scene.simulationThread;
+
+		CHECK(inOrder == frames);
+		CHECK(whole == frames);
+		CHECK(scene.collisions.load() == 0);
+		if (framesInFlight > 1) {
+			CHECK(overlapped == frames);
+			CHECK(simulationThread != std::this_thread::get_id());
+		}
+		else {
+			CHECK(simulationThread == std::this_thread::get_id());
+		}
+
+		// La simulación nunca va más de framesInFlight frames por delante.
+		const FramePipeline::Stats stats = pipeline.getStats();
+		CHECK(stats.rendered == frames);
+		CHECK(stats.simulated >= frames && stats.simulated <= frames + framesInFlight);
+		CHECK(scene.nextFrame == stats.simulated);
+	}
+
+	// Un render lento y una simulación lenta: las esperas caen del lado que corresponde.
+	struct SlowScene {
+		Scene scene;
+		std::atomic<int> simulateMs{ 0 };
+	};
+
+	void slowSimulate(void* data, unsigned int slot) {
+		SlowScene& slow = *static_cast<SlowScene*>(data);
+		std::this_thread::sleep_for(std::chrono::milliseconds(slow.simulateMs.load()));
+		simulate(&slow.scene, slot);
+	}
+
+	void testWaits() {
+		SlowScene slow;
+		slow.simulateMs = 5;
+		FramePipeline pipeline;
+		CHECK(SUCCEEDED(pipeline.init(2, slowSimulate, &slow)));
+		for (uint64_t frame = 0; frame < 20; ++frame) {
+			pipeline.beginRender();
+			pipeline.endRender();
+		}
+		FramePipeline::Stats stats = pipeline.getStats();
+		CHECK(stats.renderWaitSeconds > 0.05);
+		CHECK(stats.simulateSeconds > 0.09);
+
+		// Render lento: la simulación espera hueco libre.
+		slow.simulateMs = 0;
+		for (uint64_t frame = 20; frame < 40; ++frame) {
+			pipeline.beginRender();
+			std::this_thread::sleep_for(std::chrono::milliseconds(5));
+			pipeline.endRender();
+		}
+		stats = pipeline.getStats();
+		CHECK(stats.simulateWaitSeconds > 0.05);
+		CHECK(stats.rendered == 40);
+		pipeline.destroy();
+		CHECK(pipeline.getFramesInFlight() == 0);
+	}
+
+	// destroy() con la simulación esperando hueco, y volver a init() después.
+	void testDestroy() {
+		Scene scene;
+		FramePipeline pipeline;
+		CHECK(SUCCEEDED(pipeline.init(3, simulate, &scene)));
+		CHECK(waitStarted(scene, 3));
+		pipeline.destroy();
+		CHECK(scene.started.load() == 3);
+
+		Scene again;
+		CHECK(SUCCEEDED(pipeline.init(2, simulate, &again)));
+		CHECK(pipeline.beginRender() == 0);
+		CHECK(readSlot(again, 0, 0));
+		pipeline.endRender();
+		CHECK(pipeline.getStats().rendered == 1);
+		pipeline.destroy(); // Antes de que again deje de existir
+	}
+}
+
+int
+main() {
+	testInit();
+	for (unsigned int framesInFlight = 1; framesInFlight <= FramePipeline::MAX_FRAMES_IN_FLIGHT; ++framesInFlight)
+		testOverlap(framesInFlight);
+	testWaits();
+	testDestroy();
+	return testResult("FramePipelineTests");
+}
@@ -0,0 +1,136 @@
+#include "FrustumCuller.h"
+#include "TestCommon.h"
+#include <random>
+
+// Compara el camino SIMD del culler (SSE2 o AVX2, según la compilación) con una versión
+// escalar escrita aquí. Las dos suman en el mismo orden, así que la lista de índices
+// visibles tiene que ser idéntica, también en los volúmenes que tocan un plano justo.
+
+namespace {
+
+	bool referenceSphere(const Float4* planes, float x, float y, float z, float radius) {
+		for (int p = 0; p < FrustumCuller::PLANE_COUNT; ++p) {
+			const float distance = planes[p].x * x + planes[p].y * y + planes[p].z * z + planes[p].w;
+			if (!(distance >= -radius))
+				return false;
+		}
+		return true;
+	}
+
+	bool referenceBox(const Float4* planes, float x, float y, float z, float ex, float ey, float ez) {
+		for (int p = 0; p < FrustumCuller::PLANE_COUNT; ++p) {
+			const float distance = planes[p].x * x + planes[p].y * y + planes[p].z * z + planes[p].w;
+			const float radius = std::fabs(planes[p].x) * ex + std::fabs(planes[p].y) * ey + std::fabs(planes[p].z) * ez;
+			if (!(distance + radius >= 0.0f))
+				return false;
+		}
+		return true;
+	}
+
+	void makeFrustum(FrustumCuller& culler) {
+		const Matrix view = MatrixLookAtLH(VectorSet(3.0f, 5.0f, -20.0f, 1.0f), VectorSet(0.0f, 0.0f, 0.0f, 1.0f),
+			VectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+		culler.setFrustum(view, MatrixPerspectiveFovLH(MATH_PIDIV4, 1200.0f / 1010.0f, 0.1f, 100.0f));
+	}
+
+	// Volúmenes aleatorios alrededor del frustum y algunos colocados justo sobre un plano.
+	void makeSpheres(const Float4* planes, unsigned int count, BoundingSpheres& spheres) {
+		std::mt19937 random(7);
+		std::uniform_real_distribution<float> position(-60.0f, 60.0f);
+		std::uniform_real_distribution<float> radius(0.0f, 4.0f);
+		for (unsigned int i = 0; i < count; ++i) {
+			const Float3 center(position(random), position(random), position(random) + 40.0f);
+			float r = radius(random);
+			if (i % 13 == 0) {
+				const Float4& plane = planes[i % FrustumCuller::PLANE_COUNT];
+				r = -(plane.x * center.x + plane.y * center.y + plane.z * center.z + plane.w);
+			}
+			spheres.add(center, r);
+		}
+	}
+
+	void makeBoxes(unsigned int count, BoundingBoxes& boxes) {
+		std::mt19937 random(11);
+		std::uniform_real_distribution<float> position(-60.0f, 60.0f);
+		std::uniform_real_distribution<float> extent(0.0f, 4.0f);
+		for (unsigned int i = 0; i < count; ++i) {
+			boxes.add(Float3(position(random), position(random), position(random) + 40.0f),
+				Float3(extent(random), extent(random), extent(random)));
+		}
+	}
+
+	void testSpheres(FrustumCuller& culler, unsigned int count) {
+		BoundingSpheres spheres;
+		makeSpheres(culler.getPlanes(), count, spheres);
+		std::vector<uint32_t> expected, visible;
+		for (unsigned int i = 0; i < count; ++i) {
+			if (referenceSphere(culler.getPlanes(), spheres.centerX[i], spheres.centerY[i], spheres.centerZ[i],
+				spheres.radius[i]))
+				expected.push_back(i);
+		}
+		culler.cullSpheres(spheres, visible);
+		CHECK(visible == expected);
+		CHECK(culler.getStats().tested == count);
+		CHECK(culler.getStats().visible == expected.size());
+	}
+
+	void testBoxes(FrustumCuller& culler, unsigned int count) {
+		BoundingBoxes boxes;
+		makeBoxes(count, boxes);
+		std::vector<uint32_t> expected, visible;
+		for (unsigned int i = 0; i < count; ++i) {
+			if (referenceBox(culler.getPlanes(), boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i],
+				boxes.extentX[i], boxes.extentY[i], boxes.extentZ[i]))
+				expected.push_back(i);
+		}
+		culler.cullBoxes(boxes, visible);
+		CHECK(visible == expected);
+		CHECK(culler.getStats().visible == expected.size());
+	}
+
+	void testPlanes(FrustumCuller& culler) {
+		BoundingSpheres spheres;
+		spheres.add(Float3(0.0f, 0.0f, 0.0f), 0.0f);     // Delante de la cámara.
+		spheres.add(Float3(6.0f, 10.0f, -40.0f), 1.0f);  // Detrás.
+		spheres.add(Float3(0.0f, 0.0f, 200.0f), 1.0f);   // Más allá del plano lejano.
+		spheres.add(Float3(500.0f, 0.0f, 0.0f), 1.0f);   // Fuera por un lado.
+		spheres.add(Float3(500.0f, 0.0f, 0.0f), 600.0f); // Envuelve el frustum.
+		std::vector<uint32_t> visible;
+		culler.cullSpheres(spheres, visible);
+		CHECK(visible == std::vector<uint32_t>({ 0, 4 }));
+	}
+}
+
+int
+main() {
+#if defined(SRT_MATH_SSE) && defined(SRT_SIMD_AVX2)
+	printf("FrustumCuller AVX2\n");
+#elif defined(SRT_MATH_SSE)
+	printf("FrustumCuller SSE2\n");
+#else
+	printf("FrustumCuller scalar\n");
+#endif
+
+	FrustumCuller culler;
+	culler.init();
+	makeFrustum(culler);
+	testPlanes(culler);
+	// Tamaños que no son múltiplo de los carriles y que cruzan varios bloques.
+	for (unsigned int count : { 0u, 1u, 3u, 7u, 8u, 9u, 31u, 1000u, FrustumCuller::BOUNDS_CHUNK * 2 + 5 }) {
+		testSpheres(culler, count);
+		testBoxes(culler, count);
+	}
+	culler.destroy();
+
+	// Mismo resultado repartiendo los bloques entre hilos.
+	JobSystem jobs;
+	jobs.init(4);
+	culler.init(&jobs);
+	makeFrustum(culler);
+	testSpheres(culler, FrustumCuller::BOUNDS_CHUNK * 5 + 17);
+	testBoxes(culler, FrustumCuller::BOUNDS_CHUNK * 5 + 17);
+	culler.destroy();
+	jobs.destroy();
+
+	return testResult("FrustumCullerTests");
+}
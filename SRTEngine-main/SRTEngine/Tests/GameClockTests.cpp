@@ -0,0 +1,216 @@
+#include "GameClock.h"
+#include "TestCommon.h"
+#include <algorithm>
+#include <random>
+
+// GameClock con un contador falso: pasos por tick en modo determinista (incluido el margen
+// de una millonésima de paso de step()), el límite de maxSteps conservando la fracción,
+// pausa, escala de tiempo, y el percentil 99 y el resto de estadísticas de frame.
+
+namespace {
+
+	struct FakeCounter {
+		int64_t nanoseconds = 1000000000;
+	};
+
+	int64_t readCounter(void* data) {
+		return static_cast<FakeCounter*>(data)->nanoseconds;
+	}
+
+	unsigned int steps(GameClock& clock) {
+		unsigned int count = 0;
+		while (clock.step())
+			++count;
+		return count;
+	}
+
+	// 1/144 s por tick: cada tick da justo un paso de 1/144 y 5 de cada 12 de 1/60.
+	void testDeterministicSteps() {
+		GameClock clock;
+		CHECK(SUCCEEDED(clock.init(1.0 / 144.0)));
+		clock.setDeterministic(true, 1.0 / 144.0);
+		CHECK(clock.isDeterministic());
+		bool everyTick = true;
+		for (int i = 0; i < 144 * 60; ++i) {
+			clock.tick();
+			everyTick &= steps(clock) == 1;
+		}
+		CHECK(everyTick);
+		CHECK_NEAR(clock.getTime(), 60.0, 1e-9);
+		CHECK(clock.getFrameCount() == 144 * 60);
+
+		CHECK(SUCCEEDED(clock.init(1.0 / 60.0)));
+		clock.setDeterministic(true, 1.0 / 144.0);
+		unsigned int total = 0;
+		bool exact = true, alphaInRange = true;
+		for (unsigned int tick = 1; tick <= 144 * 60; ++tick) {
+			clock.tick();
+			total += steps(clock);
+			exact &= total == tick * 5 / 12;
+			alphaInRange &= clock.getAlpha() >= 0.0f && clock.getAlpha() < 1.0f;
+		}
+		CHECK(exact && total == 60 * 60);
+		CHECK(alphaInRange);
+	}
+
+	// 144 frames de 1/144 s suman algo menos de 1 s en double; sin el margen de step() el
+	// último paso de 1 s se perdería hasta el frame siguiente.
+	void testEpsilon() {
+		double sum = 0.0;
+		for (int i = 0; i < 144; ++i)
+			sum += 1.0 / 144.0;
+		CHECK(sum < 1.0);
+
+		GameClock clock;
+		CHECK(SUCCEEDED(clock.init(1.0)));
+		clock.setDeterministic(true, 1.0 / 144.0);
+		unsigned int total = 0;
+		for (int i = 0; i < 143; ++i) {
+			clock.tick();
+			total += steps(clock);
+		}
+		CHECK(total == 0);
+		clock.tick();
+		CHECK(steps(clock) == 1);
+		// Y lo que queda no pasa a negativo.
+		CHECK(clock.getAlpha() >= 0.0f && clock.getAlpha() < 1e-5f);
+
+		// Un acumulado claramente por debajo del paso no da paso.
+		CHECK(SUCCEEDED(clock.init(1.0)));
+		clock.setDeterministic(true, 1.0 - 1e-5);
+		clock.tick();
+		CHECK(steps(clock) == 0);
+	}
+
+	// Un frame de 105 ms con pasos de 10 ms y maxSteps = 8: 8 pasos, se tiran 2 y se
+	// conserva el medio paso.
+	void testMaxSteps() {
+		GameClock clock;
+		CHECK(clock.init(0.01, 0) == E_INVALIDARG);
+		CHECK(clock.init(0.0, 8) == E_INVALIDARG);
+		CHECK(SUCCEEDED(clock.init(0.01, 8)));
+		clock.setDeterministic(true, 0.105);
+		clock.tick();
+		CHECK(steps(clock) == 8);
+		CHECK_NEAR(clock.getAlpha(), 0.5, 1e-6);
+		CHECK_NEAR(clock.getTime(), 0.08, 1e-12);
+
+		// Fuera del modo determinista, un frame de 2 s del contador tampoco pasa de maxSteps.
+		FakeCounter counter;
+		clock.setCounter(readCounter, &counter);
+		clock.setDeterministic(false);
+		CHECK(SUCCEEDED(clock.init(1.0 / 60.0, 4)));
+		counter.nanoseconds += 2000000000;
+		clock.tick();
+		CHECK(steps(clock) == 4);
+		CHECK_NEAR(clock.getFrameSeconds(), 2.0, 1e-9);
+		CHECK_NEAR(clock.getRealTime(), 2.0, 1e-9);
+		counter.nanoseconds += 16666667;
+		clock.tick();
+		CHECK(steps(clock) == 1);
+	}
+
+	void testPauseAndTimeScale() {
+		FakeCounter counter;
+		GameClock clock;
+		clock.setCounter(readCounter, &counter);
+		CHECK(SUCCEEDED(clock.init(0.01)));
+
+		// Tiempo real: 10 ms por frame.
+		auto frame = [&](int64_t nanoseconds) {
+			counter.nanoseconds += nanoseconds;
+			clock.tick();
+			return steps(clock);
+		};
+		CHECK(frame(10000000) == 1);
+		clock.setPaused(true);
+		CHECK(clock.isPaused());
+		unsigned int paused = 0;
+		for (int i = 0; i < 10; ++i)
+			paused += frame(10000000);
+		CHECK(paused == 0);
+		CHECK(clock.getFrameCount() == 11);
+		CHECK(clock.getFrameStats().frames == 11); // En pausa se siguen midiendo los frames
+		clock.setPaused(false);
+		CHECK(frame(10000000) == 1);
+
+		clock.setTimeScale(0.5);
+		unsigned int slow = 0;
+		for (int i = 0; i < 10; ++i)
+			slow += frame(10000000);
+		CHECK(slow == 5);
+		clock.setTimeScale(3.0);
+		CHECK(frame(10000000) == 3);
+		clock.setTimeScale(-1.0);
+		CHECK(clock.getTimeScale() == 0.0);
+		CHECK(frame(10000000) == 0);
+		// La escala no cambia el tiempo real medido.
+		CHECK_NEAR(clock.getFrameSeconds(), 0.01, 1e-9);
+		CHECK_NEAR(clock.getTime(), 0.01 * (1 + 1 + 5 + 3), 1e-9);
+	}
+
+	// Percentil 99 por rango: el valor en la posición ceil(0.99 * n) de los tiempos ordenados.
+	void testFrameStats() {
+		FakeCounter counter;
+		GameClock clock;
+		clock.setCounter(readCounter, &counter);
+		CHECK(SUCCEEDED(clock.init()));
+		CHECK(clock.getFrameStats().frames == 0);
+
+		auto runFrames = [&](const std::vector<int>& milliseconds) {
+			for (int ms : milliseconds) {
+				counter.nanoseconds += (int64_t)ms * 1000000;
+				clock.tick();
+			}
+		};
+		std::mt19937 random(9);
+
+		runFrames({ 7 });
+		GameClock::FrameStats stats = clock.getFrameStats();
+		CHECK(stats.frames == 1 && stats.p99Ms == 7.0 && stats.minMs == 7.0 && stats.maxMs == 7.0);
+
+		// 1..100 ms desordenados: p99 = 99 ms.
+		std::vector<int> frames;
+		for (int i = 1; i <= 100; ++i)
+			frames.push_back(i);
+		std::shuffle(frames.begin(), frames.end(), random);
+		clock.resetFrameStats();
+		runFrames(frames);
+		stats = clock.getFrameStats();
+		CHECK(stats.frames == 100);
+		CHECK_NEAR(stats.p99Ms, 99.0, 1e-4);
+		CHECK_NEAR(stats.minMs, 1.0, 1e-4);
+		CHECK_NEAR(stats.maxMs, 100.0, 1e-4);
+		CHECK_NEAR(stats.averageMs, 50.5, 1e-4);
+
+		// 101 frames: ceil(99.99) = 100, el segundo más lento.
+		clock.resetFrameStats();
+		frames.push_back(1000);
+		runFrames(frames);
+		CHECK_NEAR(clock.getFrameStats().p99Ms, 100.0, 1e-4);
+
+		// Con el historial lleno solo cuentan los últimos FRAME_HISTORY: 44 frames de 500 ms
+		// que ya no están y 256 de 1..256 ms, p99 = ceil(253.44) = 254 ms.
+		clock.resetFrameStats();
+		runFrames(std::vector<int>(44, 500));
+		frames.clear();
+		for (int i = 1; i <= (int)GameClock::FRAME_HISTORY; ++i)
+			frames.push_back(i);
+		std::shuffle(frames.begin(), frames.end(), random);
+		runFrames(frames);
+		stats = clock.getFrameStats();
+		CHECK(stats.frames == GameClock::FRAME_HISTORY);
+		CHECK_NEAR(stats.p99Ms, 254.0, 1e-3);
+		CHECK_NEAR(stats.maxMs, 256.0, 1e-3);
+	}
+}
+
+int
+main() {
+	testDeterministicSteps();
+	testEpsilon();
+	testMaxSteps();
+	testPauseAndTimeScale();
+	testFrameStats();
+	return testResult("GameClockTests");
+}
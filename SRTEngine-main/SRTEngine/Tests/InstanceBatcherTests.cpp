@@ -0,0 +1,140 @@
+#include "InstanceBatcher.h"
+#include "TestCommon.h"
+#include <cstring>
+
+// InstanceBatcher con una malla partida en varios tramos, como la de la demo: cada tramo es
+// una malla distinta y su índice va en userData. build() deja los lotes ordenados por malla y
+// material con sus instancias contiguas y en el orden de add(), cada lote conserva el
+// userData de su tramo, y la matriz de mundo que se lee de vuelta (descuantización * mundo)
+// sirve para llevar la cámara al espacio de la malla invirtiendo solo el mundo.
+
+namespace {
+
+	const unsigned int CHUNKS = 5;
+
+	Matrix loadWorld(const InstanceData& instance) {
+		Matrix world;
+		for (int row = 0; row < 4; ++row)
+			world.r[row] = VectorLoad(instance.world[row]);
+		return world;
+	}
+
+	// Mallas de los tramos: identificadores no consecutivos, como los de InstanceRenderer::addMesh
+	// después de registrar otras mallas.
+	uint32_t chunkMesh(unsigned int chunk) {
+		return 10 + chunk * 3;
+	}
+
+	Matrix objectWorld(unsigned int object) {
+		return MatrixMultiply(MatrixRotationY(object * 0.3f), MatrixTranslation((float)object, 0.5f * object, -2.0f));
+	}
+
+	// Objetos que recorren los tramos al revés y alternan dos materiales: el camino con copia.
+	void testChunks() {
+		InstanceBatcher batcher;
+		const unsigned int objects = 7;
+		for (unsigned int object = 0; object < objects; ++object) {
+			for (unsigned int i = 0; i < CHUNKS; ++i) {
+				const unsigned int chunk = CHUNKS - 1 - i;
+				const Float4 color = { (float)object, (float)chunk, (float)(object & 1), 1.0f };
+				batcher.add(chunkMesh(chunk), object & 1, objectWorld(object), color, chunk);
+			}
+		}
+		batcher.build();
+
+		const std::vector<InstanceBatcher::Batch>& batches = batcher.getBatches();
+		CHECK(batches.size() == CHUNKS * 2);
+		CHECK(batcher.getInstanceCount() == objects * CHUNKS);
+		bool sorted = true, userData = true, contiguous = true, order = true, contents = true;
+		unsigned int first = 0;
+		for (size_t b = 0; b < batches.size(); ++b) {
+			const InstanceBatcher::Batch& batch = batches[b];
+			if (b > 0) {
+				const InstanceBatcher::Batch& previous = batches[b - 1];
+				sorted &= previous.mesh < batch.mesh || (previous.mesh == batch.mesh && previous.material < batch.material);
+			}
+			// El tramo del lote se recupera de userData y coincide con su malla.
+			userData &= batch.userData < CHUNKS && chunkMesh(batch.userData) == batch.mesh;
+			contiguous &= batch.firstInstance == first && batch.instanceCount == (objects + 1 - batch.material) / 2;
+			first += batch.instanceCount;
+
+			float lastObject = -1.0f;
+			for (unsigned int i = 0; i < batch.instanceCount; ++i) {
+				const InstanceData& instance = batcher.getInstances()[batch.firstInstance + i];
+				order &= instance.color.x > lastObject;
+				lastObject = instance.color.x;
+				contents &= instance.color.y == (float)batch.userData && instance.color.z == (float)batch.material;
+				const Matrix expected = objectWorld((unsigned int)instance.color.x);
+				for (int row = 0; row < 4; ++row) {
+					Float4 value;
+					VectorStore(value, expected.r[row]);
+					contents &= memcmp(&value, &instance.world[row], sizeof(value)) == 0;
+				}
+			}
+		}
+		CHECK(sorted && userData && contiguous && order && contents);
+
+		// clear() deja el batcher listo para otro frame, ahora con los tramos ya en orden (sin copia).
+		batcher.clear();
+		CHECK(batcher.getBatches().empty() && batcher.getInstanceCount() == 0);
+		const Float4 white = { 1.0f, 1.0f, 1.0f, 1.0f };
+		for (unsigned int chunk = 0; chunk < CHUNKS; ++chunk) {
+			batcher.add(chunkMesh(chunk), 0, objectWorld(0), white, chunk);
+			batcher.add(chunkMesh(chunk), 0, objectWorld(1), white, chunk);
+		}
+		batcher.build();
+		CHECK(batcher.getBatches().size() == CHUNKS);
+		bool inOrder = true;
+		for (unsigned int chunk = 0; chunk < CHUNKS; ++chunk) {
+			const InstanceBatcher::Batch& batch = batcher.getBatches()[chunk];
+			inOrder &= batch.userData == chunk && batch.firstInstance == chunk * 2 && batch.instanceCount == 2;
+		}
+		CHECK(inOrder);
+	}
+
+	// Como en SRTEngine.cpp: la instancia guarda decode * mundo y la cámara en el espacio de la
+	// malla es eye * inverse(decode * mundo) * decode, que tiene que ser eye * inverse(mundo).
+	void testWorldInverse() {
+		const Matrix decode = MatrixMultiply(MatrixScaling(4.0f, 2.5f, 8.0f), MatrixTranslation(-2.0f, -1.0f, -3.5f));
+		InstanceBatcher batcher;
+		const Float4 white = { 1.0f, 1.0f, 1.0f, 1.0f };
+		for (unsigned int chunk = 0; chunk < CHUNKS; ++chunk)
+			batcher.add(chunkMesh(chunk), 0, MatrixMultiply(decode, objectWorld(chunk + 1)), white, chunk);
+		batcher.build();
+
+		const Vector eye = VectorSet(3.0f, 4.0f, -10.0f, 1.0f);
+		for (const InstanceBatcher::Batch& batch : batcher.getBatches()) {
+			const Matrix world = loadWorld(batcher.getInstances()[batch.firstInstance]);
+			float determinant = 0.0f;
+			const Matrix inverse = MatrixInverse(world, &determinant);
+			CHECK(std::fabs(determinant) > 1e-3f);
+
+			// inverse(world) * world es la identidad.
+			const Matrix identity = MatrixMultiply(inverse, world);
+			for (int row = 0; row < 4; ++row) {
+				CHECK_NEAR(VectorGetX(identity.r[row]), row == 0 ? 1.0 : 0.0, 1e-5);
+				CHECK_NEAR(VectorGetY(identity.r[row]), row == 1 ? 1.0 : 0.0, 1e-5);
+				CHECK_NEAR(VectorGetZ(identity.r[row]), row == 2 ? 1.0 : 0.0, 1e-5);
+				CHECK_NEAR(VectorGetW(identity.r[row]), row == 3 ? 1.0 : 0.0, 1e-5);
+			}
+
+			const Vector localEye = Vector3Transform(eye, MatrixMultiply(inverse, decode));
+			const Vector expected = Vector3Transform(eye, MatrixInverse(objectWorld(batch.userData + 1)));
+			CHECK_NEAR(VectorGetX(localEye), VectorGetX(expected), 1e-4);
+			CHECK_NEAR(VectorGetY(localEye), VectorGetY(expected), 1e-4);
+			CHECK_NEAR(VectorGetZ(localEye), VectorGetZ(expected), 1e-4);
+			// Y de vuelta al mundo se recupera la cámara.
+			const Vector back = Vector3Transform(localEye, objectWorld(batch.userData + 1));
+			CHECK_NEAR(VectorGetX(back), 3.0, 1e-4);
+			CHECK_NEAR(VectorGetY(back), 4.0, 1e-4);
+			CHECK_NEAR(VectorGetZ(back), -10.0, 1e-4);
+		}
+	}
+}
+
+int
+main() {
+	testChunks();
+	testWorldInverse();
+	return testResult("InstanceBatcherTests");
+}
@@ -0,0 +1,251 @@
+#include "JobSystem.h"
+#include "TestCommon.h"
+#include <thread>
+
+// run, runAfter y parallelFor, también desde un hilo que no es del sistema y desde dentro de
+// un trabajo. Los datos que se pasan de una etapa a otra son variables normales, no atómicas:
+// compilado con -DSRT_ENABLE_TSAN=ON, ThreadSanitizer avisa si falta alguna relación
+// happens-before entre el final de un trabajo y quien lo espera o depende de él.
+
+namespace {
+
+	struct Slots {
+		std::vector<unsigned int> values;
+		std::atomic<unsigned int> calls{ 0 };
+	};
+
+	void markSlot(void* data, unsigned int index) {
+		Slots& slots = *static_cast<Slots*>(data);
+		slots.values[index] += index + 1;
+		slots.calls.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	bool allMarked(const Slots& slots, unsigned int times) {
+		for (unsigned int i = 0; i < slots.values.size(); ++i) {
+			if (slots.values[i] != (i + 1) * times)
+				return false;
+		}
+		return true;
+	}
+
+	void testRun(JobSystem& jobs) {
+		for (unsigned int count : { 1u, 2u, 7u, 1000u }) {
+			Slots slots;
+			slots.values.assign(count, 0);
+			JobCounter counter;
+			jobs.run(markSlot, &slots, count, &counter);
+			jobs.wait(counter);
+			CHECK(counter.isDone());
+			CHECK(slots.calls.load() == count);
+			CHECK(allMarked(slots, 1));
+		}
+
+		// Sin trabajos el contador no se toca y wait() vuelve enseguida.
+		JobCounter empty;
+		jobs.run(markSlot, nullptr, 0, &empty);
+		jobs.wait(empty);
+		CHECK(empty.isDone());
+	}
+
+	// Cada etapa lee lo que escribió la anterior, así que solo puede empezar cuando esa termina.
+	struct Pipeline {
+		static const unsigned int WIDTH = 64;
+		static const unsigned int STAGES = 8;
+		unsigned int values[STAGES][WIDTH] = {};
+		unsigned int stage[STAGES] = {};
+	};
+
+	void firstStage(void* data, unsigned int index) {
+		static_cast<Pipeline*>(data)->values[0][index] = index;
+	}
+
+	template <unsigned int Stage>
+	void nextStage(void* data, unsigned int index) {
+		Pipeline& pipeline = *static_cast<Pipeline*>(data);
+		unsigned int sum = 0;
+		for (unsigned int i = 0; i < Pipeline::WIDTH; ++i)
+			sum += pipeline.values[Stage - 1][i];
+		pipeline.values[Stage][index] = sum + index;
+	}
+
+	void testRunAfter(JobSystem& jobs) {
+		static const JobFunction stages[Pipeline::STAGES] = {
+			firstStage, nextStage<1>, nextStage<2>, nextStage<3>,
+			nextStage<4>, nextStage<5>, nextStage<6>, nextStage<7>
+		};
+
+		Pipeline pipeline;
+		JobCounter counters[Pipeline::STAGES];
+		// Se encola todo antes de que termine nada; las etapas se desbloquean en cadena.
+		jobs.run(stages[0], &pipeline, Pipeline::WIDTH, &counters[0]);
+		for (unsigned int s = 1; s < Pipeline::STAGES; ++s)
+			jobs.runAfter(counters[s - 1], stages[s], &pipeline, Pipeline::WIDTH, &counters[s]);
+		jobs.wait(counters[Pipeline::STAGES - 1]);
+		for (unsigned int s = 0; s < Pipeline::STAGES - 1; ++s)
+			CHECK(counters[s].isDone());
+
+		unsigned int expected[Pipeline::WIDTH];
+		for (unsigned int i = 0; i < Pipeline::WIDTH; ++i)
+			expected[i] = i;
+		for (unsigned int s = 1; s < Pipeline::STAGES; ++s) {
+			unsigned int sum = 0;
+			for (unsigned int i = 0; i < Pipeline::WIDTH; ++i)
+				sum += expected[i];
+			for (unsigned int i = 0; i < Pipeline::WIDTH; ++i)
+				expected[i] = sum + i;
+		}
+		bool same = true;
+		for (unsigned int i = 0; i < Pipeline::WIDTH; ++i)
+			same = same && pipeline.values[Pipeline::STAGES - 1][i] == expected[i];
+		CHECK(same);
+
+		// Si la dependencia ya terminó, runAfter() encola en el momento.
+		Slots slots;
+		slots.values.assign(16, 0);
+		JobCounter done, after;
+		jobs.runAfter(done, markSlot, &slots, 16, &after);
+		jobs.wait(after);
+		CHECK(allMarked(slots, 1));
+
+		// Varios lotes esperando al mismo contador.
+		Slots first, second;
+		first.values.assign(100, 0);
+		second.values.assign(100, 0);
+		JobCounter root, both;
+		jobs.run(markSlot, &first, 100, &root);
+		jobs.runAfter(root, markSlot, &second, 100, &both);
+		jobs.runAfter(root, markSlot, &first, 100, &both);
+		jobs.wait(both);
+		CHECK(allMarked(first, 2));
+		CHECK(allMarked(second, 1));
+	}
+
+	void testParallelFor(JobSystem& jobs) {
+		for (unsigned int count : { 0u, 1u, 5u, 1000u, 4097u }) {
+			for (unsigned int grain : { 0u, 1u, 64u, 10000u }) {
+				std::vector<unsigned int> touched(count, 0);
+				std::atomic<unsigned int> ranges{ 0 };
+				jobs.parallelFor(count, grain, [&](unsigned int begin, unsigned int end) {
+					CHECK(begin < end && end <= count);
+					for (unsigned int i = begin; i < end; ++i)
+						++touched[i];
+					ranges.fetch_add(1, std::memory_order_relaxed);
+				});
+				bool once = true;
+				for (unsigned int value : touched)
+					once = once && value == 1;
+				CHECK(once);
+				CHECK(count == 0 || ranges.load() >= 1);
+			}
+		}
+
+		// parallelFor dentro de un trabajo: wait() ejecuta trabajos en lugar de bloquear.
+		struct Nested {
+			JobSystem* jobs;
+			std::vector<unsigned int> sums;
+		};
+		Nested nested{ &jobs, std::vector<unsigned int>(8, 0) };
+		JobCounter counter;
+		jobs.run([](void* data, unsigned int index) {
+				Nested& n = *static_cast<Nested*>(data);
+				std::vector<unsigned int> values(256, 0);
+				n.jobs->parallelFor(256, 16, [&](unsigned int begin, unsigned int end) {
+					for (unsigned int i = begin; i < end; ++i)
+						values[i] = i;
+				});
+				unsigned int sum = 0;
+				for (unsigned int value : values)
+					sum += value;
+				n.sums[index] = sum;
+			}, &nested, 8, &counter);
+		jobs.wait(counter);
+		bool sums = true;
+		for (unsigned int sum : nested.sums)
+			sums = sums && sum == 255 * 256 / 2;
+		CHECK(sums);
+	}
+
+	// Hilos que no son del sistema usan la cola 0 a la vez que el hilo principal.
+	void testForeignThreads(JobSystem& jobs) {
+		const unsigned int THREADS = 3;
+		std::vector<Slots> slots(THREADS + 1);
+		std::vector<std::vector<unsigned int>> ranges(THREADS + 1, std::vector<unsigned int>(2000, 0));
+		auto work = [&](unsigned int t) {
+			slots[t].values.assign(500, 0);
+			for (int round = 0; round < 4; ++round) {
+				JobCounter counter, after;
+				jobs.run(markSlot, &slots[t], 500, &counter);
+				jobs.runAfter(counter, markSlot, &slots[t], 500, &after);
+				jobs.wait(after);
+				jobs.parallelFor(2000, 100, [&](unsigned int begin, unsigned int end) {
+					for (unsigned int i = begin; i < end; ++i)
+						++ranges[t][i];
+				});
+			}
+		};
+		std::vector<std::thread> threads;
+		for (unsigned int t = 0; t < THREADS; ++t)
+			threads.emplace_back(work, t);
+		work(THREADS);
+		for (std::thread& thread : threads)
+			thread.join();
+
+		for (unsigned int t = 0; t <= THREADS; ++t) {
+			CHECK(allMarked(slots[t], 8));
+			bool all = true;
+			for (unsigned int value : ranges[t])
+				all = all && value == 4;
+			CHECK(all);
+		}
+	}
+
+	void testWithoutInit() {
+		JobSystem jobs;
+		Slots slots;
+		slots.values.assign(10, 0);
+		JobCounter counter, after;
+		jobs.run(markSlot, &slots, 10, &counter);
+		CHECK(counter.isDone());
+		jobs.runAfter(counter, markSlot, &slots, 10, &after);
+		CHECK(after.isDone());
+		CHECK(allMarked(slots, 2));
+		unsigned int total = 0;
+		jobs.parallelFor(100, 10, [&](unsigned int begin, unsigned int end) { total += end - begin; });
+		CHECK(total == 100);
+	}
+}
+
+int
+main() {
+	testWithoutInit();
+
+	for (unsigned int threads : { 1u, 2u, 4u }) {
+		JobSystem jobs;
+		jobs.init(threads);
+		CHECK(jobs.getThreadCount() == threads);
+		testRun(jobs);
+		testRunAfter(jobs);
+		testParallelFor(jobs);
+		testForeignThreads(jobs);
+		const JobSystem::Stats stats = jobs.getStats();
+		CHECK(stats.executed > 0);
+		CHECK(threads > 1 || stats.stolen == 0);
+		jobs.destroy();
+		CHECK(jobs.getThreadCount() == 0);
+	}
+
+	// init() y destroy() repetidos no dejan hilos ni trabajos atrás.
+	JobSystem jobs;
+	for (int i = 0; i < 20; ++i) {
+		jobs.init(3);
+		Slots slots;
+		slots.values.assign(50, 0);
+		JobCounter counter;
+		jobs.run(markSlot, &slots, 50, &counter);
+		jobs.wait(counter);
+		CHECK(allMarked(slots, 1));
+		jobs.destroy();
+	}
+
+	return testResult("JobSystemTests");
+}
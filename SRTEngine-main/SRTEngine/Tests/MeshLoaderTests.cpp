@@ -0,0 +1,298 @@
+#include "MeshLoader.h"
+#include "TestCommon.h"
+#include <cstring>
+#include <string>
+
+// MeshLoader sobre textos pequeños en memoria. OBJ: índices negativos, polígonos en abanico,
+// caras sin UV o con normales (que se ignoran), unificación por par (posición, UV) y la
+// conversión a mano izquierda (z negada y V invertida); un archivo de varios MB que se parte
+// en tramos da lo mismo en serie y en paralelo y con índices relativos o absolutos. glTF: un
+// búfer base64 y un .glb con atributos sin UV y con NORMAL, la transformación del nodo y los
+// errores del JSON, los accessors y los índices. Todo lo que está mal formado da E_FAIL.
+
+namespace {
+
+	HRESULT parseObj(MeshLoader& loader, const std::string& text, MeshData& mesh) {
+		return loader.parseObj(reinterpret_cast<const uint8_t*>(text.data()), text.size(), mesh);
+	}
+
+	HRESULT parseGltf(MeshLoader& loader, const std::string& text, MeshData& mesh) {
+		return loader.parseGltf(reinterpret_cast<const uint8_t*>(text.data()), text.size(), "", mesh);
+	}
+
+	bool sameIndices(const MeshData& mesh, std::initializer_list<uint32_t> indices) {
+		return mesh.indices.size() == indices.size() && std::equal(indices.begin(), indices.end(), mesh.indices.begin());
+	}
+
+	bool sameMesh(const MeshData& a, const MeshData& b) {
+		return a.indices == b.indices && a.vertices.size() == b.vertices.size() &&
+			memcmp(a.vertices.data(), b.vertices.data(), a.vertices.size() * sizeof(MeshVertex)) == 0;
+	}
+
+	void checkVertex(const MeshVertex& vertex, float x, float y, float z, float u, float v) {
+		CHECK(vertex.position.x == x && vertex.position.y == y && vertex.position.z == z);
+		CHECK(vertex.texCoord.x == u && vertex.texCoord.y == v);
+	}
+
+	const char* QUAD_OBJ =
+		"# Cuadrado en z = 2\n"
+		"v 0 0 2\nv 1 0 2\nv 1 1 2\nv 0 1 2\n"
+		"vt 0 0\nvt 1 0\nvt 1 1\nvt 0 1\n"
+		"f 1/1 2/2 3/3 4/4\n";
+
+	// Un cuadrado se parte en dos triángulos en abanico; z y V cambian de signo y origen.
+	void testObjQuad() {
+		MeshLoader loader;
+		loader.init();
+		MeshData mesh;
+		CHECK(parseObj(loader, QUAD_OBJ, mesh) == S_OK);
+		CHECK(mesh.vertices.size() == 4);
+		CHECK(sameIndices(mesh, { 0, 1, 2, 0, 2, 3 }));
+		checkVertex(mesh.vertices[0], 0.0f, 0.0f, -2.0f, 0.0f, 1.0f);
+		checkVertex(mesh.vertices[2], 1.0f, 1.0f, -2.0f, 1.0f, 0.0f);
+		CHECK(mesh.boundsMin.z == -2.0f && mesh.boundsMax.x == 1.0f && mesh.boundsMax.y == 1.0f);
+		CHECK(loader.getStats().triangles == 2 && loader.getStats().sourceVertices == 6 && loader.getStats().vertices == 4);
+
+		// Un pentágono da tres triángulos alrededor de la primera esquina.
+		CHECK(parseObj(loader, "v 0 0 0\nv 1 0 0\nv 2 1 0\nv 1 2 0\nv 0 1 0\nf 1 2 3 4 5\n", mesh) == S_OK);
+		CHECK(sameIndices(mesh, { 0, 1, 2, 0, 2, 3, 0, 3, 4 }));
+	}
+
+	// -1 es el último vértice leído hasta la cara: la misma cara con índices negativos reutiliza
+	// los vértices.
+	void testObjNegativeIndices() {
+		MeshLoader loader;
+		loader.init();
+		MeshData mesh;
+		CHECK(parseObj(loader, std::string(QUAD_OBJ) + "f -4/-4 -3/-3 -2/-2 -1/-1\n", mesh) == S_OK);
+		CHECK(mesh.vertices.size() == 4);
+		CHECK(sameIndices(mesh, { 0, 1, 2, 0, 2, 3, 0, 1, 2, 0, 2, 3 }));
+
+		// Relativos a lo leído hasta la cara, no al final del archivo.
+		CHECK(parseObj(loader, "v 0 0 0\nv 1 0 0\nv 0 1 0\nf -3 -2 -1\nv 5 5 5\nf -4 -3 -1\n", mesh) == S_OK);
+		CHECK(sameIndices(mesh, { 0, 1, 2, 0, 1, 3 }));
+		checkVertex(mesh.vertices[3], 5.0f, 5.0f, -5.0f, 0.0f, 0.0f);
+	}
+
+	// Sin UV (con o sin normal) la UV es (0, 0); las normales y otras líneas se ignoran. La
+	// misma posición con dos UV distintas da dos vértices.
+	void testObjMissingAttributes() {
+		MeshLoader loader;
+		loader.init();
+		MeshData mesh;
+		const char* text =
+			"o sinNormales\ng grupo\ns off\nusemtl gris\n"
+			"v 0 0 0\nv 1 0 0\nv 0 1 0\n"
+			"vn 0 0 1\n"
+			"f 1//1 2//1 3//1\n"
+			"f 1 2 3 # sin nada\n";
+		CHECK(parseObj(loader, text, mesh) == S_OK);
+		CHECK(mesh.vertices.size() == 3);
+		CHECK(sameIndices(mesh, { 0, 1, 2, 0, 1, 2 }));
+		checkVertex(mesh.vertices[1], 1.0f, 0.0f, -0.0f, 0.0f, 0.0f);
+
+		CHECK(parseObj(loader, "v 0 0 0\nv 1 0 0\nv 0 1 0\nvt 0 0\nvt 0.5\nf 1/1 2/1 3/1\nf 1/2 2/1 3/1\n", mesh) == S_OK);
+		CHECK(mesh.vertices.size() == 4);
+		CHECK(sameIndices(mesh, { 0, 1, 2, 3, 1, 2 }));
+		checkVertex(mesh.vertices[3], 0.0f, 0.0f, -0.0f, 0.5f, 1.0f); // La v que falta es 0
+	}
+
+	void testObjMalformed() {
+		MeshLoader loader;
+		loader.init();
+		MeshData mesh;
+		CHECK(parseObj(loader, "", mesh) == E_INVALIDARG);
+		const char* malformed[] = {
+			"v 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n",       // Falta z
+			"v a b c\nf 1 1 1\n",                        // No es un número
+			"v 0 0 0\nv 1 0 0\nf 1 2\n",                 // Cara de dos esquinas
+			"v 0 0 0\nv 1 0 0\nv 0 1 0\nf 0 1 2\n",      // El 0 no es un índice
+			"v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 4\n",      // Fuera de rango
+			"v 0 0 0\nv 1 0 0\nv 0 1 0\nf -4 -2 -1\n",   // Negativo antes del primer vértice
+			"v 0 0 0\nv 1 0 0\nv 0 1 0\nvt 0 0\nf 1/2 2/1 3/1\n", // UV fuera de rango
+			"v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1/x 2 3\n",    // UV que no es un número
+			"v 0 0 0\nv 1 0 0\nv 0 1 0\n",               // Sin caras
+		};
+		for (const char* text : malformed) {
+			CHECK(parseObj(loader, text, mesh) == E_FAIL);
+		}
+	}
+
+	// Rejilla de side x side vértices. Con relative, la mitad de las filas de caras usan
+	// índices negativos, que en los tramos del medio apuntan a vértices de tramos anteriores.
+	std::string gridObj(unsigned int side, bool relative) {
+		std::string text;
+		char line[128];
+		for (unsigned int row = 0; row < side; ++row) {
+			for (unsigned int column = 0; column < side; ++column) {
+				snprintf(line, sizeof(line), "v %u %u %.3f\nvt %.6f %.6f\n", column, row, (column * row % 17) * 0.25f,
+					(float)column / side, (float)row / side);
+				text += line;
+			}
+			if (row == 0)
+				continue;
+			const int count = (int)((row + 1) * side);
+			for (unsigned int column = 0; column + 1 < side; ++column) {
+				int corners[4] = { (int)((row - 1) * side + column + 1), (int)((row - 1) * side + column + 2),
+					(int)(row * side + column + 2), (int)(row * side + column + 1) };
+				if (relative && (row & 1)) {
+					for (int& corner : corners)
+						corner -= count + 1;
+				}
+				snprintf(line, sizeof(line), "f %d/%d %d/%d %d/%d %d/%d\n", corners[0], corners[0], corners[1], corners[1],
+					corners[2], corners[2], corners[3], corners[3]);
+				text += line;
+			}
+		}
+		return text;
+	}
+
+	void testObjChunks() {
+		const unsigned int side = 300;
+		const std::string relative = gridObj(side, true);
+		const std::string absolute = gridObj(side, false);
+		CHECK(relative.size() > 4 * (1 << 20)); // Varios tramos incluso sin hilos
+
+		MeshLoader serial;
+		serial.init();
+		MeshData serialMesh, absoluteMesh;
+		CHECK(parseObj(serial, relative, serialMesh) == S_OK);
+		CHECK(serialMesh.vertices.size() == side * side);
+		CHECK(serialMesh.indices.size() == (side - 1) * (side - 1) * 6);
+		CHECK(parseObj(serial, absolute, absoluteMesh) == S_OK);
+		CHECK(sameMesh(serialMesh, absoluteMesh));
+
+		JobSystem jobs;
+		CHECK(SUCCEEDED(jobs.init(4)));
+		MeshLoader parallel;
+		parallel.init(&jobs);
+		MeshData parallelMesh;
+		CHECK(parseObj(parallel, relative, parallelMesh) == S_OK);
+		CHECK(sameMesh(serialMesh, parallelMesh));
+		jobs.destroy();
+	}
+
+	std::string base64(const std::vector<uint8_t>& bytes) {
+		const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+		std::string text;
+		for (size_t i = 0; i < bytes.size(); i += 3) {
+			const uint32_t value = (uint32_t)bytes[i] << 16 | (i + 1 < bytes.size() ? (uint32_t)bytes[i + 1] << 8 : 0) |
+				(i + 2 < bytes.size() ? bytes[i + 2] : 0);
+			text += alphabet[value >> 18];
+			text += alphabet[(value >> 12) & 63];
+			text += i + 1 < bytes.size() ? alphabet[(value >> 6) & 63] : '=';
+			text += i + 2 < bytes.size() ? alphabet[value & 63] : '=';
+		}
+		return text;
+	}
+
+	template <typename T>
+	void append(std::vector<uint8_t>& bytes, std::initializer_list<T> values) {
+		for (T value : values) {
+			const uint8_t* p = reinterpret_cast<const uint8_t*>(&value);
+			bytes.insert(bytes.end(), p, p + sizeof(T));
+		}
+	}
+
+	// Cuadrado con posiciones (vista 0), normales (1), UV (2) e índices de 16 bits (3).
+	std::vector<uint8_t> quadBuffer(uint16_t lastIndex) {
+		std::vector<uint8_t> bytes;
+		append<float>(bytes, { 0, 0, 0, 1, 0, 0, 1, 1, 0, 0, 1, 0 });
+		append<float>(bytes, { 0, 0, 1, 0, 0, 1, 0, 0, 1, 0, 0, 1 });
+		append<float>(bytes, { 0, 0, 1, 0, 1, 1, 0, 1 });
+		append<uint16_t>(bytes, { 0, 1, 2, 0, 2, lastIndex });
+		return bytes;
+	}
+
+	// uri vacío = el búfer es el trozo BIN de un .glb.
+	std::string quadJson(const std::string& uri, const char* attributes, unsigned int bufferLength,
+		unsigned int indexViewLength = 12) {
+		return std::string("{\"asset\":{\"version\":\"2.0\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],") +
+			"\"nodes\":[{\"mesh\":0,\"translation\":[0,0,5]}],"
+			"\"meshes\":[{\"primitives\":[{\"attributes\":" + attributes + ",\"indices\":3}]}],"
+			"\"buffers\":[{" + (uri.empty() ? std::string() : "\"uri\":\"" + uri + "\",") +
+			"\"byteLength\":" + std::to_string(bufferLength) + "}],"
+			"\"bufferViews\":[{\"buffer\":0,\"byteOffset\":0,\"byteLength\":48},{\"buffer\":0,\"byteOffset\":48,\"byteLength\":48},"
+			"{\"buffer\":0,\"byteOffset\":96,\"byteLength\":32},{\"buffer\":0,\"byteOffset\":128,\"byteLength\":" +
+			std::to_string(indexViewLength) + "}],"
+			"\"accessors\":[{\"bufferView\":0,\"componentType\":5126,\"count\":4,\"type\":\"VEC3\"},"
+			"{\"bufferView\":1,\"componentType\":5126,\"count\":4,\"type\":\"VEC3\"},"
+			"{\"bufferView\":2,\"componentType\":5126,\"count\":4,\"type\":\"VEC2\"},"
+			"{\"bufferView\":3,\"componentType\":5123,\"count\":6,\"type\":\"SCALAR\"}]}";
+	}
+
+	std::string dataUri(const std::vector<uint8_t>& bytes) {
+		return "data:application/octet-stream;base64," + base64(bytes);
+	}
+
+	std::string glb(std::string json, const std::vector<uint8_t>& binary) {
+		while (json.size() % 4)
+			json += ' ';
+		std::vector<uint8_t> bytes;
+		append<uint32_t>(bytes, { 0x46546C67u, 2u, (uint32_t)(12 + 8 + json.size() + 8 + binary.size()) });
+		append<uint32_t>(bytes, { (uint32_t)json.size(), 0x4E4F534Au });
+		bytes.insert(bytes.end(), json.begin(), json.end());
+		append<uint32_t>(bytes, { (uint32_t)binary.size(), 0x004E4942u });
+		bytes.insert(bytes.end(), binary.begin(), binary.end());
+		return std::string(bytes.begin(), bytes.end());
+	}
+
+	void testGltf() {
+		MeshLoader loader;
+		loader.init();
+		MeshData mesh;
+		const std::vector<uint8_t> buffer = quadBuffer(3);
+		const unsigned int length = (unsigned int)buffer.size();
+
+		// Sin UV y con normales: la UV es (0, 0) y la normal no se lee. El nodo mueve z a 5.
+		CHECK(parseGltf(loader, quadJson(dataUri(buffer), "{\"POSITION\":0,\"NORMAL\":1}", length), mesh) == S_OK);
+		CHECK(mesh.vertices.size() == 4);
+		CHECK(sameIndices(mesh, { 0, 1, 2, 0, 2, 3 }));
+		checkVertex(mesh.vertices[2], 1.0f, 1.0f, -5.0f, 0.0f, 0.0f);
+		CHECK(loader.getStats().triangles == 2 && loader.getStats().sourceVertices == 4);
+
+		// Con UV (la V de glTF ya tiene el origen arriba), y desde un .glb.
+		CHECK(parseGltf(loader, glb(quadJson("", "{\"POSITION\":0,\"TEXCOORD_0\":2}", length), buffer), mesh) == S_OK);
+		CHECK(sameIndices(mesh, { 0, 1, 2, 0, 2, 3 }));
+		checkVertex(mesh.vertices[1], 1.0f, 0.0f, -5.0f, 1.0f, 0.0f);
+		checkVertex(mesh.vertices[3], 0.0f, 1.0f, -5.0f, 0.0f, 1.0f);
+	}
+
+	void testGltfMalformed() {
+		MeshLoader loader;
+		loader.init();
+		MeshData mesh;
+		const std::vector<uint8_t> buffer = quadBuffer(3);
+		const unsigned int length = (unsigned int)buffer.size();
+		const char* position = "{\"POSITION\":0}";
+
+		CHECK(parseGltf(loader, "", mesh) == E_INVALIDARG);
+		const std::string malformed[] = {
+			"{\"asset\":{\"version\":\"2.0\"},\"meshes\":[",                             // JSON cortado
+			quadJson(dataUri(buffer), "{\"NORMAL\":1}", length),                         // Sin POSITION
+			quadJson(dataUri(buffer), "{\"POSITION\":2}", length),                       // POSITION que no es VEC3
+			quadJson(dataUri(buffer), "{\"POSITION\":0,\"TEXCOORD_0\":1}", length),      // UV que no es VEC2
+			quadJson(dataUri(quadBuffer(4)), position, length),                          // Índice fuera de rango
+			quadJson(dataUri(buffer), position, length, 64),                             // Vista más allá del búfer
+			quadJson(dataUri(buffer), position, length + 4),                             // Búfer más corto que byteLength
+			quadJson("data:application/octet-stream;base64,@@@@", position, length),     // base64 inválido
+			glb(quadJson("", position, length), buffer).substr(0, 40),                   // .glb cortado
+		};
+		for (const std::string& text : malformed) {
+			CHECK(parseGltf(loader, text, mesh) == E_FAIL);
+			CHECK(mesh.indices.empty());
+		}
+	}
+}
+
+int
+main() {
+	testObjQuad();
+	testObjNegativeIndices();
+	testObjMissingAttributes();
+	testObjMalformed();
+	testObjChunks();
+	testGltf();
+	testGltfMalformed();
+	return testResult("MeshLoaderTests");
+}
@@ -0,0 +1,213 @@
+#include "MeshOptimizer.h"
+#include "TestCommon.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <random>
+
+// MeshOptimizer sobre una rejilla: Tipsify baja el ACMR desde el orden por filas y desde un
+// orden al azar, cada paso deja los mismos triángulos (con su sentido) en otro orden, y la
+// renumeración para la lectura de vértices conserva la geometría, numera por primer uso y
+// quita los vértices sin usar.
+
+namespace {
+
+	typedef std::array<uint32_t, 3> Triangle;
+
+	// Rejilla de side x side vértices con un relieve para que el paso de overdraw tenga normales distintas.
+	MeshData makeGrid(unsigned int side) {
+		MeshData mesh;
+		for (unsigned int y = 0; y < side; ++y) {
+			for (unsigned int x = 0; x < side; ++x) {
+				MeshVertex vertex;
+				vertex.position = Float3((float)x, (float)y, std::sin(x * 0.3f) * std::cos(y * 0.2f) * 3.0f);
+				vertex.texCoord = Float2((float)x / side, (float)y / side);
+				mesh.vertices.push_back(vertex);
+			}
+		}
+		for (unsigned int y = 0; y + 1 < side; ++y) {
+			for (unsigned int x = 0; x + 1 < side; ++x) {
+				const uint32_t a = y * side + x, b = a + 1, c = a + side + 1, d = a + side;
+				for (uint32_t index : { a, b, c, a, c, d })
+					mesh.indices.push_back(index);
+			}
+		}
+		return mesh;
+	}
+
+	void shuffleTriangles(MeshData& mesh, unsigned int seed) {
+		std::vector<Triangle> triangles(mesh.indices.size() / 3);
+		memcpy(triangles.data(), mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+		std::mt19937 random(seed);
+		std::shuffle(triangles.begin(), triangles.end(), random);
+		memcpy(mesh.indices.data(), triangles.data(), mesh.indices.size() * sizeof(uint32_t));
+	}
+
+	// Triángulos girados para empezar por el menor índice (conserva el sentido) y ordenados.
+	std::vector<Triangle> canonical(const std::vector<uint32_t>& indices) {
+		std::vector<Triangle> triangles;
+		for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+			Triangle triangle = { indices[i], indices[i + 1], indices[i + 2] };
+			std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end()), triangle.end());
+			triangles.push_back(triangle);
+		}
+		std::sort(triangles.begin(), triangles.end());
+		return triangles;
+	}
+
+	// Lo mismo con los vértices en vez de los índices, para comparar antes y después de renumerar.
+	typedef std::array<MeshVertex, 3> Corners;
+
+	bool lessVertex(const MeshVertex& a, const MeshVertex& b) {
+		return memcmp(&a, &b, sizeof(MeshVertex)) < 0;
+	}
+
+	std::vector<Corners> geometry(const MeshData& mesh) {
+		std::vector<Corners> triangles;
+		for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3) {
+			Corners corners = { mesh.vertices[mesh.indices[i]], mesh.vertices[mesh.indices[i + 1]], mesh.vertices[mesh.indices[i + 2]] };
+			std::rotate(corners.begin(), std::min_element(corners.begin(), corners.end(), lessVertex), corners.end());
+			triangles.push_back(corners);
+		}
+		std::sort(triangles.begin(), triangles.end(), [](const Corners& a, const Corners& b) {
+			return memcmp(a.data(), b.data(), sizeof(Corners)) < 0;
+		});
+		return triangles;
+	}
+
+	bool sameGeometry(const MeshData& a, const MeshData& b) {
+		const std::vector<Corners> first = geometry(a), second = geometry(b);
+		return first.size() == second.size() && memcmp(first.data(), second.data(), first.size() * sizeof(Corners)) == 0;
+	}
+
+	void testAnalyze() {
+		const uint32_t one[] = { 0, 1, 2 };
+		MeshOptimizer::CacheStats stats = MeshOptimizer::analyzeVertexCache(one, 3, 3);
+		CHECK(stats.acmr == 3.0f && stats.atvr == 1.0f);
+		const uint32_t twice[] = { 0, 1, 2, 2, 1, 0 };
+		stats = MeshOptimizer::analyzeVertexCache(twice, 6, 3);
+		CHECK(stats.acmr == 1.5f && stats.atvr == 1.0f);
+		// Con caché de 3, el cuarto vértice expulsa al primero.
+		const uint32_t evict[] = { 0, 1, 2, 1, 2, 3, 0, 1, 3 };
+		CHECK(MeshOptimizer::analyzeVertexCache(evict, 9, 4, 3).acmr == 6.0f / 3.0f);
+		CHECK(MeshOptimizer::analyzeVertexCache(evict, 9, 4, 4).acmr == 4.0f / 3.0f);
+	}
+
+	// Tipsify en la rejilla por filas (cada vértice se transforma dos veces: ACMR cerca de 1) y al
+	// azar (casi cada esquina falla): los dos bajan hacia el 0.5 ideal y salen los mismos triángulos.
+	void testVertexCache() {
+		const unsigned int side = 65;
+		for (bool shuffled : { false, true }) {
+			MeshData mesh = makeGrid(side);
+			if (shuffled)
+				shuffleTriangles(mesh, 5);
+			const std::vector<Triangle> before = canonical(mesh.indices);
+			const float acmrBefore = MeshOptimizer::analyzeVertexCache(mesh.indices.data(), mesh.indices.size(),
+				(unsigned int)mesh.vertices.size()).acmr;
+			MeshOptimizer::optimizeVertexCache(mesh.indices.data(), mesh.indices.size(), (unsigned int)mesh.vertices.size());
+			const MeshOptimizer::CacheStats after = MeshOptimizer::analyzeVertexCache(mesh.indices.data(),
+				mesh.indices.size(), (unsigned int)mesh.vertices.size());
+			CHECK(acmrBefore > (shuffled ? 2.0f : 0.95f));
+			CHECK(after.acmr < 0.8f && after.acmr < acmrBefore);
+			CHECK(after.atvr >= 1.0f && after.atvr < 1.6f);
+			CHECK(canonical(mesh.indices) == before);
+		}
+
+		// Con una caché más grande el resultado no empeora.
+		MeshData mesh = makeGrid(side);
+		shuffleTriangles(mesh, 9);
+		std::vector<uint32_t> small = mesh.indices;
+		MeshOptimizer::optimizeVertexCache(small.data(), small.size(), (unsigned int)mesh.vertices.size(), 8);
+		MeshOptimizer::optimizeVertexCache(mesh.indices.data(), mesh.indices.size(), (unsigned int)mesh.vertices.size(), 32);
+		CHECK(MeshOptimizer::analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), (unsigned int)mesh.vertices.size(), 32).acmr <=
+			MeshOptimizer::analyzeVertexCache(small.data(), small.size(), (unsigned int)mesh.vertices.size(), 8).acmr);
+		CHECK(canonical(small) == canonical(mesh.indices));
+	}
+
+	// El paso de overdraw mueve grupos enteros: mismos triángulos y el ACMR acotado por el umbral.
+	void testOverdraw() {
+		MeshData mesh = makeGrid(65);
+		shuffleTriangles(mesh, 3);
+		const std::vector<Triangle> before = canonical(mesh.indices);
+		const unsigned int vertexCount = (unsigned int)mesh.vertices.size();
+		MeshOptimizer::optimizeVertexCache(mesh.indices.data(), mesh.indices.size(), vertexCount);
+		const float acmr = MeshOptimizer::analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), vertexCount).acmr;
+		const unsigned int clusters = MeshOptimizer::optimizeOverdraw(mesh.indices.data(), mesh.indices.size(),
+			mesh.vertices.data(), vertexCount, MeshOptimizer::DEFAULT_CACHE_SIZE, 1.05f);
+		CHECK(clusters > 1);
+		CHECK(canonical(mesh.indices) == before);
+		// Cada grupo, con la caché vacía, no pasa de 1.05 veces el ACMR de su tramo; vaciar la caché
+		// en un corte cuesta como mucho cacheSize fallos más.
+		const float triangles = (float)(mesh.indices.size() / 3);
+		const float bound = 1.05f * (acmr + clusters * MeshOptimizer::DEFAULT_CACHE_SIZE / triangles);
+		CHECK(MeshOptimizer::analyzeVertexCache(mesh.indices.data(), mesh.indices.size(), vertexCount).acmr <= bound);
+	}
+
+	// Renumerar conserva cada triángulo con sus vértices, numera por primer uso y quita los no usados.
+	void testVertexFetch() {
+		MeshData mesh = makeGrid(33);
+		shuffleTriangles(mesh, 7);
+		// Vértices sin usar al principio y al final.
+		MeshVertex unused;
+		unused.position = Float3(-100.0f, -100.0f, -100.0f);
+		unused.texCoord = Float2(0.0f, 0.0f);
+		mesh.vertices.insert(mesh.vertices.begin(), unused);
+		mesh.vertices.push_back(unused);
+		for (uint32_t& index : mesh.indices)
+			++index;
+		const MeshData original = mesh;
+
+		MeshOptimizer::optimizeVertexFetch(mesh);
+		CHECK(mesh.vertices.size() == original.vertices.size() - 2);
+		CHECK(mesh.indices.size() == original.indices.size());
+		bool geometryKept = true;
+		for (size_t i = 0; i < mesh.indices.size(); ++i)
+			geometryKept &= memcmp(&mesh.vertices[mesh.indices[i]], &original.vertices[original.indices[i]], sizeof(MeshVertex)) == 0;
+		CHECK(geometryKept);
+		uint32_t next = 0;
+		bool firstUse = true;
+		for (uint32_t index : mesh.indices) {
+			firstUse &= index <= next;
+			if (index == next)
+				++next;
+		}
+		CHECK(firstUse && next == mesh.vertices.size());
+	}
+
+	// optimize(): los tres pasos juntos dejan la misma geometría con mejor ACMR.
+	void testOptimize() {
+		MeshData mesh = makeGrid(65);
+		shuffleTriangles(mesh, 11);
+		const MeshData original = mesh;
+		MeshOptimizer::Options options;
+		MeshOptimizer::Stats stats;
+		CHECK(MeshOptimizer::optimize(mesh, options, &stats) == S_OK);
+		CHECK(stats.before.acmr > 2.0f && stats.after.acmr < 0.85f);
+		CHECK(stats.clusters > 1);
+		CHECK(sameGeometry(mesh, original));
+
+		options.optimizeOverdraw = false;
+		mesh = original;
+		CHECK(MeshOptimizer::optimize(mesh, options, &stats) == S_OK);
+		CHECK(stats.clusters == 0 && sameGeometry(mesh, original));
+
+		MeshData bad = original;
+		bad.indices.pop_back();
+		CHECK(MeshOptimizer::optimize(bad, options) == E_INVALIDARG);
+		bad = original;
+		bad.indices[4] = (uint32_t)bad.vertices.size();
+		CHECK(MeshOptimizer::optimize(bad, options) == E_INVALIDARG);
+		options.cacheSize = 2;
+		CHECK(MeshOptimizer::optimize(mesh, options) == E_INVALIDARG);
+	}
+}
+
+int
+main() {
+	testAnalyze();
+	testVertexCache();
+	testOverdraw();
+	testVertexFetch();
+	testOptimize();
+	return testResult("MeshOptimizerTests");
+}
@@ -0,0 +1,326 @@
+#include "MeshSimplifier.h"
+#include "LodSelector.h"
+#include "TestCommon.h"
+#include <algorithm>
+#include <cfloat>
+#include <map>
+
+// MeshSimplifier: sin límite de error llega al número de triángulos pedido (con la tolerancia
+// de las pasadas), nunca deja triángulos degenerados ni índices inventados y respeta el error
+// pedido; en una rejilla abierta el contorno no se mueve (los bordes solo colapsan a lo largo
+// del borde y con lockBorder ni eso), y buildLods() da niveles cada vez más pequeños con el
+// error acumulado. LodSelector: el LOD es cada vez más simple al alejarse, el error en
+// píxeles sigue la fórmula de la proyección y la histéresis evita que un objeto alterne.
+
+namespace {
+
+	MeshData makeSphere(unsigned int stacks) {
+		MeshData mesh;
+		const unsigned int slices = stacks * 2;
+		for (unsigned int i = 0; i <= stacks; ++i) {
+			const float theta = 3.14159265f * i / stacks;
+			for (unsigned int j = 0; j < slices; ++j) {
+				const float phi = 6.2831853f * j / slices;
+				const float radius = 1.0f + 0.05f * std::sin(theta * 7.0f) * std::cos(phi * 5.0f);
+				MeshVertex vertex;
+				vertex.position = Float3(radius * std::sin(theta) * std::cos(phi), radius * std::cos(theta),
+					radius * std::sin(theta) * std::sin(phi));
+				vertex.texCoord = Float2(0.0f, 0.0f);
+				mesh.vertices.push_back(vertex);
+				// Los polos son un solo vértice.
+				if (i == 0 || i == stacks)
+					break;
+			}
+		}
+		auto vertexAt = [&](unsigned int i, unsigned int j) -> uint32_t {
+			if (i == 0)
+				return 0;
+			if (i == stacks)
+				return 1 + (stacks - 1) * slices;
+			return 1 + (i - 1) * slices + j % slices;
+		};
+		for (unsigned int i = 0; i < stacks; ++i) {
+			for (unsigned int j = 0; j < slices; ++j) {
+				const uint32_t a = vertexAt(i, j), b = vertexAt(i, j + 1), c = vertexAt(i + 1, j + 1), d = vertexAt(i + 1, j);
+				if (i > 0) {
+					for (uint32_t index : { a, c, b })
+						mesh.indices.push_back(index);
+				}
+				if (i + 1 < stacks) {
+					for (uint32_t index : { a, d, c })
+						mesh.indices.push_back(index);
+				}
+			}
+		}
+		mesh.boundsMin = Float3(-1.05f, -1.05f, -1.05f);
+		mesh.boundsMax = Float3(1.05f, 1.05f, 1.05f);
+		return mesh;
+	}
+
+	// Rejilla abierta de side x side vértices en [0, side - 1]² con un relieve suave en z.
+	MeshData makeGrid(unsigned int side) {
+		MeshData mesh;
+		for (unsigned int y = 0; y < side; ++y) {
+			for (unsigned int x = 0; x < side; ++x) {
+				MeshVertex vertex;
+				vertex.position = Float3((float)x, (float)y, std::sin(x * 0.2f) * std::cos(y * 0.15f));
+				vertex.texCoord = Float2((float)x / side, (float)y / side);
+				mesh.vertices.push_back(vertex);
+			}
+		}
+		for (unsigned int y = 0; y + 1 < side; ++y) {
+			for (unsigned int x = 0; x + 1 < side; ++x) {
+				const uint32_t a = y * side + x, b = a + 1, c = a + side + 1, d = a + side;
+				for (uint32_t index : { a, c, b, a, d, c })
+					mesh.indices.push_back(index);
+			}
+		}
+		mesh.boundsMin = Float3(0.0f, 0.0f, -1.0f);
+		mesh.boundsMax = Float3((float)(side - 1), (float)(side - 1), 1.0f);
+		return mesh;
+	}
+
+	// Índices válidos y ningún triángulo con dos esquinas iguales.
+	bool wellFormed(const std::vector<uint32_t>& indices, size_t vertexCount) {
+		bool ok = indices.size() % 3 == 0;
+		for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+			ok &= indices[i] < vertexCount && indices[i + 1] < vertexCount && indices[i + 2] < vertexCount;
+			ok &= indices[i] != indices[i + 1] && indices[i + 1] != indices[i + 2] && indices[i] != indices[i + 2];
+		}
+		return ok;
+	}
+
+	std::vector<uint32_t> simplify(const MeshData& mesh, const std::vector<uint32_t>& indices, size_t targetTriangles,
+		float targetError, bool lockBorder, float* error) {
+		std::vector<uint32_t> result(indices.size());
+		const size_t count = MeshSimplifier::simplify(result.data(), indices.data(), indices.size(), mesh.vertices.data(),
+			(unsigned int)mesh.vertices.size(), targetTriangles * 3, targetError, lockBorder, error);
+		result.resize(count);
+		return result;
+	}
+
+	// Sin límite de error se llega al objetivo; con límite, el error no lo pasa.
+	void testTargetCount() {
+		const MeshData sphere = makeSphere(40); // 6240 triángulos
+		const size_t triangles = sphere.indices.size() / 3;
+		for (float ratio : { 0.5f, 0.25f, 0.1f, 0.02f }) {
+			const size_t target = (size_t)(triangles * ratio);
+			float error = -1.0f;
+			const std::vector<uint32_t> result = simplify(sphere, sphere.indices, target, FLT_MAX, false, &error);
+			const size_t reached = result.size() / 3;
+			CHECK(reached <= target && reached * 10 >= target * 9); // Hasta un 10% por debajo
+			CHECK(wellFormed(result, sphere.vertices.size()));
+			CHECK(error > 0.0f && error < 1.0f);
+		}
+
+		// Con un límite de error pequeño no se llega, y el error devuelto no lo pasa.
+		const float limit = 0.002f;
+		float error = -1.0f;
+		const std::vector<uint32_t> result = simplify(sphere, sphere.indices, triangles / 50, limit, false, &error);
+		CHECK(result.size() / 3 > triangles / 50 && result.size() < sphere.indices.size());
+		CHECK(error >= 0.0f && error <= limit);
+		CHECK(wellFormed(result, sphere.vertices.size()));
+
+		// Objetivo mayor que la malla: se copia tal cual.
+		const std::vector<uint32_t> same = simplify(sphere, sphere.indices, triangles, FLT_MAX, false, &error);
+		CHECK(same == sphere.indices && error == 0.0f);
+	}
+
+	struct EdgeInfo {
+		uint32_t a, b;
+	};
+
+	// Aristas de borde: las que solo recorre un triángulo en un sentido y ninguno en el otro.
+	std::vector<EdgeInfo> borderEdges(const std::vector<uint32_t>& indices) {
+		std::map<std::pair<uint32_t, uint32_t>, int> edges;
+		for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+			for (int k = 0; k < 3; ++k)
+				++edges[{ indices[i + k], indices[i + (k + 1) % 3] }];
+		}
+		std::vector<EdgeInfo> border;
+		for (const auto& edge : edges) {
+			if (edges.find({ edge.first.second, edge.first.first }) == edges.end())
+				border.push_back({ edge.first.first, edge.first.second });
+		}
+		return border;
+	}
+
+	// Área con signo de la proyección en xy; el contorno intacto la deja igual a la del cuadrado.
+	double projectedArea(const MeshData& mesh, const std::vector<uint32_t>& indices) {
+		double area = 0.0;
+		for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+			const Float3& a = mesh.vertices[indices[i]].position;
+			const Float3& b = mesh.vertices[indices[i + 1]].position;
+			const Float3& c = mesh.vertices[indices[i + 2]].position;
+			area += 0.5 * ((double)(b.x - a.x) * (c.y - a.y) - (double)(b.y - a.y) * (c.x - a.x));
+		}
+		return area;
+	}
+
+	void testBorder() {
+		const unsigned int side = 41;
+		const float last = (float)(side - 1);
+		const MeshData grid = makeGrid(side);
+		const double area = std::fabs(projectedArea(grid, grid.indices));
+		CHECK_NEAR(area, last * last, 1e-3);
+		auto onSide = [&](const Float3& p) {
+			return p.x == 0.0f || p.y == 0.0f || p.x == last || p.y == last;
+		};
+		auto sameSide = [&](const Float3& p, const Float3& q) {
+			return (p.x == q.x && (p.x == 0.0f || p.x == last)) || (p.y == q.y && (p.y == 0.0f || p.y == last));
+		};
+		const uint32_t corners[] = { 0, side - 1, side * (side - 1), side * side - 1 };
+
+		// Los bordes colapsan a lo largo del borde: cada arista de borde sigue sobre un lado del
+		// cuadrado, las cuatro esquinas siguen y el área proyectada no cambia.
+		for (float targetError : { 0.05f, 0.5f }) {
+			float error = 0.0f;
+			const std::vector<uint32_t> result = simplify(grid, grid.indices, grid.indices.size() / 3 / 20, targetError, false, &error);
+			CHECK(result.size() * 4 < grid.indices.size());
+			CHECK(wellFormed(result, grid.vertices.size()));
+			bool alongSides = true;
+			unsigned int borderVertices = 0;
+			for (const EdgeInfo& edge : borderEdges(result)) {
+				const Float3& p = grid.vertices[edge.a].position;
+				const Float3& q = grid.vertices[edge.b].position;
+				alongSides &= onSide(p) && onSide(q) && sameSide(p, q);
+				++borderVertices;
+			}
+			CHECK(alongSides);
+			CHECK(borderVertices < (side - 1) * 4); // Se quitaron vértices del borde
+			for (uint32_t corner : corners)
+				CHECK(std::find(result.begin(), result.end(), corner) != result.end());
+			CHECK_NEAR(std::fabs(projectedArea(grid, result)), area, 1e-2);
+		}
+
+		// lockBorder: el borde se queda con todas sus aristas.
+		float error = 0.0f;
+		const std::vector<uint32_t> locked = simplify(grid, grid.indices, grid.indices.size() / 3 / 20, 0.5f, true, &error);
+		CHECK(locked.size() * 2 < grid.indices.size());
+		CHECK(borderEdges(locked).size() == (side - 1) * 4);
+		CHECK_NEAR(std::fabs(projectedArea(grid, locked)), area, 1e-2);
+	}
+
+	void testBuildLods() {
+		const MeshData sphere = makeSphere(40);
+		MeshSimplifier::LodOptions options;
+		std::vector<MeshSimplifier::Lod> lods;
+		MeshSimplifier::Stats stats;
+		CHECK(MeshSimplifier::buildLods(sphere, options, lods, &stats) == S_OK);
+		CHECK(stats.levels == lods.size() && lods.size() >= 4 && lods.size() <= options.maxLods);
+		CHECK(lods[0].indices == sphere.indices && lods[0].error == 0.0f);
+		const float maxError = options.maxError * 0.5f * std::sqrt(3.0f * 2.1f * 2.1f);
+		for (size_t l = 1; l < lods.size(); ++l) {
+			CHECK(lods[l].indices.size() < lods[l - 1].indices.size());
+			CHECK(lods[l].indices.size() / 3 >= options.minTriangles);
+			CHECK(lods[l].error >= lods[l - 1].error && lods[l].error <= maxError * 1.0001f);
+			CHECK(wellFormed(lods[l].indices, sphere.vertices.size()));
+		}
+
+		options.reduction = 1.0f;
+		CHECK(MeshSimplifier::buildLods(sphere, options, lods) == E_INVALIDARG);
+		MeshData bad = sphere;
+		bad.indices[0] = (uint32_t)bad.vertices.size();
+		CHECK(MeshSimplifier::buildLods(bad, MeshSimplifier::LodOptions(), lods) == E_INVALIDARG);
+	}
+
+	// Cámara en el origen mirando a +z, 45 grados de campo vertical y 1080 píxeles de alto.
+	void beginFrame(LodSelector& selector) {
+		const Matrix view = MatrixLookAtLH(VectorSet(0.0f, 0.0f, 0.0f, 1.0f), VectorSet(0.0f, 0.0f, 1.0f, 1.0f),
+			VectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+		const Matrix projection = MatrixPerspectiveFovLH(MATH_PIDIV4, 16.0f / 9.0f, 0.1f, 1000.0f);
+		selector.beginFrame(view, projection, 1080.0f);
+	}
+
+	void testLodSelector() {
+		LodSelector selector;
+		LodSelector::Options options;
+		options.hysteresis = 1.0f;
+		CHECK(selector.init(options) == E_INVALIDARG);
+		options = LodSelector::Options();
+		options.maxPixelError = 0.0f;
+		CHECK(selector.init(options) == E_INVALIDARG);
+		CHECK(selector.init(LodSelector::Options()) == S_OK);
+		beginFrame(selector);
+
+		// píxeles = error / distancia * projection._22 * alto / 2, con la distancia hasta la esfera.
+		const float pixelScale = 1.0f / std::tan(MATH_PIDIV4 * 0.5f) * 540.0f;
+		CHECK_NEAR(selector.getPixelError(Float3(0.0f, 0.0f, 11.0f), 1.0f, 0.01f), 0.01f * pixelScale / 10.0f, 1e-3);
+		CHECK(std::isinf(selector.getPixelError(Float3(0.0f, 0.0f, 0.5f), 1.0f, 0.01f)));
+		CHECK(selector.getPixelError(Float3(0.0f, 0.0f, 0.5f), 1.0f, 0.0f) == 0.0f);
+
+		// Un objeto nuevo por distancia: el LOD no baja al alejarse y recorre todos los niveles.
+		const float errors[] = { 0.0f, 0.002f, 0.008f, 0.032f, 0.128f };
+		unsigned int previous = 0;
+		bool monotonic = true;
+		for (unsigned int d = 0; d < 200; ++d) {
+			const float distance = 1.5f * std::pow(1.05f, (float)d);
+			const unsigned int lod = selector.select(d, Float3(0.0f, 0.0f, distance), 1.0f, errors, 5);
+			monotonic &= lod >= previous;
+			previous = lod;
+			// El elegido cumple el umbral y el siguiente más simple no.
+			if (lod > 0)
+				monotonic &= selector.getPixelError(Float3(0.0f, 0.0f, distance), 1.0f, errors[lod]) <= 0.75f;
+			if (lod + 1 < 5)
+				monotonic &= selector.getPixelError(Float3(0.0f, 0.0f, distance), 1.0f, errors[lod + 1]) > 0.75f;
+		}
+		CHECK(monotonic);
+		CHECK(selector.select(500, Float3(0.0f, 0.0f, 1.5f), 1.0f, errors, 5) == 0);
+		CHECK(selector.select(501, Float3(0.0f, 0.0f, 100000.0f), 1.0f, errors, 5) == 4);
+		// Con escala 2 el error del mundo se duplica: hace falta el doble de distancia.
+		const float far = 1.0f + errors[2] * pixelScale / 0.7f;
+		CHECK(selector.select(502, Float3(0.0f, 0.0f, far), 1.0f, errors, 5) == 2);
+		CHECK(selector.select(503, Float3(0.0f, 0.0f, far), 1.0f, errors, 5, 2.0f) == 1);
+		CHECK(selector.select(504, Float3(0.0f, 0.0f, 2.0f * far - 1.0f), 1.0f, errors, 5, 2.0f) == 2);
+	}
+
+	// Un objeto que va y viene cerca de la distancia de cambio no alterna en cada frame.
+	void testHysteresis() {
+		LodSelector selector;
+		selector.init(LodSelector::Options());
+		const float errors[] = { 0.0f, 0.01f };
+		const float pixelScale = 1.0f / std::tan(MATH_PIDIV4 * 0.5f) * 540.0f;
+		// Distancia (a la superficie) a la que el LOD 1 proyecta p píxeles.
+		auto at = [&](float pixels) {
+			return Float3(0.0f, 0.0f, 1.0f + errors[1] * pixelScale / pixels);
+		};
+
+		beginFrame(selector);
+		CHECK(selector.select(0, at(0.9f), 1.0f, errors, 2) == 0);  // 0.9 > 0.75: no baja todavía
+		beginFrame(selector);
+		CHECK(selector.select(0, at(0.7f), 1.0f, errors, 2) == 1);  // Baja
+		CHECK(selector.getStats().switches == 1);
+		unsigned int switches = 0;
+		for (int frame = 0; frame < 20; ++frame) {
+			beginFrame(selector);
+			selector.select(0, at(frame & 1 ? 0.95f : 0.8f), 1.0f, errors, 2); // Entre 0.75 y 1: se queda
+			switches += selector.getStats().switches;
+		}
+		CHECK(switches == 0);
+		beginFrame(selector);
+		CHECK(selector.select(0, at(1.1f), 1.0f, errors, 2) == 0);  // Pasa de 1: sube
+		CHECK(selector.getStats().objects == 1 && selector.getStats().switches == 1);
+
+		// Sin histéresis el mismo vaivén alterna.
+		LodSelector::Options options;
+		options.hysteresis = 0.0f;
+		selector.init(options);
+		switches = 0;
+		for (int frame = 0; frame < 20; ++frame) {
+			beginFrame(selector);
+			selector.select(0, at(frame & 1 ? 1.05f : 0.95f), 1.0f, errors, 2);
+			switches += selector.getStats().switches;
+		}
+		CHECK(switches >= 19);
+	}
+}
+
+int
+main() {
+	testTargetCount();
+	testBorder();
+	testBuildLods();
+	testLodSelector();
+	testHysteresis();
+	return testResult("MeshSimplifierTests");
+}
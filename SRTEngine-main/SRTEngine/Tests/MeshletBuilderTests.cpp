@@ -0,0 +1,296 @@
+#include "MeshletBuilder.h"
+#include "TestCommon.h"
+#include <algorithm>
+#include <cstring>
+
+// MeshletBuilder: al partir una rejilla de más de 65536 vértices en tramos ningún índice
+// local llega al tamaño del tramo (ni a 65536) y salen todos los triángulos, en orden y con
+// sus vértices; los meshlets respetan maxVertices y maxTriangles y cubren su tramo sin
+// huecos. La prueba del cono descarta un meshlet visto por detrás, conserva los que están de
+// canto o tienen alguna cara de frente, y en una esfera nunca descarta un meshlet con alguna
+// cara visible.
+
+namespace {
+
+	Float3 subtract(const Float3& a, const Float3& b) {
+		return Float3(a.x - b.x, a.y - b.y, a.z - b.z);
+	}
+
+	float dot(const Float3& a, const Float3& b) {
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	}
+
+	Float3 cross(const Float3& a, const Float3& b) {
+		return Float3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+	}
+
+	uint32_t addVertex(MeshData& mesh, const Float3& position) {
+		MeshVertex vertex;
+		vertex.position = position;
+		vertex.texCoord = Float2(position.x, position.y);
+		mesh.vertices.push_back(vertex);
+		return (uint32_t)mesh.vertices.size() - 1;
+	}
+
+	// Añade el triángulo con la normal del motor (cross(b - a, c - a)) hacia outward.
+	void addTriangle(MeshData& mesh, uint32_t a, uint32_t b, uint32_t c, const Float3& outward) {
+		const Float3& pa = mesh.vertices[a].position;
+		const Float3 normal = cross(subtract(mesh.vertices[b].position, pa), subtract(mesh.vertices[c].position, pa));
+		for (uint32_t index : { a, dot(normal, outward) >= 0.0f ? b : c, dot(normal, outward) >= 0.0f ? c : b })
+			mesh.indices.push_back(index);
+	}
+
+	// Rejilla de side x side vértices en el plano z = 0 mirando hacia -z (hacia la cámara del motor).
+	MeshData makeGrid(unsigned int side) {
+		MeshData mesh;
+		mesh.vertices.reserve((size_t)side * side);
+		for (unsigned int y = 0; y < side; ++y) {
+			for (unsigned int x = 0; x < side; ++x)
+				addVertex(mesh, Float3((float)x, (float)y, 0.0f));
+		}
+		for (unsigned int y = 0; y + 1 < side; ++y) {
+			for (unsigned int x = 0; x + 1 < side; ++x) {
+				const uint32_t a = y * side + x, b = a + 1, c = a + side + 1, d = a + side;
+				addTriangle(mesh, a, b, c, Float3(0.0f, 0.0f, -1.0f));
+				addTriangle(mesh, a, c, d, Float3(0.0f, 0.0f, -1.0f));
+			}
+		}
+		return mesh;
+	}
+
+	uint32_t readIndex(const MeshletMesh& mesh, size_t i) {
+		if (mesh.indexSize == 2) {
+			uint16_t index;
+			memcpy(&index, &mesh.indexData[i * 2], 2);
+			return index;
+		}
+		uint32_t index;
+		memcpy(&index, &mesh.indexData[i * 4], 4);
+		return index;
+	}
+
+	// Tramos seguidos, índices locales dentro de cada tramo, meshlets que cubren su tramo y los
+	// mismos triángulos que mesh en el mismo orden.
+	void checkLayout(const MeshData& mesh, const MeshletMesh& result, const MeshletBuilder::Options& options) {
+		CHECK(result.getIndexCount() == mesh.indices.size());
+		uint32_t nextIndex = 0, nextVertex = 0, nextMeshlet = 0;
+		bool chunks = true, local = true, meshlets = true, limits = true, triangles = true;
+		for (const MeshChunk& chunk : result.chunks) {
+			chunks &= chunk.firstIndex == nextIndex && chunk.baseVertex == nextVertex && chunk.firstMeshlet == nextMeshlet;
+			chunks &= chunk.meshletCount > 0 && (!options.splitChunks || chunk.vertexCount <= options.maxChunkVertices);
+			for (uint32_t i = chunk.firstIndex; i < chunk.firstIndex + chunk.indexCount; ++i) {
+				const uint32_t index = readIndex(result, i);
+				local &= index < chunk.vertexCount && (result.indexSize == 4 || index < MeshletBuilder::MAX_16BIT_VERTICES);
+				triangles &= memcmp(&result.vertices[chunk.baseVertex + index], &mesh.vertices[mesh.indices[i]], sizeof(MeshVertex)) == 0;
+			}
+
+			uint32_t meshletIndex = chunk.firstIndex;
+			for (uint32_t m = chunk.firstMeshlet; m < chunk.firstMeshlet + chunk.meshletCount; ++m) {
+				const Meshlet& meshlet = result.meshlets[m];
+				meshlets &= meshlet.firstIndex == meshletIndex && meshlet.triangleCount > 0;
+				meshletIndex += meshlet.triangleCount * 3;
+				limits &= meshlet.triangleCount <= options.maxTriangles && meshlet.vertexCount <= options.maxVertices;
+
+				// vertexCount son los vértices distintos de sus triángulos.
+				std::vector<uint32_t> distinct;
+				for (uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.triangleCount * 3; ++i) {
+					const uint32_t index = readIndex(result, i);
+					if (std::find(distinct.begin(), distinct.end(), index) == distinct.end())
+						distinct.push_back(index);
+				}
+				limits &= distinct.size() == meshlet.vertexCount;
+			}
+			meshlets &= meshletIndex == chunk.firstIndex + chunk.indexCount;
+
+			nextIndex += chunk.indexCount;
+			nextVertex += chunk.vertexCount;
+			nextMeshlet += chunk.meshletCount;
+		}
+		chunks &= nextIndex == mesh.indices.size() && nextVertex == result.vertices.size() && nextMeshlet == result.meshlets.size();
+		CHECK(chunks && local && meshlets && limits && triangles);
+	}
+
+	void testChunks() {
+		// 300 x 300 = 90000 vértices: con 16 bits hacen falta al menos dos tramos.
+		const MeshData grid = makeGrid(300);
+		MeshletBuilder::Options options;
+		MeshletMesh result;
+		CHECK(MeshletBuilder::build(grid, options, result) == S_OK);
+		CHECK(result.indexSize == 2 && result.chunks.size() >= 2);
+		CHECK(result.vertices.size() >= grid.vertices.size()); // Los compartidos entre tramos se duplican
+		checkLayout(grid, result, options);
+
+		// Tramos pequeños: muchos cortes, misma garantía.
+		options.maxChunkVertices = 3000;
+		CHECK(MeshletBuilder::build(grid, options, result) == S_OK);
+		CHECK(result.chunks.size() >= 30);
+		checkLayout(grid, result, options);
+
+		// Sin partir: un solo tramo con índices de 32 bits.
+		options.splitChunks = false;
+		CHECK(MeshletBuilder::build(grid, options, result) == S_OK);
+		CHECK(result.indexSize == 4 && result.chunks.size() == 1 && result.vertices.size() == grid.vertices.size());
+		checkLayout(grid, result, options);
+
+		// Y con 16 bits si cabe.
+		const MeshData small = makeGrid(100);
+		CHECK(MeshletBuilder::build(small, options, result) == S_OK);
+		CHECK(result.indexSize == 2 && result.chunks.size() == 1);
+		checkLayout(small, result, options);
+	}
+
+	void testMeshletLimits() {
+		const MeshData grid = makeGrid(40);
+		const unsigned int limits[][2] = { { 64, 124 }, { 32, 64 }, { 128, 16 }, { 3, 8 }, { 16, 1000 } };
+		for (const unsigned int* limit : limits) {
+			MeshletBuilder::Options options;
+			options.maxVertices = limit[0];
+			options.maxTriangles = limit[1];
+			MeshletMesh result;
+			CHECK(MeshletBuilder::build(grid, options, result) == S_OK);
+			checkLayout(grid, result, options);
+			// Voraz: un meshlet solo se cierra antes de tiempo si el siguiente triángulo no cabe.
+			bool full = true;
+			for (size_t m = 0; m + 1 < result.meshlets.size(); ++m) {
+				const Meshlet& meshlet = result.meshlets[m];
+				full &= meshlet.triangleCount == options.maxTriangles || meshlet.vertexCount + 3 > options.maxVertices;
+			}
+			CHECK(full);
+		}
+
+		MeshletBuilder::Options options;
+		MeshletMesh result;
+		MeshData empty;
+		CHECK(MeshletBuilder::build(empty, options, result) == E_INVALIDARG);
+		options.maxVertices = 2;
+		CHECK(MeshletBuilder::build(grid, options, result) == E_INVALIDARG);
+		options = MeshletBuilder::Options();
+		options.maxChunkVertices = MeshletBuilder::MAX_16BIT_VERTICES + 1;
+		CHECK(MeshletBuilder::build(grid, options, result) == E_INVALIDARG);
+		MeshData bad = grid;
+		bad.indices[7] = (uint32_t)bad.vertices.size();
+		CHECK(MeshletBuilder::build(bad, MeshletBuilder::Options(), result) == E_INVALIDARG);
+	}
+
+	bool culled(const MeshletMesh& mesh, const Float3& camera, std::vector<MeshletBuilder::DrawRange>& ranges) {
+		ranges.clear();
+		MeshletBuilder::cull(mesh, 0, camera, 0, ranges);
+		return ranges.empty();
+	}
+
+	// Un meshlet plano y un tejado a dos aguas de 60 grados, cada uno un meshlet en su tramo.
+	void testCone() {
+		MeshData flat = makeGrid(5); // Centro (2, 2, 0), mira hacia -z
+		MeshletMesh flatMeshlets;
+		CHECK(MeshletBuilder::build(flat, MeshletBuilder::Options(), flatMeshlets) == S_OK);
+		CHECK(flatMeshlets.meshlets.size() == 1);
+		const Meshlet& meshlet = flatMeshlets.meshlets[0];
+		CHECK_NEAR(meshlet.coneAxis.z, -1.0, 1e-6);
+		CHECK_NEAR(meshlet.coneCutoff, 0.0, 1e-3);
+
+		std::vector<MeshletBuilder::DrawRange> ranges;
+		CHECK(!culled(flatMeshlets, Float3(2.0f, 2.0f, -10.0f), ranges)); // De frente
+		CHECK(ranges.size() == 1 && ranges[0].indexCount == flat.indices.size() && ranges[0].firstIndex == 0);
+		CHECK(culled(flatMeshlets, Float3(2.0f, 2.0f, 10.0f), ranges));   // Por detrás
+		CHECK(culled(flatMeshlets, Float3(30.0f, -20.0f, 10.0f), ranges)); // Por detrás y de lado
+		CHECK(!culled(flatMeshlets, Float3(50.0f, 2.0f, 0.0f), ranges));  // De canto
+		CHECK(!culled(flatMeshlets, Float3(2.0f, 2.0f, 1.0f), ranges));   // Detrás pero dentro de la esfera
+
+		// Tejado: dos aguas con normales a ±60 grados de -z, una a cada lado de la cumbrera.
+		MeshData roof;
+		const float slope = std::tan(60.0f * 3.14159265f / 180.0f);
+		const uint32_t left0 = addVertex(roof, Float3(-1.0f, 0.0f, slope)), left1 = addVertex(roof, Float3(-1.0f, 4.0f, slope));
+		const uint32_t ridge0 = addVertex(roof, Float3(0.0f, 0.0f, 0.0f)), ridge1 = addVertex(roof, Float3(0.0f, 4.0f, 0.0f));
+		const uint32_t right0 = addVertex(roof, Float3(1.0f, 0.0f, slope)), right1 = addVertex(roof, Float3(1.0f, 4.0f, slope));
+		const Float3 leftNormal(-std::sin(1.0471976f), 0.0f, -std::cos(1.0471976f));
+		const Float3 rightNormal(std::sin(1.0471976f), 0.0f, -std::cos(1.0471976f));
+		addTriangle(roof, left0, ridge0, ridge1, leftNormal);
+		addTriangle(roof, left0, ridge1, left1, leftNormal);
+		addTriangle(roof, ridge0, right0, right1, rightNormal);
+		addTriangle(roof, ridge0, right1, ridge1, rightNormal);
+		MeshletMesh roofMeshlets;
+		CHECK(MeshletBuilder::build(roof, MeshletBuilder::Options(), roofMeshlets) == S_OK);
+		CHECK(roofMeshlets.meshlets.size() == 1);
+		CHECK_NEAR(roofMeshlets.meshlets[0].coneAxis.z, -1.0, 1e-5);
+		CHECK_NEAR(roofMeshlets.meshlets[0].coneCutoff, std::sin(1.0471976f), 1e-4); // Seno de la apertura de 60 grados
+
+		CHECK(culled(roofMeshlets, Float3(0.0f, 2.0f, 50.0f), ranges));  // Desde atrás, las dos aguas de espaldas
+		CHECK(!culled(roofMeshlets, Float3(0.0f, 2.0f, -50.0f), ranges)); // Desde delante
+		// Silueta: desde la derecha el agua derecha se ve de frente y la izquierda de espaldas; el
+		// meshlet se conserva.
+		CHECK(!culled(roofMeshlets, Float3(50.0f, 2.0f, 0.0f), ranges));
+	}
+
+	// Esfera de 1 de radio: ningún meshlet descartado tiene una cara de frente y, desde lejos, se
+	// descarta buena parte de la mitad de atrás.
+	void testSphere() {
+		MeshData sphere;
+		const unsigned int stacks = 48, slices = 96;
+		for (unsigned int i = 0; i <= stacks; ++i) {
+			const float theta = 3.14159265f * i / stacks;
+			for (unsigned int j = 0; j <= slices; ++j) {
+				const float phi = 6.2831853f * j / slices;
+				addVertex(sphere, Float3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi)));
+			}
+		}
+		for (unsigned int i = 0; i < stacks; ++i) {
+			for (unsigned int j = 0; j < slices; ++j) {
+				const uint32_t a = i * (slices + 1) + j, b = a + 1, c = a + slices + 2, d = a + slices + 1;
+				const Float3& p = sphere.vertices[a].position;
+				const Float3& q = sphere.vertices[c].position;
+				const Float3 outward(p.x + q.x, p.y + q.y, p.z + q.z);
+				if (i > 0)
+					addTriangle(sphere, a, b, c, outward);
+				if (i + 1 < stacks)
+					addTriangle(sphere, a, c, d, outward);
+			}
+		}
+		MeshletBuilder::Options options;
+		options.maxVertices = 32;
+		options.maxTriangles = 32;
+		MeshletMesh result;
+		CHECK(MeshletBuilder::build(sphere, options, result) == S_OK);
+
+		const Float3 cameras[] = { Float3(0.0f, 0.0f, -6.0f), Float3(3.0f, 4.0f, 2.0f), Float3(0.0f, -20.0f, 0.5f), Float3(1.2f, 0.0f, 0.0f) };
+		for (const Float3& camera : cameras) {
+			bool conservative = true, silhouetteKept = true;
+			unsigned int culledCount = 0, backOnly = 0, silhouette = 0;
+			for (size_t m = 0; m < result.meshlets.size(); ++m) {
+				const Meshlet& meshlet = result.meshlets[m];
+				unsigned int front = 0;
+				for (uint32_t i = meshlet.firstIndex; i < meshlet.firstIndex + meshlet.triangleCount * 3; i += 3) {
+					const Float3& a = result.vertices[readIndex(result, i)].position;
+					const Float3 normal = cross(subtract(result.vertices[readIndex(result, i + 1)].position, a),
+						subtract(result.vertices[readIndex(result, i + 2)].position, a));
+					front += dot(normal, subtract(a, camera)) < 0.0f ? 1 : 0;
+				}
+				MeshletMesh single = result;
+				single.chunks.assign(1, MeshChunk());
+				single.chunks[0].firstMeshlet = (uint32_t)m;
+				single.chunks[0].meshletCount = 1;
+				std::vector<MeshletBuilder::DrawRange> ranges;
+				const bool isCulled = culled(single, camera, ranges);
+				culledCount += isCulled ? 1 : 0;
+				conservative &= !isCulled || front == 0;
+				backOnly += front == 0 ? 1 : 0;
+				if (front > 0 && front < meshlet.triangleCount) {
+					++silhouette;
+					silhouetteKept &= !isCulled;
+				}
+			}
+			CHECK(conservative && silhouetteKept && silhouette > 0);
+			CHECK(culledCount <= backOnly);
+			if (camera.y == -20.0f || camera.z == -6.0f)
+				CHECK(culledCount * 3 > backOnly); // Desde lejos la prueba no es demasiado conservadora
+		}
+	}
+}
+
+int
+main() {
+	testChunks();
+	testMeshletLimits();
+	testCone();
+	testSphere();
+	return testResult("MeshletBuilderTests");
+}
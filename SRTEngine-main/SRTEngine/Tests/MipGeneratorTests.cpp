@@ -0,0 +1,264 @@
+#include "MipGenerator.h"
+#include "TestCommon.h"
+#include <cstdlib>
+
+// MipGenerator contra una referencia escalar escrita aquí en double: conversión sRGB exacta
+// con pow, filtro 2D evaluado píxel a píxel sin tablas ni pasadas separadas, y cada nivel
+// filtrado desde el anterior sin cuantizar, como dice MipGenerator.h. Se admite 1 LSB de
+// diferencia por las tablas de conversión. Además, el camino SIMD y el escalar, y uno o
+// varios hilos, tienen que dar los mismos bytes.
+
+namespace {
+
+	double srgbToLinear(double c) {
+		return c <= 0.04045 ? c / 12.92 : std::pow((c + 0.055) / 1.055, 2.4);
+	}
+
+	double linearToSrgb(double l) {
+		return l <= 0.0031308 ? l * 12.92 : 1.055 * std::pow(l, 1.0 / 2.4) - 0.055;
+	}
+
+	double sinc(double x) {
+		const double pi = 3.14159265358979323846;
+		return x == 0.0 ? 1.0 : std::sin(pi * x) / (pi * x);
+	}
+
+	double besselI0(double x) {
+		double sum = 1.0, term = 1.0;
+		for (int k = 1; k < 64; ++k) {
+			term *= x * x * 0.25 / ((double)k * k);
+			sum += term;
+		}
+		return sum;
+	}
+
+	double filterWeight(MipGenerator::Filter filter, double x) {
+		const double ax = std::fabs(x);
+		switch (filter) {
+		case MipGenerator::FILTER_BOX:
+			return ax <= 0.5 ? 1.0 : 0.0;
+		case MipGenerator::FILTER_KAISER:
+			return ax < 3.0 ? sinc(x) * besselI0(4.0 * std::sqrt(1.0 - (x / 3.0) * (x / 3.0))) / besselI0(4.0) : 0.0;
+		default:
+			return ax < 3.0 ? sinc(x) * sinc(x / 3.0) : 0.0;
+		}
+	}
+
+	// Pesos normalizados de un píxel de salida sobre un eje, con el borde repetido. La posición
+	// de cada muestra se calcula en float como en MipGenerator: con escalas no enteras el box
+	// puede caer justo en |x| = 0.5 y en double la muestra entraría o no según el redondeo.
+	std::vector<std::pair<unsigned int, double>> axisWeights(MipGenerator::Filter filter,
+		unsigned int srcSize, unsigned int dstSize, unsigned int i) {
+		std::vector<std::pair<unsigned int, double>> weights;
+		if (srcSize == dstSize) {
+			weights.emplace_back(i, 1.0);
+			return weights;
+		}
+		const float scale = (float)srcSize / (float)dstSize;
+		const float center = (i + 0.5f) * scale - 0.5f;
+		const float support = (filter == MipGenerator::FILTER_BOX ? 0.5f : 3.0f) * scale;
+		double sum = 0.0;
+		for (int j = (int)std::ceil(center - support); j <= (int)std::floor(center + support); ++j) {
+			const double w = filterWeight(filter, (j - center) / scale);
+			if (w == 0.0)
+				continue;
+			weights.emplace_back((unsigned int)std::min(std::max(j, 0), (int)srcSize - 1), w);
+			sum += w;
+		}
+		for (auto& w : weights)
+			w.second /= sum;
+		return weights;
+	}
+
+	struct Image {
+		unsigned int width = 0;
+		unsigned int height = 0;
+		std::vector<double> pixels; // RGBA, color en lineal si srgb
+	};
+
+	uint8_t toByte(double v) {
+		v = v < 0.0 ? 0.0 : (v > 1.0 ? 1.0 : v);
+		return (uint8_t)(v * 255.0 + 0.5);
+	}
+
+	std::vector<MipLevel> referenceChain(const std::vector<uint8_t>& pixels, unsigned int width,
+		unsigned int height, MipGenerator::Filter filter, bool srgb) {
+		Image current;
+		current.width = width;
+		current.height = height;
+		for (size_t i = 0; i < pixels.size(); ++i)
+			current.pixels.push_back(srgb && i % 4 != 3 ? srgbToLinear(pixels[i] / 255.0) : pixels[i] / 255.0);
+
+		std::vector<MipLevel> levels(MipGenerator::levelCount(width, height));
+		levels[0].width = width;
+		levels[0].height = height;
+		levels[0].pixels = pixels;
+		for (size_t level = 1; level < levels.size(); ++level) {
+			Image next;
+			next.width = std::max(1u, current.width / 2);
+			next.height = std::max(1u, current.height / 2);
+			next.pixels.assign((size_t)next.width * next.height * 4, 0.0);
+			for (unsigned int y = 0; y < next.height; ++y) {
+				const auto wy = axisWeights(filter, current.height, next.height, y);
+				for (unsigned int x = 0; x < next.width; ++x) {
+					const auto wx = axisWeights(filter, current.width, next.width, x);
+					double* out = &next.pixels[((size_t)y * next.width + x) * 4];
+					for (const auto& row : wy)
+						for (const auto& column : wx)
+							for (int c = 0; c < 4; ++c)
+								out[c] += row.second * column.second *
+									current.pixels[((size_t)row.first * current.width + column.first) * 4 + c];
+				}
+			}
+			levels[level].width = next.width;
+			levels[level].height = next.height;
+			for (size_t i = 0; i < next.pixels.size(); ++i)
+				levels[level].pixels.push_back(toByte(srgb && i % 4 != 3 ? linearToSrgb(next.pixels[i]) : next.pixels[i]));
+			current = next;
+		}
+		return levels;
+	}
+
+	// Ruido con algo de estructura (degradados y bordes) para que el filtro importe.
+	std::vector<uint8_t> makeImage(unsigned int width, unsigned int height, unsigned int seed) {
+		std::vector<uint8_t> pixels((size_t)width * height * 4);
+		uint32_t random = seed;
+		for (unsigned int y = 0; y < height; ++y) {
+			for (unsigned int x = 0; x < width; ++x) {
+				uint8_t* p = &pixels[((size_t)y * width + x) * 4];
+				random = random * 1664525u + 1013904223u;
+				p[0] = (uint8_t)(x * 255 / std::max(1u, width - 1));
+				p[1] = (uint8_t)((x / 3 + y / 3) % 2 ? 230 : 20);
+				p[2] = (uint8_t)(random >> 24);
+				p[3] = (uint8_t)(((x - width / 2) * (x - width / 2) + (y - height / 2) * (y - height / 2)) * 4 <
+					width * height ? 255 : (random >> 16) & 0x7F);
+			}
+		}
+		return pixels;
+	}
+
+	int maxDifference(const std::vector<MipLevel>& a, const std::vector<MipLevel>& b) {
+		if (a.size() != b.size())
+			return 256;
+		int worst = 0;
+		for (size_t l = 0; l < a.size(); ++l) {
+			if (a[l].width != b[l].width || a[l].height != b[l].height || a[l].pixels.size() != b[l].pixels.size())
+				return 256;
+			for (size_t i = 0; i < a[l].pixels.size(); ++i)
+				worst = std::max(worst, std::abs((int)a[l].pixels[i] - (int)b[l].pixels[i]));
+		}
+		return worst;
+	}
+
+	void testLevelCount() {
+		CHECK(MipGenerator::levelCount(1, 1) == 1);
+		CHECK(MipGenerator::levelCount(256, 256) == 9);
+		CHECK(MipGenerator::levelCount(640, 480) == 10);
+		CHECK(MipGenerator::levelCount(5, 1) == 3);
+		CHECK(MipGenerator::levelCount(1, 300) == 9);
+	}
+
+	void testAgainstReference() {
+		const unsigned int sizes[][2] = { { 64, 48 }, { 37, 23 }, { 1, 17 }, { 40, 1 } };
+		const MipGenerator::Filter filters[] = { MipGenerator::FILTER_BOX, MipGenerator::FILTER_KAISER, MipGenerator::FILTER_LANCZOS };
+		unsigned int seed = 1;
+		for (const auto& size : sizes) {
+			const std::vector<uint8_t> image = makeImage(size[0], size[1], seed++);
+			for (MipGenerator::Filter filter : filters) {
+				for (bool srgb : { true, false }) {
+					MipGenerator::Options options;
+					options.filter = filter;
+					options.srgb = srgb;
+					std::vector<MipLevel> levels;
+					CHECK(SUCCEEDED(MipGenerator::generate(image.data(), size[0], size[1], options, levels)));
+					CHECK(levels.size() == MipGenerator::levelCount(size[0], size[1]));
+					CHECK(levels.back().width == 1 && levels.back().height == 1);
+					const int difference = maxDifference(levels, referenceChain(image, size[0], size[1], filter, srgb));
+					CHECK(difference <= 1);
+					if (difference > 1)
+						fprintf(stderr, "    %ux%u filter %d srgb %d: %d LSB\n", size[0], size[1], (int)filter, (int)srgb, difference);
+				}
+			}
+		}
+
+		// El box de 2x2 en tamaños pares es la media exacta de los cuatro píxeles.
+		const std::vector<uint8_t> image = makeImage(8, 8, 99);
+		MipGenerator::Options options;
+		options.filter = MipGenerator::FILTER_BOX;
+		options.srgb = false;
+		std::vector<MipLevel> levels;
+		CHECK(SUCCEEDED(MipGenerator::generate(image.data(), 8, 8, options, levels)));
+		int worst = 0;
+		for (unsigned int y = 0; y < 4; ++y) {
+			for (unsigned int x = 0; x < 4; ++x) {
+				for (int c = 0; c < 4; ++c) {
+					int sum = 0;
+					for (unsigned int k = 0; k < 4; ++k)
+						sum += image[((size_t)(2 * y + k / 2) * 8 + 2 * x + k % 2) * 4 + c];
+					worst = std::max(worst, std::abs(levels[1].pixels[((size_t)y * 4 + x) * 4 + c] - (sum + 2) / 4));
+				}
+			}
+		}
+		CHECK(worst <= 1);
+	}
+
+	// SIMD contra escalar y uno contra varios hilos: mismos bytes (sin FMA, mismo orden de sumas).
+	void testSimdAndThreads() {
+		const unsigned int width = 300, height = 260; // Pasa de MIN_PARALLEL_PIXELS en el nivel 0
+		const std::vector<uint8_t> image = makeImage(width, height, 7);
+		for (MipGenerator::Filter filter : { MipGenerator::FILTER_BOX, MipGenerator::FILTER_KAISER }) {
+			MipGenerator::Options scalar;
+			scalar.filter = filter;
+			scalar.useSimd = false;
+			std::vector<MipLevel> reference;
+			CHECK(SUCCEEDED(MipGenerator::generate(image.data(), width, height, scalar, reference)));
+			for (unsigned int threads : { 1u, 3u, 4u }) {
+				MipGenerator::Options options;
+				options.filter = filter;
+				options.threadCount = threads;
+				std::vector<MipLevel> levels;
+				CHECK(SUCCEEDED(MipGenerator::generate(image.data(), width, height, options, levels)));
+				CHECK(maxDifference(levels, reference) == 0);
+			}
+		}
+	}
+
+	float coverage(const MipLevel& level, float reference) {
+		size_t covered = 0;
+		for (size_t i = 3; i < level.pixels.size(); i += 4)
+			covered += level.pixels[i] / 255.0f > reference ? 1 : 0;
+		return (float)covered / (float)(level.width * level.height);
+	}
+
+	void testOptions() {
+		const std::vector<uint8_t> image = makeImage(64, 64, 3);
+		MipGenerator::Options options;
+		options.maxLevels = 3;
+		std::vector<MipLevel> levels;
+		CHECK(SUCCEEDED(MipGenerator::generate(image.data(), 64, 64, options, levels)));
+		CHECK(levels.size() == 3 && levels[2].width == 16);
+
+		// Hojas con alpha test: la cobertura del original se mantiene en los niveles reducidos.
+		std::vector<uint8_t> leaves((size_t)64 * 64 * 4, 255);
+		for (size_t i = 0; i < (size_t)64 * 64; ++i)
+			leaves[i * 4 + 3] = (i * 2654435761u >> 13) % 100 < 30 ? 200 : 0;
+		options = MipGenerator::Options();
+		options.preserveAlphaCoverage = true;
+		CHECK(SUCCEEDED(MipGenerator::generate(leaves.data(), 64, 64, options, levels)));
+		const float original = coverage(levels[0], options.alphaReference);
+		for (unsigned int level = 1; level <= 3; ++level)
+			CHECK_NEAR(coverage(levels[level], options.alphaReference), original, 0.05);
+
+		CHECK(MipGenerator::generate(nullptr, 4, 4, options, levels) == E_INVALIDARG);
+		CHECK(MipGenerator::generate(image.data(), 0, 4, options, levels) == E_INVALIDARG);
+	}
+}
+
+int
+main() {
+	testLevelCount();
+	testAgainstReference();
+	testSimdAndThreads();
+	testOptions();
+	return testResult("MipGeneratorTests");
+}
@@ -0,0 +1,200 @@
+#include "OcclusionCuller.h"
+#include "TestCommon.h"
+#include <random>
+
+// OcclusionCuller con oclusores conocidos (muros rectangulares delante de la cámara): una
+// caja nunca se descarta si se ve alguno de sus puntos, comprobado lanzando rayos desde la
+// cámara a puntos de sus caras contra los muros; las cajas claramente tapadas sí se
+// descartan. También los casos límite de isBoxVisible (plano cercano, fuera de pantalla,
+// cajas que atraviesan el muro), las caras traseras y los índices de 16 y 32 bits.
+
+namespace {
+
+	const float FOV = 1.0f;
+	const float ASPECT = 2.0f;
+	const Float3 EYE(0.0f, 0.0f, -10.0f);
+
+	// Muro en el plano z = constante, mirando a la cámara.
+	struct Wall {
+		float minX, maxX, minY, maxY, z;
+	};
+
+	struct Vertex {
+		float position[3];
+		float normal[3]; // Para que el paso entre vértices no sea el de un float3
+	};
+
+	// Cuadrado unidad de -1 a 1 en z = 0, en sentido horario visto desde -z.
+	const Vertex QUAD[4] = {
+		{ { -1.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, -1.0f } },
+		{ { -1.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, -1.0f } },
+		{ { 1.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, -1.0f } },
+		{ { 1.0f, -1.0f, 0.0f }, { 0.0f, 0.0f, -1.0f } },
+	};
+	const uint16_t QUAD_INDICES[6] = { 0, 1, 2, 0, 2, 3 };
+	const uint32_t QUAD_INDICES_32[6] = { 0, 1, 2, 0, 2, 3 };
+	const uint16_t QUAD_BACK_INDICES[6] = { 0, 2, 1, 0, 3, 2 };
+
+	Matrix wallWorld(const Wall& wall) {
+		return MatrixMultiply(MatrixScaling((wall.maxX - wall.minX) * 0.5f, (wall.maxY - wall.minY) * 0.5f, 1.0f),
+			MatrixTranslation((wall.maxX + wall.minX) * 0.5f, (wall.maxY + wall.minY) * 0.5f, wall.z));
+	}
+
+	void beginFrame(OcclusionCuller& culler) {
+		const Matrix view = MatrixLookAtLH(VectorSet(EYE.x, EYE.y, EYE.z, 1.0f), VectorSet(0.0f, 0.0f, 0.0f, 1.0f),
+			VectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+		culler.beginFrame(view, MatrixPerspectiveFovLH(FOV, ASPECT, 0.5f, 100.0f));
+	}
+
+	void addWalls(OcclusionCuller& culler, const std::vector<Wall>& walls) {
+		for (size_t i = 0; i < walls.size(); ++i) {
+			if (i % 2 == 0)
+				culler.addOccluder(QUAD, sizeof(Vertex), 4, QUAD_INDICES, 6, wallWorld(walls[i]));
+			else
+				culler.addOccluder(QUAD, sizeof(Vertex), 4, QUAD_INDICES_32, 6, wallWorld(walls[i]));
+		}
+		culler.finishOccluders();
+	}
+
+	// Si el segmento de la cámara al punto cruza algún muro.
+	bool blocked(const std::vector<Wall>& walls, float x, float y, float z) {
+		for (const Wall& wall : walls) {
+			if (z <= wall.z)
+				continue;
+			const float t = (wall.z - EYE.z) / (z - EYE.z);
+			const float hitX = EYE.x + (x - EYE.x) * t;
+			const float hitY = EYE.y + (y - EYE.y) * t;
+			if (hitX >= wall.minX && hitX <= wall.maxX && hitY >= wall.minY && hitY <= wall.maxY)
+				return true;
+		}
+		return false;
+	}
+
+	// Dentro del frustum (sin contar el plano lejano).
+	bool onScreen(float x, float y, float z) {
+		const float depth = z - EYE.z;
+		const float halfHeight = depth * std::tan(FOV * 0.5f);
+		return depth > 0.5f && std::fabs(y) <= halfHeight && std::fabs(x) <= halfHeight * ASPECT;
+	}
+
+	// Visible si algún punto de una rejilla de 9x9 en cada cara está en pantalla y sin tapar.
+	bool sampledVisible(const std::vector<Wall>& walls, const Float3& center, const Float3& extents) {
+		const int steps = 8;
+		for (int axis = 0; axis < 3; ++axis) {
+			for (int side = -1; side <= 1; side += 2) {
+				for (int i = 0; i <= steps; ++i) {
+					for (int j = 0; j <= steps; ++j) {
+						float p[3];
+						const float u = (float)i / steps * 2.0f - 1.0f;
+						const float v = (float)j / steps * 2.0f - 1.0f;
+						p[axis] = (float)side;
+						p[(axis + 1) % 3] = u;
+						p[(axis + 2) % 3] = v;
+						const float x = center.x + p[0] * extents.x;
+						const float y = center.y + p[1] * extents.y;
+						const float z = center.z + p[2] * extents.z;
+						if (onScreen(x, y, z) && !blocked(walls, x, y, z))
+							return true;
+					}
+				}
+			}
+		}
+		return false;
+	}
+
+	// Muchas cajas al azar detrás y delante de los muros: ningún falso descarte, y la mayoría
+	// de las que quedan bien dentro de la sombra de un muro se descartan.
+	void testNoFalseCulls(const char* name, const std::vector<Wall>& walls, unsigned int minimumCulledPercent) {
+		OcclusionCuller culler;
+		CHECK(SUCCEEDED(culler.init(256, 128)));
+		beginFrame(culler);
+		addWalls(culler, walls);
+		CHECK(culler.getStats().rasterizedTriangles == 2 * walls.size());
+
+		std::mt19937 random(2024);
+		auto uniform = [&](float low, float high) { return std::uniform_real_distribution<float>(low, high)(random); };
+		unsigned int falseCulls = 0, hidden = 0, culled = 0;
+		for (int i = 0; i < 20000; ++i) {
+			const Float3 center(uniform(-12.0f, 12.0f), uniform(-7.0f, 7.0f), uniform(-6.0f, 30.0f));
+			const Float3 extents(uniform(0.05f, 1.5f), uniform(0.05f, 1.5f), uniform(0.05f, 1.5f));
+			const bool visible = culler.isBoxVisible(center, extents);
+			if (sampledVisible(walls, center, extents)) {
+				if (!visible && ++falseCulls <= 5)
+					fprintf(stderr, "    %s: false cull of (%g %g %g) +- (%g %g %g)\n", name,
+						center.x, center.y, center.z, extents.x, extents.y, extents.z);
+			}
+			else {
+				++hidden;
+				culled += !visible;
+			}
+		}
+		CHECK(falseCulls == 0);
+		CHECK(hidden > 1000 && culled * 100 >= hidden * minimumCulledPercent);
+		printf("%s: %u of %u hidden boxes culled, %u false culls\n", name, culled, hidden, falseCulls);
+		culler.destroy();
+	}
+
+	// Casos concretos alrededor de un muro de 8x6 en z = 0.
+	void testKnownLayout() {
+		const std::vector<Wall> walls = { { -4.0f, 4.0f, -3.0f, 3.0f, 0.0f } };
+		OcclusionCuller culler;
+		CHECK(SUCCEEDED(culler.init(256, 128)));
+		beginFrame(culler);
+		addWalls(culler, walls);
+
+		CHECK(!culler.isBoxVisible(Float3(0.0f, 0.0f, 10.0f), Float3(0.5f, 0.5f, 0.5f)));   // Detrás, en el centro
+		CHECK(!culler.isBoxVisible(Float3(2.0f, -1.0f, 3.0f), Float3(0.5f, 0.5f, 0.5f)));   // Detrás, descentrada
+		CHECK(culler.isBoxVisible(Float3(0.0f, 0.0f, -2.0f), Float3(0.5f, 0.5f, 0.5f)));    // Delante del muro
+		CHECK(culler.isBoxVisible(Float3(0.0f, 0.0f, 0.0f), Float3(0.5f, 0.5f, 0.5f)));     // Atraviesa el muro
+		CHECK(culler.isBoxVisible(Float3(9.0f, 0.0f, 10.0f), Float3(0.5f, 0.5f, 0.5f)));    // Asoma por el lado
+		CHECK(culler.isBoxVisible(Float3(0.0f, 3.0f, 0.5f), Float3(0.5f, 0.5f, 0.25f)));    // Asoma por arriba
+		CHECK(culler.isBoxVisible(Float3(0.0f, 0.0f, 20.0f), Float3(12.0f, 12.0f, 1.0f)));  // Más grande que la sombra
+		CHECK(culler.isBoxVisible(Float3(0.0f, 0.0f, -10.0f), Float3(1.0f, 1.0f, 1.0f)));   // Cruza el plano cercano
+		CHECK(!culler.isBoxVisible(Float3(500.0f, 0.0f, 10.0f), Float3(1.0f, 1.0f, 1.0f))); // Fuera de pantalla
+
+		// Las mismas cajas con cullBoxes() y cullSpheres().
+		BoundingBoxes boxes;
+		boxes.add(Float3(0.0f, 0.0f, 10.0f), Float3(0.5f, 0.5f, 0.5f));
+		boxes.add(Float3(0.0f, 0.0f, -2.0f), Float3(0.5f, 0.5f, 0.5f));
+		boxes.add(Float3(9.0f, 0.0f, 10.0f), Float3(0.5f, 0.5f, 0.5f));
+		std::vector<uint32_t> visible = { 0, 1, 2 };
+		culler.cullBoxes(boxes, visible);
+		CHECK(visible == std::vector<uint32_t>({ 1, 2 }));
+		BoundingSpheres spheres;
+		spheres.add(Float3(0.0f, 0.0f, 10.0f), 0.5f);
+		spheres.add(Float3(-9.0f, 0.0f, 10.0f), 0.5f);
+		visible = { 0, 1 };
+		culler.cullSpheres(spheres, visible);
+		CHECK(visible == std::vector<uint32_t>({ 1 }));
+		CHECK(culler.getStats().tested == 5 && culler.getStats().occluded == 2);
+
+		// Sin oclusores nada queda tapado, y un muro de espaldas no tapa.
+		beginFrame(culler);
+		culler.finishOccluders();
+		CHECK(culler.isBoxVisible(Float3(0.0f, 0.0f, 10.0f), Float3(0.5f, 0.5f, 0.5f)));
+		beginFrame(culler);
+		culler.addOccluder(QUAD, sizeof(Vertex), 4, QUAD_BACK_INDICES, 6, wallWorld(walls[0]));
+		culler.finishOccluders();
+		CHECK(culler.getStats().occluderTriangles == 2 && culler.getStats().rasterizedTriangles == 0);
+		CHECK(culler.isBoxVisible(Float3(0.0f, 0.0f, 10.0f), Float3(0.5f, 0.5f, 0.5f)));
+
+		// Un muro que cruza el plano cercano se recorta y sigue tapando lo de detrás.
+		beginFrame(culler);
+		culler.addOccluder(QUAD, sizeof(Vertex), 4, QUAD_INDICES, 6,
+			MatrixMultiply(MatrixMultiply(MatrixScaling(3.0f, 3.0f, 1.0f), MatrixRotationY(1.2f)), MatrixTranslation(0.0f, 0.0f, -8.0f)));
+		culler.finishOccluders();
+		CHECK(culler.getStats().rasterizedTriangles > 0);
+		CHECK(!culler.isBoxVisible(Float3(0.0f, 0.0f, 10.0f), Float3(0.5f, 0.5f, 0.5f)));
+		culler.destroy();
+	}
+}
+
+int
+main() {
+	testKnownLayout();
+	testNoFalseCulls("one wall", { { -4.0f, 4.0f, -3.0f, 3.0f, 0.0f } }, 80);
+	// Dos muros con una rendija entre ellos y un tercero más cerca que tapa parte de la rendija.
+	testNoFalseCulls("wall with a gap", { { -6.0f, -0.15f, -3.0f, 3.0f, 2.0f }, { 0.15f, 6.0f, -3.0f, 3.0f, 2.0f },
+		{ -1.0f, 1.0f, -1.0f, 1.0f, -3.0f } }, 75);
+	return testResult("OcclusionCullerTests");
+}
@@ -0,0 +1,187 @@
+#include "RecordingContext.h"
+#include "RenderQueue.h"
+#include "TestCommon.h"
+#include <algorithm>
+#include <random>
+
+// RenderQueue: el radix sort da el mismo orden que std::stable_sort con las claves de la
+// demo y con claves de 64 bits al azar, en un hilo y repartido en el JobSystem, y se salta
+// las pasadas con un solo dígito. Lo que graba submit() pasa por RecordingContext para ver
+// que no quedan binds repetidos ni subidas de constantes de más. Los recursos son
+// direcciones de variables sueltas; solo importa su identidad.
+
+namespace {
+
+	char layout, vertexShader, pixelShader, vertexBuffer, indexBuffer, constantBuffer;
+
+	// Solo apunta el orden de los draws: cada draw lleva su posición de add() en indexCount.
+	struct OrderExecutor {
+		std::vector<unsigned int> order;
+
+		void setInputLayout(const void*) {}
+		void setVertexBuffer(unsigned int, const void*, unsigned int, unsigned int) {}
+		void setIndexBuffer(const void*, CommandList::IndexWidth, unsigned int) {}
+		void setPrimitiveTopology(unsigned int) {}
+		void setShader(StateCache::Stage, const void*) {}
+		void setConstantBuffer(StateCache::Stage, unsigned int, const void*) {}
+		void setConstantBufferRange(StateCache::Stage, unsigned int, const void*, unsigned int, unsigned int) {}
+		void setShaderResource(StateCache::Stage, unsigned int, const void*) {}
+		void setSampler(StateCache::Stage, unsigned int, const void*) {}
+		void setViewport(const CommandList::Viewport&) {}
+		void setRenderTargets(unsigned int, const void* const*, const void*) {}
+		void updateConstantBuffer(const void*, const void*, unsigned int) {}
+		void drawIndexed(unsigned int indexCount, unsigned int, int) { order.push_back(indexCount - 1); }
+		void drawIndexedInstanced(unsigned int, unsigned int, unsigned int, int, unsigned int) {}
+	};
+
+	// Encola keys, las ordena y comprueba claves y orden de los draws contra std::stable_sort.
+	void checkSorted(JobSystem* jobs, const std::vector<uint64_t>& keys, unsigned int maxPasses) {
+		RenderQueue queue;
+		queue.init(jobs);
+		queue.reserve((unsigned int)keys.size());
+		RenderQueue::Draw draw;
+		draw.vertexBuffer = &vertexBuffer;
+		draw.indexBuffer = &indexBuffer;
+		for (size_t i = 0; i < keys.size(); ++i) {
+			draw.indexCount = (unsigned int)i + 1;
+			queue.add(keys[i], draw);
+		}
+		CommandList list;
+		queue.submit(list);
+		CHECK(queue.getStats().radixPasses <= maxPasses);
+
+		std::vector<unsigned int> expected(keys.size());
+		for (size_t i = 0; i < expected.size(); ++i)
+			expected[i] = (unsigned int)i;
+		std::stable_sort(expected.begin(), expected.end(),
+			[&](unsigned int a, unsigned int b) { return keys[a] < keys[b]; });
+		bool keysInOrder = true;
+		for (size_t i = 0; i < expected.size(); ++i)
+			keysInOrder = keysInOrder && queue.getSortedKey((unsigned int)i) == keys[expected[i]];
+		CHECK(keysInOrder);
+		OrderExecutor executor;
+		list.replay(executor);
+		CHECK(executor.order == expected);
+		queue.destroy();
+	}
+
+	// Claves como las de la demo (pocos shaders y materiales, muchas repetidas) y claves de 64
+	// bits al azar. 100k draws se reparten en varios tramos con el JobSystem.
+	void testSort(JobSystem* jobs) {
+		std::mt19937_64 random(42);
+		for (unsigned int count : { 1u, 2u, 1000u, 100000u }) {
+			std::vector<uint64_t> sceneKeys(count), randomKeys(count), depthKeys(count);
+			for (unsigned int i = 0; i < count; ++i) {
+				const uint64_t r = random();
+				sceneKeys[i] = RenderQueue::makeKey(0, (unsigned int)(r & 1), (unsigned int)(r >> 8) % 3,
+					(unsigned int)(r >> 16) % 5, (unsigned int)(r >> 24) % 4, (float)((r >> 32) % 1000) / 1000.0f);
+				randomKeys[i] = random();
+				depthKeys[i] = RenderQueue::makeKey(0, 0, 0, 0, 0, (float)(r % 4096) / 4096.0f);
+			}
+			checkSorted(jobs, sceneKeys, 6);
+			checkSorted(jobs, randomKeys, 6);
+			// Solo varía la profundidad (20 bits): el resto de pasadas se salta.
+			checkSorted(jobs, depthKeys, 2);
+		}
+
+		// Transparentes: de atrás hacia delante antes que por shader.
+		CHECK(RenderQueue::makeBackToFrontKey(0, 0, 0.9f, 5, 0, 0) < RenderQueue::makeBackToFrontKey(0, 0, 0.1f, 0, 0, 0));
+		CHECK(RenderQueue::makeKey(0, 0, 0, 0, 0, 0.9f) < RenderQueue::makeKey(0, 0, 1, 0, 0, 0.1f));
+		CHECK(RenderQueue::makeKey(1, 0, 0, 0, 0, 0.0f) > RenderQueue::makeKey(0, 15, 4095, 4095, 4095, 1.0f));
+	}
+
+	// Lo que graba RenderQueue ya no tiene binds repetidos: la caché no filtra nada.
+	void testRenderQueue() {
+		RenderQueue queue;
+		queue.init();
+		char textures[4], buffers[3];
+		RenderQueue::Draw draw;
+		draw.inputLayout = &layout;
+		draw.vertexShader = &vertexShader;
+		draw.pixelShader = &pixelShader;
+		draw.vertexStride = 32;
+		draw.constantBuffer = &constantBuffer;
+		draw.indexCount = 36;
+		for (unsigned int i = 0; i < 200; ++i) {
+			draw.vertexBuffer = &buffers[i % 3];
+			draw.indexBuffer = &buffers[i % 3];
+			draw.texture = &textures[i % 4];
+			queue.add(RenderQueue::makeKey(0, 0, 0, i % 3, i % 4, (float)i / 200.0f), draw);
+		}
+		CommandList list;
+		queue.submit(list);
+
+		RecordingContext context;
+		context.executeCommandList(list);
+		const RenderQueue::Stats& stats = queue.getStats();
+		CHECK(context.getCallCount(RecordingContext::CALL_DRAW_INDEXED) == 200);
+		CHECK(context.getCallCount(RecordingContext::CALL_PS_SHADER_RESOURCES) == stats.textureChanges);
+		CHECK(context.getCallCount(RecordingContext::CALL_VERTEX_BUFFERS) +
+			context.getCallCount(RecordingContext::CALL_INDEX_BUFFER) == stats.bufferChanges);
+		CHECK(context.m_stateCache.getTotalStats().filtered == 0);
+		queue.destroy();
+	}
+
+	// Los tramos de un objeto comparten constantes: se suben una vez. Los rangos del anillo
+	// solo se enlazan, y el mismo búfer con otro rango es un bind nuevo.
+	void testRenderQueueConstants() {
+		RenderQueue queue;
+		queue.init();
+		queue.setSortEnabled(false);
+		char ring;
+		const int objectA = 1, objectB = 2;
+		RenderQueue::Draw draw;
+		draw.inputLayout = &layout;
+		draw.vertexShader = &vertexShader;
+		draw.pixelShader = &pixelShader;
+		draw.vertexBuffer = &vertexBuffer;
+		draw.vertexStride = 32;
+		draw.indexBuffer = &indexBuffer;
+		draw.indexCount = 36;
+		draw.constantBuffer = &constantBuffer;
+		draw.constantsSize = sizeof(int);
+		const int* const uploads[] = { &objectA, &objectA, &objectA, &objectB, &objectB, &objectA };
+		for (const int* constants : uploads) {
+			draw.constants = constants;
+			queue.add(0, draw);
+		}
+		draw.constantBuffer = &ring;
+		draw.constants = nullptr;
+		draw.numConstants = 16;
+		for (unsigned int first : { 0u, 0u, 16u, 32u, 32u }) {
+			draw.firstConstant = first;
+			queue.add(0, draw);
+		}
+		// Vuelta al búfer completo: otro bind aunque el puntero de las constantes no cambie.
+		draw.constantBuffer = &constantBuffer;
+		draw.constants = &objectA;
+		draw.numConstants = 0;
+		draw.firstConstant = 0;
+		queue.add(0, draw);
+
+		CommandList list;
+		queue.submit(list);
+		RecordingContext context;
+		context.executeCommandList(list);
+		const RenderQueue::Stats& stats = queue.getStats();
+		CHECK(stats.constantUploads == 4);
+		CHECK(stats.constantChanges == 5);
+		CHECK(context.getCallCount(RecordingContext::CALL_UPDATE_SUBRESOURCE) == 4);
+		CHECK(context.getCallCount(RecordingContext::CALL_VS_CONSTANT_BUFFERS) == 5);
+		CHECK(context.getCallCount(RecordingContext::CALL_PS_CONSTANT_BUFFERS) == 5);
+		CHECK(context.m_stateCache.getTotalStats().filtered == 0);
+		queue.destroy();
+	}
+}
+
+int
+main() {
+	testSort(nullptr);
+	JobSystem jobs;
+	CHECK(SUCCEEDED(jobs.init(4)));
+	testSort(&jobs);
+	jobs.destroy();
+	testRenderQueue();
+	testRenderQueueConstants();
+	return testResult("RenderQueueTests");
+}
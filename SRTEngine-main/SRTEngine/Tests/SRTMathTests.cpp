@@ -0,0 +1,335 @@
+#include "SRTMath.h"
+#include "TestCommon.h"
+#include <cstring>
+#include <random>
+#include <vector>
+
+// Precisión de SRTMath frente a una referencia escalar en double, y funciones *Stream frente
+// a las de un elemento (deben dar los mismos bits con SSE2 y con AVX2).
+
+namespace {
+	struct Reference {
+		double m[4][4];
+	};
+
+	std::mt19937 g_random(12345);
+
+	float
+	randomFloat(float low, float high) {
+		return std::uniform_real_distribution<float>(low, high)(g_random);
+	}
+
+	Matrix
+	randomMatrix() {
+		float values[16];
+		for (float& value : values)
+			value = randomFloat(-2.0f, 2.0f);
+		return MatrixLoad(values);
+	}
+
+	Vector
+	randomAxis() {
+		for (;;) {
+			const Vector axis = VectorSet(randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f), 0.0f);
+			if (VectorGetX(Vector3Length(axis)) > 0.1f)
+				return axis;
+		}
+	}
+
+	Reference
+	toReference(const Matrix& m) {
+		Reference r;
+		for (int row = 0; row < 4; ++row) {
+			Float4 f;
+			VectorStore(f, m.r[row]);
+			r.m[row][0] = f.x;
+			r.m[row][1] = f.y;
+			r.m[row][2] = f.z;
+			r.m[row][3] = f.w;
+		}
+		return r;
+	}
+
+	Reference
+	multiply(const Reference& a, const Reference& b) {
+		Reference r;
+		for (int i = 0; i < 4; ++i) {
+			for (int j = 0; j < 4; ++j) {
+				r.m[i][j] = 0.0;
+				for (int k = 0; k < 4; ++k)
+					r.m[i][j] += a.m[i][k] * b.m[k][j];
+			}
+		}
+		return r;
+	}
+
+	/// Error máximo relativo a max(1, |esperado|) entre dos matrices.
+	double
+	matrixError(const Matrix& actual, const Reference& expected) {
+		const Reference a = toReference(actual);
+		double error = 0.0;
+		for (int i = 0; i < 4; ++i) {
+			for (int j = 0; j < 4; ++j) {
+				const double scale = std::fmax(1.0, std::fabs(expected.m[i][j]));
+				error = std::fmax(error, std::fabs(a.m[i][j] - expected.m[i][j]) / scale);
+			}
+		}
+		return error;
+	}
+
+	double
+	vectorError(Vector actual, const double expected[4], int components) {
+		const float a[4] = { VectorGetX(actual), VectorGetY(actual), VectorGetZ(actual), VectorGetW(actual) };
+		double error = 0.0;
+		for (int i = 0; i < components; ++i)
+			error = std::fmax(error, std::fabs(a[i] - expected[i]) / std::fmax(1.0, std::fabs(expected[i])));
+		return error;
+	}
+
+	/// Giro de Rodrigues en double, como matriz de vectores fila (la traspuesta de la de columnas).
+	Reference
+	rodrigues(Vector axis, double angle) {
+		double k[3] = { VectorGetX(axis), VectorGetY(axis), VectorGetZ(axis) };
+		const double length = std::sqrt(k[0] * k[0] + k[1] * k[1] + k[2] * k[2]);
+		for (double& c : k)
+			c /= length;
+		const double c = std::cos(angle), s = std::sin(angle), t = 1.0 - c;
+		Reference r = {};
+		r.m[0][0] = c + t * k[0] * k[0];
+		r.m[0][1] = t * k[0] * k[1] + s * k[2];
+		r.m[0][2] = t * k[0] * k[2] - s * k[1];
+		r.m[1][0] = t * k[1] * k[0] - s * k[2];
+		r.m[1][1] = c + t * k[1] * k[1];
+		r.m[1][2] = t * k[1] * k[2] + s * k[0];
+		r.m[2][0] = t * k[2] * k[0] + s * k[1];
+		r.m[2][1] = t * k[2] * k[1] - s * k[0];
+		r.m[2][2] = c + t * k[2] * k[2];
+		r.m[3][3] = 1.0;
+		return r;
+	}
+
+	bool
+	sameBits(Vector a, Vector b, int components) {
+		Float4 fa, fb;
+		VectorStore(fa, a);
+		VectorStore(fb, b);
+		return memcmp(&fa, &fb, components * sizeof(float)) == 0;
+	}
+
+	bool
+	sameBits(const Matrix& a, const Matrix& b) {
+		for (int row = 0; row < 4; ++row) {
+			if (!sameBits(a.r[row], b.r[row], 4))
+				return false;
+		}
+		return true;
+	}
+
+	void
+	testMultiplyAndInverse() {
+		double multiplyError = 0.0, inverseError = 0.0;
+		for (int i = 0; i < 5000; ++i) {
+			const Matrix a = randomMatrix();
+			const Matrix b = randomMatrix();
+			multiplyError = std::fmax(multiplyError, matrixError(MatrixMultiply(a, b), multiply(toReference(a), toReference(b))));
+
+			float determinant = 0.0f;
+			const Matrix inverse = MatrixInverse(a, &determinant);
+			if (std::fabs(determinant) < 0.5f)
+				continue; // Mal condicionada: el error mide la matriz, no la función.
+			Reference identity = {};
+			for (int d = 0; d < 4; ++d)
+				identity.m[d][d] = 1.0;
+			inverseError = std::fmax(inverseError, matrixError(MatrixMultiply(a, inverse), identity));
+		}
+		CHECK(multiplyError < 1e-6);
+		CHECK(inverseError < 1e-3);
+		printf("  multiply max error %.2e, inverse max error %.2e\n", multiplyError, inverseError);
+
+		float determinant = 1.0f;
+		const Matrix singular(1.0f, 2.0f, 3.0f, 4.0f, 2.0f, 4.0f, 6.0f, 8.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+		CHECK(sameBits(MatrixInverse(singular, &determinant), MatrixIdentity()));
+		CHECK(determinant == 0.0f);
+
+		const Matrix m = randomMatrix();
+		CHECK(sameBits(MatrixTranspose(MatrixTranspose(m)), m));
+	}
+
+	void
+	testTransforms() {
+		double error = 0.0;
+		for (int i = 0; i < 5000; ++i) {
+			const Matrix m = randomMatrix();
+			const Reference r = toReference(m);
+			const double p[3] = { randomFloat(-10.0f, 10.0f), randomFloat(-10.0f, 10.0f), randomFloat(-10.0f, 10.0f) };
+			const Vector v = VectorSet((float)p[0], (float)p[1], (float)p[2], 0.0f);
+
+			double point[4], normal[4];
+			for (int j = 0; j < 4; ++j) {
+				point[j] = p[0] * r.m[0][j] + p[1] * r.m[1][j] + p[2] * r.m[2][j] + r.m[3][j];
+				normal[j] = p[0] * r.m[0][j] + p[1] * r.m[1][j] + p[2] * r.m[2][j];
+			}
+			error = std::fmax(error, vectorError(Vector3Transform(v, m), point, 4));
+			error = std::fmax(error, vectorError(Vector3TransformNormal(v, m), normal, 3));
+			if (std::fabs(point[3]) > 0.5) {
+				const double coord[3] = { point[0] / point[3], point[1] / point[3], point[2] / point[3] };
+				error = std::fmax(error, vectorError(Vector3TransformCoord(v, m), coord, 3) * std::fabs(point[3]) / 10.0);
+			}
+		}
+		CHECK(error < 1e-5);
+		printf("  transform max error %.2e\n", error);
+	}
+
+	void
+	testRotations() {
+		double error = 0.0;
+		for (int i = 0; i < 5000; ++i) {
+			const Vector axis = randomAxis();
+			const float angle = randomFloat(-MATH_PI, MATH_PI);
+			error = std::fmax(error, matrixError(MatrixRotationAxis(axis, angle), rodrigues(axis, angle)));
+		}
+		const float angle = 0.7f;
+		error = std::fmax(error, matrixError(MatrixRotationX(angle), rodrigues(VectorSet(1.0f, 0.0f, 0.0f, 0.0f), angle)));
+		error = std::fmax(error, matrixError(MatrixRotationY(angle), rodrigues(VectorSet(0.0f, 1.0f, 0.0f, 0.0f), angle)));
+		error = std::fmax(error, matrixError(MatrixRotationZ(angle), rodrigues(VectorSet(0.0f, 0.0f, 1.0f, 0.0f), angle)));
+		CHECK(error < 1e-5);
+		printf("  rotation max error %.2e\n", error);
+
+		// Mano izquierda: girar +x 90 grados alrededor de +y lo lleva a -z.
+		const Vector rotated = Vector3TransformNormal(VectorSet(1.0f, 0.0f, 0.0f, 0.0f), MatrixRotationY(MATH_PIDIV2));
+		CHECK_NEAR(VectorGetZ(rotated), -1.0f, 1e-6);
+	}
+
+	void
+	testQuaternions() {
+		double error = 0.0;
+		for (int i = 0; i < 2000; ++i) {
+			const Vector q1 = QuaternionRotationAxis(randomAxis(), randomFloat(-MATH_PI, MATH_PI));
+			const Vector q2 = QuaternionRotationAxis(randomAxis(), randomFloat(-MATH_PI, MATH_PI));
+
+			// q1 seguido de q2 es M(q1) * M(q2).
+			const Reference product = multiply(toReference(MatrixRotationQuaternion(q1)), toReference(MatrixRotationQuaternion(q2)));
+			error = std::fmax(error, matrixError(MatrixRotationQuaternion(QuaternionMultiply(q1, q2)), product));
+
+			const Vector v = VectorSet(randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f), randomFloat(-1.0f, 1.0f), 0.0f);
+			const Vector expected = Vector3TransformNormal(v, MatrixRotationQuaternion(q1));
+			const double e[4] = { VectorGetX(expected), VectorGetY(expected), VectorGetZ(expected), 0.0 };
+			error = std::fmax(error, vectorError(Vector3Rotate(v, q1), e, 3));
+
+			const float pitch = randomFloat(-1.5f, 1.5f), yaw = randomFloat(-3.0f, 3.0f), roll = randomFloat(-3.0f, 3.0f);
+			const Reference euler = multiply(multiply(toReference(MatrixRotationZ(roll)), toReference(MatrixRotationX(pitch))),
+				toReference(MatrixRotationY(yaw)));
+			error = std::fmax(error, matrixError(MatrixRotationQuaternion(QuaternionRotationRollPitchYaw(pitch, yaw, roll)), euler));
+
+			const Vector scale = VectorSet(randomFloat(0.5f, 2.0f), randomFloat(0.5f, 2.0f), randomFloat(0.5f, 2.0f), 0.0f);
+			const Vector translation = VectorSet(randomFloat(-5.0f, 5.0f), randomFloat(-5.0f, 5.0f), randomFloat(-5.0f, 5.0f), 0.0f);
+			const Reference srt = multiply(multiply(toReference(MatrixScaling(VectorGetX(scale), VectorGetY(scale), VectorGetZ(scale))),
+				toReference(MatrixRotationQuaternion(q1))),
+				toReference(MatrixTranslation(VectorGetX(translation), VectorGetY(translation), VectorGetZ(translation))));
+			error = std::fmax(error, matrixError(MatrixScaleRotationTranslation(scale, q1, translation), srt));
+		}
+		CHECK(error < 1e-5);
+		printf("  quaternion max error %.2e\n", error);
+
+		// Slerp: extremos, longitud unidad y mitad del ángulo en t = 0.5.
+		const Vector axis = VectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+		const Vector q0 = QuaternionRotationAxis(axis, 0.2f);
+		const Vector q1 = QuaternionRotationAxis(axis, 1.8f);
+		const Vector half = QuaternionSlerp(q0, q1, 0.5f);
+		const Vector expected = QuaternionRotationAxis(axis, 1.0f);
+		CHECK_NEAR(VectorGetX(Vector4Dot(QuaternionSlerp(q0, q1, 0.0f), q0)), 1.0f, 1e-6);
+		CHECK_NEAR(VectorGetX(Vector4Dot(QuaternionSlerp(q0, q1, 1.0f), q1)), 1.0f, 1e-6);
+		CHECK_NEAR(VectorGetX(Vector4Length(half)), 1.0f, 1e-6);
+		CHECK_NEAR(VectorGetX(Vector4Dot(half, expected)), 1.0f, 1e-6);
+
+		// Camino corto: -q1 es el mismo giro y da el mismo resultado.
+		const Vector shortPath = QuaternionSlerp(q0, VectorNegate(q1), 0.5f);
+		CHECK_NEAR(VectorGetX(Vector4Dot(shortPath, expected)), 1.0f, 1e-6);
+	}
+
+	void
+	testCameras() {
+		const Vector eye = VectorSet(1.0f, 2.0f, -5.0f, 0.0f);
+		const Vector at = VectorSet(0.5f, 0.0f, 3.0f, 0.0f);
+		const Matrix view = MatrixLookAtLH(eye, at, VectorSet(0.0f, 1.0f, 0.0f, 0.0f));
+		const Vector eyeInView = Vector3TransformCoord(eye, view);
+		const Vector atInView = Vector3TransformCoord(at, view);
+		const float distance = VectorGetX(Vector3Length(VectorSubtract(at, eye)));
+		CHECK_NEAR(VectorGetX(Vector3Length(eyeInView)), 0.0f, 1e-5);
+		CHECK_NEAR(VectorGetX(atInView), 0.0f, 1e-5);
+		CHECK_NEAR(VectorGetY(atInView), 0.0f, 1e-5);
+		CHECK_NEAR(VectorGetZ(atInView), distance, 1e-5);
+
+		const float nearZ = 0.01f, farZ = 100.0f, aspect = 1200.0f / 1010.0f;
+		const Matrix projection = MatrixPerspectiveFovLH(MATH_PIDIV4, aspect, nearZ, farZ);
+		CHECK_NEAR(VectorGetZ(Vector3TransformCoord(VectorSet(0.0f, 0.0f, nearZ, 0.0f), projection)), 0.0f, 1e-6);
+		CHECK_NEAR(VectorGetZ(Vector3TransformCoord(VectorSet(0.0f, 0.0f, farZ, 0.0f), projection)), 1.0f, 1e-6);
+		const float edge = std::tan(MATH_PIDIV4 * 0.5f) * 10.0f;
+		CHECK_NEAR(VectorGetY(Vector3TransformCoord(VectorSet(0.0f, edge, 10.0f, 0.0f), projection)), 1.0f, 1e-5);
+		CHECK_NEAR(VectorGetX(Vector3TransformCoord(VectorSet(edge * aspect, 0.0f, 10.0f, 0.0f), projection)), 1.0f, 1e-5);
+
+		const Matrix ortho = MatrixOrthographicLH(8.0f, 6.0f, 1.0f, 11.0f);
+		const Vector corner = Vector3TransformCoord(VectorSet(4.0f, -3.0f, 11.0f, 0.0f), ortho);
+		CHECK_NEAR(VectorGetX(corner), 1.0f, 1e-6);
+		CHECK_NEAR(VectorGetY(corner), -1.0f, 1e-6);
+		CHECK_NEAR(VectorGetZ(corner), 1.0f, 1e-6);
+	}
+
+	// Tamaños con y sin resto para cubrir el bucle de dos en dos de AVX2 y su cola.
+	void
+	testStreams() {
+		const Matrix m = randomMatrix();
+		const size_t inStride = 20; // Posición de un vértice entrelazado (float3 + float2).
+		for (size_t count = 0; count < 40; ++count) {
+			std::vector<uint8_t> input(count * inStride + 4);
+			for (size_t i = 0; i < count; ++i) {
+				const Float3 p(randomFloat(-10.0f, 10.0f), randomFloat(-10.0f, 10.0f), randomFloat(-10.0f, 10.0f));
+				memcpy(input.data() + i * inStride, &p, sizeof(p));
+			}
+
+			std::vector<Float4> transformed(count);
+			std::vector<Float3> coords(count), normals(count);
+			Vector3TransformStream(transformed.data(), sizeof(Float4), input.data(), inStride, count, m);
+			Vector3TransformCoordStream(coords.data(), sizeof(Float3), input.data(), inStride, count, m);
+			Vector3TransformNormalStream(normals.data(), sizeof(Float3), input.data(), inStride, count, m);
+			for (size_t i = 0; i < count; ++i) {
+				Float3 p;
+				memcpy(&p, input.data() + i * inStride, sizeof(p));
+				const Vector v = VectorLoad(p);
+				CHECK(sameBits(VectorLoad(transformed[i]), Vector3Transform(v, m), 4));
+				CHECK(sameBits(VectorLoad(coords[i]), Vector3TransformCoord(v, m), 3));
+				CHECK(sameBits(VectorLoad(normals[i]), Vector3TransformNormal(v, m), 3));
+			}
+
+			std::vector<Matrix> matrices(count), products(count);
+			for (Matrix& matrix : matrices)
+				matrix = randomMatrix();
+			MatrixMultiplyStream(products.data(), matrices.data(), count, m);
+			for (size_t i = 0; i < count; ++i)
+				CHECK(sameBits(products[i], MatrixMultiply(matrices[i], m)));
+
+			// En el sitio.
+			MatrixMultiplyStream(matrices.data(), matrices.data(), count, m);
+			for (size_t i = 0; i < count; ++i)
+				CHECK(sameBits(matrices[i], products[i]));
+		}
+	}
+}
+
+int
+main() {
+#if defined(SRT_MATH_SCALAR)
+	printf("SRTMath scalar\n");
+#elif defined(SRT_SIMD_AVX2)
+	printf("SRTMath SSE2 + AVX2 streams\n");
+#else
+	printf("SRTMath SSE2\n");
+#endif
+	testMultiplyAndInverse();
+	testTransforms();
+	testRotations();
+	testQuaternions();
+	testCameras();
+	testStreams();
+	return testResult("SRTMathTests");
+}
@@ -0,0 +1,348 @@
+#include "SoftRasterizer.h"
+#include "CommandList.h"
+#include "InstanceBatcher.h"
+#include "TestCommon.h"
+
+// El rasterizador por software contra sí mismo: cada draw transforma solo los vértices que
+// usan sus índices, DrawIndexedInstanced da la misma imagen que un DrawIndexed por instancia
+// con el mundo en CBChangesEveryFrame, y los vértices comprimidos de VertexFormat (con la
+// matriz de decodificación delante del mundo) dan casi la misma imagen que los float.
+
+namespace {
+
+	const unsigned int WIDTH = 160;
+	const unsigned int HEIGHT = 120;
+
+	// CBChangesEveryFrame: mundo transpuesto y vMeshColor, como los sube la demo.
+	struct ObjectConstants {
+		Matrix world;
+		Float4 color;
+	};
+
+	// Rejilla de n x n quads en [-1, 1] con relieve en z.
+	struct Mesh {
+		std::vector<Float3> positions;
+		std::vector<Float2> uvs;
+		std::vector<uint16_t> indices;
+	};
+
+	Mesh makeGrid(unsigned int n) {
+		Mesh mesh;
+		for (unsigned int y = 0; y <= n; ++y) {
+			for (unsigned int x = 0; x <= n; ++x) {
+				const float u = (float)x / n;
+				const float v = (float)y / n;
+				const float px = u * 2.0f - 1.0f;
+				const float py = 1.0f - v * 2.0f;
+				mesh.positions.push_back(Float3(px, py, 0.15f * std::sin(3.0f * px) * std::cos(3.0f * py)));
+				mesh.uvs.push_back(Float2(u, v));
+			}
+		}
+		for (unsigned int y = 0; y < n; ++y) {
+			for (unsigned int x = 0; x < n; ++x) {
+				const uint16_t i = (uint16_t)(y * (n + 1) + x);
+				const uint16_t row = (uint16_t)(n + 1);
+				const uint16_t quad[6] = { i, (uint16_t)(i + 1), (uint16_t)(i + row + 1),
+					i, (uint16_t)(i + row + 1), (uint16_t)(i + row) };
+				mesh.indices.insert(mesh.indices.end(), quad, quad + 6);
+			}
+		}
+		return mesh;
+	}
+
+	void store(SoftBuffer& buffer, const void* data, size_t size) {
+		buffer.m_data.resize(size);
+		memcpy(buffer.m_data.data(), data, size);
+	}
+
+	void storeTransposed(SoftBuffer& buffer, const Matrix& m) {
+		const Matrix transposed = MatrixTranspose(m);
+		store(buffer, &transposed, sizeof(transposed));
+	}
+
+	// Cámara, textura de ajedrez y búferes que comparten todas las pruebas.
+	struct Scene {
+		SoftBuffer view, projection, object, vertices, indices, instances;
+		SoftTexture checker;
+		SoftInputLayout layout;
+
+		Scene() {
+			storeTransposed(view, MatrixLookAtLH(VectorSet(0.0f, 0.0f, -6.0f, 1.0f),
+				VectorSet(0.0f, 0.0f, 0.0f, 1.0f), VectorSet(0.0f, 1.0f, 0.0f, 0.0f)));
+			storeTransposed(projection, MatrixPerspectiveFovLH(0.8f, (float)WIDTH / HEIGHT, 0.1f, 100.0f));
+			ObjectConstants constants{ MatrixIdentity(), Float4(1.0f, 1.0f, 1.0f, 1.0f) };
+			store(object, &constants, sizeof(constants));
+
+			checker.m_width = checker.m_height = 8;
+			for (unsigned int i = 0; i < 64; ++i)
+				checker.m_texels.push_back(((i & 1) ^ ((i >> 3) & 1)) ? 0xFF20C0E0u : 0xFF402010u);
+		}
+
+		void setFloatVertices(const Mesh& mesh) {
+			layout = SoftInputLayout();
+			VertexFormat::Source source;
+			source.streams[SEMANTIC_POSITION] = { mesh.positions.data(), sizeof(Float3) };
+			source.streams[SEMANTIC_TEXCOORD] = { mesh.uvs.data(), sizeof(Float2) };
+			vertices.m_data.resize(mesh.positions.size() * layout.m_format.getStride());
+			layout.m_format.encode(source, mesh.positions.size(), vertices.m_data.data());
+			store(indices, mesh.indices.data(), mesh.indices.size() * sizeof(uint16_t));
+		}
+
+		void bind(SoftRasterizer& rasterizer) const {
+			const SoftBuffer* constants[3] = { &view, &projection, &object };
+			const SoftBuffer* vertexBuffer = &vertices;
+			const SoftTexture* texture = &checker;
+			const unsigned int stride = layout.m_format.getStride();
+			const unsigned int offset = 0;
+			rasterizer.IASetInputLayout(&layout);
+			rasterizer.IASetVertexBuffers(0, 1, &vertexBuffer, &stride, &offset);
+			rasterizer.IASetIndexBuffer(&indices, SOFT_INDEX_16, 0);
+			rasterizer.VSSetConstantBuffers(0, 3, constants);
+			rasterizer.PSSetConstantBuffers(2, 1, &constants[2]);
+			rasterizer.PSSetShaderResources(0, 1, &texture);
+		}
+	};
+
+	void clear(SoftRasterizer& rasterizer) {
+		const float black[4] = { 0.0f, 0.0f, 0.0f, 1.0f };
+		rasterizer.ClearRenderTargetView(black);
+		rasterizer.ClearDepthStencilView(1.0f);
+		rasterizer.resetStats();
+	}
+
+	// Copia la parte visible del render target.
+	std::vector<uint32_t> image(const SoftRasterizer& rasterizer) {
+		const SoftRenderTarget& target = rasterizer.m_renderTarget;
+		std::vector<uint32_t> pixels;
+		for (unsigned int y = 0; y < target.m_height; ++y) {
+			const uint32_t* row = &target.m_color[(size_t)y * target.m_pitch];
+			pixels.insert(pixels.end(), row, row + target.m_width);
+		}
+		return pixels;
+	}
+
+	// Píxeles con algún canal que difiere en más de tolerance.
+	unsigned int countDifferent(const std::vector<uint32_t>& a, const std::vector<uint32_t>& b,
+		int tolerance = 0) {
+		unsigned int different = 0;
+		for (size_t i = 0; i < a.size(); ++i) {
+			for (int shift = 0; shift < 32; shift += 8) {
+				if (std::abs((int)((a[i] >> shift) & 0xFF) - (int)((b[i] >> shift) & 0xFF)) > tolerance) {
+					++different;
+					break;
+				}
+			}
+		}
+		return different;
+	}
+
+	InstanceData instanceAt(unsigned int i) {
+		const Matrix world = MatrixMultiply(MatrixRotationZ(0.3f * i),
+			MatrixTranslation(-2.5f + 1.25f * i, 0.4f * ((i & 1) ? 1.0f : -1.0f), 0.5f * i));
+		InstanceData data;
+		for (int row = 0; row < 4; ++row)
+			VectorStore(data.world[row], world.r[row]);
+		data.color = Float4(0.2f + 0.2f * i, 1.0f - 0.15f * i, 0.5f, 1.0f);
+		return data;
+	}
+
+	// Un quad en los vértices 500..503 de un búfer de 1000: solo se transforman esos cuatro,
+	// tanto con los índices absolutos como con BaseVertexLocation.
+	void testReferencedRange(SoftRasterizer& rasterizer) {
+		Mesh mesh;
+		for (unsigned int i = 0; i < 1000; ++i) {
+			const float x = (i & 1) ? 1.0f : -1.0f;
+			const float y = (i & 2) ? -1.0f : 1.0f;
+			mesh.positions.push_back(Float3(x, y, 0.0f));
+			mesh.uvs.push_back(Float2(x * 0.5f + 0.5f, 0.5f - y * 0.5f));
+		}
+		const uint16_t absolute[6] = { 500, 501, 503, 500, 503, 502 };
+		mesh.indices.assign(absolute, absolute + 6);
+		const uint16_t relative[6] = { 0, 1, 3, 0, 3, 2 };
+		mesh.indices.insert(mesh.indices.end(), relative, relative + 6);
+
+		Scene scene;
+		scene.setFloatVertices(mesh);
+		scene.bind(rasterizer);
+
+		clear(rasterizer);
+		rasterizer.DrawIndexed(6, 0, 0);
+		CHECK(rasterizer.getStats().verticesTransformed == 4);
+		CHECK(rasterizer.getStats().trianglesSubmitted == 2);
+		rasterizer.flush();
+		CHECK(rasterizer.getStats().pixelsWritten > 0);
+		const std::vector<uint32_t> first = image(rasterizer);
+
+		clear(rasterizer);
+		rasterizer.DrawIndexed(6, 6, 500);
+		CHECK(rasterizer.getStats().verticesTransformed == 4);
+		rasterizer.flush();
+		CHECK(countDifferent(first, image(rasterizer)) == 0);
+
+		// Índices fuera del búfer: el rango se recorta y los triángulos que salen se descartan.
+		clear(rasterizer);
+		rasterizer.DrawIndexed(6, 6, 998);
+		CHECK(rasterizer.getStats().verticesTransformed == 2);
+		CHECK(rasterizer.getStats().trianglesRasterized == 0);
+	}
+
+	// N instancias en un draw contra N DrawIndexed con el mundo en las constantes, directo y
+	// reproducido desde una CommandList.
+	void testInstancing(SoftRasterizer& rasterizer) {
+		const unsigned int INSTANCES = 5;
+		Scene scene;
+		scene.setFloatVertices(makeGrid(12));
+		const unsigned int indexCount = (unsigned int)(scene.indices.m_data.size() / sizeof(uint16_t));
+
+		clear(rasterizer);
+		scene.bind(rasterizer);
+		for (unsigned int i = 0; i < INSTANCES; ++i) {
+			const InstanceData data = instanceAt(i);
+			ObjectConstants constants;
+			for (int row = 0; row < 4; ++row)
+				constants.world.r[row] = VectorLoad(data.world[row]);
+			constants.world = MatrixTranspose(constants.world);
+			constants.color = data.color;
+			rasterizer.UpdateSubresource(&scene.object, &constants, sizeof(constants));
+			rasterizer.DrawIndexed(indexCount, 0, 0);
+		}
+		const SoftRasterizer::Stats separateStats = rasterizer.getStats();
+		rasterizer.flush();
+		const std::vector<uint32_t> separate = image(rasterizer);
+		CHECK(rasterizer.getStats().pixelsWritten > 0);
+
+		// Una instancia de más al principio para probar StartInstanceLocation.
+		std::vector<InstanceData> instances(1, instanceAt(INSTANCES));
+		for (unsigned int i = 0; i < INSTANCES; ++i)
+			instances.push_back(instanceAt(i));
+		store(scene.instances, instances.data(), instances.size() * sizeof(InstanceData));
+		const SoftBuffer* instanceBuffer = &scene.instances;
+		const unsigned int instanceStride = sizeof(InstanceData);
+		const unsigned int instanceOffset = 0;
+
+		clear(rasterizer);
+		scene.bind(rasterizer);
+		rasterizer.IASetVertexBuffers(1, 1, &instanceBuffer, &instanceStride, &instanceOffset);
+		rasterizer.DrawIndexedInstanced(indexCount, INSTANCES, 0, 0, 1);
+		const SoftRasterizer::Stats instancedStats = rasterizer.getStats();
+		CHECK(instancedStats.draws == 1 && separateStats.draws == INSTANCES);
+		CHECK(instancedStats.instances == INSTANCES && separateStats.instances == INSTANCES);
+		CHECK(instancedStats.verticesTransformed == separateStats.verticesTransformed);
+		CHECK(instancedStats.trianglesSubmitted == separateStats.trianglesSubmitted);
+		rasterizer.flush();
+		CHECK(countDifferent(separate, image(rasterizer)) == 0);
+
+		CommandList list;
+		list.setInputLayout(&scene.layout);
+		list.setVertexBuffer(0, &scene.vertices, scene.layout.m_format.getStride(), 0);
+		list.setVertexBuffer(1, &scene.instances, sizeof(InstanceData), 0);
+		list.setIndexBuffer(&scene.indices, CommandList::INDEX_16, 0);
+		list.setConstantBuffer(StateCache::VERTEX_STAGE, 0, &scene.view);
+		list.setConstantBuffer(StateCache::VERTEX_STAGE, 1, &scene.projection);
+		list.setShaderResource(StateCache::PIXEL_STAGE, 0, &scene.checker);
+		list.drawIndexedInstanced(indexCount, INSTANCES, 0, 0, 1);
+		CHECK(list.getDrawCount() == 1);
+		clear(rasterizer);
+		rasterizer.executeCommandList(list);
+		rasterizer.flush();
+		CHECK(countDifferent(separate, image(rasterizer)) == 0);
+
+		// Sin búfer de instancias suficiente no se dibuja nada.
+		clear(rasterizer);
+		rasterizer.DrawIndexedInstanced(indexCount, (unsigned int)instances.size() + 1, 0, 0, 0);
+		CHECK(rasterizer.getStats().draws == 0);
+	}
+
+	// Posiciones UNORM16X4 y UV HALF2 con getPositionDecodeMatrix() delante del mundo contra los
+	// mismos vértices en float: el color puede variar en una unidad por canal por el error de las UV
+	// en half, y la cobertura solo en píxeles sueltos de los bordes.
+	void testVertexFormat(SoftRasterizer& rasterizer) {
+		const Mesh mesh = makeGrid(24);
+		const Matrix world = MatrixMultiply(MatrixRotationY(0.5f), MatrixScaling(1.8f, 1.8f, 1.8f));
+
+		Scene scene;
+		scene.setFloatVertices(mesh);
+		ObjectConstants constants{ MatrixTranspose(world), Float4(1.0f, 1.0f, 1.0f, 1.0f) };
+		store(scene.object, &constants, sizeof(constants));
+		clear(rasterizer);
+		scene.bind(rasterizer);
+		rasterizer.DrawIndexed((unsigned int)mesh.indices.size(), 0, 0);
+		rasterizer.flush();
+		const uint64_t covered = rasterizer.getStats().pixelsWritten;
+		const std::vector<uint32_t> reference = image(rasterizer);
+		CHECK(covered > WIDTH * HEIGHT / 10);
+
+		VertexFormat format;
+		CHECK(SUCCEEDED(format.add(SEMANTIC_POSITION, ENCODING_UNORM16X4)));
+		CHECK(SUCCEEDED(format.add(SEMANTIC_TEXCOORD, ENCODING_HALF2)));
+		format.setBounds(Float3(-1.0f, -1.0f, -0.15f), Float3(1.0f, 1.0f, 0.15f));
+		CHECK(format.getStride() == 12);
+		VertexFormat::Source source;
+		source.streams[SEMANTIC_POSITION] = { mesh.positions.data(), sizeof(Float3) };
+		source.streams[SEMANTIC_TEXCOORD] = { mesh.uvs.data(), sizeof(Float2) };
+		scene.layout = SoftInputLayout(format);
+		scene.vertices.m_data.resize(mesh.positions.size() * format.getStride());
+		CHECK(SUCCEEDED(format.encode(source, mesh.positions.size(), scene.vertices.m_data.data())));
+		constants.world = MatrixTranspose(MatrixMultiply(format.getPositionDecodeMatrix(), world));
+		store(scene.object, &constants, sizeof(constants));
+
+		clear(rasterizer);
+		scene.bind(rasterizer);
+		rasterizer.DrawIndexed((unsigned int)mesh.indices.size(), 0, 0);
+		rasterizer.flush();
+		const uint64_t compressedCovered = rasterizer.getStats().pixelsWritten;
+		CHECK(compressedCovered + covered / 50 >= covered && compressedCovered <= covered + covered / 50);
+		CHECK(countDifferent(reference, image(rasterizer), 2) <= covered / 100);
+	}
+
+	// Rejilla con la cámara y el mundo de Scene, dibujada justo después de init().
+	std::vector<uint32_t> drawGrid(SoftRasterizer& rasterizer, const Scene& scene, const Mesh& mesh) {
+		clear(rasterizer);
+		scene.bind(rasterizer);
+		rasterizer.DrawIndexed((unsigned int)mesh.indices.size(), 0, 0);
+		rasterizer.flush();
+		return image(rasterizer);
+	}
+
+	// destroy() + init() con hilos, como hace la demo en cada WM_SIZE (también con otro tamaño
+	// entre medias): los hilos nuevos no pueden arrancar con trabajo de la vida anterior, y
+	// cada frame tiene que ser idéntico al de un solo hilo.
+	void testReinit() {
+		const Mesh mesh = makeGrid(32);
+		Scene scene;
+		scene.setFloatVertices(mesh);
+
+		SoftRasterizer single;
+		CHECK(SUCCEEDED(single.init(WIDTH, HEIGHT, 1)));
+		const std::vector<uint32_t> reference = drawGrid(single, scene, mesh);
+		single.destroy();
+
+		SoftRasterizer rasterizer;
+		for (unsigned int i = 0; i < 24; ++i) {
+			CHECK(SUCCEEDED(rasterizer.init(i % 3 == 2 ? WIDTH / 2 : WIDTH, i % 3 == 2 ? HEIGHT / 2 : HEIGHT, 4)));
+			if (i % 3 != 2) {
+				for (int frame = 0; frame < 3; ++frame)
+					CHECK(countDifferent(reference, drawGrid(rasterizer, scene, mesh)) == 0);
+			}
+			else {
+				drawGrid(rasterizer, scene, mesh);
+			}
+			rasterizer.destroy();
+		}
+	}
+}
+
+int
+main() {
+	for (unsigned int threads : { 1u, 3u }) {
+		SoftRasterizer rasterizer;
+		CHECK(SUCCEEDED(rasterizer.init(WIDTH, HEIGHT, threads)));
+		CHECK(rasterizer.getThreadCount() == threads);
+		testReferencedRange(rasterizer);
+		testInstancing(rasterizer);
+		testVertexFormat(rasterizer);
+		rasterizer.destroy();
+	}
+	testReinit();
+	return testResult("SoftRasterizerTests");
+}
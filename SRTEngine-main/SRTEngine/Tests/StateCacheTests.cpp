@@ -0,0 +1,178 @@
+#include "RecordingContext.h"
+#include "TestCommon.h"
+#include <random>
+
+// StateCache a través de RecordingContext: qué llamadas llegan al driver, recorte de rangos y
+// la regla de riesgos entre SRV y render targets. Los objetos son direcciones de variables
+// sueltas; solo importa su identidad.
+
+namespace {
+
+	char textureA, textureB, depthTexture, renderTextureC;
+	char srvA, srvB, srvDepth, srvUnknown, rtvBack, rtvC, dsvDepth, dsvOther, otherDepth;
+	char layout, vertexShader, pixelShader, vertexBuffer, indexBuffer, constantBuffer, sampler;
+
+	void registerViews(RecordingContext& context) {
+		context.registerView(&srvA, &textureA);
+		context.registerView(&srvB, &textureB);
+		context.registerView(&srvDepth, &depthTexture);
+		context.registerView(&rtvC, &renderTextureC);
+		context.registerView(&dsvDepth, &depthTexture);
+		context.registerView(&dsvOther, &otherDepth);
+		// rtvBack y srvUnknown no se registran: su recurso es desconocido.
+	}
+
+	void setTarget(RecordingContext& context, const void* rtv, const void* dsv) {
+		const void* views[1] = { rtv };
+		context.setRenderTargets(1, views, dsv);
+	}
+
+	void testRedundantBinds() {
+		RecordingContext context;
+		CommandList list;
+		for (int i = 0; i < 2; ++i) {
+			list.setInputLayout(&layout);
+			list.setShader(StateCache::VERTEX_STAGE, &vertexShader);
+			list.setShader(StateCache::PIXEL_STAGE, &pixelShader);
+			list.setVertexBuffer(0, &vertexBuffer, 32, 0);
+			list.setIndexBuffer(&indexBuffer, CommandList::INDEX_16, 0);
+			list.setConstantBuffer(StateCache::VERTEX_STAGE, 2, &constantBuffer);
+			list.setShaderResource(StateCache::PIXEL_STAGE, 0, &srvA);
+			list.setSampler(StateCache::PIXEL_STAGE, 0, &sampler);
+			list.updateConstantBuffer(&constantBuffer, &i, sizeof(i));
+			list.drawIndexed(36, 0, 0);
+		}
+		context.executeCommandList(list);
+		CHECK(context.getStateCallCount() == 8);
+		CHECK(context.getCallCount(RecordingContext::CALL_UPDATE_SUBRESOURCE) == 2);
+		CHECK(context.getCallCount(RecordingContext::CALL_DRAW_INDEXED) == 2);
+		CHECK(context.m_stateCache.getTotalStats().issued == 8);
+		CHECK(context.m_stateCache.getTotalStats().filtered == 8);
+
+		// Sin filtrar pasa todo.
+		context.reset();
+		context.m_stateCache.setEnabled(false);
+		context.executeCommandList(list);
+		CHECK(context.getStateCallCount() == 16);
+
+		// Tras ClearState el estado es desconocido y la siguiente llamada pasa.
+		context.reset();
+		context.m_stateCache.setEnabled(true);
+		context.executeCommandList(list);
+		context.ClearState();
+		context.executeCommandList(list);
+		CHECK(context.getStateCallCount() == 16);
+	}
+
+	void testRanges() {
+		StateCache cache;
+		const void* buffers[3] = { &vertexBuffer, &indexBuffer, &constantBuffer };
+		const unsigned int strides[3] = { 32, 32, 32 };
+		const unsigned int offsets[3] = { 0, 0, 0 };
+		unsigned int first, count;
+		CHECK(cache.setVertexBuffers(0, 3, buffers, strides, offsets, first, count));
+		CHECK(first == 0 && count == 3);
+		const void* changed[3] = { &vertexBuffer, &layout, &constantBuffer };
+		CHECK(cache.setVertexBuffers(0, 3, changed, strides, offsets, first, count));
+		CHECK(first == 1 && count == 1);
+		CHECK(!cache.setVertexBuffers(0, 3, changed, strides, offsets, first, count));
+
+		const void* views[4] = { &srvA, &srvB, &srvA, &srvB };
+		CHECK(cache.setShaderResources(StateCache::PIXEL_STAGE, 2, 4, views, first, count));
+		views[3] = &srvDepth;
+		CHECK(cache.setShaderResources(StateCache::PIXEL_STAGE, 2, 4, views, first, count));
+		CHECK(first == 5 && count == 1);
+	}
+
+	void testTargetHazards() {
+		RecordingContext context;
+		registerViews(context);
+
+		setTarget(context, &rtvC, &dsvOther);
+		context.setShaderResource(StateCache::PIXEL_STAGE, 0, &srvA);
+		context.setShaderResource(StateCache::PIXEL_STAGE, 1, &srvDepth);
+		context.drawIndexed(3, 0, 0);
+		CHECK(context.getCallCount(RecordingContext::CALL_PS_SHADER_RESOURCES) == 2);
+
+		// Un target que no comparte recurso con ningún SRV no los desenlaza.
+		setTarget(context, &rtvBack, &dsvOther);
+		context.setShaderResource(StateCache::PIXEL_STAGE, 0, &srvA);
+		context.setShaderResource(StateCache::PIXEL_STAGE, 1, &srvDepth);
+		context.drawIndexed(3, 0, 0);
+		CHECK(context.getCallCount(RecordingContext::CALL_RENDER_TARGETS) == 2);
+		CHECK(context.getCallCount(RecordingContext::CALL_PS_SHADER_RESOURCES) == 2);
+
+		// El depth stencil pasa a ser la textura del slot 1: el driver la quita del SRV.
+		setTarget(context, &rtvBack, &dsvDepth);
+		CHECK(context.getDriverShaderResource(0) == &srvA);
+		CHECK(context.getDriverShaderResource(1) == nullptr);
+		context.setShaderResource(StateCache::PIXEL_STAGE, 0, &srvA);
+		CHECK(context.getCallCount(RecordingContext::CALL_PS_SHADER_RESOURCES) == 2);
+
+		// Enlazarla mientras es target deja el slot a nulo; el draw no cuenta como perdido.
+		context.setShaderResource(StateCache::PIXEL_STAGE, 1, &srvDepth);
+		CHECK(context.getCallCount(RecordingContext::CALL_PS_SHADER_RESOURCES) == 3);
+		CHECK(context.getDriverShaderResource(1) == nullptr);
+		context.drawIndexed(3, 0, 0);
+
+		// Vuelve a ser solo textura: el mismo bind tiene que llegar al driver.
+		setTarget(context, &rtvBack, &dsvOther);
+		context.setShaderResource(StateCache::PIXEL_STAGE, 1, &srvDepth);
+		CHECK(context.getCallCount(RecordingContext::CALL_PS_SHADER_RESOURCES) == 4);
+		CHECK(context.getDriverShaderResource(1) == &srvDepth);
+		context.drawIndexed(3, 0, 0);
+
+		// Con un SRV de recurso desconocido se supone lo peor al cambiar de target.
+		context.setShaderResource(StateCache::PIXEL_STAGE, 2, &srvUnknown);
+		setTarget(context, &rtvC, &dsvOther);
+		context.setShaderResource(StateCache::PIXEL_STAGE, 2, &srvUnknown);
+		context.setShaderResource(StateCache::PIXEL_STAGE, 0, &srvA);
+		CHECK(context.getCallCount(RecordingContext::CALL_PS_SHADER_RESOURCES) == 6);
+		context.drawIndexed(3, 0, 0);
+
+		CHECK(context.getStaleDrawCount() == 0);
+	}
+
+	// Secuencias aleatorias de targets y texturas: la caché nunca deja un draw sin su SRV.
+	void testRandomSequences() {
+		const void* const textures[] = { &srvA, &srvB, &srvDepth, &srvUnknown, nullptr };
+		const void* const targets[] = { &rtvBack, &rtvC };
+		const void* const depths[] = { nullptr, &dsvDepth, &dsvOther };
+		std::mt19937 random(3);
+		CommandList list;
+		for (int i = 0; i < 20000; ++i) {
+			const unsigned int choice = random() % 8;
+			if (choice == 0) {
+				const void* views[1] = { targets[random() % 2] };
+				list.setRenderTargets(1, views, depths[random() % 3]);
+			}
+			else if (choice < 5) {
+				list.setShaderResource(StateCache::PIXEL_STAGE, random() % 3, textures[random() % 5]);
+			}
+			else {
+				list.drawIndexed(3, 0, 0);
+			}
+		}
+
+		RecordingContext filtered, unfiltered;
+		registerViews(filtered);
+		registerViews(unfiltered);
+		unfiltered.m_stateCache.setEnabled(false);
+		filtered.executeCommandList(list);
+		unfiltered.executeCommandList(list);
+		CHECK(filtered.getStaleDrawCount() == 0);
+		CHECK(unfiltered.getStaleDrawCount() == 0);
+		CHECK(filtered.getStateCallCount() < unfiltered.getStateCallCount());
+		for (unsigned int slot = 0; slot < 3; ++slot)
+			CHECK(filtered.getDriverShaderResource(slot) == unfiltered.getDriverShaderResource(slot));
+	}
+}
+
+int
+main() {
+	testRedundantBinds();
+	testRanges();
+	testTargetHazards();
+	testRandomSequences();
+	return testResult("StateCacheTests");
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <cmath>
+#include <cstdio>
+
+/**
+ * @file TestCommon.h
+ * @brief Comprobaciones de los tests de CPU.
+ *
+ * Cada test es un ejecutable de CTest. CHECK no aborta: imprime archivo y línea y cuenta el
+ * fallo, así que una pasada muestra todos los errores; main() termina con
+ * return testResult("Nombre").
+ */
+
+namespace test {
+    inline int& failures() {
+        static int count = 0;
+        return count;
+    }
+
+    inline void fail(const char* file, int line, const char* expression) {
+        ++failures();
+        fprintf(stderr, "%s:%d: CHECK(%s) failed\n", file, line, expression);
+    }
+}
+
+#define CHECK(condition)                                        \
+    do {                                                        \
+        if (!(condition))                                       \
+            test::fail(__FILE__, __LINE__, #condition);         \
+    } while (0)
+
+#define CHECK_NEAR(a, b, tolerance)                                                     \
+    do {                                                                                \
+        const double a_ = (double)(a), b_ = (double)(b);                                \
+        if (!(std::fabs(a_ - b_) <= (double)(tolerance))) {                             \
+            test::fail(__FILE__, __LINE__, #a " ~= " #b);                               \
+            fprintf(stderr, "    %.9g vs %.9g (tolerance %g)\n", a_, b_, (double)(tolerance)); \
+        }                                                                               \
+    } while (0)
+
+/// Resumen del test; el valor es el código de salida de main().
+inline int testResult(const char* name) {
+    if (test::failures() == 0) {
+        printf("%s: OK\n", name);
+        return 0;
+    }
+    printf("%s: %d checks failed\n", name, test::failures());
+    return 1;
+}
@@ -0,0 +1,233 @@
+#include "TextureCache.h"
+#include "TestCommon.h"
+#include <atomic>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+// TextureCache sin dispositivo (las imágenes se quedan en CPU): deduplicación por ruta y por
+// contenido, expulsión LRU al pasar del presupuesto sin tocar las entradas referenciadas, y
+// muchos hilos pidiendo y soltando a la vez las mismas rutas con un presupuesto pequeño.
+// Las imágenes son TGA de 32 bits de un solo color que se escriben en el directorio actual.
+
+namespace {
+
+	const unsigned int SIZE = 32;
+	const unsigned int IMAGES = 12;   // La imagen i y la i + IMAGES / 2 tienen el mismo contenido.
+	const unsigned int COLORS = IMAGES / 2;
+
+	std::string imageName(unsigned int index) {
+		return "TextureCacheTests_" + std::to_string(index) + ".tga";
+	}
+
+	uint32_t imageColor(unsigned int index) {
+		const unsigned int color = index % COLORS;
+		return 0xFF000000u | ((color * 40u) << 16) | ((255u - color * 30u) << 8) | (color * 17u + 5u);
+	}
+
+	// TGA sin comprimir, 32 bits, filas de arriba abajo; los píxeles van en BGRA.
+	void writeImage(unsigned int index) {
+		uint8_t header[18] = {};
+		header[2] = 2;
+		header[12] = SIZE & 0xFF;
+		header[13] = SIZE >> 8;
+		header[14] = SIZE & 0xFF;
+		header[15] = SIZE >> 8;
+		header[16] = 32;
+		header[17] = 0x28;
+		const uint32_t rgba = imageColor(index);
+		const uint8_t bgra[4] = { (uint8_t)(rgba >> 16), (uint8_t)(rgba >> 8), (uint8_t)rgba, (uint8_t)(rgba >> 24) };
+		std::ofstream file(imageName(index), std::ios::binary);
+		file.write((const char*)header, sizeof(header));
+		for (unsigned int i = 0; i < SIZE * SIZE; ++i)
+			file.write((const char*)bgra, sizeof(bgra));
+	}
+
+	// Bytes de una imagen con su cadena de mips completa en RGBA8.
+	uint64_t imageBytes() {
+		uint64_t bytes = 0;
+		for (unsigned int size = SIZE; size > 0; size /= 2)
+			bytes += (uint64_t)size * size * 4;
+		return bytes;
+	}
+
+	// El nivel 0 de la entrada es la imagen que se pidió.
+	bool holdsImage(const TextureCache& cache, TextureCache::Handle handle, unsigned int index) {
+		const std::vector<MipLevel>* levels = cache.getLevels(handle);
+		if (!levels || levels->empty() || (*levels)[0].width != SIZE || (*levels)[0].height != SIZE)
+			return false;
+		const uint32_t rgba = imageColor(index);
+		const uint8_t expected[4] = { (uint8_t)rgba, (uint8_t)(rgba >> 8), (uint8_t)(rgba >> 16), (uint8_t)(rgba >> 24) };
+		const std::vector<uint8_t>& pixels = (*levels)[0].pixels;
+		return pixels.size() == SIZE * SIZE * 4 && std::memcmp(pixels.data(), expected, 4) == 0 &&
+			std::memcmp(pixels.data() + pixels.size() - 4, expected, 4) == 0;
+	}
+
+	void testDedup() {
+		TextureCache cache;
+		CHECK(SUCCEEDED(cache.init(nullptr, 1024 * 1024)));
+
+		const TextureCache::Handle first = cache.acquire(imageName(0));
+		CHECK(first != TextureCache::INVALID_HANDLE);
+		CHECK(holdsImage(cache, first, 0));
+		CHECK(cache.getTexture(first) == nullptr);
+		CHECK(cache.getStats().misses == 1 && cache.getStats().residentBytes == imageBytes());
+
+		// La misma ruta y otra ruta con el mismo contenido comparten la entrada.
+		CHECK(cache.acquire(imageName(0)) == first);
+		CHECK(cache.acquire(imageName(COLORS)) == first);
+		cache.addRef(first);
+		TextureCache::Stats stats = cache.getStats();
+		CHECK(stats.hits == 1 && stats.contentHits == 1 && stats.misses == 1);
+		CHECK(stats.entries == 1 && stats.residentBytes == imageBytes());
+
+		const TextureCache::Handle other = cache.acquire(imageName(1));
+		CHECK(other != TextureCache::INVALID_HANDLE && other != first);
+		CHECK(holdsImage(cache, other, 1));
+
+		// Sin referencias la entrada sigue cargada (hay presupuesto) y se encuentra por las dos rutas.
+		for (int i = 0; i < 4; ++i)
+			cache.release(first);
+		cache.release(other);
+		CHECK(cache.getStats().entries == 2 && cache.getStats().evictions == 0);
+		const TextureCache::Handle again = cache.acquire(imageName(COLORS));
+		CHECK(again == first);
+		CHECK(cache.getStats().hits == 2 && cache.getStats().misses == 2);
+		cache.release(again);
+
+		CHECK(cache.acquire("TextureCacheTests_missing.tga") == TextureCache::INVALID_HANDLE);
+		CHECK(cache.getStats().failures == 1 && cache.getStats().entries == 2);
+		cache.destroy();
+	}
+
+	void testEviction() {
+		TextureCache cache;
+		CHECK(SUCCEEDED(cache.init(nullptr, 3 * imageBytes())));
+
+		// Seis contenidos distintos pedidos y soltados en orden: se quedan los tres últimos.
+		for (unsigned int i = 0; i < COLORS; ++i) {
+			const TextureCache::Handle handle = cache.acquire(imageName(i));
+			CHECK(holdsImage(cache, handle, i));
+			cache.release(handle);
+			CHECK(cache.getStats().residentBytes <= 3 * imageBytes());
+		}
+		TextureCache::Stats stats = cache.getStats();
+		CHECK(stats.misses == COLORS && stats.evictions == COLORS - 3 && stats.entries == 3);
+
+		// Usar la imagen 3 la vuelve la más reciente: la siguiente carga expulsa la 4.
+		cache.release(cache.acquire(imageName(3)));
+		CHECK(cache.getStats().hits == 1);
+		cache.release(cache.acquire(imageName(0)));
+		cache.release(cache.acquire(imageName(3)));
+		cache.release(cache.acquire(imageName(5)));
+		stats = cache.getStats();
+		CHECK(stats.hits == 3 && stats.misses == COLORS + 1);
+		cache.release(cache.acquire(imageName(4)));
+		CHECK(cache.getStats().misses == COLORS + 2);
+
+		// Las entradas referenciadas no se expulsan aunque se pase del presupuesto.
+		std::vector<TextureCache::Handle> held;
+		for (unsigned int i = 0; i < COLORS; ++i)
+			held.push_back(cache.acquire(imageName(i)));
+		stats = cache.getStats();
+		CHECK(stats.entries == COLORS && stats.residentBytes == COLORS * imageBytes());
+		for (unsigned int i = 0; i < COLORS; ++i)
+			CHECK(holdsImage(cache, held[i], i));
+		const uint64_t evictions = stats.evictions;
+		for (TextureCache::Handle handle : held)
+			cache.release(handle);
+		stats = cache.getStats();
+		CHECK(stats.entries == 3 && stats.residentBytes == 3 * imageBytes());
+		CHECK(stats.evictions == evictions + COLORS - 3);
+
+		// Bajar el presupuesto expulsa al momento.
+		cache.setBudget(imageBytes());
+		CHECK(cache.getStats().entries == 1);
+		cache.destroy();
+	}
+
+	// Hilos que piden y sueltan rutas al azar (con contenidos repetidos) con sitio para dos
+	// imágenes: cada handle que se devuelve tiene su imagen mientras está referenciado, aunque
+	// las entradas se expulsen y sus huecos se reutilicen todo el rato.
+	void testConcurrentAcquire() {
+		const unsigned int THREADS = 8;
+		const unsigned int ITERATIONS = 300;
+		TextureCache cache;
+		CHECK(SUCCEEDED(cache.init(nullptr, 2 * imageBytes())));
+
+		std::atomic<unsigned int> wrong{ 0 };
+		std::vector<std::thread> threads;
+		for (unsigned int t = 0; t < THREADS; ++t) {
+			threads.emplace_back([&cache, &wrong, t] {
+				uint32_t random = 12345u + t * 7919u;
+				std::vector<std::pair<TextureCache::Handle, unsigned int>> held;
+				for (unsigned int i = 0; i < ITERATIONS; ++i) {
+					random = random * 1664525u + 1013904223u;
+					const unsigned int index = (random >> 8) % IMAGES;
+					const TextureCache::Handle handle = cache.acquire(imageName(index));
+					if (handle == TextureCache::INVALID_HANDLE || !holdsImage(cache, handle, index))
+						wrong.fetch_add(1, std::memory_order_relaxed);
+					held.emplace_back(handle, index);
+					// Se mantienen hasta tres referencias a la vez.
+					if (held.size() > (random >> 24) % 4) {
+						if (!holdsImage(cache, held.front().first, held.front().second))
+							wrong.fetch_add(1, std::memory_order_relaxed);
+						cache.release(held.front().first);
+						held.erase(held.begin());
+					}
+				}
+				for (const auto& h : held)
+					cache.release(h.first);
+			});
+		}
+		for (std::thread& thread : threads)
+			thread.join();
+
+		const TextureCache::Stats stats = cache.getStats();
+		CHECK(wrong.load() == 0);
+		CHECK(stats.failures == 0);
+		CHECK(stats.hits + stats.contentHits + stats.misses == THREADS * ITERATIONS);
+		CHECK(stats.residentBytes <= 2 * imageBytes() && stats.entries <= 2);
+		CHECK(stats.peakBytes >= stats.residentBytes);
+		cache.destroy();
+
+		// La misma ruta nueva pedida a la vez desde todos los hilos se carga una sola vez.
+		CHECK(SUCCEEDED(cache.init(nullptr, 1024 * 1024)));
+		std::atomic<unsigned int> ready{ 0 };
+		std::vector<TextureCache::Handle> handles(THREADS, TextureCache::INVALID_HANDLE);
+		threads.clear();
+		for (unsigned int t = 0; t < THREADS; ++t) {
+			threads.emplace_back([&, t] {
+				ready.fetch_add(1);
+				while (ready.load() < THREADS)
+					std::this_thread::yield();
+				handles[t] = cache.acquire(imageName(2));
+			});
+		}
+		for (std::thread& thread : threads)
+			thread.join();
+		bool same = true;
+		for (TextureCache::Handle handle : handles)
+			same = same && handle == handles[0];
+		CHECK(same && holdsImage(cache, handles[0], 2));
+		CHECK(cache.getStats().misses == 1 && cache.getStats().hits == THREADS - 1);
+		for (TextureCache::Handle handle : handles)
+			cache.release(handle);
+		CHECK(cache.getStats().entries == 1);
+		cache.destroy();
+	}
+}
+
+int
+main() {
+	for (unsigned int i = 0; i < IMAGES; ++i)
+		writeImage(i);
+
+	testDedup();
+	testEviction();
+	testConcurrentAcquire();
+
+	for (unsigned int i = 0; i < IMAGES; ++i)
+		std::remove(imageName(i).c_str());
+	return testResult("TextureCacheTests");
+}
@@ -0,0 +1,203 @@
+#include "TextureLoader.h"
+#include "TestCommon.h"
+#include <cstring>
+#include <fstream>
+
+// TextureLoader sin dispositivo: cada update() termina al menos una carga si hay alguna
+// esperando y, si termina más de una, no pasa del presupuesto de bytes; las imágenes más
+// grandes que el presupuesto salen solas en su update(). Los archivos que no existen, que no
+// son imágenes o que se cortan en la cabecera acaban en FAILED sin gastar presupuesto ni atascar la
+// cola. Las imágenes son TGA de 32 bits que se escriben en el directorio actual.
+
+namespace {
+
+	struct Image {
+		std::string name;
+		unsigned int size;
+		uint32_t color; ///< RGBA, el byte bajo es el rojo.
+	};
+
+	// TGA sin comprimir, 32 bits, filas de arriba abajo; los píxeles van en BGRA.
+	void writeImage(const Image& image) {
+		uint8_t header[18] = {};
+		header[2] = 2;
+		header[12] = image.size & 0xFF;
+		header[13] = image.size >> 8;
+		header[14] = image.size & 0xFF;
+		header[15] = image.size >> 8;
+		header[16] = 32;
+		header[17] = 0x28;
+		const uint8_t bgra[4] = { (uint8_t)(image.color >> 16), (uint8_t)(image.color >> 8), (uint8_t)image.color,
+			(uint8_t)(image.color >> 24) };
+		std::ofstream file(image.name, std::ios::binary);
+		file.write((const char*)header, sizeof(header));
+		for (unsigned int i = 0; i < image.size * image.size; ++i)
+			file.write((const char*)bgra, sizeof(bgra));
+	}
+
+	// Bytes de la cadena de mips completa en RGBA8.
+	uint64_t chainBytes(unsigned int size) {
+		uint64_t bytes = 0;
+		for (; size > 0; size /= 2)
+			bytes += (uint64_t)size * size * 4;
+		return bytes;
+	}
+
+	bool holdsImage(const TextureLoader& loader, TextureLoader::Handle handle, const Image& image) {
+		unsigned int width = 0, height = 0;
+		const unsigned char* pixels = loader.getPixels(handle, width, height);
+		if (!pixels || width != image.size || height != image.size)
+			return false;
+		for (unsigned int i = 0; i < width * height; ++i) {
+			if (memcmp(pixels + i * 4, &image.color, 4) != 0)
+				return false;
+		}
+		return true;
+	}
+
+	std::vector<Image> makeImages() {
+		// Tamaños mezclados: 16² (1.4 KB con mips), 64² (21 KB) y 256² (349 KB).
+		const unsigned int sizes[] = { 16, 64, 64, 256, 16, 64, 16, 256, 64, 64, 16, 64 };
+		std::vector<Image> images;
+		for (unsigned int i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i) {
+			const uint32_t color = 0xFF000000u | ((i * 20u) << 16) | ((200u - i * 10u) << 8) | (i * 13u + 7u);
+			images.push_back({ "TextureLoaderTests_" + std::to_string(i) + ".tga", sizes[i], color });
+			writeImage(images.back());
+		}
+		return images;
+	}
+
+	// Cada update() termina al menos una carga y, si termina varias, no pasa del presupuesto.
+	void testBudget(const std::vector<Image>& images, unsigned int threads, uint64_t budget) {
+		TextureLoader loader;
+		CHECK(loader.load(images[0].name) == TextureLoader::INVALID_HANDLE); // Sin init()
+		CHECK(SUCCEEDED(loader.init(threads)));
+		std::vector<TextureLoader::Handle> handles;
+		for (const Image& image : images)
+			handles.push_back(loader.load(image.name));
+		CHECK(!loader.isIdle());
+		loader.waitDecoded();
+		CHECK(loader.getStats().decoded == images.size());
+
+		unsigned int updates = 0;
+		bool progress = true, withinBudget = true;
+		while (!loader.isIdle() && updates < 100) {
+			const TextureLoader::Stats before = loader.getStats();
+			const unsigned int finalized = loader.update(nullptr, budget);
+			const TextureLoader::Stats after = loader.getStats();
+			const uint64_t bytes = after.bytesFinalized - before.bytesFinalized;
+			progress &= finalized >= 1;
+			withinBudget &= bytes <= budget || after.finalized - before.finalized == 1;
+			++updates;
+		}
+		CHECK(progress && withinBudget);
+		CHECK(loader.isIdle());
+		CHECK(loader.update(nullptr, budget) == 0);
+
+		uint64_t total = 0;
+		bool ready = true, contents = true;
+		for (size_t i = 0; i < images.size(); ++i) {
+			ready &= loader.getState(handles[i]) == TextureLoader::READY;
+			contents &= holdsImage(loader, handles[i], images[i]);
+			const std::vector<MipLevel>* levels = loader.getLevels(handles[i]);
+			ready &= levels && levels->size() == (size_t)std::log2(images[i].size) + 1;
+			total += chainBytes(images[i].size);
+		}
+		CHECK(ready && contents);
+		const TextureLoader::Stats stats = loader.getStats();
+		CHECK(stats.requested == images.size() && stats.finalized == images.size() && stats.failed == 0);
+		CHECK(stats.bytesDecoded == total && stats.bytesFinalized == total);
+		// Con el presupuesto por encima de la mayor imagen hacen falta al menos total / presupuesto llamadas.
+		if (budget >= chainBytes(256))
+			CHECK(updates >= (unsigned int)((total + budget - 1) / budget));
+		CHECK(stats.worstUpdateSeconds >= stats.lastUpdateSeconds);
+		loader.destroy();
+		CHECK(loader.getState(handles[0]) == TextureLoader::FAILED); // Handles de antes de destroy()
+	}
+
+	// Presupuesto 0: una carga por update(), en el orden en que se decodificaron.
+	void testZeroBudget(const std::vector<Image>& images) {
+		TextureLoader loader;
+		CHECK(SUCCEEDED(loader.init(1)));
+		for (const Image& image : images)
+			loader.load(image.name);
+		loader.waitDecoded();
+		bool one = true;
+		for (size_t i = 0; i < images.size(); ++i)
+			one &= loader.update(nullptr, 0) == 1;
+		CHECK(one && loader.isIdle());
+	}
+
+	// Fallos: archivo que no existe, que no es una imagen, vacío y PNG cortado en la cabecera
+	// (un TGA truncado no sirve: stb_image rellena con ceros lo que falta). No gastan
+	// presupuesto y no bloquean las cargas buenas que van detrás.
+	void testFailedDecode(const std::vector<Image>& images) {
+		{
+			std::ofstream text("TextureLoaderTests_text.tga", std::ios::binary);
+			text << "this is not an image";
+		}
+		{
+			std::ofstream empty("TextureLoaderTests_empty.tga", std::ios::binary);
+		}
+		{
+			const char header[] = "\x89PNG\r\n\x1a\n\0\0\0\x0dIHDR\0\0";
+			std::ofstream cut("TextureLoaderTests_cut.png", std::ios::binary);
+			cut.write(header, sizeof(header) - 1);
+		}
+
+		TextureLoader loader;
+		CHECK(SUCCEEDED(loader.init(2)));
+		const TextureLoader::Handle missing = loader.load("TextureLoaderTests_missing.tga");
+		const TextureLoader::Handle text = loader.load("TextureLoaderTests_text.tga");
+		const TextureLoader::Handle empty = loader.load("TextureLoaderTests_empty.tga");
+		const TextureLoader::Handle cut = loader.load("TextureLoaderTests_cut.png");
+		const TextureLoader::Handle good = loader.load(images[1].name);
+		loader.waitDecoded();
+		for (TextureLoader::Handle handle : { missing, text, empty, cut })
+			CHECK(loader.getState(handle) == TextureLoader::FAILED);
+		CHECK(loader.getState(good) == TextureLoader::DECODED);
+
+		// Los cuatro fallos y la imagen buena salen en un solo update() con presupuesto justo.
+		CHECK(loader.update(nullptr, chainBytes(images[1].size)) == 5);
+		CHECK(loader.isIdle());
+		CHECK(loader.getState(good) == TextureLoader::READY && holdsImage(loader, good, images[1]));
+		unsigned int width = 0, height = 0;
+		CHECK(loader.getPixels(text, width, height) == nullptr && loader.getLevels(text) == nullptr);
+		CHECK(loader.getState(12345) == TextureLoader::FAILED);
+		const TextureLoader::Stats stats = loader.getStats();
+		CHECK(stats.requested == 5 && stats.decoded == 1 && stats.finalized == 1 && stats.failed == 4);
+		CHECK(stats.bytesFinalized == chainBytes(images[1].size));
+
+		std::remove("TextureLoaderTests_text.tga");
+		std::remove("TextureLoaderTests_empty.tga");
+		std::remove("TextureLoaderTests_cut.png");
+	}
+
+	// Con compresión el presupuesto cuenta los bytes BC, no los RGBA8.
+	void testCompressedBudget(const std::vector<Image>& images) {
+		TextureLoader loader;
+		CHECK(SUCCEEDED(loader.init(2, true, BC_FORMAT_BC1)));
+		const TextureLoader::Handle handle = loader.load(images[3].name);
+		loader.waitDecoded();
+		CHECK(loader.update(nullptr, ~0ull) == 1);
+		const std::vector<CompressedLevel>* levels = loader.getCompressedLevels(handle);
+		CHECK(levels && levels->size() == 9 && loader.getLevels(handle) == nullptr);
+		const TextureLoader::Stats stats = loader.getStats();
+		CHECK(stats.bytesFinalized == stats.bytesCompressed);
+		CHECK(stats.bytesCompressed * 4 < stats.bytesDecoded); // BC1: 8 bytes por 16 píxeles
+	}
+}
+
+int
+main() {
+	const std::vector<Image> images = makeImages();
+	testBudget(images, 1, 400000);
+	testBudget(images, 4, 100000);
+	testBudget(images, 3, 30000);  // Más pequeño que las imágenes de 256²
+	testZeroBudget(images);
+	testFailedDecode(images);
+	testCompressedBudget(images);
+	for (const Image& image : images)
+		std::remove(image.name.c_str());
+	return testResult("TextureLoaderTests");
+}
@@ -0,0 +1,292 @@
+#include "TransformHierarchy.h"
+#include "TestCommon.h"
+#include <cstring>
+#include <random>
+
+// TransformHierarchy frente a una referencia recursiva en double que guarda cada nodo por
+// separado: bosques grandes (niveles de más de un trabajo del JobSystem), cambios locales,
+// reparentados, borrados de subárboles y nodos creados menos profundos que el último. Las
+// matrices en serie y con 4 hilos deben dar los mismos bits, y update() solo debe recalcular
+// los nodos sucios y sus descendientes.
+
+namespace {
+
+	typedef TransformHierarchy::Node Node;
+
+	struct Reference {
+		double m[4][4];
+	};
+
+	struct ReferenceNode {
+		bool alive = false;
+		Node parent = TransformHierarchy::INVALID_NODE;
+		Float3 position = Float3(0.0f, 0.0f, 0.0f);
+		Float4 rotation = Float4(0.0f, 0.0f, 0.0f, 1.0f);
+		Float3 scale = Float3(1.0f, 1.0f, 1.0f);
+	};
+
+	std::mt19937 g_random(777);
+
+	float randomFloat(float low, float high) {
+		return std::uniform_real_distribution<float>(low, high)(g_random);
+	}
+
+	Float4 randomRotation() {
+		for (;;) {
+			const float x = randomFloat(-1.0f, 1.0f), y = randomFloat(-1.0f, 1.0f);
+			const float z = randomFloat(-1.0f, 1.0f), w = randomFloat(-1.0f, 1.0f);
+			const float length = std::sqrt(x * x + y * y + z * z + w * w);
+			if (length > 0.1f && length <= 1.0f)
+				return Float4(x / length, y / length, z / length, w / length);
+		}
+	}
+
+	// Escala, giro y traslación por filas, como MatrixScaleRotationTranslation.
+	Reference local(const ReferenceNode& node) {
+		const double x = node.rotation.x, y = node.rotation.y, z = node.rotation.z, w = node.rotation.w;
+		const double rotation[3][3] = {
+			{ 1 - 2 * (y * y + z * z), 2 * (x * y + z * w), 2 * (x * z - y * w) },
+			{ 2 * (x * y - z * w), 1 - 2 * (x * x + z * z), 2 * (y * z + x * w) },
+			{ 2 * (x * z + y * w), 2 * (y * z - x * w), 1 - 2 * (x * x + y * y) },
+		};
+		const double scale[3] = { node.scale.x, node.scale.y, node.scale.z };
+		Reference r = {};
+		for (int row = 0; row < 3; ++row) {
+			for (int column = 0; column < 3; ++column)
+				r.m[row][column] = rotation[row][column] * scale[row];
+		}
+		r.m[3][0] = node.position.x;
+		r.m[3][1] = node.position.y;
+		r.m[3][2] = node.position.z;
+		r.m[3][3] = 1.0;
+		return r;
+	}
+
+	Reference multiply(const Reference& a, const Reference& b) {
+		Reference r;
+		for (int i = 0; i < 4; ++i) {
+			for (int j = 0; j < 4; ++j) {
+				r.m[i][j] = 0.0;
+				for (int k = 0; k < 4; ++k)
+					r.m[i][j] += a.m[i][k] * b.m[k][j];
+			}
+		}
+		return r;
+	}
+
+	Reference world(const std::vector<ReferenceNode>& nodes, Node node) {
+		const ReferenceNode& current = nodes[node];
+		return current.parent == TransformHierarchy::INVALID_NODE
+			? local(current) : multiply(local(current), world(nodes, current.parent));
+	}
+
+	bool isAncestor(const std::vector<ReferenceNode>& nodes, Node ancestor, Node node) {
+		for (Node current = node; current != TransformHierarchy::INVALID_NODE; current = nodes[current].parent) {
+			if (current == ancestor)
+				return true;
+		}
+		return false;
+	}
+
+	unsigned int subtreeSize(const std::vector<ReferenceNode>& nodes, Node root) {
+		unsigned int count = 0;
+		for (Node node = 0; node < (Node)nodes.size(); ++node)
+			count += nodes[node].alive && isAncestor(nodes, root, node);
+		return count;
+	}
+
+	// Mayor error de todas las matrices de mundo, relativo a la magnitud de cada elemento.
+	double maxError(const TransformHierarchy& hierarchy, const std::vector<ReferenceNode>& nodes) {
+		double error = 0.0;
+		for (Node node = 0; node < (Node)nodes.size(); ++node) {
+			if (!nodes[node].alive)
+				continue;
+			const Reference expected = world(nodes, node);
+			const Matrix& actual = hierarchy.getWorld(node);
+			for (int row = 0; row < 4; ++row) {
+				Float4 f;
+				VectorStore(f, actual.r[row]);
+				const float values[4] = { f.x, f.y, f.z, f.w };
+				for (int column = 0; column < 4; ++column) {
+					const double difference = std::fabs(values[column] - expected.m[row][column]);
+					error = std::max(error, difference / (1.0 + std::fabs(expected.m[row][column])));
+				}
+			}
+		}
+		return error;
+	}
+
+	// Las dos jerarquías y la referencia reciben las mismas operaciones.
+	struct Scene {
+		TransformHierarchy serial, parallel;
+		std::vector<ReferenceNode> nodes;
+
+		Node create(Node parent) {
+			const Node node = serial.createNode(parent);
+			CHECK(parallel.createNode(parent) == node);
+			if (node >= nodes.size())
+				nodes.resize(node + 1);
+			nodes[node] = ReferenceNode();
+			nodes[node].alive = true;
+			nodes[node].parent = parent;
+			return node;
+		}
+
+		void setLocal(Node node) {
+			ReferenceNode& reference = nodes[node];
+			reference.position = Float3(randomFloat(-5.0f, 5.0f), randomFloat(-5.0f, 5.0f), randomFloat(-5.0f, 5.0f));
+			reference.rotation = randomRotation();
+			reference.scale = Float3(randomFloat(0.8f, 1.2f), randomFloat(0.8f, 1.2f), randomFloat(0.8f, 1.2f));
+			serial.setLocal(node, reference.position, reference.rotation, reference.scale);
+			parallel.setLocal(node, reference.position, reference.rotation, reference.scale);
+		}
+
+		void destroy(Node node) {
+			for (Node other = 0; other < (Node)nodes.size(); ++other) {
+				if (other != node && nodes[other].alive && isAncestor(nodes, node, other))
+					nodes[other].alive = false;
+			}
+			nodes[node].alive = false;
+			serial.destroyNode(node);
+			parallel.destroyNode(node);
+		}
+
+		Node randomAlive() {
+			for (;;) {
+				const Node node = (Node)(g_random() % nodes.size());
+				if (nodes[node].alive)
+					return node;
+			}
+		}
+
+		void update() {
+			serial.update();
+			parallel.update();
+		}
+
+		bool sameBits() const {
+			for (Node node = 0; node < (Node)nodes.size(); ++node) {
+				if (nodes[node].alive && memcmp(&serial.getWorld(node), &parallel.getWorld(node), sizeof(Matrix)) != 0)
+					return false;
+			}
+			return serial.getStats().updatedNodes == parallel.getStats().updatedNodes;
+		}
+	};
+
+	// Bosque ancho y profundo con cambios aleatorios durante varios update().
+	void testAgainstReference(JobSystem& jobs) {
+		Scene scene;
+		scene.serial.init();
+		scene.parallel.init(&jobs);
+
+		// 64 raíces y 12 niveles de unos 1500 nodos; cada tanto un nodo se cuelga de un nivel
+		// anterior para que haya que reordenar.
+		std::vector<Node> previous, current;
+		for (int i = 0; i < 64; ++i)
+			previous.push_back(scene.create(TransformHierarchy::INVALID_NODE));
+		for (int level = 1; level < 12; ++level) {
+			current.clear();
+			for (int i = 0; i < 1500; ++i) {
+				const Node parent = previous[g_random() % previous.size()];
+				current.push_back(scene.create(parent));
+				if (i % 100 == 99)
+					scene.create(TransformHierarchy::INVALID_NODE);
+			}
+			previous.swap(current);
+		}
+		for (Node node = 0; node < (Node)scene.nodes.size(); ++node)
+			scene.setLocal(node);
+		scene.update();
+		CHECK(scene.serial.getStats().reordered && scene.serial.getStats().levels == 12);
+		CHECK(scene.serial.getStats().updatedNodes == scene.serial.getNodeCount());
+		CHECK(maxError(scene.parallel, scene.nodes) < 1e-4);
+		CHECK(scene.sameBits());
+
+		for (int round = 0; round < 12; ++round) {
+			for (int i = 0; i < 200; ++i)
+				scene.setLocal(scene.randomAlive());
+			for (int i = 0; i < 20; ++i) {
+				const Node node = scene.randomAlive();
+				const Node parent = g_random() % 4 == 0 ? TransformHierarchy::INVALID_NODE : scene.randomAlive();
+				const bool cycle = parent != TransformHierarchy::INVALID_NODE && isAncestor(scene.nodes, node, parent);
+				const HRESULT hr = scene.serial.setParent(node, parent);
+				CHECK(scene.parallel.setParent(node, parent) == hr);
+				CHECK(cycle ? hr == E_INVALIDARG : hr == S_OK);
+				if (!cycle)
+					scene.nodes[node].parent = parent;
+			}
+			if (round % 3 == 0)
+				scene.destroy(scene.randomAlive());
+			for (int i = 0; i < 50; ++i)
+				scene.setLocal(scene.create(g_random() % 2 ? scene.randomAlive() : TransformHierarchy::INVALID_NODE));
+
+			scene.update();
+			CHECK(maxError(scene.serial, scene.nodes) < 1e-4);
+			CHECK(scene.sameBits());
+			for (Node node = 0; node < (Node)scene.nodes.size(); ++node) {
+				if (scene.nodes[node].alive)
+					CHECK(scene.serial.getParent(node) == scene.nodes[node].parent);
+			}
+		}
+	}
+
+	// update() solo recalcula lo sucio: el nodo cambiado y su subárbol.
+	void testDirtyPropagation() {
+		Scene scene;
+		const Node root = scene.create(TransformHierarchy::INVALID_NODE);
+		const Node arm = scene.create(root);
+		const Node hand = scene.create(arm);
+		const Node finger = scene.create(hand);
+		const Node other = scene.create(TransformHierarchy::INVALID_NODE);
+		const Node leaf = scene.create(other);
+		for (Node node : { root, arm, hand, finger, other, leaf })
+			scene.setLocal(node);
+		scene.update();
+		CHECK(scene.serial.getStats().updatedNodes == 6);
+
+		scene.update();
+		CHECK(scene.serial.getStats().updatedNodes == 0);
+
+		scene.setLocal(finger);
+		scene.update();
+		CHECK(scene.serial.getStats().updatedNodes == 1);
+
+		scene.setLocal(arm);
+		scene.update();
+		CHECK(scene.serial.getStats().updatedNodes == 3);
+		CHECK(maxError(scene.serial, scene.nodes) < 1e-5);
+
+		// Reparentar marca el subárbol movido y reordena, pero no toca el resto.
+		CHECK(SUCCEEDED(scene.serial.setParent(hand, leaf)) && SUCCEEDED(scene.parallel.setParent(hand, leaf)));
+		scene.nodes[hand].parent = leaf;
+		scene.update();
+		CHECK(scene.serial.getStats().reordered);
+		CHECK(scene.serial.getStats().updatedNodes == subtreeSize(scene.nodes, hand));
+		CHECK(scene.serial.getStats().levels == 4);
+		CHECK(maxError(scene.serial, scene.nodes) < 1e-5);
+
+		// Un ciclo se rechaza sin cambiar nada.
+		CHECK(scene.serial.setParent(other, finger) == E_INVALIDARG);
+		CHECK(scene.serial.setParent(other, other) == E_INVALIDARG);
+		scene.update();
+		CHECK(scene.serial.getStats().updatedNodes == 0 && !scene.serial.getStats().reordered);
+
+		scene.destroy(leaf);
+		CHECK(!scene.serial.isValid(hand) && !scene.serial.isValid(finger) && scene.serial.isValid(other));
+		CHECK(scene.serial.getNodeCount() == 3);
+		scene.setLocal(other);
+		scene.update();
+		CHECK(scene.serial.getStats().updatedNodes == 1);
+		CHECK(maxError(scene.serial, scene.nodes) < 1e-5);
+	}
+}
+
+int
+main() {
+	JobSystem jobs;
+	jobs.init(4);
+	testAgainstReference(jobs);
+	testDirtyPropagation();
+	jobs.destroy();
+	return testResult("TransformHierarchyTests");
+}
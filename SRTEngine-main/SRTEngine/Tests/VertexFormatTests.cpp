@@ -0,0 +1,263 @@
+#include "VertexFormat.h"
+#include "TestCommon.h"
+#include <cstring>
+#include <random>
+
+// VertexFormat: cotas del error de ida y vuelta de cada codificación comprimida (normales en
+// octaedro, half y posiciones UNORM16 llevadas a la malla con getPositionDecodeMatrix()), cajas
+// degeneradas en setBounds() y UV fuera de [0, 1] con ENCODING_UNORM16X2, que encode() rechaza
+// en vez de recortarlas.
+
+namespace {
+
+	float dot(const Float3& a, const Float3& b) {
+		return a.x * b.x + a.y * b.y + a.z * b.z;
+	}
+
+	// Ángulo entre unitarios por el producto vectorial: con el escalar, en float, cerca de 1 no
+	// se distingue nada por debajo de unos 3e-4 rad.
+	float angle(const Float3& a, const Float3& b) {
+		const Float3 c(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+		return std::atan2(std::sqrt(dot(c, c)), dot(a, b));
+	}
+
+	Float3 normalize(const Float3& v) {
+		const float length = std::sqrt(dot(v, v));
+		return Float3(v.x / length, v.y / length, v.z / length);
+	}
+
+	void testLayout() {
+		VertexFormat format;
+		CHECK(format.add(SEMANTIC_POSITION, ENCODING_UNORM16X4) == S_OK);
+		CHECK(format.add(SEMANTIC_NORMAL, ENCODING_OCT16) == S_OK);
+		CHECK(format.add(SEMANTIC_TEXCOORD, ENCODING_HALF2) == S_OK);
+		CHECK(format.getStride() == 16);
+		CHECK(format.find(SEMANTIC_NORMAL) && format.find(SEMANTIC_NORMAL)->offset == 8);
+		CHECK(format.find(SEMANTIC_COLOR) == nullptr);
+		CHECK(format.add(SEMANTIC_POSITION, ENCODING_FLOAT3) == E_INVALIDARG);
+		CHECK(format.add(SEMANTIC_COLOR, ENCODING_OCT16) == E_INVALIDARG);
+		CHECK(format.getStride() == 16);
+	}
+
+	// Octaedro en SNORM16: el mejor de los cuatro redondeos queda a menos de 1.5e-4 rad (unos
+	// 0.009 grados; el paso de la rejilla es 1 / 32767 en [-1, 1]²) de la normal en toda la
+	// esfera, también en la mitad plegada z < 0, los ejes salen exactos y la decodificación es
+	// unitaria.
+	void testOctahedral() {
+		std::mt19937 random(1);
+		std::uniform_real_distribution<float> uniform(-1.0f, 1.0f);
+		float worst = 0.0f;
+		bool unit = true;
+		for (int i = 0; i < 200000; ++i) {
+			const Float3 normal = normalize(Float3(uniform(random), uniform(random), uniform(random)));
+			int16_t encoded[2];
+			VertexFormat::encodeOctahedral(normal, encoded);
+			const Float3 decoded = VertexFormat::decodeOctahedral(encoded);
+			worst = std::max(worst, angle(normal, decoded));
+			unit &= std::fabs(dot(decoded, decoded) - 1.0f) < 1e-5f;
+		}
+		CHECK(worst < 1.5e-4f);
+		CHECK(unit);
+
+		const Float3 axes[] = { Float3(1, 0, 0), Float3(-1, 0, 0), Float3(0, 1, 0), Float3(0, -1, 0), Float3(0, 0, 1), Float3(0, 0, -1) };
+		for (const Float3& axis : axes) {
+			int16_t encoded[2];
+			VertexFormat::encodeOctahedral(axis, encoded);
+			CHECK(dot(VertexFormat::decodeOctahedral(encoded), axis) > 1.0f - 1e-6f);
+		}
+		// Sin normalizar da lo mismo; el vector nulo da (0, 0), que decodifica a +z.
+		int16_t a[2], b[2];
+		VertexFormat::encodeOctahedral(Float3(0.3f, -0.4f, -0.2f), a);
+		VertexFormat::encodeOctahedral(Float3(3.0f, -4.0f, -2.0f), b);
+		CHECK(a[0] == b[0] && a[1] == b[1]);
+		VertexFormat::encodeOctahedral(Float3(0.0f, 0.0f, 0.0f), a);
+		CHECK(a[0] == 0 && a[1] == 0);
+
+		// Por encode()/decode() sale lo mismo que con las funciones sueltas.
+		VertexFormat format;
+		format.add(SEMANTIC_NORMAL, ENCODING_OCT16);
+		const Float3 normals[2] = { normalize(Float3(0.2f, -0.9f, -0.3f)), normalize(Float3(-0.5f, 0.1f, 0.8f)) };
+		VertexFormat::Source source;
+		source.streams[SEMANTIC_NORMAL] = { normals, sizeof(Float3) };
+		uint32_t vertices[2];
+		CHECK(format.encode(source, 2, vertices) == S_OK);
+		Float4 decoded[2];
+		CHECK(format.decode(vertices, 2, SEMANTIC_NORMAL, decoded) == S_OK);
+		for (int i = 0; i < 2; ++i) {
+			CHECK(angle(Float3(decoded[i].x, decoded[i].y, decoded[i].z), normals[i]) < 1.5e-4f);
+			CHECK(decoded[i].w == 0.0f);
+		}
+	}
+
+	// Half: todo valor finito de half vuelve a sí mismo, el error relativo en el rango normal es
+	// como mucho 2^-11, los empates van al par y lo que desborda o no llega se va a infinito o 0.
+	void testHalf() {
+		bool roundTrip = true;
+		for (uint32_t h = 0; h < 65536; ++h) {
+			const float value = VertexFormat::halfToFloat((uint16_t)h);
+			if (!std::isnan(value))
+				roundTrip &= VertexFormat::floatToHalf(value) == h;
+			else
+				roundTrip &= std::isnan(VertexFormat::halfToFloat(VertexFormat::floatToHalf(value)));
+		}
+		CHECK(roundTrip);
+
+		std::mt19937 random(2);
+		std::uniform_real_distribution<float> exponent(-14.0f, 15.9f);
+		float worst = 0.0f;
+		for (int i = 0; i < 100000; ++i) {
+			const float value = std::exp2(exponent(random)) * (i & 1 ? -1.0f : 1.0f);
+			const float decoded = VertexFormat::halfToFloat(VertexFormat::floatToHalf(value));
+			worst = std::max(worst, std::fabs(decoded - value) / std::fabs(value));
+		}
+		CHECK(worst <= std::exp2(-11.0f));
+
+		CHECK(VertexFormat::halfToFloat(VertexFormat::floatToHalf(1.0f + std::exp2(-11.0f))) == 1.0f);
+		CHECK(VertexFormat::halfToFloat(VertexFormat::floatToHalf(1.0f + 3.0f * std::exp2(-11.0f))) == 1.0f + std::exp2(-9.0f));
+		CHECK(VertexFormat::floatToHalf(65504.0f) == 0x7bff);
+		CHECK(VertexFormat::floatToHalf(65519.0f) == 0x7bff);
+		CHECK(VertexFormat::floatToHalf(65520.0f) == 0x7c00);
+		CHECK(VertexFormat::floatToHalf(-1e10f) == 0xfc00);
+		CHECK(VertexFormat::floatToHalf(std::exp2(-24.0f)) == 0x0001);
+		CHECK(VertexFormat::floatToHalf(std::exp2(-26.0f)) == 0x0000);
+		CHECK(VertexFormat::floatToHalf(-0.0f) == 0x8000);
+		CHECK(std::isnan(VertexFormat::halfToFloat(VertexFormat::floatToHalf(NAN))));
+	}
+
+	// UNORM16 relativo a la caja: en [0, 1] como lo entrega el input assembler y por
+	// getPositionDecodeMatrix() de vuelta a la malla, con un error por eje de media unidad de
+	// cuantización; lo que sale de la caja se recorta a ella.
+	void testPositions() {
+		const Float3 boundsMin(-3.0f, 10.0f, -0.5f), boundsMax(5.0f, 12.0f, 0.5f);
+		VertexFormat format;
+		format.add(SEMANTIC_POSITION, ENCODING_UNORM16X4);
+		format.setBounds(boundsMin, boundsMax);
+		const Matrix decode = format.getPositionDecodeMatrix();
+
+		std::mt19937 random(3);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		std::vector<Float3> positions;
+		for (int i = 0; i < 10000; ++i) {
+			positions.push_back(Float3(boundsMin.x + unit(random) * 8.0f, boundsMin.y + unit(random) * 2.0f,
+				boundsMin.z + unit(random) * 1.0f));
+		}
+		positions.push_back(boundsMin);
+		positions.push_back(boundsMax);
+		VertexFormat::Source source;
+		source.streams[SEMANTIC_POSITION] = { positions.data(), sizeof(Float3) };
+		std::vector<uint8_t> vertices(positions.size() * format.getStride());
+		CHECK(format.encode(source, positions.size(), vertices.data()) == S_OK);
+		std::vector<Float4> quantized(positions.size()), meshSpace(positions.size());
+		format.decode(vertices.data(), positions.size(), SEMANTIC_POSITION, quantized.data(), false);
+		format.decode(vertices.data(), positions.size(), SEMANTIC_POSITION, meshSpace.data());
+
+		// Media unidad de cuantización más el redondeo del float en la escala del eje.
+		const Float3 tolerance(8.0f / 65535.0f * 0.5f + 1e-5f, 2.0f / 65535.0f * 0.5f + 2e-5f, 1.0f / 65535.0f * 0.5f + 1e-6f);
+		bool inBounds = true, viaMatrix = true, viaDecode = true;
+		for (size_t i = 0; i < positions.size(); ++i) {
+			const Float4& q = quantized[i];
+			inBounds &= q.x >= 0.0f && q.x <= 1.0f && q.y >= 0.0f && q.y <= 1.0f && q.z >= 0.0f && q.z <= 1.0f && q.w == 1.0f;
+			const Vector p = Vector3Transform(VectorSet(q.x, q.y, q.z, 1.0f), decode);
+			viaMatrix &= std::fabs(VectorGetX(p) - positions[i].x) <= tolerance.x &&
+				std::fabs(VectorGetY(p) - positions[i].y) <= tolerance.y && std::fabs(VectorGetZ(p) - positions[i].z) <= tolerance.z;
+			viaDecode &= std::fabs(meshSpace[i].x - positions[i].x) <= tolerance.x &&
+				std::fabs(meshSpace[i].y - positions[i].y) <= tolerance.y && std::fabs(meshSpace[i].z - positions[i].z) <= tolerance.z;
+		}
+		CHECK(inBounds && viaMatrix && viaDecode);
+		const Float4& last = meshSpace.back();
+		CHECK(last.x == boundsMax.x && last.y == boundsMax.y && last.z == boundsMax.z);
+
+		const Float3 outside(-10.0f, 11.0f, 3.0f);
+		source.streams[SEMANTIC_POSITION] = { &outside, sizeof(Float3) };
+		CHECK(format.encode(source, 1, vertices.data()) == S_OK);
+		Float4 clamped;
+		format.decode(vertices.data(), 1, SEMANTIC_POSITION, &clamped);
+		CHECK(clamped.x == boundsMin.x && clamped.z == boundsMax.z);
+
+		// Sin UNORM16X4 la matriz es la identidad.
+		VertexFormat plain;
+		plain.add(SEMANTIC_POSITION, ENCODING_HALF4);
+		plain.setBounds(boundsMin, boundsMax);
+		const Matrix identity = MatrixIdentity(), decodePlain = plain.getPositionDecodeMatrix();
+		CHECK(memcmp(&decodePlain, &identity, sizeof(Matrix)) == 0);
+	}
+
+	// Un eje sin extensión (malla plana) o con la caja al revés se queda con escala 1: la matriz
+	// sigue siendo invertible, ese eje se codifica en 0 y sale exacto.
+	void testDegenerateBounds() {
+		VertexFormat format;
+		format.add(SEMANTIC_POSITION, ENCODING_UNORM16X4);
+		for (const Float3& boundsMax : { Float3(4.0f, 2.0f, 7.0f), Float3(4.0f, 1.0f, 7.0f) }) {
+			const Float3 boundsMin(0.0f, 2.0f, 7.0f);
+			format.setBounds(boundsMin, boundsMax);
+			float determinant = 0.0f;
+			const Matrix decode = format.getPositionDecodeMatrix();
+			MatrixInverse(decode, &determinant);
+			CHECK(determinant != 0.0f && std::isfinite(determinant));
+
+			const Float3 positions[2] = { Float3(1.0f, 2.0f, 7.0f), Float3(3.0f, 2.0f, 7.0f) };
+			VertexFormat::Source source;
+			source.streams[SEMANTIC_POSITION] = { positions, sizeof(Float3) };
+			uint8_t vertices[16];
+			CHECK(format.encode(source, 2, vertices) == S_OK);
+			Float4 decoded[2];
+			format.decode(vertices, 2, SEMANTIC_POSITION, decoded);
+			for (int i = 0; i < 2; ++i) {
+				CHECK(std::isfinite(decoded[i].x) && std::isfinite(decoded[i].y) && std::isfinite(decoded[i].z));
+				CHECK_NEAR(decoded[i].x, positions[i].x, 4.0f / 65535.0f);
+				CHECK(decoded[i].y == 2.0f && decoded[i].z == 7.0f);
+			}
+		}
+	}
+
+	// UNORM16X2: en [0, 1] con media unidad de error y los extremos exactos; fuera (UV que se
+	// repiten) o NaN, encode() devuelve E_INVALIDARG sin tocar el destino. HALF2 sí las admite.
+	void testTexCoords() {
+		VertexFormat format;
+		format.add(SEMANTIC_TEXCOORD, ENCODING_UNORM16X2);
+		std::vector<Float2> uvs;
+		for (int i = 0; i <= 1000; ++i)
+			uvs.push_back(Float2(i / 1000.0f, 1.0f - i / 1000.0f));
+		VertexFormat::Source source;
+		source.streams[SEMANTIC_TEXCOORD] = { uvs.data(), sizeof(Float2) };
+		std::vector<uint32_t> vertices(uvs.size());
+		CHECK(format.encode(source, uvs.size(), vertices.data()) == S_OK);
+		std::vector<Float4> decoded(uvs.size());
+		format.decode(vertices.data(), uvs.size(), SEMANTIC_TEXCOORD, decoded.data());
+		bool close = true;
+		for (size_t i = 0; i < uvs.size(); ++i)
+			close &= std::fabs(decoded[i].x - uvs[i].x) <= 0.5f / 65535.0f + 1e-7f && std::fabs(decoded[i].y - uvs[i].y) <= 0.5f / 65535.0f + 1e-7f;
+		CHECK(close);
+		CHECK(decoded[0].x == 0.0f && decoded[0].y == 1.0f && decoded.back().x == 1.0f && decoded.back().y == 0.0f);
+
+		for (const Float2& bad : { Float2(1.5f, 0.5f), Float2(0.5f, -0.001f), Float2(NAN, 0.5f) }) {
+			std::vector<Float2> tiled = uvs;
+			tiled[500] = bad;
+			source.streams[SEMANTIC_TEXCOORD] = { tiled.data(), sizeof(Float2) };
+			std::vector<uint32_t> untouched(uvs.size(), 0xdeadbeefu);
+			CHECK(format.encode(source, tiled.size(), untouched.data()) == E_INVALIDARG);
+			CHECK(untouched[0] == 0xdeadbeefu && untouched[500] == 0xdeadbeefu);
+		}
+
+		VertexFormat half;
+		half.add(SEMANTIC_TEXCOORD, ENCODING_HALF2);
+		const Float2 tiled(3.5f, -2.25f);
+		source.streams[SEMANTIC_TEXCOORD] = { &tiled, sizeof(Float2) };
+		uint32_t vertex;
+		CHECK(half.encode(source, 1, &vertex) == S_OK);
+		Float4 value;
+		half.decode(&vertex, 1, SEMANTIC_TEXCOORD, &value);
+		CHECK(value.x == 3.5f && value.y == -2.25f);
+	}
+}
+
+int
+main() {
+	testLayout();
+	testOctahedral();
+	testHalf();
+	testPositions();
+	testDegenerateBounds();
+	testTexCoords();
+	return testResult("VertexFormatTests");
+}
@@ -0,0 +1,78 @@
+#include "ArchiveWriter.h"
+#include "AssetArchive.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+// Empaquetador de recursos: escribe con ArchiveWriter un .pak con los archivos indicados y
+// todo lo que cuelga de los directorios indicados. Cada entrada se guarda con su ruta tal y
+// como se escribió (relativa al directorio desde el que se ejecuta la demo), que es el
+// nombre con el que la buscan la demo y TextureCache. Las entradas se comprimen en LZ4
+// salvo con --store; ArchiveWriter ya guarda tal cual las que no ganan al menos un 10 %.
+// Uso: SRTPack [--store] salida.pak archivo|directorio...
+
+namespace {
+
+	namespace fs = std::filesystem;
+
+	void usage() {
+		fprintf(stderr, "Usage: SRTPack [--store] output.pak file|directory...\n");
+	}
+}
+
+int
+main(int argc, char** argv) {
+	int argument = 1;
+	bool compress = true;
+	if (argument < argc && strcmp(argv[argument], "--store") == 0) {
+		compress = false;
+		++argument;
+	}
+	if (argc - argument < 2) {
+		usage();
+		return 1;
+	}
+	const std::string output = argv[argument++];
+
+	ArchiveWriter writer;
+	std::vector<std::string> names;
+	for (; argument < argc; ++argument) {
+		const fs::path input = argv[argument];
+		std::error_code error;
+		if (fs::is_directory(input, error)) {
+			for (fs::recursive_directory_iterator it(input, error), end; !error && it != end; it.increment(error)) {
+				if (it->is_regular_file(error))
+					names.push_back(it->path().lexically_normal().generic_string());
+			}
+		}
+		else if (fs::is_regular_file(input, error)) {
+			names.push_back(input.lexically_normal().generic_string());
+		}
+		if (error || !fs::exists(input)) {
+			fprintf(stderr, "SRTPack: cannot read %s\n", input.string().c_str());
+			return 1;
+		}
+	}
+
+	// El orden de los datos no depende del orden en que el sistema devuelva los archivos.
+	std::sort(names.begin(), names.end());
+	uintmax_t inputBytes = 0;
+	for (const std::string& name : names) {
+		writer.addFile(name, name, compress);
+		inputBytes += fs::file_size(name);
+	}
+	if (FAILED(writer.write(output))) {
+		fprintf(stderr, "SRTPack: failed writing %s\n", output.c_str());
+		return 1;
+	}
+
+	AssetArchive archive;
+	if (FAILED(archive.open(output))) {
+		fprintf(stderr, "SRTPack: %s does not read back\n", output.c_str());
+		return 1;
+	}
+	printf("%s: %u entries, %.1f MB -> %.1f MB\n", output.c_str(), archive.getEntryCount(),
+		inputBytes / 1048576.0, fs::file_size(output) / 1048576.0);
+	return 0;
+}